@@ -58,6 +58,8 @@ macro(USE_COMPAT)
     check_symbol_exists(strptime "time.h" HAVE_STRPTIME)
     check_symbol_exists(mmap "sys/mman.h" HAVE_MMAP)
     check_symbol_exists(setenv "stdlib.h" HAVE_SETENV)
+    check_symbol_exists(writev "sys/uio.h" HAVE_WRITEV)
+    check_symbol_exists(poll "poll.h" HAVE_POLL)
 
     check_include_file("alloca.h" HAVE_ALLOCA_H)
 
@@ -0,0 +1,877 @@
+/**
+ * @file cbor.c
+ * @brief YANG-CBOR format common functionality and SID files.
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include "cbor.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "context.h"
+#include "hash_table.h"
+#include "in_internal.h"
+#include "json.h"
+#include "log.h"
+#include "ly_common.h"
+#include "out_internal.h"
+#include "set.h"
+#include "tree_schema.h"
+#include "tree_schema_internal.h"
+
+LY_ERR
+lycbor_print_head(struct ly_out *out, uint8_t major, uint64_t arg)
+{
+    uint8_t buf[9];
+    size_t len, i;
+
+    if (arg < 24) {
+        buf[0] = major | arg;
+        len = 0;
+    } else if (arg <= UINT8_MAX) {
+        buf[0] = major | 24;
+        len = 1;
+    } else if (arg <= UINT16_MAX) {
+        buf[0] = major | 25;
+        len = 2;
+    } else if (arg <= UINT32_MAX) {
+        buf[0] = major | 26;
+        len = 4;
+    } else {
+        buf[0] = major | 27;
+        len = 8;
+    }
+
+    /* network byte order */
+    for (i = 0; i < len; ++i) {
+        buf[len - i] = (arg >> (8 * i)) & 0xFF;
+    }
+
+    return ly_write_(out, (char *)buf, len + 1);
+}
+
+LY_ERR
+lycbor_print_int(struct ly_out *out, int64_t num)
+{
+    if (num >= 0) {
+        return lycbor_print_head(out, LYCBOR_UINT, num);
+    }
+
+    /* -1 - num, cannot overflow */
+    return lycbor_print_head(out, LYCBOR_NINT, (uint64_t)(-(num + 1)));
+}
+
+LY_ERR
+lycbor_print_str(struct ly_out *out, uint8_t major, const char *str, size_t len)
+{
+    LY_CHECK_RET(lycbor_print_head(out, major, len));
+    if (len) {
+        LY_CHECK_RET(ly_write_(out, str, len));
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Read bytes from a CBOR input.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[out] buf Buffer to read into.
+ * @param[in] count Number of bytes to read.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lycbor_read(struct lycbor_ctx *cborctx, void *buf, size_t count)
+{
+    if (ly_in_read(cborctx->in, buf, count)) {
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Unexpected end of YANG-CBOR data.");
+        return LY_EVALID;
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lycbor_read_head(struct lycbor_ctx *cborctx, struct lycbor_item *item)
+{
+    uint8_t buf[8], byte;
+    size_t len, i;
+
+    LY_CHECK_RET(lycbor_read(cborctx, &byte, 1));
+
+    memset(item, 0, sizeof *item);
+    item->major = byte & LYCBOR_MAJOR_MASK;
+    item->info = byte & LYCBOR_INFO_MASK;
+
+    if (item->info < 24) {
+        item->arg = item->info;
+        return LY_SUCCESS;
+    } else if (item->info == LYCBOR_INDEFINITE) {
+        if ((item->major != LYCBOR_BYTES) && (item->major != LYCBOR_TEXT) && (item->major != LYCBOR_ARRAY) &&
+                (item->major != LYCBOR_MAP)) {
+            LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Unexpected YANG-CBOR item \"0x%02x\".", byte);
+            return LY_EVALID;
+        }
+        item->indefinite = 1;
+        return LY_SUCCESS;
+    } else if (item->info > 27) {
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR item additional information \"0x%02x\".", byte);
+        return LY_EVALID;
+    }
+
+    /* 1, 2, 4, or 8 bytes of the argument in network byte order */
+    len = 1 << (item->info - 24);
+    LY_CHECK_RET(lycbor_read(cborctx, buf, len));
+    for (i = 0; i < len; ++i) {
+        item->arg = (item->arg << 8) | buf[i];
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lycbor_check_len(struct lycbor_ctx *cborctx, uint64_t len, size_t used)
+{
+    struct ly_in *in = cborctx->in;
+
+    if (len >= SIZE_MAX - used) {
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Too long YANG-CBOR string of %" PRIu64 " bytes.", len);
+        return LY_EVALID;
+    } else if (in->length && (len > in->length - (size_t)(in->current - in->start))) {
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Unexpected end of YANG-CBOR data.");
+        return LY_EVALID;
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lycbor_read_str(struct lycbor_ctx *cborctx, const struct lycbor_item *item, char **str, size_t *len)
+{
+    struct lycbor_item chunk;
+    char *s = NULL, *ptr;
+    size_t l = 0;
+
+    assert((item->major == LYCBOR_TEXT) || (item->major == LYCBOR_BYTES));
+
+    *str = NULL;
+    *len = 0;
+
+    if (!item->indefinite) {
+        /* the string must fit into the rest of the input before it is allocated */
+        LY_CHECK_RET(lycbor_check_len(cborctx, item->arg, 0));
+        s = malloc(item->arg + 1);
+        LY_CHECK_ERR_RET(!s, LOGMEM(cborctx->ctx), LY_EMEM);
+        if (lycbor_read(cborctx, s, item->arg)) {
+            free(s);
+            return LY_EVALID;
+        }
+        l = item->arg;
+    } else {
+        /* concatenate all the definite-length chunks */
+        while (!lycbor_read_break(cborctx)) {
+            LY_CHECK_ERR_RET(lycbor_read_head(cborctx, &chunk), free(s), LY_EVALID);
+            if ((chunk.major != item->major) || chunk.indefinite) {
+                LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR indefinite-length string chunk.");
+                free(s);
+                return LY_EVALID;
+            }
+            LY_CHECK_ERR_RET(lycbor_check_len(cborctx, chunk.arg, l), free(s), LY_EVALID);
+
+            ptr = realloc(s, l + chunk.arg + 1);
+            LY_CHECK_ERR_RET(!ptr, LOGMEM(cborctx->ctx); free(s), LY_EMEM);
+            s = ptr;
+            if (lycbor_read(cborctx, s + l, chunk.arg)) {
+                free(s);
+                return LY_EVALID;
+            }
+            l += chunk.arg;
+        }
+        if (!s) {
+            s = malloc(1);
+            LY_CHECK_ERR_RET(!s, LOGMEM(cborctx->ctx), LY_EMEM);
+        }
+    }
+
+    if ((item->major == LYCBOR_TEXT) && memchr(s, '\0', l)) {
+        /* the strings are used as NUL-terminated */
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR text string with a NUL character.");
+        free(s);
+        return LY_EVALID;
+    }
+
+    s[l] = '\0';
+    *str = s;
+    *len = l;
+    return LY_SUCCESS;
+}
+
+ly_bool
+lycbor_read_break(struct lycbor_ctx *cborctx)
+{
+    struct ly_in *in = cborctx->in;
+
+    if (in->length && ((size_t)(in->current - in->start) >= in->length)) {
+        /* EOF, the next read fails */
+        return 0;
+    }
+
+    if ((uint8_t)in->current[0] == LYCBOR_BREAK) {
+        ly_in_skip(in, 1);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Skip the content of a CBOR item, recursively.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[in] item Read header of the item to skip.
+ * @param[in] depth Nesting depth of @p item.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lycbor_skip_r(struct lycbor_ctx *cborctx, const struct lycbor_item *item, uint32_t depth)
+{
+    struct lycbor_item sub;
+    uint64_t i, count;
+
+    if (depth > LY_MAX_BLOCK_DEPTH * 10) {
+        LOGVAL(cborctx->ctx, LYVE_SYNTAX, "Maximum number %d of YANG-CBOR nestings has been exceeded.",
+                LY_MAX_BLOCK_DEPTH * 10);
+        return LY_EVALID;
+    }
+
+    switch (item->major) {
+    case LYCBOR_UINT:
+    case LYCBOR_NINT:
+    case LYCBOR_SIMPLE:
+        /* no content */
+        break;
+    case LYCBOR_BYTES:
+    case LYCBOR_TEXT:
+        if (!item->indefinite) {
+            LY_CHECK_RET(lycbor_check_len(cborctx, item->arg, 0));
+            ly_in_skip(cborctx->in, item->arg);
+            break;
+        }
+
+        while (!lycbor_read_break(cborctx)) {
+            LY_CHECK_RET(lycbor_read_head(cborctx, &sub));
+            LY_CHECK_RET(lycbor_skip_r(cborctx, &sub, depth + 1));
+        }
+        break;
+    case LYCBOR_ARRAY:
+    case LYCBOR_MAP:
+        count = (item->major == LYCBOR_MAP) ? 2 : 1;
+        if (item->indefinite) {
+            while (!lycbor_read_break(cborctx)) {
+                /* array item or map key and value */
+                for (i = 0; i < count; ++i) {
+                    LY_CHECK_RET(lycbor_read_head(cborctx, &sub));
+                    LY_CHECK_RET(lycbor_skip_r(cborctx, &sub, depth + 1));
+                }
+            }
+            break;
+        }
+
+        count *= item->arg;
+        for (i = 0; i < count; ++i) {
+            LY_CHECK_RET(lycbor_read_head(cborctx, &sub));
+            LY_CHECK_RET(lycbor_skip_r(cborctx, &sub, depth + 1));
+        }
+        break;
+    case LYCBOR_TAG:
+        /* tagged item */
+        LY_CHECK_RET(lycbor_read_head(cborctx, &sub));
+        LY_CHECK_RET(lycbor_skip_r(cborctx, &sub, depth + 1));
+        break;
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lycbor_skip(struct lycbor_ctx *cborctx, const struct lycbor_item *item)
+{
+    return lycbor_skip_r(cborctx, item, 0);
+}
+
+/**
+ * @brief Hash table equal callback of resolved SIDs by their SID.
+ */
+static ly_bool
+ly_sid_ht_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct ly_sid_rec *rec1 = val1_p, *rec2 = val2_p;
+
+    return rec1->sid == rec2->sid;
+}
+
+/**
+ * @brief Hash table equal callback of resolved SIDs by their item.
+ */
+static ly_bool
+ly_sid_item_ht_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct ly_sid_rec *rec1 = val1_p, *rec2 = val2_p;
+
+    return rec1->item == rec2->item;
+}
+
+uint64_t
+ly_sid_get(const struct ly_ctx *ctx, const void *item)
+{
+    struct ly_sid_rec rec = {0}, *match;
+
+    if (!ctx->sid_item_ht) {
+        return 0;
+    }
+
+    rec.item = item;
+    if (lyht_find(ctx->sid_item_ht, &rec, lyht_hash((const char *)&item, sizeof item), (void **)&match)) {
+        return 0;
+    }
+
+    return match->sid;
+}
+
+const void *
+ly_sid_find(const struct ly_ctx *ctx, uint64_t sid, uint8_t ns)
+{
+    struct ly_sid_rec rec = {0}, *match;
+
+    if (!ctx->sid_ht) {
+        return NULL;
+    }
+
+    rec.sid = sid;
+    if (lyht_find(ctx->sid_ht, &rec, lyht_hash((const char *)&sid, sizeof sid), (void **)&match)) {
+        return NULL;
+    }
+
+    return (match->ns == ns) ? match->item : NULL;
+}
+
+/**
+ * @brief Resolve a schema node identifier of a data SID file item.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] id Schema node identifier in the form "/mod:a/b/mod2:c", without choices and cases.
+ * @return Resolved schema node, NULL if not found or if it is an RPC/action input or output.
+ */
+static const struct lysc_node *
+ly_sid_resolve_data(const struct ly_ctx *ctx, const char *id)
+{
+    const struct lysc_node *parent = NULL, *node;
+    const struct lys_module *mod = NULL;
+    const char *name, *ptr;
+    size_t name_len;
+    uint32_t getnext_opts = 0;
+    ly_bool inout;
+
+    while (*id) {
+        if (*id != '/') {
+            return NULL;
+        }
+        ++id;
+
+        /* optional module prefix */
+        name = id;
+        name_len = strcspn(id, ":/");
+        if (name[name_len] == ':') {
+            ptr = strndup(name, name_len);
+            LY_CHECK_ERR_RET(!ptr, LOGMEM(ctx), NULL);
+            mod = ly_ctx_get_module_implemented(ctx, ptr);
+            free((char *)ptr);
+
+            name += name_len + 1;
+            name_len = strcspn(name, "/");
+        }
+        id = name + name_len;
+        if (!mod || !name_len) {
+            return NULL;
+        }
+
+        /* RPC/action input and output are not data nodes, just select the children */
+        inout = 0;
+        if (parent && (parent->nodetype & (LYS_RPC | LYS_ACTION))) {
+            if (!ly_strncmp("input", name, name_len)) {
+                getnext_opts = 0;
+                inout = 1;
+            } else if (!ly_strncmp("output", name, name_len)) {
+                getnext_opts = LYS_GETNEXT_OUTPUT;
+                inout = 1;
+            }
+        }
+        if (inout) {
+            if (!*id) {
+                return NULL;
+            }
+            continue;
+        }
+
+        node = lys_find_child(parent, mod, name, name_len, 0, getnext_opts);
+        if (!node) {
+            return NULL;
+        }
+        parent = node;
+        getnext_opts = 0;
+    }
+
+    return parent;
+}
+
+/**
+ * @brief Resolve an identity name of an identity SID file item.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] id Identity name with the module name prefix.
+ * @return Resolved identity, NULL if not found.
+ */
+static const struct lysc_ident *
+ly_sid_resolve_ident(const struct ly_ctx *ctx, const char *id)
+{
+    const struct lys_module *mod;
+    const char *name;
+    char *mod_name;
+    LY_ARRAY_COUNT_TYPE u;
+
+    name = strchr(id, ':');
+    if (!name) {
+        return NULL;
+    }
+
+    mod_name = strndup(id, name - id);
+    LY_CHECK_ERR_RET(!mod_name, LOGMEM(ctx), NULL);
+    mod = ly_ctx_get_module_implemented(ctx, mod_name);
+    free(mod_name);
+    if (!mod) {
+        return NULL;
+    }
+
+    ++name;
+    LY_ARRAY_FOR(mod->identities, u) {
+        if (!strcmp(mod->identities[u].name, name)) {
+            return &mod->identities[u];
+        }
+    }
+
+    return NULL;
+}
+
+void
+ly_sid_resolved_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->sid_ht, NULL);
+    ctx->sid_ht = NULL;
+    lyht_free(ctx->sid_item_ht, NULL);
+    ctx->sid_item_ht = NULL;
+}
+
+LY_ERR
+ly_sid_resolve(struct ly_ctx *ctx)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct ly_sid_item *item;
+    struct ly_sid_rec rec = {0};
+    uint32_t i;
+
+    ly_sid_resolved_free(ctx);
+    if (!ctx->sid_items.count) {
+        return LY_SUCCESS;
+    }
+
+    ctx->sid_ht = lyht_new(lyht_get_fixed_size(ctx->sid_items.count), sizeof rec, ly_sid_ht_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!ctx->sid_ht, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    ctx->sid_item_ht = lyht_new(lyht_get_fixed_size(ctx->sid_items.count), sizeof rec, ly_sid_item_ht_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!ctx->sid_item_ht, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+
+    for (i = 0; i < ctx->sid_items.count; ++i) {
+        item = ctx->sid_items.objs[i];
+
+        if (item->ns == LY_SID_NS_DATA) {
+            rec.item = ly_sid_resolve_data(ctx, item->identifier);
+        } else {
+            rec.item = ly_sid_resolve_ident(ctx, item->identifier);
+        }
+        if (!rec.item) {
+            LOGVRB("SID %" PRIu64 " item \"%s\" not found in the context, ignoring.", item->sid, item->identifier);
+            continue;
+        }
+        rec.sid = item->sid;
+        rec.ns = item->ns;
+
+        rc = lyht_insert(ctx->sid_ht, &rec, lyht_hash((const char *)&rec.sid, sizeof rec.sid), NULL);
+        LY_CHECK_GOTO(rc, cleanup);
+        rc = lyht_insert(ctx->sid_item_ht, &rec, lyht_hash((const char *)&rec.item, sizeof rec.item), NULL);
+        if (rc == LY_EEXIST) {
+            /* the same item with several SIDs, keep the first one */
+            rc = LY_SUCCESS;
+        }
+        LY_CHECK_GOTO(rc, cleanup);
+    }
+
+cleanup:
+    if (rc) {
+        ly_sid_resolved_free(ctx);
+    }
+    return rc;
+}
+
+/**
+ * @brief Free a SID file item.
+ *
+ * @param[in] ptr Item to free.
+ */
+static void
+ly_sid_item_free(void *ptr)
+{
+    struct ly_sid_item *item = ptr;
+
+    if (!item) {
+        return;
+    }
+
+    free(item->identifier);
+    free(item);
+}
+
+void
+ly_sid_free(struct ly_ctx *ctx)
+{
+    ly_sid_resolved_free(ctx);
+    ly_set_erase(&ctx->sid_items, ly_sid_item_free);
+}
+
+/**
+ * @brief Items of a SID file being loaded.
+ */
+struct ly_sid_load {
+    struct ly_set items;        /**< set of the loaded items (struct ly_sid_item *) */
+    char *module_name;          /**< name of the module of the SID file */
+    uint32_t module_depth;      /**< nesting depth of the object with @p module_name */
+};
+
+/**
+ * @brief Get the name of a JSON member without any module prefix.
+ *
+ * @param[in] jsonctx JSON context with the member name.
+ * @param[out] name_len Length of the name.
+ * @return Member name.
+ */
+static const char *
+ly_sid_member_name(const struct lyjson_ctx *jsonctx, size_t *name_len)
+{
+    const char *ptr;
+
+    ptr = memchr(jsonctx->value, ':', jsonctx->value_len);
+    if (ptr) {
+        ++ptr;
+        *name_len = jsonctx->value_len - (ptr - jsonctx->value);
+        return ptr;
+    }
+
+    *name_len = jsonctx->value_len;
+    return jsonctx->value;
+}
+
+/**
+ * @brief Parse a SID file item number.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] str SID number.
+ * @param[in] len Length of @p str.
+ * @param[out] sid Parsed SID.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_sid_parse_num(const struct ly_ctx *ctx, const char *str, size_t len, uint64_t *sid)
+{
+    size_t i;
+
+    *sid = 0;
+    for (i = 0; i < len; ++i) {
+        if ((str[i] < '0') || (str[i] > '9') || (*sid > (UINT64_MAX - (str[i] - '0')) / 10)) {
+            break;
+        }
+        *sid = *sid * 10 + (str[i] - '0');
+    }
+    if (!len || (i < len) || !*sid) {
+        LOGVAL(ctx, LYVE_SYNTAX, "Invalid SID \"%.*s\".", (int)len, str);
+        return LY_EVALID;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Parse a JSON value of a SID file, recursively, and collect all the objects that are SID items.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] jsonctx JSON context.
+ * @param[in] depth Object nesting depth of the value.
+ * @param[in,out] status JSON status of the value to parse, is set to the status following the value.
+ * @param[in,out] load Loaded SID file items.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_sid_load_value(const struct ly_ctx *ctx, struct lyjson_ctx *jsonctx, uint32_t depth,
+        enum LYJSON_PARSER_STATUS *status, struct ly_sid_load *load)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const char *name;
+    size_t name_len;
+    char *ns = NULL, *id = NULL, *mod_name = NULL, **member;
+    ly_bool has_sid = 0;
+    uint64_t sid = 0;
+    struct ly_sid_item *item;
+
+    switch (*status) {
+    case LYJSON_OBJECT:
+        LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+        while (*status != LYJSON_OBJECT_CLOSED) {
+            /* member name */
+            name = ly_sid_member_name(jsonctx, &name_len);
+            if (!ly_strncmp("namespace", name, name_len)) {
+                member = &ns;
+            } else if (!ly_strncmp("identifier", name, name_len)) {
+                member = &id;
+            } else if (!ly_strncmp("module-name", name, name_len)) {
+                member = &mod_name;
+            } else if (!ly_strncmp("sid", name, name_len)) {
+                member = NULL;
+                has_sid = 1;
+            } else {
+                member = NULL;
+                name = NULL;
+            }
+
+            /* member value */
+            LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+            if (name && ((*status == LYJSON_STRING) || (*status == LYJSON_NUMBER))) {
+                if (member) {
+                    free(*member);
+                    *member = strndup(jsonctx->value, jsonctx->value_len);
+                    LY_CHECK_ERR_GOTO(!*member, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+                } else {
+                    LY_CHECK_GOTO(rc = ly_sid_parse_num(ctx, jsonctx->value, jsonctx->value_len, &sid), cleanup);
+                }
+                LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+            } else {
+                if (!member && name) {
+                    /* not a SID item */
+                    has_sid = 0;
+                }
+                LY_CHECK_GOTO(rc = ly_sid_load_value(ctx, jsonctx, depth + 1, status, load), cleanup);
+            }
+
+            if (*status == LYJSON_OBJECT_NEXT) {
+                LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+            }
+        }
+
+        /* SID item */
+        if (ns && id && has_sid) {
+            if (!strcmp(ns, "data") || !strcmp(ns, "identity")) {
+                item = calloc(1, sizeof *item);
+                LY_CHECK_ERR_GOTO(!item, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+                item->ns = !strcmp(ns, "data") ? LY_SID_NS_DATA : LY_SID_NS_IDENTITY;
+                item->identifier = id;
+                id = NULL;
+                item->sid = sid;
+                LY_CHECK_ERR_GOTO(rc = ly_set_add(&load->items, item, 1, NULL), ly_sid_item_free(item), cleanup);
+            }
+        }
+
+        /* module of the SID file, the least nested one */
+        if (mod_name && (!load->module_name || (depth < load->module_depth))) {
+            free(load->module_name);
+            load->module_name = mod_name;
+            mod_name = NULL;
+            load->module_depth = depth;
+        }
+        break;
+    case LYJSON_ARRAY:
+        LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+        while (*status != LYJSON_ARRAY_CLOSED) {
+            LY_CHECK_GOTO(rc = ly_sid_load_value(ctx, jsonctx, depth, status, load), cleanup);
+            if (*status == LYJSON_ARRAY_NEXT) {
+                LY_CHECK_GOTO(rc = lyjson_ctx_next(jsonctx, status), cleanup);
+            }
+        }
+        break;
+    default:
+        /* scalar value */
+        break;
+    }
+
+    /* move after the value */
+    rc = lyjson_ctx_next(jsonctx, status);
+
+cleanup:
+    free(ns);
+    free(id);
+    free(mod_name);
+    return rc;
+}
+
+/**
+ * @brief Hash table equal callback of SID file items by their identifier.
+ */
+static ly_bool
+ly_sid_load_id_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct ly_sid_item *item1 = *(struct ly_sid_item **)val1_p, *item2 = *(struct ly_sid_item **)val2_p;
+
+    return (item1->ns == item2->ns) && !strcmp(item1->identifier, item2->identifier);
+}
+
+/**
+ * @brief Hash table equal callback of SID file items by their SID.
+ */
+static ly_bool
+ly_sid_load_sid_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct ly_sid_item *item1 = *(struct ly_sid_item **)val1_p, *item2 = *(struct ly_sid_item **)val2_p;
+
+    return item1->sid == item2->sid;
+}
+
+/**
+ * @brief Merge loaded SID file items into the items of a context.
+ *
+ * @param[in] ctx Context to merge into.
+ * @param[in,out] load Loaded items, are spent.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_sid_load_merge(struct ly_ctx *ctx, struct ly_sid_load *load)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct ly_ht *id_ht = NULL, *sid_ht = NULL;
+    struct ly_sid_item *item, **match;
+    char *id;
+    uint32_t i, hash, count = ctx->sid_items.count + load->items.count;
+
+    /* prefix the identities with the module name of the SID file */
+    for (i = 0; i < load->items.count; ++i) {
+        item = load->items.objs[i];
+        if ((item->ns != LY_SID_NS_IDENTITY) || strchr(item->identifier, ':')) {
+            continue;
+        }
+
+        if (!load->module_name) {
+            LOGVAL(ctx, LYVE_SYNTAX, "Missing module name of the SID file with identity \"%s\".", item->identifier);
+            return LY_EVALID;
+        }
+        if (asprintf(&id, "%s:%s", load->module_name, item->identifier) == -1) {
+            LOGMEM(ctx);
+            return LY_EMEM;
+        }
+        free(item->identifier);
+        item->identifier = id;
+    }
+
+    /* index the current items */
+    id_ht = lyht_new(lyht_get_fixed_size(count), sizeof item, ly_sid_load_id_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!id_ht, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    sid_ht = lyht_new(lyht_get_fixed_size(count), sizeof item, ly_sid_load_sid_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!sid_ht, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    for (i = 0; i < ctx->sid_items.count; ++i) {
+        item = ctx->sid_items.objs[i];
+        hash = lyht_hash(item->identifier, strlen(item->identifier));
+        LY_CHECK_GOTO(rc = lyht_insert(id_ht, &item, hash, NULL), cleanup);
+        LY_CHECK_GOTO(rc = lyht_insert(sid_ht, &item, lyht_hash((const char *)&item->sid, sizeof item->sid), NULL), cleanup);
+    }
+
+    /* check all the new items first */
+    for (i = 0; i < load->items.count; ++i) {
+        item = load->items.objs[i];
+        if (!lyht_find(sid_ht, &item, lyht_hash((const char *)&item->sid, sizeof item->sid), (void **)&match) &&
+                ((*match)->ns == item->ns) && !strcmp((*match)->identifier, item->identifier)) {
+            /* the same item loaded again */
+            continue;
+        }
+
+        /* remove any previous SID of the item */
+        hash = lyht_hash(item->identifier, strlen(item->identifier));
+        if (!lyht_find(id_ht, &item, hash, (void **)&match)) {
+            lyht_remove(sid_ht, match, lyht_hash((const char *)&(*match)->sid, sizeof (*match)->sid));
+        }
+
+        if (lyht_insert(sid_ht, &item, lyht_hash((const char *)&item->sid, sizeof item->sid), (void **)&match)) {
+            LOGVAL(ctx, LYVE_SYNTAX, "SID %" PRIu64 " assigned to both \"%s\" and \"%s\".", item->sid,
+                    (*match)->identifier, item->identifier);
+            rc = LY_EVALID;
+            goto cleanup;
+        }
+    }
+
+    /* merge them */
+    for (i = 0; i < load->items.count; ++i) {
+        item = load->items.objs[i];
+        hash = lyht_hash(item->identifier, strlen(item->identifier));
+        if (!lyht_find(id_ht, &item, hash, (void **)&match)) {
+            /* reassign the SID of the item */
+            (*match)->sid = item->sid;
+            ly_sid_item_free(item);
+        } else {
+            LY_CHECK_GOTO(rc = ly_set_add(&ctx->sid_items, item, 1, NULL), cleanup);
+            LY_CHECK_GOTO(rc = lyht_insert(id_ht, &item, hash, NULL), cleanup);
+        }
+        load->items.objs[i] = NULL;
+    }
+
+cleanup:
+    lyht_free(id_ht, NULL);
+    lyht_free(sid_ht, NULL);
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+ly_ctx_load_sid_file(struct ly_ctx *ctx, struct ly_in *in)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyjson_ctx *jsonctx = NULL;
+    enum LYJSON_PARSER_STATUS status;
+    struct ly_sid_load load = {0};
+
+    LY_CHECK_ARG_RET(ctx, ctx, in, LY_EINVAL);
+
+    /* parse the items */
+    LY_CHECK_GOTO(rc = lyjson_ctx_new(ctx, in, &jsonctx), cleanup);
+    status = lyjson_ctx_status(jsonctx);
+    LY_CHECK_GOTO(rc = ly_sid_load_value(ctx, jsonctx, 0, &status, &load), cleanup);
+    if (status != LYJSON_END) {
+        LOGVAL(ctx, LYVE_SYNTAX, "Unexpected data following the SID file.");
+        rc = LY_EVALID;
+        goto cleanup;
+    }
+
+    /* add them into the context and resolve them */
+    LY_CHECK_GOTO(rc = ly_sid_load_merge(ctx, &load), cleanup);
+    LY_CHECK_GOTO(rc = ly_sid_resolve(ctx), cleanup);
+
+cleanup:
+    lyjson_ctx_free(jsonctx);
+    ly_set_erase(&load.items, ly_sid_item_free);
+    free(load.module_name);
+    return rc;
+}
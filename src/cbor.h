@@ -0,0 +1,249 @@
+/**
+ * @file cbor.h
+ * @brief Header for YANG-CBOR format printer & parser
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#ifndef LY_CBOR_H_
+#define LY_CBOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log.h"
+#include "parser_internal.h"
+
+struct ly_ctx;
+struct ly_in;
+struct ly_out;
+struct lysc_ident;
+struct lysc_node;
+
+/*
+ * YANG-CBOR format (RFC 9254)
+ *
+ * Data trees are encoded as CBOR (RFC 8949) maps with the members being the child nodes, similarly to JSON.
+ * Some notable properties:
+ *
+ * - member keys are either names (text strings of the same form as JSON member names) or YANG Schema Item
+ * iDentifiers (SIDs), which are integers assigned to schema nodes and identities in SID files (RFC 9595) that
+ * must be loaded into the context (::ly_ctx_load_sid_file()). SID keys are encoded as the difference from the SID
+ * of the parent schema node (0 for top-level nodes), keys of nodes whose parent has no SID use an absolute SID
+ * tagged with ::LYCBOR_TAG_SID. Nodes without SIDs always use names.
+ *
+ * - lists and leaf-lists are arrays of their instances, containers are maps, anydata are maps of their data trees.
+ *
+ * - values are encoded natively according to their type, numbers as integers, decimal64 as decimal fractions,
+ * booleans as simple values, empty as null, binary as byte strings, enumerations as integers, bits as byte strings
+ * bitmaps, and identityrefs as SIDs, if they have one. In unions, enumerations, bits, and identityrefs are tagged
+ * to be distinguished from the other types. All the other values are text strings of their canonical values.
+ *
+ * - metadata and opaque nodes are not supported.
+ */
+
+/**
+ * @brief CBOR major types.
+ */
+#define LYCBOR_UINT     0x00    /**< unsigned integer */
+#define LYCBOR_NINT     0x20    /**< negative integer */
+#define LYCBOR_BYTES    0x40    /**< byte string */
+#define LYCBOR_TEXT     0x60    /**< text string */
+#define LYCBOR_ARRAY    0x80    /**< array */
+#define LYCBOR_MAP      0xA0    /**< map */
+#define LYCBOR_TAG      0xC0    /**< tagged item */
+#define LYCBOR_SIMPLE   0xE0    /**< simple values and floats */
+
+#define LYCBOR_MAJOR_MASK 0xE0  /**< mask of the major type in the initial byte */
+#define LYCBOR_INFO_MASK 0x1F   /**< mask of the additional information in the initial byte */
+#define LYCBOR_INDEFINITE 0x1F  /**< additional information of indefinite-length items */
+
+/**
+ * @brief CBOR simple values.
+ */
+#define LYCBOR_FALSE    0xF4
+#define LYCBOR_TRUE     0xF5
+#define LYCBOR_NULL     0xF6
+#define LYCBOR_BREAK    0xFF
+
+/**
+ * @brief CBOR tags used by YANG-CBOR.
+ */
+#define LYCBOR_TAG_DECFRAC  4   /**< decimal fraction, decimal64 value */
+#define LYCBOR_TAG_BITS     43  /**< bits value in a union */
+#define LYCBOR_TAG_ENUM     44  /**< enumeration value in a union */
+#define LYCBOR_TAG_IDENT    45  /**< identityref SID in a union */
+#define LYCBOR_TAG_SID      47  /**< absolute SID of a member key */
+
+/**
+ * @brief Parsed CBOR item header.
+ */
+struct lycbor_item {
+    uint8_t major;          /**< major type */
+    uint8_t info;           /**< additional information */
+    uint64_t arg;           /**< argument, value of integers, length of strings, count of arrays and maps, tag number */
+    ly_bool indefinite;     /**< whether the item has an indefinite length */
+};
+
+/**
+ * @brief YANG-CBOR format parser context
+ */
+struct lycbor_ctx {
+    const struct ly_ctx *ctx;
+    uint64_t line;             /* current line, always 0 */
+    struct ly_in *in;          /* input structure */
+};
+
+/**
+ * @brief Loaded SID file item.
+ */
+struct ly_sid_item {
+    uint8_t ns;             /**< namespace of the item, ::LY_SID_NS_DATA or ::LY_SID_NS_IDENTITY */
+    char *identifier;       /**< data node path or identity name with the module name prefix */
+    uint64_t sid;           /**< assigned SID */
+};
+
+#define LY_SID_NS_DATA 1        /**< SID of a schema node */
+#define LY_SID_NS_IDENTITY 2    /**< SID of an identity */
+
+/**
+ * @brief SID of a resolved SID file item.
+ */
+struct ly_sid_rec {
+    const void *item;       /**< schema node or identity */
+    uint64_t sid;           /**< its SID */
+    uint8_t ns;             /**< namespace of the item */
+};
+
+/**
+ * @brief Print a CBOR item header.
+ *
+ * @param[in] out Output structure.
+ * @param[in] major Major type of the item.
+ * @param[in] arg Argument of the item.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_print_head(struct ly_out *out, uint8_t major, uint64_t arg);
+
+/**
+ * @brief Print a CBOR integer.
+ *
+ * @param[in] out Output structure.
+ * @param[in] num Integer to print.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_print_int(struct ly_out *out, int64_t num);
+
+/**
+ * @brief Print a CBOR text or byte string.
+ *
+ * @param[in] out Output structure.
+ * @param[in] major Major type, ::LYCBOR_TEXT or ::LYCBOR_BYTES.
+ * @param[in] str String to print.
+ * @param[in] len Length of @p str.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_print_str(struct ly_out *out, uint8_t major, const char *str, size_t len);
+
+/**
+ * @brief Read a CBOR item header.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[out] item Read item header.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_read_head(struct lycbor_ctx *cborctx, struct lycbor_item *item);
+
+/**
+ * @brief Read the content of a CBOR text or byte string.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[in] item Read header of the string.
+ * @param[out] str Read string, NULL-terminated, free with free().
+ * @param[out] len Length of @p str.
+ * @return LY_ERR value.
+ */
+/**
+ * @brief Check that a string of a length can be read and stored with its terminating zero.
+ *
+ * The length is checked against the rest of the input unless it is memory without a known length.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[in] len Length of the string.
+ * @param[in] used Length of the already read chunks of the string to append it to.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_check_len(struct lycbor_ctx *cborctx, uint64_t len, size_t used);
+
+LY_ERR lycbor_read_str(struct lycbor_ctx *cborctx, const struct lycbor_item *item, char **str, size_t *len);
+
+/**
+ * @brief Check whether the next item of an indefinite-length array or map is the break stop code and skip it.
+ *
+ * @param[in] cborctx CBOR context.
+ * @return Whether the stop code was read.
+ */
+ly_bool lycbor_read_break(struct lycbor_ctx *cborctx);
+
+/**
+ * @brief Skip the content of a CBOR item.
+ *
+ * @param[in] cborctx CBOR context.
+ * @param[in] item Read header of the item to skip.
+ * @return LY_ERR value.
+ */
+LY_ERR lycbor_skip(struct lycbor_ctx *cborctx, const struct lycbor_item *item);
+
+/**
+ * @brief Get the SID of a schema node or an identity.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] item Schema node or identity.
+ * @return Its SID, 0 if it has none.
+ */
+uint64_t ly_sid_get(const struct ly_ctx *ctx, const void *item);
+
+/**
+ * @brief Find a schema node or an identity by its SID.
+ *
+ * @param[in] ctx Context to use.
+ * @param[in] sid SID to find.
+ * @param[in] ns Expected namespace of the item.
+ * @return Found schema node or identity, NULL if none.
+ */
+const void *ly_sid_find(const struct ly_ctx *ctx, uint64_t sid, uint8_t ns);
+
+/**
+ * @brief Resolve all the loaded SID file items in the current context schemas.
+ *
+ * @param[in] ctx Context to use.
+ * @return LY_ERR value.
+ */
+LY_ERR ly_sid_resolve(struct ly_ctx *ctx);
+
+/**
+ * @brief Free the resolved SID file items of a context, they may reference schema nodes being freed.
+ *
+ * @param[in] ctx Context to use.
+ */
+void ly_sid_resolved_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Free all the loaded SID file items of a context.
+ *
+ * @param[in] ctx Context to use.
+ */
+void ly_sid_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Destructor for the lyd_cbor_ctx structure.
+ */
+void lyd_cbor_ctx_free(struct lyd_ctx *lydctx);
+
+#endif /* LY_CBOR_H_ */
@@ -32,10 +32,12 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "cbor.h"
 #include "compat.h"
 #include "hash_table.h"
 #include "in.h"
 #include "ly_common.h"
+#include "lyb.h"
 #include "parser_data.h"
 #include "plugins_internal.h"
 #include "plugins_types.h"
@@ -329,12 +331,26 @@ ly_ctx_new(const char *search_dir, uint16_t options, struct ly_ctx **new_ctx)
         LY_CHECK_ERR_GOTO(!ctx->leafref_links_ht, rc = LY_EMEM, cleanup);
     }
 
+    if (options & LY_CTX_INST_INDEX) {
+        LY_CHECK_GOTO(rc = lyd_inst_index_new(ctx), cleanup);
+    }
+
+    if (options & LY_CTX_LIST_CONSTRAINTS) {
+        LY_CHECK_GOTO(rc = lyd_cons_new(ctx), cleanup);
+    }
+
+    if (options & LY_CTX_WHEN_CACHE) {
+        LY_CHECK_GOTO(rc = lyd_when_cache_new(ctx), cleanup);
+    }
+
     /* initialize thread-specific error hash table */
     ctx->err_ht = lyht_new(1, sizeof(struct ly_ctx_err_rec), ly_ctx_ht_err_equal_cb, NULL, 1);
     LY_CHECK_ERR_GOTO(!ctx->err_ht, rc = LY_EMEM, cleanup);
 
     /* init LYB hash lock */
     pthread_mutex_init(&ctx->lyb_hash_lock, NULL);
+    pthread_mutex_init(&ctx->data_index_lock, NULL);
+    pthread_mutex_init(&ctx->lyb_stub_lock, NULL);
 
     /* modules list */
     ctx->flags = options;
@@ -667,6 +683,18 @@ ly_ctx_set_options(struct ly_ctx *ctx, uint16_t option)
         LY_CHECK_ERR_RET(!ctx->leafref_links_ht, LOGARG(ctx, option), LY_EMEM);
     }
 
+    if (!(ctx->flags & LY_CTX_INST_INDEX) && (option & LY_CTX_INST_INDEX)) {
+        LY_CHECK_RET(lyd_inst_index_new(ctx));
+    }
+
+    if (!(ctx->flags & LY_CTX_LIST_CONSTRAINTS) && (option & LY_CTX_LIST_CONSTRAINTS)) {
+        LY_CHECK_RET(lyd_cons_new(ctx));
+    }
+
+    if (!(ctx->flags & LY_CTX_WHEN_CACHE) && (option & LY_CTX_WHEN_CACHE)) {
+        LY_CHECK_RET(lyd_when_cache_new(ctx));
+    }
+
     if (!(ctx->flags & LY_CTX_SET_PRIV_PARSED) && (option & LY_CTX_SET_PRIV_PARSED)) {
         ctx->flags |= LY_CTX_SET_PRIV_PARSED;
         /* recompile the whole context to set the priv pointers */
@@ -712,6 +740,18 @@ ly_ctx_unset_options(struct ly_ctx *ctx, uint16_t option)
         ctx->leafref_links_ht = NULL;
     }
 
+    if ((ctx->flags & LY_CTX_INST_INDEX) && (option & LY_CTX_INST_INDEX)) {
+        lyd_inst_index_free(ctx);
+    }
+
+    if ((ctx->flags & LY_CTX_LIST_CONSTRAINTS) && (option & LY_CTX_LIST_CONSTRAINTS)) {
+        lyd_cons_free(ctx);
+    }
+
+    if ((ctx->flags & LY_CTX_WHEN_CACHE) && (option & LY_CTX_WHEN_CACHE)) {
+        lyd_when_cache_free(ctx);
+    }
+
     if ((ctx->flags & LY_CTX_SET_PRIV_PARSED) && (option & LY_CTX_SET_PRIV_PARSED)) {
         struct lys_module *mod;
         uint32_t index;
@@ -771,6 +811,15 @@ ly_ctx_new_change(struct ly_ctx *ctx)
     /* change counter */
     ctx->change_count++;
 
+    /* cached LYB hashes of schema siblings, the siblings may have changed */
+    lyb_sibs_free(ctx);
+
+    /* identity derivation closure, if changed */
+    lys_ident_closure_build(ctx);
+
+    /* SIDs of the loaded SID files, the schema nodes may have changed, best effort */
+    ly_sid_resolve(ctx);
+
     /* module hash */
     while ((mod = ly_ctx_get_module_iter(ctx, &i))) {
         /* name */
@@ -1383,6 +1432,10 @@ ly_ctx_destroy(struct ly_ctx *ctx)
         return;
     }
 
+    /* virtual default leaves and LYB stubs of any leftover data, they need their schema nodes */
+    lyd_dflt_virtual_free(ctx);
+    lyd_lyb_stub_free(ctx);
+
     /* modules list */
     for ( ; ctx->list.count; ctx->list.count--) {
         fctx.mod = ctx->list.objs[ctx->list.count - 1];
@@ -1406,6 +1459,20 @@ ly_ctx_destroy(struct ly_ctx *ctx)
     /* leftover unres */
     lys_unres_glob_erase(&ctx->unres);
 
+    /* secondary data indexes, should be all freed with the modules */
+    lyd_index_free_module(ctx, NULL);
+    lyd_inst_index_free(ctx);
+    lyd_cons_free(ctx);
+    lyd_when_cache_free(ctx);
+    lyd_child_vec_free(ctx);
+    lyb_sibs_free(ctx);
+
+    /* identity derivation closure */
+    lys_ident_closure_free(ctx);
+
+    /* loaded SID files */
+    ly_sid_free(ctx);
+
     /* clean the leafref links hash table */
     if (ctx->leafref_links_ht) {
         lyht_free(ctx->leafref_links_ht, ly_ctx_ht_leafref_links_rec_free);
@@ -1419,6 +1486,8 @@ ly_ctx_destroy(struct ly_ctx *ctx)
 
     /* LYB hash lock */
     pthread_mutex_destroy(&ctx->lyb_hash_lock);
+    pthread_mutex_destroy(&ctx->data_index_lock);
+    pthread_mutex_destroy(&ctx->lyb_stub_lock);
 
     /* context specific plugins */
     ly_set_erase(&ctx->plugins_types, NULL);
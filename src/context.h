@@ -125,6 +125,8 @@ struct lys_module;
  *
  * - ::ly_ctx_get_yanglib_data()
  *
+ * - ::ly_ctx_load_sid_file()
+ *
  * - ::ly_ctx_get_change_count()
  * - ::ly_ctx_internal_modules_count()
  *
@@ -207,6 +209,31 @@ struct ly_ctx;
                                         loaded except for built-in YANG types so all derived types will use these and
                                         for all purposes behave as the base type. The option can be used for cases when
                                         invalid data needs to be stored in YANG node values. */
+#define LY_CTX_INST_INDEX 0x1000 /**< Maintain an index of the data instances of all the schema nodes in the context. It
+                                        is then used by XPath evaluation of the descendant paths (such as "//name" or
+                                        "/a//b") instead of traversing the whole (sub)tree, making them proportional to
+                                        the number of results. The index costs a hash table record per data node and
+                                        must be enabled before any data are created. Once any data nodes were created
+                                        without it (or it was unset while some data existed), the index is never used in
+                                        the context. Working with data trees of a single context from several threads is
+                                        not safe with this option. */
+#define LY_CTX_XPATH_PARALLEL 0x2000 /**< Evaluate XPath descendant steps over several subtrees and predicates over large
+                                        node sets on data trees in parallel by worker threads, at most one per online
+                                        CPU. Useful for expressions examining most of a large data tree, such as
+                                        "//entry[contains(description, 'x')]". The data tree must not be modified
+                                        during the evaluation. */
+#define LY_CTX_LIST_CONSTRAINTS 0x4000 /**< Keep the number of (leaf-)list instances and the list instances hashed by
+                                        their unique values once validated and maintain them on every data tree change.
+                                        Validation of min-elements, max-elements, and unique constraints then only
+                                        examines the instances changed since the previous validation instead of all of
+                                        them. It costs a hash table record per validated constrained (leaf-)list
+                                        instance and a record per unique for lists, unset the option to free them.
+                                        Top-level (leaf-)lists are always validated the standard way. */
+#define LY_CTX_WHEN_CACHE 0x8000 /**< Remember the data nodes whose when conditions were evaluated to true by validation
+                                        and do not evaluate them again until an instance of a schema node referenced by
+                                        the conditions is linked, unlinked, or changed. It costs a hash table record per
+                                        validated node with a when condition and a mutex lock on every data tree change
+                                        of such an instance, unset the option to free them. */
 
 /** @} contextoptions */
 
@@ -623,6 +650,22 @@ LIBYANG_API_DECL uint32_t ly_ctx_internal_modules_count(const struct ly_ctx *ctx
 LIBYANG_API_DECL struct lys_module *ly_ctx_load_module(struct ly_ctx *ctx, const char *name, const char *revision,
         const char **features);
 
+/**
+ * @brief Load a YANG SID file (RFC 9595) into a context to be used by the ::LYD_CBOR data format.
+ *
+ * The SID file must be in its JSON encoding. Only the items of the data nodes and identities are used, the
+ * items of modules, features, and of schema nodes not present in the context are ignored. The SIDs remain loaded
+ * for the whole lifetime of the context and are resolved again after any change of its modules. Loading the items
+ * of the same schema nodes again reassigns their SIDs.
+ *
+ * @param[in] ctx Context to load into.
+ * @param[in] in Input handler with the SID file.
+ * @return LY_SUCCESS on success.
+ * @return LY_EVALID if the SID file is invalid or assigns the same SID to different items.
+ * @return LY_ERR value on other errors.
+ */
+LIBYANG_API_DECL LY_ERR ly_ctx_load_sid_file(struct ly_ctx *ctx, struct ly_in *in);
+
 /**
  * @brief Get data of the internal ietf-yang-library module with information about all the loaded modules.
  * ietf-yang-library module must be loaded.
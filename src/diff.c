@@ -25,8 +25,10 @@
 #include "compat.h"
 #include "context.h"
 #include "dict.h"
+#include "hash_table_internal.h"
 #include "log.h"
 #include "ly_common.h"
+#include "parser_data.h"
 #include "plugins_exts.h"
 #include "plugins_exts/metadata.h"
 #include "plugins_types.h"
@@ -367,7 +369,7 @@ lyd_diff_add(const struct lyd_node *node, enum lyd_diff_op op, const char *orig_
         }
 
         /* check whether it exists in the diff */
-        if (lyd_find_sibling_first(siblings, parent, &match)) {
+        if (lyd_find_sibling_first_(siblings, parent, &match)) {
             break;
         }
 
@@ -498,6 +500,220 @@ lyd_diff_add(const struct lyd_node *node, enum lyd_diff_op op, const char *orig_
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Index of a linked user-ordered instance.
+ */
+struct lyd_diff_userord_idx {
+    const struct lyd_node *node;    /**< instance */
+    uint32_t idx;                   /**< index of the instance in ::lyd_diff_userord.insts */
+};
+
+/**
+ * @brief Hash table value-equal callback for user-ordered instance indexes.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_diff_userord_idx_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_diff_userord_idx *idx1 = val1_p, *idx2 = val2_p;
+
+    return idx1->node == idx2->node;
+}
+
+/**
+ * @brief Get hash of a user-ordered instance.
+ *
+ * @param[in] node Instance.
+ * @return Hash.
+ */
+static uint32_t
+lyd_diff_userord_idx_hash(const struct lyd_node *node)
+{
+    return lyht_hash((const char *)&node, sizeof node);
+}
+
+/**
+ * @brief Get the index of a linked user-ordered instance.
+ *
+ * @param[in] item Userord item.
+ * @param[in] node Instance.
+ * @return Index of @p node, ::LYD_DIFF_USERORD_NONE if not found.
+ */
+static uint32_t
+lyd_diff_userord_inst_idx(const struct lyd_diff_userord *item, const struct lyd_node *node)
+{
+    struct lyd_diff_userord_idx rec = {.node = node}, *match;
+
+    if (lyht_find(item->insts_ht, &rec, lyd_diff_userord_idx_hash(node), (void **)&match)) {
+        return LYD_DIFF_USERORD_NONE;
+    }
+    return match->idx;
+}
+
+/**
+ * @brief Unlink a user-ordered instance from the current order.
+ *
+ * @param[in] item Userord item.
+ * @param[in] idx Index of the instance.
+ */
+static void
+lyd_diff_userord_inst_unlink(struct lyd_diff_userord *item, uint32_t idx)
+{
+    struct lyd_diff_userord_inst *inst = &item->insts[idx];
+
+    if (inst->prev == LYD_DIFF_USERORD_NONE) {
+        item->head = inst->next;
+    } else {
+        item->insts[inst->prev].next = inst->next;
+    }
+    if (inst->next != LYD_DIFF_USERORD_NONE) {
+        item->insts[inst->next].prev = inst->prev;
+    }
+    inst->prev = LYD_DIFF_USERORD_NONE;
+    inst->next = LYD_DIFF_USERORD_NONE;
+}
+
+/**
+ * @brief Link a user-ordered instance into the current order.
+ *
+ * @param[in] item Userord item.
+ * @param[in] idx Index of the unlinked instance.
+ * @param[in] anchor Index of the instance to link after, ::LYD_DIFF_USERORD_NONE to link as the first one.
+ */
+static void
+lyd_diff_userord_inst_link(struct lyd_diff_userord *item, uint32_t idx, uint32_t anchor)
+{
+    struct lyd_diff_userord_inst *inst = &item->insts[idx];
+
+    inst->prev = anchor;
+    if (anchor == LYD_DIFF_USERORD_NONE) {
+        inst->next = item->head;
+        item->head = idx;
+    } else {
+        inst->next = item->insts[anchor].next;
+        item->insts[anchor].next = idx;
+    }
+    if (inst->next != LYD_DIFF_USERORD_NONE) {
+        item->insts[inst->next].prev = idx;
+    }
+}
+
+/**
+ * @brief Add a new user-ordered instance, not linked into the current order.
+ *
+ * @param[in] item Userord item.
+ * @param[in] node Instance to add.
+ * @param[out] idx Index of the added instance.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_diff_userord_inst_add(struct lyd_diff_userord *item, const struct lyd_node *node, uint32_t *idx)
+{
+    const struct ly_ctx *ctx = item->schema->module->ctx;
+    struct lyd_diff_userord_inst *inst;
+    struct lyd_diff_userord_idx rec;
+
+    LY_ARRAY_NEW_RET(ctx, item->insts, inst, LY_EMEM);
+    inst->node = node;
+    inst->prev = LYD_DIFF_USERORD_NONE;
+    inst->next = LYD_DIFF_USERORD_NONE;
+
+    rec.node = node;
+    rec.idx = LY_ARRAY_COUNT(item->insts) - 1;
+    LY_CHECK_ERR_RET(lyht_insert(item->insts_ht, &rec, lyd_diff_userord_idx_hash(node), NULL), LOGMEM(ctx), LY_EMEM);
+
+    *idx = rec.idx;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Learn the instances from the first tree that keep their relative order in the second tree.
+ *
+ * These are the instances of the longest increasing subsequence of the first tree positions of the instances
+ * in the second tree order. Only all the other instances need to be moved.
+ *
+ * @param[in] item Userord item with all the instances from the first tree.
+ * @param[in] second Any instance from the second tree.
+ * @param[in] options Diff options.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_diff_userord_learn_stable(struct lyd_diff_userord *item, const struct lyd_node *second, uint16_t options)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct ly_ctx *ctx = item->schema->module->ctx;
+    const struct lyd_node *first;
+    struct lyd_node *iter, *match;
+    uint32_t *seq = NULL, *tails = NULL, *prevs = NULL, count = 0, len = 0, lo, hi, mid, i, idx;
+
+    item->stable_learned = 1;
+    if (!LY_ARRAY_COUNT(item->insts)) {
+        return LY_SUCCESS;
+    }
+    first = lyd_first_sibling(item->insts[0].node);
+
+    /* first tree indexes of the matching instances in the second tree order */
+    seq = malloc(LY_ARRAY_COUNT(item->insts) * sizeof *seq);
+    LY_CHECK_ERR_GOTO(!seq, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    LYD_LIST_FOR_INST(lyd_first_sibling(second), item->schema, iter) {
+        if ((iter->flags & LYD_DEFAULT) && !(options & LYD_DIFF_DEFAULTS)) {
+            continue;
+        }
+
+        rc = lyd_find_sibling_first_(first, iter, &match);
+        if (rc == LY_ENOTFOUND) {
+            rc = LY_SUCCESS;
+            continue;
+        }
+        LY_CHECK_GOTO(rc, cleanup);
+        if ((match->flags & LYD_DEFAULT) && !(options & LYD_DIFF_DEFAULTS)) {
+            continue;
+        }
+
+        idx = lyd_diff_userord_inst_idx(item, match);
+        if ((idx != LYD_DIFF_USERORD_NONE) && (count < LY_ARRAY_COUNT(item->insts))) {
+            seq[count++] = idx;
+        }
+    }
+    if (!count) {
+        goto cleanup;
+    }
+
+    /* longest increasing subsequence, tails[k] is the subsequence of length k + 1 with the smallest last index */
+    tails = malloc(count * sizeof *tails);
+    prevs = malloc(count * sizeof *prevs);
+    LY_CHECK_ERR_GOTO(!tails || !prevs, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    for (i = 0; i < count; ++i) {
+        lo = 0;
+        hi = len;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (seq[tails[mid]] < seq[i]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        prevs[i] = lo ? tails[lo - 1] : LYD_DIFF_USERORD_NONE;
+        tails[lo] = i;
+        if (lo == len) {
+            ++len;
+        }
+    }
+
+    for (i = tails[len - 1]; i != LYD_DIFF_USERORD_NONE; i = prevs[i]) {
+        item->insts[seq[i]].stable = 1;
+    }
+
+cleanup:
+    free(seq);
+    free(tails);
+    free(prevs);
+    return rc;
+}
+
 /**
  * @brief Get a userord entry for a specific user-ordered list/leaf-list. Create if does not exist yet.
  *
@@ -513,6 +729,7 @@ lyd_diff_userord_get(const struct lyd_node *first, const struct lysc_node *schem
     struct lyd_node *iter;
     const struct lyd_node **node;
     LY_ARRAY_COUNT_TYPE u;
+    uint32_t idx, prev;
 
     LY_ARRAY_FOR(*userord, u) {
         if ((*userord)[u].schema == schema) {
@@ -526,6 +743,24 @@ lyd_diff_userord_get(const struct lyd_node *first, const struct lysc_node *schem
     item->schema = schema;
     item->pos = 0;
     item->inst = NULL;
+    item->head = LYD_DIFF_USERORD_NONE;
+    item->last = LYD_DIFF_USERORD_NONE;
+
+    if (!lysc_is_dup_inst_list(schema)) {
+        /* link all the instances in the current order */
+        item->insts_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_diff_userord_idx), lyd_diff_userord_idx_equal_cb,
+                NULL, 1);
+        LY_CHECK_ERR_RET(!item->insts_ht, LOGMEM(schema->module->ctx), NULL);
+        if (first) {
+            prev = LYD_DIFF_USERORD_NONE;
+            LYD_LIST_FOR_INST(lyd_first_sibling(first), first->schema, iter) {
+                LY_CHECK_RET(lyd_diff_userord_inst_add(item, iter, &idx), NULL);
+                lyd_diff_userord_inst_link(item, idx, prev);
+                prev = idx;
+            }
+        }
+        return item;
+    }
 
     /* store all the instance pointers in the current order */
     if (first) {
@@ -650,8 +885,10 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
 {
     LY_ERR rc = LY_SUCCESS;
     const struct lysc_node *schema;
+    const struct lyd_node *anchor = NULL, *orig_anchor = NULL;
     size_t buflen, bufused;
-    uint32_t first_pos, second_pos, comp_opts;
+    uint32_t first_pos = 0, second_pos = 0, first_idx = LYD_DIFF_USERORD_NONE, anchor_idx, second_idx;
+    ly_bool moved;
 
     assert(first || second);
 
@@ -666,41 +903,74 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     schema = first ? first->schema : second->schema;
     assert(lysc_is_userordered(schema));
 
-    /* find user-ordered first position */
-    if (first) {
-        for (first_pos = 0; first_pos < LY_ARRAY_COUNT(userord_item->inst); ++first_pos) {
-            if (userord_item->inst[first_pos] == first) {
-                break;
+    if (lysc_is_dup_inst_list(schema)) {
+        /* find user-ordered first position */
+        if (first) {
+            for (first_pos = 0; first_pos < LY_ARRAY_COUNT(userord_item->inst); ++first_pos) {
+                if (userord_item->inst[first_pos] == first) {
+                    break;
+                }
+            }
+            assert(first_pos < LY_ARRAY_COUNT(userord_item->inst));
+            if (first_pos) {
+                orig_anchor = userord_item->inst[first_pos - 1];
             }
         }
-        assert(first_pos < LY_ARRAY_COUNT(userord_item->inst));
+
+        /* prepare position of the next instance */
+        second_pos = userord_item->pos++;
+        if (second_pos) {
+            anchor = userord_item->inst[second_pos - 1];
+        }
+
+        /* in first, there may be a different instance on the second position, we are going to move 'first' node */
+        moved = (first && second && lyd_compare_single(second, userord_item->inst[second_pos], LYD_COMPARE_FULL_RECURSION)) ?
+                1 : 0;
+        anchor_idx = LYD_DIFF_USERORD_NONE;
     } else {
-        first_pos = 0;
-    }
+        if ((options & LYD_DIFF_MIN_MOVES) && second && !userord_item->stable_learned) {
+            LY_CHECK_RET(lyd_diff_userord_learn_stable(userord_item, second, options));
+        }
+
+        /* find the first instance and its previous instance in the current order */
+        if (first) {
+            first_idx = lyd_diff_userord_inst_idx(userord_item, first);
+            assert(first_idx != LYD_DIFF_USERORD_NONE);
+            if (userord_item->insts[first_idx].prev != LYD_DIFF_USERORD_NONE) {
+                orig_anchor = userord_item->insts[userord_item->insts[first_idx].prev].node;
+            }
+        }
+
+        /* the instance is to be placed after the last handled instance from the second tree */
+        anchor_idx = userord_item->last;
+        if (anchor_idx != LYD_DIFF_USERORD_NONE) {
+            anchor = userord_item->insts[anchor_idx].node;
+        }
 
-    /* prepare position of the next instance */
-    second_pos = userord_item->pos++;
+        /* move only the instances that are not already in place (and do not keep their relative order) */
+        moved = (first && second && !userord_item->insts[first_idx].stable &&
+                (userord_item->insts[first_idx].prev != anchor_idx)) ? 1 : 0;
+        if (first && second) {
+            userord_item->last = first_idx;
+        }
+    }
 
     /* learn operation first */
     if (!second) {
         *op = LYD_DIFF_OP_DELETE;
     } else if (!first) {
         *op = LYD_DIFF_OP_CREATE;
+    } else if (moved) {
+        *op = LYD_DIFF_OP_REPLACE;
+    } else if ((options & LYD_DIFF_DEFAULTS) && ((first->flags & LYD_DEFAULT) != (second->flags & LYD_DEFAULT))) {
+        /* default flag change */
+        *op = LYD_DIFF_OP_NONE;
+    } else if ((options & LYD_DIFF_META) && lyd_diff_node_metadata_check(first, second)) {
+        /* metadata changes */
+        *op = LYD_DIFF_OP_NONE;
     } else {
-        comp_opts = lysc_is_dup_inst_list(second->schema) ? LYD_COMPARE_FULL_RECURSION : 0;
-        if (lyd_compare_single(second, userord_item->inst[second_pos], comp_opts)) {
-            /* in first, there is a different instance on the second position, we are going to move 'first' node */
-            *op = LYD_DIFF_OP_REPLACE;
-        } else if ((options & LYD_DIFF_DEFAULTS) && ((first->flags & LYD_DEFAULT) != (second->flags & LYD_DEFAULT))) {
-            /* default flag change */
-            *op = LYD_DIFF_OP_NONE;
-        } else if ((options & LYD_DIFF_META) && lyd_diff_node_metadata_check(first, second)) {
-            /* metadata changes */
-            *op = LYD_DIFF_OP_NONE;
-        } else {
-            /* no changes */
-            return LY_ENOT;
-        }
+        /* no changes */
+        return LY_ENOT;
     }
 
     /*
@@ -719,8 +989,8 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     /* value */
     if ((schema->nodetype == LYS_LEAFLIST) && !lysc_is_dup_inst_list(schema) &&
             ((*op == LYD_DIFF_OP_REPLACE) || (*op == LYD_DIFF_OP_CREATE))) {
-        if (second_pos) {
-            *value = strdup(lyd_get_value(userord_item->inst[second_pos - 1]));
+        if (anchor) {
+            *value = strdup(lyd_get_value(anchor));
             LY_CHECK_ERR_GOTO(!*value, LOGMEM(schema->module->ctx); rc = LY_EMEM, cleanup);
         } else {
             *value = strdup("");
@@ -731,8 +1001,8 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     /* orig-value */
     if ((schema->nodetype == LYS_LEAFLIST) && !lysc_is_dup_inst_list(schema) &&
             ((*op == LYD_DIFF_OP_REPLACE) || (*op == LYD_DIFF_OP_DELETE))) {
-        if (first_pos) {
-            *orig_value = strdup(lyd_get_value(userord_item->inst[first_pos - 1]));
+        if (orig_anchor) {
+            *orig_value = strdup(lyd_get_value(orig_anchor));
             LY_CHECK_ERR_GOTO(!*orig_value, LOGMEM(schema->module->ctx); rc = LY_EMEM, cleanup);
         } else {
             *orig_value = strdup("");
@@ -743,9 +1013,9 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     /* key */
     if ((schema->nodetype == LYS_LIST) && !lysc_is_dup_inst_list(schema) &&
             ((*op == LYD_DIFF_OP_REPLACE) || (*op == LYD_DIFF_OP_CREATE))) {
-        if (second_pos) {
+        if (anchor) {
             buflen = bufused = 0;
-            LY_CHECK_GOTO(rc = lyd_path_list_predicate(userord_item->inst[second_pos - 1], key, &buflen, &bufused, 0), cleanup);
+            LY_CHECK_GOTO(rc = lyd_path_list_predicate(anchor, key, &buflen, &bufused, 0), cleanup);
         } else {
             *key = strdup("");
             LY_CHECK_ERR_GOTO(!*key, LOGMEM(schema->module->ctx); rc = LY_EMEM, cleanup);
@@ -755,9 +1025,9 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     /* orig-key */
     if ((schema->nodetype == LYS_LIST) && !lysc_is_dup_inst_list(schema) &&
             ((*op == LYD_DIFF_OP_REPLACE) || (*op == LYD_DIFF_OP_DELETE))) {
-        if (first_pos) {
+        if (orig_anchor) {
             buflen = bufused = 0;
-            LY_CHECK_GOTO(rc = lyd_path_list_predicate(userord_item->inst[first_pos - 1], orig_key, &buflen, &bufused, 0), cleanup);
+            LY_CHECK_GOTO(rc = lyd_path_list_predicate(orig_anchor, orig_key, &buflen, &bufused, 0), cleanup);
         } else {
             *orig_key = strdup("");
             LY_CHECK_ERR_GOTO(!*orig_key, LOGMEM(schema->module->ctx); rc = LY_EMEM, cleanup);
@@ -795,6 +1065,23 @@ lyd_diff_userord_attrs(const struct lyd_node *first, const struct lyd_node *seco
     /*
      * update our instances - apply the change
      */
+    if (!lysc_is_dup_inst_list(schema)) {
+        if (*op == LYD_DIFF_OP_CREATE) {
+            /* link the created instance */
+            LY_CHECK_GOTO(rc = lyd_diff_userord_inst_add(userord_item, second, &second_idx), cleanup);
+            lyd_diff_userord_inst_link(userord_item, second_idx, anchor_idx);
+            userord_item->last = second_idx;
+        } else if (*op == LYD_DIFF_OP_DELETE) {
+            /* unlink the instance */
+            lyd_diff_userord_inst_unlink(userord_item, first_idx);
+        } else if (*op == LYD_DIFF_OP_REPLACE) {
+            /* move the instance after the previous one from the second tree */
+            lyd_diff_userord_inst_unlink(userord_item, first_idx);
+            lyd_diff_userord_inst_link(userord_item, first_idx, anchor_idx);
+        }
+        goto cleanup;
+    }
+
     if (*op == LYD_DIFF_OP_CREATE) {
         /* insert the instance */
         LY_ARRAY_CREATE_GOTO(schema->module->ctx, userord_item->inst, 1, rc, cleanup);
@@ -952,6 +1239,7 @@ lyd_diff_attrs(const struct lyd_node *first, const struct lyd_node *second, uint
  * @brief Find a matching instance of a node in a data tree.
  *
  * @param[in] siblings Siblings to search in.
+ * @param[in] parent Parent of @p siblings to search its virtual default leaves in, if any.
  * @param[in] target Target node to search for.
  * @param[in] defaults Whether to consider (or ignore) default values.
  * @param[in,out] dup_inst_ht Duplicate instance cache.
@@ -959,8 +1247,8 @@ lyd_diff_attrs(const struct lyd_node *first, const struct lyd_node *second, uint
  * @return LY_ERR value.
  */
 static LY_ERR
-lyd_diff_find_match(const struct lyd_node *siblings, const struct lyd_node *target, ly_bool defaults,
-        struct ly_ht **dup_inst_ht, struct lyd_node **match)
+lyd_diff_find_match(const struct lyd_node *siblings, const struct lyd_node *parent, const struct lyd_node *target,
+        ly_bool defaults, struct ly_ht **dup_inst_ht, struct lyd_node **match)
 {
     LY_ERR r;
 
@@ -969,10 +1257,10 @@ lyd_diff_find_match(const struct lyd_node *siblings, const struct lyd_node *targ
         r = lyd_find_sibling_opaq_next(siblings, LYD_NAME(target), match);
     } else if (target->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
         /* try to find the exact instance */
-        r = lyd_find_sibling_first(siblings, target, match);
+        r = lyd_find_sibling_first_(siblings, target, match);
     } else {
         /* try to simply find the node, there cannot be more instances */
-        r = lyd_find_sibling_val(siblings, target->schema, NULL, 0, match);
+        r = lyd_find_sibling_val_(siblings, target->schema, NULL, 0, match);
     }
     if (r && (r != LY_ENOTFOUND)) {
         return r;
@@ -981,6 +1269,14 @@ lyd_diff_find_match(const struct lyd_node *siblings, const struct lyd_node *targ
     /* update match as needed */
     LY_CHECK_RET(lyd_dup_inst_next(match, siblings, dup_inst_ht));
 
+    if (!*match && defaults && parent && target->schema && (target->schema->nodetype == LYS_LEAF)) {
+        /* may be a virtual default leaf */
+        r = lyd_dflt_virtual_get(parent, target->schema, match);
+        if (r && (r != LY_ENOTFOUND)) {
+            return r;
+        }
+    }
+
     if (*match && ((*match)->flags & LYD_DEFAULT) && !defaults) {
         /* ignore default nodes */
         *match = NULL;
@@ -1142,8 +1438,8 @@ lyd_diff_node_metadata_r(const struct lyd_node *first_subtree, const struct lyd_
             break;
         }
 
-        lyd_find_sibling_first(lyd_child(first_subtree), diff_node, &first);
-        lyd_find_sibling_first(lyd_child(second_subtree), diff_node, &second);
+        lyd_find_sibling_first_(lyd_child(first_subtree), diff_node, &first);
+        lyd_find_sibling_first_(lyd_child(second_subtree), diff_node, &second);
         LY_CHECK_RET(lyd_diff_node_metadata_r(first, second, keys_only, diff_node));
     }
 
@@ -1185,15 +1481,17 @@ lyd_diff_node_metadata_r(const struct lyd_node *first_subtree, const struct lyd_
  * they can safely be used as anchors for the later operations.
  *
  * @param[in] first First tree first sibling.
+ * @param[in] parent_first Parent of @p first, if any.
  * @param[in] second Second tree first sibling.
+ * @param[in] parent_second Parent of @p second, if any.
  * @param[in] options Diff options.
  * @param[in] nosiblings Whether to skip following siblings.
  * @param[in,out] diff Diff to append to.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *second, uint16_t options, ly_bool nosiblings,
-        struct lyd_node **diff)
+lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *parent_first, const struct lyd_node *second,
+        const struct lyd_node *parent_second, uint16_t options, ly_bool nosiblings, struct lyd_node **diff)
 {
     LY_ERR rc = LY_SUCCESS, r;
     const struct lyd_node *iter_first, *iter_second;
@@ -1220,7 +1518,7 @@ lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *second,
         diff_node = NULL;
 
         /* find a match in the second tree */
-        LY_CHECK_GOTO(rc = lyd_diff_find_match(second, iter_first, options & LYD_DIFF_DEFAULTS, &dup_inst_second,
+        LY_CHECK_GOTO(rc = lyd_diff_find_match(second, parent_second, iter_first, options & LYD_DIFF_DEFAULTS, &dup_inst_second,
                 &match_second), cleanup);
 
         if (lysc_is_userordered(iter_first->schema)) {
@@ -1273,8 +1571,8 @@ lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *second,
             }
 
             /* check descendants, if any, recursively */
-            LY_CHECK_GOTO(rc = lyd_diff_siblings_r(lyd_child_no_keys(iter_first), lyd_child_no_keys(match_second),
-                    options, 0, diff), cleanup);
+            LY_CHECK_GOTO(rc = lyd_diff_siblings_r(lyd_child_no_keys(iter_first), iter_first,
+                    lyd_child_no_keys(match_second), match_second, options, 0, diff), cleanup);
         } else {
             if ((options & LYD_DIFF_META) && diff_node) {
                 /* create metadata diff for the node and all its descendants */
@@ -1307,7 +1605,7 @@ lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *second,
         diff_node = NULL;
 
         /* find a match in the first tree */
-        LY_CHECK_GOTO(rc = lyd_diff_find_match(first, iter_second, options & LYD_DIFF_DEFAULTS, &dup_inst_first,
+        LY_CHECK_GOTO(rc = lyd_diff_find_match(first, parent_first, iter_second, options & LYD_DIFF_DEFAULTS, &dup_inst_first,
                 &match_first), cleanup);
 
         if (lysc_is_userordered(iter_second->schema)) {
@@ -1343,6 +1641,19 @@ lyd_diff_siblings_r(const struct lyd_node *first, const struct lyd_node *second,
             rc = lyd_diff_add(iter_second, op, orig_default, orig_value, NULL, NULL, NULL, NULL, NULL, diff, &diff_node);
             free(orig_value);
             LY_CHECK_GOTO(rc, cleanup);
+        } else if (match_first->flags & LYD_DFLT_VIRTUAL) {
+            /* virtual default leaf was not iterated over, get all the attributes */
+            r = lyd_diff_attrs(match_first, iter_second, options, &op, &orig_default, &orig_value);
+            if (r && (r != LY_ENOT)) {
+                goto cleanup;
+            }
+
+            /* add into diff if there are any changes */
+            if (!r) {
+                rc = lyd_diff_add(iter_second, op, orig_default, orig_value, NULL, NULL, NULL, NULL, NULL, diff, &diff_node);
+                free(orig_value);
+                LY_CHECK_GOTO(rc, cleanup);
+            }
         } /* else was handled */
 
         if ((options & LYD_DIFF_META) && diff_node) {
@@ -1360,6 +1671,8 @@ cleanup:
     lyd_dup_inst_free(dup_inst_second);
     LY_ARRAY_FOR(userord, u) {
         LY_ARRAY_FREE(userord[u].inst);
+        LY_ARRAY_FREE(userord[u].insts);
+        lyht_free(userord[u].insts_ht, NULL);
     }
     LY_ARRAY_FREE(userord);
     if (rc) {
@@ -1392,7 +1705,12 @@ lyd_diff(const struct lyd_node *first, const struct lyd_node *second, uint16_t o
 
     *diff = NULL;
 
-    return lyd_diff_siblings_r(first, second, options, nosiblings, diff);
+    /* lazily parsed LYB subtrees are compared as well */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(first));
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(second));
+
+    return lyd_diff_siblings_r(first, first ? lyd_parent(first) : NULL, second, second ? lyd_parent(second) : NULL,
+            options, nosiblings, diff);
 }
 
 LIBYANG_API_DEF LY_ERR
@@ -1475,7 +1793,7 @@ lyd_diff_insert(struct lyd_node **first_node, struct lyd_node *parent_node, stru
                 return LY_EINVAL;
             }
         } else {
-            ret = lyd_find_sibling_val(*first_node, new_node->schema, userord_anchor, 0, &anchor);
+            ret = lyd_find_sibling_val_(*first_node, new_node->schema, userord_anchor, 0, &anchor);
             if (ret == LY_ENOTFOUND) {
                 LOGERR(LYD_CTX(new_node), LY_EINVAL, "Node \"%s\" instance to insert next to not found.",
                         new_node->schema->name);
@@ -1493,7 +1811,7 @@ lyd_diff_insert(struct lyd_node **first_node, struct lyd_node *parent_node, stru
         }
     } else {
         /* find the first instance */
-        ret = lyd_find_sibling_val(*first_node, new_node->schema, NULL, 0, &anchor);
+        ret = lyd_find_sibling_val_(*first_node, new_node->schema, NULL, 0, &anchor);
         LY_CHECK_RET(ret && (ret != LY_ENOTFOUND), ret);
 
         if (anchor) {
@@ -1784,7 +2102,7 @@ lyd_diff_apply_r(struct lyd_node **first_node, struct lyd_node *parent_node, con
     if (lysc_is_userordered(diff_node->schema) && ((op == LYD_DIFF_OP_CREATE) || (op == LYD_DIFF_OP_REPLACE))) {
         if (op == LYD_DIFF_OP_REPLACE) {
             /* find the node (we must have some siblings because the node was only moved) */
-            LY_CHECK_RET(lyd_diff_find_match(*first_node, diff_node, 1, dup_inst, &match));
+            LY_CHECK_RET(lyd_diff_find_match(*first_node, NULL, diff_node, 1, dup_inst, &match));
             LY_CHECK_ERR_RET(!match, LOGERR_NOINST(ctx, diff_node), LY_EINVAL);
         } else {
             /* duplicate the node */
@@ -1820,7 +2138,7 @@ lyd_diff_apply_r(struct lyd_node **first_node, struct lyd_node *parent_node, con
         switch (op) {
         case LYD_DIFF_OP_NONE:
             /* find the node */
-            LY_CHECK_RET(lyd_diff_find_match(*first_node, diff_node, 1, dup_inst, &match));
+            LY_CHECK_RET(lyd_diff_find_match(*first_node, NULL, diff_node, 1, dup_inst, &match));
             LY_CHECK_ERR_RET(!match, LOGERR_NOINST(ctx, diff_node), LY_EINVAL);
 
             if (match->schema->nodetype & LYD_NODE_TERM) {
@@ -1854,7 +2172,7 @@ lyd_diff_apply_r(struct lyd_node **first_node, struct lyd_node *parent_node, con
             break;
         case LYD_DIFF_OP_DELETE:
             /* find the node */
-            LY_CHECK_RET(lyd_diff_find_match(*first_node, diff_node, 1, dup_inst, &match));
+            LY_CHECK_RET(lyd_diff_find_match(*first_node, NULL, diff_node, 1, dup_inst, &match));
             LY_CHECK_ERR_RET(!match, LOGERR_NOINST(ctx, diff_node), LY_EINVAL);
 
             /* remove it */
@@ -1875,7 +2193,7 @@ lyd_diff_apply_r(struct lyd_node **first_node, struct lyd_node *parent_node, con
             }
 
             /* find the node */
-            LY_CHECK_RET(lyd_diff_find_match(*first_node, diff_node, 1, dup_inst, &match));
+            LY_CHECK_RET(lyd_diff_find_match(*first_node, NULL, diff_node, 1, dup_inst, &match));
             LY_CHECK_ERR_RET(!match, LOGERR_NOINST(ctx, diff_node), LY_EINVAL);
 
             /* update the value */
@@ -1924,6 +2242,10 @@ lyd_diff_apply_module(struct lyd_node **data, const struct lyd_node *diff, const
     struct ly_ht *dup_inst = NULL;
     LY_ERR ret = LY_SUCCESS;
 
+    /* the diff is applied on fully parsed data */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(*data));
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(diff));
+
     LY_LIST_FOR(diff, root) {
         if (mod && (lyd_owner_module(root) != mod)) {
             /* skip data nodes from different modules */
@@ -1947,6 +2269,23 @@ lyd_diff_apply_all(struct lyd_node **data, const struct lyd_node *diff)
     return lyd_diff_apply_module(data, diff, NULL, NULL, NULL);
 }
 
+LIBYANG_API_DEF LY_ERR
+lyd_diff_apply_lyb(const struct ly_ctx *ctx, struct ly_in *in, struct lyd_node **data)
+{
+    LY_ERR rc;
+    struct lyd_node *diff = NULL;
+
+    LY_CHECK_ARG_RET(ctx, ctx, in, data, LY_EINVAL);
+    LY_CHECK_CTX_EQUAL_RET(__func__, ctx, *data ? LYD_CTX(*data) : NULL, LY_EINVAL);
+
+    /* the diff was printed from valid data in the schema order, just store it */
+    LY_CHECK_RET(lyd_parse_data(ctx, NULL, in, LYD_LYB, LYD_PARSE_STORE_ONLY | LYD_PARSE_ORDERED, 0, &diff));
+
+    rc = lyd_diff_apply_module(data, diff, NULL, NULL, NULL);
+    lyd_free_siblings(diff);
+    return rc;
+}
+
 /**
  * @brief Update operations on a diff node when the new operation is NONE.
  *
@@ -2362,9 +2701,9 @@ lyd_diff_merge_delete(struct lyd_node *diff_match, enum lyd_diff_op cur_op, cons
             if (!child->schema) {
                 r = lyd_find_sibling_opaq_next(lyd_child(src_diff), LYD_NAME(child), NULL);
             } else if (child->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
-                r = lyd_find_sibling_first(lyd_child(src_diff), child, NULL);
+                r = lyd_find_sibling_first_(lyd_child(src_diff), child, NULL);
             } else {
-                r = lyd_find_sibling_val(lyd_child(src_diff), child->schema, NULL, 0, NULL);
+                r = lyd_find_sibling_val_(lyd_child(src_diff), child->schema, NULL, 0, NULL);
             }
             if (!r) {
                 LY_CHECK_RET(lyd_diff_change_op(child, cur_op));
@@ -2705,7 +3044,7 @@ lyd_diff_merge_r(const struct lyd_node *src_diff, struct lyd_node *diff_parent,
     LY_CHECK_RET(lyd_diff_get_op(src_diff, &src_op, NULL));
 
     /* find an equal node in the current diff */
-    LY_CHECK_RET(lyd_diff_find_match(diff_parent ? lyd_child_no_keys(diff_parent) : *diff, src_diff, 1, dup_inst, &diff_node));
+    LY_CHECK_RET(lyd_diff_find_match(diff_parent ? lyd_child_no_keys(diff_parent) : *diff, NULL, src_diff, 1, dup_inst, &diff_node));
 
     if (diff_node) {
         /* get target (current) operation */
@@ -19,15 +19,37 @@
 
 #include "log.h"
 
+struct ly_ht;
 struct lyd_node;
 
+/**
+ * @brief Internal structure for an instance in the current (virtual) user-ordered instances order.
+ */
+struct lyd_diff_userord_inst {
+    const struct lyd_node *node;    /**< Instance from the first tree or created instance from the second tree. */
+    uint32_t prev;                  /**< Index of the previous instance, ::LYD_DIFF_USERORD_NONE for the first one. */
+    uint32_t next;                  /**< Index of the next instance, ::LYD_DIFF_USERORD_NONE for the last one. */
+    ly_bool stable;                 /**< Set if the instance keeps its relative order and need not be moved. */
+};
+
+#define LYD_DIFF_USERORD_NONE UINT32_MAX    /**< no instance index */
+
 /**
  * @brief Internal structure for storing current (virtual) user-ordered instances order.
+ *
+ * Lists with duplicate instances use the array of instances with their positions, all the other lists
+ * and leaf-lists use the linked instances with a hash table of their indexes.
  */
 struct lyd_diff_userord {
     const struct lysc_node *schema; /**< User-ordered list/leaf-list schema node. */
     uint64_t pos;                   /**< Current position in the second tree. */
-    const struct lyd_node **inst;   /**< Sized array of current instance order. */
+    const struct lyd_node **inst;   /**< Sized array of current instance order, lists with duplicate instances. */
+
+    struct lyd_diff_userord_inst *insts;    /**< Sized array of linked instances, in the order they were added. */
+    struct ly_ht *insts_ht;         /**< Hash table of the instance indexes in lyd_diff_userord.insts. */
+    uint32_t head;                  /**< Index of the first instance in the current order. */
+    uint32_t last;                  /**< Index of the last handled instance from the second tree. */
+    ly_bool stable_learned;         /**< Whether the stable instances were already learned. */
 };
 
 /**
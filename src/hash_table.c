@@ -131,6 +131,48 @@ lyht_new(uint32_t size, uint16_t val_size, lyht_value_equal_cb val_equal, void *
     return ht;
 }
 
+/**
+ * @brief Size of a hash table structure in a preallocated memory, aligned to 8 bytes.
+ */
+#define LYHT_MEM_HT_SIZE ((sizeof(struct ly_ht) + 7) & ~(size_t)7)
+
+size_t
+lyht_mem_size(uint32_t size, uint16_t val_size)
+{
+    return LYHT_MEM_HT_SIZE + size * sizeof(struct ly_ht_hlist) + (size_t)size * (SIZEOF_LY_HT_REC + val_size);
+}
+
+struct ly_ht *
+lyht_new_mem(void *mem, uint32_t size, uint16_t val_size, lyht_value_equal_cb val_equal, void *cb_data)
+{
+    struct ly_ht *ht = mem;
+    struct ly_ht_rec *rec;
+    uint32_t i;
+
+    assert(size && !(size & (size - 1)));
+    assert(val_equal && val_size);
+
+    ht->used = 0;
+    ht->size = size;
+    ht->val_equal = val_equal;
+    ht->cb_data = cb_data;
+    ht->resize = 0;
+    ht->rec_size = SIZEOF_LY_HT_REC + val_size;
+
+    /* the hlists and records follow the structure */
+    ht->hlists = (struct ly_ht_hlist *)((char *)mem + LYHT_MEM_HT_SIZE);
+    ht->recs = (unsigned char *)(ht->hlists + size);
+    for (i = 0; i < size; i++) {
+        ht->hlists[i].first = LYHT_NO_RECORD;
+        ht->hlists[i].last = LYHT_NO_RECORD;
+        rec = lyht_get_rec(ht->recs, ht->rec_size, i);
+        rec->next = i + 1;
+    }
+    ht->first_free_rec = 0;
+
+    return ht;
+}
+
 LIBYANG_API_DEF lyht_value_equal_cb
 lyht_set_cb(struct ly_ht *ht, lyht_value_equal_cb new_val_equal)
 {
@@ -166,6 +208,7 @@ lyht_dup(const struct ly_ht *orig)
     memcpy(ht->hlists, orig->hlists, sizeof(ht->hlists[0]) * orig->size);
     memcpy(ht->recs, orig->recs, (size_t)orig->size * orig->rec_size);
     ht->used = orig->used;
+    ht->first_free_rec = orig->first_free_rec;
     return ht;
 }
 
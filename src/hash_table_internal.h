@@ -113,6 +113,30 @@ lyht_get_rec(unsigned char *recs, uint16_t rec_size, uint32_t idx)
     for (hlist_idx = 0; hlist_idx < ht->size; hlist_idx++)           \
         LYHT_ITER_HLIST_RECS(ht, hlist_idx, rec_idx, rec)
 
+/**
+ * @brief Get the size of the memory needed for a hash table created by ::lyht_new_mem().
+ *
+ * @param[in] size Number of records, must be a power of 2.
+ * @param[in] val_size Size in bytes of value (the stored hashed item).
+ * @return Size of the memory in bytes.
+ */
+size_t lyht_mem_size(uint32_t size, uint16_t val_size);
+
+/**
+ * @brief Initialize a hash table in a preallocated memory.
+ *
+ * The hash table is never resized so it can store at most @p size values. It must not be freed by ::lyht_free(),
+ * only the memory itself is freed.
+ *
+ * @param[in] mem Memory of the size learned by ::lyht_mem_size(), aligned to 8 bytes.
+ * @param[in] size Number of records, must be a power of 2.
+ * @param[in] val_size Size in bytes of value (the stored hashed item).
+ * @param[in] val_equal Callback for checking value equivalence.
+ * @param[in] cb_data User data always passed to @p val_equal.
+ * @return Initialized hash table.
+ */
+struct ly_ht *lyht_new_mem(void *mem, uint32_t size, uint16_t val_size, lyht_value_equal_cb val_equal, void *cb_data);
+
 /**
  * @brief Dictionary hash table record.
  */
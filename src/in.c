@@ -168,6 +168,17 @@ ly_in_new_memory(const char *str, struct ly_in **in)
     return LY_SUCCESS;
 }
 
+LIBYANG_API_DEF LY_ERR
+ly_in_new_memory_len(const char *data, size_t len, struct ly_in **in)
+{
+    LY_CHECK_ARG_RET(NULL, data, len, in, LY_EINVAL);
+
+    LY_CHECK_RET(ly_in_new_memory(data, in));
+    (*in)->length = len;
+
+    return LY_SUCCESS;
+}
+
 LIBYANG_API_DEF const char *
 ly_in_memory(struct ly_in *in, const char *str)
 {
@@ -179,6 +190,7 @@ ly_in_memory(struct ly_in *in, const char *str)
 
     if (str) {
         in->start = in->current = str;
+        in->length = 0;
         in->line = 1;
     }
 
@@ -53,6 +53,7 @@ extern "C" {
  * - ::ly_in_new_file()
  * - ::ly_in_new_filepath()
  * - ::ly_in_new_memory()
+ * - ::ly_in_new_memory_len()
  *
  * - ::ly_in_fd()
  * - ::ly_in_file()
@@ -171,6 +172,21 @@ LIBYANG_API_DECL FILE *ly_in_file(struct ly_in *in, FILE *f);
  */
 LIBYANG_API_DECL LY_ERR ly_in_new_memory(const char *str, struct ly_in **in);
 
+/**
+ * @brief Create input handler using memory of a known length to read data.
+ *
+ * Useful for binary data, such as ::LYD_CBOR, which are not NULL-terminated and whose encoded lengths are then checked
+ * against @p len instead of being trusted.
+ *
+ * @param[in] data Pointer where to start reading data. Note that in case the destroy argument of ::ly_in_free() is used,
+ * the input data are passed to free().
+ * @param[in] len Length of @p data.
+ * @param[out] in Created input handler supposed to be passed to different ly*_parse() functions.
+ * @return LY_SUCCESS in case of success
+ * @return LY_ERR value in case of failure.
+ */
+LIBYANG_API_DECL LY_ERR ly_in_new_memory_len(const char *data, size_t len, struct ly_in **in);
+
 /**
  * @brief Get or change memory where the data are read from.
  *
@@ -26,7 +26,7 @@ struct ly_in {
     const char *current;    /**< Current position in the input data */
     const char *func_start; /**< Input data position when the last parser function was executed */
     const char *start;      /**< Input data start */
-    size_t length;          /**< mmap() length (if used) */
+    size_t length;          /**< mmap() length (if used) or length of the memory, 0 if unknown */
 
     union {
         int fd;             /**< file descriptor for LY_IN_FD type */
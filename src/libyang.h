@@ -162,6 +162,12 @@ extern "C" {
  * Data trees are not internally synchronized so the general safe practice of a single writer **or** several concurrent
  * readers should be followed. Specifically, only the functions with non-const ::lyd_node parameters modify the node(s)
  * and no concurrent execution of such functions should be allowed on a single data tree or subtrees of one.
+ *
+ * Any number of threads can read a single data tree concurrently, which includes getting node values
+ * (::lyd_get_value(), ::lyd_value_get_canonical()), searching (`lyd_find_*()` functions), evaluating XPath
+ * (::lyd_find_xpath(), ::lyd_eval_xpath()), and printing (`lyd_print_*()` functions). Caches filled on demand
+ * by these functions, such as canonical values of some types or records of secondary indexes (::lyd_index_add()),
+ * are published atomically or guarded by a context lock.
  */
 
 /**
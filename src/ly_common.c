@@ -34,6 +34,9 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 #include "compat.h"
 #include "tree_schema_internal.h"
@@ -120,6 +123,65 @@ ly_strncmp(const char *refstr, const char *str, size_t str_len)
     }
 }
 
+/**
+ * @brief Check whether a character is rejected by ::ly_strncspn().
+ *
+ * @param[in] c Character to check.
+ * @param[in] reject Rejected characters.
+ * @param[in] cntrl Whether control characters are rejected as well.
+ * @return Whether the character is rejected.
+ */
+static ly_bool
+ly_strncspn_reject(unsigned char c, const char *reject, ly_bool cntrl)
+{
+    if (cntrl && ((c < 0x20) || (c == 0x7f))) {
+        return 1;
+    }
+    return strchr(reject, c) ? 1 : 0;
+}
+
+size_t
+ly_strncspn(const char *str, size_t len, const char *reject, ly_bool cntrl)
+{
+    size_t i = 0;
+
+#if defined (__SSE2__) && defined (__GNUC__)
+    __m128i chars[4], block, match, c1f, c7f;
+    size_t j, reject_len = strlen(reject);
+    uint32_t mask;
+
+    assert(reject_len <= 4);
+
+    /* the unused slots match the NULL-byte, which is rejected anyway */
+    for (j = 0; j < 4; ++j) {
+        chars[j] = _mm_set1_epi8(reject[(j < reject_len) ? j : reject_len]);
+    }
+    c1f = _mm_set1_epi8(0x1f);
+    c7f = _mm_set1_epi8(0x7f);
+
+    /* process whole 16-byte blocks, the remainder is processed by the scalar loop */
+    for ( ; i + 16 <= len; i += 16) {
+        block = _mm_loadu_si128((const __m128i *)(str + i));
+        match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, chars[0]), _mm_cmpeq_epi8(block, chars[1])),
+                _mm_or_si128(_mm_cmpeq_epi8(block, chars[2]), _mm_cmpeq_epi8(block, chars[3])));
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_setzero_si128()));
+        if (cntrl) {
+            /* unsigned (block <= 0x1f) || (block == 0x7f) */
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(_mm_min_epu8(block, c1f), block));
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, c7f));
+        }
+
+        mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for ( ; (i < len) && !ly_strncspn_reject(str[i], reject, cntrl); ++i) {}
+    return i;
+}
+
 LY_ERR
 ly_strntou8(const char *nptr, size_t len, uint8_t *ret)
 {
@@ -366,6 +366,29 @@ struct ly_ctx {
     struct ly_ht *leafref_links_ht;   /**< hash table of leafref links between term data nodes */
     struct ly_set plugins_types;      /**< context specific set of type plugins */
     struct ly_set plugins_extensions; /**< contets specific set of extension plugins */
+    struct ly_set data_indexes;       /**< set of secondary data indexes (struct lyd_index *) */
+    pthread_mutex_t data_index_lock;  /**< lock for creating the records of secondary data indexes and virtual default
+                                           leaves on lookups */
+    struct lyd_inst_index *inst_index; /**< index of data instances of schema nodes, if ::LY_CTX_INST_INDEX is set */
+    ATOMIC_T data_unindexed;          /**< set once any data nodes may exist that are not in ::ly_ctx.inst_index,
+                                           any later created index is then incomplete */
+    struct ly_ht *cons_states_ht;     /**< hash table of list constraint states (struct lyd_cons_state *),
+                                           if ::LY_CTX_LIST_CONSTRAINTS is set */
+    struct ly_ht *ident_closure_ht;   /**< transitive closure of identity derivation (struct lys_ident_closure_rec *),
+                                           NULL if out-of-date */
+    struct lyd_when_cache *when_cache; /**< cache of when condition results of data nodes, if ::LY_CTX_WHEN_CACHE is set */
+    struct ly_ht *dflt_virt_ht;       /**< hash table of virtual default leaves (struct lyd_dflt_virt *), created when needed */
+    struct ly_ht *child_vec_ht;       /**< hash table of children vectors of inner nodes with many children
+                                           (struct lyd_child_vec *), created when needed */
+    struct ly_ht *lyb_sibs_ht;        /**< hash table of cached LYB hashes of schema siblings (struct lyb_sibs *),
+                                           created when needed, guarded by ::ly_ctx.lyb_hash_lock */
+    struct ly_ht *lyb_stub_ht;        /**< hash table of lazily parsed LYB data nodes (struct lyd_lyb_stub *),
+                                           created when needed, guarded by ::ly_ctx.lyb_stub_lock */
+    pthread_mutex_t lyb_stub_lock;    /**< lock for parsing the children of lazily parsed LYB data nodes */
+    struct ly_set sid_items;          /**< set of loaded SID file items (struct ly_sid_item *) */
+    struct ly_ht *sid_ht;             /**< hash table of resolved SID file items by their SID (struct ly_sid_rec) */
+    struct ly_ht *sid_item_ht;        /**< hash table of resolved SID file items by their schema node or identity
+                                           (struct ly_sid_rec) */
 };
 
 /**
@@ -428,6 +451,20 @@ void *ly_realloc(void *ptr, size_t size);
  */
 char *ly_strnchr(const char *s, int c, size_t len);
 
+/**
+ * @brief Get the length of the initial segment of @p str not containing any of the @p reject characters.
+ *
+ * Uses SIMD instructions, if available, so it is suitable for finding the characters to escape in long strings.
+ * The NULL-byte is always rejected.
+ *
+ * @param[in] str String to search in.
+ * @param[in] len Length of @p str, may not be exceeded even if @p str contains a NULL-byte.
+ * @param[in] reject NULL-terminated set of at most 4 characters to find.
+ * @param[in] cntrl Whether control characters (0x00 - 0x1f and 0x7f) are rejected as well.
+ * @return Length of the initial segment, @p len if there are no rejected characters.
+ */
+size_t ly_strncspn(const char *str, size_t len, const char *reject, ly_bool cntrl);
+
 /**
  * @brief Compare NULL-terminated @p refstr with @p str_len bytes from @p str.
  *
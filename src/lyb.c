@@ -21,9 +21,28 @@
 #include <string.h>
 
 #include "compat.h"
+#include "hash_table.h"
+#include "log.h"
 #include "ly_common.h"
+#include "plugins_exts.h"
+#include "plugins_exts/metadata.h"
+#include "tree_data.h"
 #include "tree_schema.h"
 
+/**
+ * @brief Cached LYB hashes of all the schema siblings on one level.
+ */
+struct lyb_sibs {
+    const struct lysc_node *first_sibling;  /**< first schema sibling, key of the record */
+    struct ly_ht *ht;           /**< printer hash table of the siblings with their non-colliding hashes, created when needed */
+    struct lyb_sib_hash {
+        LYB_HASH hash;          /**< hash of the sibling with collision ID 0 */
+        uint32_t order;         /**< order of the sibling */
+        const struct lysc_node *node;   /**< schema sibling */
+    } *hashes;                  /**< parser lookup array of the siblings sorted by their hash, created when needed */
+    uint32_t hash_count;        /**< number of items in hashes */
+};
+
 /**
  * @brief Generate single hash for a schema node to be used for LYB data.
  *
@@ -109,3 +128,471 @@ lyb_cache_module_hash(const struct lys_module *mod)
     /* UNLOCK */
     pthread_mutex_unlock(&mod->ctx->lyb_hash_lock);
 }
+
+/**
+ * @brief Hash table equal callback for checking hash equality only.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyb_hash_equal_cb(void *UNUSED(val1_p), void *UNUSED(val2_p), ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    /* for this purpose, if hash matches, the value does also, we do not want 2 values to have the same hash */
+    return 1;
+}
+
+/**
+ * @brief Hash table equal callback for checking value pointer equality only.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyb_ptr_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lysc_node *val1 = *(struct lysc_node **)val1_p;
+    struct lysc_node *val2 = *(struct lysc_node **)val2_p;
+
+    if (val1 == val2) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Hash table equal callback for checking collisions.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyb_col_equal_cb(void *val1_p, void *val2_p, ly_bool mod, void *cb_data)
+{
+    /* for first value check use lyb_ptr_equal_cb, for collisions lyb_hash_equal_cb */
+    return mod ? lyb_ptr_equal_cb(val1_p, val2_p, mod, cb_data) : lyb_hash_equal_cb(val1_p, val2_p, mod, cb_data);
+}
+
+/**
+ * @brief Check that sibling collision hash is safe to insert into hash table.
+ *
+ * @param[in] ht Hash table.
+ * @param[in] sibling Hashed sibling.
+ * @param[in] ht_col_id Sibling hash collision ID.
+ * @param[in] compare_col_id Last collision ID to compare with.
+ * @return LY_SUCCESS when the whole hash sequence does not collide,
+ * @return LY_EEXIST when the whole hash sequence sollides.
+ */
+static LY_ERR
+lyb_hash_sequence_check(struct ly_ht *ht, struct lysc_node *sibling, LYB_HASH ht_col_id, LYB_HASH compare_col_id)
+{
+    struct lysc_node **col_node;
+
+    /* get the first node inserted with last hash col ID ht_col_id */
+    if (lyht_find(ht, &sibling, lyb_get_hash(sibling, ht_col_id), (void **)&col_node)) {
+        /* there is none. valid situation */
+        return LY_SUCCESS;
+    }
+
+    do {
+        int64_t j;
+
+        for (j = (int64_t)compare_col_id; j > -1; --j) {
+            if (lyb_get_hash(sibling, j) != lyb_get_hash(*col_node, j)) {
+                /* one non-colliding hash */
+                break;
+            }
+        }
+        if (j == -1) {
+            /* all whole hash sequences of nodes inserted with last hash col ID compare_col_id collide */
+            return LY_EEXIST;
+        }
+
+        /* get next node inserted with last hash col ID ht_col_id */
+    } while (!lyht_find_next_with_collision_cb(ht, col_node, lyb_get_hash(*col_node, ht_col_id), lyb_col_equal_cb,
+            (void **)&col_node));
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Hash all the siblings and add them also into a separate hash table.
+ *
+ * @param[in] sibling Any sibling in all the siblings on one level.
+ * @param[out] ht_p Created hash table.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_hash_siblings(struct lysc_node *sibling, struct ly_ht **ht_p)
+{
+    struct ly_ht *ht;
+    const struct lysc_node *parent;
+    const struct lys_module *mod;
+    LYB_HASH i;
+    uint32_t getnext_opts;
+
+    ht = lyht_new(1, sizeof(struct lysc_node *), lyb_hash_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RET(!ht, LOGMEM(sibling->module->ctx), LY_EMEM);
+
+    getnext_opts = 0;
+    if (sibling->flags & LYS_IS_OUTPUT) {
+        getnext_opts = LYS_GETNEXT_OUTPUT;
+    }
+
+    parent = lysc_data_parent(sibling);
+    mod = sibling->module;
+
+    sibling = NULL;
+    while ((sibling = (struct lysc_node *)lys_getnext(sibling, parent, mod->compiled, getnext_opts))) {
+        /* find the first non-colliding hash (or specifically non-colliding hash sequence) */
+        for (i = 0; i < LYB_HASH_BITS; ++i) {
+            /* check that we are not colliding with nodes inserted with a lower collision ID than ours */
+            int64_t j;
+
+            for (j = (int64_t)i - 1; j > -1; --j) {
+                if (lyb_hash_sequence_check(ht, sibling, (LYB_HASH)j, i)) {
+                    break;
+                }
+            }
+            if (j > -1) {
+                /* some check failed, we must use a higher collision ID */
+                continue;
+            }
+
+            /* try to insert node with the current collision ID */
+            if (!lyht_insert_with_resize_cb(ht, &sibling, lyb_get_hash(sibling, i), lyb_ptr_equal_cb, NULL)) {
+                /* success, no collision */
+                break;
+            }
+
+            /* make sure we really cannot insert it with this hash col ID (meaning the whole hash sequence is colliding) */
+            if (i && !lyb_hash_sequence_check(ht, sibling, i, i)) {
+                /* it can be inserted after all, even though there is already a node with the same last collision ID */
+                lyht_set_cb(ht, lyb_ptr_equal_cb);
+                if (lyht_insert(ht, &sibling, lyb_get_hash(sibling, i), NULL)) {
+                    LOGINT(sibling->module->ctx);
+                    lyht_set_cb(ht, lyb_hash_equal_cb);
+                    lyht_free(ht, NULL);
+                    return LY_EINT;
+                }
+                lyht_set_cb(ht, lyb_hash_equal_cb);
+                break;
+            }
+            /* there is still another colliding schema node with the same hash sequence, try higher collision ID */
+        }
+
+        if (i == LYB_HASH_BITS) {
+            /* wow */
+            LOGINT(sibling->module->ctx);
+            lyht_free(ht, NULL);
+            return LY_EINT;
+        }
+    }
+
+    /* change val equal callback so that the HT is usable for finding value hashes */
+    lyht_set_cb(ht, lyb_ptr_equal_cb);
+
+    *ht_p = ht;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Hash table equal callback for the cached siblings records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyb_sibs_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyb_sibs *val1 = *(struct lyb_sibs **)val1_p;
+    struct lyb_sibs *val2 = *(struct lyb_sibs **)val2_p;
+
+    return val1->first_sibling == val2->first_sibling;
+}
+
+/**
+ * @brief Free a cached siblings record.
+ *
+ * @param[in] val_p Pointer to the record (struct lyb_sibs **).
+ */
+static void
+lyb_sibs_rec_free(void *val_p)
+{
+    struct lyb_sibs *sibs = *(struct lyb_sibs **)val_p;
+
+    lyht_free(sibs->ht, NULL);
+    free(sibs->hashes);
+    free(sibs);
+}
+
+/**
+ * @brief Get the cached siblings record, create it if not yet cached. Context LYB hash lock is expected to be held
+ * so nothing is logged, the lock is also used for logging.
+ *
+ * @param[in] first_sibling First schema sibling.
+ * @param[out] sibs Cached siblings record.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_sibs_get(const struct lysc_node *first_sibling, struct lyb_sibs **sibs)
+{
+    struct ly_ctx *ctx = first_sibling->module->ctx;
+    struct lyb_sibs rec = {0}, *rec_p = &rec, **match_p;
+    uint32_t hash;
+
+    if (!ctx->lyb_sibs_ht) {
+        ctx->lyb_sibs_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyb_sibs *), lyb_sibs_equal_cb, NULL, 1);
+        LY_CHECK_RET(!ctx->lyb_sibs_ht, LY_EMEM);
+    }
+
+    rec.first_sibling = first_sibling;
+    hash = lyht_hash((const char *)&first_sibling, sizeof first_sibling);
+    if (!lyht_find(ctx->lyb_sibs_ht, &rec_p, hash, (void **)&match_p)) {
+        *sibs = *match_p;
+        return LY_SUCCESS;
+    }
+
+    /* new record */
+    rec_p = calloc(1, sizeof *rec_p);
+    LY_CHECK_RET(!rec_p, LY_EMEM);
+    rec_p->first_sibling = first_sibling;
+    if (lyht_insert(ctx->lyb_sibs_ht, &rec_p, hash, NULL)) {
+        free(rec_p);
+        return LY_EMEM;
+    }
+
+    *sibs = rec_p;
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lyb_sibs_get_ht(const struct lysc_node *first_sibling, struct ly_ht **ht)
+{
+    LY_ERR rc;
+    struct ly_ctx *ctx = first_sibling->module->ctx;
+    struct lyb_sibs *sibs = NULL;
+    struct ly_ht *new_ht = NULL;
+
+    *ht = NULL;
+
+    /* LOCK */
+    pthread_mutex_lock(&ctx->lyb_hash_lock);
+
+    rc = lyb_sibs_get(first_sibling, &sibs);
+    if (!rc) {
+        *ht = sibs->ht;
+    }
+
+    /* UNLOCK */
+    pthread_mutex_unlock(&ctx->lyb_hash_lock);
+
+    LY_CHECK_ERR_RET(rc, LOGMEM(ctx), rc);
+    if (*ht) {
+        return LY_SUCCESS;
+    }
+
+    /* hash all the siblings, may log so without the lock */
+    LY_CHECK_RET(lyb_hash_siblings((struct lysc_node *)first_sibling, &new_ht));
+
+    /* LOCK */
+    pthread_mutex_lock(&ctx->lyb_hash_lock);
+
+    if (!sibs->ht) {
+        sibs->ht = new_ht;
+        new_ht = NULL;
+    }
+    *ht = sibs->ht;
+
+    /* UNLOCK */
+    pthread_mutex_unlock(&ctx->lyb_hash_lock);
+
+    /* created concurrently by another thread */
+    lyht_free(new_ht, NULL);
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Compare callback for sorting the siblings by their hash and order.
+ */
+static int
+lyb_sib_hash_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct lyb_sib_hash *sib1 = ptr1, *sib2 = ptr2;
+
+    if (sib1->hash != sib2->hash) {
+        return (sib1->hash < sib2->hash) ? -1 : 1;
+    }
+    return (sib1->order < sib2->order) ? -1 : (sib1->order > sib2->order);
+}
+
+/**
+ * @brief Create the parser lookup array of siblings.
+ *
+ * @param[in] sparent Schema parent of the siblings.
+ * @param[in] mod Module of the top-level siblings.
+ * @param[in] ext Extension instance of the top-level siblings.
+ * @param[in] getnext_opts Options for getting the siblings.
+ * @param[out] hashes_p Created array of the siblings sorted by their hash.
+ * @param[out] count_p Number of items in @p hashes_p.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_sibs_hashes_create(const struct lysc_node *sparent, const struct lys_module *mod, const struct lysc_ext_instance *ext,
+        uint32_t getnext_opts, struct lyb_sib_hash **hashes_p, uint32_t *count_p)
+{
+    const struct lysc_node *sibling = NULL;
+    struct lyb_sib_hash *hashes = NULL;
+    uint32_t count = 0, size = 0;
+    void *mem;
+
+    while (1) {
+        if (!sparent && ext) {
+            sibling = lys_getnext_ext(sibling, sparent, ext, getnext_opts);
+        } else {
+            sibling = lys_getnext(sibling, sparent, mod ? mod->compiled : NULL, getnext_opts);
+        }
+        if (!sibling) {
+            break;
+        }
+
+        if (count == size) {
+            size = size ? size * 2 : 8;
+            mem = realloc(hashes, size * sizeof *hashes);
+            LY_CHECK_ERR_RET(!mem, free(hashes); LOGMEM(sibling->module->ctx), LY_EMEM);
+            hashes = mem;
+        }
+        hashes[count].hash = lyb_get_hash(sibling, 0);
+        hashes[count].order = count;
+        hashes[count].node = sibling;
+        ++count;
+    }
+
+    /* siblings with the same hash keep their order */
+    qsort(hashes, count, sizeof *hashes, lyb_sib_hash_cmp);
+
+    *hashes_p = hashes;
+    *count_p = count;
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lyb_sibs_find(const struct lysc_node *sparent, const struct lys_module *mod, const struct lysc_ext_instance *ext,
+        uint32_t getnext_opts, const LYB_HASH *hash, uint8_t hash_count, const struct lysc_node **snode)
+{
+    LY_ERR rc;
+    const struct lysc_node *first_sibling;
+    struct ly_ctx *ctx;
+    struct lyb_sibs *sibs = NULL;
+    struct lyb_sib_hash *hashes = NULL;
+    uint32_t lo, hi, mid, count = 0;
+    uint8_t i;
+
+    *snode = NULL;
+
+    if (!sparent && ext) {
+        first_sibling = lys_getnext_ext(NULL, sparent, ext, getnext_opts);
+    } else {
+        first_sibling = lys_getnext(NULL, sparent, mod ? mod->compiled : NULL, getnext_opts);
+    }
+    if (!first_sibling) {
+        /* no siblings */
+        return LY_SUCCESS;
+    }
+    ctx = first_sibling->module->ctx;
+
+    /* LOCK */
+    pthread_mutex_lock(&ctx->lyb_hash_lock);
+
+    rc = lyb_sibs_get(first_sibling, &sibs);
+    if (!rc) {
+        hashes = sibs->hashes;
+        count = sibs->hash_count;
+    }
+
+    /* UNLOCK */
+    pthread_mutex_unlock(&ctx->lyb_hash_lock);
+
+    LY_CHECK_ERR_RET(rc, LOGMEM(ctx), rc);
+    if (!hashes) {
+        /* create the lookup array, may log so without the lock */
+        LY_CHECK_RET(lyb_sibs_hashes_create(sparent, mod, ext, getnext_opts, &hashes, &count));
+
+        /* LOCK */
+        pthread_mutex_lock(&ctx->lyb_hash_lock);
+
+        if (!sibs->hashes) {
+            sibs->hashes = hashes;
+            sibs->hash_count = count;
+        } else {
+            /* created concurrently by another thread */
+            free(hashes);
+            hashes = sibs->hashes;
+            count = sibs->hash_count;
+        }
+
+        /* UNLOCK */
+        pthread_mutex_unlock(&ctx->lyb_hash_lock);
+    }
+
+    /* the first sibling with the hash, the array is not modified anymore */
+    lo = 0;
+    hi = count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (hashes[mid].hash < hash[0]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* the first one in the schema order matching all the hashes */
+    for ( ; (lo < count) && (hashes[lo].hash == hash[0]); ++lo) {
+        for (i = 1; i < hash_count; ++i) {
+            if (lyb_get_hash(hashes[lo].node, i) != hash[i]) {
+                break;
+            }
+        }
+        if (i == hash_count) {
+            *snode = hashes[lo].node;
+            break;
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+void
+lyb_sibs_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->lyb_sibs_ht, lyb_sibs_rec_free);
+    ctx->lyb_sibs_ht = NULL;
+}
+
+ly_bool
+lyb_index_node(const struct lysc_node *snode)
+{
+    return (snode->nodetype == LYS_LIST) || ((snode->nodetype == LYS_CONTAINER) && !lysc_data_parent(snode));
+}
+
+const char * const lyb_diff_meta_names[] = {
+    "operation", "orig-default", "orig-value", "value", "key", "orig-key", "position", "orig-position",
+    "meta-create", "meta-delete", "meta-replace", "meta-orig"
+};
+
+const char * const lyb_diff_op_names[] = {"none", "create", "delete", "replace"};
+
+uint8_t
+lyb_diff_meta_code(const struct lyd_meta *meta)
+{
+    uint8_t i;
+
+    if (strcmp(meta->annotation->module->name, "yang")) {
+        return LYB_DIFF_META_GENERIC;
+    }
+
+    for (i = 0; i < LYB_DIFF_META_COUNT; ++i) {
+        if (!strcmp(meta->name, lyb_diff_meta_names[i])) {
+            return i + 1;
+        }
+    }
+
+    return LYB_DIFF_META_GENERIC;
+}
@@ -21,7 +21,11 @@
 #include "parser_internal.h"
 
 struct ly_ctx;
+struct ly_ht;
+struct lyd_meta;
+struct lysc_ext_instance;
 struct lysc_node;
+struct lys_module;
 
 /*
  * LYB format
@@ -44,6 +48,14 @@ struct lysc_node;
  * - data are preceded with information about the used context. The exact same context must be used for
  * parsing the data to guarantee that all the schema nodes get the same hash.
  *
+ * - optionally, data are followed by an index of the subtrees of top-level containers and list instances. Each entry
+ * is found by the offset of the "siblings" with the children of the node and holds the offset right after the node
+ * together with the state of all the enclosing "siblings" there. It allows the parser to skip the subtree and
+ * parse it later (::LYD_PARSE_LYB_LAZY). All the offsets are from the beginning of the data.
+ *
+ * - a diff (::LYD_PRINT_LYB_DIFF) has every metadata prefixed with a code of the diff metadata of the "yang" module
+ * followed by its value in a binary form, code 0 is used for any other metadata with their standard encoding.
+ *
  * This is a short summary of the format:
  * @verbatim
 
@@ -60,6 +72,11 @@ struct lysc_node;
  inner       = node_header siblings
  leaf        = node_header term_value
  node_header = metadata node_flags
+ diff_meta   = 8bit_zero module meta_name meta_value | diff_op 8bit_operation | diff_orig_dflt 8bit_bool |
+               diff_code 32bit_length meta_value
+
+ index       = index_length entry_count entry_offset* entry*
+ entry       = siblings_offset end_offset depth (chunk_written chunk_inner_chunks chunk_next)*
 
  @endverbatim
  */
@@ -81,20 +98,23 @@ struct lylyb_ctx {
     const struct ly_ctx *ctx;
     uint64_t line;             /* current line */
     struct ly_in *in;          /* input structure */
+    ly_bool diff;              /* diff metadata in the binary form (::LYB_HEADER_DIFF) */
 
     struct lyd_lyb_sibling {
         size_t written;
         size_t position;
         uint16_t inner_chunks;
+        size_t chunk;          /* printer only, sequence number of the current chunk for the index */
     } *siblings;
     LY_ARRAY_COUNT_TYPE sibling_size;
 
+    /* LYB parser only */
+    struct lyb_lazy *lazy;     /* indexed data being parsed lazily, if any */
+    struct ly_set stubs;       /* created stub records (struct lyd_lyb_stub *) to be stored */
+
     /* LYB printer only */
-    struct lyd_lyb_sib_ht {
-        struct lysc_node *first_sibling;
-        struct ly_ht *ht;
-    } *sib_hts;
     ly_bool empty_hash;
+    struct lyb_index *index;   /* index being created, if any */
 };
 
 /**
@@ -124,6 +144,18 @@ void lyd_lyb_ctx_free(struct lyd_ctx *lydctx);
 /* LYB hash algorithm mask of the header byte */
 #define LYB_HEADER_HASH_MASK 0x30
 
+/* header flag of data followed by an index, its offset follows the context hash */
+#define LYB_HEADER_INDEX 0x40
+
+/* header flag of a diff with the diff metadata in a binary form */
+#define LYB_HEADER_DIFF 0x80
+
+/* diff metadata codes, generic metadata, "yang" module operation and orig-default, the others are the index + 1
+ * of the names in ::lyb_diff_meta_names */
+#define LYB_DIFF_META_GENERIC 0x00
+#define LYB_DIFF_META_OPERATION 0x01
+#define LYB_DIFF_META_ORIG_DEFAULT 0x02
+
 /**
  * LYB schema hash constants
  *
@@ -170,6 +202,12 @@ void lyd_lyb_ctx_free(struct lyd_ctx *lydctx);
 /* Just a helper macro */
 #define LYB_META_BYTES (LYB_INCHUNK_BYTES + LYB_SIZE_BYTES)
 
+/* size of all the offsets and lengths in the index */
+#define LYB_INDEX_OFFSET_BYTES 8
+
+/* size of the state of a single "siblings" in an index entry */
+#define LYB_INDEX_LEVEL_BYTES (LYB_META_BYTES + 1)
+
 /* module revision as XXXX XXXX XXXX XXXX (2B) (year is offset from 2000)
  *                    YYYY YYYM MMMD DDDD */
 #define LYB_REV_YEAR_OFFSET 2000
@@ -195,4 +233,71 @@ LYB_HASH lyb_get_hash(const struct lysc_node *node, uint8_t collision_id);
  */
 void lyb_cache_module_hash(const struct lys_module *mod);
 
+/**
+ * @brief Get the printer hash table of schema siblings with their non-colliding hashes. Cached in the context.
+ *
+ * @param[in] first_sibling First schema sibling on the level.
+ * @param[out] ht Hash table of the siblings, must not be modified or freed.
+ * @return LY_ERR value.
+ */
+LY_ERR lyb_sibs_get_ht(const struct lysc_node *first_sibling, struct ly_ht **ht);
+
+/**
+ * @brief Find a schema sibling matching parsed hashes. The lookup table is cached in the context.
+ *
+ * @param[in] sparent Schema parent, must be set if @p mod and @p ext are not.
+ * @param[in] mod Module of the top-level node.
+ * @param[in] ext Extension instance of the top-level node.
+ * @param[in] getnext_opts Options for getting the siblings.
+ * @param[in] hash Parsed hashes starting with collision ID 0.
+ * @param[in] hash_count Number of @p hash.
+ * @param[out] snode Found schema node, NULL if none matches.
+ * @return LY_ERR value.
+ */
+LY_ERR lyb_sibs_find(const struct lysc_node *sparent, const struct lys_module *mod, const struct lysc_ext_instance *ext,
+        uint32_t getnext_opts, const LYB_HASH *hash, uint8_t hash_count, const struct lysc_node **snode);
+
+/**
+ * @brief Free all the cached LYB hashes of schema siblings of a context.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lyb_sibs_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Learn whether the subtrees of instances of a schema node are in the LYB index (::LYD_PRINT_LYB_INDEX).
+ *
+ * @param[in] snode Schema node of the instances.
+ * @return Whether the instances are indexed.
+ */
+ly_bool lyb_index_node(const struct lysc_node *snode);
+
+/**
+ * @brief Names of the diff metadata of the "yang" module with a code, indexed by the code - 1.
+ */
+extern const char * const lyb_diff_meta_names[];
+
+/**
+ * @brief Number of items in ::lyb_diff_meta_names.
+ */
+#define LYB_DIFF_META_COUNT 12
+
+/**
+ * @brief Values of the "yang" module operation metadata, indexed by their binary form.
+ */
+extern const char * const lyb_diff_op_names[];
+
+/**
+ * @brief Number of items in ::lyb_diff_op_names.
+ */
+#define LYB_DIFF_OP_COUNT 4
+
+/**
+ * @brief Get the diff code of metadata (::LYB_HEADER_DIFF).
+ *
+ * @param[in] meta Metadata to learn about.
+ * @return Metadata code, ::LYB_DIFF_META_GENERIC if it has none.
+ */
+uint8_t lyb_diff_meta_code(const struct lyd_meta *meta);
+
 #endif /* LY_LYB_H_ */
@@ -34,6 +34,19 @@
 #include "tree_data.h"
 #include "tree_schema.h"
 
+#ifdef HAVE_POLL
+# include <poll.h>
+#endif
+
+#ifdef HAVE_WRITEV
+# include <sys/uio.h>
+#else
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
 /**
  * @brief Align the desired size to 1 KB.
  */
@@ -76,6 +89,11 @@ lyd_node_should_print(const struct lyd_node *node, uint32_t options)
             return 1;
         }
 
+        if ((node->flags & LYD_DFLT_VIRTUAL) && (options & (LYD_PRINT_WD_ALL | LYD_PRINT_WD_ALL_TAG | LYD_PRINT_WD_IMPL_TAG))) {
+            /* virtual default leaves will be printed */
+            return 1;
+        }
+
         /* avoid empty default containers */
         LYD_TREE_DFS_BEGIN(node, elem) {
             if ((elem != node) && lyd_node_should_print(elem, options)) {
@@ -110,6 +128,161 @@ lyd_metadata_should_print(const struct lyd_meta *meta)
     return !lyd_meta_is_internal(meta);
 }
 
+/**
+ * @brief Wait until a non-blocking output file descriptor is writable.
+ *
+ * @param[in] fd File descriptor to wait for.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_out_fd_wait(int fd)
+{
+#ifdef HAVE_POLL
+    struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+
+    while (poll(&pfd, 1, -1) == -1) {
+        if (errno != EINTR) {
+            LOGERR(NULL, LY_ESYS, "%s: waiting for the output failed (%s).", __func__, strerror(errno));
+            return LY_ESYS;
+        }
+    }
+    return LY_SUCCESS;
+#else
+    (void)fd;
+
+    LOGERR(NULL, LY_ESYS, "%s: writing data failed (%s).", __func__, strerror(EAGAIN));
+    return LY_ESYS;
+#endif
+}
+
+/**
+ * @brief Write data directly to a file descriptor or callback output.
+ *
+ * A non-blocking file descriptor is waited for, a callback failing with EAGAIN is an error.
+ *
+ * @param[in] out Output specification of LY_OUT_FD or LY_OUT_CALLBACK type.
+ * @param[in] iov Data to write, modified.
+ * @param[in] iovcnt Number of items in @p iov.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_out_wbuf_writev(struct ly_out *out, struct iovec *iov, int iovcnt)
+{
+    ssize_t r;
+    int i = 0;
+
+    while (i < iovcnt) {
+        if (!iov[i].iov_len) {
+            ++i;
+            continue;
+        }
+
+        if (out->type == LY_OUT_FD) {
+#ifdef HAVE_WRITEV
+            r = writev(out->method.fd, &iov[i], iovcnt - i);
+#else
+            r = write(out->method.fd, iov[i].iov_base, iov[i].iov_len);
+#endif
+        } else {
+            r = out->method.clb.func(out->method.clb.arg, iov[i].iov_base, iov[i].iov_len);
+        }
+
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((out->type == LY_OUT_FD) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                LY_CHECK_RET(ly_out_fd_wait(out->method.fd));
+                continue;
+            }
+            LOGERR(NULL, LY_ESYS, "%s: writing data failed (%s).", __func__, strerror(errno));
+            return LY_ESYS;
+        } else if (!r || ((out->type == LY_OUT_CALLBACK) && ((size_t)r != iov[i].iov_len))) {
+            LOGERR(NULL, LY_ESYS, "%s: writing data failed (unable to write %" PRIu32 " from %" PRIu32 " data).",
+                    __func__, (uint32_t)(iov[i].iov_len - r), (uint32_t)iov[i].iov_len);
+            return LY_ESYS;
+        }
+
+        /* skip the written data, the write may have been partial */
+        for ( ; (i < iovcnt) && ((size_t)r >= iov[i].iov_len); ++i) {
+            r -= iov[i].iov_len;
+        }
+        if (r) {
+            iov[i].iov_base = (char *)iov[i].iov_base + r;
+            iov[i].iov_len -= r;
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Write the buffered data of the write-combining buffer followed by optional additional data.
+ *
+ * @param[in] out Output specification of LY_OUT_FD or LY_OUT_CALLBACK type.
+ * @param[in] buf Optional data to write after the buffered data.
+ * @param[in] len Length of @p buf.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_out_wbuf_flush(struct ly_out *out, const char *buf, size_t len)
+{
+    struct iovec iov[2];
+
+    if (!out->wbuf_len && !len) {
+        return LY_SUCCESS;
+    }
+
+    /* single vectored write of both the buffered and the new data */
+    iov[0].iov_base = out->wbuf;
+    iov[0].iov_len = out->wbuf_len;
+    iov[1].iov_base = (void *)buf;
+    iov[1].iov_len = len;
+
+    /* the buffered data are dropped even on error so that they are not written again */
+    out->wbuf_len = 0;
+    return ly_out_wbuf_writev(out, iov, 2);
+}
+
+/**
+ * @brief Write data through the write-combining buffer.
+ *
+ * @param[in] out Output specification of LY_OUT_FD or LY_OUT_CALLBACK type.
+ * @param[in] buf Data to write.
+ * @param[in] len Length of @p buf.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+ly_out_wbuf_write(struct ly_out *out, const char *buf, size_t len)
+{
+    size_t n;
+
+    assert(out->wbuf_size);
+
+    if ((out->type == LY_OUT_FD) && (out->wbuf_len + len > out->wbuf_size)) {
+        /* no room, write everything at once */
+        return ly_out_wbuf_flush(out, buf, len);
+    }
+
+    if (!out->wbuf) {
+        out->wbuf = malloc(out->wbuf_size);
+        LY_CHECK_ERR_RET(!out->wbuf, LOGMEM(NULL), LY_EMEM);
+    }
+
+    while (out->wbuf_len + len > out->wbuf_size) {
+        /* the callback is never passed more data than the buffer size */
+        n = out->wbuf_size - out->wbuf_len;
+        memcpy(&out->wbuf[out->wbuf_len], buf, n);
+        out->wbuf_len += n;
+        LY_CHECK_RET(ly_out_wbuf_flush(out, NULL, 0));
+        buf += n;
+        len -= n;
+    }
+
+    memcpy(&out->wbuf[out->wbuf_len], buf, len);
+    out->wbuf_len += len;
+    return LY_SUCCESS;
+}
+
 LIBYANG_API_DEF LY_OUT_TYPE
 ly_out_type(const struct ly_out *out)
 {
@@ -117,6 +290,21 @@ ly_out_type(const struct ly_out *out)
     return out->type;
 }
 
+LIBYANG_API_DEF LY_ERR
+ly_out_buffer_size(struct ly_out *out, size_t size)
+{
+    LY_CHECK_ARG_RET(NULL, out, (out->type == LY_OUT_FD) || (out->type == LY_OUT_CALLBACK), LY_EINVAL);
+
+    /* write the data buffered so far */
+    LY_CHECK_RET(ly_out_wbuf_flush(out, NULL, 0));
+
+    free(out->wbuf);
+    out->wbuf = NULL;
+    out->wbuf_size = size;
+
+    return LY_SUCCESS;
+}
+
 LIBYANG_API_DEF LY_ERR
 ly_out_new_clb(ly_write_clb writeclb, void *user_data, struct ly_out **out)
 {
@@ -142,6 +330,7 @@ ly_out_clb(struct ly_out *out, ly_write_clb writeclb)
     prev_clb = out->method.clb.func;
 
     if (writeclb) {
+        ly_out_wbuf_flush(out, NULL, 0);
         out->method.clb.func = writeclb;
     }
 
@@ -158,6 +347,7 @@ ly_out_clb_arg(struct ly_out *out, void *arg)
     prev_arg = out->method.clb.arg;
 
     if (arg) {
+        ly_out_wbuf_flush(out, NULL, 0);
         out->method.clb.arg = arg;
     }
 
@@ -212,6 +402,7 @@ ly_out_fd(struct ly_out *out, int fd)
             out->method.fdstream.f = stream;
             out->method.fdstream.fd = streamfd;
         } else { /* LY_OUT_FD */
+            ly_out_wbuf_flush(out, NULL, 0);
             out->method.fd = fd;
         }
     }
@@ -305,6 +496,8 @@ ly_out_reset(struct ly_out *out)
         LOGINT(NULL);
         return LY_EINT;
     case LY_OUT_FD:
+        /* the buffered data would be rewritten anyway */
+        out->wbuf_len = 0;
         if ((lseek(out->method.fd, 0, SEEK_SET) == -1) && (errno != ESPIPE)) {
             LOGERR(NULL, LY_ESYS, "Seeking output file descriptor failed (%s).", strerror(errno));
             return LY_ESYS;
@@ -394,6 +587,11 @@ ly_out_free(struct ly_out *out, void (*clb_arg_destructor)(void *arg), ly_bool d
         return;
     }
 
+    /* write any buffered data */
+    if ((out->type == LY_OUT_FD) || (out->type == LY_OUT_CALLBACK)) {
+        ly_out_wbuf_flush(out, NULL, 0);
+    }
+
     switch (out->type) {
     case LY_OUT_CALLBACK:
         if (clb_arg_destructor) {
@@ -430,6 +628,7 @@ ly_out_free(struct ly_out *out, void (*clb_arg_destructor)(void *arg), ly_bool d
     }
 
     free(out->buffered);
+    free(out->wbuf);
     free(out);
 }
 
@@ -440,6 +639,19 @@ ly_vprint_(struct ly_out *out, const char *format, va_list ap)
     int written = 0;
     char *msg = NULL;
 
+    if (out->wbuf_size) {
+        /* format into memory and write it through the write-combining buffer */
+        if ((written = vasprintf(&msg, format, ap)) < 0) {
+            goto finish;
+        }
+        ret = ly_out_wbuf_write(out, msg, written);
+        free(msg);
+        if (ret) {
+            return ret;
+        }
+        goto finish;
+    }
+
     switch (out->type) {
     case LY_OUT_FD:
         written = vdprintf(out->method.fd, format, ap);
@@ -483,6 +695,7 @@ ly_vprint_(struct ly_out *out, const char *format, va_list ap)
         return LY_EINT;
     }
 
+finish:
     if (written < 0) {
         LOGERR(NULL, LY_ESYS, "%s: writing data failed (%s).", __func__, strerror(errno));
         written = 0;
@@ -533,19 +746,22 @@ ly_print_flush(struct ly_out *out)
 {
     switch (out->type) {
     case LY_OUT_FDSTREAM:
+        fflush(out->method.fdstream.f);
         /* move the original file descriptor to the end of the output file */
         lseek(out->method.fdstream.fd, 0, SEEK_END);
-        fflush(out->method.fdstream.f);
         break;
     case LY_OUT_FILEPATH:
     case LY_OUT_FILE:
         fflush(out->method.f);
         break;
     case LY_OUT_FD:
+        ly_out_wbuf_flush(out, NULL, 0);
         fsync(out->method.fd);
         break;
-    case LY_OUT_MEMORY:
     case LY_OUT_CALLBACK:
+        ly_out_wbuf_flush(out, NULL, 0);
+        break;
+    case LY_OUT_MEMORY:
         /* nothing to do */
         break;
     case LY_OUT_ERROR:
@@ -585,6 +801,15 @@ ly_write_(struct ly_out *out, const char *buf, size_t len)
         return LY_SUCCESS;
     }
 
+    if (out->wbuf_size) {
+        /* LY_OUT_FD or LY_OUT_CALLBACK with the write-combining buffer */
+        LY_CHECK_RET(ly_out_wbuf_write(out, buf, len));
+
+        out->printed += len;
+        out->func_printed += len;
+        return LY_SUCCESS;
+    }
+
 repeat:
     switch (out->type) {
     case LY_OUT_MEMORY:
@@ -667,6 +892,59 @@ repeat:
     return ret;
 }
 
+LY_ERR
+ly_print_str(struct ly_out *out, const char *str)
+{
+    if (!str) {
+        return LY_SUCCESS;
+    }
+
+    return ly_write_(out, str, strlen(str));
+}
+
+LY_ERR
+ly_print_indent(struct ly_out *out, uint32_t count)
+{
+    static const char spaces[] = "                                                                ";
+    uint32_t len;
+
+    while (count) {
+        len = (count < sizeof spaces - 1) ? count : sizeof spaces - 1;
+        LY_CHECK_RET(ly_write_(out, spaces, len));
+        count -= len;
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+ly_print_uint(struct ly_out *out, uint64_t num)
+{
+    char buf[20];
+    size_t i = sizeof buf;
+
+    /* fill the digits from the end */
+    do {
+        buf[--i] = '0' + (num % 10);
+        num /= 10;
+    } while (num);
+
+    return ly_write_(out, &buf[i], sizeof buf - i);
+}
+
+LY_ERR
+ly_print_int(struct ly_out *out, int64_t num)
+{
+    if (num < 0) {
+        LY_CHECK_RET(ly_write_(out, "-", 1));
+
+        /* negate in the unsigned domain so that INT64_MIN is handled correctly */
+        return ly_print_uint(out, -(uint64_t)num);
+    }
+
+    return ly_print_uint(out, num);
+}
+
 LIBYANG_API_DEF LY_ERR
 ly_write(struct ly_out *out, const char *buf, size_t len)
 {
@@ -63,6 +63,7 @@ extern "C" {
  * - ::ly_out_memory()
  *
  * - ::ly_out_type()
+ * - ::ly_out_buffer_size()
  * - ::ly_out_printed()
  * - ::ly_out_printed_total()
  *
@@ -180,6 +181,9 @@ LIBYANG_API_DECL void *ly_out_clb_arg(struct ly_out *out, void *arg);
 /**
  * @brief Create printer handler using file descriptor.
  *
+ * The handler is not buffered, every print is written into @p fd directly. Many small writes are much faster
+ * with the write-combining buffer enabled by ::ly_out_buffer_size().
+ *
  * @param[in] fd File descriptor to use.
  * @param[out] out Created printer handler supposed to be passed to different ly*_print() functions.
  * @return LY_SUCCESS in case of success
@@ -276,8 +280,33 @@ LIBYANG_API_DECL const char *ly_out_filepath(struct ly_out *out, const char *fil
  */
 LIBYANG_API_DECL LY_ERR ly_print(struct ly_out *out, const char *format, ...);
 
+/**
+ * @brief Recommended size of the write-combining buffer of printer handlers, see ::ly_out_buffer_size().
+ */
+#define LY_OUT_BUF_SIZE 8192
+
+/**
+ * @brief Set the size of the write-combining buffer of a file descriptor or callback printer handler.
+ *
+ * The printed data are collected in the buffer and written when the buffer is full, on ::ly_print_flush()
+ * and on ::ly_out_free(). The handlers are not buffered by default, so if the buffer is used and the file descriptor
+ * is written to or read from directly, call ::ly_print_flush() first.
+ *
+ * An ::LY_OUT_FD handler writes the buffered data together with the data not fitting into the buffer by a single
+ * writev(2) call. An ::LY_OUT_CALLBACK handler passes the data to the callback in chunks of at most @p size bytes.
+ *
+ * @param[in] out Printer handler of ::LY_OUT_FD or ::LY_OUT_CALLBACK type.
+ * @param[in] size Size of the buffer in bytes, 0 to write all the data directly. Any buffered data are written first.
+ * @return LY_SUCCESS in case of success
+ * @return LY_ERR value in case of failure.
+ */
+LIBYANG_API_DECL LY_ERR ly_out_buffer_size(struct ly_out *out, size_t size);
+
 /**
  * @brief Flush the output from any internal buffers and clean any auxiliary data.
+ *
+ * Data buffered by the write-combining buffer (::ly_out_buffer_size()) are written.
+ *
  * @param[in] out Output specification.
  */
 LIBYANG_API_DECL void ly_print_flush(struct ly_out *out);
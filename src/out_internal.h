@@ -54,6 +54,11 @@ struct ly_out {
     size_t buf_size;     /**< allocated size of the buffer for holes */
     size_t hole_count;   /**< hole counter */
 
+    /* LY_OUT_FD and LY_OUT_CALLBACK only */
+    char *wbuf;          /**< write-combining buffer, allocated on the first write */
+    size_t wbuf_len;     /**< number of used bytes in the write-combining buffer */
+    size_t wbuf_size;    /**< size of the write-combining buffer, 0 if the output is not buffered */
+
     size_t printed;      /**< Total number of printed bytes */
     size_t func_printed; /**< Number of bytes printed by the last function */
 };
@@ -81,6 +86,61 @@ LY_ERR ly_print_(struct ly_out *out, const char *format, ...);
  */
 LY_ERR ly_write_(struct ly_out *out, const char *buf, size_t len);
 
+/**
+ * @brief Print a string literal into the specified output without any formatting.
+ *
+ * Does not reset printed bytes. Adds to printed bytes.
+ *
+ * @param[in] OUT Output specification.
+ * @param[in] LIT String literal to print, its length is known at compile time.
+ * @return LY_ERR value.
+ */
+#define ly_print_lit(OUT, LIT) ly_write_(OUT, "" LIT, sizeof(LIT) - 1)
+
+/**
+ * @brief Print a NULL-terminated string into the specified output without any formatting.
+ *
+ * Does not reset printed bytes. Adds to printed bytes.
+ *
+ * @param[in] out Output specification.
+ * @param[in] str String to print, nothing is printed if NULL.
+ * @return LY_ERR value.
+ */
+LY_ERR ly_print_str(struct ly_out *out, const char *str);
+
+/**
+ * @brief Print indentation of the given number of spaces into the specified output.
+ *
+ * Does not reset printed bytes. Adds to printed bytes.
+ *
+ * @param[in] out Output specification.
+ * @param[in] count Number of spaces to print.
+ * @return LY_ERR value.
+ */
+LY_ERR ly_print_indent(struct ly_out *out, uint32_t count);
+
+/**
+ * @brief Print an unsigned integer in decimal notation into the specified output.
+ *
+ * Does not reset printed bytes. Adds to printed bytes.
+ *
+ * @param[in] out Output specification.
+ * @param[in] num Number to print.
+ * @return LY_ERR value.
+ */
+LY_ERR ly_print_uint(struct ly_out *out, uint64_t num);
+
+/**
+ * @brief Print a signed integer in decimal notation into the specified output.
+ *
+ * Does not reset printed bytes. Adds to printed bytes.
+ *
+ * @param[in] out Output specification.
+ * @param[in] num Number to print.
+ * @return LY_ERR value.
+ */
+LY_ERR ly_print_int(struct ly_out *out, int64_t num);
+
 /**
  * @brief Create a hole in the output data that will be filled later.
  *
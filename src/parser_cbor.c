@@ -0,0 +1,853 @@
+/**
+ * @file parser_cbor.c
+ * @brief YANG-CBOR data parser for libyang
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _GNU_SOURCE
+
+#include "cbor.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "context.h"
+#include "in_internal.h"
+#include "log.h"
+#include "ly_common.h"
+#include "parser_data.h"
+#include "parser_internal.h"
+#include "set.h"
+#include "tree.h"
+#include "tree_data.h"
+#include "tree_data_internal.h"
+#include "tree_edit.h"
+#include "tree_schema.h"
+#include "validation.h"
+
+/**
+ * @brief Term node value read from YANG-CBOR data.
+ */
+struct lydcbor_value {
+    const char *str;        /**< value */
+    size_t len;             /**< length of @p str */
+    ly_bool dynamic;        /**< whether @p str is allocated */
+    LY_VALUE_FORMAT format; /**< format of @p str */
+    uint32_t hints;         /**< [value hints](@ref lydvalhints) of @p str */
+    char buf[32];           /**< buffer for printed numbers */
+};
+
+void
+lyd_cbor_ctx_free(struct lyd_ctx *lydctx)
+{
+    struct lyd_cbor_ctx *ctx = (struct lyd_cbor_ctx *)lydctx;
+
+    if (!lydctx) {
+        return;
+    }
+
+    lyd_ctx_free(lydctx);
+    free(ctx->cborctx);
+    free(ctx);
+}
+
+static LY_ERR lydcbor_parse_siblings(struct lyd_cbor_ctx *lydctx, struct lyd_node *parent, const struct lysc_node *sparent,
+        uint64_t base_sid, struct lyd_node **first_p, struct ly_set *parsed, const struct lycbor_item *map);
+
+/**
+ * @brief Read a text string without copying it, if possible.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] item Read header of the text string.
+ * @param[out] str Read string, not NULL-terminated.
+ * @param[out] len Length of @p str.
+ * @param[out] dynamic Whether @p str was allocated.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_read_text(struct lyd_cbor_ctx *lydctx, const struct lycbor_item *item, const char **str, size_t *len,
+        ly_bool *dynamic)
+{
+    struct ly_in *in = lydctx->cborctx->in;
+
+    if (item->indefinite) {
+        *dynamic = 1;
+        return lycbor_read_str(lydctx->cborctx, item, (char **)str, len);
+    }
+
+    /* directly from the input */
+    LY_CHECK_RET(lycbor_check_len(lydctx->cborctx, item->arg, 0));
+    *str = in->current;
+    *len = item->arg;
+    *dynamic = 0;
+    ly_in_skip(in, item->arg);
+    if (memchr(*str, '\0', *len)) {
+        LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR text string with a NUL character.");
+        return LY_EVALID;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Get the signed value of an integer item.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] item Integer item.
+ * @param[out] num Its value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_item_int(struct lyd_cbor_ctx *lydctx, const struct lycbor_item *item, int64_t *num)
+{
+    if (((item->major != LYCBOR_UINT) && (item->major != LYCBOR_NINT)) || (item->arg > INT64_MAX)) {
+        LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR integer.");
+        return LY_EVALID;
+    }
+
+    *num = (item->major == LYCBOR_UINT) ? (int64_t)item->arg : -1 - (int64_t)item->arg;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Check that a schema node found by its SID is a valid child of a schema parent.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] snode Found schema node.
+ * @param[in] sparent Schema parent, NULL for top-level nodes.
+ * @return Whether it is a valid child.
+ */
+static ly_bool
+lydcbor_check_parent(struct lyd_cbor_ctx *lydctx, const struct lysc_node *snode, const struct lysc_node *sparent)
+{
+    const struct lysc_node *iter;
+
+    if (lysc_data_parent(snode) != sparent) {
+        return 0;
+    }
+
+    if (sparent && (sparent->nodetype & (LYS_RPC | LYS_ACTION))) {
+        /* input or output child */
+        for (iter = snode->parent; !(iter->nodetype & (LYS_INPUT | LYS_OUTPUT)); iter = iter->parent) {}
+        if ((iter->nodetype == LYS_OUTPUT) != ((lydctx->int_opts & LYD_INTOPT_REPLY) ? 1 : 0)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Parse a member key and find its schema node.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] sparent Schema parent of the member, NULL for top-level nodes.
+ * @param[in] base_sid SID of @p sparent, the base of delta SIDs, 0 if it has none.
+ * @param[out] snode Found schema node, NULL if not found.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_parse_key(struct lyd_cbor_ctx *lydctx, const struct lysc_node *sparent, uint64_t base_sid,
+        const struct lysc_node **snode)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct ly_ctx *ctx = lydctx->cborctx->ctx;
+    const struct lys_module *mod = NULL;
+    struct lycbor_item item;
+    const char *str = NULL, *name;
+    size_t len, name_len;
+    ly_bool dynamic = 0;
+    int64_t delta;
+    uint64_t sid = 0;
+
+    *snode = NULL;
+
+    LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+    switch (item.major) {
+    case LYCBOR_UINT:
+    case LYCBOR_NINT:
+        /* delta SID */
+        LY_CHECK_RET(lydcbor_item_int(lydctx, &item, &delta));
+        if (sparent && !base_sid) {
+            LOGVAL(ctx, LYVE_SYNTAX, "Delta SID %" PRId64 " of a child of \"%s\" without a SID.", delta, sparent->name);
+            return LY_EVALID;
+        }
+        sid = base_sid + delta;
+        break;
+    case LYCBOR_TAG:
+        /* absolute SID */
+        if (item.arg == LYCBOR_TAG_SID) {
+            LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+            if (item.major == LYCBOR_UINT) {
+                sid = item.arg;
+                break;
+            }
+        }
+        LOGVAL(ctx, LYVE_SYNTAX, "Invalid YANG-CBOR member key.");
+        return LY_EVALID;
+    case LYCBOR_TEXT:
+        /* member name */
+        LY_CHECK_RET(lydcbor_read_text(lydctx, &item, &str, &len, &dynamic));
+        name = memchr(str, ':', len);
+        if (name) {
+            mod = ly_ctx_get_module_implemented2(ctx, str, name - str);
+            ++name;
+            name_len = len - (name - str);
+        } else {
+            if (!sparent) {
+                LOGVAL(ctx, LYVE_SYNTAX, "Top-level member \"%.*s\" without a module name.", (int)len, str);
+                rc = LY_EVALID;
+                goto cleanup;
+            }
+            mod = sparent->module;
+            name = str;
+            name_len = len;
+        }
+        if (mod && name_len) {
+            *snode = lys_find_child(sparent, mod, name, name_len, 0,
+                    (lydctx->int_opts & LYD_INTOPT_REPLY) ? LYS_GETNEXT_OUTPUT : 0);
+        }
+        if (!*snode && (lydctx->parse_opts & LYD_PARSE_STRICT)) {
+            LOGVAL(ctx, LYVE_REFERENCE, "Node \"%.*s\" not found.", (int)len, str);
+            rc = LY_EVALID;
+        }
+        goto cleanup;
+    default:
+        LOGVAL(ctx, LYVE_SYNTAX, "Invalid YANG-CBOR member key.");
+        return LY_EVALID;
+    }
+
+    /* find the node by its SID */
+    *snode = ly_sid_find(ctx, sid, LY_SID_NS_DATA);
+    if (*snode && !lydcbor_check_parent(lydctx, *snode, sparent)) {
+        *snode = NULL;
+    }
+    if (!*snode && (lydctx->parse_opts & LYD_PARSE_STRICT)) {
+        LOGVAL(ctx, LYVE_REFERENCE, "Node with SID %" PRIu64 " not found.", sid);
+        rc = LY_EVALID;
+    }
+
+cleanup:
+    if (dynamic) {
+        free((char *)str);
+    }
+    return rc;
+}
+
+/**
+ * @brief Get the type of a union member or leaf with leafrefs resolved.
+ *
+ * @param[in] type Type to resolve.
+ * @return Real type.
+ */
+static const struct lysc_type *
+lydcbor_realtype(const struct lysc_type *type)
+{
+    if (type->basetype == LY_TYPE_LEAFREF) {
+        return ((const struct lysc_type_leafref *)type)->realtype;
+    }
+    return type;
+}
+
+/**
+ * @brief Find the first member of a type with the specific base type, if it is a union.
+ *
+ * @param[in] type Type of a term node.
+ * @param[in] basetype Base type to find.
+ * @param[out] idx Index of the found member in the union, if @p type is a union.
+ * @return Found type, NULL if none.
+ */
+static const struct lysc_type *
+lydcbor_type_find(const struct lysc_type *type, LY_DATA_TYPE basetype, uint32_t *idx)
+{
+    const struct lysc_type_union *type_u;
+    LY_ARRAY_COUNT_TYPE u;
+
+    type = lydcbor_realtype(type);
+    if (type->basetype != LY_TYPE_UNION) {
+        return (type->basetype == basetype) ? type : NULL;
+    }
+
+    type_u = (const struct lysc_type_union *)type;
+    LY_ARRAY_FOR(type_u->types, u) {
+        if (lydcbor_realtype(type_u->types[u])->basetype == basetype) {
+            if (idx) {
+                *idx = u;
+            }
+            return lydcbor_realtype(type_u->types[u]);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Convert an enumeration integer value into its name.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] type Enumeration type.
+ * @param[in] num Enumeration value.
+ * @param[out] val Converted value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_value_enum(struct lyd_cbor_ctx *lydctx, const struct lysc_type *type, int64_t num, struct lydcbor_value *val)
+{
+    const struct lysc_type_enum *type_e = (const struct lysc_type_enum *)type;
+    LY_ARRAY_COUNT_TYPE u;
+
+    LY_ARRAY_FOR(type_e->enums, u) {
+        if (type_e->enums[u].value == num) {
+            val->str = type_e->enums[u].name;
+            val->len = strlen(val->str);
+            val->hints = LYD_VALHINT_STRING;
+            return LY_SUCCESS;
+        }
+    }
+
+    LOGVAL(lydctx->cborctx->ctx, LYVE_DATA, "Invalid enumeration value %" PRId64 ".", num);
+    return LY_EVALID;
+}
+
+/**
+ * @brief Convert an identity SID into its name.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] sid Identity SID.
+ * @param[out] val Converted value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_value_ident(struct lyd_cbor_ctx *lydctx, uint64_t sid, struct lydcbor_value *val)
+{
+    const struct lysc_ident *ident;
+    char *str;
+
+    ident = ly_sid_find(lydctx->cborctx->ctx, sid, LY_SID_NS_IDENTITY);
+    if (!ident) {
+        LOGVAL(lydctx->cborctx->ctx, LYVE_DATA, "Identity with SID %" PRIu64 " not found.", sid);
+        return LY_EVALID;
+    }
+
+    if (asprintf(&str, "%s:%s", ident->module->name, ident->name) == -1) {
+        LOGMEM(lydctx->cborctx->ctx);
+        return LY_EMEM;
+    }
+    val->str = str;
+    val->len = strlen(str);
+    val->dynamic = 1;
+    val->hints = LYD_VALHINT_STRING;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Convert a bits bitmap into the bit names.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] type Bits type.
+ * @param[in] bitmap Bitmap, the bit with position 0 is the least significant bit of the first byte.
+ * @param[in] size Size of @p bitmap.
+ * @param[out] val Converted value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_value_bits(struct lyd_cbor_ctx *lydctx, const struct lysc_type *type, const char *bitmap, size_t size,
+        struct lydcbor_value *val)
+{
+    const struct lysc_type_bits *type_b = (const struct lysc_type_bits *)type;
+    LY_ARRAY_COUNT_TYPE u;
+    uint64_t pos;
+    char *str = NULL, *ptr;
+    size_t len = 0, name_len;
+
+    for (pos = 0; pos < size * 8; ++pos) {
+        if (!(((uint8_t)bitmap[pos / 8] >> (pos % 8)) & 1)) {
+            continue;
+        }
+
+        LY_ARRAY_FOR(type_b->bits, u) {
+            if (type_b->bits[u].position == pos) {
+                break;
+            }
+        }
+        if (u == LY_ARRAY_COUNT(type_b->bits)) {
+            LOGVAL(lydctx->cborctx->ctx, LYVE_DATA, "Invalid bit position %" PRIu64 ".", pos);
+            free(str);
+            return LY_EVALID;
+        }
+
+        /* append the name */
+        name_len = strlen(type_b->bits[u].name);
+        ptr = realloc(str, len + name_len + 2);
+        LY_CHECK_ERR_RET(!ptr, LOGMEM(lydctx->cborctx->ctx); free(str), LY_EMEM);
+        str = ptr;
+        if (len) {
+            str[len++] = ' ';
+        }
+        memcpy(str + len, type_b->bits[u].name, name_len + 1);
+        len += name_len;
+    }
+
+    val->str = str ? str : "";
+    val->len = len;
+    val->dynamic = str ? 1 : 0;
+    val->hints = LYD_VALHINT_STRING;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Convert a decimal fraction into its decimal string.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] array Read header of the array with the exponent and the mantissa.
+ * @param[out] val Converted value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_value_decfrac(struct lyd_cbor_ctx *lydctx, const struct lycbor_item *array, struct lydcbor_value *val)
+{
+    struct lycbor_item item;
+    int64_t exp, mantissa;
+    uint64_t abs;
+    char digits[24];
+    int len, fd;
+
+    if ((array->major != LYCBOR_ARRAY) || array->indefinite || (array->arg != 2)) {
+        LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Invalid YANG-CBOR decimal fraction.");
+        return LY_EVALID;
+    }
+    LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+    LY_CHECK_RET(lydcbor_item_int(lydctx, &item, &exp));
+    LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+    LY_CHECK_RET(lydcbor_item_int(lydctx, &item, &mantissa));
+    if ((exp > 0) || (exp < -18)) {
+        LOGVAL(lydctx->cborctx->ctx, LYVE_DATA, "Invalid YANG-CBOR decimal fraction exponent %" PRId64 ".", exp);
+        return LY_EVALID;
+    }
+
+    /* digits with enough leading zeros */
+    fd = -exp;
+    abs = (mantissa < 0) ? -(uint64_t)mantissa : (uint64_t)mantissa;
+    len = sprintf(digits, "%0*" PRIu64, fd + 1, abs);
+
+    /* insert the decimal point */
+    if (fd) {
+        len = sprintf(val->buf, "%s%.*s.%s", (mantissa < 0) ? "-" : "", len - fd, digits, digits + len - fd);
+    } else {
+        len = sprintf(val->buf, "%s%s", (mantissa < 0) ? "-" : "", digits);
+    }
+    val->str = val->buf;
+    val->len = len;
+    val->hints = LYD_VALHINT_STRING;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Read a term node value and convert it into the JSON value format, if needed.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] snode Schema node of the term node.
+ * @param[in] item Read header of the value.
+ * @param[out] val Read value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_value(struct lyd_cbor_ctx *lydctx, const struct lysc_node *snode, const struct lycbor_item *item,
+        struct lydcbor_value *val)
+{
+    const struct ly_ctx *ctx = lydctx->cborctx->ctx;
+    const struct lysc_type *type = ((const struct lysc_node_leaf *)snode)->type, *mtype;
+    struct lycbor_item tagged;
+    uint32_t idx = 0;
+    int64_t num;
+    char *str;
+    size_t len;
+
+    memset(val, 0, sizeof *val);
+    val->format = LY_VALUE_JSON;
+
+    switch (item->major) {
+    case LYCBOR_UINT:
+    case LYCBOR_NINT:
+        if ((lydcbor_realtype(type)->basetype == LY_TYPE_ENUM) && (item->arg <= INT64_MAX)) {
+            /* enumeration value */
+            LY_CHECK_RET(lydcbor_item_int(lydctx, item, &num));
+            return lydcbor_value_enum(lydctx, lydcbor_realtype(type), num, val);
+        } else if (lydcbor_realtype(type)->basetype == LY_TYPE_IDENT) {
+            /* identity SID */
+            return lydcbor_value_ident(lydctx, item->arg, val);
+        }
+
+        /* number */
+        if (item->major == LYCBOR_UINT) {
+            val->len = sprintf(val->buf, "%" PRIu64, item->arg);
+        } else if (item->arg < UINT64_MAX) {
+            val->len = sprintf(val->buf, "-%" PRIu64, item->arg + 1);
+        } else {
+            val->len = sprintf(val->buf, "-18446744073709551616");
+        }
+        val->str = val->buf;
+        val->hints = LYD_VALHINT_DECNUM | LYD_VALHINT_NUM64;
+        break;
+    case LYCBOR_TEXT:
+        LY_CHECK_RET(lydcbor_read_text(lydctx, item, &val->str, &val->len, &val->dynamic));
+        val->hints = LYD_VALHINT_STRING;
+        break;
+    case LYCBOR_BYTES:
+        LY_CHECK_RET(lycbor_read_str(lydctx->cborctx, item, &str, &len));
+        if ((mtype = lydcbor_type_find(type, LY_TYPE_BINARY, &idx))) {
+            if (lydcbor_realtype(type)->basetype == LY_TYPE_UNION) {
+                /* union LYB value with the type index */
+                val->str = malloc(4 + len);
+                LY_CHECK_ERR_RET(!val->str, LOGMEM(ctx); free(str), LY_EMEM);
+                idx = htole32(idx);
+                memcpy((char *)val->str, &idx, 4);
+                memcpy((char *)val->str + 4, str, len);
+                val->len = 4 + len;
+                free(str);
+            } else {
+                /* raw binary value */
+                val->str = str;
+                val->len = len;
+            }
+            val->dynamic = 1;
+            val->format = LY_VALUE_LYB;
+        } else if ((mtype = lydcbor_type_find(type, LY_TYPE_BITS, NULL))) {
+            /* bits bitmap */
+            LY_CHECK_ERR_RET(lydcbor_value_bits(lydctx, mtype, str, len, val), free(str), LY_EVALID);
+            free(str);
+        } else {
+            free(str);
+            LOGVAL(ctx, LYVE_DATA, "Unexpected YANG-CBOR byte string value of \"%s\".", snode->name);
+            return LY_EVALID;
+        }
+        break;
+    case LYCBOR_TAG:
+        LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &tagged));
+        if (item->arg == LYCBOR_TAG_DECFRAC) {
+            /* decimal64 */
+            return lydcbor_value_decfrac(lydctx, &tagged, val);
+        } else if ((item->arg == LYCBOR_TAG_ENUM) && ((tagged.major == LYCBOR_UINT) || (tagged.major == LYCBOR_NINT)) &&
+                (mtype = lydcbor_type_find(type, LY_TYPE_ENUM, NULL))) {
+            LY_CHECK_RET(lydcbor_item_int(lydctx, &tagged, &num));
+            return lydcbor_value_enum(lydctx, mtype, num, val);
+        } else if ((item->arg == LYCBOR_TAG_IDENT) && (tagged.major == LYCBOR_UINT)) {
+            return lydcbor_value_ident(lydctx, tagged.arg, val);
+        } else if ((item->arg == LYCBOR_TAG_BITS) && (tagged.major == LYCBOR_BYTES) &&
+                (mtype = lydcbor_type_find(type, LY_TYPE_BITS, NULL))) {
+            LY_CHECK_RET(lycbor_read_str(lydctx->cborctx, &tagged, &str, &len));
+            LY_CHECK_ERR_RET(lydcbor_value_bits(lydctx, mtype, str, len, val), free(str), LY_EVALID);
+            free(str);
+            return LY_SUCCESS;
+        } else if (((item->arg == LYCBOR_TAG_ENUM) || (item->arg == LYCBOR_TAG_IDENT) || (item->arg == LYCBOR_TAG_BITS)) &&
+                (tagged.major == LYCBOR_TEXT)) {
+            /* tagged name */
+            LY_CHECK_RET(lydcbor_read_text(lydctx, &tagged, &val->str, &val->len, &val->dynamic));
+            val->hints = LYD_VALHINT_STRING;
+            return LY_SUCCESS;
+        }
+
+        LOGVAL(ctx, LYVE_SYNTAX, "Unexpected YANG-CBOR tag %" PRIu64 " of a value of \"%s\".", item->arg, snode->name);
+        return LY_EVALID;
+    case LYCBOR_SIMPLE:
+        if ((item->info == (LYCBOR_FALSE & LYCBOR_INFO_MASK)) || (item->info == (LYCBOR_TRUE & LYCBOR_INFO_MASK))) {
+            val->str = (item->info == (LYCBOR_TRUE & LYCBOR_INFO_MASK)) ? "true" : "false";
+            val->len = strlen(val->str);
+            val->hints = LYD_VALHINT_BOOLEAN;
+            break;
+        } else if (item->info == (LYCBOR_NULL & LYCBOR_INFO_MASK)) {
+            val->str = "";
+            val->hints = LYD_VALHINT_EMPTY;
+            break;
+        }
+    /* fallthrough */
+    default:
+        LOGVAL(ctx, LYVE_SYNTAX, "Unexpected YANG-CBOR value of \"%s\".", snode->name);
+        return LY_EVALID;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Parse an anydata/anyxml value.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] snode Schema node of the any node.
+ * @param[in] item Read header of the value.
+ * @param[out] node Created any node.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_parse_any(struct lyd_cbor_ctx *lydctx, const struct lysc_node *snode, const struct lycbor_item *item,
+        struct lyd_node **node)
+{
+    LY_ERR rc = LY_SUCCESS;
+    uint32_t prev_parse_opts = lydctx->parse_opts, prev_int_opts = lydctx->int_opts;
+    struct lyd_node *tree = NULL;
+    char *str;
+    size_t len;
+
+    switch (item->major) {
+    case LYCBOR_MAP:
+        /* data tree with the SIDs relative to the any node, only parsed */
+        lydctx->parse_opts &= ~LYD_PARSE_STRICT;
+        lydctx->parse_opts |= LYD_PARSE_ONLY;
+        lydctx->int_opts |= LYD_INTOPT_ANY | LYD_INTOPT_WITH_SIBLINGS;
+        rc = lydcbor_parse_siblings(lydctx, NULL, NULL, ly_sid_get(lydctx->cborctx->ctx, snode), &tree, NULL, item);
+        lydctx->parse_opts = prev_parse_opts;
+        lydctx->int_opts = prev_int_opts;
+        LY_CHECK_GOTO(rc, cleanup);
+
+        LY_CHECK_GOTO(rc = lyd_create_any(snode, tree, LYD_ANYDATA_DATATREE, 1, node), cleanup);
+        tree = NULL;
+        break;
+    case LYCBOR_TEXT:
+        LY_CHECK_GOTO(rc = lycbor_read_str(lydctx->cborctx, item, &str, &len), cleanup);
+        rc = lyd_create_any(snode, str, LYD_ANYDATA_STRING, 1, node);
+        LY_CHECK_ERR_GOTO(rc, free(str), cleanup);
+        break;
+    case LYCBOR_SIMPLE:
+        if (item->info == (LYCBOR_NULL & LYCBOR_INFO_MASK)) {
+            LY_CHECK_GOTO(rc = lyd_create_any(snode, NULL, LYD_ANYDATA_STRING, 1, node), cleanup);
+            break;
+        }
+    /* fallthrough */
+    default:
+        LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Unexpected YANG-CBOR value of \"%s\".", snode->name);
+        rc = LY_EVALID;
+        break;
+    }
+
+cleanup:
+    lyd_free_siblings(tree);
+    return rc;
+}
+
+/**
+ * @brief Parse a single instance of a node.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] parent Data parent of the node, must be set if @p first_p is not.
+ * @param[in] snode Schema node of the instance.
+ * @param[in,out] first_p First top-level sibling, must be set if @p parent is not.
+ * @param[out] parsed Set of all successfully parsed nodes, if any.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_parse_instance(struct lyd_cbor_ctx *lydctx, struct lyd_node *parent, const struct lysc_node *snode,
+        struct lyd_node **first_p, struct ly_set *parsed)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lycbor_item item;
+    struct lydcbor_value val;
+    struct lyd_node *node = NULL;
+    ly_bool log_node = 0;
+
+    LOG_LOCSET(snode, NULL);
+
+    LY_CHECK_GOTO(rc = lycbor_read_head(lydctx->cborctx, &item), cleanup);
+    if (snode->nodetype & LYD_NODE_TERM) {
+        /* create term node */
+        LY_CHECK_GOTO(rc = lydcbor_value(lydctx, snode, &item, &val), cleanup);
+        rc = lyd_parser_create_term((struct lyd_ctx *)lydctx, snode, val.str, val.len, &val.dynamic, val.format, NULL,
+                val.hints, &node);
+        if (val.dynamic) {
+            free((char *)val.str);
+        }
+        LY_CHECK_GOTO(rc, cleanup);
+    } else if (snode->nodetype & LYD_NODE_INNER) {
+        if (item.major != LYCBOR_MAP) {
+            LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Expected a YANG-CBOR map as the value of \"%s\".", snode->name);
+            rc = LY_EVALID;
+            goto cleanup;
+        }
+
+        /* create inner node */
+        LY_CHECK_GOTO(rc = lyd_create_inner(snode, &node), cleanup);
+        LOG_LOCSET(NULL, node);
+        log_node = 1;
+
+        /* process children */
+        rc = lydcbor_parse_siblings(lydctx, node, snode, ly_sid_get(lydctx->cborctx->ctx, snode), NULL, NULL, &item);
+        LY_CHECK_GOTO(rc, cleanup);
+
+        if (snode->nodetype == LYS_LIST) {
+            /* check all keys exist */
+            LY_CHECK_GOTO(rc = lyd_parser_check_keys(node), cleanup);
+        }
+
+        if (!(lydctx->parse_opts & LYD_PARSE_ONLY)) {
+            /* new node validation */
+            LY_CHECK_GOTO(rc = lyd_parser_validate_new_implicit((struct lyd_ctx *)lydctx, node), cleanup);
+        }
+
+        if (snode->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+            /* remember the RPC/action/notification */
+            lydctx->op_node = node;
+        }
+    } else {
+        /* create any node */
+        LY_CHECK_GOTO(rc = lydcbor_parse_any(lydctx, snode, &item, &node), cleanup);
+    }
+
+    /* add/correct flags */
+    LY_CHECK_GOTO(rc = lyd_parser_set_data_flags(node, &node->meta, (struct lyd_ctx *)lydctx, NULL), cleanup);
+
+    /* insert, keep first pointer correct */
+    lyd_insert_node(parent, first_p, node, lydctx->parse_opts & LYD_PARSE_ORDERED ? LYD_INSERT_NODE_LAST :
+            LYD_INSERT_NODE_DEFAULT);
+    while (!parent && (*first_p)->prev->next) {
+        *first_p = (*first_p)->prev;
+    }
+    if (parsed) {
+        ly_set_add(parsed, node, 1, NULL);
+    }
+
+    if (!(lydctx->parse_opts & LYD_PARSE_ONLY)) {
+        /* store for ext instance node validation, if needed */
+        (void)lyd_validate_node_ext(node, &lydctx->ext_node);
+    }
+    node = NULL;
+
+cleanup:
+    if (log_node) {
+        LOG_LOCBACK(0, 1);
+    }
+    LOG_LOCBACK(1, 0);
+    lyd_free_tree(node);
+    return rc;
+}
+
+/**
+ * @brief Parse all the members of a map as sibling data nodes.
+ *
+ * @param[in] lydctx YANG-CBOR parser context.
+ * @param[in] parent Data parent of the siblings, must be set if @p first_p is not.
+ * @param[in] sparent Schema parent of the siblings, NULL for top-level nodes.
+ * @param[in] base_sid SID of @p sparent or of the parent any node, the base of delta SIDs, 0 if it has none.
+ * @param[in,out] first_p First top-level sibling, must be set if @p parent is not.
+ * @param[out] parsed Set of all successfully parsed nodes, if any.
+ * @param[in] map Read header of the map.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lydcbor_parse_siblings(struct lyd_cbor_ctx *lydctx, struct lyd_node *parent, const struct lysc_node *sparent,
+        uint64_t base_sid, struct lyd_node **first_p, struct ly_set *parsed, const struct lycbor_item *map)
+{
+    const struct lysc_node *snode;
+    struct lycbor_item item;
+    uint64_t i, j;
+
+    for (i = 0; map->indefinite ? !lycbor_read_break(lydctx->cborctx) : (i < map->arg); ++i) {
+        /* member key */
+        LY_CHECK_RET(lydcbor_parse_key(lydctx, sparent, base_sid, &snode));
+        if (!snode) {
+            /* unknown node, skip it */
+            LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+            LY_CHECK_RET(lycbor_skip(lydctx->cborctx, &item));
+            continue;
+        }
+        LY_CHECK_RET(lyd_parser_check_schema((struct lyd_ctx *)lydctx, snode));
+
+        if (!(snode->nodetype & (LYS_LIST | LYS_LEAFLIST))) {
+            /* single instance */
+            LY_CHECK_RET(lydcbor_parse_instance(lydctx, parent, snode, first_p, parsed));
+            continue;
+        }
+
+        /* array of instances */
+        LY_CHECK_RET(lycbor_read_head(lydctx->cborctx, &item));
+        if (item.major != LYCBOR_ARRAY) {
+            LOGVAL(lydctx->cborctx->ctx, LYVE_SYNTAX, "Expected a YANG-CBOR array as the value of \"%s\".", snode->name);
+            return LY_EVALID;
+        }
+        for (j = 0; item.indefinite ? !lycbor_read_break(lydctx->cborctx) : (j < item.arg); ++j) {
+            LY_CHECK_RET(lydcbor_parse_instance(lydctx, parent, snode, first_p, parsed));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lyd_parse_cbor(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, struct lyd_node *parent,
+        struct lyd_node **first_p, struct ly_in *in, uint32_t parse_opts, uint32_t val_opts, uint32_t int_opts,
+        struct ly_set *parsed, ly_bool *subtree_sibling, struct lyd_ctx **lydctx_p)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyd_cbor_ctx *lydctx;
+    struct lycbor_item map;
+
+    assert(!(parse_opts & ~LYD_PARSE_OPTS_MASK));
+    assert(!(val_opts & ~LYD_VALIDATE_OPTS_MASK));
+
+    LY_CHECK_ARG_RET(ctx, !ext, !(parse_opts & LYD_PARSE_SUBTREE), LY_EINVAL);
+
+    if (subtree_sibling) {
+        *subtree_sibling = 0;
+    }
+
+    lydctx = calloc(1, sizeof *lydctx);
+    LY_CHECK_ERR_RET(!lydctx, LOGMEM(ctx), LY_EMEM);
+    lydctx->cborctx = calloc(1, sizeof *lydctx->cborctx);
+    LY_CHECK_ERR_GOTO(!lydctx->cborctx, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+
+    lydctx->cborctx->ctx = ctx;
+    lydctx->cborctx->in = in;
+    lydctx->parse_opts = parse_opts;
+    lydctx->val_opts = val_opts;
+    lydctx->int_opts = int_opts;
+    lydctx->free = lyd_cbor_ctx_free;
+
+    /* find the operation node if it exists already */
+    LY_CHECK_GOTO(rc = lyd_parser_find_operation(parent, int_opts, &lydctx->op_node), cleanup);
+
+    /* the top-level map */
+    LY_CHECK_GOTO(rc = lycbor_read_head(lydctx->cborctx, &map), cleanup);
+    if (map.major != LYCBOR_MAP) {
+        LOGVAL(ctx, LYVE_SYNTAX, "Expected a YANG-CBOR map of the data nodes.");
+        rc = LY_EVALID;
+        goto cleanup;
+    }
+    if ((int_opts & LYD_INTOPT_NO_SIBLINGS) && !map.indefinite && (map.arg > 1)) {
+        LOGVAL(ctx, LYVE_SYNTAX, "Unexpected sibling node.");
+        rc = LY_EVALID;
+        goto cleanup;
+    }
+
+    /* all the data nodes */
+    rc = lydcbor_parse_siblings(lydctx, parent, parent ? parent->schema : NULL,
+            parent ? ly_sid_get(ctx, parent->schema) : 0, first_p, parsed, &map);
+    LY_CHECK_GOTO(rc, cleanup);
+
+    if ((int_opts & (LYD_INTOPT_RPC | LYD_INTOPT_ACTION | LYD_INTOPT_NOTIF | LYD_INTOPT_REPLY)) && !lydctx->op_node) {
+        LOGVAL(ctx, LYVE_DATA, "Missing the operation node.");
+        rc = LY_EVALID;
+        goto cleanup;
+    }
+
+cleanup:
+    /* there should be no unres stored if validation should be skipped */
+    assert(!(parse_opts & LYD_PARSE_ONLY) || (!lydctx->node_types.count && !lydctx->meta_types.count &&
+            !lydctx->node_when.count));
+
+    if (rc) {
+        lyd_cbor_ctx_free((struct lyd_ctx *)lydctx);
+    } else {
+        *lydctx_p = (struct lyd_ctx *)lydctx;
+    }
+    return rc;
+}
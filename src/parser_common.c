@@ -450,6 +450,7 @@ LY_ERR
 lyd_parser_validate_new_implicit(struct lyd_ctx *lydctx, struct lyd_node *node)
 {
     LY_ERR r, rc = LY_SUCCESS;
+    uint32_t impl_opts;
 
     if (lyd_owner_module(node) != lydctx->val_getnext_ht_mod) {
         /* free any previous getnext HT */
@@ -468,9 +469,15 @@ lyd_parser_validate_new_implicit(struct lyd_ctx *lydctx, struct lyd_node *node)
     LY_DPARSER_ERR_GOTO(r, rc = r, lydctx, cleanup);
 
     /* add any missing default children */
+    impl_opts = 0;
+    if (lydctx->val_opts & LYD_VALIDATE_NO_STATE) {
+        impl_opts |= LYD_IMPLICIT_NO_STATE;
+    }
+    if (lydctx->val_opts & LYD_VALIDATE_VIRTUAL_DEFAULTS) {
+        impl_opts |= LYD_IMPLICIT_VIRTUAL_DFLT;
+    }
     r = lyd_new_implicit_r(node, lyd_node_child_p(node), NULL, NULL, &lydctx->node_when, &lydctx->node_types,
-            &lydctx->ext_node, (lydctx->val_opts & LYD_VALIDATE_NO_STATE) ? LYD_IMPLICIT_NO_STATE : 0,
-            lydctx->val_getnext_ht, NULL);
+            &lydctx->ext_node, impl_opts, lydctx->val_getnext_ht, NULL);
     LY_CHECK_ERR_GOTO(r, rc = r, cleanup);
 
 cleanup:
@@ -64,6 +64,8 @@ struct ly_in;
  * - ::lyd_parse_op() is used for parsing RPCs/actions, replies, and notifications. Even NETCONF rpc, rpc-reply, and
  *   notification messages are supported.
  * - ::lyd_parse_ext_op() is used for parsing RPCs/actions, replies, and notifications defined inside extension instances.
+ * - ::lyd_diff_apply_lyb() is used for applying a diff printed in the LYB format, such as when replicating changes
+ *   of a datastore.
  *
  * Further information regarding the processing input instance data can be found on the following pages.
  * - @subpage howtoDataValidation
@@ -78,6 +80,7 @@ struct ly_in;
  * - ::lyd_parse_ext_data()
  * - ::lyd_parse_op()
  * - ::lyd_parse_ext_op()
+ * - ::lyd_diff_apply_lyb()
  */
 
 /**
@@ -181,6 +184,13 @@ struct ly_in;
                                                        format according to RFC 7951 based on their type. Using this
                                                        option the validation can be softened to accept boolean and
                                                        number type values enclosed in quotes. */
+#define LYD_PARSE_LYB_LAZY 0x10000000       /**< Parse LYB data printed with ::LYD_PRINT_LYB_INDEX lazily. The children of
+                                                 top-level containers and list instances (except the keys) are not parsed,
+                                                 the nodes are marked ::LYD_LYB_STUB instead and the parser uses the index
+                                                 to skip their subtrees. The children are parsed once needed, so the input
+                                                 data must stay valid and unchanged while there are any stubs. Only memory
+                                                 input (::ly_in_new_memory()) is supported and ::LYD_PARSE_ONLY must be used.
+                                                 Data without an index are parsed normally. */
 #define LYD_PARSE_OPTS_MASK 0xFFFF0000      /**< Mask for all the LYD_PARSE_ options. */
 
 /** @} dataparseroptions */
@@ -220,6 +230,9 @@ struct ly_in;
 #define LYD_VALIDATE_NOT_FINAL 0x0020       /**< Skip final validation tasks that require for all the data nodes to
                                                  either exist or not, based on the YANG constraints. Once the data
                                                  satisfy this requirement, the final validation should be performed. */
+#define LYD_VALIDATE_VIRTUAL_DEFAULTS 0x0040 /**< Keep eligible default leaves virtual instead of adding them, see
+                                                 ::LYD_IMPLICIT_VIRTUAL_DFLT. They are then found by lyd_find_path(),
+                                                 XPath, and considered by the printers and lyd_diff_tree(), as needed. */
 
 #define LYD_VALIDATE_OPTS_MASK  0x0000FFFF  /**< Mask for all the LYD_VALIDATE_* options. */
 
@@ -474,6 +487,22 @@ LIBYANG_API_DECL LY_ERR lyd_parse_op(const struct ly_ctx *ctx, struct lyd_node *
 LIBYANG_API_DECL LY_ERR lyd_parse_ext_op(const struct lysc_ext_instance *ext, struct lyd_node *parent, struct ly_in *in,
         LYD_FORMAT format, enum lyd_type data_type, struct lyd_node **tree, struct lyd_node **op);
 
+/**
+ * @brief Parse a diff in the LYB format and apply it on a data tree.
+ *
+ * The diff is expected to be printed with ::LYD_PRINT_LYB_DIFF from a diff of valid data in the same context
+ * (::lyd_diff_siblings()) so it is parsed with ::LYD_PARSE_STORE_ONLY and ::LYD_PARSE_ORDERED, without any validation
+ * of the values. The parsed diff is freed after it is applied. Details about applying a diff are mentioned
+ * in ::lyd_diff_apply_module().
+ *
+ * @param[in] ctx Context of the data and the diff.
+ * @param[in] in Input structure with the LYB diff.
+ * @param[in,out] data Data to apply the diff on.
+ * @return LY_SUCCESS on success,
+ * @return LY_ERR on error.
+ */
+LIBYANG_API_DECL LY_ERR lyd_diff_apply_lyb(const struct ly_ctx *ctx, struct ly_in *in, struct lyd_node **data);
+
 /**
  * @brief Fully validate a data tree.
  *
@@ -67,7 +67,7 @@ typedef void (*lyd_ctx_free_clb)(struct lyd_ctx *ctx);
 /**
  * @brief Internal (common) context for YANG data parsers.
  *
- * Covers ::lyd_xml_ctx, ::lyd_json_ctx and ::lyd_lyb_ctx.
+ * Covers ::lyd_xml_ctx, ::lyd_json_ctx, ::lyd_lyb_ctx and ::lyd_cbor_ctx.
  */
 struct lyd_ctx {
     const struct lysc_ext_instance *ext; /**< extension instance possibly changing document root context of the data being parsed */
@@ -179,6 +179,31 @@ struct lyd_lyb_ctx {
     struct lylyb_ctx *lybctx;      /* LYB context */
 };
 
+/**
+ * @brief Internal context for YANG-CBOR data parser.
+ */
+struct lyd_cbor_ctx {
+    const struct lysc_ext_instance *ext;
+    uint32_t parse_opts;
+    uint32_t val_opts;
+    uint32_t int_opts;
+    uint32_t path_len;
+    char path[LYD_PARSER_BUFSIZE];
+    struct ly_set node_when;
+    struct ly_set node_types;
+    struct ly_set meta_types;
+    struct ly_set ext_node;
+    struct ly_set ext_val;
+    struct lyd_node *op_node;
+    const struct lys_module *val_getnext_ht_mod;
+    struct ly_ht *val_getnext_ht;
+
+    /* callbacks */
+    lyd_ctx_free_clb free;
+
+    struct lycbor_ctx *cborctx;    /**< CBOR context */
+};
+
 /**
  * @brief Parsed extension instance data to validate.
  */
@@ -348,6 +373,26 @@ LY_ERR lyd_parse_lyb(const struct ly_ctx *ctx, const struct lysc_ext_instance *e
         struct lyd_node **first_p, struct ly_in *in, uint32_t parse_opts, uint32_t val_opts, uint32_t int_opts,
         struct ly_set *parsed, ly_bool *subtree_sibling, struct lyd_ctx **lydctx_p);
 
+/**
+ * @brief Parse YANG-CBOR data as a YANG data tree.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] ext Extension instance, not supported.
+ * @param[in] parent Parent to connect the parsed nodes to, if any.
+ * @param[in,out] first_p Pointer to the first top-level parsed node, used only if @p parent is NULL.
+ * @param[in] in Input structure.
+ * @param[in] parse_opts Options for parser, see @ref dataparseroptions.
+ * @param[in] val_opts Options for the validation phase, see @ref datavalidationoptions.
+ * @param[in] int_opts Internal data parser options.
+ * @param[out] parsed Set to add all the parsed siblings into.
+ * @param[out] subtree_sibling Never set, ::LYD_PARSE_SUBTREE is not supported.
+ * @param[out] lydctx_p Data parser context to finish validation.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_parse_cbor(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, struct lyd_node *parent,
+        struct lyd_node **first_p, struct ly_in *in, uint32_t parse_opts, uint32_t val_opts, uint32_t int_opts,
+        struct ly_set *parsed, ly_bool *subtree_sibling, struct lyd_ctx **lydctx_p);
+
 /**
  * @brief Validate eventTime date-and-time value.
  *
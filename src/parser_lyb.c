@@ -15,6 +15,7 @@
 #include "lyb.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -43,22 +44,71 @@
 
 static LY_ERR lyb_parse_siblings(struct lyd_lyb_ctx *lybctx, struct lyd_node *parent, struct lyd_node **first_p,
         struct ly_set *parsed);
+static LY_ERR lyb_parse_node(struct lyd_lyb_ctx *lybctx, struct lyd_node *parent, struct lyd_node **first_p,
+        struct ly_set *parsed);
+
+/**
+ * @brief LYB data with an index being parsed lazily, shared by all the stubs parsed from them.
+ */
+struct lyb_lazy {
+    const char *data;       /**< beginning of the LYB data */
+    const char *index;      /**< index of the data */
+    uint64_t count;         /**< number of index entries */
+    uint32_t refs;          /**< number of stubs referencing the data */
+    ly_bool diff;           /**< diff metadata in the binary form */
+};
+
+/**
+ * @brief Record of a lazily parsed data node (::LYD_LYB_STUB) stored in ::ly_ctx.lyb_stub_ht.
+ */
+struct lyd_lyb_stub {
+    const struct lyd_node *node;        /**< stub node */
+    struct lyb_lazy *lazy;              /**< data the node was parsed from */
+    size_t offset;                      /**< offset of the first unparsed child in the data */
+    struct lyd_lyb_sibling *siblings;   /**< state of the "siblings" at the offset (sized array) */
+    uint32_t parse_opts;                /**< parse options used */
+};
+
+/**
+ * @brief Free a stub record.
+ *
+ * Is expected to be called with ::ly_ctx.lyb_stub_lock held, unless the record was not stored yet.
+ *
+ * @param[in] stub Stub record to free.
+ * @param[in] stored Whether the record was stored and references its data.
+ */
+static void
+lyb_lazy_stub_free(struct lyd_lyb_stub *stub, ly_bool stored)
+{
+    if (!stub) {
+        return;
+    }
+
+    if (stored && !--stub->lazy->refs) {
+        free(stub->lazy);
+    }
+    LY_ARRAY_FREE(stub->siblings);
+    free(stub);
+}
+
+/**
+ * @brief Free a set item of a stub record that was not stored.
+ */
+static void
+lyb_lazy_stub_set_free(void *obj)
+{
+    lyb_lazy_stub_free(obj, 0);
+}
 
 void
 lylyb_ctx_free(struct lylyb_ctx *ctx)
 {
-    LY_ARRAY_COUNT_TYPE u;
-
     if (!ctx) {
         return;
     }
 
     LY_ARRAY_FREE(ctx->siblings);
-
-    LY_ARRAY_FOR(ctx->sib_hts, u) {
-        lyht_free(ctx->sib_hts[u].ht, NULL);
-    }
-    LY_ARRAY_FREE(ctx->sib_hts);
+    ly_set_erase(&ctx->stubs, lyb_lazy_stub_set_free);
 
     free(ctx);
 }
@@ -422,6 +472,61 @@ cleanup:
     return rc;
 }
 
+/**
+ * @brief Parse diff metadata with their value in the binary form.
+ *
+ * @param[in] lybctx LYB context.
+ * @param[in] sparent Schema parent node of the metadata.
+ * @param[in] code Diff code of the metadata.
+ * @param[in,out] meta Metadata list to add to.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_parse_diff_meta(struct lyd_lyb_ctx *lybctx, const struct lysc_node *sparent, uint8_t code, struct lyd_meta **meta)
+{
+    LY_ERR rc;
+    const struct lys_module *mod;
+    const char *name, *value;
+    char *dyn_value = NULL;
+    ly_bool dynamic = 0;
+    uint8_t byte;
+
+    if (code > LYB_DIFF_META_COUNT) {
+        LOGERR(lybctx->lybctx->ctx, LY_EINVAL, "Invalid LYB diff metadata code \"0x%02x\".", code);
+        return LY_EINVAL;
+    }
+    name = lyb_diff_meta_names[code - 1];
+    mod = ly_ctx_get_module_implemented(lybctx->lybctx->ctx, "yang");
+    LY_CHECK_ERR_RET(!mod, LOGINT(lybctx->lybctx->ctx), LY_EINT);
+
+    switch (code) {
+    case LYB_DIFF_META_OPERATION:
+        lyb_read(&byte, 1, lybctx->lybctx);
+        if (byte >= LYB_DIFF_OP_COUNT) {
+            LOGERR(lybctx->lybctx->ctx, LY_EINVAL, "Invalid LYB diff operation \"0x%02x\".", byte);
+            return LY_EINVAL;
+        }
+        value = lyb_diff_op_names[byte];
+        break;
+    case LYB_DIFF_META_ORIG_DEFAULT:
+        lyb_read(&byte, 1, lybctx->lybctx);
+        value = byte ? "true" : "false";
+        break;
+    default:
+        LY_CHECK_RET(lyb_read_string(&dyn_value, sizeof(uint32_t), lybctx->lybctx));
+        value = dyn_value;
+        dynamic = 1;
+        break;
+    }
+
+    rc = lyd_parser_create_meta((struct lyd_ctx *)lybctx, NULL, meta, mod, name, strlen(name), value, strlen(value),
+            &dynamic, LY_VALUE_JSON, NULL, LYD_HINT_DATA, sparent);
+    if (dynamic) {
+        free(dyn_value);
+    }
+    return rc;
+}
+
 /**
  * @brief Parse YANG node metadata.
  *
@@ -435,7 +540,7 @@ lyb_parse_metadata(struct lyd_lyb_ctx *lybctx, const struct lysc_node *sparent,
 {
     LY_ERR ret = LY_SUCCESS;
     ly_bool dynamic;
-    uint8_t i, count = 0;
+    uint8_t i, count = 0, code;
     char *meta_name = NULL, *meta_value;
     const struct lys_module *mod;
 
@@ -444,6 +549,15 @@ lyb_parse_metadata(struct lyd_lyb_ctx *lybctx, const struct lysc_node *sparent,
 
     /* read attributes */
     for (i = 0; i < count; ++i) {
+        if (lybctx->lybctx->diff) {
+            /* diff metadata code */
+            lyb_read(&code, 1, lybctx->lybctx);
+            if (code != LYB_DIFF_META_GENERIC) {
+                LY_CHECK_GOTO(ret = lyb_parse_diff_meta(lybctx, sparent, code, meta), cleanup);
+                continue;
+            }
+        }
+
         /* find module */
         ret = lyb_parse_module(lybctx->lybctx, &mod);
         LY_CHECK_GOTO(ret, cleanup);
@@ -691,32 +805,6 @@ lyb_read_hashes(struct lylyb_ctx *lybctx, LYB_HASH *hash, uint8_t *hash_count)
     return LY_SUCCESS;
 }
 
-/**
- * @brief Check whether a schema node matches a hash(es).
- *
- * @param[in] sibling Schema node to check.
- * @param[in] hash Hash array to check.
- * @param[in] hash_count Number of hashes in @p hash.
- * @return non-zero if matches,
- * @return 0 if not.
- */
-static int
-lyb_is_schema_hash_match(struct lysc_node *sibling, LYB_HASH *hash, uint8_t hash_count)
-{
-    LYB_HASH sibling_hash;
-    uint8_t i;
-
-    /* compare all the hashes starting from collision ID 0 */
-    for (i = 0; i < hash_count; ++i) {
-        sibling_hash = lyb_get_hash(sibling, i);
-        if (sibling_hash != hash[i]) {
-            return 0;
-        }
-    }
-
-    return 1;
-}
-
 /**
  * @brief Parse schema node hash.
  *
@@ -748,22 +836,7 @@ lyb_parse_schema_hash(struct lyd_lyb_ctx *lybctx, const struct lysc_node *sparen
     getnext_opts = lybctx->int_opts & LYD_INTOPT_REPLY ? LYS_GETNEXT_OUTPUT : 0;
 
     /* find our node with matching hashes */
-    sibling = NULL;
-    while (1) {
-        if (!sparent && lybctx->ext) {
-            sibling = lys_getnext_ext(sibling, sparent, lybctx->ext, getnext_opts);
-        } else {
-            sibling = lys_getnext(sibling, sparent, mod ? mod->compiled : NULL, getnext_opts);
-        }
-        if (!sibling) {
-            break;
-        }
-
-        if (lyb_is_schema_hash_match((struct lysc_node *)sibling, hash, hash_count)) {
-            /* match found */
-            break;
-        }
-    }
+    LY_CHECK_RET(lyb_sibs_find(sparent, mod, lybctx->ext, getnext_opts, hash, hash_count, &sibling));
 
     if (!sibling) {
         if (lybctx->ext) {
@@ -847,6 +920,234 @@ lyb_skip_siblings(struct lylyb_ctx *lybctx)
     } while (LYB_LAST_SIBLING(lybctx).written);
 }
 
+/**
+ * @brief Read a number from the LYB index.
+ *
+ * @param[in] ptr Pointer to the number.
+ * @return Read number.
+ */
+static uint64_t
+lyb_lazy_read_number(const char *ptr)
+{
+    uint64_t num;
+
+    memcpy(&num, ptr, LYB_INDEX_OFFSET_BYTES);
+    return le64toh(num);
+}
+
+/**
+ * @brief Prepare lazy parsing of LYB data with an index.
+ *
+ * @param[in] lybctx LYB context.
+ * @param[in] data Beginning of the LYB data.
+ * @param[in] index_offset Offset of the index in @p data.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_lazy_new(struct lylyb_ctx *lybctx, const char *data, uint64_t index_offset)
+{
+    struct lyb_lazy *lazy;
+
+    lazy = calloc(1, sizeof *lazy);
+    LY_CHECK_ERR_RET(!lazy, LOGMEM(lybctx->ctx), LY_EMEM);
+
+    lazy->data = data;
+    lazy->index = data + index_offset;
+    lazy->count = lyb_lazy_read_number(lazy->index + LYB_INDEX_OFFSET_BYTES);
+    lazy->diff = lybctx->diff;
+
+    lybctx->lazy = lazy;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Find the index entry of a subtree.
+ *
+ * @param[in] lazy Indexed data.
+ * @param[in] offset Offset of the "siblings" with the children of the subtree root.
+ * @return Found index entry, NULL if the subtree is not indexed.
+ */
+static const char *
+lyb_lazy_entry_find(const struct lyb_lazy *lazy, uint64_t offset)
+{
+    const char *table, *entry;
+    uint64_t lo = 0, hi = lazy->count, mid, entry_offset;
+
+    /* offsets of the entries follow the index length and the entry count, the entries are sorted */
+    table = lazy->index + 2 * LYB_INDEX_OFFSET_BYTES;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        entry = lazy->data + lyb_lazy_read_number(table + mid * LYB_INDEX_OFFSET_BYTES);
+        entry_offset = lyb_lazy_read_number(entry);
+        if (entry_offset == offset) {
+            return entry;
+        } else if (entry_offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Skip the rest of an indexed subtree, restore the state of all the "siblings" after it.
+ *
+ * @param[in] lybctx LYB context.
+ * @param[in] entry Index entry of the subtree.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_lazy_skip(struct lylyb_ctx *lybctx, const char *entry)
+{
+    LY_ARRAY_COUNT_TYPE u;
+    const char *level;
+    uint64_t end, num;
+    uint8_t depth;
+
+    end = lyb_lazy_read_number(entry + LYB_INDEX_OFFSET_BYTES);
+    depth = entry[2 * LYB_INDEX_OFFSET_BYTES];
+    if ((LY_ARRAY_COUNT_TYPE)depth + 1 != LY_ARRAY_COUNT(lybctx->siblings)) {
+        /* the "siblings" with the children are the last ones */
+        LOGINT_RET(lybctx->ctx);
+    }
+
+    /* the children "siblings" are finished */
+    LY_ARRAY_DECREMENT(lybctx->siblings);
+
+    level = entry + 2 * LYB_INDEX_OFFSET_BYTES + 1;
+    for (u = 0; u < depth; ++u) {
+        num = 0;
+        memcpy(&num, level, LYB_SIZE_BYTES);
+        lybctx->siblings[u].written = le64toh(num);
+        num = 0;
+        memcpy(&num, level + LYB_SIZE_BYTES, LYB_INCHUNK_BYTES);
+        lybctx->siblings[u].inner_chunks = le64toh(num);
+        lybctx->siblings[u].position = level[LYB_META_BYTES];
+
+        level += LYB_INDEX_LEVEL_BYTES;
+    }
+
+    lybctx->in->current = lybctx->lazy->data + end;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Create a stub record of a node whose remaining children are not parsed now.
+ *
+ * @param[in] lybctx LYB context.
+ * @param[in] node Inner node with its "siblings" of children being read.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_lazy_stub_new(struct lyd_lyb_ctx *lybctx, const struct lyd_node *node)
+{
+    struct lylyb_ctx *lyb = lybctx->lybctx;
+    struct lyd_lyb_stub *stub;
+    LY_ARRAY_COUNT_TYPE u, count;
+    LY_ERR rc;
+
+    stub = calloc(1, sizeof *stub);
+    LY_CHECK_ERR_RET(!stub, LOGMEM(lyb->ctx), LY_EMEM);
+
+    stub->node = node;
+    stub->lazy = lyb->lazy;
+    stub->offset = lyb->in->current - lyb->lazy->data;
+    stub->parse_opts = lybctx->parse_opts;
+
+    /* the current state of all the "siblings" */
+    count = LY_ARRAY_COUNT(lyb->siblings);
+    LY_ARRAY_CREATE_GOTO(lyb->ctx, stub->siblings, count, rc, error);
+    for (u = 0; u < count; ++u) {
+        LY_ARRAY_INCREMENT(stub->siblings);
+        stub->siblings[u] = lyb->siblings[u];
+    }
+
+    LY_CHECK_GOTO(rc = ly_set_add(&lyb->stubs, stub, 1, NULL), error);
+    return LY_SUCCESS;
+
+error:
+    lyb_lazy_stub_free(stub, 0);
+    return rc;
+}
+
+/**
+ * @brief Hash table value-equal callback for stub records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyb_lazy_stub_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_lyb_stub *stub1 = *(struct lyd_lyb_stub **)val1_p, *stub2 = *(struct lyd_lyb_stub **)val2_p;
+
+    return stub1->node == stub2->node;
+}
+
+/**
+ * @brief Hash table free callback for stub records.
+ */
+static void
+lyb_lazy_stub_rec_free(void *val_p)
+{
+    lyb_lazy_stub_free(*(struct lyd_lyb_stub **)val_p, 1);
+}
+
+/**
+ * @brief Get hash of a stub node.
+ *
+ * @param[in] node Stub node.
+ * @return Hash.
+ */
+static uint32_t
+lyb_lazy_stub_hash(const struct lyd_node *node)
+{
+    return lyht_hash((const char *)&node, sizeof node);
+}
+
+/**
+ * @brief Store all the stub records created by a parser in the context and mark their nodes.
+ *
+ * Is expected to be called with ::ly_ctx.lyb_stub_lock held.
+ *
+ * @param[in] lybctx LYB context.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_lazy_stubs_store(struct lylyb_ctx *lybctx)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)lybctx->ctx;
+    struct lyd_lyb_stub *stub;
+    struct lyd_node *node;
+    uint32_t i;
+
+    if (!lybctx->stubs.count) {
+        return LY_SUCCESS;
+    }
+
+    if (!ctx->lyb_stub_ht) {
+        ctx->lyb_stub_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_lyb_stub *), lyb_lazy_stub_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RET(!ctx->lyb_stub_ht, LOGMEM(ctx), LY_EMEM);
+    }
+
+    for (i = 0; i < lybctx->stubs.count; ++i) {
+        stub = lybctx->stubs.objs[i];
+        if (lyht_insert(ctx->lyb_stub_ht, &stub, lyb_lazy_stub_hash(stub->node), NULL)) {
+            LOGMEM(ctx);
+            return LY_EMEM;
+        }
+        lybctx->stubs.objs[i] = NULL;
+
+        node = (struct lyd_node *)stub->node;
+        node->flags |= LYD_LYB_STUB;
+        ++stub->lazy->refs;
+    }
+    ly_set_erase(&lybctx->stubs, NULL);
+
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Insert new node to @p parsed set.
  *
@@ -1217,6 +1518,44 @@ error:
     return ret;
 }
 
+/**
+ * @brief Parse the children of an inner node, if parsing lazily and the node is indexed, parse only its keys.
+ *
+ * @param[in] lybctx LYB context.
+ * @param[in] node Inner node whose children to parse.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_parse_node_children(struct lyd_lyb_ctx *lybctx, struct lyd_node *node)
+{
+    struct lylyb_ctx *lyb = lybctx->lybctx;
+    const struct lysc_node *key;
+    const char *entry;
+
+    if (!lyb->lazy || !lyb_index_node(node->schema) ||
+            !(entry = lyb_lazy_entry_find(lyb->lazy, lyb->in->current - lyb->lazy->data))) {
+        return lyb_parse_siblings(lybctx, node, NULL, NULL);
+    }
+
+    /* register new siblings */
+    LY_CHECK_RET(lyb_read_start_siblings(lyb));
+
+    /* the keys are always parsed, they are needed for the instance hash */
+    for (key = lysc_node_child(node->schema); key && (key->flags & LYS_KEY) && LYB_LAST_SIBLING(lyb).written;
+            key = key->next) {
+        LY_CHECK_RET(lyb_parse_node(lybctx, node, NULL, NULL));
+    }
+
+    if (!LYB_LAST_SIBLING(lyb).written) {
+        /* no other children */
+        return lyb_read_stop_siblings(lyb);
+    }
+
+    /* remember where the children continue and skip them */
+    LY_CHECK_RET(lyb_lazy_stub_new(lybctx, node));
+    return lyb_lazy_skip(lyb, entry);
+}
+
 /**
  * @brief Parse inner node.
  *
@@ -1248,7 +1587,7 @@ lyb_parse_node_inner(struct lyd_lyb_ctx *lybctx, struct lyd_node *parent, const
     LOG_LOCSET(NULL, node);
 
     /* process children */
-    ret = lyb_parse_siblings(lybctx, node, NULL, NULL);
+    ret = lyb_parse_node_children(lybctx, node);
     LY_CHECK_GOTO(ret, error);
 
     /* additional procedure for inner node */
@@ -1387,7 +1726,7 @@ lyb_parse_node_list(struct lyd_lyb_ctx *lybctx, struct lyd_node *parent, const s
         log_node = 1;
 
         /* process children */
-        ret = lyb_parse_siblings(lybctx, node, NULL, NULL);
+        ret = lyb_parse_node_children(lybctx, node);
         LY_CHECK_GOTO(ret, error);
 
         /* additional procedure for inner node */
@@ -1558,10 +1897,11 @@ lyb_parse_magic_number(struct lylyb_ctx *lybctx)
  * @brief Parse LYB header.
  *
  * @param[in] lybctx LYB context.
+ * @param[out] index_offset Offset of the index of the data, 0 if there is none.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyb_parse_header(struct lylyb_ctx *lybctx)
+lyb_parse_header(struct lylyb_ctx *lybctx, uint64_t *index_offset)
 {
     uint8_t byte = 0;
     uint32_t hash;
@@ -1586,6 +1926,15 @@ lyb_parse_header(struct lylyb_ctx *lybctx)
 
     /* skip hash checking to support parsing data with less strict requirements (as in the previous versions) */
 
+    /* diff metadata encoding */
+    lybctx->diff = (byte & LYB_HEADER_DIFF) ? 1 : 0;
+
+    *index_offset = 0;
+    if (byte & LYB_HEADER_INDEX) {
+        /* index offset */
+        lyb_read_number(index_offset, sizeof *index_offset, LYB_INDEX_OFFSET_BYTES, lybctx);
+    }
+
     return LY_SUCCESS;
 }
 
@@ -1596,11 +1945,15 @@ lyd_parse_lyb(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, str
 {
     LY_ERR rc = LY_SUCCESS;
     struct lyd_lyb_ctx *lybctx;
+    const char *data = in->current;
+    uint64_t index_offset;
 
     assert(!(parse_opts & ~LYD_PARSE_OPTS_MASK));
     assert(!(val_opts & ~LYD_VALIDATE_OPTS_MASK));
 
     LY_CHECK_ARG_RET(ctx, !(parse_opts & LYD_PARSE_SUBTREE), LY_EINVAL);
+    LY_CHECK_ARG_RET(ctx, !(parse_opts & LYD_PARSE_LYB_LAZY) || ((parse_opts & LYD_PARSE_ONLY) &&
+            (in->type == LY_IN_MEMORY)), LY_EINVAL);
 
     if (subtree_sibling) {
         *subtree_sibling = 0;
@@ -1627,9 +1980,14 @@ lyd_parse_lyb(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, str
     LY_CHECK_GOTO(rc, cleanup);
 
     /* read header */
-    rc = lyb_parse_header(lybctx->lybctx);
+    rc = lyb_parse_header(lybctx->lybctx, &index_offset);
     LY_CHECK_GOTO(rc, cleanup);
 
+    if ((parse_opts & LYD_PARSE_LYB_LAZY) && index_offset && !ext && !(int_opts & ~LYD_INTOPT_WITH_SIBLINGS)) {
+        /* lazy parsing using the index */
+        LY_CHECK_GOTO(rc = lyb_lazy_new(lybctx->lybctx, data, index_offset), cleanup);
+    }
+
     /* read sibling(s) */
     rc = lyb_parse_siblings(lybctx, parent, first_p, parsed);
     LY_CHECK_GOTO(rc, cleanup);
@@ -1648,7 +2006,29 @@ lyd_parse_lyb(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, str
     /* read the last zero, parsing finished */
     ly_in_skip(lybctx->lybctx->in, 1);
 
+    if (index_offset) {
+        /* skip the index */
+        lybctx->lybctx->in->current = data + index_offset + lyb_lazy_read_number(data + index_offset);
+    }
+
+    if (lybctx->lybctx->lazy) {
+        /* store the stubs, they reference the data from now on */
+        pthread_mutex_lock((pthread_mutex_t *)&ctx->lyb_stub_lock);
+        rc = lyb_lazy_stubs_store(lybctx->lybctx);
+        if (!lybctx->lybctx->lazy->refs) {
+            free(lybctx->lybctx->lazy);
+        }
+        pthread_mutex_unlock((pthread_mutex_t *)&ctx->lyb_stub_lock);
+        lybctx->lybctx->lazy = NULL;
+        LY_CHECK_GOTO(rc, cleanup);
+    }
+
 cleanup:
+    if (rc && lybctx->lybctx && lybctx->lybctx->lazy) {
+        /* no stubs were stored */
+        free(lybctx->lybctx->lazy);
+    }
+
     /* there should be no unres stored if validation should be skipped */
     assert(!(parse_opts & LYD_PARSE_ONLY) || (!lybctx->node_types.count && !lybctx->meta_types.count &&
             !lybctx->node_when.count));
@@ -1667,6 +2047,7 @@ lyd_lyb_data_length(const char *data)
     LY_ERR ret = LY_SUCCESS;
     struct lylyb_ctx *lybctx;
     uint32_t count;
+    uint64_t index_offset;
     uint8_t zero[LYB_SIZE_BYTES] = {0};
 
     if (!data) {
@@ -1683,9 +2064,15 @@ lyd_lyb_data_length(const char *data)
     LY_CHECK_GOTO(ret, cleanup);
 
     /* read header */
-    ret = lyb_parse_header(lybctx);
+    ret = lyb_parse_header(lybctx, &index_offset);
     LY_CHECK_GOTO(ret, cleanup);
 
+    if (index_offset) {
+        /* the data end with the index */
+        lybctx->in->current = data + index_offset + lyb_lazy_read_number(data + index_offset);
+        goto cleanup;
+    }
+
     if (memcmp(zero, lybctx->in->current, LYB_SIZE_BYTES)) {
         /* register a new sibling */
         ret = lyb_read_start_siblings(lybctx);
@@ -1712,3 +2099,160 @@ cleanup:
 
     return ret ? -1 : (int)count;
 }
+
+/**
+ * @brief Stub node whose children are being parsed by this thread, its ::LYD_LYB_STUB flag is cleared only once
+ * the children are complete so that concurrent readers wait for them.
+ */
+static THREAD_LOCAL const struct lyd_node *lyb_stub_loading;
+
+/**
+ * @brief Parse the remaining children of a stub node.
+ *
+ * Is expected to be called with ::ly_ctx.lyb_stub_lock held.
+ *
+ * @param[in] stub Stub record of the node, removed from the context.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_lazy_stub_parse(struct lyd_lyb_stub *stub)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyd_node *node = (struct lyd_node *)stub->node;
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_lyb_ctx *lybctx;
+    struct ly_in *in = NULL;
+    ly_bool log_node = 0;
+
+    lybctx = calloc(1, sizeof *lybctx);
+    LY_CHECK_ERR_RET(!lybctx, LOGMEM(ctx), LY_EMEM);
+    lybctx->lybctx = calloc(1, sizeof *lybctx->lybctx);
+    LY_CHECK_ERR_GOTO(!lybctx->lybctx, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    LY_CHECK_GOTO(rc = ly_in_new_memory(stub->lazy->data, &in), cleanup);
+    in->current = stub->lazy->data + stub->offset;
+
+    lybctx->lybctx->in = in;
+    lybctx->lybctx->ctx = ctx;
+    lybctx->lybctx->lazy = stub->lazy;
+    lybctx->lybctx->diff = stub->lazy->diff;
+    lybctx->lybctx->siblings = stub->siblings;
+    lybctx->lybctx->sibling_size = LY_ARRAY_COUNT(stub->siblings);
+    stub->siblings = NULL;
+    lybctx->parse_opts = stub->parse_opts;
+    lybctx->int_opts = LYD_INTOPT_WITH_SIBLINGS;
+    lybctx->free = lyd_lyb_ctx_free;
+
+    /* the rest of the children, linking them must not load the node again */
+    lyb_stub_loading = node;
+    LOG_LOCSET(NULL, node);
+    log_node = 1;
+    while (LYB_LAST_SIBLING(lybctx->lybctx).written) {
+        LY_CHECK_GOTO(rc = lyb_parse_node(lybctx, node, NULL, NULL), cleanup);
+    }
+    LY_CHECK_GOTO(rc = lyb_read_stop_siblings(lybctx->lybctx), cleanup);
+
+    /* any nested stubs */
+    rc = lyb_lazy_stubs_store(lybctx->lybctx);
+
+cleanup:
+    if (log_node) {
+        LOG_LOCBACK(0, 1);
+    }
+
+    /* publish the children, the stub record is gone even on error */
+    lyb_stub_loading = NULL;
+    ATOMIC_FLAGS_AND_RELEASE(node->flags, ~LYD_LYB_STUB);
+    ly_in_free(in, 0);
+    lyd_lyb_ctx_free((struct lyd_ctx *)lybctx);
+    return rc;
+}
+
+LY_ERR
+lyd_lyb_stub_load(const struct lyd_node *node)
+{
+    struct ly_ctx *ctx;
+    struct lyd_lyb_stub stub_key = {.node = node}, *stub_p = &stub_key, *stub = NULL;
+    LY_ERR rc = LY_SUCCESS;
+
+    if (!node || !(ATOMIC_FLAGS_LOAD_ACQUIRE(node->flags) & LYD_LYB_STUB) || (node == lyb_stub_loading)) {
+        /* loaded or being loaded by this thread */
+        return LY_SUCCESS;
+    }
+
+    ctx = (struct ly_ctx *)LYD_CTX(node);
+    pthread_mutex_lock(&ctx->lyb_stub_lock);
+
+    /* another thread may have loaded the node meanwhile */
+    if (ctx->lyb_stub_ht && !lyht_find(ctx->lyb_stub_ht, &stub_p, lyb_lazy_stub_hash(node), (void **)&stub_p)) {
+        stub = *(struct lyd_lyb_stub **)stub_p;
+        lyht_remove(ctx->lyb_stub_ht, &stub, lyb_lazy_stub_hash(node));
+        rc = lyb_lazy_stub_parse(stub);
+        lyb_lazy_stub_free(stub, 1);
+    }
+
+    pthread_mutex_unlock(&ctx->lyb_stub_lock);
+    return rc;
+}
+
+LY_ERR
+lyd_lyb_stub_load_siblings(const struct lyd_node *first)
+{
+    const struct lyd_node *iter;
+
+    if (!first || !LYD_CTX(first)->lyb_stub_ht) {
+        /* no stubs */
+        return LY_SUCCESS;
+    }
+
+    LY_LIST_FOR(first, iter) {
+        LY_CHECK_RET(lyd_lyb_materialize((struct lyd_node *)iter, 1));
+    }
+
+    return LY_SUCCESS;
+}
+
+void
+lyd_lyb_stub_free_node(const struct lyd_node *node)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)LYD_CTX(node);
+    struct lyd_lyb_stub stub_key = {.node = node}, *stub_p = &stub_key, *stub;
+
+    if (!(node->flags & LYD_LYB_STUB)) {
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->lyb_stub_lock);
+    if (ctx->lyb_stub_ht && !lyht_find(ctx->lyb_stub_ht, &stub_p, lyb_lazy_stub_hash(node), (void **)&stub_p)) {
+        stub = *(struct lyd_lyb_stub **)stub_p;
+        lyht_remove(ctx->lyb_stub_ht, &stub, lyb_lazy_stub_hash(node));
+        lyb_lazy_stub_free(stub, 1);
+    }
+    pthread_mutex_unlock(&ctx->lyb_stub_lock);
+}
+
+void
+lyd_lyb_stub_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->lyb_stub_ht, lyb_lazy_stub_rec_free);
+    ctx->lyb_stub_ht = NULL;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_lyb_materialize(struct lyd_node *node, ly_bool recursive)
+{
+    struct lyd_node *elem;
+
+    LY_CHECK_ARG_RET(NULL, node, LY_EINVAL);
+
+    if (!recursive) {
+        return lyd_lyb_stub_load(node);
+    }
+
+    LYD_TREE_DFS_BEGIN(node, elem) {
+        /* the children are loaded before the DFS moves to them */
+        LY_CHECK_RET(lyd_lyb_stub_load(elem));
+        LYD_TREE_DFS_END(node, elem);
+    }
+
+    return LY_SUCCESS;
+}
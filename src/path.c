@@ -1329,7 +1329,7 @@ ly_path_eval_partial(const struct ly_path *path, const struct lyd_node *start, c
 
     if (lysc_data_parent(path[0].node)) {
         /* relative path, start from the parent children */
-        start = lyd_child(start);
+        start = lyd_child_load(start);
     } else {
         /* absolute path, start from the first top-level sibling */
         while (start->parent) {
@@ -1358,20 +1358,20 @@ ly_path_eval_partial(const struct ly_path *path, const struct lyd_node *start, c
             case LY_PATH_PREDTYPE_LEAFLIST:
                 /* we will use hashes to find one leaf-list instance */
                 LY_CHECK_RET(lyd_create_term2(path[u].node, &path[u].predicates[0].value, &target));
-                lyd_find_sibling_first(start, target, &node);
+                lyd_find_sibling_first_(start, target, &node);
                 lyd_free_tree(target);
                 break;
             case LY_PATH_PREDTYPE_LIST_VAR:
             case LY_PATH_PREDTYPE_LIST:
                 /* we will use hashes to find one list instance */
                 LY_CHECK_RET(lyd_create_list(path[u].node, path[u].predicates, vars, 1, &target));
-                lyd_find_sibling_first(start, target, &node);
+                lyd_find_sibling_first_(start, target, &node);
                 lyd_free_tree(target);
                 break;
             }
         } else {
             /* we will use hashes to find one any/container/leaf instance */
-            if (lyd_find_sibling_val(start, path[u].node, NULL, 0, &node) && with_opaq) {
+            if (lyd_find_sibling_val_(start, path[u].node, NULL, 0, &node) && with_opaq) {
                 if (!lyd_find_sibling_opaq_next(start, path[u].node->name, &node) &&
                         (lyd_node_module(node) != path[u].node->module)) {
                     /* non-matching opaque node */
@@ -1388,8 +1388,8 @@ ly_path_eval_partial(const struct ly_path *path, const struct lyd_node *start, c
         /* rememeber previous node */
         prev_node = node;
 
-        /* next path segment, if any */
-        start = lyd_child(node);
+        /* next path segment, if any, the found node itself is not parsed if it is a lazy LYB stub */
+        start = (u + 1 < LY_ARRAY_COUNT(path)) ? lyd_child_load(node) : lyd_child(node);
     }
 
     if (node) {
@@ -1428,8 +1428,15 @@ ly_path_eval(const struct ly_path *path, const struct lyd_node *start, const str
 {
     LY_ERR ret;
     struct lyd_node *m;
+    LY_ARRAY_COUNT_TYPE path_idx;
 
-    ret = ly_path_eval_partial(path, start, vars, 0, NULL, &m);
+    ret = ly_path_eval_partial(path, start, vars, 0, &path_idx, &m);
+    if ((ret == LY_EINCOMPLETE) && (path_idx + 2 == LY_ARRAY_COUNT(path)) && !path[path_idx + 1].predicates) {
+        /* only the last leaf is missing, it may be a virtual default */
+        if (!lyd_dflt_virtual_get(m, path[path_idx + 1].node, &m)) {
+            ret = LY_SUCCESS;
+        }
+    }
 
     if (ret == LY_SUCCESS) {
         /* last node was found */
@@ -85,4 +85,19 @@ struct lyplg_type *lyplg_type_plugin_find(const struct ly_ctx *ctx, const char *
  */
 struct lyplg_ext_record *lyplg_ext_record_find(const struct ly_ctx *ctx, const char *module, const char *revision, const char *name);
 
+/**
+ * @brief Start caching the targets of the leafrefs resolved by ::lyplg_type_resolve_leafref() in this thread.
+ *
+ * Meant for resolving many leafrefs at once, the targets of all the leafrefs with the same path are collected only
+ * once. The data trees must not be modified until the caching is stopped.
+ *
+ * @param[out] started Set if the caching was started, not if it has already been active.
+ */
+void lyplg_type_leafref_cache_start(ly_bool *started);
+
+/**
+ * @brief Stop caching the targets of leafrefs and free the cache.
+ */
+void lyplg_type_leafref_cache_stop(void);
+
 #endif /* LY_PLUGINS_INTERNAL_H_ */
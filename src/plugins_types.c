@@ -27,6 +27,7 @@
 #include "compat.h"
 #include "context.h"
 #include "dict.h"
+#include "hash_table_internal.h"
 #include "ly_common.h"
 #include "path.h"
 #include "plugins_internal.h"
@@ -349,6 +350,21 @@ lyplg_type_print_simple(const struct ly_ctx *UNUSED(ctx), const struct lyd_value
     return value->_canonical;
 }
 
+LIBYANG_API_DEF LY_ERR
+lyplg_type_cache_canonical(const struct ly_ctx *ctx, const struct lyd_value *value, char *canon)
+{
+    const char *dict_canon;
+
+    LY_CHECK_RET(lydict_insert_zc(ctx, canon, &dict_canon));
+
+    /* publish the value only if no other thread did */
+    if (!ATOMIC_PTR_CAS(((struct lyd_value *)value)->_canonical, NULL, dict_canon)) {
+        lydict_remove(ctx, dict_canon);
+    }
+
+    return LY_SUCCESS;
+}
+
 LIBYANG_API_DEF LY_ERR
 lyplg_type_dup_simple(const struct ly_ctx *ctx, const struct lyd_value *original, struct lyd_value *dup)
 {
@@ -910,9 +926,16 @@ LIBYANG_API_DEF LY_ERR
 lyplg_type_identity_isderived(const struct lysc_ident *base, const struct lysc_ident *der)
 {
     LY_ARRAY_COUNT_TYPE u;
+    LY_ERR rc;
 
     assert(base->module->ctx == der->module->ctx);
 
+    /* precomputed closure of all the bases of the identity */
+    rc = lys_ident_closure_isderived(base, der);
+    if (rc != LY_ENOT) {
+        return rc;
+    }
+
     LY_ARRAY_FOR(base->derived, u) {
         if (der == base->derived[u]) {
             return LY_SUCCESS;
@@ -924,6 +947,291 @@ lyplg_type_identity_isderived(const struct lysc_ident *base, const struct lysc_i
     return LY_ENOTFOUND;
 }
 
+/**
+ * @brief Leafref targets of a single leafref path in a single context, with values collected once and then
+ * looked up for every leafref.
+ */
+struct lyplg_leafref_cache_rec {
+    const struct lyxp_expr *path;   /**< leafref path */
+    const struct lyd_node *anchor;  /**< data node relative @p path is evaluated from, NULL for an absolute path */
+    const struct lyd_node *tree;    /**< data tree @p path is evaluated on */
+    uint32_t uses;                  /**< number of leafrefs resolved using the record */
+    struct ly_ht *targets_ht;       /**< hash table of the targets (struct lyplg_leafref_cache_target), created
+                                         only for a record used repeatedly */
+    ly_bool unusable;               /**< set if the targets could not be collected */
+};
+
+/**
+ * @brief Leafref target in a cache record.
+ */
+struct lyplg_leafref_cache_target {
+    const char *value;              /**< canonical value of @p node */
+    const struct lysc_type *realtype; /**< type of the value of @p node, the member type for a union */
+    const struct lyd_node *node;    /**< target node */
+};
+
+/**
+ * @brief Thread-specific cache of the leafref targets, active while validating a batch of values.
+ */
+static THREAD_LOCAL struct {
+    ly_bool active;                 /**< whether the cache is used */
+    struct ly_ht *recs_ht;          /**< hash table of the records (struct lyplg_leafref_cache_rec *) */
+} leafref_cache;
+
+/**
+ * @brief Hash table value-equal callback for leafref cache records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyplg_leafref_cache_rec_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyplg_leafref_cache_rec *rec1 = *(struct lyplg_leafref_cache_rec **)val1_p;
+    struct lyplg_leafref_cache_rec *rec2 = *(struct lyplg_leafref_cache_rec **)val2_p;
+
+    return (rec1->path == rec2->path) && (rec1->anchor == rec2->anchor) && (rec1->tree == rec2->tree);
+}
+
+/**
+ * @brief Hash table value-equal callback for leafref cache targets.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyplg_leafref_cache_target_equal_cb(void *val1_p, void *val2_p, ly_bool mod, void *UNUSED(cb_data))
+{
+    struct lyplg_leafref_cache_target *target1 = val1_p, *target2 = val2_p;
+
+    if (mod) {
+        return target1->node == target2->node;
+    }
+    return (target1->realtype == target2->realtype) && !strcmp(target1->value, target2->value);
+}
+
+/**
+ * @brief Get the type and hash of a value for the leafref cache.
+ *
+ * Values of different types with the same canonical value must not match so the actual type of a union value is used.
+ *
+ * @param[in] value Value to use.
+ * @param[in] val_str Canonical value of @p value.
+ * @param[out] realtype Type of the value.
+ * @return Hash of the value.
+ */
+static uint32_t
+lyplg_leafref_cache_target_hash(const struct lyd_value *value, const char *val_str, const struct lysc_type **realtype)
+{
+    uint32_t hash;
+
+    if ((value->realtype->basetype == LY_TYPE_UNION) && value->subvalue) {
+        *realtype = value->subvalue->value.realtype;
+    } else {
+        *realtype = value->realtype;
+    }
+
+    hash = lyht_hash_multi(0, val_str, strlen(val_str));
+    hash = lyht_hash_multi(hash, (const char *)realtype, sizeof *realtype);
+    return lyht_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Free a leafref cache record.
+ *
+ * @param[in] val_p Pointer to the record to free.
+ */
+static void
+lyplg_leafref_cache_rec_free(void *val_p)
+{
+    struct lyplg_leafref_cache_rec *rec = *(struct lyplg_leafref_cache_rec **)val_p;
+
+    lyht_free(rec->targets_ht, NULL);
+    free(rec);
+}
+
+void
+lyplg_type_leafref_cache_start(ly_bool *started)
+{
+    *started = 0;
+    if (!leafref_cache.active) {
+        leafref_cache.active = 1;
+        *started = 1;
+    }
+}
+
+void
+lyplg_type_leafref_cache_stop(void)
+{
+    lyht_free(leafref_cache.recs_ht, lyplg_leafref_cache_rec_free);
+    leafref_cache.recs_ht = NULL;
+    leafref_cache.active = 0;
+}
+
+/**
+ * @brief Learn the data node a leafref path depends on, if its targets do not depend on anything else.
+ *
+ * Supported are absolute paths and relative paths starting with parent steps, both without predicates.
+ *
+ * @param[in] path Leafref path.
+ * @param[in] node Leafref node.
+ * @param[out] anchor Data node the targets depend on, NULL for an absolute path.
+ * @return Whether the targets of @p path can be cached.
+ */
+static ly_bool
+lyplg_leafref_cache_path_anchor(const struct lyxp_expr *path, const struct lyd_node *node, const struct lyd_node **anchor)
+{
+    uint32_t i = 0;
+
+    *anchor = NULL;
+    if (path->tokens[0] != LYXP_TOKEN_OPER_PATH) {
+        /* ".." steps */
+        *anchor = node;
+        while ((i + 1 < path->used) && (path->tokens[i] == LYXP_TOKEN_DDOT) &&
+                (path->tokens[i + 1] == LYXP_TOKEN_OPER_PATH)) {
+            *anchor = lyd_parent(*anchor);
+            if (!*anchor) {
+                /* the document root */
+                return 0;
+            }
+            i += 2;
+        }
+        if (!i) {
+            return 0;
+        }
+    }
+
+    /* the rest must be only node name tests */
+    for ( ; i < path->used; ++i) {
+        if ((path->tokens[i] != LYXP_TOKEN_OPER_PATH) && (path->tokens[i] != LYXP_TOKEN_NAMETEST)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Collect the targets of a leafref cache record.
+ *
+ * @param[in] rec Record to fill.
+ * @param[in] lref Leafref type.
+ * @param[in] node Leafref node.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyplg_leafref_cache_rec_fill(struct lyplg_leafref_cache_rec *rec, const struct lysc_type_leafref *lref,
+        const struct lyd_node *node)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_set set = {0};
+    struct lyplg_leafref_cache_target target;
+    uint32_t i, hash, temp_lo = 0, *prev_lo;
+
+    /* evaluate the path without the value, any error is generated again when resolving the leafref */
+    prev_lo = ly_temp_log_options(&temp_lo);
+    rc = lyxp_eval(LYD_CTX(node), lref->path, node->schema->module, LY_VALUE_SCHEMA_RESOLVED, lref->prefixes, node,
+            node, rec->tree, NULL, &set, LYXP_IGNORE_WHEN);
+    ly_temp_log_options(prev_lo);
+    LY_CHECK_GOTO(rc, cleanup);
+
+    rec->targets_ht = lyht_new(lyht_get_fixed_size(set.used), sizeof target, lyplg_leafref_cache_target_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!rec->targets_ht, LOGMEM(LYD_CTX(node)); rc = LY_EMEM, cleanup);
+
+    for (i = 0; i < set.used; ++i) {
+        if ((set.val.nodes[i].type != LYXP_NODE_ELEM) || !(set.val.nodes[i].node->schema->nodetype & LYD_NODE_TERM)) {
+            continue;
+        }
+
+        target.node = set.val.nodes[i].node;
+        target.value = lyd_get_value(target.node);
+        LY_CHECK_ERR_GOTO(!target.value, rc = LY_EMEM, cleanup);
+        hash = lyplg_leafref_cache_target_hash(&((struct lyd_node_term *)target.node)->value, target.value,
+                &target.realtype);
+        LY_CHECK_GOTO(rc = lyht_insert_no_check(rec->targets_ht, &target, hash, NULL), cleanup);
+    }
+
+cleanup:
+    lyxp_set_free_content(&set);
+    if (rc) {
+        lyht_free(rec->targets_ht, NULL);
+        rec->targets_ht = NULL;
+    }
+    return rc;
+}
+
+/**
+ * @brief Find leafref targets in the leafref cache.
+ *
+ * @param[in] lref Leafref type.
+ * @param[in] node Leafref node.
+ * @param[in] value Leafref value.
+ * @param[in] val_str Canonical leafref value.
+ * @param[in] tree Full data tree to search in.
+ * @param[out] targets Optional set of target nodes.
+ * @return LY_SUCCESS if some targets were found;
+ * @return LY_ENOTFOUND if there are no targets;
+ * @return LY_ENOT if the cache cannot be used;
+ * @return LY_ERR on error.
+ */
+static LY_ERR
+lyplg_leafref_cache_find(const struct lysc_type_leafref *lref, const struct lyd_node *node, const struct lyd_value *value,
+        const char *val_str, const struct lyd_node *tree, struct ly_set **targets)
+{
+    struct lyplg_leafref_cache_rec rec_key = {0}, *rec = &rec_key, **rec_p;
+    struct lyplg_leafref_cache_target target = {0}, *target_p;
+    uint32_t hash;
+
+    if (!lyplg_leafref_cache_path_anchor(lref->path, node, &rec_key.anchor)) {
+        return LY_ENOT;
+    }
+    rec_key.path = lref->path;
+    rec_key.tree = tree;
+
+    if (!leafref_cache.recs_ht) {
+        leafref_cache.recs_ht = lyht_new(LYHT_MIN_SIZE, sizeof rec, lyplg_leafref_cache_rec_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RET(!leafref_cache.recs_ht, LOGMEM(LYD_CTX(node)), LY_EMEM);
+    }
+
+    /* find the record, create it if not yet */
+    hash = lyht_hash_multi(0, (const char *)&rec_key.path, sizeof rec_key.path);
+    hash = lyht_hash_multi(hash, (const char *)&rec_key.anchor, sizeof rec_key.anchor);
+    hash = lyht_hash_multi(hash, (const char *)&rec_key.tree, sizeof rec_key.tree);
+    hash = lyht_hash_multi(hash, NULL, 0);
+    if (!lyht_find(leafref_cache.recs_ht, &rec, hash, (void **)&rec_p)) {
+        rec = *rec_p;
+    } else {
+        rec = malloc(sizeof *rec);
+        LY_CHECK_ERR_RET(!rec, LOGMEM(LYD_CTX(node)), LY_EMEM);
+        *rec = rec_key;
+        LY_CHECK_ERR_RET(lyht_insert(leafref_cache.recs_ht, &rec, hash, NULL), free(rec), LY_EMEM);
+    }
+
+    if (rec->unusable || (++rec->uses < 2)) {
+        /* a single leafref is faster to resolve using the value */
+        return LY_ENOT;
+    }
+
+    if (!rec->targets_ht && lyplg_leafref_cache_rec_fill(rec, lref, node)) {
+        rec->unusable = 1;
+        return LY_ENOT;
+    }
+
+    /* find the targets */
+    target.value = val_str;
+    hash = lyplg_leafref_cache_target_hash(value, val_str, &target.realtype);
+    if (lyht_find(rec->targets_ht, &target, hash, (void **)&target_p)) {
+        return LY_ENOTFOUND;
+    }
+
+    if (targets) {
+        LY_CHECK_RET(ly_set_new(targets));
+        do {
+            LY_CHECK_RET(ly_set_add(*targets, target_p->node, 1, NULL));
+        } while (!lyht_find_next(rec->targets_ht, target_p, hash, (void **)&target_p));
+    }
+
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Try to generate a path to the leafref target with its value to enable the use of hash-based search.
  *
@@ -1026,6 +1334,22 @@ lyplg_type_resolve_leafref(const struct lysc_type_leafref *lref, const struct ly
     /* get the canonical value */
     val_str = lyd_value_get_canonical(LYD_CTX(node), value);
 
+    if (leafref_cache.active) {
+        /* try to use the targets collected for all the leafrefs with the same path */
+        r = lyplg_leafref_cache_find(lref, node, value, val_str, tree, targets);
+        if (r == LY_ENOTFOUND) {
+            rc = LY_ENOTFOUND;
+            if (asprintf(errmsg, LY_ERRMSG_NOLREF_VAL, val_str, lref->path->expr) == -1) {
+                *errmsg = NULL;
+                rc = LY_EMEM;
+            }
+            goto cleanup;
+        } else if (r != LY_ENOT) {
+            rc = r;
+            goto cleanup;
+        }
+    }
+
     if (!strchr(val_str, '\"') || !strchr(val_str, '\'')) {
         /* get the path with the value */
         r = lyplg_type_resolve_leafref_get_target_path(lref->path, node->schema, LY_VALUE_SCHEMA_RESOLVED, lref->prefixes,
@@ -461,6 +461,20 @@ LIBYANG_API_DECL void lyplg_type_lypath_free(const struct ly_ctx *ctx, struct ly
 LIBYANG_API_DECL LY_ERR lyplg_type_print_xpath10_value(const struct lyd_value_xpath10 *xp_val, LY_VALUE_FORMAT format,
         void *prefix_data, char **str_value, struct ly_err_item **err);
 
+/**
+ * @brief Cache a canonical value generated by a print callback in ::lyd_value._canonical.
+ *
+ * Print callbacks generating the canonical value only when it is first needed must use this function so that
+ * the same value can be printed by several threads concurrently. If another thread has meanwhile cached
+ * its canonical value, @p canon is discarded and the cached value is kept.
+ *
+ * @param[in] ctx libyang context with the dictionary.
+ * @param[in] value Value to cache the canonical value of.
+ * @param[in] canon Generated canonical value, is spent.
+ * @return LY_ERR value.
+ */
+LIBYANG_API_DECL LY_ERR lyplg_type_cache_canonical(const struct ly_ctx *ctx, const struct lyd_value *value, char *canon);
+
 /**
  * @defgroup plugintypestoreopts Plugins: Type store callback options.
  *
@@ -417,14 +417,14 @@ lyplg_type_print_binary(const struct ly_ctx *ctx, const struct lyd_value *value,
     }
 
     /* generate canonical value if not already */
-    if (!value->_canonical) {
+    if (!ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical)) {
         /* get the base64 string value */
         if (binary_base64_encode(ctx, val->data, val->size, &ret, &ret_len)) {
             return NULL;
         }
 
         /* store it */
-        if (lydict_insert_zc(ctx, ret, (const char **)&value->_canonical)) {
+        if (lyplg_type_cache_canonical(ctx, value, ret)) {
             LOGMEM(ctx);
             return NULL;
         }
@@ -416,14 +416,14 @@ lyplg_type_print_bits(const struct ly_ctx *ctx, const struct lyd_value *value, L
     }
 
     /* generate canonical value if not already */
-    if (!value->_canonical) {
+    if (!ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical)) {
         /* get the canonical value */
         if (bits_items2canon(val->items, &ret)) {
             return NULL;
         }
 
         /* store it */
-        if (lydict_insert_zc(ctx, ret, (const char **)&value->_canonical)) {
+        if (lyplg_type_cache_canonical(ctx, value, ret)) {
             LOGMEM(ctx);
             return NULL;
         }
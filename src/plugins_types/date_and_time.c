@@ -295,7 +295,7 @@ lyplg_type_print_date_and_time(const struct ly_ctx *ctx, const struct lyd_value
     }
 
     /* generate canonical value if not already */
-    if (!value->_canonical) {
+    if (!ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical)) {
         if (val->unknown_tz) {
             /* ly_time_time2str but always using GMT */
             if (!gmtime_r(&val->time, &tm)) {
@@ -313,7 +313,7 @@ lyplg_type_print_date_and_time(const struct ly_ctx *ctx, const struct lyd_value
         }
 
         /* store it */
-        if (lydict_insert_zc(ctx, ret, (const char **)&value->_canonical)) {
+        if (lyplg_type_cache_canonical(ctx, value, ret)) {
             LOGMEM(ctx);
             return NULL;
         }
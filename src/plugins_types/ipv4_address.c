@@ -294,7 +294,7 @@ lyplg_type_print_ipv4_address(const struct ly_ctx *ctx, const struct lyd_value *
     }
 
     /* generate canonical value if not already */
-    if (!value->_canonical) {
+    if (!ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical)) {
         /* '%' + zone */
         zone_len = val->zone ? strlen(val->zone) + 1 : 0;
         ret = malloc(INET_ADDRSTRLEN + zone_len);
@@ -313,7 +313,7 @@ lyplg_type_print_ipv4_address(const struct ly_ctx *ctx, const struct lyd_value *
         }
 
         /* store it */
-        if (lydict_insert_zc(ctx, ret, (const char **)&value->_canonical)) {
+        if (lyplg_type_cache_canonical(ctx, value, ret)) {
             LOGMEM(ctx);
             return NULL;
         }
@@ -32,7 +32,7 @@ lyplg_type_store_lyds(const struct ly_ctx *ctx, const struct lysc_type *type, co
         struct lys_glob_unres *UNUSED(unres), struct ly_err_item **UNUSED(err))
 {
     int ret;
-    struct rb_node *rbt = NULL;
+    struct lyds_tree *tree = NULL;
     struct lyd_value_lyds_tree *val = NULL;
 
     /* Prepare value memory. */
@@ -48,13 +48,13 @@ lyplg_type_store_lyds(const struct ly_ctx *ctx, const struct lysc_type *type, co
         return LY_EVALID;
     }
 
-    /* Create a new Red-black tree. The insertion of additional data nodes should be done via lyds_insert(). */
-    ret = lyds_create_node((struct lyd_node *)value, &rbt);
+    /* Create a new lyds tree. The insertion of additional data nodes should be done via lyds_insert(). */
+    ret = lyds_create_tree((struct lyd_node *)value, &tree);
     LY_CHECK_GOTO(ret, cleanup);
 
-    /* Set the root of the Red-black tree. */
+    /* Set the lyds tree. */
     storage->realtype = type;
-    val->rbt = rbt;
+    val->rbt = tree;
 
 cleanup:
     if (ret) {
@@ -73,7 +73,7 @@ lyplg_type_free_lyds(const struct ly_ctx *UNUSED(ctx), struct lyd_value *value)
     assert(!value->_canonical);
     LYD_VALUE_GET(value, val);
 
-    /* Release Red-black tree. */
+    /* Release lyds tree. */
     lyds_free_tree(val->rbt);
     LYPLG_TYPE_VAL_INLINE_DESTROY(val);
     memset(value->fixed_mem, 0, LYD_VALUE_FIXED_MEM_SIZE);
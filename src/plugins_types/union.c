@@ -663,6 +663,7 @@ lyplg_type_print_union(const struct ly_ctx *ctx, const struct lyd_value *value,
     struct lyd_value_union *subvalue = value->subvalue;
     struct lysc_type_union *type_u = (struct lysc_type_union *)value->realtype;
     size_t lyb_data_len = 0;
+    const char *canon;
 
     if ((format == LY_VALUE_LYB) && (subvalue->format == LY_VALUE_LYB)) {
         /* The return value is already ready. */
@@ -683,9 +684,13 @@ lyplg_type_print_union(const struct ly_ctx *ctx, const struct lyd_value *value,
 
     assert(format != LY_VALUE_LYB);
     ret = (void *)subvalue->value.realtype->plugin->print(ctx, &subvalue->value, format, prefix_data, dynamic, value_len);
-    if (!value->_canonical && (format == LY_VALUE_CANON)) {
+    if (!ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical) && (format == LY_VALUE_CANON)) {
         /* the canonical value is supposed to be stored now */
-        lydict_insert(ctx, subvalue->value._canonical, 0, (const char **)&value->_canonical);
+        if (!lydict_dup(ctx, subvalue->value._canonical, &canon) &&
+                !ATOMIC_PTR_CAS(((struct lyd_value *)value)->_canonical, NULL, canon)) {
+            /* stored meanwhile by another thread */
+            lydict_remove(ctx, canon);
+        }
     }
 
     return ret;
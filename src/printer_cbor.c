@@ -0,0 +1,420 @@
+/**
+ * @file printer_cbor.c
+ * @brief YANG-CBOR printer for libyang data structure
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include "cbor.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "context.h"
+#include "log.h"
+#include "ly_common.h"
+#include "out.h"
+#include "out_internal.h"
+#include "printer_data.h"
+#include "printer_internal.h"
+#include "set.h"
+#include "tree.h"
+#include "tree_data.h"
+#include "tree_data_internal.h"
+#include "tree_schema.h"
+
+/**
+ * @brief YANG-CBOR printer context.
+ */
+struct cborpr_ctx {
+    struct ly_out *out;         /**< output specification */
+    const struct ly_ctx *ctx;   /**< libyang context of the printed data */
+    uint32_t options;           /**< [Data printer flags](@ref dataprinterflags) */
+};
+
+static LY_ERR cbor_print_siblings(struct cborpr_ctx *pctx, const struct ly_set *nodes, const struct lysc_node *sparent,
+        uint64_t base_sid);
+
+/**
+ * @brief Print a member key of a data node.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] snode Schema node of the member.
+ * @param[in] sparent Schema parent of the member, NULL for top-level nodes.
+ * @param[in] base_sid SID of @p sparent or of the parent any node, the base of delta SIDs, 0 if it has none.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_key(struct cborpr_ctx *pctx, const struct lysc_node *snode, const struct lysc_node *sparent, uint64_t base_sid)
+{
+    uint64_t sid;
+    size_t mod_len = 0, name_len;
+
+    sid = ly_sid_get(pctx->ctx, snode);
+    if (sid) {
+        if (sparent && !base_sid) {
+            /* absolute SID */
+            LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TAG, LYCBOR_TAG_SID));
+            return lycbor_print_head(pctx->out, LYCBOR_UINT, sid);
+        }
+
+        /* delta SID */
+        return lycbor_print_int(pctx->out, (int64_t)(sid - base_sid));
+    }
+
+    /* name with the module name, if needed */
+    name_len = strlen(snode->name);
+    if (!sparent || (sparent->module != snode->module)) {
+        mod_len = strlen(snode->module->name);
+        LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TEXT, mod_len + 1 + name_len));
+        LY_CHECK_RET(ly_write_(pctx->out, snode->module->name, mod_len));
+        LY_CHECK_RET(ly_write_(pctx->out, ":", 1));
+    } else {
+        LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TEXT, name_len));
+    }
+    return ly_write_(pctx->out, snode->name, name_len);
+}
+
+/**
+ * @brief Print a bits value as a bitmap.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] value Bits value.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_bits(struct cborpr_ctx *pctx, const struct lyd_value *value)
+{
+    LY_ERR rc;
+    struct lyd_value_bits *bits;
+    LY_ARRAY_COUNT_TYPE u;
+    uint32_t size = 0;
+    uint8_t *bitmap;
+
+    LYD_VALUE_GET(value, bits);
+
+    /* bit with position 0 is the least significant bit of the first byte, trailing zero bytes are omitted */
+    LY_ARRAY_FOR(bits->items, u) {
+        if (bits->items[u]->position / 8 + 1 > size) {
+            size = bits->items[u]->position / 8 + 1;
+        }
+    }
+    bitmap = calloc(1, size + 1);
+    LY_CHECK_ERR_RET(!bitmap, LOGMEM(pctx->ctx), LY_EMEM);
+    LY_ARRAY_FOR(bits->items, u) {
+        bitmap[bits->items[u]->position / 8] |= 1 << (bits->items[u]->position % 8);
+    }
+
+    rc = lycbor_print_str(pctx->out, LYCBOR_BYTES, (char *)bitmap, size);
+    free(bitmap);
+    return rc;
+}
+
+/**
+ * @brief Print a term node value.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] value Value to print.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_value(struct cborpr_ctx *pctx, const struct lyd_value *value)
+{
+    const char *str;
+    struct lyd_value_binary *bin;
+    ly_bool in_union = 0;
+    uint8_t byte;
+    uint64_t sid;
+
+    if (value->realtype->basetype == LY_TYPE_UNION) {
+        /* the actual value, enumerations, bits, and identityrefs are tagged */
+        value = &value->subvalue->value;
+        in_union = 1;
+    }
+
+    switch (value->realtype->basetype) {
+    case LY_TYPE_UINT8:
+        return lycbor_print_head(pctx->out, LYCBOR_UINT, value->uint8);
+    case LY_TYPE_UINT16:
+        return lycbor_print_head(pctx->out, LYCBOR_UINT, value->uint16);
+    case LY_TYPE_UINT32:
+        return lycbor_print_head(pctx->out, LYCBOR_UINT, value->uint32);
+    case LY_TYPE_UINT64:
+        return lycbor_print_head(pctx->out, LYCBOR_UINT, value->uint64);
+    case LY_TYPE_INT8:
+        return lycbor_print_int(pctx->out, value->int8);
+    case LY_TYPE_INT16:
+        return lycbor_print_int(pctx->out, value->int16);
+    case LY_TYPE_INT32:
+        return lycbor_print_int(pctx->out, value->int32);
+    case LY_TYPE_INT64:
+        return lycbor_print_int(pctx->out, value->int64);
+    case LY_TYPE_DEC64:
+        /* decimal fraction [exponent, mantissa] */
+        LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TAG, LYCBOR_TAG_DECFRAC));
+        LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_ARRAY, 2));
+        LY_CHECK_RET(lycbor_print_int(pctx->out, -(int64_t)((struct lysc_type_dec *)value->realtype)->fraction_digits));
+        return lycbor_print_int(pctx->out, value->dec64);
+    case LY_TYPE_BOOL:
+        byte = value->boolean ? LYCBOR_TRUE : LYCBOR_FALSE;
+        return ly_write_(pctx->out, (char *)&byte, 1);
+    case LY_TYPE_EMPTY:
+        byte = LYCBOR_NULL;
+        return ly_write_(pctx->out, (char *)&byte, 1);
+    case LY_TYPE_BINARY:
+        LYD_VALUE_GET(value, bin);
+        return lycbor_print_str(pctx->out, LYCBOR_BYTES, bin->data, bin->size);
+    case LY_TYPE_ENUM:
+        if (in_union) {
+            LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TAG, LYCBOR_TAG_ENUM));
+            return lycbor_print_str(pctx->out, LYCBOR_TEXT, value->enum_item->name, strlen(value->enum_item->name));
+        }
+        return lycbor_print_int(pctx->out, value->enum_item->value);
+    case LY_TYPE_BITS:
+        if (in_union) {
+            LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TAG, LYCBOR_TAG_BITS));
+            break;
+        }
+        return cbor_print_bits(pctx, value);
+    case LY_TYPE_IDENT:
+        sid = ly_sid_get(pctx->ctx, value->ident);
+        if (!sid) {
+            /* canonical name */
+            break;
+        }
+
+        if (in_union) {
+            LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_TAG, LYCBOR_TAG_IDENT));
+        }
+        return lycbor_print_head(pctx->out, LYCBOR_UINT, sid);
+    default:
+        /* canonical value */
+        break;
+    }
+
+    str = lyd_value_get_canonical(pctx->ctx, value);
+    LY_CHECK_ERR_RET(!str, LOGINT(pctx->ctx), LY_EINT);
+    return lycbor_print_str(pctx->out, LYCBOR_TEXT, str, strlen(str));
+}
+
+/**
+ * @brief Collect the printed siblings.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] first First sibling.
+ * @param[in] single Whether to print only @p first.
+ * @param[in] virt Optional virtual default leaves to print after the siblings.
+ * @param[out] nodes Set of the nodes to print.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_collect(struct cborpr_ctx *pctx, const struct lyd_node *first, ly_bool single, const struct ly_set *virt,
+        struct ly_set *nodes)
+{
+    const struct lyd_node *node;
+    uint32_t i;
+
+    LY_LIST_FOR(first, node) {
+        if (!node->schema) {
+            LOGERR(pctx->ctx, LY_EINVAL, "YANG-CBOR printer does not support opaque node \"%s\".", LYD_NAME(node));
+            return LY_EINVAL;
+        }
+        if (lyd_node_should_print(node, pctx->options)) {
+            LY_CHECK_RET(ly_set_add(nodes, (void *)node, 1, NULL));
+        }
+        if (single) {
+            break;
+        }
+    }
+
+    for (i = 0; virt && (i < virt->count); ++i) {
+        if (lyd_node_should_print(virt->dnodes[i], pctx->options)) {
+            LY_CHECK_RET(ly_set_add(nodes, virt->dnodes[i], 1, NULL));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Print an inner node as a map of its children.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] node Inner node to print.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_inner(struct cborpr_ctx *pctx, const struct lyd_node *node)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct ly_set virt = {0}, nodes = {0};
+
+    /* lazily parsed LYB children */
+    LY_CHECK_RET(lyd_lyb_stub_load(node));
+
+    if (pctx->options & (LYD_PRINT_WD_ALL | LYD_PRINT_WD_ALL_TAG | LYD_PRINT_WD_IMPL_TAG)) {
+        /* virtual default leaves are printed as well */
+        LY_CHECK_GOTO(rc = lyd_dflt_virtual_children(node, &virt), cleanup);
+    }
+
+    LY_CHECK_GOTO(rc = cbor_print_collect(pctx, lyd_child(node), 0, &virt, &nodes), cleanup);
+    rc = cbor_print_siblings(pctx, &nodes, node->schema, ly_sid_get(pctx->ctx, node->schema));
+
+cleanup:
+    ly_set_erase(&virt, NULL);
+    ly_set_erase(&nodes, NULL);
+    return rc;
+}
+
+/**
+ * @brief Print an anydata/anyxml value.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] node Any node to print.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_any(struct cborpr_ctx *pctx, const struct lyd_node *node)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct lyd_node_any *any = (const struct lyd_node_any *)node;
+    struct ly_set nodes = {0};
+    char *str = NULL;
+    uint8_t byte;
+
+    switch (any->value_type) {
+    case LYD_ANYDATA_DATATREE:
+        /* map of the data tree with the SIDs relative to the any node */
+        LY_CHECK_GOTO(rc = cbor_print_collect(pctx, any->value.tree, 0, NULL, &nodes), cleanup);
+        rc = cbor_print_siblings(pctx, &nodes, NULL, ly_sid_get(pctx->ctx, node->schema));
+        break;
+    case LYD_ANYDATA_STRING:
+    case LYD_ANYDATA_XML:
+    case LYD_ANYDATA_JSON:
+        if (!any->value.str) {
+            byte = LYCBOR_NULL;
+            rc = ly_write_(pctx->out, (char *)&byte, 1);
+            break;
+        }
+        rc = lycbor_print_str(pctx->out, LYCBOR_TEXT, any->value.str, strlen(any->value.str));
+        break;
+    case LYD_ANYDATA_LYB:
+        LY_CHECK_GOTO(rc = lyd_any_value_str(node, &str), cleanup);
+        rc = lycbor_print_str(pctx->out, LYCBOR_TEXT, str, strlen(str));
+        break;
+    }
+
+cleanup:
+    ly_set_erase(&nodes, NULL);
+    free(str);
+    return rc;
+}
+
+/**
+ * @brief Print the value of a data node.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] node Data node to print.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_node(struct cborpr_ctx *pctx, const struct lyd_node *node)
+{
+    switch (node->schema->nodetype) {
+    case LYS_RPC:
+    case LYS_ACTION:
+    case LYS_NOTIF:
+    case LYS_CONTAINER:
+    case LYS_LIST:
+        return cbor_print_inner(pctx, node);
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        return cbor_print_value(pctx, &((const struct lyd_node_term *)node)->value);
+    case LYS_ANYDATA:
+    case LYS_ANYXML:
+        return cbor_print_any(pctx, node);
+    default:
+        LOGINT(pctx->ctx);
+        return LY_EINT;
+    }
+}
+
+/**
+ * @brief Print sibling data nodes as a map, instances of lists and leaf-lists are arrays.
+ *
+ * @param[in] pctx CBOR printer context.
+ * @param[in] nodes Set of the sibling nodes to print.
+ * @param[in] sparent Schema parent of the siblings, NULL for top-level nodes.
+ * @param[in] base_sid SID of @p sparent or of the parent any node, the base of delta SIDs, 0 if it has none.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+cbor_print_siblings(struct cborpr_ctx *pctx, const struct ly_set *nodes, const struct lysc_node *sparent,
+        uint64_t base_sid)
+{
+    const struct lyd_node *node;
+    uint32_t i, j, count = 0;
+
+    /* number of members, the instances of a list or a leaf-list are always adjacent */
+    for (i = 0; i < nodes->count; ++i) {
+        if (!i || (nodes->dnodes[i]->schema != nodes->dnodes[i - 1]->schema)) {
+            ++count;
+        }
+    }
+    LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_MAP, count));
+
+    for (i = 0; i < nodes->count; i = j) {
+        node = nodes->dnodes[i];
+        for (j = i + 1; (j < nodes->count) && (nodes->dnodes[j]->schema == node->schema); ++j) {}
+
+        LY_CHECK_RET(cbor_print_key(pctx, node->schema, sparent, base_sid));
+        if (node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+            LY_CHECK_RET(lycbor_print_head(pctx->out, LYCBOR_ARRAY, j - i));
+            for ( ; i < j; ++i) {
+                LY_CHECK_RET(cbor_print_node(pctx, nodes->dnodes[i]));
+            }
+        } else {
+            LY_CHECK_RET(cbor_print_node(pctx, node));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+cbor_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct cborpr_ctx pctx = {0};
+    struct ly_set nodes = {0};
+    const struct lysc_node *sparent = NULL;
+
+    pctx.out = out;
+    pctx.ctx = root ? LYD_CTX(root) : NULL;
+    pctx.options = options;
+
+    if (root) {
+        LY_CHECK_GOTO(rc = cbor_print_collect(&pctx, root, !(options & LYD_PRINT_WITHSIBLINGS), NULL, &nodes), cleanup);
+        if (root->parent) {
+            /* the members are relative to the parent */
+            sparent = root->parent->schema;
+        }
+    }
+
+    /* the top-level map */
+    rc = cbor_print_siblings(&pctx, &nodes, sparent, sparent ? ly_sid_get(pctx.ctx, sparent) : 0);
+
+cleanup:
+    ly_set_erase(&nodes, NULL);
+    ly_print_flush(out);
+    return rc;
+}
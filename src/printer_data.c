@@ -14,7 +14,12 @@
 
 #include "printer_data.h"
 
+#include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "log.h"
 #include "ly_common.h"
@@ -23,6 +28,546 @@
 #include "printer_internal.h"
 #include "tree_data.h"
 
+/**
+ * @brief Piece of a parallel print stream output.
+ *
+ * Once written into the final output, both @p buf and @p task are freed and set to NULL.
+ */
+struct lypr_piece {
+    char *buf;                  /**< printed data, NULL for a task output */
+    size_t len;                 /**< length of the printed data */
+    struct lypr_task *task;     /**< task whose output this is, NULL for printed data */
+};
+
+/**
+ * @brief Task of a parallel print.
+ */
+struct lypr_task {
+    struct lypr_stream stream;  /**< output of the task, must be the first member */
+    const char *sep;            /**< optional separator of the task output */
+    lypr_task_clb print_clb;    /**< callback printing the task content */
+    lypr_task_free_clb free_clb; /**< callback freeing the printer context */
+    void *pctx;                 /**< printer context of the task */
+    struct lypr_task *next;     /**< next queued task */
+    ly_bool top;                /**< whether the task was created in the main stream */
+    LY_ERR rc;                  /**< result of the task */
+    ly_bool done;               /**< set once the task is finished, protected by ::lypr_pool.lock */
+};
+
+/**
+ * @brief Thread pool of a parallel print.
+ */
+struct lypr_pool {
+    const struct ly_ctx *ctx;   /**< libyang context for logging */
+    struct lypr_stream *main;   /**< main stream, printed by the thread that started the print */
+    struct ly_out *out;         /**< final output the finished pieces are written into, by the main stream thread */
+    pthread_mutex_t lock;       /**< lock for all the following members */
+    pthread_cond_t cond;        /**< signalled when a task is queued or finished */
+    struct lypr_task *first;    /**< first queued task to execute */
+    struct lypr_task *last;     /**< last queued task */
+    uint32_t running;           /**< number of dequeued tasks being executed */
+    uint32_t finished;          /**< number of finished tasks, to detect a change while the lock was not held */
+    uint32_t inflight;          /**< number of started tasks whose output was not written yet */
+    uint32_t max_inflight;      /**< maximum number of in-flight tasks, further tasks are executed by their creator */
+    ly_bool stop;               /**< all the tasks are finished, threads should exit */
+
+    pthread_t *threads;         /**< worker threads */
+    uint32_t thread_count;      /**< number of worker threads */
+};
+
+/**
+ * @brief Initialize a stream.
+ *
+ * @param[in] pool Pool of the stream.
+ * @param[in] stream Stream to initialize.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lypr_stream_init(struct lypr_pool *pool, struct lypr_stream *stream)
+{
+    memset(stream, 0, sizeof *stream);
+    stream->pool = pool;
+    return ly_out_new_memory(&stream->buf, 0, &stream->out);
+}
+
+/**
+ * @brief Move the data printed into a stream so far into a new piece.
+ *
+ * @param[in] stream Stream to use.
+ * @param[in] task Optional task to add as a piece after the data.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lypr_stream_cut(struct lypr_stream *stream, struct lypr_task *task)
+{
+    void *mem;
+
+    if (stream->count + 2 > stream->size) {
+        mem = realloc(stream->pieces, (stream->size ? stream->size * 2 : 8) * sizeof *stream->pieces);
+        LY_CHECK_ERR_RET(!mem, LOGMEM(stream->pool->ctx), LY_EMEM);
+        stream->pieces = mem;
+        stream->size = stream->size ? stream->size * 2 : 8;
+    }
+
+    if (stream->out->method.mem.len) {
+        /* take over the printed data */
+        stream->pieces[stream->count].buf = stream->buf;
+        stream->pieces[stream->count].len = stream->out->method.mem.len;
+        stream->pieces[stream->count].task = NULL;
+        ++stream->count;
+
+        stream->buf = NULL;
+        stream->out->method.mem.len = 0;
+        stream->out->method.mem.size = 0;
+    }
+
+    if (task) {
+        stream->pieces[stream->count].buf = NULL;
+        stream->pieces[stream->count].len = 0;
+        stream->pieces[stream->count].task = task;
+        ++stream->count;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Check whether all the tasks of a stream are finished, recursively.
+ *
+ * Is expected to be called with ::lypr_pool.lock held.
+ *
+ * @param[in] stream Stream of a finished task.
+ * @return Whether the whole stream output is finished.
+ */
+static ly_bool
+lypr_stream_done(const struct lypr_stream *stream)
+{
+    uint32_t i;
+
+    for (i = stream->written; i < stream->count; ++i) {
+        if (stream->pieces[i].task && (!stream->pieces[i].task->done || !lypr_stream_done(&stream->pieces[i].task->stream))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Check whether a finished stream has no output.
+ *
+ * @param[in] stream Stream to check.
+ * @return Whether the stream output is empty.
+ */
+static ly_bool
+lypr_stream_empty(const struct lypr_stream *stream)
+{
+    uint32_t i;
+
+    for (i = stream->written; i < stream->count; ++i) {
+        if (stream->pieces[i].buf || (stream->pieces[i].task && !lypr_stream_empty(&stream->pieces[i].task->stream))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Free a stream including all its tasks.
+ *
+ * @param[in] stream Stream to free.
+ */
+static void
+lypr_stream_free(struct lypr_stream *stream)
+{
+    uint32_t i;
+
+    for (i = 0; i < stream->count; ++i) {
+        if (stream->pieces[i].buf) {
+            free(stream->pieces[i].buf);
+        } else if (stream->pieces[i].task) {
+            lypr_stream_free(&stream->pieces[i].task->stream);
+            free(stream->pieces[i].task);
+        }
+    }
+    free(stream->pieces);
+    ly_out_free(stream->out, NULL, 0);
+    free(stream->buf);
+}
+
+/**
+ * @brief Write the finished output of a stream in order and free it, up to the first unfinished task.
+ *
+ * Is called only by the thread printing the main stream, the owner of ::lypr_pool.out.
+ *
+ * @param[in] stream Stream to write.
+ * @param[out] complete Whether all the pieces of @p stream were written.
+ * @return LY_ERR value, the first error of a task in the output order.
+ */
+static LY_ERR
+lypr_stream_flush(struct lypr_stream *stream, ly_bool *complete)
+{
+    struct lypr_pool *pool = stream->pool;
+    struct lypr_piece *piece;
+    struct lypr_task *task;
+    ly_bool ready;
+
+    *complete = 0;
+
+    for ( ; stream->written < stream->count; ++stream->written) {
+        piece = &stream->pieces[stream->written];
+        if (piece->buf) {
+            LY_CHECK_RET(ly_write_(pool->out, piece->buf, piece->len));
+            free(piece->buf);
+            piece->buf = NULL;
+            stream->sep_group = 0;
+            continue;
+        }
+
+        task = piece->task;
+        pthread_mutex_lock(&pool->lock);
+        ready = task->done && (!task->sep || lypr_stream_done(&task->stream));
+        pthread_mutex_unlock(&pool->lock);
+        if (!ready) {
+            /* the output of this task is not finished yet */
+            return LY_SUCCESS;
+        }
+        LY_CHECK_RET(task->rc);
+
+        if (task->sep && !lypr_stream_empty(&task->stream)) {
+            /* separate the non-empty outputs of the consecutive tasks */
+            if (stream->sep_group) {
+                LY_CHECK_RET(ly_write_(pool->out, task->sep, strlen(task->sep)));
+            }
+            stream->sep_group = 1;
+        }
+        LY_CHECK_RET(lypr_stream_flush(&task->stream, &ready));
+        if (!ready) {
+            return LY_SUCCESS;
+        }
+
+        /* the whole task output is written */
+        lypr_stream_free(&task->stream);
+        free(task);
+        piece->task = NULL;
+
+        pthread_mutex_lock(&pool->lock);
+        --pool->inflight;
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    *complete = 1;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Execute a task and mark it finished.
+ *
+ * @param[in] pool Pool of the task.
+ * @param[in] task Task to execute.
+ * @param[in] dequeued Whether the task was dequeued by ::lypr_pool_dequeue().
+ */
+static void
+lypr_task_run(struct lypr_pool *pool, struct lypr_task *task, ly_bool dequeued)
+{
+    /* print the task, its output must be finished even on error */
+    task->rc = task->print_clb(task->pctx);
+    if (!task->rc) {
+        task->rc = lypr_stream_cut(&task->stream, NULL);
+    }
+    task->free_clb(task->pctx);
+    task->pctx = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    task->done = 1;
+    if (dequeued) {
+        --pool->running;
+    }
+    ++pool->finished;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Take the first queued task, if any.
+ *
+ * Is expected to be called with ::lypr_pool.lock held.
+ *
+ * @param[in] pool Pool to use.
+ * @return Dequeued task, NULL if there is none.
+ */
+static struct lypr_task *
+lypr_pool_dequeue(struct lypr_pool *pool)
+{
+    struct lypr_task *task = pool->first;
+
+    if (task) {
+        pool->first = task->next;
+        if (!pool->first) {
+            pool->last = NULL;
+        }
+        ++pool->running;
+    }
+    return task;
+}
+
+/**
+ * @brief Worker thread of a parallel print, executes queued tasks until stopped.
+ *
+ * @param[in] arg Pool (struct lypr_pool *).
+ * @return NULL.
+ */
+static void *
+lypr_pool_thread(void *arg)
+{
+    struct lypr_pool *pool = arg;
+    struct lypr_task *task;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        task = lypr_pool_dequeue(pool);
+        if (!task) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        lypr_task_run(pool, task, 1);
+
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+LY_ERR
+lypr_parallel_new(const struct ly_ctx *ctx, struct ly_out *out, struct lypr_stream **stream)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lypr_pool *pool;
+    long cpus;
+    uint32_t count;
+
+    *stream = NULL;
+
+    pool = calloc(1, sizeof *pool);
+    LY_CHECK_ERR_RET(!pool, LOGMEM(ctx), LY_EMEM);
+    pool->ctx = ctx;
+    pool->out = out;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    *stream = calloc(1, sizeof **stream);
+    LY_CHECK_ERR_GOTO(!*stream, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    LY_CHECK_GOTO(rc = lypr_stream_init(pool, *stream), cleanup);
+    pool->main = *stream;
+
+    /* the calling thread executes the tasks as well, but there is always at least one worker */
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    count = (cpus > 2) ? (uint32_t)cpus - 1 : 1;
+    if (count > LYPR_PARALLEL_MAX_THREADS - 1) {
+        count = LYPR_PARALLEL_MAX_THREADS - 1;
+    }
+    pool->threads = malloc(count * sizeof *pool->threads);
+    LY_CHECK_ERR_GOTO(!pool->threads, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    for (pool->thread_count = 0; pool->thread_count < count; ++pool->thread_count) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, lypr_pool_thread, pool)) {
+            /* use only the threads created so far, the calling thread if none */
+            break;
+        }
+    }
+    pool->max_inflight = (pool->thread_count + 1) * LYPR_PARALLEL_TASKS_PER_THREAD;
+
+cleanup:
+    if (rc) {
+        if (*stream) {
+            lypr_stream_free(*stream);
+            free(*stream);
+            *stream = NULL;
+        }
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->cond);
+        free(pool);
+    }
+    return rc;
+}
+
+LY_ERR
+lypr_task_new(struct lypr_stream *stream, const char *sep, struct lypr_stream **task_stream)
+{
+    struct lypr_task *task;
+    ly_bool complete;
+
+    *task_stream = NULL;
+
+    task = calloc(1, sizeof *task);
+    LY_CHECK_ERR_RET(!task, LOGMEM(stream->pool->ctx), LY_EMEM);
+    if (lypr_stream_init(stream->pool, &task->stream)) {
+        free(task);
+        return LY_EMEM;
+    }
+    task->sep = sep;
+    task->top = (stream == stream->pool->main) ? 1 : 0;
+
+    /* the task is owned by the stream from now on */
+    if (lypr_stream_cut(stream, task)) {
+        lypr_stream_free(&task->stream);
+        free(task);
+        return LY_EMEM;
+    }
+    *task_stream = &task->stream;
+
+    if (task->top) {
+        /* write all the output finished so far */
+        return lypr_stream_flush(stream, &complete);
+    }
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Wait until a new task can be queued by the main stream thread, writing the finished output meanwhile.
+ *
+ * @param[in] pool Pool to use.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lypr_pool_wait_inflight(struct lypr_pool *pool)
+{
+    struct lypr_task *task;
+    ly_bool complete;
+    uint32_t finished;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->inflight >= pool->max_inflight) {
+        finished = pool->finished;
+        pthread_mutex_unlock(&pool->lock);
+        LY_CHECK_RET(lypr_stream_flush(pool->main, &complete));
+        pthread_mutex_lock(&pool->lock);
+        if (pool->inflight < pool->max_inflight) {
+            break;
+        }
+
+        /* help with the tasks or wait for one to finish */
+        if ((task = lypr_pool_dequeue(pool))) {
+            pthread_mutex_unlock(&pool->lock);
+            lypr_task_run(pool, task, 1);
+            pthread_mutex_lock(&pool->lock);
+        } else if (finished == pool->finished) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lypr_task_start(struct lypr_stream *task_stream, lypr_task_clb print_clb, lypr_task_free_clb free_clb, void *pctx)
+{
+    LY_ERR rc;
+    struct lypr_task *task = (struct lypr_task *)task_stream;
+    struct lypr_pool *pool = task_stream->pool;
+    ly_bool queue;
+
+    task->print_clb = print_clb;
+    task->free_clb = free_clb;
+    task->pctx = pctx;
+
+    if (task->top && (rc = lypr_pool_wait_inflight(pool))) {
+        /* the task is never executed */
+        free_clb(pctx);
+        task->pctx = NULL;
+        task->rc = rc;
+        pthread_mutex_lock(&pool->lock);
+        task->done = 1;
+        pthread_mutex_unlock(&pool->lock);
+        return rc;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    queue = (pool->inflight < pool->max_inflight) ? 1 : 0;
+    ++pool->inflight;
+    if (queue) {
+        if (pool->last) {
+            pool->last->next = task;
+        } else {
+            pool->first = task;
+        }
+        pool->last = task;
+        pthread_cond_signal(&pool->cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!queue) {
+        /* a nested task while too many task outputs are kept in memory, its creator cannot wait for the output
+         * to be written because it precedes this task so execute it right away */
+        lypr_task_run(pool, task, 0);
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lypr_parallel_finish(struct lypr_stream *stream, struct ly_out *out)
+{
+    LY_ERR rc;
+    struct lypr_pool *pool = stream->pool;
+    struct lypr_task *task;
+    ly_bool complete = 0;
+    uint32_t i, finished;
+
+    assert(stream == pool->main);
+
+    rc = lypr_stream_cut(stream, NULL);
+
+    /* help with the tasks and write their output as they finish */
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        finished = pool->finished;
+        pthread_mutex_unlock(&pool->lock);
+        if (!rc && out && !complete) {
+            rc = lypr_stream_flush(stream, &complete);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if ((task = lypr_pool_dequeue(pool))) {
+            pthread_mutex_unlock(&pool->lock);
+            lypr_task_run(pool, task, 1);
+            pthread_mutex_lock(&pool->lock);
+        } else if (pool->running) {
+            if (finished == pool->finished) {
+                pthread_cond_wait(&pool->cond, &pool->lock);
+            }
+        } else {
+            /* all the tasks are finished, no more can be created */
+            pool->stop = 1;
+            pthread_cond_broadcast(&pool->cond);
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    for (i = 0; i < pool->thread_count; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    if (!rc && out && !complete) {
+        rc = lypr_stream_flush(stream, &complete);
+        assert(rc || complete);
+    }
+
+    lypr_stream_free(stream);
+    free(stream);
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    free(pool);
+    return rc;
+}
+
 static LY_ERR
 lyd_print_(struct ly_out *out, const struct lyd_node *root, LYD_FORMAT format, uint32_t options)
 {
@@ -38,6 +583,9 @@ lyd_print_(struct ly_out *out, const struct lyd_node *root, LYD_FORMAT format, u
     case LYD_LYB:
         ret = lyb_print_data(out, root, options);
         break;
+    case LYD_CBOR:
+        ret = cbor_print_data(out, root, options);
+        break;
     case LYD_UNKNOWN:
         LOGINT(root ? LYD_CTX(root) : NULL);
         ret = LY_EINT;
@@ -111,6 +659,8 @@ lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, uint32_t op
     LY_CHECK_ARG_RET(NULL, fd != -1, LY_EINVAL);
 
     LY_CHECK_RET(ly_out_new_fd(fd, &out));
+    ret = ly_out_buffer_size(out, LY_OUT_BUF_SIZE);
+    LY_CHECK_ERR_RET(ret, ly_out_free(out, NULL, 0), ret);
     ret = lyd_print_(out, root, format, options);
     ly_out_free(out, NULL, 0);
     return ret;
@@ -153,6 +703,8 @@ lyd_print_clb(ly_write_clb writeclb, void *user_data, const struct lyd_node *roo
     LY_CHECK_ARG_RET(NULL, writeclb, LY_EINVAL);
 
     LY_CHECK_RET(ly_out_new_clb(writeclb, user_data, &out));
+    ret = ly_out_buffer_size(out, LY_OUT_BUF_SIZE);
+    LY_CHECK_ERR_RET(ret, ly_out_free(out, NULL, 0), ret);
     ret = lyd_print_(out, root, format, options);
     ly_out_free(out, NULL, 0);
     return ret;
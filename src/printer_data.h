@@ -79,6 +79,10 @@ struct ly_out;
                                                       The flag is not allowed for ::lyd_print_all() and ::lyd_print_tree(). */
 #define LYD_PRINT_SHRINK        LY_PRINT_SHRINK  /**< Flag for output without indentation and formatting new lines. */
 #define LYD_PRINT_KEEPEMPTYCONT 0x04             /**< Preserve empty non-presence containers */
+#define LYD_PRINT_PARALLEL      0x08             /**< Print the independent top-level subtrees and large runs of list instances
+                                                      concurrently by several threads, the output is the same as when printed
+                                                      sequentially. The whole output is kept in memory until the printing
+                                                      finishes. Ignored by the LYB printer. */
 #define LYD_PRINT_WD_MASK       0xF0             /**< Mask for with-defaults modes */
 #define LYD_PRINT_WD_EXPLICIT   0x00             /**< Explicit with-defaults mode. Only the data explicitly being present in
                                                       the data tree are printed, so the implicitly added default nodes are
@@ -97,6 +101,12 @@ struct ly_out;
                                                       are not explicitly present in the original data tree despite their
                                                       value is equal to their default value.  There is the same limitation regarding
                                                       the presence of ietf-netconf-with-defaults module in libyang context. */
+#define LYD_PRINT_LYB_INDEX     0x100            /**< Append an index of the subtrees of top-level containers and list instances
+                                                      to LYB data so that they can be parsed with ::LYD_PARSE_LYB_LAZY.
+                                                      Ignored by the other printers. */
+#define LYD_PRINT_LYB_DIFF      0x200            /**< Print a diff (::lyd_diff_siblings()) into LYB data with all its diff metadata
+                                                      in a compact binary form, to be applied by ::lyd_diff_apply_lyb().
+                                                      Ignored by the other printers. */
 /**
  * @}
  */
@@ -170,6 +180,8 @@ LIBYANG_API_DECL LY_ERR lyd_print_path(const char *path, const struct lyd_node *
 /**
  * @brief Print data tree in the specified format.
  *
+ * The printed data are passed to @p writeclb in chunks of up to ::LY_OUT_BUF_SIZE bytes.
+ *
  * @param[in] writeclb Callback function to write the data (see write(1)).
  * @param[in] user_data Optional caller-specific argument to be passed to the \p writeclb callback.
  * @param[in] root The root element of the (sub)tree to print.
@@ -84,6 +84,8 @@ LY_ERR yang_print_parsed_module(struct ly_out *out, const struct lysp_module *mo
 #define INDENT (DO_FORMAT ? (LEVEL)*2 : 0),"" /**< indentation parameters for printer functions */
 #define LEVEL_INC LEVEL++                     /**< increase indentation level */
 #define LEVEL_DEC LEVEL--                     /**< decrease indentation level */
+#define PRINT_INDENT ly_print_indent(pctx->out, DO_FORMAT ? (LEVEL) * 2 : 0) /**< print the current indentation */
+#define PRINT_NEWLINE (DO_FORMAT ? ly_print_lit(pctx->out, "\n") : LY_SUCCESS) /**< print newline if formatting */
 
 #define XML_NS_INDENT 8
 
@@ -185,6 +187,104 @@ LY_ERR tree_print_parsed_submodule(struct ly_out *out, const struct lysp_submodu
 LY_ERR tree_print_compiled_node(struct ly_out *out, const struct lysc_node *node, uint32_t options,
         size_t line_length);
 
+/**
+ * @brief Maximum number of threads of a parallel data print (::LYD_PRINT_PARALLEL).
+ */
+#define LYPR_PARALLEL_MAX_THREADS 64
+
+/**
+ * @brief Number of list instances printed by a single task of a parallel data print (::LYD_PRINT_PARALLEL).
+ * Runs of list instances are split into tasks only if they have at least 2 chunks.
+ */
+#define LYPR_PARALLEL_CHUNK 512
+
+/**
+ * @brief Number of tasks of a parallel data print (::LYD_PRINT_PARALLEL) per thread whose output may be kept
+ * in memory before it is written.
+ */
+#define LYPR_PARALLEL_TASKS_PER_THREAD 4
+
+/**
+ * @brief Ordered output of a parallel data print.
+ *
+ * The data printed into ::lypr_stream.out are kept in pieces interleaved with the outputs
+ * of the tasks created from the stream. The pieces are written into the final output in order and freed as soon
+ * as they and all the preceding pieces are finished.
+ */
+struct lypr_stream {
+    struct lypr_pool *pool;     /**< pool executing the tasks */
+    struct ly_out *out;         /**< memory output to print into */
+    char *buf;                  /**< memory buffer of the output */
+    struct lypr_piece *pieces;  /**< finished pieces of the output */
+    uint32_t count;             /**< number of pieces */
+    uint32_t size;              /**< allocated size of pieces */
+    uint32_t written;           /**< number of pieces already written into the final output */
+    ly_bool sep_group;          /**< whether the last written piece was a non-empty task output with a separator */
+};
+
+/**
+ * @brief Callback printing the content of a parallel print task.
+ *
+ * @param[in] pctx Printer context of the task.
+ * @return LY_ERR value.
+ */
+typedef LY_ERR (*lypr_task_clb)(void *pctx);
+
+/**
+ * @brief Callback freeing the printer context of a parallel print task.
+ *
+ * @param[in] pctx Printer context of the task.
+ */
+typedef void (*lypr_task_free_clb)(void *pctx);
+
+/**
+ * @brief Start a parallel data print.
+ *
+ * @param[in] ctx libyang context for logging.
+ * @param[in] out Final output to write into, only by the thread printing the main stream.
+ * @param[out] stream Main stream to print into.
+ * @return LY_ERR value.
+ */
+LY_ERR lypr_parallel_new(const struct ly_ctx *ctx, struct ly_out *out, struct lypr_stream **stream);
+
+/**
+ * @brief Create a new task at the current position of a stream.
+ *
+ * The task output is placed after everything printed into @p stream so far and before everything printed later.
+ *
+ * @param[in] stream Stream to create the task in.
+ * @param[in] sep Optional separator written before the non-empty task output if it directly follows another
+ * non-empty output of a task with a separator.
+ * @param[out] task_stream Stream of the task to print into.
+ * @return LY_ERR value.
+ */
+LY_ERR lypr_task_new(struct lypr_stream *stream, const char *sep, struct lypr_stream **task_stream);
+
+/**
+ * @brief Queue a created task for execution.
+ *
+ * At most ::LYPR_PARALLEL_TASKS_PER_THREAD tasks per thread are kept in flight, until their output is written.
+ * Once reached, a task of the main stream waits for the finished output to be written and a nested task is executed
+ * right away.
+ *
+ * @param[in] task_stream Stream of the task.
+ * @param[in] print_clb Callback printing the task content.
+ * @param[in] free_clb Callback freeing @p pctx once the task finishes, called even on error.
+ * @param[in] pctx Printer context of the task, printing into @p task_stream.
+ * @return LY_ERR value.
+ */
+LY_ERR lypr_task_start(struct lypr_stream *task_stream, lypr_task_clb print_clb, lypr_task_free_clb free_clb, void *pctx);
+
+/**
+ * @brief Finish a parallel data print, wait for all the tasks and write the rest of the output.
+ *
+ * @param[in] stream Main stream, is freed.
+ * @param[in] out Output to write the rest into, the same as passed to ::lypr_parallel_new(). If NULL, the print is
+ * only aborted.
+ * @return LY_ERR value, the first error of a task, the output written so far is then incomplete.
+ */
+LY_ERR lypr_parallel_finish(struct lypr_stream *stream, struct ly_out *out);
+
 /**
  * @brief XML printer of YANG data.
  *
@@ -215,4 +315,14 @@ LY_ERR json_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t
  */
 LY_ERR lyb_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options);
 
+/**
+ * @brief YANG-CBOR printer of YANG data.
+ *
+ * @param[in] out Output structure.
+ * @param[in] root The root element of the (sub)tree to print.
+ * @param[in] options [Data printer flags](@ref dataprinterflags).
+ * @return LY_ERR value, number of the printed bytes is updated in ::ly_out.printed.
+ */
+LY_ERR cbor_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options);
+
 #endif /* LY_PRINTER_INTERNAL_H_ */
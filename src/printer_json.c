@@ -14,9 +14,9 @@
  */
 
 #include <assert.h>
-#include <ctype.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "context.h"
 #include "log.h"
@@ -31,8 +31,28 @@
 #include "set.h"
 #include "tree.h"
 #include "tree_data.h"
+#include "tree_data_internal.h"
 #include "tree_schema.h"
 
+/**
+ * @brief Number of entries in the member name cache, must be a power of 2.
+ */
+#define JSON_NAME_CACHE_SIZE 256
+
+/**
+ * @brief Member name cache entry, holds the printed forms of a schema node name.
+ */
+struct jsonpr_name {
+    const struct lysc_node *schema; /**< schema node of the cached names */
+    const struct lys_module *parent_mod;    /**< module of the parent node @p qualified was resolved for */
+    ly_bool qualified;          /**< whether the name is qualified in a parent node of @p parent_mod */
+    char *forms[4];             /**< "name": forms indexed by ::JSON_NAME_QUALIFIED and ::JSON_NAME_ATTR flags */
+    uint32_t lens[4];           /**< lengths of the forms */
+};
+
+#define JSON_NAME_QUALIFIED 0x01    /**< name prefixed with the module name */
+#define JSON_NAME_ATTR 0x02         /**< name prefixed with the metadata sign (@) */
+
 /**
  * @brief JSON printer context.
  */
@@ -47,6 +67,20 @@ struct jsonpr_ctx {
     uint16_t level_printed;     /* level where some data were already printed */
     struct ly_set open;         /* currently open array(s) */
     const struct lyd_node *first_leaflist;  /**< first printed leaf-list instance, used when printing its metadata/attributes */
+    struct jsonpr_name *names;  /**< direct-mapped cache of member names of schema nodes, allocated on first use */
+
+    struct lypr_stream *par;    /**< stream to create parallel print tasks in, NULL if not allowed */
+    const struct lyd_node *par_skip;    /**< last list instance printed by parallel tasks, all the instances are skipped */
+};
+
+/**
+ * @brief JSON printer task of a parallel print.
+ */
+struct jsonpr_task {
+    struct jsonpr_ctx pctx;     /**< printer context of the task */
+    const struct lyd_node *first;   /**< first sibling to print */
+    uint32_t count;             /**< number of siblings to print */
+    ly_bool top;                /**< whether the siblings are top-level nodes */
 };
 
 /**
@@ -57,7 +91,8 @@ struct jsonpr_ctx {
 
 #define PRINT_COMMA \
     if (pctx->level_printed >= pctx->level) { \
-        ly_print_(pctx->out, ",%s", (DO_FORMAT ? "\n" : "")); \
+        ly_print_lit(pctx->out, ","); \
+        PRINT_NEWLINE; \
     }
 
 static LY_ERR json_print_node(struct jsonpr_ctx *pctx, const struct lyd_node *node);
@@ -101,7 +136,8 @@ matching_node(const struct lyd_node *node1, const struct lyd_node *node2)
 static LY_ERR
 json_print_array_open(struct jsonpr_ctx *pctx, const struct lyd_node *node)
 {
-    ly_print_(pctx->out, "[%s", DO_FORMAT ? "\n" : "");
+    ly_print_lit(pctx->out, "[");
+    PRINT_NEWLINE;
     LY_CHECK_RET(ly_set_add(&pctx->open, (void *)node, 0, NULL));
     LEVEL_INC;
 
@@ -136,7 +172,9 @@ json_print_array_close(struct jsonpr_ctx *pctx)
 {
     LEVEL_DEC;
     ly_set_rm_index(&pctx->open, pctx->open.count - 1, NULL);
-    ly_print_(pctx->out, "%s%*s]", DO_FORMAT ? "\n" : "", INDENT);
+    PRINT_NEWLINE;
+    PRINT_INDENT;
+    ly_print_lit(pctx->out, "]");
 }
 
 /**
@@ -220,37 +258,47 @@ json_nscmp(const struct lyd_node *node1, const struct lyd_node *node2)
 static LY_ERR
 json_print_string(struct ly_out *out, const char *text)
 {
-    uint64_t i;
+    static const char hex[] = "0123456789ABCDEF";
+    char esc[] = "\\u00XX";
+    unsigned char byte;
+    size_t len, span;
 
     if (!text) {
         return LY_SUCCESS;
     }
 
     ly_write_(out, "\"", 1);
-    for (i = 0; text[i]; i++) {
-        const unsigned char byte = text[i];
+    for (len = strlen(text); len; ++text, --len) {
+        /* write the run of characters that need no escaping at once */
+        span = ly_strncspn(text, len, "\"\\", 1);
+        if (span) {
+            ly_write_(out, text, span);
+            text += span;
+            len -= span;
+            if (!len) {
+                break;
+            }
+        }
 
+        byte = *text;
         switch (byte) {
         case '"':
-            ly_print_(out, "\\\"");
+            ly_print_lit(out, "\\\"");
             break;
         case '\\':
-            ly_print_(out, "\\\\");
+            ly_print_lit(out, "\\\\");
             break;
         case '\r':
-            ly_print_(out, "\\r");
+            ly_print_lit(out, "\\r");
             break;
         case '\t':
-            ly_print_(out, "\\t");
+            ly_print_lit(out, "\\t");
             break;
         default:
-            if (iscntrl(byte)) {
-                /* control character */
-                ly_print_(out, "\\u%.4X", byte);
-            } else {
-                /* printable character (even non-ASCII UTF8) */
-                ly_write_(out, &text[i], 1);
-            }
+            /* control character */
+            esc[4] = hex[byte >> 4];
+            esc[5] = hex[byte & 0xf];
+            ly_write_(out, esc, 6);
             break;
         }
     }
@@ -259,6 +307,144 @@ json_print_string(struct ly_out *out, const char *text)
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Print indented and quoted JSON member name, ending by ':'.
+ *
+ * @param[in] pctx JSON printer context.
+ * @param[in] is_attr Flag if the metadata sign (@) is supposed to be added before the identifier.
+ * @param[in] module_name Optional module name to prefix the @p name with.
+ * @param[in] name Member name.
+ */
+static void
+json_print_name(struct jsonpr_ctx *pctx, ly_bool is_attr, const char *module_name, const char *name)
+{
+    PRINT_INDENT;
+    if (is_attr) {
+        ly_print_lit(pctx->out, "\"@");
+    } else {
+        ly_print_lit(pctx->out, "\"");
+    }
+    if (module_name) {
+        ly_print_str(pctx->out, module_name);
+        ly_print_lit(pctx->out, ":");
+    }
+    ly_print_str(pctx->out, name);
+    if (DO_FORMAT) {
+        ly_print_lit(pctx->out, "\": ");
+    } else {
+        ly_print_lit(pctx->out, "\":");
+    }
+}
+
+/**
+ * @brief Get the member name cache entry of a schema node.
+ *
+ * @param[in] pctx JSON printer context.
+ * @param[in] schema Schema node whose entry to get.
+ * @param[out] entry Cache entry of @p schema, a colliding schema node is evicted.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+json_print_name_entry(struct jsonpr_ctx *pctx, const struct lysc_node *schema, struct jsonpr_name **entry)
+{
+    uint32_t i;
+
+    if (!pctx->names) {
+        pctx->names = calloc(JSON_NAME_CACHE_SIZE, sizeof *pctx->names);
+        LY_CHECK_ERR_RET(!pctx->names, LOGMEM(pctx->ctx), LY_EMEM);
+    }
+
+    /* schema nodes are allocated separately, ignore the alignment bits */
+    *entry = &pctx->names[((uintptr_t)schema >> 4) & (JSON_NAME_CACHE_SIZE - 1)];
+    if ((*entry)->schema != schema) {
+        /* evict the colliding schema node */
+        for (i = 0; i < 4; ++i) {
+            free((*entry)->forms[i]);
+        }
+        memset(*entry, 0, sizeof **entry);
+        (*entry)->schema = schema;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Print indented JSON member name of a schema node, ending by ':', using the member name cache.
+ *
+ * @param[in] pctx JSON printer context.
+ * @param[in] entry Member name cache entry of the schema node whose name to print.
+ * @param[in] form Form of the name, ::JSON_NAME_QUALIFIED and ::JSON_NAME_ATTR flags.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+json_print_schema_name(struct jsonpr_ctx *pctx, struct jsonpr_name *entry, uint32_t form)
+{
+    const struct lysc_node *schema = entry->schema;
+    const char *mod_name = schema->module->name;
+    size_t mod_len = 0, name_len, len;
+    char *str;
+    uint32_t i;
+
+    if (!entry->forms[form]) {
+        /* "@module:name": */
+        name_len = strlen(schema->name);
+        if (form & JSON_NAME_QUALIFIED) {
+            mod_len = strlen(mod_name) + 1;
+        }
+        len = 1 + ((form & JSON_NAME_ATTR) ? 1 : 0) + mod_len + name_len + 2 + (DO_FORMAT ? 1 : 0);
+        str = malloc(len);
+        LY_CHECK_ERR_RET(!str, LOGMEM(pctx->ctx), LY_EMEM);
+
+        i = 0;
+        str[i++] = '"';
+        if (form & JSON_NAME_ATTR) {
+            str[i++] = '@';
+        }
+        if (mod_len) {
+            memcpy(str + i, mod_name, mod_len - 1);
+            i += mod_len - 1;
+            str[i++] = ':';
+        }
+        memcpy(str + i, schema->name, name_len);
+        i += name_len;
+        str[i++] = '"';
+        str[i++] = ':';
+        if (DO_FORMAT) {
+            str[i++] = ' ';
+        }
+        assert(i == len);
+
+        entry->forms[form] = str;
+        entry->lens[form] = len;
+    }
+
+    PRINT_INDENT;
+    return ly_write_(pctx->out, entry->forms[form], entry->lens[form]);
+}
+
+/**
+ * @brief Free the member name cache.
+ *
+ * @param[in] pctx JSON printer context.
+ */
+static void
+json_print_names_free(struct jsonpr_ctx *pctx)
+{
+    uint32_t i, j;
+
+    if (!pctx->names) {
+        return;
+    }
+
+    for (i = 0; i < JSON_NAME_CACHE_SIZE; ++i) {
+        for (j = 0; j < 4; ++j) {
+            free(pctx->names[i].forms[j]);
+        }
+    }
+    free(pctx->names);
+    pctx->names = NULL;
+}
+
 /**
  * @brief Print JSON object's member name, ending by ':'. It resolves if the prefix is supposed to be printed.
  *
@@ -270,16 +456,32 @@ json_print_string(struct ly_out *out, const char *text)
 static LY_ERR
 json_print_member(struct jsonpr_ctx *pctx, const struct lyd_node *node, ly_bool is_attr)
 {
+    struct jsonpr_name *entry;
+    const struct lys_module *parent_mod;
+    uint32_t form = is_attr ? JSON_NAME_ATTR : 0;
+
     PRINT_COMMA;
-    if ((LEVEL == 1) || json_nscmp(node, pctx->parent)) {
+    LY_CHECK_RET(json_print_name_entry(pctx, node->schema, &entry));
+
+    if ((LEVEL == 1) || !pctx->parent) {
         /* print "namespace" */
-        ly_print_(pctx->out, "%*s\"%s%s:%s\":%s", INDENT, is_attr ? "@" : "",
-                node_prefix(node), node->schema->name, DO_FORMAT ? " " : "");
-    } else {
-        ly_print_(pctx->out, "%*s\"%s%s\":%s", INDENT, is_attr ? "@" : "", node->schema->name, DO_FORMAT ? " " : "");
+        form |= JSON_NAME_QUALIFIED;
+    } else if (pctx->parent->schema) {
+        /* resolved only once per parent module */
+        parent_mod = pctx->parent->schema->module;
+        if (entry->parent_mod != parent_mod) {
+            entry->parent_mod = parent_mod;
+            entry->qualified = json_nscmp(node, pctx->parent) ? 1 : 0;
+        }
+        if (entry->qualified) {
+            form |= JSON_NAME_QUALIFIED;
+        }
+    } else if (json_nscmp(node, pctx->parent)) {
+        /* opaque parent */
+        form |= JSON_NAME_QUALIFIED;
     }
 
-    return LY_SUCCESS;
+    return json_print_schema_name(pctx, entry, form);
 }
 
 /**
@@ -329,9 +531,9 @@ json_print_member2(struct jsonpr_ctx *pctx, const struct lyd_node *parent, LY_VA
 
     /* print the member */
     if (module_name && (!parent || (node_prefix(parent) != module_name))) {
-        ly_print_(pctx->out, "%*s\"%s%s:%s\":%s", INDENT, is_attr ? "@" : "", module_name, name_str, DO_FORMAT ? " " : "");
+        json_print_name(pctx, is_attr, module_name, name_str);
     } else {
-        ly_print_(pctx->out, "%*s\"%s%s\":%s", INDENT, is_attr ? "@" : "", name_str, DO_FORMAT ? " " : "");
+        json_print_name(pctx, is_attr, NULL, name_str);
     }
 
     return LY_SUCCESS;
@@ -386,11 +588,15 @@ print_val:
     case LY_TYPE_UINT16:
     case LY_TYPE_UINT32:
     case LY_TYPE_BOOL:
-        ly_print_(pctx->out, "%s", value[0] ? value : "null");
+        if (value[0]) {
+            ly_print_str(pctx->out, value);
+        } else {
+            ly_print_lit(pctx->out, "null");
+        }
         break;
 
     case LY_TYPE_EMPTY:
-        ly_print_(pctx->out, "[null]");
+        ly_print_lit(pctx->out, "[null]");
         break;
 
     default:
@@ -423,9 +629,13 @@ json_print_attribute(struct jsonpr_ctx *pctx, const struct lyd_node_opaq *node)
         if (attr->hints & (LYD_VALHINT_STRING | LYD_VALHINT_OCTNUM | LYD_VALHINT_HEXNUM | LYD_VALHINT_NUM64)) {
             json_print_string(pctx->out, attr->value);
         } else if (attr->hints & (LYD_VALHINT_BOOLEAN | LYD_VALHINT_DECNUM)) {
-            ly_print_(pctx->out, "%s", attr->value[0] ? attr->value : "null");
+            if (attr->value[0]) {
+                ly_print_str(pctx->out, attr->value);
+            } else {
+                ly_print_lit(pctx->out, "null");
+            }
         } else if (attr->hints & LYD_VALHINT_EMPTY) {
-            ly_print_(pctx->out, "[null]");
+            ly_print_lit(pctx->out, "[null]");
         } else {
             /* unknown value format with no hints, use universal string */
             json_print_string(pctx->out, attr->value);
@@ -450,7 +660,8 @@ json_print_metadata(struct jsonpr_ctx *pctx, const struct lyd_node *node, const
     struct lyd_meta *meta;
 
     if (wdmod) {
-        ly_print_(pctx->out, "%*s\"%s:default\":%strue", INDENT, wdmod->name, DO_FORMAT ? " " : "");
+        json_print_name(pctx, 0, wdmod->name, "default");
+        ly_print_lit(pctx->out, "true");
         LEVEL_PRINTED;
     }
 
@@ -459,7 +670,7 @@ json_print_metadata(struct jsonpr_ctx *pctx, const struct lyd_node *node, const
             continue;
         }
         PRINT_COMMA;
-        ly_print_(pctx->out, "%*s\"%s:%s\":%s", INDENT, meta->annotation->module->name, meta->name, DO_FORMAT ? " " : "");
+        json_print_name(pctx, 0, meta->annotation->module->name, meta->name);
         LY_CHECK_RET(json_print_value(pctx, LYD_CTX(node), &meta->value, NULL));
         LEVEL_PRINTED;
     }
@@ -518,11 +729,14 @@ json_print_attributes(struct jsonpr_ctx *pctx, const struct lyd_node *node, ly_b
         } else {
             LY_CHECK_RET(json_print_member(pctx, node, 1));
         }
-        ly_print_(pctx->out, "{%s", (DO_FORMAT ? "\n" : ""));
+        ly_print_lit(pctx->out, "{");
+        PRINT_NEWLINE;
         LEVEL_INC;
         LY_CHECK_RET(json_print_metadata(pctx, node, wdmod));
         LEVEL_DEC;
-        ly_print_(pctx->out, "%s%*s}", DO_FORMAT ? "\n" : "", INDENT);
+        PRINT_NEWLINE;
+        PRINT_INDENT;
+        ly_print_lit(pctx->out, "}");
         LEVEL_PRINTED;
     } else if (!node->schema && ((struct lyd_node_opaq *)node)->attr) {
         if (inner) {
@@ -531,11 +745,14 @@ json_print_attributes(struct jsonpr_ctx *pctx, const struct lyd_node *node, ly_b
             LY_CHECK_RET(json_print_member2(pctx, lyd_parent(node), ((struct lyd_node_opaq *)node)->format,
                     &((struct lyd_node_opaq *)node)->name, 1));
         }
-        ly_print_(pctx->out, "{%s", (DO_FORMAT ? "\n" : ""));
+        ly_print_lit(pctx->out, "{");
+        PRINT_NEWLINE;
         LEVEL_INC;
         LY_CHECK_RET(json_print_attribute(pctx, (struct lyd_node_opaq *)node));
         LEVEL_DEC;
-        ly_print_(pctx->out, "%s%*s}", DO_FORMAT ? "\n" : "", INDENT);
+        PRINT_NEWLINE;
+        PRINT_INDENT;
+        ly_print_lit(pctx->out, "}");
         LEVEL_PRINTED;
     }
 
@@ -603,7 +820,8 @@ json_print_any_content(struct jsonpr_ctx *pctx, struct lyd_node_any *any)
     switch (any->value_type) {
     case LYD_ANYDATA_DATATREE:
         /* print as an object */
-        ly_print_(pctx->out, "{%s", DO_FORMAT ? "\n" : "");
+        ly_print_lit(pctx->out, "{");
+        PRINT_NEWLINE;
         LEVEL_INC;
 
         /* close opening tag and print data */
@@ -620,23 +838,21 @@ json_print_any_content(struct jsonpr_ctx *pctx, struct lyd_node_any *any)
 
         /* terminate the object */
         LEVEL_DEC;
-        if (DO_FORMAT) {
-            ly_print_(pctx->out, "\n%*s}", INDENT);
-        } else {
-            ly_print_(pctx->out, "}");
-        }
+        PRINT_NEWLINE;
+        PRINT_INDENT;
+        ly_print_lit(pctx->out, "}");
         break;
     case LYD_ANYDATA_JSON:
         if (!any->value.json) {
             /* no content */
             if (any->schema->nodetype == LYS_ANYXML) {
-                ly_print_(pctx->out, "null");
+                ly_print_lit(pctx->out, "null");
             } else {
-                ly_print_(pctx->out, "{}");
+                ly_print_lit(pctx->out, "{}");
             }
         } else {
             /* print without escaping special characters */
-            ly_print_(pctx->out, "%s", any->value.json);
+            ly_print_str(pctx->out, any->value.json);
         }
         break;
     case LYD_ANYDATA_STRING:
@@ -644,9 +860,9 @@ json_print_any_content(struct jsonpr_ctx *pctx, struct lyd_node_any *any)
         if (!any->value.str) {
             /* no content */
             if (any->schema->nodetype == LYS_ANYXML) {
-                ly_print_(pctx->out, "null");
+                ly_print_lit(pctx->out, "null");
             } else {
-                ly_print_(pctx->out, "{}");
+                ly_print_lit(pctx->out, "{}");
             }
         } else {
             /* print as a string */
@@ -676,14 +892,25 @@ json_print_inner(struct jsonpr_ctx *pctx, const struct lyd_node *node)
     struct lyd_node *child;
     const struct lyd_node *prev_parent;
     struct lyd_node_opaq *opaq = NULL;
+    struct ly_set virt = {0};
     ly_bool has_content = 0;
+    uint32_t i;
+    LY_ERR ret = LY_SUCCESS;
+
+    /* lazily parsed LYB children */
+    LY_CHECK_RET(lyd_lyb_stub_load(node));
+
+    if (pctx->options & (LYD_PRINT_WD_ALL | LYD_PRINT_WD_ALL_TAG | LYD_PRINT_WD_IMPL_TAG)) {
+        /* virtual default leaves are printed as well */
+        LY_CHECK_RET(lyd_dflt_virtual_children(node, &virt));
+    }
 
     LY_LIST_FOR(lyd_child(node), child) {
         if (lyd_node_should_print(child, pctx->options)) {
             break;
         }
     }
-    if (node->meta || child) {
+    if (node->meta || child || virt.count) {
         has_content = 1;
     }
     if (!node->schema) {
@@ -692,11 +919,17 @@ json_print_inner(struct jsonpr_ctx *pctx, const struct lyd_node *node)
 
     if ((node->schema && (node->schema->nodetype == LYS_LIST)) ||
             (opaq && (opaq->hints != LYD_HINT_DATA) && (opaq->hints & LYD_NODEHINT_LIST))) {
-        ly_print_(pctx->out, "%s%*s{%s", (is_open_array(pctx, node) && (pctx->level_printed >= pctx->level)) ?
-                (DO_FORMAT ? ",\n" : ",") : "", INDENT, (DO_FORMAT && has_content) ? "\n" : "");
-    } else {
-        ly_print_(pctx->out, "%s{%s", (is_open_array(pctx, node) && (pctx->level_printed >= pctx->level)) ? "," : "",
-                (DO_FORMAT && has_content) ? "\n" : "");
+        if (is_open_array(pctx, node) && (pctx->level_printed >= pctx->level)) {
+            ly_print_lit(pctx->out, ",");
+            PRINT_NEWLINE;
+        }
+        PRINT_INDENT;
+    } else if (is_open_array(pctx, node) && (pctx->level_printed >= pctx->level)) {
+        ly_print_lit(pctx->out, ",");
+    }
+    ly_print_lit(pctx->out, "{");
+    if (has_content) {
+        PRINT_NEWLINE;
     }
     LEVEL_INC;
 
@@ -706,19 +939,24 @@ json_print_inner(struct jsonpr_ctx *pctx, const struct lyd_node *node)
     prev_parent = pctx->parent;
     pctx->parent = node;
     LY_LIST_FOR(lyd_child(node), child) {
-        LY_CHECK_RET(json_print_node(pctx, child));
+        LY_CHECK_GOTO(ret = json_print_node(pctx, child), cleanup);
+    }
+    for (i = 0; i < virt.count; ++i) {
+        LY_CHECK_GOTO(ret = json_print_node(pctx, virt.dnodes[i]), cleanup);
     }
     pctx->parent = prev_parent;
 
     LEVEL_DEC;
-    if (DO_FORMAT && has_content) {
-        ly_print_(pctx->out, "\n%*s}", INDENT);
-    } else {
-        ly_print_(pctx->out, "}");
+    if (has_content) {
+        PRINT_NEWLINE;
+        PRINT_INDENT;
     }
+    ly_print_lit(pctx->out, "}");
     LEVEL_PRINTED;
 
-    return LY_SUCCESS;
+cleanup:
+    ly_set_erase(&virt, NULL);
+    return ret;
 }
 
 /**
@@ -785,6 +1023,135 @@ json_print_array_is_last_inst(struct jsonpr_ctx *pctx, const struct lyd_node *no
     return 0;
 }
 
+/**
+ * @brief Print the siblings of a parallel print task.
+ *
+ * @param[in] arg JSON printer task (struct jsonpr_task *).
+ * @return LY_ERR value.
+ */
+static LY_ERR
+json_print_task(void *arg)
+{
+    struct jsonpr_task *task = arg;
+    const struct lyd_node *node;
+    uint32_t i;
+
+    for (i = 0, node = task->first; i < task->count; ++i, node = node->next) {
+        if (task->top) {
+            task->pctx.root = node;
+        }
+        LY_CHECK_RET(json_print_node(&task->pctx, node));
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Free a JSON printer task of a parallel print.
+ *
+ * @param[in] arg JSON printer task (struct jsonpr_task *).
+ */
+static void
+json_print_task_free(void *arg)
+{
+    struct jsonpr_task *task = arg;
+
+    ly_set_erase(&task->pctx.open, NULL);
+    json_print_names_free(&task->pctx);
+    free(task);
+}
+
+/**
+ * @brief Print siblings by a new parallel print task, in the current printer state.
+ *
+ * @param[in] pctx JSON printer context.
+ * @param[in] sep Optional separator of the task output, see ::lypr_task_new().
+ * @param[in] first First sibling to print.
+ * @param[in] count Number of siblings to print.
+ * @param[in] top Whether the siblings are top-level nodes, their task may create further tasks.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+json_print_task_start(struct jsonpr_ctx *pctx, const char *sep, const struct lyd_node *first, uint32_t count, ly_bool top)
+{
+    struct lypr_stream *task_stream;
+    struct jsonpr_task *task;
+    uint32_t i;
+
+    LY_CHECK_RET(lypr_task_new(pctx->par, sep, &task_stream));
+
+    task = calloc(1, sizeof *task);
+    LY_CHECK_ERR_RET(!task, LOGMEM(pctx->ctx), LY_EMEM);
+    task->pctx = *pctx;
+    task->pctx.out = task_stream->out;
+    memset(&task->pctx.open, 0, sizeof task->pctx.open);
+    task->pctx.first_leaflist = NULL;
+    task->pctx.names = NULL;
+    task->pctx.par = top ? task_stream : NULL;
+    task->pctx.par_skip = NULL;
+    task->first = first;
+    task->count = count;
+    task->top = top;
+
+    for (i = 0; i < pctx->open.count; ++i) {
+        LY_CHECK_ERR_RET(ly_set_add(&task->pctx.open, pctx->open.objs[i], 1, NULL), json_print_task_free(task), LY_EMEM);
+    }
+
+    return lypr_task_start(task_stream, json_print_task, json_print_task_free, task);
+}
+
+/**
+ * @brief Print a long run of list instances by parallel print tasks.
+ *
+ * @param[in] pctx JSON printer context.
+ * @param[in] node First list instance of the run.
+ * @return LY_SUCCESS if the instances are printed, ::json_print_node() skips them.
+ * @return LY_ENOT if the run is too short.
+ * @return LY_ERR value on error.
+ */
+static LY_ERR
+json_print_list_parallel(struct jsonpr_ctx *pctx, const struct lyd_node *node)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct lyd_node *iter, *first, *last = NULL;
+    uint32_t count;
+
+    for (iter = node, count = 0; iter && (iter->schema == node->schema) && (count < 2 * LYPR_PARALLEL_CHUNK); iter = iter->next) {
+        ++count;
+    }
+    if (count < 2 * LYPR_PARALLEL_CHUNK) {
+        return LY_ENOT;
+    }
+
+    /* the first chunk opens the array */
+    LY_CHECK_RET(json_print_task_start(pctx, NULL, node, LYPR_PARALLEL_CHUNK, 0));
+
+    /* the other chunks continue in the open array with some instances already printed */
+    LY_CHECK_RET(ly_set_add(&pctx->open, (void *)node, 1, NULL));
+    LEVEL_INC;
+    LEVEL_PRINTED;
+
+    iter = node;
+    for (count = 0; count < LYPR_PARALLEL_CHUNK; ++count) {
+        iter = iter->next;
+    }
+    while (iter && (iter->schema == node->schema)) {
+        first = iter;
+        for (count = 0; iter && (iter->schema == node->schema) && (count < LYPR_PARALLEL_CHUNK); iter = iter->next) {
+            last = iter;
+            ++count;
+        }
+        LY_CHECK_GOTO(rc = json_print_task_start(pctx, NULL, first, count, 0), cleanup);
+    }
+
+    pctx->par_skip = last;
+
+cleanup:
+    LEVEL_DEC;
+    ly_set_rm_index(&pctx->open, pctx->open.count - 1, NULL);
+    return rc;
+}
+
 /**
  * @brief Print single leaf-list or list instance.
  *
@@ -800,15 +1167,27 @@ static LY_ERR
 json_print_leaf_list(struct jsonpr_ctx *pctx, const struct lyd_node *node)
 {
     const struct lys_module *wdmod = NULL;
+    LY_ERR rc;
+
+    if (pctx->par && (node->schema->nodetype == LYS_LIST) && !is_open_array(pctx, node) &&
+            ((pctx->root != node) || (pctx->options & LYD_PRINT_WITHSIBLINGS))) {
+        /* try to print the instances in parallel */
+        rc = json_print_list_parallel(pctx, node);
+        if (rc != LY_ENOT) {
+            return rc;
+        }
+    }
 
     if (!is_open_array(pctx, node)) {
         LY_CHECK_RET(json_print_member(pctx, node, 0));
         LY_CHECK_RET(json_print_array_open(pctx, node));
         if (node->schema->nodetype == LYS_LEAFLIST) {
-            ly_print_(pctx->out, "%*s", INDENT);
+            PRINT_INDENT;
         }
     } else if (node->schema->nodetype == LYS_LEAFLIST) {
-        ly_print_(pctx->out, ",%s%*s", DO_FORMAT ? "\n" : "", INDENT);
+        ly_print_lit(pctx->out, ",");
+        PRINT_NEWLINE;
+        PRINT_INDENT;
     }
 
     if (node->schema->nodetype == LYS_LIST) {
@@ -872,7 +1251,8 @@ json_print_meta_attr_leaflist(struct jsonpr_ctx *pctx)
         LY_CHECK_RET(json_print_member2(pctx, lyd_parent(node), opaq->format, &opaq->name, 1));
     }
 
-    ly_print_(pctx->out, "[%s", (DO_FORMAT ? "\n" : ""));
+    ly_print_lit(pctx->out, "[");
+    PRINT_NEWLINE;
     LEVEL_INC;
     LY_LIST_FOR(node, iter) {
         PRINT_COMMA;
@@ -882,7 +1262,9 @@ json_print_meta_attr_leaflist(struct jsonpr_ctx *pctx)
             iter_wdmod = NULL;
         }
         if ((iter->schema && (node_has_printable_meta(iter) || iter_wdmod)) || (opaq && opaq->attr)) {
-            ly_print_(pctx->out, "%*s%s", INDENT, DO_FORMAT ? "{\n" : "{");
+            PRINT_INDENT;
+            ly_print_lit(pctx->out, "{");
+            PRINT_NEWLINE;
             LEVEL_INC;
 
             if (iter->schema) {
@@ -892,9 +1274,12 @@ json_print_meta_attr_leaflist(struct jsonpr_ctx *pctx)
             }
 
             LEVEL_DEC;
-            ly_print_(pctx->out, "%s%*s}", DO_FORMAT ? "\n" : "", INDENT);
+            PRINT_NEWLINE;
+            PRINT_INDENT;
+            ly_print_lit(pctx->out, "}");
         } else {
-            ly_print_(pctx->out, "%*snull", INDENT);
+            PRINT_INDENT;
+            ly_print_lit(pctx->out, "null");
         }
         LEVEL_PRINTED;
         if (!matching_node(iter, iter->next)) {
@@ -902,7 +1287,9 @@ json_print_meta_attr_leaflist(struct jsonpr_ctx *pctx)
         }
     }
     LEVEL_DEC;
-    ly_print_(pctx->out, "%s%*s]", DO_FORMAT ? "\n" : "", INDENT);
+    PRINT_NEWLINE;
+    PRINT_INDENT;
+    ly_print_lit(pctx->out, "]");
     LEVEL_PRINTED;
 
     return LY_SUCCESS;
@@ -944,19 +1331,21 @@ json_print_opaq(struct jsonpr_ctx *pctx, const struct lyd_node_opaq *node)
             LY_CHECK_RET(json_print_array_open(pctx, &node->node));
         }
         if (hints & LYD_NODEHINT_LEAFLIST) {
-            ly_print_(pctx->out, "%*s", INDENT);
+            PRINT_INDENT;
         }
     } else if (hints & LYD_NODEHINT_LEAFLIST) {
-        ly_print_(pctx->out, ",%s%*s", DO_FORMAT ? "\n" : "", INDENT);
+        ly_print_lit(pctx->out, ",");
+        PRINT_NEWLINE;
+        PRINT_INDENT;
     }
     if (node->child || (hints & LYD_NODEHINT_LIST) || (hints & LYD_NODEHINT_CONTAINER)) {
         LY_CHECK_RET(json_print_inner(pctx, &node->node));
         LEVEL_PRINTED;
     } else {
         if (hints & LYD_VALHINT_EMPTY) {
-            ly_print_(pctx->out, "[null]");
+            ly_print_lit(pctx->out, "[null]");
         } else if ((hints & (LYD_VALHINT_BOOLEAN | LYD_VALHINT_DECNUM)) && !(hints & LYD_VALHINT_NUM64)) {
-            ly_print_(pctx->out, "%s", node->value);
+            ly_print_str(pctx->out, node->value);
         } else {
             /* string or a large number */
             json_print_string(pctx->out, node->value);
@@ -990,6 +1379,14 @@ json_print_opaq(struct jsonpr_ctx *pctx, const struct lyd_node_opaq *node)
 static LY_ERR
 json_print_node(struct jsonpr_ctx *pctx, const struct lyd_node *node)
 {
+    if (pctx->par_skip) {
+        /* printed by parallel tasks */
+        if (node == pctx->par_skip) {
+            pctx->par_skip = NULL;
+        }
+        return LY_SUCCESS;
+    }
+
     if (!lyd_node_should_print(node, pctx->options)) {
         if (json_print_array_is_last_inst(pctx, node)) {
             json_print_array_close(pctx);
@@ -1037,12 +1434,15 @@ json_print_node(struct jsonpr_ctx *pctx, const struct lyd_node *node)
 LY_ERR
 json_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options)
 {
-    const struct lyd_node *node;
+    LY_ERR rc = LY_SUCCESS;
+    const struct lyd_node *node, *last;
     struct jsonpr_ctx pctx = {0};
     const char *delimiter = (options & LYD_PRINT_SHRINK) ? "" : "\n";
+    uint32_t count;
 
     if (!root) {
-        ly_print_(out, "{}%s", delimiter);
+        ly_print_lit(out, "{}");
+        ly_print_str(out, delimiter);
         ly_print_flush(out);
         return LY_SUCCESS;
     }
@@ -1054,24 +1454,55 @@ json_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t option
     pctx.options = options;
     pctx.ctx = LYD_CTX(root);
 
+    if (options & LYD_PRINT_PARALLEL) {
+        /* print into the memory stream of a parallel print */
+        LY_CHECK_RET(lypr_parallel_new(pctx.ctx, out, &pctx.par));
+        pctx.out = pctx.par->out;
+    }
+
     /* start */
-    ly_print_(pctx.out, "{%s", delimiter);
+    ly_print_lit(pctx.out, "{");
+    ly_print_str(pctx.out, delimiter);
 
     /* content */
     LY_LIST_FOR(root, node) {
         pctx.root = node;
-        LY_CHECK_RET(json_print_node(&pctx, node));
+        if (pctx.par && (options & LYD_PRINT_WITHSIBLINGS)) {
+            /* print all the instances by a separate task */
+            for (last = node, count = 1; last->next && matching_node(node, last->next); last = last->next) {
+                ++count;
+            }
+            LY_CHECK_GOTO(rc = json_print_task_start(&pctx, (options & LYD_PRINT_SHRINK) ? "," : ",\n", node, count, 1),
+                    cleanup);
+            node = last;
+            continue;
+        }
+
+        LY_CHECK_GOTO(rc = json_print_node(&pctx, node), cleanup);
         if (!(options & LYD_PRINT_WITHSIBLINGS)) {
             break;
         }
     }
 
     /* end */
-    ly_print_(out, "%s}%s", delimiter, delimiter);
+    ly_print_str(pctx.out, delimiter);
+    ly_print_lit(pctx.out, "}");
+    ly_print_str(pctx.out, delimiter);
 
     assert(!pctx.open.count);
-    ly_set_erase(&pctx.open, NULL);
-
+    if (pctx.par) {
+        /* wait for the tasks and write the rest of the output */
+        rc = lypr_parallel_finish(pctx.par, out);
+        pctx.par = NULL;
+        LY_CHECK_GOTO(rc, cleanup);
+    }
     ly_print_flush(out);
-    return LY_SUCCESS;
+
+cleanup:
+    if (pctx.par) {
+        lypr_parallel_finish(pctx.par, NULL);
+    }
+    ly_set_erase(&pctx.open, NULL);
+    json_print_names_free(&pctx);
+    return rc;
 }
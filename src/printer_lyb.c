@@ -42,166 +42,108 @@
 static LY_ERR lyb_print_siblings(struct ly_out *out, const struct lyd_node *node, struct lyd_lyb_ctx *lybctx);
 
 /**
- * @brief Hash table equal callback for checking hash equality only.
- *
- * Implementation of ::lyht_value_equal_cb.
+ * @brief Index of subtrees being printed (::LYD_PRINT_LYB_INDEX).
  */
-static ly_bool
-lyb_hash_equal_cb(void *UNUSED(val1_p), void *UNUSED(val2_p), ly_bool UNUSED(mod), void *UNUSED(cb_data))
-{
-    /* for this purpose, if hash matches, the value does also, we do not want 2 values to have the same hash */
-    return 1;
-}
+struct lyb_index {
+    size_t base;                    /**< printed bytes before the data */
+    size_t hole;                    /**< position of the index offset in the header */
+
+    struct lyb_index_chunk {
+        size_t written;             /**< final size of the chunk */
+        uint16_t inner_chunks;      /**< final inner chunk count of the chunk */
+    } *chunks;                      /**< all the chunks by their sequence number */
+    uint32_t chunk_count;
+    uint32_t chunk_size;
+
+    struct lyb_index_entry {
+        uint64_t offset;            /**< offset of the "siblings" with the children */
+        uint64_t end;               /**< offset right after the node */
+        uint8_t depth;              /**< number of the enclosing "siblings" */
+        uint32_t level;             /**< index of the state of the first enclosing "siblings" in levels */
+    } *entries;                     /**< entries sorted by their offset */
+    uint32_t entry_count;
+    uint32_t entry_size;
+
+    struct lyb_index_level {
+        size_t chunk;               /**< sequence number of the current chunk */
+        size_t written;             /**< bytes written into the chunk */
+    } *levels;                      /**< states of the enclosing "siblings" of all the entries */
+    uint32_t level_count;
+    uint32_t level_size;
+};
 
 /**
- * @brief Hash table equal callback for checking value pointer equality only.
+ * @brief Make sure an index array has space for more items.
  *
- * Implementation of ::lyht_value_equal_cb.
+ * @param[in] ctx libyang context for logging.
+ * @param[in,out] items Array of items.
+ * @param[in,out] size Allocated items.
+ * @param[in] count Used items.
+ * @param[in] needed Number of items to be added.
+ * @param[in] item_size Size of an item.
+ * @return LY_ERR value.
  */
-static ly_bool
-lyb_ptr_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+static LY_ERR
+lyb_index_grow(const struct ly_ctx *ctx, void **items, uint32_t *size, uint32_t count, uint32_t needed, size_t item_size)
 {
-    struct lysc_node *val1 = *(struct lysc_node **)val1_p;
-    struct lysc_node *val2 = *(struct lysc_node **)val2_p;
+    uint32_t new_size;
+    void *mem;
 
-    if (val1 == val2) {
-        return 1;
+    if (count + needed <= *size) {
+        return LY_SUCCESS;
     }
-    return 0;
-}
 
-/**
- * @brief Hash table equal callback for checking collisions.
- *
- * Implementation of ::lyht_value_equal_cb.
- */
-static ly_bool
-lyb_col_equal_cb(void *val1_p, void *val2_p, ly_bool mod, void *cb_data)
-{
-    /* for first value check use lyb_ptr_equal_cb, for collisions lyb_hash_equal_cb */
-    return mod ? lyb_ptr_equal_cb(val1_p, val2_p, mod, cb_data) : lyb_hash_equal_cb(val1_p, val2_p, mod, cb_data);
+    new_size = *size ? *size * 2 : 64;
+    while (new_size < count + needed) {
+        new_size *= 2;
+    }
+
+    mem = realloc(*items, new_size * item_size);
+    LY_CHECK_ERR_RET(!mem, LOGMEM(ctx), LY_EMEM);
+    *items = mem;
+    *size = new_size;
+
+    return LY_SUCCESS;
 }
 
 /**
- * @brief Check that sibling collision hash is safe to insert into hash table.
+ * @brief Free an index.
  *
- * @param[in] ht Hash table.
- * @param[in] sibling Hashed sibling.
- * @param[in] ht_col_id Sibling hash collision ID.
- * @param[in] compare_col_id Last collision ID to compare with.
- * @return LY_SUCCESS when the whole hash sequence does not collide,
- * @return LY_EEXIST when the whole hash sequence sollides.
+ * @param[in] index Index to free.
  */
-static LY_ERR
-lyb_hash_sequence_check(struct ly_ht *ht, struct lysc_node *sibling, LYB_HASH ht_col_id, LYB_HASH compare_col_id)
+static void
+lyb_index_free(struct lyb_index *index)
 {
-    struct lysc_node **col_node;
-
-    /* get the first node inserted with last hash col ID ht_col_id */
-    if (lyht_find(ht, &sibling, lyb_get_hash(sibling, ht_col_id), (void **)&col_node)) {
-        /* there is none. valid situation */
-        return LY_SUCCESS;
+    if (!index) {
+        return;
     }
 
-    do {
-        int64_t j;
-
-        for (j = (int64_t)compare_col_id; j > -1; --j) {
-            if (lyb_get_hash(sibling, j) != lyb_get_hash(*col_node, j)) {
-                /* one non-colliding hash */
-                break;
-            }
-        }
-        if (j == -1) {
-            /* all whole hash sequences of nodes inserted with last hash col ID compare_col_id collide */
-            return LY_EEXIST;
-        }
-
-        /* get next node inserted with last hash col ID ht_col_id */
-    } while (!lyht_find_next_with_collision_cb(ht, col_node, lyb_get_hash(*col_node, ht_col_id), lyb_col_equal_cb,
-            (void **)&col_node));
-
-    return LY_SUCCESS;
+    free(index->chunks);
+    free(index->entries);
+    free(index->levels);
+    free(index);
 }
 
 /**
- * @brief Hash all the siblings and add them also into a separate hash table.
+ * @brief Assign a sequence number to a new chunk of "siblings", if creating an index.
  *
- * @param[in] sibling Any sibling in all the siblings on one level.
- * @param[out] ht_p Created hash table.
+ * @param[in] lybctx LYB context.
+ * @param[in] sib "Siblings" with the new chunk.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyb_hash_siblings(struct lysc_node *sibling, struct ly_ht **ht_p)
+lyb_index_chunk_new(struct lylyb_ctx *lybctx, struct lyd_lyb_sibling *sib)
 {
-    struct ly_ht *ht;
-    const struct lysc_node *parent;
-    const struct lys_module *mod;
-    LYB_HASH i;
-    uint32_t getnext_opts;
-
-    ht = lyht_new(1, sizeof(struct lysc_node *), lyb_hash_equal_cb, NULL, 1);
-    LY_CHECK_ERR_RET(!ht, LOGMEM(sibling->module->ctx), LY_EMEM);
-
-    getnext_opts = 0;
-    if (sibling->flags & LYS_IS_OUTPUT) {
-        getnext_opts = LYS_GETNEXT_OUTPUT;
-    }
-
-    parent = lysc_data_parent(sibling);
-    mod = sibling->module;
+    struct lyb_index *index = lybctx->index;
 
-    sibling = NULL;
-    while ((sibling = (struct lysc_node *)lys_getnext(sibling, parent, mod->compiled, getnext_opts))) {
-        /* find the first non-colliding hash (or specifically non-colliding hash sequence) */
-        for (i = 0; i < LYB_HASH_BITS; ++i) {
-            /* check that we are not colliding with nodes inserted with a lower collision ID than ours */
-            int64_t j;
-
-            for (j = (int64_t)i - 1; j > -1; --j) {
-                if (lyb_hash_sequence_check(ht, sibling, (LYB_HASH)j, i)) {
-                    break;
-                }
-            }
-            if (j > -1) {
-                /* some check failed, we must use a higher collision ID */
-                continue;
-            }
-
-            /* try to insert node with the current collision ID */
-            if (!lyht_insert_with_resize_cb(ht, &sibling, lyb_get_hash(sibling, i), lyb_ptr_equal_cb, NULL)) {
-                /* success, no collision */
-                break;
-            }
-
-            /* make sure we really cannot insert it with this hash col ID (meaning the whole hash sequence is colliding) */
-            if (i && !lyb_hash_sequence_check(ht, sibling, i, i)) {
-                /* it can be inserted after all, even though there is already a node with the same last collision ID */
-                lyht_set_cb(ht, lyb_ptr_equal_cb);
-                if (lyht_insert(ht, &sibling, lyb_get_hash(sibling, i), NULL)) {
-                    LOGINT(sibling->module->ctx);
-                    lyht_set_cb(ht, lyb_hash_equal_cb);
-                    lyht_free(ht, NULL);
-                    return LY_EINT;
-                }
-                lyht_set_cb(ht, lyb_hash_equal_cb);
-                break;
-            }
-            /* there is still another colliding schema node with the same hash sequence, try higher collision ID */
-        }
-
-        if (i == LYB_HASH_BITS) {
-            /* wow */
-            LOGINT(sibling->module->ctx);
-            lyht_free(ht, NULL);
-            return LY_EINT;
-        }
+    if (!index) {
+        return LY_SUCCESS;
     }
 
-    /* change val equal callback so that the HT is usable for finding value hashes */
-    lyht_set_cb(ht, lyb_ptr_equal_cb);
+    LY_CHECK_RET(lyb_index_grow(lybctx->ctx, (void **)&index->chunks, &index->chunk_size, index->chunk_count, 1,
+            sizeof *index->chunks));
+    sib->chunk = index->chunk_count++;
 
-    *ht_p = ht;
     return LY_SUCCESS;
 }
 
@@ -244,9 +186,10 @@ lyb_hash_find(struct ly_ht *ht, struct lysc_node *node, LYB_HASH *hash_p)
  *
  * @param[in] out Out structure.
  * @param[in] sib Contains metadata that is written.
+ * @param[in] lybctx LYB context.
  */
 static LY_ERR
-lyb_write_sibling_meta(struct ly_out *out, struct lyd_lyb_sibling *sib)
+lyb_write_sibling_meta(struct ly_out *out, struct lyd_lyb_sibling *sib, struct lylyb_ctx *lybctx)
 {
     uint8_t meta_buf[LYB_META_BYTES];
     uint64_t num = 0;
@@ -259,6 +202,12 @@ lyb_write_sibling_meta(struct ly_out *out, struct lyd_lyb_sibling *sib)
 
     LY_CHECK_RET(ly_write_skipped(out, sib->position, (char *)&meta_buf, LYB_META_BYTES));
 
+    if (lybctx->index) {
+        /* the chunk is final */
+        lybctx->index->chunks[sib->chunk].written = sib->written;
+        lybctx->index->chunks[sib->chunk].inner_chunks = sib->inner_chunks;
+    }
+
     return LY_SUCCESS;
 }
 
@@ -311,7 +260,7 @@ lyb_write(struct ly_out *out, const uint8_t *buf, size_t count, struct lylyb_ctx
 
         if (full) {
             /* write the meta information (inner chunk count and chunk size) */
-            LY_CHECK_RET(lyb_write_sibling_meta(out, full));
+            LY_CHECK_RET(lyb_write_sibling_meta(out, full, lybctx));
 
             /* zero written and inner chunks */
             full->written = 0;
@@ -319,6 +268,7 @@ lyb_write(struct ly_out *out, const uint8_t *buf, size_t count, struct lylyb_ctx
 
             /* skip space for another chunk size */
             LY_CHECK_RET(ly_write_skip(out, LYB_META_BYTES, &full->position));
+            LY_CHECK_RET(lyb_index_chunk_new(lybctx, full));
 
             /* increase inner chunk count */
             for (iter = &lybctx->siblings[0]; iter != full; ++iter) {
@@ -345,7 +295,7 @@ static LY_ERR
 lyb_write_stop_siblings(struct ly_out *out, struct lylyb_ctx *lybctx)
 {
     /* write the meta chunk information */
-    lyb_write_sibling_meta(out, &LYB_LAST_SIBLING(lybctx));
+    LY_CHECK_RET(lyb_write_sibling_meta(out, &LYB_LAST_SIBLING(lybctx), lybctx));
 
     LY_ARRAY_DECREMENT(lybctx->siblings);
     return LY_SUCCESS;
@@ -383,6 +333,7 @@ lyb_write_start_siblings(struct ly_out *out, struct lylyb_ctx *lybctx)
     }
 
     LY_CHECK_RET(ly_write_skip(out, LYB_META_BYTES, &LYB_LAST_SIBLING(lybctx).position));
+    LY_CHECK_RET(lyb_index_chunk_new(lybctx, &LYB_LAST_SIBLING(lybctx)));
 
     return LY_SUCCESS;
 }
@@ -524,10 +475,11 @@ lyb_print_magic_number(struct ly_out *out)
  * @brief Print LYB header.
  *
  * @param[in] out Out structure.
+ * @param[in] lybctx LYB context, without a libyang context if printing empty data.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyb_print_header(struct ly_out *out, const struct ly_ctx *ctx)
+lyb_print_header(struct ly_out *out, struct lylyb_ctx *lybctx)
 {
     uint8_t byte = 0;
     uint32_t hash;
@@ -535,17 +487,28 @@ lyb_print_header(struct ly_out *out, const struct ly_ctx *ctx)
     /* version, hash algorithm (flags) */
     byte |= LYB_HEADER_VERSION_NUM;
     byte |= LYB_HEADER_HASH_ALG;
+    if (lybctx->index) {
+        byte |= LYB_HEADER_INDEX;
+    }
+    if (lybctx->diff) {
+        byte |= LYB_HEADER_DIFF;
+    }
 
     LY_CHECK_RET(ly_write_(out, (char *)&byte, sizeof byte));
 
     /* context hash, if not printing empty data */
-    if (ctx) {
-        hash = ly_ctx_get_modules_hash(ctx);
+    if (lybctx->ctx) {
+        hash = ly_ctx_get_modules_hash(lybctx->ctx);
     } else {
         hash = 0;
     }
     LY_CHECK_RET(ly_write_(out, (char *)&hash, sizeof hash));
 
+    if (lybctx->index) {
+        /* index offset, known only after the data are printed */
+        LY_CHECK_RET(ly_write_skip(out, LYB_INDEX_OFFSET_BYTES, &lybctx->index->hole));
+    }
+
     return LY_SUCCESS;
 }
 
@@ -675,6 +638,38 @@ cleanup:
     return ret;
 }
 
+/**
+ * @brief Print the value of diff metadata in its binary form.
+ *
+ * @param[in] out Out structure.
+ * @param[in] meta Diff metadata to print.
+ * @param[in] code Diff code of @p meta.
+ * @param[in] lybctx LYB context.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_print_diff_meta_value(struct ly_out *out, const struct lyd_meta *meta, uint8_t code, struct lylyb_ctx *lybctx)
+{
+    const char *value = lyd_get_meta_value(meta);
+    uint8_t byte;
+
+    switch (code) {
+    case LYB_DIFF_META_OPERATION:
+        for (byte = 0; byte < LYB_DIFF_OP_COUNT; ++byte) {
+            if (!strcmp(value, lyb_diff_op_names[byte])) {
+                break;
+            }
+        }
+        LY_CHECK_ERR_RET(byte == LYB_DIFF_OP_COUNT, LOGINT(lybctx->ctx), LY_EINT);
+        return lyb_write(out, &byte, 1, lybctx);
+    case LYB_DIFF_META_ORIG_DEFAULT:
+        byte = meta->value.boolean ? 1 : 0;
+        return lyb_write(out, &byte, 1, lybctx);
+    default:
+        return lyb_write_string(value, 0, sizeof(uint32_t), out, lybctx);
+    }
+}
+
 /**
  * @brief Print YANG node metadata.
  *
@@ -686,7 +681,7 @@ cleanup:
 static LY_ERR
 lyb_print_metadata(struct ly_out *out, const struct lyd_node *node, struct lyd_lyb_ctx *lybctx)
 {
-    uint8_t count = 0;
+    uint8_t count = 0, code = LYB_DIFF_META_GENERIC;
     const struct lys_module *wd_mod = NULL;
     struct lyd_meta *iter;
 
@@ -718,6 +713,10 @@ lyb_print_metadata(struct ly_out *out, const struct lyd_node *node, struct lyd_l
     LY_CHECK_RET(lyb_write(out, &count, 1, lybctx->lybctx));
 
     if (wd_mod) {
+        if (lybctx->lybctx->diff) {
+            LY_CHECK_RET(lyb_write(out, &code, 1, lybctx->lybctx));
+        }
+
         /* write the "default" metadata */
         LY_CHECK_RET(lyb_print_module(out, wd_mod, lybctx->lybctx));
         LY_CHECK_RET(lyb_write_string("default", 0, sizeof(uint16_t), out, lybctx->lybctx));
@@ -730,6 +729,17 @@ lyb_print_metadata(struct ly_out *out, const struct lyd_node *node, struct lyd_l
             continue;
         }
 
+        if (lybctx->lybctx->diff) {
+            /* diff metadata code */
+            code = lyb_diff_meta_code(iter);
+            LY_CHECK_RET(lyb_write(out, &code, 1, lybctx->lybctx));
+
+            if (code) {
+                LY_CHECK_RET(lyb_print_diff_meta_value(out, iter, code, lybctx->lybctx));
+                continue;
+            }
+        }
+
         /* module */
         LY_CHECK_RET(lyb_print_module(out, iter->annotation->module, lybctx->lybctx));
 
@@ -804,10 +814,8 @@ lyb_print_attributes(struct ly_out *out, const struct lyd_node_opaq *node, struc
 static LY_ERR
 lyb_print_schema_hash(struct ly_out *out, struct lysc_node *schema, struct ly_ht **sibling_ht, struct lylyb_ctx *lybctx)
 {
-    LY_ARRAY_COUNT_TYPE u;
     uint32_t i;
     LYB_HASH hash;
-    struct lyd_lyb_sib_ht *sib_ht;
     struct lysc_node *first_sibling;
 
     if (!schema) {
@@ -817,29 +825,12 @@ lyb_print_schema_hash(struct ly_out *out, struct lysc_node *schema, struct ly_ht
         return LY_SUCCESS;
     }
 
-    /* create whole sibling HT if not already created and saved */
+    /* get whole sibling HT if not already got for these siblings, it is cached in the context */
     if (!*sibling_ht) {
         /* get first schema data sibling */
         first_sibling = (struct lysc_node *)lys_getnext(NULL, lysc_data_parent(schema), schema->module->compiled,
                 (schema->flags & LYS_IS_OUTPUT) ? LYS_GETNEXT_OUTPUT : 0);
-        LY_ARRAY_FOR(lybctx->sib_hts, u) {
-            if (lybctx->sib_hts[u].first_sibling == first_sibling) {
-                /* we have already created a hash table for these siblings */
-                *sibling_ht = lybctx->sib_hts[u].ht;
-                break;
-            }
-        }
-
-        if (!*sibling_ht) {
-            /* we must create sibling hash table */
-            LY_CHECK_RET(lyb_hash_siblings(first_sibling, sibling_ht));
-
-            /* and save it */
-            LY_ARRAY_NEW_RET(lybctx->ctx, lybctx->sib_hts, sib_ht, LY_EMEM);
-
-            sib_ht->first_sibling = first_sibling;
-            sib_ht->ht = *sibling_ht;
-        }
+        LY_CHECK_RET(lyb_sibs_get_ht(first_sibling, sibling_ht));
     }
 
     /* get our hash */
@@ -918,6 +909,119 @@ lyb_print_lyb_type(struct ly_out *out, const struct lyd_node *node, struct lyd_l
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Print the children of an inner node, add an index entry of the node, if required.
+ *
+ * @param[in] out Out structure.
+ * @param[in] node Inner node whose children to print.
+ * @param[in] lybctx LYB context.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_print_children(struct ly_out *out, const struct lyd_node *node, struct lyd_lyb_ctx *lybctx)
+{
+    struct lylyb_ctx *lyb = lybctx->lybctx;
+    struct lyb_index *index = lyb->index;
+    struct lyb_index_entry *entry;
+    LY_ARRAY_COUNT_TYPE u, depth;
+    uint32_t e;
+
+    depth = LY_ARRAY_COUNT(lyb->siblings);
+    if (!index || !lyb_index_node(node->schema) || (LYD_CTX(node) != lyb->ctx) || (depth > UINT8_MAX)) {
+        return lyb_print_siblings(out, lyd_child(node), lybctx);
+    }
+
+    /* add the entry before printing the children so that the entries remain sorted by their offset */
+    LY_CHECK_RET(lyb_index_grow(lyb->ctx, (void **)&index->entries, &index->entry_size, index->entry_count, 1,
+            sizeof *index->entries));
+    e = index->entry_count++;
+    index->entries[e].offset = out->printed - index->base;
+
+    LY_CHECK_RET(lyb_print_siblings(out, lyd_child(node), lybctx));
+
+    /* the state of all the enclosing "siblings" after the node */
+    LY_CHECK_RET(lyb_index_grow(lyb->ctx, (void **)&index->levels, &index->level_size, index->level_count, depth,
+            sizeof *index->levels));
+    entry = &index->entries[e];
+    entry->end = out->printed - index->base;
+    entry->depth = depth;
+    entry->level = index->level_count;
+    for (u = 0; u < depth; ++u) {
+        index->levels[index->level_count].chunk = lyb->siblings[u].chunk;
+        index->levels[index->level_count].written = lyb->siblings[u].written;
+        ++index->level_count;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Print the index of the printed data.
+ *
+ * @param[in] out Out structure.
+ * @param[in] lybctx LYB context.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyb_print_index(struct ly_out *out, struct lylyb_ctx *lybctx)
+{
+    struct lyb_index *index = lybctx->index;
+    struct lyb_index_entry *entry;
+    struct lyb_index_level *level;
+    struct lyb_index_chunk *chunk;
+    uint8_t level_buf[LYB_INDEX_LEVEL_BYTES];
+    uint64_t index_offset, len, num;
+    uint32_t e, u;
+
+    index_offset = out->printed - index->base;
+
+    /* index length and entry count */
+    len = 2 * LYB_INDEX_OFFSET_BYTES + (uint64_t)index->entry_count * LYB_INDEX_OFFSET_BYTES;
+    for (e = 0; e < index->entry_count; ++e) {
+        len += 2 * LYB_INDEX_OFFSET_BYTES + 1 + index->entries[e].depth * LYB_INDEX_LEVEL_BYTES;
+    }
+    num = htole64(len);
+    LY_CHECK_RET(ly_write_(out, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+    num = htole64((uint64_t)index->entry_count);
+    LY_CHECK_RET(ly_write_(out, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+
+    /* entry offsets */
+    len = index_offset + 2 * LYB_INDEX_OFFSET_BYTES + (uint64_t)index->entry_count * LYB_INDEX_OFFSET_BYTES;
+    for (e = 0; e < index->entry_count; ++e) {
+        num = htole64(len);
+        LY_CHECK_RET(ly_write_(out, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+        len += 2 * LYB_INDEX_OFFSET_BYTES + 1 + index->entries[e].depth * LYB_INDEX_LEVEL_BYTES;
+    }
+
+    /* entries */
+    for (e = 0; e < index->entry_count; ++e) {
+        entry = &index->entries[e];
+        num = htole64(entry->offset);
+        LY_CHECK_RET(ly_write_(out, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+        num = htole64(entry->end);
+        LY_CHECK_RET(ly_write_(out, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+        LY_CHECK_RET(ly_write_(out, (char *)&entry->depth, 1));
+
+        for (u = 0; u < entry->depth; ++u) {
+            /* the state the parser will have, the remaining bytes of the chunk */
+            level = &index->levels[entry->level + u];
+            chunk = &index->chunks[level->chunk];
+            num = htole64((uint64_t)(chunk->written - level->written));
+            memcpy(level_buf, &num, LYB_SIZE_BYTES);
+            num = htole64((uint64_t)chunk->inner_chunks);
+            memcpy(level_buf + LYB_SIZE_BYTES, &num, LYB_INCHUNK_BYTES);
+            level_buf[LYB_META_BYTES] = (chunk->written == LYB_SIZE_MAX) ? 1 : 0;
+            LY_CHECK_RET(ly_write_(out, (char *)level_buf, LYB_INDEX_LEVEL_BYTES));
+        }
+    }
+
+    /* index offset in the header */
+    num = htole64(index_offset);
+    LY_CHECK_RET(ly_write_skipped(out, index->hole, (char *)&num, LYB_INDEX_OFFSET_BYTES));
+
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Print inner node.
  *
@@ -929,11 +1033,14 @@ lyb_print_lyb_type(struct ly_out *out, const struct lyd_node *node, struct lyd_l
 static LY_ERR
 lyb_print_node_inner(struct ly_out *out, const struct lyd_node *node, struct lyd_lyb_ctx *lybctx)
 {
+    /* lazily parsed LYB children, before the flags are printed */
+    LY_CHECK_RET(lyd_lyb_stub_load(node));
+
     /* write necessary basic data */
     LY_CHECK_RET(lyb_print_node_header(out, node, lybctx));
 
     /* recursively write all the descendants */
-    LY_CHECK_RET(lyb_print_siblings(out, lyd_child(node), lybctx));
+    LY_CHECK_RET(lyb_print_children(out, node, lybctx));
 
     return LY_SUCCESS;
 }
@@ -1126,11 +1233,14 @@ lyb_print_node_list(struct ly_out *out, const struct lyd_node *node, struct lyd_
             break;
         }
 
+        /* lazily parsed LYB children, before the flags are printed */
+        LY_CHECK_RET(lyd_lyb_stub_load(node));
+
         /* write necessary basic data */
         LY_CHECK_RET(lyb_print_node_header(out, node, lybctx));
 
         /* recursively write all the descendants */
-        LY_CHECK_RET(lyb_print_siblings(out, lyd_child(node), lybctx));
+        LY_CHECK_RET(lyb_print_children(out, node, lybctx));
 
         *printed_node = node;
     }
@@ -1241,6 +1351,7 @@ lyb_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options
     LY_CHECK_ERR_GOTO(!lybctx->lybctx, LOGMEM(ctx); ret = LY_EMEM, cleanup);
 
     lybctx->print_options = options;
+    lybctx->lybctx->diff = (options & LYD_PRINT_LYB_DIFF) ? 1 : 0;
     if (root) {
         lybctx->lybctx->ctx = ctx;
         assert(ctx->mod_hash);
@@ -1250,13 +1361,19 @@ lyb_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options
             ret = LY_EINVAL;
             goto cleanup;
         }
+
+        if (options & LYD_PRINT_LYB_INDEX) {
+            lybctx->lybctx->index = calloc(1, sizeof *lybctx->lybctx->index);
+            LY_CHECK_ERR_GOTO(!lybctx->lybctx->index, LOGMEM(ctx); ret = LY_EMEM, cleanup);
+            lybctx->lybctx->index->base = out->printed;
+        }
     }
 
     /* LYB magic number */
     LY_CHECK_GOTO(ret = lyb_print_magic_number(out), cleanup);
 
     /* LYB header */
-    LY_CHECK_GOTO(ret = lyb_print_header(out, lybctx->lybctx->ctx), cleanup);
+    LY_CHECK_GOTO(ret = lyb_print_header(out, lybctx->lybctx), cleanup);
 
     /* all the top-level siblings, recursively */
     LY_CHECK_GOTO(ret = lyb_print_siblings(out, root, lybctx), cleanup);
@@ -1264,7 +1381,16 @@ lyb_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options
     /* ending zero byte */
     LY_CHECK_GOTO(ret = lyb_write(out, &zero, sizeof zero, lybctx->lybctx), cleanup);
 
+    if (lybctx->lybctx->index) {
+        /* index of the subtrees */
+        LY_CHECK_GOTO(ret = lyb_print_index(out, lybctx->lybctx), cleanup);
+    }
+
 cleanup:
+    if (lybctx && lybctx->lybctx) {
+        lyb_index_free(lybctx->lybctx->index);
+        lybctx->lybctx->index = NULL;
+    }
     lyd_lyb_ctx_free((struct lyd_ctx *)lybctx);
     return ret;
 }
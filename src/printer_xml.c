@@ -32,6 +32,7 @@
 #include "set.h"
 #include "tree.h"
 #include "tree_data.h"
+#include "tree_data_internal.h"
 #include "tree_schema.h"
 #include "xml.h"
 
@@ -45,6 +46,21 @@ struct xmlpr_ctx {
     const struct ly_ctx *ctx; /**< libyang context */
     struct ly_set prefix;     /**< printed namespace prefixes */
     struct ly_set ns;         /**< printed namespaces */
+    struct ly_set term_ns;    /**< modules of the prefixes in a term node value, reused to avoid allocations per node */
+
+    const struct lyd_node *root;    /**< top-level node being printed */
+    struct lypr_stream *par;  /**< stream to create parallel print tasks in, NULL if not allowed */
+    const struct lyd_node *par_skip;    /**< last list instance printed by parallel tasks, all the instances are skipped */
+};
+
+/**
+ * @brief XML printer task of a parallel print.
+ */
+struct xmlpr_task {
+    struct xmlpr_ctx pctx;    /**< printer context of the task */
+    const struct lyd_node *first;   /**< first sibling to print */
+    uint32_t count;           /**< number of siblings to print */
+    ly_bool top;              /**< whether the siblings are top-level nodes */
 };
 
 #define LYXML_PREFIX_REQUIRED 0x01  /**< The prefix is not just a suggestion but a requirement. */
@@ -70,7 +86,7 @@ xml_print_ns(struct xmlpr_ctx *pctx, const char *ns, const char *new_prefix, uin
         if (!new_prefix) {
             /* find default namespace */
             if (!pctx->prefix.objs[i - 1]) {
-                if (!strcmp(pctx->ns.objs[i - 1], ns)) {
+                if ((pctx->ns.objs[i - 1] == ns) || !strcmp(pctx->ns.objs[i - 1], ns)) {
                     /* matching default namespace */
                     return pctx->prefix.objs[i - 1];
                 }
@@ -79,7 +95,7 @@ xml_print_ns(struct xmlpr_ctx *pctx, const char *ns, const char *new_prefix, uin
             }
         } else {
             /* find prefixed namespace */
-            if (!strcmp(pctx->ns.objs[i - 1], ns)) {
+            if ((pctx->ns.objs[i - 1] == ns) || !strcmp(pctx->ns.objs[i - 1], ns)) {
                 if (!pctx->prefix.objs[i - 1]) {
                     /* default namespace is not interesting */
                     continue;
@@ -94,7 +110,14 @@ xml_print_ns(struct xmlpr_ctx *pctx, const char *ns, const char *new_prefix, uin
     }
 
     /* suitable namespace not found, must be printed */
-    ly_print_(pctx->out, " xmlns%s%s=\"%s\"", new_prefix ? ":" : "", new_prefix ? new_prefix : "", ns);
+    ly_print_lit(pctx->out, " xmlns");
+    if (new_prefix) {
+        ly_print_lit(pctx->out, ":");
+        ly_print_str(pctx->out, new_prefix);
+    }
+    ly_print_lit(pctx->out, "=\"");
+    ly_print_str(pctx->out, ns);
+    ly_print_lit(pctx->out, "\"");
 
     /* and added into namespaces */
     if (new_prefix) {
@@ -195,8 +218,8 @@ xml_print_meta(struct xmlpr_ctx *pctx, const struct lyd_node *node)
     const struct lys_module *mod;
     struct ly_set ns_list = {0};
     LY_ARRAY_COUNT_TYPE u;
-    ly_bool dynamic, filter_attrs = 0;
-    const char *value;
+    ly_bool dynamic, filter_attrs = 0, filter_checked = 0;
+    const char *value, *prefix;
     uint32_t i;
 
     /* with-defaults */
@@ -206,20 +229,10 @@ xml_print_meta(struct xmlpr_ctx *pctx, const struct lyd_node *node)
             /* we have implicit OR explicit default node, print attribute only if context include with-defaults schema */
             mod = ly_ctx_get_module_latest(LYD_CTX(node), "ietf-netconf-with-defaults");
             if (mod) {
-                ly_print_(pctx->out, " %s:default=\"true\"", xml_print_ns(pctx, mod->ns, mod->prefix, 0));
-            }
-        }
-    }
-
-    /* check for NETCONF filter unqualified attributes */
-    if (!strcmp(node->schema->module->name, "notifications")) {
-        filter_attrs = 1;
-    } else {
-        LY_ARRAY_FOR(node->schema->exts, u) {
-            if (!strcmp(node->schema->exts[u].def->name, "get-filter-element-attributes") &&
-                    !strcmp(node->schema->exts[u].def->module->name, "ietf-netconf")) {
-                filter_attrs = 1;
-                break;
+                prefix = xml_print_ns(pctx, mod->ns, mod->prefix, 0);
+                ly_print_lit(pctx->out, " ");
+                ly_print_str(pctx->out, prefix);
+                ly_print_lit(pctx->out, ":default=\"true\"");
             }
         }
     }
@@ -229,6 +242,22 @@ xml_print_meta(struct xmlpr_ctx *pctx, const struct lyd_node *node)
             continue;
         }
 
+        if (!filter_checked) {
+            /* check for NETCONF filter unqualified attributes, only once there is some metadata to print */
+            if (!strcmp(node->schema->module->name, "notifications")) {
+                filter_attrs = 1;
+            } else {
+                LY_ARRAY_FOR(node->schema->exts, u) {
+                    if (!strcmp(node->schema->exts[u].def->name, "get-filter-element-attributes") &&
+                            !strcmp(node->schema->exts[u].def->module->name, "ietf-netconf")) {
+                        filter_attrs = 1;
+                        break;
+                    }
+                }
+            }
+            filter_checked = 1;
+        }
+
         /* store the module of the default namespace, NULL because there is none */
         ly_set_add(&ns_list, NULL, 0, NULL);
 
@@ -246,23 +275,47 @@ xml_print_meta(struct xmlpr_ctx *pctx, const struct lyd_node *node)
         if (filter_attrs && !strcmp(mod->name, "ietf-netconf") && (!strcmp(meta->name, "type") ||
                 !strcmp(meta->name, "select"))) {
             /* print special NETCONF filter unqualified attributes */
-            ly_print_(pctx->out, " %s=\"", meta->name);
+            ly_print_lit(pctx->out, " ");
         } else {
             /* print the metadata with its namespace */
-            ly_print_(pctx->out, " %s:%s=\"", xml_print_ns(pctx, mod->ns, mod->prefix, 1), meta->name);
+            prefix = xml_print_ns(pctx, mod->ns, mod->prefix, 1);
+            ly_print_lit(pctx->out, " ");
+            ly_print_str(pctx->out, prefix);
+            ly_print_lit(pctx->out, ":");
         }
+        ly_print_str(pctx->out, meta->name);
+        ly_print_lit(pctx->out, "=\"");
 
         /* print metadata value */
         if (value && value[0]) {
             lyxml_dump_text(pctx->out, value, 1);
         }
-        ly_print_(pctx->out, "\"");
+        ly_print_lit(pctx->out, "\"");
         if (dynamic) {
             free((void *)value);
         }
     }
 }
 
+/**
+ * @brief Print closing tag of an XML element.
+ *
+ * @param[in] pctx XML printer context.
+ * @param[in] name Element name.
+ * @param[in] indent Whether to print indentation before the tag.
+ */
+static void
+xml_print_close(struct xmlpr_ctx *pctx, const char *name, ly_bool indent)
+{
+    if (indent) {
+        PRINT_INDENT;
+    }
+    ly_print_lit(pctx->out, "</");
+    ly_print_str(pctx->out, name);
+    ly_print_lit(pctx->out, ">");
+    PRINT_NEWLINE;
+}
+
 /**
  * @brief Print generic XML element despite of the data node type.
  *
@@ -275,7 +328,9 @@ static void
 xml_print_node_open(struct xmlpr_ctx *pctx, const struct lyd_node *node)
 {
     /* print node name */
-    ly_print_(pctx->out, "%*s<%s", INDENT, node->schema->name);
+    PRINT_INDENT;
+    ly_print_lit(pctx->out, "<");
+    ly_print_str(pctx->out, node->schema->name);
 
     /* print default namespace */
     xml_print_ns(pctx, node->schema->module->ns, NULL, 0);
@@ -309,9 +364,15 @@ xml_print_attr(struct xmlpr_ctx *pctx, const struct lyd_attr *attr)
         }
 
         /* print the attribute with its prefix and value */
-        ly_print_(pctx->out, " %s%s%s=\"", pref ? pref : "", pref ? ":" : "", attr->name.name);
+        ly_print_lit(pctx->out, " ");
+        if (pref) {
+            ly_print_str(pctx->out, pref);
+            ly_print_lit(pctx->out, ":");
+        }
+        ly_print_str(pctx->out, attr->name.name);
+        ly_print_lit(pctx->out, "=\"");
         lyxml_dump_text(pctx->out, attr->value, 1);
-        ly_print_(pctx->out, "\""); /* print attribute value terminator */
+        ly_print_lit(pctx->out, "\""); /* print attribute value terminator */
     }
 
     return LY_SUCCESS;
@@ -321,7 +382,9 @@ static LY_ERR
 xml_print_opaq_open(struct xmlpr_ctx *pctx, const struct lyd_node_opaq *node)
 {
     /* print node name */
-    ly_print_(pctx->out, "%*s<%s", INDENT, node->name.name);
+    PRINT_INDENT;
+    ly_print_lit(pctx->out, "<");
+    ly_print_str(pctx->out, node->name.name);
 
     if (node->name.prefix || node->name.module_ns) {
         /* print default namespace */
@@ -345,42 +408,49 @@ static LY_ERR
 xml_print_term(struct xmlpr_ctx *pctx, const struct lyd_node_term *node)
 {
     LY_ERR rc = LY_SUCCESS;
-    struct ly_set ns_list = {0};
+    struct ly_set *ns_list = &pctx->term_ns;
     ly_bool dynamic = 0;
     const char *value = NULL;
     const struct lys_module *mod;
     uint32_t i;
 
     /* store the module of the default namespace */
-    if ((rc = ly_set_add(&ns_list, node->schema->module, 0, NULL))) {
+    assert(!ns_list->count);
+    if ((rc = ly_set_add(ns_list, node->schema->module, 0, NULL))) {
         LOGMEM(pctx->ctx);
         goto cleanup;
     }
 
     /* print the value */
     value = ((struct lysc_node_leaf *)node->schema)->type->plugin->print(LYD_CTX(node), &node->value, LY_VALUE_XML,
-            &ns_list, &dynamic, NULL);
+            ns_list, &dynamic, NULL);
     LY_CHECK_ERR_GOTO(!value, rc = LY_EINVAL, cleanup);
 
     /* print node opening */
     xml_print_node_open(pctx, &node->node);
 
     /* print namespaces connected with the values's prefixes */
-    for (i = 1; i < ns_list.count; ++i) {
-        mod = ns_list.objs[i];
-        ly_print_(pctx->out, " xmlns:%s=\"%s\"", mod->prefix, mod->ns);
+    for (i = 1; i < ns_list->count; ++i) {
+        mod = ns_list->objs[i];
+        ly_print_lit(pctx->out, " xmlns:");
+        ly_print_str(pctx->out, mod->prefix);
+        ly_print_lit(pctx->out, "=\"");
+        ly_print_str(pctx->out, mod->ns);
+        ly_print_lit(pctx->out, "\"");
     }
 
     if (!value[0]) {
-        ly_print_(pctx->out, "/>%s", DO_FORMAT ? "\n" : "");
+        ly_print_lit(pctx->out, "/>");
+        PRINT_NEWLINE;
     } else {
-        ly_print_(pctx->out, ">");
+        ly_print_lit(pctx->out, ">");
         lyxml_dump_text(pctx->out, value, 0);
-        ly_print_(pctx->out, "</%s>%s", node->schema->name, DO_FORMAT ? "\n" : "");
+        xml_print_close(pctx, node->schema->name, 0);
     }
 
 cleanup:
-    ly_set_erase(&ns_list, NULL);
+    /* keep the memory for the next node */
+    ns_list->count = 0;
     if (dynamic) {
         free((void *)value);
     }
@@ -397,33 +467,53 @@ cleanup:
 static LY_ERR
 xml_print_inner(struct xmlpr_ctx *pctx, const struct lyd_node_inner *node)
 {
-    LY_ERR ret;
+    LY_ERR ret = LY_SUCCESS;
     struct lyd_node *child;
+    struct ly_set virt = {0};
+    uint32_t i;
+
+    /* lazily parsed LYB children */
+    LY_CHECK_RET(lyd_lyb_stub_load(&node->node));
 
     xml_print_node_open(pctx, &node->node);
 
+    if (pctx->options & (LYD_PRINT_WD_ALL | LYD_PRINT_WD_ALL_TAG | LYD_PRINT_WD_IMPL_TAG)) {
+        /* virtual default leaves are printed as well */
+        LY_CHECK_RET(lyd_dflt_virtual_children(&node->node, &virt));
+    }
+
     LY_LIST_FOR(node->child, child) {
         if (lyd_node_should_print(child, pctx->options)) {
             break;
         }
     }
-    if (!child) {
+    if (!child && !virt.count) {
         /* there are no children that will be printed */
-        ly_print_(pctx->out, "/>%s", DO_FORMAT ? "\n" : "");
+        ly_print_lit(pctx->out, "/>");
+        PRINT_NEWLINE;
         return LY_SUCCESS;
     }
 
     /* children */
-    ly_print_(pctx->out, ">%s", DO_FORMAT ? "\n" : "");
+    ly_print_lit(pctx->out, ">");
+    PRINT_NEWLINE;
 
     LEVEL_INC;
     LY_LIST_FOR(node->child, child) {
-        ret = xml_print_node(pctx, child);
-        LY_CHECK_ERR_RET(ret, LEVEL_DEC, ret);
+        LY_CHECK_GOTO(ret = xml_print_node(pctx, child), cleanup);
     }
+    for (i = 0; i < virt.count; ++i) {
+        LY_CHECK_GOTO(ret = xml_print_node(pctx, virt.dnodes[i]), cleanup);
+    }
+
+cleanup:
     LEVEL_DEC;
+    ly_set_erase(&virt, NULL);
+    if (ret) {
+        return ret;
+    }
 
-    ly_print_(pctx->out, "%*s</%s>%s", INDENT, node->schema->name, DO_FORMAT ? "\n" : "");
+    xml_print_close(pctx, node->schema->name, 1);
 
     return LY_SUCCESS;
 }
@@ -445,7 +535,8 @@ xml_print_anydata(struct xmlpr_ctx *pctx, const struct lyd_node_any *node)
     if (!any->value.tree) {
         /* no content */
 no_content:
-        ly_print_(pctx->out, "/>%s", DO_FORMAT ? "\n" : "");
+        ly_print_lit(pctx->out, "/>");
+        PRINT_NEWLINE;
         return LY_SUCCESS;
     } else {
         if (any->value_type == LYD_ANYDATA_LYB) {
@@ -472,7 +563,8 @@ no_content:
             pctx->options &= ~LYD_PRINT_WITHSIBLINGS;
             LEVEL_INC;
 
-            ly_print_(pctx->out, ">%s", DO_FORMAT ? "\n" : "");
+            ly_print_lit(pctx->out, ">");
+            PRINT_NEWLINE;
             LY_LIST_FOR(any->value.tree, iter) {
                 ret = xml_print_node(pctx, iter);
                 LY_CHECK_ERR_RET(ret, LEVEL_DEC, ret);
@@ -488,7 +580,7 @@ no_content:
                 goto no_content;
             }
             /* close opening tag and print data */
-            ly_print_(pctx->out, ">");
+            ly_print_lit(pctx->out, ">");
             lyxml_dump_text(pctx->out, any->value.str, 0);
             break;
         case LYD_ANYDATA_XML:
@@ -496,7 +588,8 @@ no_content:
             if (!any->value.str[0]) {
                 goto no_content;
             }
-            ly_print_(pctx->out, ">%s", any->value.str);
+            ly_print_lit(pctx->out, ">");
+            ly_print_str(pctx->out, any->value.str);
             break;
         case LYD_ANYDATA_LYB:
             /* LYB format is not supported */
@@ -505,11 +598,7 @@ no_content:
         }
 
         /* closing tag */
-        if (any->value_type == LYD_ANYDATA_DATATREE) {
-            ly_print_(pctx->out, "%*s</%s>%s", INDENT, node->schema->name, DO_FORMAT ? "\n" : "");
-        } else {
-            ly_print_(pctx->out, "</%s>%s", node->schema->name, DO_FORMAT ? "\n" : "");
-        }
+        xml_print_close(pctx, node->schema->name, any->value_type == LYD_ANYDATA_DATATREE);
     }
 
     return LY_SUCCESS;
@@ -529,14 +618,15 @@ xml_print_opaq(struct xmlpr_ctx *pctx, const struct lyd_node_opaq *node)
             xml_print_ns_prefix_data(pctx, node->format, node->val_prefix_data, LYXML_PREFIX_REQUIRED);
         }
 
-        ly_print_(pctx->out, ">");
+        ly_print_lit(pctx->out, ">");
         lyxml_dump_text(pctx->out, node->value, 0);
     }
 
     if (node->child) {
         /* children */
         if (!node->value[0]) {
-            ly_print_(pctx->out, ">%s", DO_FORMAT ? "\n" : "");
+            ly_print_lit(pctx->out, ">");
+            PRINT_NEWLINE;
         }
 
         LEVEL_INC;
@@ -546,17 +636,142 @@ xml_print_opaq(struct xmlpr_ctx *pctx, const struct lyd_node_opaq *node)
         }
         LEVEL_DEC;
 
-        ly_print_(pctx->out, "%*s</%s>%s", INDENT, node->name.name, DO_FORMAT ? "\n" : "");
+        xml_print_close(pctx, node->name.name, 1);
     } else if (node->value[0]) {
-        ly_print_(pctx->out, "</%s>%s", node->name.name, DO_FORMAT ? "\n" : "");
+        xml_print_close(pctx, node->name.name, 0);
     } else {
         /* no value or children */
-        ly_print_(pctx->out, "/>%s", DO_FORMAT ? "\n" : "");
+        ly_print_lit(pctx->out, "/>");
+        PRINT_NEWLINE;
     }
 
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Print the siblings of a parallel print task.
+ *
+ * @param[in] arg XML printer task (struct xmlpr_task *).
+ * @return LY_ERR value.
+ */
+static LY_ERR
+xml_print_task(void *arg)
+{
+    struct xmlpr_task *task = arg;
+    const struct lyd_node *node;
+    uint32_t i;
+
+    for (i = 0, node = task->first; i < task->count; ++i, node = node->next) {
+        if (task->top) {
+            task->pctx.root = node;
+        }
+        LY_CHECK_RET(xml_print_node(&task->pctx, node));
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Free an XML printer task of a parallel print.
+ *
+ * @param[in] arg XML printer task (struct xmlpr_task *).
+ */
+static void
+xml_print_task_free(void *arg)
+{
+    struct xmlpr_task *task = arg;
+    uint32_t i;
+
+    for (i = 0; i < task->pctx.prefix.count; ++i) {
+        lydict_remove(task->pctx.ctx, task->pctx.prefix.objs[i]);
+    }
+    ly_set_erase(&task->pctx.prefix, NULL);
+    ly_set_erase(&task->pctx.ns, NULL);
+    ly_set_erase(&task->pctx.term_ns, NULL);
+    free(task);
+}
+
+/**
+ * @brief Print siblings by a new parallel print task, in the current printer state.
+ *
+ * @param[in] pctx XML printer context.
+ * @param[in] first First sibling to print.
+ * @param[in] count Number of siblings to print.
+ * @param[in] top Whether the siblings are top-level nodes, their task may create further tasks.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+xml_print_task_start(struct xmlpr_ctx *pctx, const struct lyd_node *first, uint32_t count, ly_bool top)
+{
+    struct lypr_stream *task_stream;
+    struct xmlpr_task *task;
+    const char *prefix;
+    uint32_t i;
+
+    LY_CHECK_RET(lypr_task_new(pctx->par, NULL, &task_stream));
+
+    task = calloc(1, sizeof *task);
+    LY_CHECK_ERR_RET(!task, LOGMEM(pctx->ctx), LY_EMEM);
+    task->pctx.out = task_stream->out;
+    task->pctx.level = pctx->level;
+    task->pctx.options = pctx->options;
+    task->pctx.ctx = pctx->ctx;
+    task->pctx.root = pctx->root;
+    task->pctx.par = top ? task_stream : NULL;
+    task->first = first;
+    task->count = count;
+    task->top = top;
+
+    /* the namespaces printed so far */
+    for (i = 0; i < pctx->ns.count; ++i) {
+        prefix = NULL;
+        if (pctx->prefix.objs[i]) {
+            LY_CHECK_ERR_RET(lydict_dup(pctx->ctx, pctx->prefix.objs[i], &prefix), xml_print_task_free(task), LY_EMEM);
+        }
+        LY_CHECK_ERR_RET(ly_set_add(&task->pctx.prefix, (void *)prefix, 1, NULL),
+                lydict_remove(pctx->ctx, prefix); xml_print_task_free(task), LY_EMEM);
+        LY_CHECK_ERR_RET(ly_set_add(&task->pctx.ns, pctx->ns.objs[i], 1, NULL), xml_print_task_free(task), LY_EMEM);
+    }
+
+    return lypr_task_start(task_stream, xml_print_task, xml_print_task_free, task);
+}
+
+/**
+ * @brief Print a long run of list instances by parallel print tasks.
+ *
+ * @param[in] pctx XML printer context.
+ * @param[in] node First list instance of the run.
+ * @return LY_SUCCESS if the instances are printed, ::xml_print_node() skips them.
+ * @return LY_ENOT if the run is too short.
+ * @return LY_ERR value on error.
+ */
+static LY_ERR
+xml_print_list_parallel(struct xmlpr_ctx *pctx, const struct lyd_node *node)
+{
+    const struct lyd_node *iter, *first, *last = NULL;
+    uint32_t count;
+
+    for (iter = node, count = 0; iter && (iter->schema == node->schema) && (count < 2 * LYPR_PARALLEL_CHUNK); iter = iter->next) {
+        ++count;
+    }
+    if (count < 2 * LYPR_PARALLEL_CHUNK) {
+        return LY_ENOT;
+    }
+
+    iter = node;
+    while (iter && (iter->schema == node->schema)) {
+        first = iter;
+        for (count = 0; iter && (iter->schema == node->schema) && (count < LYPR_PARALLEL_CHUNK); iter = iter->next) {
+            last = iter;
+            ++count;
+        }
+        LY_CHECK_RET(xml_print_task_start(pctx, first, count, 0));
+    }
+
+    pctx->par_skip = last;
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Print XML element representing lyd_node.
  *
@@ -570,6 +785,25 @@ xml_print_node(struct xmlpr_ctx *pctx, const struct lyd_node *node)
     LY_ERR ret = LY_SUCCESS;
     uint32_t ns_count;
 
+    if (pctx->par_skip) {
+        /* printed by parallel tasks */
+        if (node == pctx->par_skip) {
+            pctx->par_skip = NULL;
+        }
+        return LY_SUCCESS;
+    }
+
+    if (pctx->par && node->schema && (node->schema->nodetype == LYS_LIST) &&
+            (!node->prev->next || (node->prev->schema != node->schema)) &&
+            ((pctx->root != node) || (pctx->options & LYD_PRINT_WITHSIBLINGS))) {
+        /* try to print the instances in parallel */
+        ret = xml_print_list_parallel(pctx, node);
+        if (ret != LY_ENOT) {
+            return ret;
+        }
+        ret = LY_SUCCESS;
+    }
+
     if (!lyd_node_should_print(node, pctx->options)) {
         /* do not print at all */
         return LY_SUCCESS;
@@ -617,8 +851,10 @@ xml_print_node(struct xmlpr_ctx *pctx, const struct lyd_node *node)
 LY_ERR
 xml_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options)
 {
-    const struct lyd_node *node;
+    LY_ERR rc = LY_SUCCESS;
+    const struct lyd_node *node, *last;
     struct xmlpr_ctx pctx = {0};
+    uint32_t count;
 
     if (!root) {
         if ((out->type == LY_OUT_MEMORY) || (out->type == LY_OUT_CALLBACK)) {
@@ -632,18 +868,45 @@ xml_print_data(struct ly_out *out, const struct lyd_node *root, uint32_t options
     pctx.options = options;
     pctx.ctx = LYD_CTX(root);
 
+    if (options & LYD_PRINT_PARALLEL) {
+        /* print into the memory stream of a parallel print */
+        LY_CHECK_GOTO(rc = lypr_parallel_new(pctx.ctx, out, &pctx.par), finish);
+        pctx.out = pctx.par->out;
+    }
+
     /* content */
     LY_LIST_FOR(root, node) {
-        LY_CHECK_RET(xml_print_node(&pctx, node));
+        pctx.root = node;
+        if (pctx.par && (options & LYD_PRINT_WITHSIBLINGS)) {
+            /* print all the instances by a separate task */
+            for (last = node, count = 1; last->next && (last->next->schema == node->schema); last = last->next) {
+                ++count;
+            }
+            LY_CHECK_GOTO(rc = xml_print_task_start(&pctx, node, count, 1), finish);
+            node = last;
+            continue;
+        }
+
+        LY_CHECK_GOTO(rc = xml_print_node(&pctx, node), finish);
         if (!(options & LYD_PRINT_WITHSIBLINGS)) {
             break;
         }
     }
 
+    if (pctx.par) {
+        /* wait for the tasks and write the rest of the output */
+        rc = lypr_parallel_finish(pctx.par, out);
+        pctx.par = NULL;
+    }
+
 finish:
+    if (pctx.par) {
+        lypr_parallel_finish(pctx.par, NULL);
+    }
     assert(!pctx.prefix.count && !pctx.ns.count);
     ly_set_erase(&pctx.prefix, NULL);
     ly_set_erase(&pctx.ns, NULL);
+    ly_set_erase(&pctx.term_ns, NULL);
     ly_print_flush(out);
-    return LY_SUCCESS;
+    return rc;
 }
@@ -737,18 +737,18 @@ yprc_range(struct lys_ypr_ctx *pctx, const struct lysc_range *range, LY_DATA_TYP
         if (u > 0) {
             ly_print_(pctx->out, " | ");
         }
-        if (range->parts[u].max_64 == range->parts[u].min_64) {
+        if (range->parts[u].max_64 != range->parts[u].min_64) {
             if (basetype <= LY_TYPE_STRING) { /* unsigned values */
-                ly_print_(pctx->out, "%" PRIu64, range->parts[u].max_u64);
+                ly_print_uint(pctx->out, range->parts[u].min_u64);
             } else { /* signed values */
-                ly_print_(pctx->out, "%" PRId64, range->parts[u].max_64);
-            }
-        } else {
-            if (basetype <= LY_TYPE_STRING) { /* unsigned values */
-                ly_print_(pctx->out, "%" PRIu64 "..%" PRIu64, range->parts[u].min_u64, range->parts[u].max_u64);
-            } else { /* signed values */
-                ly_print_(pctx->out, "%" PRId64 "..%" PRId64, range->parts[u].min_64, range->parts[u].max_64);
+                ly_print_int(pctx->out, range->parts[u].min_64);
             }
+            ly_print_lit(pctx->out, "..");
+        }
+        if (basetype <= LY_TYPE_STRING) { /* unsigned values */
+            ly_print_uint(pctx->out, range->parts[u].max_u64);
+        } else { /* signed values */
+            ly_print_int(pctx->out, range->parts[u].max_64);
         }
     }
     ly_print_(pctx->out, "\"");
@@ -371,6 +371,7 @@ lys_compile_identity_bases(struct lysc_ctx *ctx, const struct lysp_module *base_
                     /* we have match! store the backlink */
                     LY_ARRAY_NEW_RET(ctx->ctx, mod->identities[v].derived, idref, LY_EMEM);
                     *idref = ident;
+                    lys_ident_closure_free(ctx->ctx);
                 } else {
                     /* we have match! store the found identity */
                     LY_ARRAY_NEW_RET(ctx->ctx, *bases, idref, LY_EMEM);
@@ -76,6 +76,9 @@ lyd_parse_get_format(const struct ly_in *in, LYD_FORMAT format)
         } else if ((len >= LY_LYB_SUFFIX_LEN + 1) &&
                 !strncmp(&path[len - LY_LYB_SUFFIX_LEN], LY_LYB_SUFFIX, LY_LYB_SUFFIX_LEN)) {
             format = LYD_LYB;
+        } else if ((len >= LY_CBOR_SUFFIX_LEN + 1) &&
+                !strncmp(&path[len - LY_CBOR_SUFFIX_LEN], LY_CBOR_SUFFIX, LY_CBOR_SUFFIX_LEN)) {
+            format = LYD_CBOR;
         } /* else still unknown */
     }
 
@@ -136,6 +139,10 @@ lyd_parse(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, struct
         r = lyd_parse_lyb(ctx, ext, parent, first_p, in, parse_opts, val_opts, int_opts, &parsed,
                 &subtree_sibling, &lydctx);
         break;
+    case LYD_CBOR:
+        r = lyd_parse_cbor(ctx, ext, parent, first_p, in, parse_opts, val_opts, int_opts, &parsed,
+                &subtree_sibling, &lydctx);
+        break;
     case LYD_UNKNOWN:
         LOGARG(ctx, format);
         r = LY_EINVAL;
@@ -402,6 +409,9 @@ lyd_parse_op_(const struct ly_ctx *ctx, const struct lysc_ext_instance *ext, str
     case LYD_LYB:
         rc = lyd_parse_lyb(ctx, ext, parent, &first, in, parse_opts, val_opts, int_opts, &parsed, NULL, &lydctx);
         break;
+    case LYD_CBOR:
+        rc = lyd_parse_cbor(ctx, ext, parent, &first, in, parse_opts, val_opts, int_opts, &parsed, NULL, &lydctx);
+        break;
     case LYD_UNKNOWN:
         LOGARG(ctx, format);
         rc = LY_EINVAL;
@@ -755,6 +765,10 @@ lyd_insert_node(struct lyd_node *parent, struct lyd_node **first_sibling_p, stru
     if (!parent && first_sibling_p && (*first_sibling_p)) {
         parent = lyd_parent(*first_sibling_p);
     }
+    if (parent && (parent->flags & LYD_LYB_STUB)) {
+        /* the children must be complete, errors are logged */
+        lyd_lyb_stub_load(parent);
+    }
     first_sibling = parent ? lyd_child(parent) : *first_sibling_p;
 
     if ((order == LYD_INSERT_NODE_LAST) || !node->schema || (first_sibling && (first_sibling->flags & LYD_EXT))) {
@@ -812,6 +826,8 @@ lyd_unlink_check(struct lyd_node *node)
         return LY_SUCCESS;
     }
 
+    LY_CHECK_RET(lyd_frozen_check(node));
+
     if (lysc_is_key(node->schema) && node->parent) {
         LOGERR(LYD_CTX(node), LY_EINVAL, "Cannot unlink a list key \"%s\", unlink the list instance instead.",
                 LYD_NAME(node));
@@ -1042,6 +1058,7 @@ lyd_insert_child(struct lyd_node *parent, struct lyd_node *node)
     LY_CHECK_CTX_EQUAL_RET(__func__, LYD_CTX(parent), LYD_CTX(node), LY_EINVAL);
 
     LY_CHECK_RET(lyd_insert_check_schema(parent->schema, NULL, node->schema));
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (node->parent || node->prev->next || !node->next) {
         LY_CHECK_RET(lyd_unlink_tree(node));
@@ -1084,6 +1101,7 @@ lyd_insert_sibling(struct lyd_node *sibling, struct lyd_node *node, struct lyd_n
 
     if (sibling) {
         LY_CHECK_RET(lyd_insert_check_schema(NULL, sibling->schema, node->schema));
+        LY_CHECK_RET(lyd_frozen_check(sibling));
     }
 
     first_sibling = lyd_first_sibling(sibling);
@@ -1108,6 +1126,8 @@ lyd_insert_before(struct lyd_node *sibling, struct lyd_node *node)
     LY_CHECK_CTX_EQUAL_RET(__func__, LYD_CTX(sibling), LYD_CTX(node), LY_EINVAL);
 
     LY_CHECK_RET(lyd_insert_check_schema(NULL, sibling->schema, node->schema));
+    LY_CHECK_RET(lyd_frozen_check(sibling));
+    LY_CHECK_RET(lyd_unlink_check(node));
 
     if (node->schema && (!(node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(node->schema->flags & LYS_ORDBY_USER))) {
         LOGERR(LYD_CTX(sibling), LY_EINVAL, "Can be used only for user-ordered nodes.");
@@ -1132,6 +1152,8 @@ lyd_insert_after(struct lyd_node *sibling, struct lyd_node *node)
     LY_CHECK_CTX_EQUAL_RET(__func__, LYD_CTX(sibling), LYD_CTX(node), LY_EINVAL);
 
     LY_CHECK_RET(lyd_insert_check_schema(NULL, sibling->schema, node->schema));
+    LY_CHECK_RET(lyd_frozen_check(sibling));
+    LY_CHECK_RET(lyd_unlink_check(node));
 
     if (node->schema && (!(node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(node->schema->flags & LYS_ORDBY_USER))) {
         LOGERR(LYD_CTX(sibling), LY_EINVAL, "Can be used only for user-ordered nodes.");
@@ -1154,6 +1176,12 @@ lyd_unlink_ignore_lyds(struct lyd_node **first_sibling_p, struct lyd_node *node)
 {
     struct lyd_node *first_sibling;
 
+    if ((node->flags & LYD_DFLT_VIRTUAL) && node->schema && (node->schema->nodetype & LYD_NODE_TERM)) {
+        /* virtual default leaf, only detach it from its parent */
+        lyd_dflt_virtual_unlink(node);
+        return;
+    }
+
     /* update hashes while still linked into the tree */
     lyd_unlink_hash(node);
 
@@ -1217,7 +1245,7 @@ lyd_unlink(struct lyd_node *node)
         if (!node->prev->next || (node->prev->schema != node->schema)) {
             leader = node;
         } else {
-            lyd_find_sibling_val(node, node->schema, NULL, 0, &leader);
+            lyd_find_sibling_val_(node, node->schema, NULL, 0, &leader);
             assert(leader);
         }
         lyds_unlink(&leader, node);
@@ -1234,7 +1262,7 @@ lyd_unlink_siblings(struct lyd_node *node)
 
     if (lyds_is_supported(node) && node->prev->next && (node->prev->schema == node->schema)) {
         /* unlink starts at the non-first item in the (leaf-)list */
-        lyd_find_sibling_val(node, node->schema, NULL, 0, &leader);
+        lyd_find_sibling_val_(node, node->schema, NULL, 0, &leader);
         lyds_split(&first_sibling, leader, node, &start);
     } else {
         /* unlink @p node */
@@ -1692,7 +1720,7 @@ lyd_compare_single_data(const struct lyd_node *node1, const struct lyd_node *nod
         }
 
         if (options & LYD_COMPARE_FULL_RECURSION) {
-            return lyd_compare_siblings_(lyd_child(node1), lyd_child(node2), options, 1);
+            return lyd_compare_siblings_(lyd_child_load(node1), lyd_child_load(node2), options, 1);
         }
         return LY_SUCCESS;
     } else {
@@ -1715,7 +1743,7 @@ lyd_compare_single_data(const struct lyd_node *node1, const struct lyd_node *nod
         case LYS_NOTIF:
             /* implicit container is always equal to a container with non-default descendants */
             if (options & LYD_COMPARE_FULL_RECURSION) {
-                return lyd_compare_siblings_(lyd_child(node1), lyd_child(node2), options, 1);
+                return lyd_compare_siblings_(lyd_child_load(node1), lyd_child_load(node2), options, 1);
             }
             return LY_SUCCESS;
         case LYS_LIST:
@@ -1723,7 +1751,7 @@ lyd_compare_single_data(const struct lyd_node *node1, const struct lyd_node *nod
             iter2 = lyd_child(node2);
 
             if (options & LYD_COMPARE_FULL_RECURSION) {
-                return lyd_compare_siblings_(iter1, iter2, options, 1);
+                return lyd_compare_siblings_(lyd_child_load(node1), lyd_child_load(node2), options, 1);
             } else if (node1->schema->flags & LYS_KEYLESS) {
                 /* always equal */
                 return LY_SUCCESS;
@@ -1813,7 +1841,7 @@ lyd_compare_siblings_(const struct lyd_node *node1, const struct lyd_node *node2
                 ((node1->schema->nodetype == LYS_LEAFLIST) && (node1->schema->flags & LYS_CONFIG_W))) &&
                 (node1->schema->flags & LYS_ORDBY_SYSTEM)) {
             /* find a matching instance in case they are ordered differently */
-            r = lyd_find_sibling_first(node2, node1, (struct lyd_node **)&iter2);
+            r = lyd_find_sibling_first_(node2, node1, (struct lyd_node **)&iter2);
             if (r == LY_ENOTFOUND) {
                 /* no matching instance, data not equal */
                 r = LY_ENOT;
@@ -2192,8 +2220,13 @@ lyd_dup_r(const struct lyd_node *node, const struct ly_ctx *trg_ctx, struct lyd_
     if (options & LYD_DUP_WITH_FLAGS) {
         dup->flags = node->flags;
     } else {
-        dup->flags = (node->flags & (LYD_DEFAULT | LYD_EXT)) | LYD_NEW;
+        dup->flags = (node->flags & (LYD_DEFAULT | LYD_EXT | LYD_DFLT_VIRTUAL)) | LYD_NEW;
+    }
+    if (node->schema && (node->schema->nodetype & LYD_NODE_TERM)) {
+        /* a duplicate of a virtual default leaf is a regular default node */
+        dup->flags &= ~LYD_DFLT_VIRTUAL;
     }
+    dup->flags &= ~(LYD_FROZEN | LYD_LYB_STUB);
     if (options & LYD_DUP_WITH_PRIV) {
         dup->priv = node->priv;
     }
@@ -2211,6 +2244,7 @@ lyd_dup_r(const struct lyd_node *node, const struct ly_ctx *trg_ctx, struct lyd_
         }
     }
     dup->prev = dup;
+    lyd_inst_index_add(dup);
 
     /* duplicate metadata/attributes */
     if (!(options & LYD_DUP_NO_META)) {
@@ -2268,6 +2302,9 @@ lyd_dup_r(const struct lyd_node *node, const struct ly_ctx *trg_ctx, struct lyd_
         struct lyd_node *child;
 
         if (options & LYD_DUP_RECURSIVE) {
+            /* all the children are needed */
+            LY_CHECK_GOTO(rc = lyd_lyb_stub_load(node), cleanup);
+
             /* create a hash table with the size of the previous hash table (duplicate) */
             if (orig->children_ht) {
                 ((struct lyd_node_inner *)dup)->children_ht = lyht_new(orig->children_ht->size,
@@ -2621,10 +2658,10 @@ lyd_merge_sibling_r(struct lyd_node **first_trg, struct lyd_node *parent_trg,
         r = lyd_find_sibling_opaq_next(*first_trg, LYD_NAME(sibling_src), &match_trg);
     } else if (sibling_src->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
         /* try to find the exact instance */
-        r = lyd_find_sibling_first(*first_trg, sibling_src, &match_trg);
+        r = lyd_find_sibling_first_(*first_trg, sibling_src, &match_trg);
     } else {
         /* try to simply find the node, there cannot be more instances */
-        r = lyd_find_sibling_val(*first_trg, sibling_src->schema, NULL, 0, &match_trg);
+        r = lyd_find_sibling_val_(*first_trg, sibling_src->schema, NULL, 0, &match_trg);
     }
     LY_CHECK_RET(r && (r != LY_ENOTFOUND), r);
 
@@ -2717,7 +2754,7 @@ lyd_merge_sibling_r(struct lyd_node **first_trg, struct lyd_node *parent_trg,
             }
         }
 
-        if (lyds->rbn) {
+        if (lyds->tree) {
             /* insert node and try to reuse free lyds data */
             lyds_insert2(parent_trg, first_trg, leader_p, dup_src, lyds);
         } else {
@@ -2759,12 +2796,17 @@ lyd_merge(struct lyd_node **target, const struct lyd_node *source, const struct
         /* nothing to merge */
         return LY_SUCCESS;
     }
+    LY_CHECK_RET(lyd_frozen_check(*target));
 
     if ((*target && lysc_data_parent((*target)->schema)) || lysc_data_parent(source->schema)) {
         LOGERR(LYD_CTX(source), LY_EINVAL, "Invalid arguments - can merge only 2 top-level subtrees (%s()).", __func__);
         return LY_EINVAL;
     }
 
+    /* lazily parsed LYB subtrees are merged as well */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(*target));
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(source));
+
     leader = NULL;
     schema = NULL;
     LY_LIST_FOR_SAFE(source, tmp, sibling_src) {
@@ -3144,8 +3186,8 @@ lyd_find_meta(const struct lyd_meta *first, const struct lys_module *module, con
     return ret;
 }
 
-LIBYANG_API_DEF LY_ERR
-lyd_find_sibling_first(const struct lyd_node *siblings, const struct lyd_node *target, struct lyd_node **match)
+LY_ERR
+lyd_find_sibling_first_(const struct lyd_node *siblings, const struct lyd_node *target, struct lyd_node **match)
 {
     struct lyd_node **match_p, *iter, *dup = NULL;
     struct lyd_node_inner *parent;
@@ -3234,8 +3276,8 @@ lyd_find_sibling_first(const struct lyd_node *siblings, const struct lyd_node *t
     return LY_SUCCESS;
 }
 
-LIBYANG_API_DEF LY_ERR
-lyd_find_sibling_val(const struct lyd_node *siblings, const struct lysc_node *schema, const char *key_or_value,
+LY_ERR
+lyd_find_sibling_val_(const struct lyd_node *siblings, const struct lysc_node *schema, const char *key_or_value,
         size_t val_len, struct lyd_node **match)
 {
     LY_ERR rc;
@@ -3287,7 +3329,7 @@ lyd_find_sibling_val(const struct lyd_node *siblings, const struct lysc_node *sc
         }
 
         /* find it */
-        rc = lyd_find_sibling_first(siblings, target, match);
+        rc = lyd_find_sibling_first_(siblings, target, match);
     } else {
         /* find the first schema node instance */
         rc = lyd_find_sibling_schema(siblings, schema, match);
@@ -3297,6 +3339,68 @@ lyd_find_sibling_val(const struct lyd_node *siblings, const struct lysc_node *sc
     return rc;
 }
 
+/**
+ * @brief Find a virtual default leaf (::LYD_DFLT_VIRTUAL) of the parent of some siblings.
+ *
+ * @param[in] siblings Siblings without a real instance of @p schema.
+ * @param[in] schema Schema node of the leaf.
+ * @param[in] target Optional leaf whose value must match.
+ * @param[out] match Can be NULL, otherwise the found virtual leaf.
+ * @return LY_SUCCESS on success, @p match set.
+ * @return LY_ENOTFOUND if not found, @p match set to NULL.
+ * @return LY_ERR value if another error occurred.
+ */
+static LY_ERR
+lyd_find_sibling_virtual(const struct lyd_node *siblings, const struct lysc_node *schema,
+        const struct lyd_node *target, struct lyd_node **match)
+{
+    struct lyd_node *vnode = NULL;
+    LY_ERR rc = LY_ENOTFOUND;
+
+    if (siblings && schema && (schema->nodetype == LYS_LEAF)) {
+        rc = lyd_dflt_virtual_get(lyd_parent(siblings), schema, &vnode);
+        if (!rc && target && lyd_compare_single(target, vnode, 0)) {
+            /* different value */
+            vnode = NULL;
+            rc = LY_ENOTFOUND;
+        }
+    }
+
+    if (match) {
+        *match = vnode;
+    }
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_find_sibling_first(const struct lyd_node *siblings, const struct lyd_node *target, struct lyd_node **match)
+{
+    LY_ERR rc;
+
+    rc = lyd_find_sibling_first_(siblings, target, match);
+    if ((rc == LY_ENOTFOUND) && (!siblings || (LYD_CTX(siblings) == LYD_CTX(target)))) {
+        /* may be a virtual default leaf */
+        rc = lyd_find_sibling_virtual(siblings, target->schema, target, match);
+    }
+
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_find_sibling_val(const struct lyd_node *siblings, const struct lysc_node *schema, const char *key_or_value,
+        size_t val_len, struct lyd_node **match)
+{
+    LY_ERR rc;
+
+    rc = lyd_find_sibling_val_(siblings, schema, key_or_value, val_len, match);
+    if (rc == LY_ENOTFOUND) {
+        /* may be a virtual default leaf */
+        rc = lyd_find_sibling_virtual(siblings, schema, NULL, match);
+    }
+
+    return rc;
+}
+
 LIBYANG_API_DEF LY_ERR
 lyd_find_sibling_dup_inst_set(const struct lyd_node *siblings, const struct lyd_node *target, struct ly_set **set)
 {
@@ -3326,7 +3430,7 @@ lyd_find_sibling_dup_inst_set(const struct lyd_node *siblings, const struct lyd_
         assert(target->hash);
 
         /* find the first instance */
-        lyd_find_sibling_first(siblings, target, &first);
+        lyd_find_sibling_first_(siblings, target, &first);
         if (first) {
             /* add it so that it is the first in the set */
             if (ly_set_add(*set, first, 1, NULL)) {
@@ -3437,6 +3541,79 @@ lyd_find_xpath3(const struct lyd_node *ctx_node, const struct lyd_node *tree, co
     return lyd_eval_xpath4(ctx_node, tree, NULL, xpath, format, prefix_data, vars, NULL, set, NULL, NULL, NULL);
 }
 
+/**
+ * @brief XPath search iterator.
+ */
+struct lyd_xpath_iter {
+    struct lyxp_iter *xp_iter;  /**< lazy XPath evaluation, if supported */
+    struct ly_set *set;         /**< fully evaluated result, otherwise */
+    uint32_t idx;               /**< index of the next node in lyd_xpath_iter.set */
+};
+
+LIBYANG_API_DEF LY_ERR
+lyd_find_xpath_iter(const struct lyd_node *ctx_node, const struct lyd_node *tree, const char *xpath,
+        LY_VALUE_FORMAT format, void *prefix_data, const struct lyxp_var *vars, struct lyd_xpath_iter **iter)
+{
+    LY_ERR rc;
+    struct lyxp_expr *exp = NULL;
+
+    LY_CHECK_ARG_RET(NULL, tree, xpath, iter, LY_EINVAL);
+
+    *iter = calloc(1, sizeof **iter);
+    LY_CHECK_ERR_RET(!*iter, LOGMEM(LYD_CTX(tree)), LY_EMEM);
+
+    /* parse expression */
+    rc = lyxp_expr_parse((struct ly_ctx *)LYD_CTX(tree), xpath, 0, 1, &exp);
+    LY_CHECK_GOTO(rc, cleanup);
+
+    /* try to evaluate it lazily */
+    rc = lyxp_iter_new(LYD_CTX(tree), exp, NULL, format, prefix_data, ctx_node, tree, vars, LYXP_IGNORE_WHEN,
+            &(*iter)->xp_iter);
+    if (rc == LY_ENOT) {
+        /* evaluate it all */
+        rc = lyd_eval_xpath4(ctx_node, tree, NULL, xpath, format, prefix_data, vars, NULL, &(*iter)->set, NULL, NULL,
+                NULL);
+    }
+
+cleanup:
+    lyxp_expr_free((struct ly_ctx *)LYD_CTX(tree), exp);
+    if (rc) {
+        lyd_find_xpath_iter_free(*iter);
+        *iter = NULL;
+    }
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_find_xpath_next(struct lyd_xpath_iter *iter, struct lyd_node **node)
+{
+    LY_CHECK_ARG_RET(NULL, iter, node, LY_EINVAL);
+
+    *node = NULL;
+
+    if (iter->xp_iter) {
+        return lyxp_iter_next(iter->xp_iter, (const struct lyd_node **)node);
+    }
+
+    if (iter->idx == iter->set->count) {
+        return LY_ENOTFOUND;
+    }
+    *node = iter->set->dnodes[iter->idx++];
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF void
+lyd_find_xpath_iter_free(struct lyd_xpath_iter *iter)
+{
+    if (!iter) {
+        return;
+    }
+
+    lyxp_iter_free(iter->xp_iter);
+    ly_set_free(iter->set, NULL);
+    free(iter);
+}
+
 LIBYANG_API_DEF LY_ERR
 lyd_eval_xpath(const struct lyd_node *ctx_node, const char *xpath, ly_bool *result)
 {
@@ -3456,6 +3633,44 @@ lyd_eval_xpath3(const struct lyd_node *ctx_node, const struct lys_module *cur_mo
     return lyd_eval_xpath4(ctx_node, ctx_node, cur_mod, xpath, format, prefix_data, vars, NULL, NULL, NULL, NULL, result);
 }
 
+/**
+ * @brief Evaluate a simple path on data lazily, only until the first matching node is found.
+ *
+ * @param[in] ctx_node XPath context node, NULL for the root node.
+ * @param[in] tree Data tree to evaluate on.
+ * @param[in] cur_mod Current module of @p exp.
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] format Format of any prefixes in @p exp.
+ * @param[in] prefix_data Format-specific prefix data.
+ * @param[in] vars Optional [sized array](@ref sizedarrays) of XPath variables.
+ * @param[out] exists Whether any node matches.
+ * @return LY_ENOT if @p exp is not a simple path;
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_eval_xpath_exists(const struct lyd_node *ctx_node, const struct lyd_node *tree, const struct lys_module *cur_mod,
+        const struct lyxp_expr *exp, LY_VALUE_FORMAT format, void *prefix_data, const struct lyxp_var *vars,
+        ly_bool *exists)
+{
+    LY_ERR rc;
+    struct lyxp_iter *iter;
+    const struct lyd_node *node;
+
+    LY_CHECK_RET(lyxp_iter_new(LYD_CTX(tree), exp, cur_mod, format, prefix_data, ctx_node, tree, vars,
+            LYXP_IGNORE_WHEN, &iter));
+
+    rc = lyxp_iter_next(iter, &node);
+    if (!rc) {
+        *exists = 1;
+    } else if (rc == LY_ENOTFOUND) {
+        *exists = 0;
+        rc = LY_SUCCESS;
+    }
+
+    lyxp_iter_free(iter);
+    return rc;
+}
+
 LIBYANG_API_DEF LY_ERR
 lyd_eval_xpath4(const struct lyd_node *ctx_node, const struct lyd_node *tree, const struct lys_module *cur_mod,
         const char *xpath, LY_VALUE_FORMAT format, void *prefix_data, const struct lyxp_var *vars, LY_XPATH_TYPE *ret_type,
@@ -3474,6 +3689,14 @@ lyd_eval_xpath4(const struct lyd_node *ctx_node, const struct lyd_node *tree, co
     ret = lyxp_expr_parse((struct ly_ctx *)LYD_CTX(tree), xpath, 0, 1, &exp);
     LY_CHECK_GOTO(ret, cleanup);
 
+    if (boolean && !node_set && !string && !number) {
+        /* only learning whether there is any matching node is enough for simple paths */
+        ret = lyd_eval_xpath_exists(ctx_node, tree, cur_mod, exp, format, prefix_data, vars, boolean);
+        if (ret != LY_ENOT) {
+            goto cleanup;
+        }
+    }
+
     /* evaluate expression */
     ret = lyxp_eval(LYD_CTX(tree), exp, cur_mod, format, prefix_data, ctx_node, ctx_node, tree, vars, &xp_set,
             LYXP_IGNORE_WHEN);
@@ -3692,6 +3915,8 @@ lyd_find_path(const struct lyd_node *ctx_node, const char *path, ly_bool output,
     LY_ERR ret = LY_SUCCESS;
     struct lyxp_expr *expr = NULL;
     struct ly_path *lypath = NULL;
+    struct lyd_node *node, *vnode;
+    LY_ARRAY_COUNT_TYPE path_idx;
 
     LY_CHECK_ARG_RET(NULL, ctx_node, ctx_node->schema, path, LY_EINVAL);
 
@@ -3706,7 +3931,17 @@ lyd_find_path(const struct lyd_node *ctx_node, const char *path, ly_bool output,
     LY_CHECK_GOTO(ret, cleanup);
 
     /* evaluate the path */
-    ret = ly_path_eval_partial(lypath, ctx_node, NULL, 0, NULL, match);
+    ret = ly_path_eval_partial(lypath, ctx_node, NULL, 0, &path_idx, &node);
+    if ((ret == LY_EINCOMPLETE) && (path_idx + 2 == LY_ARRAY_COUNT(lypath))) {
+        /* only the last leaf is missing, it may be a virtual default */
+        if (!lyd_dflt_virtual_get(node, lypath[path_idx + 1].node, &vnode)) {
+            node = vnode;
+            ret = LY_SUCCESS;
+        }
+    }
+    if (match) {
+        *match = node;
+    }
 
 cleanup:
     lyxp_expr_free(LYD_CTX(ctx_node), expr);
@@ -40,9 +40,9 @@ struct ly_set;
 struct lyd_node;
 struct lyd_node_opaq;
 struct lyd_node_term;
+struct lyd_xpath_iter;
 struct timespec;
 struct lyxp_var;
-struct rb_node;
 
 /**
  * @page howtoData Data Instances
@@ -91,6 +91,7 @@ struct rb_node;
  * - @subpage howtoDataManipulation
  * - @subpage howtoDataPrinters
  * - @subpage howtoDataLYB
+ * - @subpage howtoDataCBOR
  *
  * \note API for this group of functions is described in the [Data Instances module](@ref datatree).
  *
@@ -407,6 +408,22 @@ struct rb_node;
  * @section howtoDataLYBTypes Format of specific data type values
  */
 
+/**
+ * @page howtoDataCBOR YANG-CBOR Format
+ *
+ * YANG-CBOR is the standard binary encoding of YANG data defined in RFC 9254, a compact alternative to JSON. Members
+ * of the data node maps are identified either by their names, the same as in JSON, or by YANG Schema Item
+ * iDentifiers (SIDs). SIDs are assigned to schema nodes and identities in SID files (RFC 9595), which are loaded into
+ * a context using ::ly_ctx_load_sid_file(). The printer uses SIDs for all the nodes that have one and names for
+ * the rest, the parser accepts both.
+ *
+ * Values are encoded natively according to their type, for example integers as CBOR integers, decimal64 as decimal
+ * fractions, bits as bitmaps, and identityrefs as SIDs. Metadata and opaque nodes are not supported.
+ *
+ * Being binary, YANG-CBOR data in memory should be parsed from an input created by ::ly_in_new_memory_len() so that
+ * the encoded lengths are checked against the real length of the data.
+ */
+
 /**
  * @ingroup trees
  * @defgroup datatree Data Tree
@@ -540,7 +557,8 @@ typedef enum {
     LYD_UNKNOWN = 0,     /**< unknown data format, invalid value */
     LYD_XML,             /**< XML instance data format */
     LYD_JSON,            /**< JSON instance data format */
-    LYD_LYB              /**< LYB instance data format */
+    LYD_LYB,             /**< LYB instance data format */
+    LYD_CBOR             /**< YANG-CBOR instance data format (RFC 9254), see ::ly_ctx_load_sid_file() */
 } LYD_FORMAT;
 
 /**
@@ -720,7 +738,7 @@ struct lyd_value_xpath10 {
  * @brief Special lyd_value structure for lyds tree value.
  */
 struct lyd_value_lyds_tree {
-    struct rb_node *rbt;        /**< Root of the Red-black tree. */
+    void *rbt;                  /**< Opaque index of the sorted (leaf-)list instances. */
 };
 
 /**
@@ -778,6 +796,12 @@ struct lyd_attr {
  *       3 LYD_NEW          |x|x|x|x|x|x|x|
  *                          +-+-+-+-+-+-+-+
  *       4 LYD_EXT          |x|x|x|x|x|x|x|
+ *                          +-+-+-+-+-+-+-+
+ *       5 LYD_DFLT_VIRTUAL |x|x|x| | | | |
+ *                          +-+-+-+-+-+-+-+
+ *       6 LYD_FROZEN       |x|x|x|x|x|x|x|
+ *                          +-+-+-+-+-+-+-+
+ *       7 LYD_LYB_STUB     |x|x| | | | | |
  *     ---------------------+-+-+-+-+-+-+-+
  *
  */
@@ -786,6 +810,17 @@ struct lyd_attr {
 #define LYD_WHEN_TRUE   0x02        /**< all when conditions of this node were evaluated to true */
 #define LYD_NEW         0x04        /**< node was created after the last validation, is needed for the next validation */
 #define LYD_EXT         0x08        /**< node is the first sibling parsed as extension instance data */
+#define LYD_DFLT_VIRTUAL 0x10       /**< inner node whose missing default leaves are virtually present, see
+                                         ::LYD_IMPLICIT_VIRTUAL_DFLT; the virtual leaves are created only when looked up and
+                                         carry this flag too, they are not linked to the children of their parent but
+                                         changing their value links them as regular default nodes; once a real instance
+                                         replaces a virtual leaf, the virtual leaf is no longer found but remains valid
+                                         until its parent is freed */
+#define LYD_FROZEN      0x20        /**< node is a part of a read-only tree created by ::lyd_freeze() */
+#define LYD_LYB_STUB    0x40        /**< inner node parsed with ::LYD_PARSE_LYB_LAZY whose (non-key) children were not
+                                         parsed yet; they are parsed when needed by path and XPath evaluation, the printers,
+                                         ::lyd_child_no_keys() and other functions working with the whole tree, or
+                                         explicitly by ::lyd_lyb_materialize() */
 
 /** @} */
 
@@ -1136,6 +1171,17 @@ LIBYANG_API_DECL struct lyd_node *lyd_first_sibling(const struct lyd_node *node)
  */
 LIBYANG_API_DECL int lyd_lyb_data_length(const char *data);
 
+/**
+ * @brief Parse the children of nodes parsed lazily from LYB data, see ::LYD_PARSE_LYB_LAZY.
+ *
+ * The LYB data the nodes were parsed from must still be available.
+ *
+ * @param[in] node Node whose children to parse, nothing is done if it is not a ::LYD_LYB_STUB node.
+ * @param[in] recursive Whether to parse all the descendants of @p node, so that no stubs remain in its subtree.
+ * @return LY_ERR value.
+ */
+LIBYANG_API_DECL LY_ERR lyd_lyb_materialize(struct lyd_node *node, ly_bool recursive);
+
 /**
  * @brief Check node parsed into an opaque node for the reason (error) why it could not be parsed as data node.
  *
@@ -1639,6 +1685,12 @@ LIBYANG_API_DECL LY_ERR lyd_new_ext_path(struct lyd_node *parent, const struct l
 #define LYD_IMPLICIT_OUTPUT      0x04   /**< For RPC/action nodes, add output implicit nodes instead of input. */
 #define LYD_IMPLICIT_NO_DEFAULTS 0x08   /**< Do not add any default nodes (leaves/leaf-lists), only non-presence
                                              containers. */
+#define LYD_IMPLICIT_VIRTUAL_DFLT 0x10  /**< Do not add default configuration leaves that are direct children of their
+                                             parent, have no when, and whose type does not reference the data tree
+                                             (leafref, instance-identifier, union), mark the parent with
+                                             ::LYD_DFLT_VIRTUAL instead. Such leaves are then virtually present for
+                                             the readers of the data.
+                                             Ignored if a diff of the created nodes is generated. */
 
 /** @} implicitoptions */
 
@@ -2042,6 +2094,142 @@ LIBYANG_API_DECL LY_ERR lyd_dup_siblings(const struct lyd_node *node, struct lyd
 LIBYANG_API_DECL LY_ERR lyd_dup_siblings_to_ctx(const struct lyd_node *node, const struct ly_ctx *trg_ctx,
         struct lyd_node_inner *parent, uint32_t options, struct lyd_node **dup);
 
+/**
+ * @brief Create a compact read-only copy of a data tree.
+ *
+ * All the nodes, metadata, attributes, and children hash tables of the copy are allocated in a single memory block,
+ * in the depth-first order, and marked with ::LYD_FROZEN. The nodes keep their standard structures because they are
+ * read directly by all the functions and applications, so only the per-allocation overhead, the spare space of hash
+ * tables, and the internal metadata of sorted instances are saved. The values stored by the type plugins in separate
+ * allocations and the values of any nodes are still allocated separately. For a tree of lists with a few short values
+ * it is about 10 % less memory than a regular copy. For a more compact layout without pointers that can be used only
+ * by the image functions, see ::lyd_image_create(). All the functions only reading data trees can be used
+ * on the frozen tree, for example ::lyd_find_path(), ::lyd_find_xpath(), or ::lyd_print_mem(). Inserting,
+ * unlinking, or changing frozen nodes and validating frozen trees fails. The frozen tree can be freed only as a whole
+ * by ::lyd_free_all() or ::lyd_free_siblings() on a top-level node.
+ *
+ * @param[in] tree Any sibling of the data tree to freeze, all its siblings are frozen.
+ * @param[out] frozen First top-level sibling of the frozen tree.
+ * @return LY_ERR value.
+ */
+LIBYANG_API_DECL LY_ERR lyd_freeze(const struct lyd_node *tree, struct lyd_node **frozen);
+
+/**
+ * @brief Create a regular modifiable copy of a frozen data tree, see ::lyd_freeze().
+ *
+ * The frozen nodes share a single memory block and cannot be freed or changed individually, so the modifiable tree
+ * is always a new copy and the frozen tree is kept. The validation state of the nodes is preserved.
+ *
+ * @param[in] frozen Any node of the frozen data tree, all its top-level siblings are copied.
+ * @param[out] tree First top-level sibling of the copy.
+ * @return LY_ERR value.
+ */
+LIBYANG_API_DECL LY_ERR lyd_thaw(const struct lyd_node *frozen, struct lyd_node **tree);
+
+/**
+ * @brief Data node of a data tree image, see ::lyd_image_create().
+ */
+struct lyd_image_node;
+
+/**
+ * @brief Create a relocatable image of a data tree.
+ *
+ * The image is a single memory block without any pointers, all the nodes and their values are referenced by offsets
+ * within the image. So, it can be copied anywhere, for example into a shared memory or a file, and read directly by
+ * any process using a context with the same modules, see ::lyd_image_first() and ::lyd_image_find_path(). The image
+ * is read-only and includes the nodes with their canonical values, the virtual default leaves are stored as regular
+ * nodes. Metadata are not included, opaque and extension data nodes are not supported. The image must be placed
+ * in a memory aligned to 8 bytes.
+ *
+ * @param[in] tree Any top-level sibling of the data tree, all the siblings are stored.
+ * @param[out] image Created image, free it with free().
+ * @param[out] size Size of @p image.
+ * @return LY_ERR value.
+ */
+LIBYANG_API_DECL LY_ERR lyd_image_create(const struct lyd_node *tree, void **image, size_t *size);
+
+/**
+ * @brief Get the first top-level node of a data tree image.
+ *
+ * @param[in] ctx Context with the same modules as the context of the image data tree.
+ * @param[in] image Data tree image.
+ * @param[out] first First top-level node of @p image.
+ * @return LY_SUCCESS on success;
+ * @return LY_EINVAL if @p image is not valid or was created with a different context.
+ */
+LIBYANG_API_DECL LY_ERR lyd_image_first(const struct ly_ctx *ctx, const void *image, const struct lyd_image_node **first);
+
+/**
+ * @brief Get the next sibling of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return Next sibling, NULL if there is none.
+ */
+LIBYANG_API_DECL const struct lyd_image_node *lyd_image_next(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the first child of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return First child, NULL if there is none.
+ */
+LIBYANG_API_DECL const struct lyd_image_node *lyd_image_child(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the parent of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return Parent node, NULL for top-level nodes.
+ */
+LIBYANG_API_DECL const struct lyd_image_node *lyd_image_parent(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the schema node name of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return Schema node name.
+ */
+LIBYANG_API_DECL const char *lyd_image_name(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the module name of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return Module name.
+ */
+LIBYANG_API_DECL const char *lyd_image_module(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the value of a data tree image node.
+ *
+ * @param[in] node Image node.
+ * @return Canonical value of terms, JSON value of any nodes, NULL for other nodes.
+ */
+LIBYANG_API_DECL const char *lyd_image_value(const struct lyd_image_node *node);
+
+/**
+ * @brief Get the schema node of a data tree image node.
+ *
+ * @param[in] ctx Context with the same modules as the context of the image data tree.
+ * @param[in] node Image node.
+ * @return Schema node, NULL if not found.
+ */
+LIBYANG_API_DECL const struct lysc_node *lyd_image_schema(const struct ly_ctx *ctx, const struct lyd_image_node *node);
+
+/**
+ * @brief Search a data tree image for a node using a path, similarly to ::lyd_find_path().
+ *
+ * @param[in] ctx Context with the same modules as the context of the image data tree.
+ * @param[in] image Data tree image.
+ * @param[in] path Absolute data path of the node with all the list instances identified by their keys or positions.
+ * @param[out] match Optional found node.
+ * @return LY_SUCCESS if the node was found;
+ * @return LY_ENOTFOUND if the node was not found;
+ * @return LY_ERR on other errors.
+ */
+LIBYANG_API_DECL LY_ERR lyd_image_find_path(const struct ly_ctx *ctx, const void *image, const char *path,
+        const struct lyd_image_node **match);
+
 /**
  * @brief Create a copy of the metadata.
  *
@@ -2166,6 +2354,12 @@ LIBYANG_API_DECL LY_ERR lyd_merge_module(struct lyd_node **target, const struct
 #define LYD_DIFF_META       0x02 /**< All metadata are compared and the full difference reported in the diff always in
                                       the form of 'yang:meta-\<operation\>' metadata. Also, equal nodes with only changes
                                       in their metadata will be present in the diff with the 'none' operation. */
+#define LYD_DIFF_MIN_MOVES  0x04 /**< Only the user-ordered (leaf-)list instances not keeping their relative order are
+                                      moved, based on the longest increasing subsequence of their original positions.
+                                      The diff is then the shortest possible, otherwise the instances are moved
+                                      one-by-one so that the beginning of the final order is always correct. Note that
+                                      merging such a diff using ::lyd_diff_merge_all() with another diff moving
+                                      the same instances may not result in the expected order. */
 
 /** @} diffoptions */
 
@@ -2381,6 +2575,8 @@ LIBYANG_API_DECL struct lyd_meta *lyd_find_meta(const struct lyd_meta *first, co
  * @brief Search in the given siblings (NOT recursively) for the first target instance with the same value.
  * Uses hashes - should be used whenever possible for best performance.
  *
+ * A virtual default leaf (::LYD_DFLT_VIRTUAL) of the parent of @p siblings is found as well.
+ *
  * @param[in] siblings Siblings to search in including preceding and succeeding nodes.
  * @param[in] target Target node to find.
  * @param[out] match Can be NULL, otherwise the found data node.
@@ -2395,6 +2591,8 @@ LIBYANG_API_DECL LY_ERR lyd_find_sibling_first(const struct lyd_node *siblings,
  * @brief Search in the given siblings for the first schema instance.
  * Uses hashes - should be used whenever possible for best performance.
  *
+ * A virtual default leaf (::LYD_DFLT_VIRTUAL) of the parent of @p siblings is found as well.
+ *
  * @param[in] siblings Siblings to search in including preceding and succeeding nodes.
  * @param[in] schema Schema node of the data node to find.
  * @param[in] key_or_value If it is NULL, the first schema node data instance is found. For nodes with many
@@ -2471,6 +2669,8 @@ LIBYANG_API_DECL void lyxp_vars_free(struct lyxp_var *vars);
  * in the form `list[key1=...][key2=...][key3=...]` or a leaf-list instance in the form
  * `leaf-list[.=...]`, these instances are found using hashes with constant (*O(1)*) complexity
  * (unless they are defined in top-level). Other predicates can still follow the aforementioned ones.
+ * Similarly, list instances selected in the form `list[leaf=...]`, where `leaf` was indexed using ::lyd_index_add(),
+ * are found using the index.
  *
  * Opaque nodes are part of the evaluation but only those with a matching schema node.
  *
@@ -2519,10 +2719,82 @@ LIBYANG_API_DECL LY_ERR lyd_find_xpath2(const struct lyd_node *ctx_node, const c
 LIBYANG_API_DECL LY_ERR lyd_find_xpath3(const struct lyd_node *ctx_node, const struct lyd_node *tree, const char *xpath,
         LY_VALUE_FORMAT format, void *prefix_data, const struct lyxp_var *vars, struct ly_set **set);
 
+/**
+ * @brief Search in the given data for instances of nodes matching the provided XPath, one by one.
+ *
+ * Unlike ::lyd_find_xpath3(), the result is not collected into a set. If @p xpath is a simple path consisting only of
+ * child (`/`) and descendant (`//`) steps with node name tests and predicates that are comparisons, logical expressions,
+ * or paths without `position()` and `last()`,
+ * the data are traversed lazily as the nodes are being requested by ::lyd_find_xpath_next(). It is then efficient
+ * to stop the search after the first matching node(s). Any other expression is fully evaluated first.
+ *
+ * The data must not be modified while the iterator is used.
+ *
+ * @param[in] ctx_node XPath context node, NULL for the root node.
+ * @param[in] tree Data tree to evaluate on.
+ * @param[in] xpath [XPath](@ref howtoXPath) to select with prefixes in @p format. It must evaluate into a node set.
+ * @param[in] format Format of any prefixes in @p xpath.
+ * @param[in] prefix_data Format-specific prefix data, must be valid while the iterator is used.
+ * @param[in] vars [Sized array](@ref sizedarrays) of XPath variables, must be valid while the iterator is used.
+ * @param[out] iter Created iterator, free it with ::lyd_find_xpath_iter_free().
+ * @return LY_SUCCESS on success, @p iter is returned.
+ * @return LY_ERR value if an error occurred.
+ */
+LIBYANG_API_DECL LY_ERR lyd_find_xpath_iter(const struct lyd_node *ctx_node, const struct lyd_node *tree, const char *xpath,
+        LY_VALUE_FORMAT format, void *prefix_data, const struct lyxp_var *vars, struct lyd_xpath_iter **iter);
+
+/**
+ * @brief Get the next data node matching the XPath of an iterator, in the document order.
+ *
+ * @param[in] iter Iterator created by ::lyd_find_xpath_iter().
+ * @param[out] node Next found data node.
+ * @return LY_SUCCESS on success, @p node is returned.
+ * @return LY_ENOTFOUND if there are no more matching nodes.
+ * @return LY_ERR value if an error occurred.
+ */
+LIBYANG_API_DECL LY_ERR lyd_find_xpath_next(struct lyd_xpath_iter *iter, struct lyd_node **node);
+
+/**
+ * @brief Free an XPath iterator.
+ *
+ * @param[in] iter Iterator created by ::lyd_find_xpath_iter() to free.
+ */
+LIBYANG_API_DECL void lyd_find_xpath_iter_free(struct lyd_xpath_iter *iter);
+
+/**
+ * @brief Create a secondary index of list instances by the value of one of their (non-key) leaves.
+ *
+ * The index is then used by ::lyd_find_xpath() and other XPath evaluation for predicates in the form
+ * `list[leaf=...]` instead of evaluating the predicate for every list instance. The index is created lazily, for every
+ * parent data node the first time its list instances are searched for, and is then updated whenever a list instance
+ * or its indexed leaf is created, removed, or its value changed. It is defined for all the data trees of the context
+ * until ::lyd_index_remove() is called or the module of the list is recompiled.
+ *
+ * Instances of top-level lists cannot be indexed. Searching concurrently in data trees with an index is safe,
+ * the index records created by the searches are guarded by a context lock (see @ref howtoThreads). Modifying
+ * the data trees still requires a single writer.
+ *
+ * @param[in] leaf Schema leaf of a list to index the list instances by.
+ * @return LY_SUCCESS on success, also if the index already exists.
+ * @return LY_ERR value on error.
+ */
+LIBYANG_API_DECL LY_ERR lyd_index_add(const struct lysc_node *leaf);
+
+/**
+ * @brief Remove a secondary index of list instances created by ::lyd_index_add().
+ *
+ * @param[in] leaf Schema leaf the list instances are indexed by.
+ * @return LY_SUCCESS on success.
+ * @return LY_ENOTFOUND if there is no such index.
+ * @return LY_ERR value on error.
+ */
+LIBYANG_API_DECL LY_ERR lyd_index_remove(const struct lysc_node *leaf);
+
 /**
  * @brief Evaluate an XPath on data and return the result converted to boolean.
  *
- * Optimizations similar as in ::lyd_find_xpath().
+ * Optimizations similar as in ::lyd_find_xpath(). Additionally, simple paths (see ::lyd_find_xpath_iter()) are
+ * evaluated only until the first matching node is found.
  *
  * @param[in] ctx_node XPath context node.
  * @param[in] xpath [XPath](@ref howtoXPath) to select in JSON format.
@@ -2619,7 +2891,8 @@ LIBYANG_API_DEF LY_ERR lyd_trim_xpath(struct lyd_node **tree, const char *xpath,
  * Always works in constant (*O(1)*) complexity. To be exact, it is *O(n)* where *n* is the depth
  * of the path used.
  *
- * Opaque nodes are NEVER found/traversed.
+ * Opaque nodes are NEVER found/traversed. Virtual default leaves (::LYD_DFLT_VIRTUAL) are found, such a leaf
+ * remains valid until its parent is freed even if a real instance replaces it in the meantime.
  *
  * @param[in] ctx_node Path context node.
  * @param[in] path [Path](@ref howtoXPath) to find.
@@ -38,6 +38,7 @@
 #include "tree.h"
 #include "tree_data.h"
 #include "tree_data_internal.h"
+#include "tree_data_sorted.h"
 #include "tree_edit.h"
 #include "tree_schema.h"
 #include "tree_schema_internal.h"
@@ -179,7 +180,7 @@ lys_getnext_data(const struct lyd_node *last, const struct lyd_node *sibling, co
 
     /* find next schema node data instance */
     while ((siter = lys_getnext(siter, parent, module, 0))) {
-        if (!lyd_find_sibling_val(sibling, siter, NULL, 0, &match)) {
+        if (!lyd_find_sibling_val_(sibling, siter, NULL, 0, &match)) {
             break;
         }
     }
@@ -293,6 +294,17 @@ lyd_child_no_keys(const struct lyd_node *node)
     }
 }
 
+struct lyd_node *
+lyd_child_load(const struct lyd_node *node)
+{
+    if (node && (ATOMIC_FLAGS_LOAD_ACQUIRE(node->flags) & LYD_LYB_STUB)) {
+        /* errors are logged */
+        lyd_lyb_stub_load(node);
+    }
+
+    return lyd_child(node);
+}
+
 LIBYANG_API_DEF const struct lys_module *
 lyd_owner_module(const struct lyd_node *node)
 {
@@ -756,6 +768,11 @@ lyd_list_pos(const struct lyd_node *instance)
         return 0;
     }
 
+    /* constant time for parents with many children */
+    if (instance->parent && (pos = lyd_child_vec_list_pos(instance))) {
+        return pos;
+    }
+
     /* data instances are ordered, so we can stop when we found instance of other schema node */
     for (iter = instance; iter->schema == instance->schema; iter = iter->prev) {
         if (pos && (iter->next == NULL)) {
@@ -791,6 +808,108 @@ lyd_first_sibling(const struct lyd_node *node)
     return start;
 }
 
+/**
+ * @brief Learn whether a data node is a virtual default leaf, see ::LYD_DFLT_VIRTUAL.
+ *
+ * @param[in] node Data node.
+ * @return Whether the node is a virtual default leaf.
+ */
+static ly_bool
+lyd_node_is_dflt_virtual(const struct lyd_node *node)
+{
+    return (node->flags & LYD_DFLT_VIRTUAL) && node->schema && (node->schema->nodetype & LYD_NODE_TERM);
+}
+
+int
+lyd_node_doc_order_cmp(const struct lyd_node *node1, const struct lyd_node *node2)
+{
+    const struct lyd_node *iter1, *iter2, *next1, *next2;
+    const struct lysc_node *siter;
+    uint32_t depth1 = 0, depth2 = 0;
+    int cmp;
+
+    if (node1 == node2) {
+        return 0;
+    }
+
+    if (lyd_node_is_dflt_virtual(node1) || lyd_node_is_dflt_virtual(node2)) {
+        /* virtual default leaves are not linked, they follow their parent before its children */
+        iter1 = lyd_node_is_dflt_virtual(node1) ? lyd_parent(node1) : node1;
+        iter2 = lyd_node_is_dflt_virtual(node2) ? lyd_parent(node2) : node2;
+        if (iter1 != iter2) {
+            return lyd_node_doc_order_cmp(iter1, iter2);
+        } else if (iter1 == node1) {
+            return -1;
+        } else if (iter2 == node2) {
+            return 1;
+        }
+
+        /* virtual leaves of a single parent are in the schema order */
+        for (siter = node1->schema; siter; siter = siter->next) {
+            if (siter == node2->schema) {
+                return -1;
+            }
+        }
+        return 1;
+    }
+
+    /* get the depths */
+    for (iter1 = node1; iter1->parent; iter1 = lyd_parent(iter1)) {
+        ++depth1;
+    }
+    for (iter2 = node2; iter2->parent; iter2 = lyd_parent(iter2)) {
+        ++depth2;
+    }
+
+    /* move to the same depth */
+    for (iter1 = node1; depth1 > depth2; --depth1) {
+        iter1 = lyd_parent(iter1);
+    }
+    for (iter2 = node2; depth2 > depth1; --depth2) {
+        iter2 = lyd_parent(iter2);
+    }
+    if (iter1 == iter2) {
+        /* one node is an ancestor of the other one */
+        return (iter1 == node1) ? -1 : 1;
+    }
+
+    /* move to siblings */
+    while (iter1->parent != iter2->parent) {
+        iter1 = lyd_parent(iter1);
+        iter2 = lyd_parent(iter2);
+    }
+
+    if ((iter1->schema == iter2->schema) && lyds_is_supported(iter1)) {
+        /* instances are sorted */
+        cmp = lyds_compare_single((struct lyd_node *)iter1, (struct lyd_node *)iter2);
+        if (cmp) {
+            return cmp;
+        }
+    }
+
+    /* search the following siblings of both nodes at once, stops on the closer node */
+    next1 = iter1->next;
+    next2 = iter2->next;
+    while (next1 || next2) {
+        if (next1) {
+            if (next1 == iter2) {
+                return -1;
+            }
+            next1 = next1->next;
+        }
+        if (next2) {
+            if (next2 == iter1) {
+                return 1;
+            }
+            next2 = next2->next;
+        }
+    }
+
+    /* not in the same tree */
+    LOGINT(LYD_CTX(node1));
+    return 0;
+}
+
 /**
  * @brief Check list node parsed into an opaque node for the reason.
  *
@@ -977,9 +1096,12 @@ cleanup:
 LIBYANG_API_DEF const char *
 lyd_value_get_canonical(const struct ly_ctx *ctx, const struct lyd_value *value)
 {
+    const char *canon;
+
     LY_CHECK_ARG_RET(ctx, ctx, value, NULL);
 
-    return value->_canonical ? value->_canonical :
+    canon = ATOMIC_PTR_LOAD_ACQUIRE(value->_canonical);
+    return canon ? canon :
            (const char *)value->realtype->plugin->print(ctx, value, LY_VALUE_CANON, NULL, NULL, NULL);
 }
 
@@ -208,6 +208,10 @@ lyd_free_subtree(struct lyd_node *node)
 
     assert(node);
 
+    /* remove from the instance index and the when cache */
+    lyd_inst_index_del(node);
+    lyd_when_cache_del(node);
+
     if (!node->schema) {
         opaq = (struct lyd_node_opaq *)node;
 
@@ -225,6 +229,9 @@ lyd_free_subtree(struct lyd_node *node)
         /* remove children hash table in case of inner data node */
         lyht_free(((struct lyd_node_inner *)node)->children_ht, NULL);
 
+        /* remove any secondary indexes of the children */
+        lyd_index_free_parent(node);
+
         /* free the children */
         LY_LIST_FOR_SAFE(lyd_child(node), next, iter) {
             lyd_free_subtree(iter);
@@ -260,6 +267,9 @@ lyd_free_tree(struct lyd_node *node)
         LOGERR(LYD_CTX(node), LY_EINVAL, "Cannot free a list key \"%s\", free the list instance instead.", LYD_NAME(node));
         return;
     }
+    if (lyd_frozen_check(node)) {
+        return;
+    }
 
     lyd_unlink(node);
     lyd_free_subtree(node);
@@ -274,6 +284,16 @@ lyd_free_(struct lyd_node *node)
         return;
     }
 
+    if (node->flags & LYD_FROZEN) {
+        if (node->parent) {
+            lyd_frozen_check(node);
+        } else {
+            /* the whole frozen tree */
+            lyd_frozen_free(node);
+        }
+        return;
+    }
+
     LY_LIST_FOR_SAFE(lyd_first_sibling(node), next, iter) {
         if (lysc_is_key(iter->schema) && iter->parent) {
             LOGERR(LYD_CTX(iter), LY_EINVAL, "Cannot free a list key \"%s\", free the list instance instead.", LYD_NAME(iter));
@@ -0,0 +1,410 @@
+/**
+ * @file tree_data_frozen.c
+ * @brief Compact read-only (frozen) data trees.
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "dict.h"
+#include "hash_table.h"
+#include "log.h"
+#include "ly_common.h"
+#include "plugins_exts/metadata.h"
+#include "plugins_types.h"
+#include "tree.h"
+#include "tree_data.h"
+#include "tree_data_internal.h"
+#include "tree_schema.h"
+
+/*
+ * A frozen data tree is a copy of a data tree with all its nodes, metadata, attributes, and children hash tables
+ * allocated in a single memory block, in the depth-first order. So, the siblings and descendants are stored next to each other, there
+ * is no per-node allocation overhead, and the internal 'lyds_tree' metadata are not needed since the tree is never
+ * modified. The nodes keep their standard structures so all the functions reading data trees work with frozen
+ * trees, too. The first top-level node is at the beginning of the memory block.
+ */
+
+/**
+ * @brief Size of a structure rounded up to keep all the structures in the memory block aligned.
+ */
+#define LYD_FROZEN_SIZE(size) (((size) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
+/**
+ * @brief Get the size of a data node structure.
+ *
+ * @param[in] node Data node.
+ * @return Size of the node structure.
+ */
+static size_t
+lyd_frozen_node_size(const struct lyd_node *node)
+{
+    if (!node->schema) {
+        return LYD_FROZEN_SIZE(sizeof(struct lyd_node_opaq));
+    } else if (node->schema->nodetype & LYD_NODE_TERM) {
+        return LYD_FROZEN_SIZE(sizeof(struct lyd_node_term));
+    } else if (node->schema->nodetype & LYD_NODE_ANY) {
+        return LYD_FROZEN_SIZE(sizeof(struct lyd_node_any));
+    }
+    return LYD_FROZEN_SIZE(sizeof(struct lyd_node_inner));
+}
+
+/**
+ * @brief Learn the size of the memory block needed for frozen siblings, recursively.
+ *
+ * @param[in] first First sibling.
+ * @return Size of the memory block.
+ */
+static size_t
+lyd_frozen_size_r(const struct lyd_node *first)
+{
+    const struct lyd_node *node;
+    const struct lyd_meta *meta;
+    const struct lyd_attr *attr;
+    size_t size = 0;
+    uint32_t ht_size;
+
+    LY_LIST_FOR(first, node) {
+        size += lyd_frozen_node_size(node);
+
+        if (!node->schema) {
+            LY_LIST_FOR(((struct lyd_node_opaq *)node)->attr, attr) {
+                size += LYD_FROZEN_SIZE(sizeof *attr);
+            }
+        } else {
+            LY_LIST_FOR(node->meta, meta) {
+                if (!lyd_meta_is_internal(meta)) {
+                    size += LYD_FROZEN_SIZE(sizeof *meta);
+                }
+            }
+        }
+
+        if (node->schema && (node->schema->nodetype & LYD_NODE_INNER)) {
+            /* children hash table */
+            size += LYD_FROZEN_SIZE(lyd_hash_table_frozen_size(lyd_child(node), &ht_size));
+        }
+
+        size += lyd_frozen_size_r(lyd_child(node));
+    }
+
+    return size;
+}
+
+/**
+ * @brief Freeze metadata of a node.
+ *
+ * @param[in] node Original data node.
+ * @param[in] frozen Frozen data node.
+ * @param[in,out] mem Memory block cursor.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_frozen_meta(const struct lyd_node *node, struct lyd_node *frozen, char **mem)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    const struct lyd_meta *meta;
+    const struct lyd_attr *attr;
+    struct lyd_meta *fmeta, *last_meta = NULL;
+    struct lyd_attr *fattr, *last_attr = NULL;
+    LY_ERR rc;
+
+    if (!node->schema) {
+        LY_LIST_FOR(((struct lyd_node_opaq *)node)->attr, attr) {
+            fattr = (struct lyd_attr *)*mem;
+            *mem += LYD_FROZEN_SIZE(sizeof *fattr);
+
+            fattr->parent = (struct lyd_node_opaq *)frozen;
+            fattr->format = attr->format;
+            fattr->hints = attr->hints;
+            if (attr->val_prefix_data) {
+                LY_CHECK_RET(ly_dup_prefix_data(ctx, attr->format, attr->val_prefix_data, &fattr->val_prefix_data));
+            }
+            lydict_dup(ctx, attr->name.name, &fattr->name.name);
+            lydict_dup(ctx, attr->name.prefix, &fattr->name.prefix);
+            lydict_dup(ctx, attr->name.module_ns, &fattr->name.module_ns);
+            lydict_dup(ctx, attr->value, &fattr->value);
+
+            /* link */
+            if (last_attr) {
+                last_attr->next = fattr;
+            } else {
+                ((struct lyd_node_opaq *)frozen)->attr = fattr;
+            }
+            last_attr = fattr;
+        }
+        return LY_SUCCESS;
+    }
+
+    LY_LIST_FOR(node->meta, meta) {
+        if (lyd_meta_is_internal(meta)) {
+            /* the frozen instances are never reordered */
+            continue;
+        }
+
+        fmeta = (struct lyd_meta *)*mem;
+        *mem += LYD_FROZEN_SIZE(sizeof *fmeta);
+
+        rc = meta->value.realtype->plugin->duplicate(ctx, &meta->value, &fmeta->value);
+        LY_CHECK_ERR_RET(rc, LOGERR(ctx, rc, "Value duplication failed."), rc);
+        fmeta->parent = frozen;
+        fmeta->annotation = meta->annotation;
+        lydict_dup(ctx, meta->name, &fmeta->name);
+
+        /* link */
+        if (last_meta) {
+            last_meta->next = fmeta;
+        } else {
+            frozen->meta = fmeta;
+        }
+        last_meta = fmeta;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Freeze siblings, recursively.
+ *
+ * @param[in] first First original sibling.
+ * @param[in] parent Frozen parent, if any.
+ * @param[in,out] mem Memory block cursor.
+ * @param[in,out] first_frozen First frozen sibling.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_frozen_siblings_r(const struct lyd_node *first, struct lyd_node *parent, char **mem, struct lyd_node **first_frozen)
+{
+    const struct ly_ctx *ctx;
+    const struct lyd_node *node;
+    struct lyd_node *frozen, *child, *first_child;
+    struct lyd_node_opaq *fopaq, *opaq;
+    struct lyd_node_term *term;
+    struct lyd_node_any *any;
+    size_t ht_mem_size;
+    uint32_t ht_size;
+    LY_ERR rc;
+
+    LY_LIST_FOR(first, node) {
+        ctx = LYD_CTX(node);
+        frozen = (struct lyd_node *)*mem;
+        *mem += lyd_frozen_node_size(node);
+
+        frozen->hash = node->hash;
+        frozen->flags = node->flags | LYD_FROZEN;
+        frozen->schema = node->schema;
+        frozen->priv = node->priv;
+
+        /* nodetype-specific value */
+        if (!node->schema) {
+            fopaq = (struct lyd_node_opaq *)frozen;
+            opaq = (struct lyd_node_opaq *)node;
+
+            if (opaq->val_prefix_data) {
+                LY_CHECK_RET(ly_dup_prefix_data(ctx, opaq->format, opaq->val_prefix_data, &fopaq->val_prefix_data));
+            }
+            lydict_dup(ctx, opaq->name.name, &fopaq->name.name);
+            lydict_dup(ctx, opaq->name.prefix, &fopaq->name.prefix);
+            lydict_dup(ctx, opaq->name.module_ns, &fopaq->name.module_ns);
+            lydict_dup(ctx, opaq->value, &fopaq->value);
+            fopaq->format = opaq->format;
+            fopaq->hints = opaq->hints;
+            fopaq->ctx = opaq->ctx;
+        } else if (node->schema->nodetype & LYD_NODE_TERM) {
+            term = (struct lyd_node_term *)node;
+            rc = term->value.realtype->plugin->duplicate(ctx, &term->value, &((struct lyd_node_term *)frozen)->value);
+            LY_CHECK_ERR_RET(rc, LOGERR(ctx, rc, "Value duplication failed."), rc);
+        }
+
+        /* link to the parent and siblings */
+        frozen->parent = (struct lyd_node_inner *)parent;
+        if (*first_frozen) {
+            frozen->prev = (*first_frozen)->prev;
+            frozen->prev->next = frozen;
+            (*first_frozen)->prev = frozen;
+        } else {
+            frozen->prev = frozen;
+            *first_frozen = frozen;
+            if (parent) {
+                if (parent->schema) {
+                    ((struct lyd_node_inner *)parent)->child = frozen;
+                } else {
+                    ((struct lyd_node_opaq *)parent)->child = frozen;
+                }
+            }
+        }
+        lyd_inst_index_add(frozen);
+
+        /* metadata */
+        LY_CHECK_RET(lyd_frozen_meta(node, frozen, mem));
+
+        if (node->schema && (node->schema->nodetype & LYD_NODE_ANY)) {
+            any = (struct lyd_node_any *)node;
+            LY_CHECK_RET(lyd_any_copy_value(frozen, &any->value, any->value_type));
+        } else if (lyd_child(node)) {
+            /* children */
+            first_child = NULL;
+            LY_CHECK_RET(lyd_frozen_siblings_r(lyd_child(node), frozen, mem, &first_child));
+            if (node->schema) {
+                /* hash table with all the children in the memory block */
+                ht_mem_size = lyd_hash_table_frozen_size(first_child, &ht_size);
+                if (ht_mem_size) {
+                    LY_CHECK_RET(lyd_hash_table_frozen_create(frozen, ht_size, *mem));
+                    *mem += LYD_FROZEN_SIZE(ht_mem_size);
+                }
+                LY_LIST_FOR(first_child, child) {
+                    LY_CHECK_RET(lyd_insert_hash(child));
+                }
+            }
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Free the content of frozen siblings, recursively, not the structures themselves.
+ *
+ * @param[in] first First frozen sibling.
+ */
+static void
+lyd_frozen_free_r(struct lyd_node *first)
+{
+    struct lyd_node *node;
+    struct lyd_node_opaq *opaq;
+    struct lyd_meta *meta;
+    struct lyd_attr *attr;
+    const struct ly_ctx *ctx;
+
+    LY_LIST_FOR(first, node) {
+        ctx = LYD_CTX(node);
+
+        /* remove from the instance index and the when cache */
+        lyd_inst_index_del(node);
+        lyd_when_cache_del(node);
+
+        if (!node->schema) {
+            opaq = (struct lyd_node_opaq *)node;
+            lyd_frozen_free_r(opaq->child);
+
+            lydict_remove(ctx, opaq->name.name);
+            lydict_remove(ctx, opaq->name.prefix);
+            lydict_remove(ctx, opaq->name.module_ns);
+            lydict_remove(ctx, opaq->value);
+            ly_free_prefix_data(opaq->format, opaq->val_prefix_data);
+
+            LY_LIST_FOR(opaq->attr, attr) {
+                ly_free_prefix_data(attr->format, attr->val_prefix_data);
+                lydict_remove(ctx, attr->name.name);
+                lydict_remove(ctx, attr->name.prefix);
+                lydict_remove(ctx, attr->name.module_ns);
+                lydict_remove(ctx, attr->value);
+            }
+            continue;
+        }
+
+        if (node->schema->nodetype & LYD_NODE_INNER) {
+            /* the children hash table is in the memory block */
+            lyd_index_free_parent(node);
+            lyd_frozen_free_r(lyd_child(node));
+        } else if (node->schema->nodetype & LYD_NODE_ANY) {
+            lyd_any_copy_value(node, NULL, 0);
+        } else {
+            ((struct lysc_node_leaf *)node->schema)->type->plugin->free(ctx, &((struct lyd_node_term *)node)->value);
+            lyd_free_leafref_nodes((struct lyd_node_term *)node);
+        }
+
+        LY_LIST_FOR(node->meta, meta) {
+            lydict_remove(ctx, meta->name);
+            meta->value.realtype->plugin->free(ctx, &meta->value);
+        }
+    }
+}
+
+void
+lyd_frozen_free(struct lyd_node *node)
+{
+    if (!node) {
+        return;
+    }
+
+    /* the first top-level node is the beginning of the memory block */
+    for ( ; node->parent; node = lyd_parent(node)) {}
+    node = lyd_first_sibling(node);
+    assert(node->flags & LYD_FROZEN);
+
+    lyd_frozen_free_r(node);
+    free(node);
+}
+
+LY_ERR
+lyd_frozen_check(const struct lyd_node *node)
+{
+    if (!node) {
+        return LY_SUCCESS;
+    }
+
+    if ((node->flags & LYD_FROZEN) ||
+            ((node->flags & LYD_DFLT_VIRTUAL) && node->parent && (node->parent->flags & LYD_FROZEN))) {
+        LOGERR(LYD_CTX(node), LY_EINVAL, "Data node \"%s\" is frozen and cannot be modified.", LYD_NAME(node));
+        return LY_EINVAL;
+    }
+
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_freeze(const struct lyd_node *tree, struct lyd_node **frozen)
+{
+    LY_ERR rc;
+    char *mem, *end;
+    size_t size;
+
+    LY_CHECK_ARG_RET(NULL, tree, frozen, LY_EINVAL);
+
+    *frozen = NULL;
+    tree = lyd_first_sibling(tree);
+
+    /* lazily parsed LYB subtrees are frozen as well */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(tree));
+
+    /* allocate the whole memory block */
+    size = lyd_frozen_size_r(tree);
+    mem = calloc(1, size);
+    LY_CHECK_ERR_RET(!mem, LOGMEM(LYD_CTX(tree)), LY_EMEM);
+    end = mem + size;
+
+    /* fill it */
+    rc = lyd_frozen_siblings_r(tree, NULL, &mem, frozen);
+    if (rc) {
+        if (*frozen) {
+            lyd_frozen_free(*frozen);
+            *frozen = NULL;
+        } else {
+            free(end - size);
+        }
+        return rc;
+    }
+    assert(mem == end);
+
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_thaw(const struct lyd_node *frozen, struct lyd_node **tree)
+{
+    LY_CHECK_ARG_RET(NULL, frozen, tree, LY_EINVAL);
+
+    /* regular copy of all the top-level siblings, keep the validation state */
+    for ( ; frozen->parent; frozen = lyd_parent(frozen)) {}
+    return lyd_dup_siblings(lyd_first_sibling(frozen), NULL, LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS | LYD_DUP_WITH_PRIV,
+            tree);
+}
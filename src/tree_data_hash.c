@@ -19,11 +19,13 @@
 
 #include "compat.h"
 #include "hash_table.h"
+#include "hash_table_internal.h"
 #include "log.h"
 #include "ly_common.h"
 #include "plugins_types.h"
 #include "tree.h"
 #include "tree_data.h"
+#include "tree_data_internal.h"
 #include "tree_schema.h"
 
 LY_ERR
@@ -165,13 +167,21 @@ lyd_insert_hash(struct lyd_node *node)
     struct lyd_node *iter;
     uint32_t u;
 
+    /* invalidate cached when results, even of top-level nodes */
+    lyd_when_cache_change(node);
+
     if (!node->parent || !node->schema || !node->parent->schema) {
         /* nothing to do */
         return LY_SUCCESS;
     }
 
+    /* update any secondary indexes */
+    lyd_index_insert(node);
+
     /* create parent hash table if required, otherwise just add the new child */
-    if (!node->parent->children_ht) {
+    if (node->parent->flags & LYD_FROZEN) {
+        /* created with all the children, see lyd_hash_table_frozen_create() */
+    } else if (!node->parent->children_ht) {
         /* the hash table is created only when the number of children in a node exceeds the
          * defined minimal limit LYD_HT_MIN_ITEMS
          */
@@ -196,16 +206,75 @@ lyd_insert_hash(struct lyd_node *node)
     return LY_SUCCESS;
 }
 
+size_t
+lyd_hash_table_frozen_size(const struct lyd_node *first, uint32_t *size)
+{
+    const struct lyd_node *iter;
+    uint32_t u = 0, rec_count = 0;
+
+    *size = 0;
+
+    LY_LIST_FOR(first, iter) {
+        if (!iter->schema) {
+            continue;
+        }
+        ++u;
+
+        /* the node and the first instance of a (leaf-)list */
+        ++rec_count;
+        if ((iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) &&
+                (!iter->prev->next || (iter->prev->schema != iter->schema))) {
+            ++rec_count;
+        }
+    }
+    if (u < LYD_HT_MIN_ITEMS) {
+        return 0;
+    }
+
+    /* the same fill as a regular hash table before it is enlarged */
+    *size = lyht_get_fixed_size((rec_count * LYHT_HUNDRED_PERCENTAGE) / LYHT_ENLARGE_PERCENTAGE + 1);
+    return lyht_mem_size(*size, sizeof(struct lyd_node *));
+}
+
+LY_ERR
+lyd_hash_table_frozen_create(struct lyd_node *parent, uint32_t size, void *mem)
+{
+    struct lyd_node_inner *inner = (struct lyd_node_inner *)parent;
+    struct lyd_node *iter;
+
+    assert(parent->flags & LYD_FROZEN);
+
+    inner->children_ht = lyht_new_mem(mem, size, sizeof(struct lyd_node *), lyd_hash_table_val_equal, NULL);
+    LY_LIST_FOR(inner->child, iter) {
+        if (iter->schema) {
+            LY_CHECK_RET(lyd_insert_hash_add(inner->children_ht, iter, 1));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
 void
 lyd_unlink_hash(struct lyd_node *node)
 {
     uint32_t hash;
 
-    if (!node->parent || !node->schema || !node->parent->schema || !node->parent->children_ht) {
+    /* invalidate cached when results, even of top-level nodes */
+    lyd_when_cache_unlink(node);
+
+    if (!node->parent || !node->schema || !node->parent->schema) {
         /* not in any HT */
         return;
     }
 
+    /* update any secondary indexes */
+    lyd_index_unlink(node);
+
+    if (!node->parent->children_ht) {
+        /* not in the parent HT */
+        return;
+    }
+
     /* remove from the parent HT */
     if (lyht_remove(node->parent->children_ht, &node, node->hash)) {
         LOGINT(LYD_CTX(node));
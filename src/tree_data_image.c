@@ -0,0 +1,777 @@
+/**
+ * @file tree_data_image.c
+ * @brief Relocatable offset-based data tree images.
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "context.h"
+#include "hash_table.h"
+#include "log.h"
+#include "ly_common.h"
+#include "lyb.h"
+#include "path.h"
+#include "tree.h"
+#include "tree_data.h"
+#include "tree_data_internal.h"
+#include "tree_schema.h"
+#include "xpath.h"
+
+/*
+ * A data tree image is a single memory block with a header followed by the array of all the nodes, in the
+ * depth-first order, and by all their strings. There are no pointers in the image, the nodes reference each other
+ * and their strings by offsets relative to the referencing node so the image can be copied anywhere, for example
+ * into a shared memory or a file mapped by several processes, and read directly. Schema nodes are referenced by
+ * their module and schema node names, which are resolved in any context with the same modules. Nodes are looked up
+ * by their data node hashes, which are the same as in the original tree. Sibling sets with at least
+ * ::LYD_HT_MIN_ITEMS nodes have an index of their hashes sorted for a binary search, stored in the index area
+ * between the nodes and the strings, smaller sets are searched sequentially. The first instance of every (leaf-)list
+ * is also indexed by the hash of its schema node only, the same as a single instance.
+ */
+
+/**
+ * @brief Magic bytes at the beginning of an image.
+ */
+#define LYD_IMAGE_MAGIC "LYDI"
+
+/**
+ * @brief Current version of the image format.
+ */
+#define LYD_IMAGE_VERSION 2
+
+/**
+ * @brief Image header.
+ */
+struct lyd_image_hdr {
+    char magic[4];          /**< ::LYD_IMAGE_MAGIC */
+    uint8_t version;        /**< ::LYD_IMAGE_VERSION */
+    uint8_t hash_alg;       /**< hash algorithm of the data node hashes, ::LYB_HEADER_HASH_ALG */
+    uint16_t padding;
+    uint32_t ctx_hash;      /**< context modules hash, see ::ly_ctx_get_modules_hash() */
+    uint32_t idx_count;     /**< number of index entries of the top-level siblings, 0 if not indexed */
+    uint64_t size;          /**< size of the whole image */
+    int64_t idx;            /**< offset of the index of the top-level siblings */
+};
+
+/**
+ * @brief Image data node, the first top-level node immediately follows the header.
+ */
+struct lyd_image_node {
+    int64_t parent;         /**< offset of the parent node, 0 for top-level nodes */
+    int64_t next;           /**< offset of the next sibling, 0 for the last sibling */
+    int64_t child;          /**< offset of the first child, 0 if there are none */
+    int64_t module;         /**< offset of the module name */
+    int64_t name;           /**< offset of the schema node name */
+    int64_t value;          /**< offset of the canonical value of terms or the JSON value of any nodes, 0 if none */
+    int64_t idx;            /**< offset of the index of the children */
+    uint32_t hash;          /**< hash of the data node, see ::lyd_hash() */
+    uint32_t idx_count;     /**< number of index entries of the children, 0 if not indexed */
+};
+
+/**
+ * @brief Image sibling index entry, the entries of a sibling set are sorted by their hash and then by the order
+ * of the siblings.
+ */
+struct lyd_image_idx {
+    uint32_t hash;          /**< hash of the node or the hash of its schema node for the first (leaf-)list instance */
+    uint32_t first;         /**< whether the entry is the first (leaf-)list instance indexed by its schema node hash */
+    int64_t node;           /**< offset of the node */
+};
+
+/**
+ * @brief Stored dictionary string.
+ */
+struct lyd_image_str {
+    const char *str;        /**< dictionary string */
+    uint64_t off;           /**< its offset in the string area */
+};
+
+/**
+ * @brief Image creation context.
+ */
+struct lyd_image_ctx {
+    struct lyd_image_node *nodes;   /**< node area */
+    uint64_t count;                 /**< number of nodes */
+    uint64_t size;                  /**< number of allocated nodes */
+
+    struct lyd_image_idx *idx;      /**< index area, the node offsets are node indices until the image is finished */
+    uint64_t idx_count;             /**< number of index entries */
+    uint64_t idx_size;              /**< number of allocated index entries */
+    uint64_t top_idx;               /**< first index entry of the top-level siblings */
+    uint32_t top_idx_count;         /**< number of index entries of the top-level siblings */
+
+    char *strs;                     /**< string area, starts with an empty string so that offset 0 means none */
+    uint64_t strs_len;              /**< used length of the string area */
+    uint64_t strs_size;             /**< allocated size of the string area */
+    struct ly_ht *str_ht;           /**< dictionary strings already in the string area */
+};
+
+/**
+ * @brief Get a node referenced by an offset.
+ *
+ * @param[in] node Referencing node.
+ * @param[in] off Offset relative to @p node.
+ * @return Referenced node, NULL if @p off is 0.
+ */
+#define LYD_IMAGE_NODE(node, off) ((off) ? (const struct lyd_image_node *)((const char *)(node) + (off)) : NULL)
+
+/**
+ * @brief Get a string referenced by an offset.
+ *
+ * @param[in] node Referencing node.
+ * @param[in] off Offset relative to @p node.
+ * @return Referenced string, NULL if @p off is 0.
+ */
+#define LYD_IMAGE_STR(node, off) ((off) ? (const char *)(node) + (off) : NULL)
+
+/**
+ * @brief Compare callback for the stored dictionary strings.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_image_str_equal(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_image_str *val1 = val1_p, *val2 = val2_p;
+
+    return val1->str == val2->str;
+}
+
+/**
+ * @brief Store a string in the string area.
+ *
+ * @param[in] ictx Image creation context.
+ * @param[in] str String to store.
+ * @param[in] dict Whether @p str is a dictionary string, which is then stored only once.
+ * @param[out] off Offset of the string in the string area.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_str_store(struct lyd_image_ctx *ictx, const char *str, ly_bool dict, uint64_t *off)
+{
+    struct lyd_image_str rec, *match;
+    uint32_t hash = 0;
+    size_t len;
+    void *mem;
+
+    if (dict) {
+        /* dictionary strings are compared by their pointers */
+        rec.str = str;
+        hash = lyht_hash((const char *)&str, sizeof str);
+        if (!lyht_find(ictx->str_ht, &rec, hash, (void **)&match)) {
+            *off = match->off;
+            return LY_SUCCESS;
+        }
+    }
+
+    len = strlen(str) + 1;
+    if (ictx->strs_len + len > ictx->strs_size) {
+        ictx->strs_size = (ictx->strs_len + len) * 2;
+        mem = realloc(ictx->strs, ictx->strs_size);
+        LY_CHECK_ERR_RET(!mem, LOGMEM(NULL), LY_EMEM);
+        ictx->strs = mem;
+    }
+    memcpy(ictx->strs + ictx->strs_len, str, len);
+    *off = ictx->strs_len;
+    ictx->strs_len += len;
+
+    if (dict) {
+        rec.off = *off;
+        LY_CHECK_RET(lyht_insert(ictx->str_ht, &rec, hash, NULL));
+    }
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Add a data node into the node area. The string offsets are relative to the string area until the image
+ * is finished.
+ *
+ * @param[in] ictx Image creation context.
+ * @param[in] node Data node to add.
+ * @param[in] parent_idx Index of the parent node, @p idx for top-level nodes.
+ * @param[in] prev_idx Index of the previous sibling, @p idx for the first sibling.
+ * @param[out] idx Index of the added node.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_node_add(struct lyd_image_ctx *ictx, const struct lyd_node *node, uint64_t parent_idx, uint64_t prev_idx,
+        uint64_t *idx)
+{
+    struct lyd_image_node *inode;
+    char *str = NULL;
+    uint64_t off;
+    void *mem;
+    LY_ERR rc;
+
+    if (!node->schema) {
+        LOGERR(LYD_CTX(node), LY_EINVAL, "Opaque node \"%s\" cannot be stored in a data tree image.",
+                ((struct lyd_node_opaq *)node)->name.name);
+        return LY_EINVAL;
+    } else if (node->flags & LYD_EXT) {
+        LOGERR(LYD_CTX(node), LY_EINVAL, "Extension data node \"%s\" cannot be stored in a data tree image.",
+                LYD_NAME(node));
+        return LY_EINVAL;
+    }
+
+    if (ictx->count == ictx->size) {
+        ictx->size = ictx->size ? ictx->size * 2 : 32;
+        mem = realloc(ictx->nodes, ictx->size * sizeof *ictx->nodes);
+        LY_CHECK_ERR_RET(!mem, LOGMEM(LYD_CTX(node)), LY_EMEM);
+        ictx->nodes = mem;
+    }
+    *idx = ictx->count++;
+    inode = &ictx->nodes[*idx];
+    memset(inode, 0, sizeof *inode);
+
+    /* links */
+    if (parent_idx != *idx) {
+        inode->parent = ((int64_t)parent_idx - (int64_t)*idx) * (int64_t)sizeof *inode;
+        if (!ictx->nodes[parent_idx].child) {
+            ictx->nodes[parent_idx].child = ((int64_t)*idx - (int64_t)parent_idx) * (int64_t)sizeof *inode;
+        }
+    }
+    if (prev_idx != *idx) {
+        ictx->nodes[prev_idx].next = ((int64_t)*idx - (int64_t)prev_idx) * (int64_t)sizeof *inode;
+    }
+
+    /* strings */
+    LY_CHECK_RET(lyd_image_str_store(ictx, node->schema->module->name, 1, &off));
+    inode->module = off;
+    LY_CHECK_RET(lyd_image_str_store(ictx, node->schema->name, 1, &off));
+    inode->name = off;
+    if (node->schema->nodetype & LYD_NODE_TERM) {
+        LY_CHECK_RET(lyd_image_str_store(ictx, lyd_get_value(node), 1, &off));
+        inode->value = off;
+    } else if ((node->schema->nodetype & LYD_NODE_ANY) && ((struct lyd_node_any *)node)->value.str) {
+        LY_CHECK_RET(lyd_any_value_str(node, &str));
+        rc = lyd_image_str_store(ictx, str, 0, &off);
+        free(str);
+        LY_CHECK_RET(rc);
+        inode->value = off;
+    }
+
+    inode->hash = node->hash;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Get the hash of a single instance or of the first (leaf-)list instance, made of its schema node only.
+ *
+ * @param[in] schema Schema node of the instance.
+ * @return Schema node hash.
+ */
+static uint32_t
+lyd_image_schema_hash(const struct lysc_node *schema)
+{
+    uint32_t hash;
+
+    hash = lyht_hash_multi(0, schema->module->name, strlen(schema->module->name));
+    hash = lyht_hash_multi(hash, schema->name, strlen(schema->name));
+    return lyht_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Compare callback for sorting the sibling index entries.
+ */
+static int
+lyd_image_idx_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct lyd_image_idx *idx1 = ptr1, *idx2 = ptr2;
+
+    if (idx1->hash != idx2->hash) {
+        return (idx1->hash < idx2->hash) ? -1 : 1;
+    }
+    if (idx1->node != idx2->node) {
+        return (idx1->node < idx2->node) ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Add an index entry into the index area.
+ *
+ * @param[in] ictx Image creation context.
+ * @param[in] hash Hash of the entry.
+ * @param[in] first Whether the entry is the first (leaf-)list instance.
+ * @param[in] node_idx Index of the node.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_idx_add(struct lyd_image_ctx *ictx, uint32_t hash, ly_bool first, uint64_t node_idx)
+{
+    void *mem;
+
+    if (ictx->idx_count == ictx->idx_size) {
+        ictx->idx_size = ictx->idx_size ? ictx->idx_size * 2 : 32;
+        mem = realloc(ictx->idx, ictx->idx_size * sizeof *ictx->idx);
+        LY_CHECK_ERR_RET(!mem, LOGMEM(NULL), LY_EMEM);
+        ictx->idx = mem;
+    }
+
+    ictx->idx[ictx->idx_count].hash = hash;
+    ictx->idx[ictx->idx_count].first = first;
+    ictx->idx[ictx->idx_count].node = node_idx;
+    ++ictx->idx_count;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Create the index of a sibling set, if it is large enough.
+ *
+ * @param[in] ictx Image creation context.
+ * @param[in] first_idx Index of the first sibling.
+ * @param[in] parent_idx Index of the parent node, @p first_idx for top-level siblings.
+ * @param[in] schemas Schema nodes of all the siblings.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_idx_create(struct lyd_image_ctx *ictx, uint64_t first_idx, uint64_t parent_idx, const struct ly_set *schemas)
+{
+    const struct lyd_image_node *inode;
+    const struct lysc_node *prev_schema = NULL;
+    uint64_t start = ictx->idx_count, node_idx;
+    uint32_t i;
+
+    if (schemas->count < LYD_HT_MIN_ITEMS) {
+        return LY_SUCCESS;
+    }
+
+    node_idx = first_idx;
+    for (i = 0; i < schemas->count; ++i) {
+        inode = &ictx->nodes[node_idx];
+        LY_CHECK_RET(lyd_image_idx_add(ictx, inode->hash, 0, node_idx));
+        if ((schemas->snodes[i]->nodetype & (LYS_LIST | LYS_LEAFLIST)) && (schemas->snodes[i] != prev_schema)) {
+            /* first instance, (leaf-)list instances are always next to each other */
+            LY_CHECK_RET(lyd_image_idx_add(ictx, lyd_image_schema_hash(schemas->snodes[i]), 1, node_idx));
+        }
+        prev_schema = schemas->snodes[i];
+
+        node_idx += inode->next / (int64_t)sizeof *inode;
+    }
+    qsort(ictx->idx + start, ictx->idx_count - start, sizeof *ictx->idx, lyd_image_idx_cmp);
+
+    /* the entry offset is made relative when the image is finished */
+    if (parent_idx == first_idx) {
+        ictx->top_idx = start;
+        ictx->top_idx_count = ictx->idx_count - start;
+    } else {
+        ictx->nodes[parent_idx].idx = start;
+        ictx->nodes[parent_idx].idx_count = ictx->idx_count - start;
+    }
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Add data node siblings with all their descendants into the node area.
+ *
+ * @param[in] ictx Image creation context.
+ * @param[in] first First sibling to add.
+ * @param[in] parent Parent data node, NULL for top-level siblings.
+ * @param[in] parent_idx Index of the parent node, ignored for top-level siblings.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_siblings_r(struct lyd_image_ctx *ictx, const struct lyd_node *first, const struct lyd_node *parent,
+        uint64_t parent_idx)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct lyd_node *node;
+    struct ly_set virt = {0}, schemas = {0};
+    uint64_t idx = 0, prev_idx = 0, first_idx = 0;
+    ly_bool has_prev = 0, virtual = 0;
+    uint32_t i = 0;
+
+    /* virtual default leaves are stored as regular nodes after the real children */
+    if (parent) {
+        LY_CHECK_GOTO(rc = lyd_dflt_virtual_children(parent, &virt), cleanup);
+    }
+
+    node = first;
+    while (node || (i < virt.count)) {
+        if (!node) {
+            node = virt.dnodes[i++];
+            virtual = 1;
+        }
+
+        LY_CHECK_GOTO(rc = lyd_image_node_add(ictx, node, parent ? parent_idx : ictx->count,
+                has_prev ? prev_idx : ictx->count, &idx), cleanup);
+        LY_CHECK_GOTO(rc = lyd_image_siblings_r(ictx, lyd_child(node), node, idx), cleanup);
+        LY_CHECK_GOTO(rc = ly_set_add(&schemas, node->schema, 1, NULL), cleanup);
+
+        if (!has_prev) {
+            first_idx = idx;
+        }
+        prev_idx = idx;
+        has_prev = 1;
+        node = virtual ? NULL : node->next;
+    }
+
+    if (has_prev) {
+        LY_CHECK_GOTO(rc = lyd_image_idx_create(ictx, first_idx, parent ? parent_idx : first_idx, &schemas), cleanup);
+    }
+
+cleanup:
+    ly_set_erase(&virt, NULL);
+    ly_set_erase(&schemas, NULL);
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_image_create(const struct lyd_node *tree, void **image, size_t *size)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyd_image_ctx ictx = {0};
+    struct lyd_image_hdr *hdr;
+    struct lyd_image_node *inode;
+    uint64_t i, node_off, idx_off, strs_off;
+
+    LY_CHECK_ARG_RET(NULL, tree, image, size, LY_EINVAL);
+    LY_CHECK_ARG_RET(LYD_CTX(tree), !tree->parent, LY_EINVAL);
+
+    *image = NULL;
+    *size = 0;
+
+    /* all the nodes are needed */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(tree));
+    tree = lyd_first_sibling(tree);
+
+    ictx.str_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_image_str), lyd_image_str_equal, NULL, 1);
+    LY_CHECK_ERR_GOTO(!ictx.str_ht, LOGMEM(LYD_CTX(tree)); rc = LY_EMEM, cleanup);
+
+    /* empty string at offset 0 */
+    ictx.strs_size = 1024;
+    ictx.strs = malloc(ictx.strs_size);
+    LY_CHECK_ERR_GOTO(!ictx.strs, LOGMEM(LYD_CTX(tree)); rc = LY_EMEM, cleanup);
+    ictx.strs[0] = '\0';
+    ictx.strs_len = 1;
+
+    /* create the nodes and their strings */
+    LY_CHECK_GOTO(rc = lyd_image_siblings_r(&ictx, tree, NULL, 0), cleanup);
+
+    /* assemble the image */
+    idx_off = sizeof *hdr + ictx.count * sizeof *ictx.nodes;
+    strs_off = idx_off + ictx.idx_count * sizeof *ictx.idx;
+    *size = strs_off + ictx.strs_len;
+    *image = malloc(*size);
+    LY_CHECK_ERR_GOTO(!*image, LOGMEM(LYD_CTX(tree)); rc = LY_EMEM, cleanup);
+
+    hdr = *image;
+    memset(hdr, 0, sizeof *hdr);
+    memcpy(hdr->magic, LYD_IMAGE_MAGIC, 4);
+    hdr->version = LYD_IMAGE_VERSION;
+    hdr->hash_alg = LYB_HEADER_HASH_ALG;
+    hdr->ctx_hash = ly_ctx_get_modules_hash(LYD_CTX(tree));
+    hdr->size = *size;
+    if (ictx.top_idx_count) {
+        hdr->idx_count = ictx.top_idx_count;
+        hdr->idx = idx_off + ictx.top_idx * sizeof *ictx.idx;
+    }
+
+    /* make the string and index offsets relative to the nodes */
+    for (i = 0; i < ictx.count; ++i) {
+        inode = &ictx.nodes[i];
+        node_off = sizeof *hdr + i * sizeof *inode;
+        inode->module += strs_off - node_off;
+        inode->name += strs_off - node_off;
+        if (inode->value) {
+            inode->value += strs_off - node_off;
+        }
+        if (inode->idx_count) {
+            inode->idx = (int64_t)(idx_off + inode->idx * sizeof *ictx.idx) - (int64_t)node_off;
+        }
+    }
+
+    /* make the node offsets relative to the index entries */
+    for (i = 0; i < ictx.idx_count; ++i) {
+        node_off = sizeof *hdr + ictx.idx[i].node * sizeof *ictx.nodes;
+        ictx.idx[i].node = (int64_t)node_off - (int64_t)(idx_off + i * sizeof *ictx.idx);
+    }
+
+    memcpy((char *)*image + sizeof *hdr, ictx.nodes, ictx.count * sizeof *ictx.nodes);
+    memcpy((char *)*image + idx_off, ictx.idx, ictx.idx_count * sizeof *ictx.idx);
+    memcpy((char *)*image + strs_off, ictx.strs, ictx.strs_len);
+
+cleanup:
+    free(ictx.nodes);
+    free(ictx.idx);
+    free(ictx.strs);
+    lyht_free(ictx.str_ht, NULL);
+    if (rc) {
+        free(*image);
+        *image = NULL;
+        *size = 0;
+    }
+    return rc;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_image_first(const struct ly_ctx *ctx, const void *image, const struct lyd_image_node **first)
+{
+    const struct lyd_image_hdr *hdr = image;
+
+    LY_CHECK_ARG_RET(ctx, ctx, image, first, LY_EINVAL);
+
+    if (memcmp(hdr->magic, LYD_IMAGE_MAGIC, 4) || (hdr->version != LYD_IMAGE_VERSION)) {
+        LOGERR(ctx, LY_EINVAL, "Invalid data tree image.");
+        return LY_EINVAL;
+    } else if (hdr->hash_alg != LYB_HEADER_HASH_ALG) {
+        LOGERR(ctx, LY_EINVAL, "Data tree image was created with a different hash algorithm.");
+        return LY_EINVAL;
+    } else if (hdr->ctx_hash != ly_ctx_get_modules_hash(ctx)) {
+        LOGERR(ctx, LY_EINVAL, "Data tree image was created with a different context.");
+        return LY_EINVAL;
+    }
+
+    *first = (const struct lyd_image_node *)(hdr + 1);
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF const struct lyd_image_node *
+lyd_image_next(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_NODE(node, node->next) : NULL;
+}
+
+LIBYANG_API_DEF const struct lyd_image_node *
+lyd_image_child(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_NODE(node, node->child) : NULL;
+}
+
+LIBYANG_API_DEF const struct lyd_image_node *
+lyd_image_parent(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_NODE(node, node->parent) : NULL;
+}
+
+LIBYANG_API_DEF const char *
+lyd_image_name(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_STR(node, node->name) : NULL;
+}
+
+LIBYANG_API_DEF const char *
+lyd_image_module(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_STR(node, node->module) : NULL;
+}
+
+LIBYANG_API_DEF const char *
+lyd_image_value(const struct lyd_image_node *node)
+{
+    return node ? LYD_IMAGE_STR(node, node->value) : NULL;
+}
+
+LIBYANG_API_DEF const struct lysc_node *
+lyd_image_schema(const struct ly_ctx *ctx, const struct lyd_image_node *node)
+{
+    const struct lysc_node *sparent = NULL;
+    const struct lys_module *mod;
+
+    if (!ctx || !node) {
+        return NULL;
+    }
+
+    if (node->parent) {
+        sparent = lyd_image_schema(ctx, LYD_IMAGE_NODE(node, node->parent));
+        if (!sparent) {
+            return NULL;
+        }
+    }
+
+    mod = ly_ctx_get_module_implemented(ctx, LYD_IMAGE_STR(node, node->module));
+    if (!mod) {
+        return NULL;
+    }
+    return lys_find_child(sparent, mod, LYD_IMAGE_STR(node, node->name), 0, 0, 0);
+}
+
+/**
+ * @brief Check whether an image node is an instance of a schema node.
+ *
+ * @param[in] node Image node.
+ * @param[in] schema Schema node.
+ * @return Whether the node is an instance of @p schema.
+ */
+static ly_bool
+lyd_image_is_inst(const struct lyd_image_node *node, const struct lysc_node *schema)
+{
+    return !strcmp((const char *)node + node->name, schema->name) &&
+           !strcmp((const char *)node + node->module, schema->module->name);
+}
+
+/**
+ * @brief Check whether an image node has the same keys or value as a data node.
+ *
+ * @param[in] node Image node of a list or a leaf-list.
+ * @param[in] target Data node with the keys or value.
+ * @return Whether the instances are the same.
+ */
+static ly_bool
+lyd_image_inst_equal(const struct lyd_image_node *node, const struct lyd_node *target)
+{
+    const struct lyd_image_node *child;
+    const struct lyd_node *key;
+
+    if (target->schema->nodetype == LYS_LEAFLIST) {
+        return !strcmp((const char *)node + node->value, lyd_get_value(target));
+    }
+
+    /* the keys are always the first children in the schema order */
+    child = LYD_IMAGE_NODE(node, node->child);
+    LY_LIST_FOR(lyd_child(target), key) {
+        if (!child || !lyd_image_is_inst(child, key->schema) ||
+                strcmp((const char *)child + child->value, lyd_get_value(key))) {
+            return 0;
+        }
+        child = LYD_IMAGE_NODE(child, child->next);
+    }
+    return 1;
+}
+
+/**
+ * @brief Find an image node instance of a path segment.
+ *
+ * @param[in] first First sibling to search.
+ * @param[in] idx Index of the siblings, NULL if not indexed.
+ * @param[in] idx_count Number of @p idx entries.
+ * @param[in] seg Compiled path segment.
+ * @param[out] match Found node, NULL if none.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_image_find_seg(const struct lyd_image_node *first, const struct lyd_image_idx *idx, uint32_t idx_count,
+        const struct ly_path *seg, const struct lyd_image_node **match)
+{
+    const struct lyd_image_node *node;
+    struct lyd_node *target = NULL;
+    ly_bool first_inst = 0;
+    uint64_t pos;
+    uint32_t hash, lo, hi, mid;
+
+    *match = NULL;
+
+    if (seg->predicates && (seg->predicates[0].type == LY_PATH_PREDTYPE_LEAFLIST)) {
+        LY_CHECK_RET(lyd_create_term2(seg->node, &seg->predicates[0].value, &target));
+        hash = target->hash;
+    } else if (seg->predicates && (seg->predicates[0].type == LY_PATH_PREDTYPE_LIST)) {
+        LY_CHECK_RET(lyd_create_list(seg->node, seg->predicates, NULL, 1, &target));
+        hash = target->hash;
+    } else {
+        /* a single instance or the first instance of a (leaf-)list, the hash is made of the schema node only */
+        hash = lyd_image_schema_hash(seg->node);
+        first_inst = (seg->node->nodetype & (LYS_LIST | LYS_LEAFLIST)) ? 1 : 0;
+    }
+
+    if (idx) {
+        /* binary search for the first entry with the hash */
+        lo = 0;
+        hi = idx_count;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (idx[mid].hash < hash) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        for ( ; (lo < idx_count) && (idx[lo].hash == hash); ++lo) {
+            node = LYD_IMAGE_NODE(&idx[lo], idx[lo].node);
+            if ((first_inst && !idx[lo].first) || !lyd_image_is_inst(node, seg->node)) {
+                continue;
+            } else if (target && !lyd_image_inst_equal(node, target)) {
+                continue;
+            }
+
+            *match = node;
+            break;
+        }
+    } else {
+        for (node = first; node; node = LYD_IMAGE_NODE(node, node->next)) {
+            /* the first (leaf-)list instance has the hash of the instance */
+            if ((!first_inst && (node->hash != hash)) || !lyd_image_is_inst(node, seg->node)) {
+                continue;
+            } else if (target && !lyd_image_inst_equal(node, target)) {
+                continue;
+            }
+
+            *match = node;
+            break;
+        }
+    }
+
+    if (*match && seg->predicates && (seg->predicates[0].type == LY_PATH_PREDTYPE_POSITION)) {
+        /* (leaf-)list instances are always next to each other */
+        for (pos = 1; *match && (pos < seg->predicates[0].position); ++pos) {
+            *match = LYD_IMAGE_NODE(*match, (*match)->next);
+            if (*match && !lyd_image_is_inst(*match, seg->node)) {
+                *match = NULL;
+            }
+        }
+    }
+
+    lyd_free_tree(target);
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_image_find_path(const struct ly_ctx *ctx, const void *image, const char *path, const struct lyd_image_node **match)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_expr *expr = NULL;
+    struct ly_path *lypath = NULL;
+    const struct lyd_image_hdr *hdr;
+    const struct lyd_image_node *node = NULL;
+    const struct lyd_image_idx *idx;
+    uint32_t idx_count;
+    LY_ARRAY_COUNT_TYPE u;
+
+    LY_CHECK_ARG_RET(ctx, ctx, image, path, LY_EINVAL);
+
+    LY_CHECK_GOTO(rc = lyd_image_first(ctx, image, &node), cleanup);
+
+    /* parse and compile the path */
+    rc = ly_path_parse(ctx, NULL, path, 0, 0, LY_PATH_BEGIN_ABSOLUTE, LY_PATH_PREFIX_FIRST, LY_PATH_PRED_SIMPLE, &expr);
+    LY_CHECK_GOTO(rc, cleanup);
+    rc = ly_path_compile(ctx, NULL, NULL, NULL, expr, LY_PATH_OPER_INPUT, LY_PATH_TARGET_SINGLE, 0, LY_VALUE_JSON,
+            NULL, &lypath);
+    LY_CHECK_GOTO(rc, cleanup);
+
+    /* find the nodes of all the segments */
+    hdr = image;
+    idx = hdr->idx_count ? (const struct lyd_image_idx *)((const char *)hdr + hdr->idx) : NULL;
+    idx_count = hdr->idx_count;
+    LY_ARRAY_FOR(lypath, u) {
+        if (u) {
+            idx = node->idx_count ? (const struct lyd_image_idx *)((const char *)node + node->idx) : NULL;
+            idx_count = node->idx_count;
+            node = LYD_IMAGE_NODE(node, node->child);
+        }
+        LY_CHECK_GOTO(rc = lyd_image_find_seg(node, idx, idx_count, &lypath[u], &node), cleanup);
+        if (!node) {
+            rc = LY_ENOTFOUND;
+            break;
+        }
+    }
+
+cleanup:
+    if (match) {
+        *match = rc ? NULL : node;
+    }
+    lyxp_expr_free(ctx, expr);
+    ly_path_free(lypath);
+    return rc;
+}
@@ -0,0 +1,2612 @@
+/**
+ * @file tree_data_index.c
+ * @brief Secondary indexes of data nodes.
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "hash_table.h"
+#include "hash_table_internal.h"
+#include "log.h"
+#include "ly_common.h"
+#include "plugins_types.h"
+#include "set.h"
+#include "tree.h"
+#include "tree_data.h"
+#include "tree_data_internal.h"
+#include "tree_data_sorted.h"
+#include "tree_schema.h"
+#include "validation.h"
+#include "xpath.h"
+
+/*
+ * The indexes are stored in the context, one ::lyd_index for every indexed leaf. Each index holds a hash table
+ * of ::lyd_index_inst records, one for every parent data node whose list instances were indexed. Such a record
+ * is created lazily, on the first index lookup for the parent, and is then maintained whenever a list instance
+ * or an indexed leaf is linked or unlinked or its value changes. Finally, there is a hash table of ::lyd_index_val
+ * buckets in every record, one for every distinct value of the leaf, and the bucket references all the list
+ * instances with this value. Since the records are created by lookups, which must be safe for concurrent readers
+ * of a data tree, the lookups are serialized by ::ly_ctx.data_index_lock.
+ */
+
+/*
+ * The instance index (::LY_CTX_INST_INDEX) is a single ::lyd_inst_index in the context with a hash table
+ * of ::lyd_inst_index_rec records, one for every schema node with some instances, hashed by the schema node name
+ * so that all the schema nodes of a name can be found. Every data node is added into it when created and removed
+ * when freed, regardless of being linked into a tree or not. The data nodes existing when the index is created are
+ * not in it, so the context counts all its data nodes and the index is not used until all these are freed.
+ */
+
+/*
+ * The when cache (::ly_ctx.when_cache) remembers the data nodes whose when conditions were evaluated to true during
+ * validation so that the conditions need not be evaluated again. Every schema node referenced by a cached condition,
+ * as learned by atomizing it, has a ::lyd_when_dep record with the generation of its last change. Whenever
+ * an instance of such a schema node is linked, unlinked, or its value changes, the generation of the record is set
+ * to the next generation of the cache. A cached result of a data node is valid as long as none of the dependencies
+ * of its conditions has changed since it was stored. Only the result of an unlinked node itself is forgotten, a relative
+ * reference of a condition of a node in its subtree that leaves the subtree passes through the unlinked node, whose
+ * schema node is then a dependency with a new generation.
+ */
+
+/*
+ * The children vectors (::ly_ctx.child_vec_ht) hold the children of an inner data node with many children in their
+ * order, in a treap with the subtree sizes counted in every node, together with a hash table of the treap node
+ * of every child, so that the position of a (leaf-)list instance is learned in logarithmic time instead of by
+ * traversing all its preceding instances. A vector is created lazily, on the first position lookup for a parent
+ * with at least ::LYD_CHILD_VEC_MIN_ITEMS children, and is then updated in logarithmic time whenever a child is
+ * linked after its previous sibling or unlinked. Opaque nodes, which are always the last, are not included.
+ */
+
+/**
+ * @brief Minimal number of children of a parent to create its children vector.
+ */
+#define LYD_CHILD_VEC_MIN_ITEMS 64
+
+/**
+ * @brief Treap node of a child in its children vector.
+ */
+struct lyd_child_tnode {
+    const struct lyd_node *node;    /**< child data node */
+    struct lyd_child_tnode *left;   /**< subtree of the preceding children */
+    struct lyd_child_tnode *right;  /**< subtree of the following children */
+    struct lyd_child_tnode *up;     /**< parent treap node, NULL for the root */
+    uint32_t prio;                  /**< random priority, not lower than the priorities of the whole subtree */
+    uint32_t size;                  /**< number of the nodes in the subtree */
+};
+
+/**
+ * @brief Children vector of a single parent data node.
+ */
+struct lyd_child_vec {
+    const struct lyd_node *parent;  /**< parent data node of the children */
+    struct lyd_child_tnode *root;   /**< root of the treap of the children with a schema node in their order */
+    struct lyd_child_tnode *block;  /**< treap nodes allocated at once when the vector was created */
+    uint32_t block_count;           /**< number of the nodes in @p block */
+    uint32_t seed;                  /**< state of the generator of the treap node priorities */
+    struct ly_ht *pos_ht;           /**< hash table of the treap nodes of the children (struct lyd_child_pos) */
+};
+
+/**
+ * @brief Treap node of a child in its children vector.
+ */
+struct lyd_child_pos {
+    const struct lyd_node *node;    /**< child data node */
+    struct lyd_child_tnode *tnode;  /**< treap node of @p node */
+};
+
+/**
+ * @brief Index of the data instances of all the schema nodes.
+ */
+struct lyd_inst_index {
+    struct ly_ht *schema_ht;        /**< hash table of instance records (struct lyd_inst_index_rec *) */
+    struct ly_ht *dflt_ht;          /**< hash table of records of leaf schema nodes with the parents (::LYD_DFLT_VIRTUAL)
+                                         where they may be virtual default leaves (struct lyd_inst_index_rec *) */
+    uint32_t opaq_count;            /**< number of existing opaque nodes, which cannot be indexed */
+    ly_bool unindexed;              /**< set if some existing data nodes may have been created before the index */
+    ly_bool invalid;                /**< set if the index failed to be updated and cannot be used */
+};
+
+/**
+ * @brief Instances of a single schema node.
+ */
+struct lyd_inst_index_rec {
+    const struct lysc_node *schema; /**< schema node of the instances */
+    struct ly_ht *insts_ht;         /**< hash table of the data instances (struct lyd_node *) */
+};
+
+/**
+ * @brief Bucket of list instances with the same indexed leaf value.
+ */
+struct lyd_index_val {
+    struct lyd_value value;         /**< indexed value */
+    struct lyd_node *entry;         /**< the only list instance with the value */
+    struct ly_ht *entries_ht;       /**< hash table of all the list instances (struct lyd_node *) with the value,
+                                         used instead of lyd_index_val.entry if there are more */
+};
+
+/**
+ * @brief Index of the list instances of a single parent data node.
+ */
+struct lyd_index_inst {
+    const struct lyd_node *parent;  /**< parent data node of the indexed list instances */
+    struct ly_ht *values_ht;        /**< hash table of value buckets (struct lyd_index_val *) */
+};
+
+/**
+ * @brief Secondary index of a list by its leaf.
+ */
+struct lyd_index {
+    const struct lysc_node *list;   /**< indexed list */
+    const struct lysc_node *leaf;   /**< leaf of @p list whose values are indexed */
+    struct ly_ht *parents_ht;       /**< hash table of indexed parents (struct lyd_index_inst *) */
+};
+
+/**
+ * @brief Schema node referenced by some cached when conditions.
+ */
+struct lyd_when_dep {
+    const struct lysc_node *schema; /**< referenced schema node */
+    uint64_t gen;                   /**< generation of the last change of an instance of @p schema */
+};
+
+/**
+ * @brief Dependencies of all the when conditions of a schema node.
+ */
+struct lyd_when_snode {
+    const struct lysc_node *schema; /**< schema node with when conditions */
+    struct lyd_when_dep **deps;     /**< referenced schema nodes ([sized array](@ref sizedarrays)) */
+    ly_bool invalid;                /**< set if the dependencies could not be learned and the results cannot be cached */
+};
+
+/**
+ * @brief Cached true result of the when conditions of a data node.
+ */
+struct lyd_when_node {
+    const struct lyd_node *node;    /**< data node with the when conditions */
+    const struct lyd_when_snode *snode; /**< dependencies of the conditions */
+    uint64_t gen;                   /**< generation of the cache when the result was stored */
+};
+
+/**
+ * @brief Cache of when condition results.
+ */
+struct lyd_when_cache {
+    pthread_mutex_t lock;           /**< lock for accessing the cache, it is shared by all the data trees */
+    uint64_t gen;                   /**< current generation, incremented on every change of a dependency */
+    struct ly_ht *deps_ht;          /**< hash table of dependency records (struct lyd_when_dep *) */
+    struct ly_ht *snodes_ht;        /**< hash table of schema node records (struct lyd_when_snode *) */
+    struct ly_ht *nodes_ht;         /**< hash table of cached results (struct lyd_when_node *) */
+};
+
+/**
+ * @brief Hash table value-equal callback for pointer records compared by identity.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_index_ptr_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    return *(void **)val1_p == *(void **)val2_p;
+}
+
+/**
+ * @brief Hash table value-equal callback for parent index records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_index_inst_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_index_inst *inst1 = *(struct lyd_index_inst **)val1_p, *inst2 = *(struct lyd_index_inst **)val2_p;
+
+    return inst1->parent == inst2->parent;
+}
+
+/**
+ * @brief Hash table value-equal callback for value buckets.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_index_val_equal_cb(void *val1_p, void *val2_p, ly_bool mod, void *cb_data)
+{
+    struct lyd_index_val *val1 = *(struct lyd_index_val **)val1_p, *val2 = *(struct lyd_index_val **)val2_p;
+    const struct ly_ctx *ctx = cb_data;
+
+    if (mod) {
+        return val1 == val2;
+    }
+
+    if (val1->value.realtype != val2->value.realtype) {
+        return 0;
+    }
+    return val1->value.realtype->plugin->compare(ctx, &val1->value, &val2->value) ? 0 : 1;
+}
+
+/**
+ * @brief Hash table value-equal callback for instance records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_inst_index_rec_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_inst_index_rec *rec1 = *(struct lyd_inst_index_rec **)val1_p, *rec2 = *(struct lyd_inst_index_rec **)val2_p;
+
+    return rec1->schema == rec2->schema;
+}
+
+/**
+ * @brief Get hash of a data node pointer.
+ *
+ * @param[in] ptr Pointer to hash.
+ * @return Hash.
+ */
+static uint32_t
+lyd_index_ptr_hash(const void *ptr)
+{
+    return lyht_hash((const char *)&ptr, sizeof ptr);
+}
+
+/**
+ * @brief Get hash of an indexed value, the same way as for leaf-list instances.
+ *
+ * @param[in] value Value to hash.
+ * @return Hash.
+ */
+static uint32_t
+lyd_index_val_hash(const struct lyd_value *value)
+{
+    const void *hash_key;
+    ly_bool dyn;
+    size_t key_len;
+    uint32_t hash;
+
+    hash_key = value->realtype->plugin->print(NULL, value, LY_VALUE_LYB, NULL, &dyn, &key_len);
+    hash = lyht_hash_multi(0, hash_key, key_len);
+    hash = lyht_hash_multi(hash, NULL, 0);
+    if (dyn) {
+        free((void *)hash_key);
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Free a value bucket.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] val Bucket to free.
+ */
+static void
+lyd_index_val_free(const struct ly_ctx *ctx, struct lyd_index_val *val)
+{
+    if (!val) {
+        return;
+    }
+
+    val->value.realtype->plugin->free(ctx, &val->value);
+    lyht_free(val->entries_ht, NULL);
+    free(val);
+}
+
+/**
+ * @brief Free a parent index record.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] inst Parent index record to free.
+ */
+static void
+lyd_index_inst_free(const struct ly_ctx *ctx, struct lyd_index_inst *inst)
+{
+    uint32_t hlist_idx, rec_idx;
+    struct ly_ht_rec *rec;
+
+    if (!inst) {
+        return;
+    }
+
+    LYHT_ITER_ALL_RECS(inst->values_ht, hlist_idx, rec_idx, rec) {
+        lyd_index_val_free(ctx, *(struct lyd_index_val **)&rec->val);
+    }
+    lyht_free(inst->values_ht, NULL);
+    free(inst);
+}
+
+/**
+ * @brief Free an index.
+ *
+ * @param[in] index Index to free.
+ */
+static void
+lyd_index_free(struct lyd_index *index)
+{
+    uint32_t hlist_idx, rec_idx;
+    struct ly_ht_rec *rec;
+
+    if (!index) {
+        return;
+    }
+
+    LYHT_ITER_ALL_RECS(index->parents_ht, hlist_idx, rec_idx, rec) {
+        lyd_index_inst_free(index->list->module->ctx, *(struct lyd_index_inst **)&rec->val);
+    }
+    lyht_free(index->parents_ht, NULL);
+    free(index);
+}
+
+/**
+ * @brief Find an index of a leaf.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] leaf Indexed leaf.
+ * @param[out] idx Optional index of the found index in the context set.
+ * @return Found index, NULL if there is none.
+ */
+static struct lyd_index *
+lyd_index_get(const struct ly_ctx *ctx, const struct lysc_node *leaf, uint32_t *idx)
+{
+    struct lyd_index *index;
+    uint32_t i;
+
+    for (i = 0; i < ctx->data_indexes.count; ++i) {
+        index = ctx->data_indexes.objs[i];
+        if (index->leaf == leaf) {
+            if (idx) {
+                *idx = i;
+            }
+            return index;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the parent index record of an index.
+ *
+ * @param[in] index Index to search in.
+ * @param[in] parent Parent data node of the list instances.
+ * @return Found parent index record, NULL if the parent instances were not indexed yet.
+ */
+static struct lyd_index_inst *
+lyd_index_inst_get(const struct lyd_index *index, const struct lyd_node *parent)
+{
+    struct lyd_index_inst inst = {.parent = parent}, *inst_p = &inst, **match_p;
+
+    if (lyht_find(index->parents_ht, &inst_p, lyd_index_ptr_hash(parent), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Add a list instance into a parent index record.
+ *
+ * @param[in] inst Parent index record.
+ * @param[in] leaf Indexed leaf instance.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_index_inst_add(struct lyd_index_inst *inst, const struct lyd_node_term *leaf)
+{
+    const struct ly_ctx *ctx = LYD_CTX(leaf);
+    struct lyd_node *entry = lyd_parent(&leaf->node);
+    struct lyd_index_val val = {0}, *val_p = &val, **match_p;
+    uint32_t hash;
+    LY_ERR r;
+
+    val.value = leaf->value;
+    hash = lyd_index_val_hash(&leaf->value);
+
+    if (!lyht_find(inst->values_ht, &val_p, hash, (void **)&match_p)) {
+        /* existing value bucket */
+        val_p = *match_p;
+        if (val_p->entry == entry) {
+            return LY_SUCCESS;
+        }
+
+        if (!val_p->entries_ht) {
+            /* second instance with this value */
+            val_p->entries_ht = lyht_new(LYHT_MIN_SIZE, sizeof entry, lyd_index_ptr_equal_cb, NULL, 1);
+            LY_CHECK_ERR_RET(!val_p->entries_ht, LOGMEM(ctx), LY_EMEM);
+            LY_CHECK_RET(lyht_insert(val_p->entries_ht, &val_p->entry, lyd_index_ptr_hash(val_p->entry), NULL));
+            val_p->entry = NULL;
+        }
+
+        r = lyht_insert(val_p->entries_ht, &entry, lyd_index_ptr_hash(entry), NULL);
+        if (r && (r != LY_EEXIST)) {
+            return r;
+        }
+        return LY_SUCCESS;
+    }
+
+    /* new value bucket */
+    val_p = calloc(1, sizeof *val_p);
+    LY_CHECK_ERR_RET(!val_p, LOGMEM(ctx), LY_EMEM);
+    r = ((struct lysc_node_leaf *)leaf->schema)->type->plugin->duplicate(ctx, &leaf->value, &val_p->value);
+    LY_CHECK_ERR_RET(r, free(val_p), r);
+    val_p->entry = entry;
+
+    r = lyht_insert(inst->values_ht, &val_p, hash, NULL);
+    LY_CHECK_ERR_RET(r, lyd_index_val_free(ctx, val_p), r);
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Remove a list instance from a parent index record.
+ *
+ * @param[in] inst Parent index record.
+ * @param[in] leaf Indexed leaf instance with the value the list instance is indexed by.
+ */
+static void
+lyd_index_inst_del(struct lyd_index_inst *inst, const struct lyd_node_term *leaf)
+{
+    const struct ly_ctx *ctx = LYD_CTX(leaf);
+    struct lyd_node *entry = lyd_parent(&leaf->node);
+    struct lyd_index_val val = {0}, *val_p = &val, **match_p;
+    uint32_t hash;
+
+    val.value = leaf->value;
+    hash = lyd_index_val_hash(&leaf->value);
+
+    if (lyht_find(inst->values_ht, &val_p, hash, (void **)&match_p)) {
+        /* not indexed */
+        return;
+    }
+    val_p = *match_p;
+
+    if (val_p->entries_ht) {
+        lyht_remove(val_p->entries_ht, &entry, lyd_index_ptr_hash(entry));
+        if (val_p->entries_ht->used) {
+            return;
+        }
+    } else if (val_p->entry != entry) {
+        return;
+    }
+
+    /* last instance with this value, remove the bucket */
+    lyht_remove(inst->values_ht, &val_p, hash);
+    lyd_index_val_free(ctx, val_p);
+}
+
+/**
+ * @brief Index all the list instances of a parent.
+ *
+ * @param[in] index Index to use.
+ * @param[in] parent Parent data node of the list instances.
+ * @param[out] inst_p Created parent index record.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_index_inst_create(struct lyd_index *index, const struct lyd_node *parent, struct lyd_index_inst **inst_p)
+{
+    const struct ly_ctx *ctx = index->list->module->ctx;
+    struct lyd_index_inst *inst;
+    struct lyd_node *entry, *leaf;
+    LY_ERR rc = LY_SUCCESS;
+
+    inst = calloc(1, sizeof *inst);
+    LY_CHECK_ERR_RET(!inst, LOGMEM(ctx), LY_EMEM);
+    inst->parent = parent;
+    inst->values_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_index_val *), lyd_index_val_equal_cb, (void *)ctx, 1);
+    LY_CHECK_ERR_GOTO(!inst->values_ht, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+
+    LYD_LIST_FOR_INST(lyd_child(parent), index->list, entry) {
+        if (!lyd_find_sibling_val_(lyd_child(entry), index->leaf, NULL, 0, &leaf)) {
+            LY_CHECK_GOTO(rc = lyd_index_inst_add(inst, (struct lyd_node_term *)leaf), cleanup);
+        }
+    }
+
+    LY_CHECK_GOTO(rc = lyht_insert(index->parents_ht, &inst, lyd_index_ptr_hash(parent), NULL), cleanup);
+
+cleanup:
+    if (rc) {
+        lyd_index_inst_free(ctx, inst);
+        inst = NULL;
+    }
+    *inst_p = inst;
+    return rc;
+}
+
+/**
+ * @brief Update all the relevant indexes after an indexed leaf instance was linked or unlinked, or before/after
+ * its value changed.
+ *
+ * @param[in] node Leaf instance, can be any data node.
+ * @param[in] add Whether to add or remove the list instance of @p node from the indexes.
+ */
+static void
+lyd_index_update_leaf(const struct lyd_node *node, ly_bool add)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    const struct lyd_node *entry;
+    struct lyd_index *index;
+    struct lyd_index_inst *inst;
+    uint32_t i;
+
+    entry = lyd_parent(node);
+    if (!entry || !entry->schema || (entry->schema->nodetype != LYS_LIST) || !lyd_parent(entry)) {
+        /* not an instance of an indexable list */
+        return;
+    }
+
+    for (i = 0; i < ctx->data_indexes.count; ++i) {
+        index = ctx->data_indexes.objs[i];
+        if (index->leaf != node->schema) {
+            continue;
+        }
+
+        inst = lyd_index_inst_get(index, lyd_parent(entry));
+        if (!inst) {
+            /* parent not indexed */
+            continue;
+        }
+
+        if (add) {
+            if (lyd_index_inst_add(inst, (struct lyd_node_term *)node)) {
+                /* the record is no longer reliable, it will be recreated when needed */
+                lyht_remove(index->parents_ht, &inst, lyd_index_ptr_hash(inst->parent));
+                lyd_index_inst_free(ctx, inst);
+            }
+        } else {
+            lyd_index_inst_del(inst, (struct lyd_node_term *)node);
+        }
+    }
+}
+
+/**
+ * @brief Hash table value-equal callback for children vectors.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_child_vec_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_child_vec *vec1 = *(struct lyd_child_vec **)val1_p, *vec2 = *(struct lyd_child_vec **)val2_p;
+
+    return vec1->parent == vec2->parent;
+}
+
+/**
+ * @brief Free a subtree of the treap of a children vector.
+ *
+ * @param[in] vec Children vector.
+ * @param[in] tnode Root of the subtree to free.
+ */
+static void
+lyd_child_tnode_free(struct lyd_child_vec *vec, struct lyd_child_tnode *tnode)
+{
+    if (!tnode) {
+        return;
+    }
+
+    lyd_child_tnode_free(vec, tnode->left);
+    lyd_child_tnode_free(vec, tnode->right);
+    if ((tnode < vec->block) || (tnode >= vec->block + vec->block_count)) {
+        free(tnode);
+    }
+}
+
+/**
+ * @brief Hash table free callback for children vectors.
+ */
+static void
+lyd_child_vec_rec_free(void *val_p)
+{
+    struct lyd_child_vec *vec = *(struct lyd_child_vec **)val_p;
+
+    lyht_free(vec->pos_ht, NULL);
+    lyd_child_tnode_free(vec, vec->root);
+    free(vec->block);
+    free(vec);
+}
+
+/**
+ * @brief Find the children vector of a parent.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] parent Parent data node.
+ * @return Found vector, NULL if there is none.
+ */
+static struct lyd_child_vec *
+lyd_child_vec_get(const struct ly_ctx *ctx, const struct lyd_node *parent)
+{
+    struct lyd_child_vec vec_key = {.parent = parent}, *vec_p = &vec_key, **match_p;
+
+    if (!ctx->child_vec_ht || lyht_find(ctx->child_vec_ht, &vec_p, lyd_index_ptr_hash(parent), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Remove the children vector of a parent and free it.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] vec Children vector to drop.
+ */
+static void
+lyd_child_vec_drop(const struct ly_ctx *ctx, struct lyd_child_vec *vec)
+{
+    lyht_remove(ctx->child_vec_ht, &vec, lyd_index_ptr_hash(vec->parent));
+    lyd_child_vec_rec_free(&vec);
+}
+
+/**
+ * @brief Get the size of a treap subtree.
+ *
+ * @param[in] tnode Root of the subtree, may be NULL.
+ * @return Number of the nodes in the subtree.
+ */
+static uint32_t
+lyd_child_tnode_size(const struct lyd_child_tnode *tnode)
+{
+    return tnode ? tnode->size : 0;
+}
+
+/**
+ * @brief Update the size of a treap node and the parent pointers of its children after they changed.
+ *
+ * @param[in] tnode Treap node to update.
+ */
+static void
+lyd_child_tnode_update(struct lyd_child_tnode *tnode)
+{
+    tnode->size = 1 + lyd_child_tnode_size(tnode->left) + lyd_child_tnode_size(tnode->right);
+    if (tnode->left) {
+        tnode->left->up = tnode;
+    }
+    if (tnode->right) {
+        tnode->right->up = tnode;
+    }
+}
+
+/**
+ * @brief Split a treap into the first nodes and the rest.
+ *
+ * @param[in] tnode Root of the treap to split, may be NULL.
+ * @param[in] count Number of the first nodes.
+ * @param[out] first Root of the treap of the first @p count nodes.
+ * @param[out] rest Root of the treap of the rest of the nodes.
+ */
+static void
+lyd_child_tnode_split(struct lyd_child_tnode *tnode, uint32_t count, struct lyd_child_tnode **first,
+        struct lyd_child_tnode **rest)
+{
+    if (!tnode) {
+        *first = NULL;
+        *rest = NULL;
+        return;
+    }
+
+    if (lyd_child_tnode_size(tnode->left) < count) {
+        lyd_child_tnode_split(tnode->right, count - lyd_child_tnode_size(tnode->left) - 1, &tnode->right, rest);
+        *first = tnode;
+    } else {
+        lyd_child_tnode_split(tnode->left, count, first, &tnode->left);
+        *rest = tnode;
+    }
+    lyd_child_tnode_update(tnode);
+    tnode->up = NULL;
+}
+
+/**
+ * @brief Merge 2 treaps, all the nodes of the first one precede the nodes of the second one.
+ *
+ * @param[in] first Root of the first treap, may be NULL.
+ * @param[in] second Root of the second treap, may be NULL.
+ * @return Root of the merged treap.
+ */
+static struct lyd_child_tnode *
+lyd_child_tnode_merge(struct lyd_child_tnode *first, struct lyd_child_tnode *second)
+{
+    if (!first || !second) {
+        return first ? first : second;
+    }
+
+    if (first->prio > second->prio) {
+        first->right = lyd_child_tnode_merge(first->right, second);
+        lyd_child_tnode_update(first);
+        first->up = NULL;
+        return first;
+    }
+
+    second->left = lyd_child_tnode_merge(first, second->left);
+    lyd_child_tnode_update(second);
+    second->up = NULL;
+    return second;
+}
+
+/**
+ * @brief Get the index of a node in its treap.
+ *
+ * @param[in] tnode Treap node.
+ * @return Number of the nodes preceding @p tnode.
+ */
+static uint32_t
+lyd_child_tnode_rank(const struct lyd_child_tnode *tnode)
+{
+    uint32_t rank = lyd_child_tnode_size(tnode->left);
+
+    for ( ; tnode->up; tnode = tnode->up) {
+        if (tnode == tnode->up->right) {
+            rank += lyd_child_tnode_size(tnode->up->left) + 1;
+        }
+    }
+
+    return rank;
+}
+
+/**
+ * @brief Find the treap node of a child.
+ *
+ * @param[in] vec Children vector.
+ * @param[in] node Child data node.
+ * @return Treap node of @p node, NULL if there is none.
+ */
+static struct lyd_child_tnode *
+lyd_child_vec_find(const struct lyd_child_vec *vec, const struct lyd_node *node)
+{
+    struct lyd_child_pos pos_key = {.node = node}, *pos = &pos_key;
+
+    if (lyht_find(vec->pos_ht, pos, lyd_index_ptr_hash(node), (void **)&pos)) {
+        return NULL;
+    }
+    return pos->tnode;
+}
+
+/**
+ * @brief Insert a child into a children vector.
+ *
+ * @param[in] vec Children vector.
+ * @param[in] tnode Treap node of the child to insert, only @p tnode->node is expected to be set.
+ * @param[in] idx Index to insert the child on.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_child_vec_insert(struct lyd_child_vec *vec, struct lyd_child_tnode *tnode, uint32_t idx)
+{
+    struct lyd_child_pos pos = {.node = tnode->node, .tnode = tnode};
+    struct lyd_child_tnode *first, *rest;
+
+    LY_CHECK_RET(lyht_insert(vec->pos_ht, &pos, lyd_index_ptr_hash(tnode->node), NULL));
+
+    /* xorshift priority */
+    vec->seed ^= vec->seed << 13;
+    vec->seed ^= vec->seed >> 17;
+    vec->seed ^= vec->seed << 5;
+    tnode->prio = vec->seed;
+    tnode->left = tnode->right = tnode->up = NULL;
+    tnode->size = 1;
+
+    if (idx == lyd_child_tnode_size(vec->root)) {
+        /* append */
+        vec->root = lyd_child_tnode_merge(vec->root, tnode);
+    } else {
+        lyd_child_tnode_split(vec->root, idx, &first, &rest);
+        vec->root = lyd_child_tnode_merge(lyd_child_tnode_merge(first, tnode), rest);
+    }
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Create the children vector of a parent.
+ *
+ * Is expected to be called with ::ly_ctx.data_index_lock held.
+ *
+ * @param[in] parent Parent data node with enough children.
+ * @param[out] vec_p Created children vector.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_child_vec_create(const struct lyd_node *parent, struct lyd_child_vec **vec_p)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)LYD_CTX(parent);
+    struct lyd_child_vec *vec;
+    struct lyd_node *child;
+    uint32_t count;
+
+    *vec_p = NULL;
+
+    if (!ctx->child_vec_ht) {
+        ctx->child_vec_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_child_vec *), lyd_child_vec_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RET(!ctx->child_vec_ht, LOGMEM(ctx), LY_EMEM);
+    }
+
+    count = ((struct lyd_node_inner *)parent)->children_ht->used;
+    vec = calloc(1, sizeof *vec);
+    LY_CHECK_ERR_RET(!vec, LOGMEM(ctx), LY_EMEM);
+    vec->parent = parent;
+    vec->seed = lyd_index_ptr_hash(parent) | 1;
+    vec->block = malloc(count * sizeof *vec->block);
+    vec->pos_ht = lyht_new(lyht_get_fixed_size(count), sizeof(struct lyd_child_pos), lyd_index_ptr_equal_cb, NULL, 1);
+    LY_CHECK_GOTO(!vec->block || !vec->pos_ht, error);
+
+    LY_LIST_FOR(lyd_child(parent), child) {
+        if (!child->schema) {
+            break;
+        }
+        assert(vec->block_count < count);
+        vec->block[vec->block_count].node = child;
+        LY_CHECK_GOTO(lyd_child_vec_insert(vec, &vec->block[vec->block_count], vec->block_count), error);
+        ++vec->block_count;
+    }
+
+    LY_CHECK_GOTO(lyht_insert(ctx->child_vec_ht, &vec, lyd_index_ptr_hash(parent), NULL), error);
+    *vec_p = vec;
+    return LY_SUCCESS;
+
+error:
+    lyd_child_vec_rec_free(&vec);
+    LOGMEM(ctx);
+    return LY_EMEM;
+}
+
+uint32_t
+lyd_child_vec_list_pos(const struct lyd_node *instance)
+{
+    const struct ly_ctx *ctx = LYD_CTX(instance);
+    const struct lyd_node *parent = lyd_parent(instance);
+    struct lyd_child_vec *vec;
+    struct lyd_child_tnode *tnode, *first_tnode;
+    struct lyd_node *first;
+    uint32_t ret = 0;
+
+    if (!parent->schema || !((struct lyd_node_inner *)parent)->children_ht ||
+            (((struct lyd_node_inner *)parent)->children_ht->used < LYD_CHILD_VEC_MIN_ITEMS)) {
+        /* few children, traversing them is fine */
+        return 0;
+    }
+
+    /* first instance from the parent hash table */
+    if (lyd_find_sibling_schema(lyd_child(parent), instance->schema, &first)) {
+        return 0;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    vec = lyd_child_vec_get(ctx, parent);
+    if (!vec && lyd_child_vec_create(parent, &vec)) {
+        goto cleanup;
+    }
+
+    tnode = lyd_child_vec_find(vec, instance);
+    first_tnode = lyd_child_vec_find(vec, first);
+    if (!tnode || !first_tnode) {
+        goto cleanup;
+    }
+
+    ret = lyd_child_tnode_rank(tnode) - lyd_child_tnode_rank(first_tnode) + 1;
+
+cleanup:
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+    return ret;
+}
+
+/**
+ * @brief Update the children vector of the parent of a node after it was linked or before it is unlinked.
+ *
+ * @param[in] node Child data node.
+ * @param[in] add Whether @p node was linked or is being unlinked.
+ */
+static void
+lyd_child_vec_update(const struct lyd_node *node, ly_bool add)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_child_vec *vec;
+    struct lyd_child_tnode *tnode, *prev, *first, *rest;
+    uint32_t idx;
+    ly_bool keep = 0;
+
+    if (!ctx->child_vec_ht || !ctx->child_vec_ht->used || !lyd_parent(node) || !node->schema) {
+        return;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    vec = lyd_child_vec_get(ctx, lyd_parent(node));
+    if (!vec) {
+        goto cleanup;
+    }
+
+    if (add) {
+        /* inserted right after its previous sibling */
+        if (lyd_child(lyd_parent(node)) == node) {
+            idx = 0;
+        } else if ((prev = lyd_child_vec_find(vec, node->prev))) {
+            idx = lyd_child_tnode_rank(prev) + 1;
+        } else {
+            goto cleanup;
+        }
+
+        tnode = malloc(sizeof *tnode);
+        if (tnode) {
+            tnode->node = node;
+            if (lyd_child_vec_insert(vec, tnode, idx)) {
+                free(tnode);
+            } else {
+                keep = 1;
+            }
+        }
+    } else if ((tnode = lyd_child_vec_find(vec, node))) {
+        /* split the node off */
+        idx = lyd_child_tnode_rank(tnode);
+        lyd_child_tnode_split(vec->root, idx, &first, &rest);
+        lyd_child_tnode_split(rest, 1, &tnode, &rest);
+        vec->root = lyd_child_tnode_merge(first, rest);
+        keep = !lyht_remove(vec->pos_ht, &node, lyd_index_ptr_hash(node));
+
+        lyd_child_tnode_free(vec, tnode);
+    }
+
+cleanup:
+    if (vec && !keep) {
+        /* the vector does not match the children */
+        lyd_child_vec_drop(ctx, vec);
+    }
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+}
+
+/**
+ * @brief Free the children vector of a parent node that is being freed.
+ *
+ * @param[in] node Inner data node being freed.
+ */
+static void
+lyd_child_vec_free_parent(const struct lyd_node *node)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_child_vec *vec;
+
+    if (!ctx->child_vec_ht || !ctx->child_vec_ht->used || !(vec = lyd_child_vec_get(ctx, node))) {
+        return;
+    }
+
+    lyd_child_vec_drop(ctx, vec);
+}
+
+void
+lyd_child_vec_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->child_vec_ht, lyd_child_vec_rec_free);
+    ctx->child_vec_ht = NULL;
+}
+
+/**
+ * @brief Update all the relevant indexes after a list instance was linked or before it is unlinked.
+ *
+ * @param[in] node List instance, can be any data node.
+ * @param[in] add Whether to add or remove @p node from the indexes.
+ */
+static void
+lyd_index_update_entry(const struct lyd_node *node, ly_bool add)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_index *index;
+    struct lyd_index_inst *inst;
+    struct lyd_node *leaf;
+    uint32_t i;
+
+    if ((node->schema->nodetype != LYS_LIST) || !lyd_parent(node)) {
+        return;
+    }
+
+    for (i = 0; i < ctx->data_indexes.count; ++i) {
+        index = ctx->data_indexes.objs[i];
+        if (index->list != node->schema) {
+            continue;
+        }
+
+        inst = lyd_index_inst_get(index, lyd_parent(node));
+        if (!inst || lyd_find_sibling_val_(lyd_child(node), index->leaf, NULL, 0, &leaf)) {
+            /* parent not indexed or no leaf to index by */
+            continue;
+        }
+
+        if (add) {
+            if (lyd_index_inst_add(inst, (struct lyd_node_term *)leaf)) {
+                lyht_remove(index->parents_ht, &inst, lyd_index_ptr_hash(inst->parent));
+                lyd_index_inst_free(ctx, inst);
+            }
+        } else {
+            lyd_index_inst_del(inst, (struct lyd_node_term *)leaf);
+        }
+    }
+}
+
+void
+lyd_index_insert(const struct lyd_node *node)
+{
+    lyd_cons_update(node, 1);
+    lyd_dflt_virtual_insert(node);
+    lyd_child_vec_update(node, 1);
+
+    if (!node->schema || !LYD_CTX(node)->data_indexes.count) {
+        return;
+    }
+
+    if (node->schema->nodetype == LYS_LIST) {
+        lyd_index_update_entry(node, 1);
+    } else if (node->schema->nodetype == LYS_LEAF) {
+        lyd_index_update_leaf(node, 1);
+    }
+}
+
+void
+lyd_index_unlink(const struct lyd_node *node)
+{
+    lyd_cons_update(node, 0);
+    lyd_child_vec_update(node, 0);
+
+    if (!node->schema || !LYD_CTX(node)->data_indexes.count) {
+        return;
+    }
+
+    if (node->schema->nodetype == LYS_LIST) {
+        lyd_index_update_entry(node, 0);
+    } else if (node->schema->nodetype == LYS_LEAF) {
+        lyd_index_update_leaf(node, 0);
+    }
+}
+
+void
+lyd_index_free_parent(const struct lyd_node *node)
+{
+    const struct ly_ctx *ctx;
+    struct lyd_index *index;
+    struct lyd_index_inst *inst;
+    uint32_t i;
+
+    lyd_cons_free_parent(node);
+    lyd_dflt_virtual_free_parent(node);
+    lyd_child_vec_free_parent(node);
+    lyd_lyb_stub_free_node(node);
+
+    if (!node->schema || !LYD_CTX(node)->data_indexes.count) {
+        return;
+    }
+
+    ctx = LYD_CTX(node);
+    for (i = 0; i < ctx->data_indexes.count; ++i) {
+        index = ctx->data_indexes.objs[i];
+        if (lysc_data_parent(index->list) != node->schema) {
+            continue;
+        }
+
+        inst = lyd_index_inst_get(index, node);
+        if (inst) {
+            lyht_remove(index->parents_ht, &inst, lyd_index_ptr_hash(node));
+            lyd_index_inst_free(ctx, inst);
+        }
+    }
+}
+
+/**
+ * @brief Free an instance record.
+ *
+ * @param[in] rec Record to free.
+ */
+static void
+lyd_inst_index_rec_free(struct lyd_inst_index_rec *rec)
+{
+    lyht_free(rec->insts_ht, NULL);
+    free(rec);
+}
+
+/**
+ * @brief Free all the instance records of schema nodes of a module.
+ *
+ * @param[in] ht Hash table of instance records.
+ * @param[in] mod Module whose compiled schema nodes are being freed.
+ */
+static void
+lyd_inst_index_free_module(struct ly_ht *ht, const struct lys_module *mod)
+{
+    struct lyd_inst_index_rec *irec;
+    struct ly_ht_rec *rec;
+    uint32_t hlist_idx, rec_idx;
+    ly_bool found;
+
+    do {
+        found = 0;
+        LYHT_ITER_ALL_RECS(ht, hlist_idx, rec_idx, rec) {
+            irec = *(struct lyd_inst_index_rec **)&rec->val;
+            if (irec->schema->module == mod) {
+                found = 1;
+                break;
+            }
+        }
+
+        if (found) {
+            /* removing records while iterating is not possible */
+            lyht_remove(ht, &irec, lyd_index_ptr_hash(irec->schema->name));
+            lyd_inst_index_rec_free(irec);
+        }
+    } while (found);
+}
+
+void
+lyd_index_free_module(struct ly_ctx *ctx, const struct lys_module *mod)
+{
+    struct lyd_index *index;
+    uint32_t i;
+
+    i = 0;
+    while (i < ctx->data_indexes.count) {
+        index = ctx->data_indexes.objs[i];
+        if (!mod || (index->list->module == mod) || (index->leaf->module == mod)) {
+            lyd_index_free(index);
+            ly_set_rm_index(&ctx->data_indexes, i, NULL);
+        } else {
+            ++i;
+        }
+    }
+
+    if (!ctx->data_indexes.count) {
+        ly_set_erase(&ctx->data_indexes, NULL);
+    }
+
+    if (mod && ctx->inst_index) {
+        lyd_inst_index_free_module(ctx->inst_index->schema_ht, mod);
+        lyd_inst_index_free_module(ctx->inst_index->dflt_ht, mod);
+    }
+
+    if (mod && ctx->cons_states_ht && ctx->cons_states_ht->used) {
+        /* the states are recreated when needed */
+        lyd_cons_free(ctx);
+        lyd_cons_new(ctx);
+    }
+
+    if (mod && ctx->when_cache && ctx->when_cache->snodes_ht->used) {
+        /* the dependencies are learned again when needed */
+        lyd_when_cache_free(ctx);
+        lyd_when_cache_new(ctx);
+    }
+}
+
+ly_bool
+lyd_index_exists(const struct lysc_node *leaf)
+{
+    return lyd_index_get(leaf->module->ctx, leaf, NULL) ? 1 : 0;
+}
+
+/**
+ * @brief Sort list instances comparator, for instances supported by lyds.
+ */
+static int
+lyd_index_entry_cmp(const void *ptr1, const void *ptr2)
+{
+    struct lyd_node *node1 = *(struct lyd_node **)ptr1, *node2 = *(struct lyd_node **)ptr2;
+
+    return lyds_compare_single(node1, node2);
+}
+
+LY_ERR
+lyd_index_find(const struct lyd_node *parent, const struct lysc_node *leaf, const struct lyd_value *value,
+        struct ly_set *entries)
+{
+    LY_ERR rc = LY_SUCCESS;
+    const struct ly_ctx *ctx = leaf->module->ctx;
+    struct lyd_index *index;
+    struct lyd_index_inst *inst;
+    struct lyd_index_val val = {0}, *val_p = &val, **match_p;
+    struct lyd_node *iter;
+    struct ly_ht_rec *rec;
+    uint32_t hlist_idx, rec_idx, start;
+
+    index = lyd_index_get(ctx, leaf, NULL);
+    if (!index) {
+        return LY_ENOT;
+    }
+
+    if (!parent || (parent->schema != lysc_data_parent(index->list))) {
+        /* no instances */
+        return LY_SUCCESS;
+    }
+
+    /* LOCK */
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    /* get the parent index, create it if not yet */
+    inst = lyd_index_inst_get(index, parent);
+    if (!inst) {
+        LY_CHECK_GOTO(rc = lyd_index_inst_create(index, parent, &inst), cleanup);
+    }
+
+    /* find the value bucket */
+    val.value = *value;
+    if (lyht_find(inst->values_ht, &val_p, lyd_index_val_hash(value), (void **)&match_p)) {
+        /* no instances with this value */
+        goto cleanup;
+    }
+    val_p = *match_p;
+
+    if (!val_p->entries_ht) {
+        rc = ly_set_add(entries, val_p->entry, 1, NULL);
+        goto cleanup;
+    }
+
+    /* collect all the instances */
+    start = entries->count;
+    LYHT_ITER_ALL_RECS(val_p->entries_ht, hlist_idx, rec_idx, rec) {
+        LY_CHECK_GOTO(rc = ly_set_add(entries, *(struct lyd_node **)&rec->val, 1, NULL), cleanup);
+    }
+
+    if (lyds_is_supported(entries->dnodes[start])) {
+        /* sorted by the keys */
+        qsort(&entries->dnodes[start], entries->count - start, sizeof *entries->dnodes, lyd_index_entry_cmp);
+    } else {
+        /* user-ordered, learn the order from the siblings */
+        entries->count = start;
+        LYD_LIST_FOR_INST(lyd_child(parent), index->list, iter) {
+            if (!lyht_find(val_p->entries_ht, &iter, lyd_index_ptr_hash(iter), NULL)) {
+                LY_CHECK_GOTO(rc = ly_set_add(entries, iter, 1, NULL), cleanup);
+            }
+        }
+    }
+
+cleanup:
+    /* UNLOCK */
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+    return rc;
+}
+
+LY_ERR
+lyd_inst_index_new(struct ly_ctx *ctx)
+{
+    struct lyd_inst_index *index;
+
+    assert(!ctx->inst_index);
+
+    index = calloc(1, sizeof *index);
+    LY_CHECK_ERR_RET(!index, LOGMEM(ctx), LY_EMEM);
+
+    index->schema_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_inst_index_rec *), lyd_inst_index_rec_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RET(!index->schema_ht, free(index); LOGMEM(ctx), LY_EMEM);
+    index->dflt_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_inst_index_rec *), lyd_inst_index_rec_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RET(!index->dflt_ht, lyht_free(index->schema_ht, NULL); free(index); LOGMEM(ctx), LY_EMEM);
+
+    /* data nodes of any existing data trees are not indexed */
+    index->unindexed = ATOMIC_LOAD_RELAXED(ctx->data_unindexed) ? 1 : 0;
+
+    ctx->inst_index = index;
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Free all the instance records in a hash table and the table itself.
+ *
+ * @param[in] ht Hash table of instance records.
+ */
+static void
+lyd_inst_index_ht_free(struct ly_ht *ht)
+{
+    struct ly_ht_rec *rec;
+    uint32_t hlist_idx, rec_idx;
+
+    LYHT_ITER_ALL_RECS(ht, hlist_idx, rec_idx, rec) {
+        lyd_inst_index_rec_free(*(struct lyd_inst_index_rec **)&rec->val);
+    }
+    lyht_free(ht, NULL);
+}
+
+void
+lyd_inst_index_free(struct ly_ctx *ctx)
+{
+    if (!ctx->inst_index) {
+        return;
+    }
+
+    if (ctx->inst_index->invalid || ctx->inst_index->unindexed || ctx->inst_index->opaq_count ||
+            ctx->inst_index->schema_ht->used) {
+        /* indexed data nodes remain, they would be missing in a new index */
+        ATOMIC_STORE_RELAXED(ctx->data_unindexed, 1);
+    }
+
+    lyd_inst_index_ht_free(ctx->inst_index->schema_ht);
+    lyd_inst_index_ht_free(ctx->inst_index->dflt_ht);
+    free(ctx->inst_index);
+    ctx->inst_index = NULL;
+}
+
+/**
+ * @brief Add a data node into the record of a schema node.
+ *
+ * @param[in] ht Hash table of instance records.
+ * @param[in] schema Schema node of the record.
+ * @param[in] node Data node to add, is not added again if already in the record.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_inst_index_rec_add(struct ly_ht *ht, const struct lysc_node *schema, const struct lyd_node *node)
+{
+    struct lyd_inst_index_rec irec = {0}, *irec_p = &irec, **match_p;
+    uint32_t hash;
+    LY_ERR rc;
+
+    /* find the schema node record */
+    irec.schema = schema;
+    hash = lyd_index_ptr_hash(schema->name);
+    if (lyht_find(ht, &irec_p, hash, (void **)&match_p)) {
+        /* first instance, create it */
+        irec_p = calloc(1, sizeof *irec_p);
+        LY_CHECK_RET(!irec_p, LY_EMEM);
+        irec_p->schema = schema;
+        irec_p->insts_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_node *), lyd_index_ptr_equal_cb, NULL, 1);
+        LY_CHECK_ERR_RET(!irec_p->insts_ht, free(irec_p), LY_EMEM);
+        LY_CHECK_ERR_RET(lyht_insert(ht, &irec_p, hash, NULL), lyd_inst_index_rec_free(irec_p), LY_EMEM);
+    } else {
+        irec_p = *match_p;
+    }
+
+    /* add the instance */
+    rc = lyht_insert(irec_p->insts_ht, &node, lyd_index_ptr_hash(node), NULL);
+    return (rc == LY_EEXIST) ? LY_SUCCESS : rc;
+}
+
+/**
+ * @brief Remove a data node from the record of a schema node.
+ *
+ * @param[in] ht Hash table of instance records.
+ * @param[in] schema Schema node of the record.
+ * @param[in] node Data node to remove, it may not be in the record if created before the index.
+ */
+static void
+lyd_inst_index_rec_del(struct ly_ht *ht, const struct lysc_node *schema, const struct lyd_node *node)
+{
+    struct lyd_inst_index_rec irec = {0}, *irec_p = &irec, **match_p;
+    uint32_t hash, node_hash;
+
+    irec.schema = schema;
+    hash = lyd_index_ptr_hash(schema->name);
+    if (lyht_find(ht, &irec_p, hash, (void **)&match_p)) {
+        return;
+    }
+    irec_p = *match_p;
+
+    node_hash = lyd_index_ptr_hash(node);
+    if (lyht_find(irec_p->insts_ht, &node, node_hash, NULL)) {
+        return;
+    }
+    lyht_remove(irec_p->insts_ht, &node, node_hash);
+    if (!irec_p->insts_ht->used) {
+        /* last instance */
+        lyht_remove(ht, &irec_p, hash);
+        lyd_inst_index_rec_free(irec_p);
+    }
+}
+
+/**
+ * @brief Add or remove a parent of virtual default leaves in the records of all its leaves that may be virtual.
+ *
+ * @param[in] index Instance index.
+ * @param[in] parent Parent data node marked with ::LYD_DFLT_VIRTUAL.
+ * @param[in] add Whether to add or remove @p parent.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_inst_index_dflt_update(struct lyd_inst_index *index, const struct lyd_node *parent, ly_bool add)
+{
+    const struct lysc_node *snode;
+
+    LY_LIST_FOR(lysc_node_child(parent->schema), snode) {
+        if (!lyd_dflt_virtual_allowed(parent, snode)) {
+            continue;
+        }
+
+        if (add) {
+            LY_CHECK_RET(lyd_inst_index_rec_add(index->dflt_ht, snode, parent));
+        } else {
+            lyd_inst_index_rec_del(index->dflt_ht, snode, parent);
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+void
+lyd_inst_index_add(const struct lyd_node *node)
+{
+    struct lyd_inst_index *index = LYD_CTX(node)->inst_index;
+
+    if (!index) {
+        /* any index created later would miss this node, no read-modify-write needed */
+        if (!ATOMIC_LOAD_RELAXED(LYD_CTX(node)->data_unindexed)) {
+            ATOMIC_STORE_RELAXED(((struct ly_ctx *)LYD_CTX(node))->data_unindexed, 1);
+        }
+        return;
+    } else if (index->invalid) {
+        return;
+    }
+
+    if (!node->schema) {
+        ++index->opaq_count;
+        return;
+    }
+
+    LY_CHECK_GOTO(lyd_inst_index_rec_add(index->schema_ht, node->schema, node), error);
+    if ((node->flags & LYD_DFLT_VIRTUAL) && (node->schema->nodetype & LYD_NODE_INNER)) {
+        LY_CHECK_GOTO(lyd_inst_index_dflt_update(index, node, 1), error);
+    }
+    return;
+
+error:
+    /* the index is incomplete, never use it */
+    LOGMEM(LYD_CTX(node));
+    index->invalid = 1;
+}
+
+void
+lyd_inst_index_dflt_parent(const struct lyd_node *parent)
+{
+    struct lyd_inst_index *index = LYD_CTX(parent)->inst_index;
+
+    if (!index || index->invalid) {
+        return;
+    }
+
+    if (lyd_inst_index_dflt_update(index, parent, 1)) {
+        /* the index is incomplete, never use it */
+        LOGMEM(LYD_CTX(parent));
+        index->invalid = 1;
+    }
+}
+
+void
+lyd_inst_index_del(const struct lyd_node *node)
+{
+    struct lyd_inst_index *index = LYD_CTX(node)->inst_index;
+
+    if (!index || index->invalid) {
+        return;
+    }
+
+    if (!node->schema) {
+        if (index->opaq_count) {
+            --index->opaq_count;
+        }
+        return;
+    }
+
+    lyd_inst_index_rec_del(index->schema_ht, node->schema, node);
+    if ((node->flags & LYD_DFLT_VIRTUAL) && (node->schema->nodetype & LYD_NODE_INNER)) {
+        lyd_inst_index_dflt_update(index, node, 0);
+    }
+}
+
+LY_ERR
+lyd_inst_index_find(const struct ly_ctx *ctx, const struct lys_module *mod, const char *name, struct ly_set *insts)
+{
+    const struct lyd_inst_index *index = ctx->inst_index;
+    struct lyd_inst_index_rec *irec;
+    struct ly_ht_rec *rec, *irec_rec;
+    struct lyd_node *node, *parent, *vnode;
+    uint32_t hash, rec_idx, hlist_idx, irec_idx;
+
+    if (!index || index->invalid || index->opaq_count || index->unindexed || ctx->ext_clb) {
+        /* index not usable, opaque nodes, nodes created before the index, or nested data of other contexts could be
+         * missed */
+        return LY_ENOT;
+    }
+
+    /* go through all the records with the same hash, there may be several schema nodes with the name */
+    hash = lyd_index_ptr_hash(name);
+    LYHT_ITER_HLIST_RECS(index->schema_ht, hash & (index->schema_ht->size - 1), rec_idx, rec) {
+        irec = *(struct lyd_inst_index_rec **)&rec->val;
+        if ((rec->hash != hash) || (irec->schema->name != name) || (mod && (irec->schema->module != mod))) {
+            continue;
+        }
+
+        LYHT_ITER_ALL_RECS(irec->insts_ht, hlist_idx, irec_idx, irec_rec) {
+            node = *(struct lyd_node **)&irec_rec->val;
+            if ((node->flags & LYD_DFLT_VIRTUAL) && (node->schema->nodetype & LYD_NODE_TERM)) {
+                /* virtual default leaf, found using its parent unless replaced */
+                continue;
+            }
+            LY_CHECK_RET(ly_set_add(insts, node, 1, NULL));
+        }
+    }
+
+    /* virtual default leaves (::LYD_DFLT_VIRTUAL) of the parents where they may be */
+    LYHT_ITER_HLIST_RECS(index->dflt_ht, hash & (index->dflt_ht->size - 1), rec_idx, rec) {
+        irec = *(struct lyd_inst_index_rec **)&rec->val;
+        if ((rec->hash != hash) || (irec->schema->name != name) || (mod && (irec->schema->module != mod))) {
+            continue;
+        }
+
+        LYHT_ITER_ALL_RECS(irec->insts_ht, hlist_idx, irec_idx, irec_rec) {
+            parent = *(struct lyd_node **)&irec_rec->val;
+            if (!lyd_find_sibling_val_(lyd_child(parent), irec->schema, NULL, 0, NULL) ||
+                    lyd_dflt_virtual_get(parent, irec->schema, &vnode)) {
+                /* there is a real instance */
+                continue;
+            }
+            LY_CHECK_RET(ly_set_add(insts, vnode, 1, NULL));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_index_add(const struct lysc_node *leaf)
+{
+    struct ly_ctx *ctx;
+    const struct lysc_node *list;
+    struct lyd_index *index;
+    LY_ERR rc;
+
+    LY_CHECK_ARG_RET(NULL, leaf, LY_EINVAL);
+    ctx = leaf->module->ctx;
+
+    list = lysc_data_parent(leaf);
+    if ((leaf->nodetype != LYS_LEAF) || !list || (list->nodetype != LYS_LIST)) {
+        LOGERR(ctx, LY_EINVAL, "Node \"%s\" is not a leaf of a list.", leaf->name);
+        return LY_EINVAL;
+    } else if (leaf->flags & LYS_KEY) {
+        LOGERR(ctx, LY_EINVAL, "Leaf \"%s\" is a list key, instances are always found by hashes.", leaf->name);
+        return LY_EINVAL;
+    } else if (!lysc_data_parent(list)) {
+        LOGERR(ctx, LY_EINVAL, "Indexing instances of top-level list \"%s\" is not supported.", list->name);
+        return LY_EINVAL;
+    }
+
+    if (lyd_index_get(ctx, leaf, NULL)) {
+        /* already indexed */
+        return LY_SUCCESS;
+    }
+
+    index = calloc(1, sizeof *index);
+    LY_CHECK_ERR_RET(!index, LOGMEM(ctx), LY_EMEM);
+    index->list = list;
+    index->leaf = leaf;
+    index->parents_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_index_inst *), lyd_index_inst_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RET(!index->parents_ht, free(index); LOGMEM(ctx), LY_EMEM);
+
+    rc = ly_set_add(&ctx->data_indexes, index, 1, NULL);
+    LY_CHECK_ERR_RET(rc, lyd_index_free(index), rc);
+
+    return LY_SUCCESS;
+}
+
+LIBYANG_API_DEF LY_ERR
+lyd_index_remove(const struct lysc_node *leaf)
+{
+    struct ly_ctx *ctx;
+    struct lyd_index *index;
+    uint32_t i;
+
+    LY_CHECK_ARG_RET(NULL, leaf, LY_EINVAL);
+    ctx = leaf->module->ctx;
+
+    index = lyd_index_get(ctx, leaf, &i);
+    if (!index) {
+        return LY_ENOTFOUND;
+    }
+
+    lyd_index_free(index);
+    ly_set_rm_index(&ctx->data_indexes, i, NULL);
+    if (!ctx->data_indexes.count) {
+        ly_set_erase(&ctx->data_indexes, NULL);
+    }
+
+    return LY_SUCCESS;
+}
+
+/*
+ * List constraint states (::LY_CTX_LIST_CONSTRAINTS) are ::lyd_cons_state records, one for every parent data node
+ * and its (leaf-)list with min-elements, max-elements, or unique constraints, kept in ::lyd_cons_parent records
+ * in a context hash table. A state is created by the first validation of the instances and then maintained whenever
+ * an instance is linked or unlinked. For lists with uniques, every instance is also in a ::lyd_cons_bucket of every
+ * unique, with all the instances with the same unique values. Any change of the unique leaves of an instance only
+ * removes it from its buckets and marks it as dirty, it is hashed again by the next validation. The states are
+ * shared by all the data trees of the context so they are accessed only with ::ly_ctx.data_index_lock held.
+ */
+
+/**
+ * @brief Instance in a list constraint state.
+ */
+struct lyd_cons_entry {
+    const struct lyd_node *node;        /**< (leaf-)list instance */
+    struct lyd_cons_bucket **buckets;   /**< bucket of every list unique, NULL if some of its values are missing */
+    ly_bool dirty;                      /**< set if the entry is not in the buckets because it has changed */
+};
+
+/**
+ * @brief Bucket of list instances with the same values of a unique.
+ */
+struct lyd_cons_bucket {
+    uint32_t hash;                      /**< hash of the unique values */
+    struct ly_set entries;              /**< entries with the values (struct lyd_cons_entry *) */
+};
+
+/**
+ * @brief Buckets of a single list unique.
+ */
+struct lyd_cons_uniq {
+    const struct lysc_node_leaf **leaves;   /**< unique leaves */
+    struct ly_ht *buckets_ht;           /**< hash table of buckets (struct lyd_cons_bucket *) */
+};
+
+/**
+ * @brief Constraint state of the instances of a single (leaf-)list.
+ */
+struct lyd_cons_state {
+    const struct lysc_node *schema;     /**< schema node of the instances */
+    struct ly_ht *entries_ht;           /**< hash table of all the instances (struct lyd_cons_entry *) */
+    struct lyd_cons_uniq *uniqs;        /**< buckets of every list unique ([sized array](@ref sizedarrays)) */
+    struct ly_set dirty;                /**< dirty entries (struct lyd_cons_entry *) */
+    uint32_t dup_count;                 /**< number of buckets with more than one entry */
+};
+
+/**
+ * @brief Constraint states of the (leaf-)list instances of a single parent data node.
+ */
+struct lyd_cons_parent {
+    const struct lyd_node *parent;      /**< parent data node of the instances */
+    struct ly_set states;               /**< constraint states (struct lyd_cons_state *) */
+};
+
+/**
+ * @brief Hash table value-equal callback for constraint state parents.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_cons_parent_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_cons_parent *par1 = *(struct lyd_cons_parent **)val1_p, *par2 = *(struct lyd_cons_parent **)val2_p;
+
+    return par1->parent == par2->parent;
+}
+
+/**
+ * @brief Hash table value-equal callback for constraint state entries.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_cons_entry_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_cons_entry *entry1 = *(struct lyd_cons_entry **)val1_p, *entry2 = *(struct lyd_cons_entry **)val2_p;
+
+    return entry1->node == entry2->node;
+}
+
+/**
+ * @brief Hash table value-equal callback for unique buckets, compares the unique values of their first entries.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_cons_bucket_equal_cb(void *val1_p, void *val2_p, ly_bool mod, void *cb_data)
+{
+    struct lyd_cons_bucket *bucket1 = *(struct lyd_cons_bucket **)val1_p, *bucket2 = *(struct lyd_cons_bucket **)val2_p;
+    const struct lysc_node_leaf **leaves = cb_data;
+    const struct lyd_node *list1, *list2;
+    const struct lyd_value *val1, *val2;
+    LY_ARRAY_COUNT_TYPE u;
+
+    if (mod) {
+        return bucket1 == bucket2;
+    }
+
+    list1 = ((struct lyd_cons_entry *)bucket1->entries.objs[0])->node;
+    list2 = ((struct lyd_cons_entry *)bucket2->entries.objs[0])->node;
+    LY_ARRAY_FOR(leaves, u) {
+        val1 = lyd_val_uniq_value(leaves[u], list1);
+        val2 = lyd_val_uniq_value(leaves[u], list2);
+        if (val1->realtype->plugin->compare(leaves[u]->module->ctx, val1, val2)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Hash table free callback for unique buckets.
+ *
+ * @param[in] val_p Pointer to the bucket pointer.
+ */
+static void
+lyd_cons_bucket_free(void *val_p)
+{
+    struct lyd_cons_bucket *bucket = *(struct lyd_cons_bucket **)val_p;
+
+    ly_set_erase(&bucket->entries, NULL);
+    free(bucket);
+}
+
+/**
+ * @brief Hash table free callback for constraint state entries.
+ *
+ * @param[in] val_p Pointer to the entry pointer.
+ */
+static void
+lyd_cons_entry_free(void *val_p)
+{
+    struct lyd_cons_entry *entry = *(struct lyd_cons_entry **)val_p;
+
+    free(entry->buckets);
+    free(entry);
+}
+
+/**
+ * @brief Free a constraint state.
+ *
+ * @param[in] state_p State to free.
+ */
+static void
+lyd_cons_state_free(void *state_p)
+{
+    struct lyd_cons_state *state = state_p;
+    LY_ARRAY_COUNT_TYPE u;
+
+    if (!state) {
+        return;
+    }
+
+    LY_ARRAY_FOR(state->uniqs, u) {
+        lyht_free(state->uniqs[u].buckets_ht, lyd_cons_bucket_free);
+    }
+    LY_ARRAY_FREE(state->uniqs);
+    lyht_free(state->entries_ht, lyd_cons_entry_free);
+    ly_set_erase(&state->dirty, NULL);
+    free(state);
+}
+
+/**
+ * @brief Hash table free callback for constraint state parents.
+ *
+ * @param[in] val_p Pointer to the parent record pointer.
+ */
+static void
+lyd_cons_parent_free(void *val_p)
+{
+    struct lyd_cons_parent *par = *(struct lyd_cons_parent **)val_p;
+
+    ly_set_erase(&par->states, lyd_cons_state_free);
+    free(par);
+}
+
+/**
+ * @brief Get the constraint states of a parent.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] parent Parent data node of the instances.
+ * @return Found parent record, NULL if there is none.
+ */
+static struct lyd_cons_parent *
+lyd_cons_parent_get(const struct ly_ctx *ctx, const struct lyd_node *parent)
+{
+    struct lyd_cons_parent par_key = {.parent = parent}, *par_p = &par_key, **match_p;
+
+    if (!ctx->cons_states_ht->used ||
+            lyht_find(ctx->cons_states_ht, &par_p, lyd_index_ptr_hash(parent), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Get a constraint state.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] parent Parent data node of the instances.
+ * @param[in] schema Schema node of the instances.
+ * @param[out] par_p Optional parent record of the state.
+ * @return Found state, NULL if there is none.
+ */
+static struct lyd_cons_state *
+lyd_cons_state_get(const struct ly_ctx *ctx, const struct lyd_node *parent, const struct lysc_node *schema,
+        struct lyd_cons_parent **par_p)
+{
+    struct lyd_cons_parent *par;
+    struct lyd_cons_state *state;
+    uint32_t i;
+
+    par = lyd_cons_parent_get(ctx, parent);
+    if (par_p) {
+        *par_p = par;
+    }
+    if (!par) {
+        return NULL;
+    }
+
+    for (i = 0; i < par->states.count; ++i) {
+        state = par->states.objs[i];
+        if (state->schema == schema) {
+            return state;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Remove and free a constraint state that can no longer be maintained, it will be created again when needed.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] parent Parent data node of the instances.
+ * @param[in] state State to drop.
+ */
+static void
+lyd_cons_state_drop(const struct ly_ctx *ctx, const struct lyd_node *parent, struct lyd_cons_state *state)
+{
+    struct lyd_cons_parent *par;
+
+    par = lyd_cons_parent_get(ctx, parent);
+    assert(par);
+
+    ly_set_rm(&par->states, state, lyd_cons_state_free);
+    if (!par->states.count) {
+        lyht_remove(ctx->cons_states_ht, &par, lyd_index_ptr_hash(parent));
+        lyd_cons_parent_free(&par);
+    }
+}
+
+/**
+ * @brief Find a constraint state entry.
+ *
+ * @param[in] state Constraint state.
+ * @param[in] node Instance of the entry.
+ * @return Found entry, NULL if there is none.
+ */
+static struct lyd_cons_entry *
+lyd_cons_entry_get(const struct lyd_cons_state *state, const struct lyd_node *node)
+{
+    struct lyd_cons_entry entry_key = {.node = node}, *entry_p = &entry_key, **match_p;
+
+    if (lyht_find(state->entries_ht, &entry_p, lyd_index_ptr_hash(node), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Remove an entry from all its unique buckets.
+ *
+ * @param[in] state Constraint state.
+ * @param[in] entry Entry to remove.
+ */
+static void
+lyd_cons_entry_unhash(struct lyd_cons_state *state, struct lyd_cons_entry *entry)
+{
+    struct lyd_cons_bucket *bucket;
+    LY_ARRAY_COUNT_TYPE u;
+
+    LY_ARRAY_FOR(state->uniqs, u) {
+        bucket = entry->buckets[u];
+        if (!bucket) {
+            continue;
+        }
+        entry->buckets[u] = NULL;
+
+        ly_set_rm(&bucket->entries, entry, NULL);
+        if (bucket->entries.count == 1) {
+            --state->dup_count;
+        } else if (!bucket->entries.count) {
+            lyht_remove(state->uniqs[u].buckets_ht, &bucket, bucket->hash);
+            lyd_cons_bucket_free(&bucket);
+        }
+    }
+}
+
+/**
+ * @brief Remove an entry from all its unique buckets and mark it as dirty.
+ *
+ * @param[in] state Constraint state.
+ * @param[in] entry Entry to mark.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_cons_entry_dirty(struct lyd_cons_state *state, struct lyd_cons_entry *entry)
+{
+    if (entry->dirty) {
+        return LY_SUCCESS;
+    }
+
+    lyd_cons_entry_unhash(state, entry);
+    entry->dirty = 1;
+    return ly_set_add(&state->dirty, entry, 1, NULL);
+}
+
+/**
+ * @brief Add a new instance into a constraint state.
+ *
+ * @param[in] state Constraint state.
+ * @param[in] node Instance to add.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_cons_entry_add(struct lyd_cons_state *state, const struct lyd_node *node)
+{
+    struct lyd_cons_entry *entry;
+
+    if (lyd_cons_entry_get(state, node)) {
+        /* already added */
+        return LY_SUCCESS;
+    }
+
+    entry = calloc(1, sizeof *entry);
+    LY_CHECK_RET(!entry, LY_EMEM);
+    entry->node = node;
+    if (state->uniqs) {
+        entry->buckets = calloc(LY_ARRAY_COUNT(state->uniqs), sizeof *entry->buckets);
+        LY_CHECK_ERR_RET(!entry->buckets, free(entry), LY_EMEM);
+    }
+
+    if (lyht_insert_no_check(state->entries_ht, &entry, lyd_index_ptr_hash(node), NULL)) {
+        lyd_cons_entry_free(&entry);
+        return LY_EMEM;
+    }
+
+    if (state->uniqs) {
+        /* to be hashed by its unique values */
+        LY_CHECK_RET(lyd_cons_entry_dirty(state, entry));
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Remove an instance from a constraint state.
+ *
+ * @param[in] state Constraint state.
+ * @param[in] node Instance to remove.
+ */
+static void
+lyd_cons_entry_del(struct lyd_cons_state *state, const struct lyd_node *node)
+{
+    struct lyd_cons_entry *entry;
+
+    entry = lyd_cons_entry_get(state, node);
+    if (!entry) {
+        return;
+    }
+
+    if (entry->dirty) {
+        ly_set_rm(&state->dirty, entry, NULL);
+    } else {
+        lyd_cons_entry_unhash(state, entry);
+    }
+
+    lyht_remove(state->entries_ht, &entry, lyd_index_ptr_hash(node));
+    lyd_cons_entry_free(&entry);
+}
+
+/**
+ * @brief Hash all the dirty entries of a constraint state by their unique values.
+ *
+ * @param[in] state Constraint state.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_cons_dirty_hash(struct lyd_cons_state *state)
+{
+    struct lyd_cons_entry *entry;
+    struct lyd_cons_bucket bucket_key = {0}, *bucket_p = &bucket_key, *bucket, **match_p;
+    void *entry_p;
+    LY_ARRAY_COUNT_TYPE u;
+    uint32_t hash;
+
+    bucket_key.entries.count = 1;
+    bucket_key.entries.objs = &entry_p;
+
+    while (state->dirty.count) {
+        entry = state->dirty.objs[state->dirty.count - 1];
+        entry_p = entry;
+
+        LY_ARRAY_FOR(state->uniqs, u) {
+            if (lyd_val_uniq_hash(state->uniqs[u].leaves, entry->node, &hash)) {
+                /* incomplete unique values */
+                continue;
+            }
+
+            if (!lyht_find(state->uniqs[u].buckets_ht, &bucket_p, hash, (void **)&match_p)) {
+                /* instances with the same values */
+                bucket = *match_p;
+                LY_CHECK_RET(ly_set_add(&bucket->entries, entry, 1, NULL));
+                if (bucket->entries.count == 2) {
+                    ++state->dup_count;
+                }
+            } else {
+                /* new bucket */
+                bucket = calloc(1, sizeof *bucket);
+                LY_CHECK_RET(!bucket, LY_EMEM);
+                bucket->hash = hash;
+                if (ly_set_add(&bucket->entries, entry, 1, NULL) ||
+                        lyht_insert_no_check(state->uniqs[u].buckets_ht, &bucket, hash, NULL)) {
+                    lyd_cons_bucket_free(&bucket);
+                    return LY_EMEM;
+                }
+            }
+            entry->buckets[u] = bucket;
+        }
+
+        entry->dirty = 0;
+        --state->dirty.count;
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Get a constraint state, create it if it does not exist.
+ *
+ * @param[in] parent Parent data node of the instances.
+ * @param[in] snode Schema node of the instances.
+ * @return Constraint state, NULL if it cannot be used.
+ */
+static struct lyd_cons_state *
+lyd_cons_state_get_create(const struct lyd_node *parent, const struct lysc_node *snode)
+{
+    const struct ly_ctx *ctx = snode->module->ctx;
+    const struct lysc_node_list *slist = (const struct lysc_node_list *)snode;
+    struct lyd_cons_parent *par;
+    struct lyd_cons_state *state;
+    struct lyd_cons_uniq *uniq;
+    struct lyd_node *iter;
+    LY_ARRAY_COUNT_TYPE u;
+    LY_ERR rc = LY_SUCCESS;
+
+    if (!ctx->cons_states_ht || !parent->schema || (LYD_CTX(parent) != ctx)) {
+        /* not maintained for extension data with a parent from another context */
+        return NULL;
+    }
+
+    state = lyd_cons_state_get(ctx, parent, snode, &par);
+    if (state) {
+        return state;
+    }
+
+    state = calloc(1, sizeof *state);
+    LY_CHECK_ERR_RET(!state, LOGMEM(ctx), NULL);
+    state->schema = snode;
+    state->entries_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_cons_entry *), lyd_cons_entry_equal_cb, NULL, 1);
+    LY_CHECK_ERR_GOTO(!state->entries_ht, rc = LY_EMEM, cleanup);
+
+    if (snode->nodetype == LYS_LIST) {
+        LY_ARRAY_FOR(slist->uniques, u) {
+            LY_ARRAY_NEW_GOTO(ctx, state->uniqs, uniq, rc, cleanup);
+            uniq->leaves = (const struct lysc_node_leaf **)slist->uniques[u];
+            uniq->buckets_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_cons_bucket *), lyd_cons_bucket_equal_cb,
+                    (void *)uniq->leaves, 1);
+            LY_CHECK_ERR_GOTO(!uniq->buckets_ht, rc = LY_EMEM, cleanup);
+        }
+    }
+
+    LYD_LIST_FOR_INST(lyd_child(parent), snode, iter) {
+        LY_CHECK_GOTO(rc = lyd_cons_entry_add(state, iter), cleanup);
+    }
+
+    if (!par) {
+        /* new parent record */
+        par = calloc(1, sizeof *par);
+        LY_CHECK_ERR_GOTO(!par, rc = LY_EMEM, cleanup);
+        par->parent = parent;
+        rc = lyht_insert(ctx->cons_states_ht, &par, lyd_index_ptr_hash(parent), NULL);
+        LY_CHECK_ERR_GOTO(rc, free(par), cleanup);
+    }
+    rc = ly_set_add(&par->states, state, 1, NULL);
+
+cleanup:
+    if (rc) {
+        LOGMEM(ctx);
+        lyd_cons_state_free(state);
+        state = NULL;
+    }
+    return state;
+}
+
+LY_ERR
+lyd_cons_count(const struct lyd_node *parent, const struct lysc_node *snode, uint32_t *count)
+{
+    const struct ly_ctx *ctx = snode->module->ctx;
+    struct lyd_cons_state *state;
+    LY_ERR rc = LY_SUCCESS;
+
+    if (!ctx->cons_states_ht) {
+        return LY_ENOT;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    state = lyd_cons_state_get_create(parent, snode);
+    if (!state) {
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+
+    *count = state->entries_ht->used;
+
+cleanup:
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+    return rc;
+}
+
+LY_ERR
+lyd_cons_unique(const struct lyd_node *parent, const struct lysc_node *snode, ly_bool *dup)
+{
+    const struct ly_ctx *ctx = snode->module->ctx;
+    struct lyd_cons_state *state;
+    LY_ERR rc = LY_SUCCESS;
+
+    if (!ctx->cons_states_ht) {
+        return LY_ENOT;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    state = lyd_cons_state_get_create(parent, snode);
+    if (!state) {
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+
+    if (lyd_cons_dirty_hash(state)) {
+        lyd_cons_state_drop(ctx, parent, state);
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+
+    *dup = state->dup_count ? 1 : 0;
+
+cleanup:
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+    return rc;
+}
+
+/**
+ * @brief Update the constraint states after a data node was linked or unlinked.
+ *
+ * Is expected to be called with ::ly_ctx.data_index_lock held.
+ *
+ * @param[in] node Linked or unlinked data node.
+ * @param[in] add Whether @p node was linked or unlinked.
+ */
+static void
+lyd_cons_update_node(const struct lyd_node *node, ly_bool add)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    const struct lyd_node *entry;
+    struct lyd_cons_state *state;
+    struct lyd_cons_entry *cons_entry;
+
+    if (node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+        /* (leaf-)list instance */
+        state = lyd_cons_state_get(ctx, lyd_parent(node), node->schema, NULL);
+        if (!state) {
+            return;
+        }
+
+        if (!add) {
+            lyd_cons_entry_del(state, node);
+        } else if (lyd_cons_entry_add(state, node)) {
+            lyd_cons_state_drop(ctx, lyd_parent(node), state);
+        }
+        return;
+    } else if (!(node->schema->nodetype & (LYS_CONTAINER | LYS_LEAF))) {
+        return;
+    }
+
+    /* a node of a list instance, may be or include a unique leaf */
+    for (entry = lyd_parent(node); entry && entry->schema && (entry->schema->nodetype == LYS_CONTAINER);
+            entry = lyd_parent(entry)) {}
+    if (!entry || !entry->schema || (entry->schema->nodetype != LYS_LIST) ||
+            !((struct lysc_node_list *)entry->schema)->uniques || !lyd_parent(entry)) {
+        return;
+    }
+
+    state = lyd_cons_state_get(ctx, lyd_parent(entry), entry->schema, NULL);
+    if (state && (cons_entry = lyd_cons_entry_get(state, entry))) {
+        if (lyd_cons_entry_dirty(state, cons_entry)) {
+            lyd_cons_state_drop(ctx, lyd_parent(entry), state);
+        }
+    }
+}
+
+void
+lyd_cons_update(const struct lyd_node *node, ly_bool add)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+
+    if (!node->schema || !ctx->cons_states_ht || !lyd_parent(node)) {
+        return;
+    }
+
+    /* the states are shared by all the data trees of the context */
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+    lyd_cons_update_node(node, add);
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+}
+
+void
+lyd_cons_free_parent(const struct lyd_node *node)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_cons_parent *par;
+
+    if (!ctx->cons_states_ht) {
+        return;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+    if ((par = lyd_cons_parent_get(ctx, node))) {
+        lyht_remove(ctx->cons_states_ht, &par, lyd_index_ptr_hash(node));
+        lyd_cons_parent_free(&par);
+    }
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+}
+
+LY_ERR
+lyd_cons_new(struct ly_ctx *ctx)
+{
+    assert(!ctx->cons_states_ht);
+
+    ctx->cons_states_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_cons_parent *), lyd_cons_parent_equal_cb, NULL, 1);
+    LY_CHECK_ERR_RET(!ctx->cons_states_ht, LOGMEM(ctx), LY_EMEM);
+
+    return LY_SUCCESS;
+}
+
+void
+lyd_cons_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->cons_states_ht, lyd_cons_parent_free);
+    ctx->cons_states_ht = NULL;
+}
+
+/**
+ * @brief Hash table value-equal callback for when cache records, compares their first member.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_when_rec_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    return **(void ***)val1_p == **(void ***)val2_p;
+}
+
+/**
+ * @brief Hash table free callback for when cache records without any allocated members.
+ */
+static void
+lyd_when_rec_free(void *val_p)
+{
+    free(*(void **)val_p);
+}
+
+/**
+ * @brief Hash table free callback for schema node records.
+ */
+static void
+lyd_when_snode_free(void *val_p)
+{
+    struct lyd_when_snode *snode = *(struct lyd_when_snode **)val_p;
+
+    LY_ARRAY_FREE(snode->deps);
+    free(snode);
+}
+
+/**
+ * @brief Find a when cache record.
+ *
+ * @param[in] ht Hash table of the records.
+ * @param[in] key Key pointer of the record, its first member.
+ * @return Found record, NULL if there is none.
+ */
+static void *
+lyd_when_rec_get(struct ly_ht *ht, const void *key)
+{
+    const void *key_rec = key, **key_p = &key_rec;
+    void **match_p;
+
+    if (lyht_find(ht, &key_p, lyd_index_ptr_hash(key), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Add all the schema nodes referenced by a when condition into the dependencies of a schema node.
+ *
+ * @param[in] cache When cache.
+ * @param[in] snode Schema node record to update.
+ * @param[in] when When condition to atomize.
+ * @param[in] schema Schema node with @p when.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_when_snode_add_deps(struct lyd_when_cache *cache, struct lyd_when_snode *snode, const struct lysc_when *when,
+        const struct lysc_node *schema)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_set xp_set = {0};
+    struct lyd_when_dep *dep, **dep_p;
+    LY_ARRAY_COUNT_TYPE v;
+    uint32_t i, opts;
+
+    opts = LYXP_SCNODE_SCHEMA | ((schema->flags & LYS_IS_OUTPUT) ? LYXP_SCNODE_OUTPUT : 0);
+    LY_CHECK_GOTO(rc = lyxp_atomize(schema->module->ctx, when->cond, schema->module, LY_VALUE_SCHEMA_RESOLVED,
+            when->prefixes, when->context, when->context, &xp_set, opts), cleanup);
+
+    for (i = 0; i < xp_set.used; ++i) {
+        if ((xp_set.val.scnodes[i].type != LYXP_NODE_ELEM) ||
+                ((xp_set.val.scnodes[i].in_ctx == LYXP_SET_SCNODE_START_USED) &&
+                (xp_set.val.scnodes[i].scnode == snode->schema))) {
+            /* not a referenced data node, the node itself forgets its result when unlinked */
+            continue;
+        }
+
+        /* get the dependency record */
+        dep = lyd_when_rec_get(cache->deps_ht, xp_set.val.scnodes[i].scnode);
+        if (!dep) {
+            dep = calloc(1, sizeof *dep);
+            LY_CHECK_ERR_GOTO(!dep, rc = LY_EMEM, cleanup);
+            dep->schema = xp_set.val.scnodes[i].scnode;
+            if (lyht_insert_no_check(cache->deps_ht, &dep, lyd_index_ptr_hash(dep->schema), NULL)) {
+                free(dep);
+                rc = LY_EMEM;
+                goto cleanup;
+            }
+        }
+
+        /* add it once */
+        LY_ARRAY_FOR(snode->deps, v) {
+            if (snode->deps[v] == dep) {
+                break;
+            }
+        }
+        if (v == LY_ARRAY_COUNT(snode->deps)) {
+            LY_ARRAY_NEW_GOTO(schema->module->ctx, snode->deps, dep_p, rc, cleanup);
+            *dep_p = dep;
+        }
+    }
+
+cleanup:
+    lyxp_set_free_content(&xp_set);
+    return rc;
+}
+
+/**
+ * @brief Get the dependencies of the when conditions of a schema node, learn them if not yet known.
+ *
+ * @param[in] cache When cache.
+ * @param[in] schema Schema node with when conditions.
+ * @return Schema node record, NULL on memory allocation error.
+ */
+static struct lyd_when_snode *
+lyd_when_snode_get(struct lyd_when_cache *cache, const struct lysc_node *schema)
+{
+    struct lyd_when_snode *snode;
+    const struct lysc_node *iter;
+    struct lysc_when **when_list;
+    LY_ARRAY_COUNT_TYPE u;
+
+    snode = lyd_when_rec_get(cache->snodes_ht, schema);
+    if (snode) {
+        return snode;
+    }
+
+    snode = calloc(1, sizeof *snode);
+    LY_CHECK_RET(!snode, NULL);
+    snode->schema = schema;
+
+    /* the same conditions as evaluated by validation, including those of the choice and case parents */
+    iter = schema;
+    do {
+        when_list = lysc_node_when(iter);
+        LY_ARRAY_FOR(when_list, u) {
+            if (lyd_when_snode_add_deps(cache, snode, when_list[u], iter)) {
+                snode->invalid = 1;
+                break;
+            }
+        }
+
+        iter = iter->parent;
+    } while (!snode->invalid && iter && (iter->nodetype & (LYS_CASE | LYS_CHOICE)));
+
+    if (lyht_insert_no_check(cache->snodes_ht, &snode, lyd_index_ptr_hash(schema), NULL)) {
+        lyd_when_snode_free(&snode);
+        return NULL;
+    }
+    return snode;
+}
+
+/**
+ * @brief Forget a cached result of a data node, if any.
+ *
+ * @param[in] cache When cache.
+ * @param[in] node Data node with the result.
+ */
+static void
+lyd_when_node_del(struct lyd_when_cache *cache, const struct lyd_node *node)
+{
+    struct lyd_when_node *wnode;
+
+    wnode = lyd_when_rec_get(cache->nodes_ht, node);
+    if (wnode) {
+        lyht_remove(cache->nodes_ht, &wnode, lyd_index_ptr_hash(node));
+        free(wnode);
+    }
+}
+
+ly_bool
+lyd_when_cache_valid(const struct lyd_node *node)
+{
+    struct lyd_when_cache *cache = LYD_CTX(node)->when_cache;
+    struct lyd_when_node *wnode;
+    LY_ARRAY_COUNT_TYPE u;
+    ly_bool valid = 0;
+
+    if (!cache || !(node->flags & LYD_WHEN_TRUE) || !cache->nodes_ht->used) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    wnode = lyd_when_rec_get(cache->nodes_ht, node);
+    if (wnode && (wnode->snode->schema == node->schema)) {
+        valid = 1;
+        LY_ARRAY_FOR(wnode->snode->deps, u) {
+            if (wnode->snode->deps[u]->gen > wnode->gen) {
+                /* a dependency changed since */
+                valid = 0;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return valid;
+}
+
+void
+lyd_when_cache_store(const struct lyd_node *node)
+{
+    struct lyd_when_cache *cache = LYD_CTX(node)->when_cache;
+    struct lyd_when_snode *snode;
+    struct lyd_when_node *wnode;
+
+    if (!cache) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    snode = lyd_when_snode_get(cache, node->schema);
+    if (!snode || snode->invalid) {
+        goto cleanup;
+    }
+
+    wnode = lyd_when_rec_get(cache->nodes_ht, node);
+    if (!wnode) {
+        wnode = calloc(1, sizeof *wnode);
+        LY_CHECK_GOTO(!wnode, cleanup);
+        wnode->node = node;
+        if (lyht_insert_no_check(cache->nodes_ht, &wnode, lyd_index_ptr_hash(node), NULL)) {
+            free(wnode);
+            goto cleanup;
+        }
+    }
+    wnode->snode = snode;
+    wnode->gen = cache->gen;
+
+cleanup:
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void
+lyd_when_cache_change(const struct lyd_node *node)
+{
+    struct lyd_when_cache *cache = LYD_CTX(node)->when_cache;
+    struct lyd_when_dep *dep;
+
+    if (!cache || !node->schema || !cache->deps_ht->used) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    dep = lyd_when_rec_get(cache->deps_ht, node->schema);
+    if (dep) {
+        dep->gen = ++cache->gen;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void
+lyd_when_cache_unlink(const struct lyd_node *node)
+{
+    struct lyd_when_cache *cache = LYD_CTX(node)->when_cache;
+    struct lyd_when_dep *dep;
+
+    if (!cache || !node->schema ||
+            (!cache->deps_ht->used && (!(node->flags & LYD_WHEN_TRUE) || !cache->nodes_ht->used))) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    dep = lyd_when_rec_get(cache->deps_ht, node->schema);
+    if (dep) {
+        dep->gen = ++cache->gen;
+    }
+    if (node->flags & LYD_WHEN_TRUE) {
+        lyd_when_node_del(cache, node);
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void
+lyd_when_cache_del(const struct lyd_node *node)
+{
+    struct lyd_when_cache *cache = LYD_CTX(node)->when_cache;
+
+    if (!cache || !(node->flags & LYD_WHEN_TRUE) || !cache->nodes_ht->used) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    lyd_when_node_del(cache, node);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+LY_ERR
+lyd_when_cache_new(struct ly_ctx *ctx)
+{
+    struct lyd_when_cache *cache;
+
+    assert(!ctx->when_cache);
+
+    cache = calloc(1, sizeof *cache);
+    LY_CHECK_ERR_RET(!cache, LOGMEM(ctx), LY_EMEM);
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->deps_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_when_dep *), lyd_when_rec_equal_cb, NULL, 1);
+    cache->snodes_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_when_snode *), lyd_when_rec_equal_cb, NULL, 1);
+    cache->nodes_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_when_node *), lyd_when_rec_equal_cb, NULL, 1);
+
+    ctx->when_cache = cache;
+    if (!cache->deps_ht || !cache->snodes_ht || !cache->nodes_ht) {
+        lyd_when_cache_free(ctx);
+        LOGMEM(ctx);
+        return LY_EMEM;
+    }
+
+    return LY_SUCCESS;
+}
+
+void
+lyd_when_cache_free(struct ly_ctx *ctx)
+{
+    struct lyd_when_cache *cache = ctx->when_cache;
+
+    if (!cache) {
+        return;
+    }
+
+    lyht_free(cache->nodes_ht, lyd_when_rec_free);
+    lyht_free(cache->snodes_ht, lyd_when_snode_free);
+    lyht_free(cache->deps_ht, lyd_when_rec_free);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+    ctx->when_cache = NULL;
+}
@@ -33,6 +33,8 @@ struct lysc_module;
 #define LY_JSON_SUFFIX_LEN 5
 #define LY_LYB_SUFFIX ".lyb"
 #define LY_LYB_SUFFIX_LEN 4
+#define LY_CBOR_SUFFIX ".cbor"
+#define LY_CBOR_SUFFIX_LEN 5
 
 /**
  * @brief Internal item structure for remembering "used" instances of duplicate node instances.
@@ -130,6 +132,48 @@ const struct lys_module *lyd_data_next_module(struct lyd_node **next, struct lyd
  */
 LY_ERR lyd_find_sibling_schema(const struct lyd_node *siblings, const struct lysc_node *schema, struct lyd_node **match);
 
+/**
+ * @brief Search in the given siblings (NOT recursively) for the first target instance with the same value.
+ * Unlike ::lyd_find_sibling_first(), virtual default leaves (::LYD_DFLT_VIRTUAL) are never found.
+ *
+ * @param[in] siblings Siblings to search in including preceding and succeeding nodes.
+ * @param[in] target Target node to find.
+ * @param[out] match Can be NULL, otherwise the found data node.
+ * @return LY_SUCCESS on success, @p match set.
+ * @return LY_ENOTFOUND if not found, @p match set to NULL.
+ * @return LY_ERR value if another error occurred.
+ */
+LY_ERR lyd_find_sibling_first_(const struct lyd_node *siblings, const struct lyd_node *target, struct lyd_node **match);
+
+/**
+ * @brief Search in the given siblings for the first schema instance.
+ * Unlike ::lyd_find_sibling_val(), virtual default leaves (::LYD_DFLT_VIRTUAL) are never found.
+ *
+ * @param[in] siblings Siblings to search in including preceding and succeeding nodes.
+ * @param[in] schema Schema node of the data node to find.
+ * @param[in] key_or_value Optional key or value of the instance, see ::lyd_find_sibling_val().
+ * @param[in] val_len Optional length of @p key_or_value in case it is not 0-terminated.
+ * @param[out] match Can be NULL, otherwise the found data node.
+ * @return LY_SUCCESS on success, @p match set.
+ * @return LY_ENOTFOUND if not found, @p match set to NULL.
+ * @return LY_ERR value if another error occurred.
+ */
+LY_ERR lyd_find_sibling_val_(const struct lyd_node *siblings, const struct lysc_node *schema, const char *key_or_value,
+        size_t val_len, struct lyd_node **match);
+
+/**
+ * @brief Compare 2 data nodes of the same tree based on their position in the document order (preorder DFS).
+ *
+ * Only the parents of both nodes and their siblings between the nodes are traversed.
+ *
+ * @param[in] node1 First node to compare.
+ * @param[in] node2 Second node to compare.
+ * @return Negative number if @p node1 precedes @p node2,
+ * @return Zero if the nodes are the same,
+ * @return Positive number if @p node1 follows @p node2.
+ */
+int lyd_node_doc_order_cmp(const struct lyd_node *node1, const struct lyd_node *node2);
+
 /**
  * @brief Check whether a node to be deleted is the root node, move it if it is.
  *
@@ -660,6 +704,27 @@ ly_bool lyd_hash_table_val_equal(void *val1_p, void *val2_p, ly_bool mod, void *
  */
 LY_ERR lyd_insert_hash(struct lyd_node *node);
 
+/**
+ * @brief Learn the size of the children hash table of a frozen node, see ::lyd_freeze().
+ *
+ * @param[in] first First child of the frozen node.
+ * @param[out] size Number of records of the hash table.
+ * @return Size of the memory of the hash table, 0 if it is not needed.
+ */
+size_t lyd_hash_table_frozen_size(const struct lyd_node *first, uint32_t *size);
+
+/**
+ * @brief Create the children hash table of a frozen node with all its children in a preallocated memory.
+ *
+ * The hash table is never resized and is freed with the memory of the frozen tree.
+ *
+ * @param[in] parent Frozen inner node with all its children.
+ * @param[in] size Number of records of the hash table learned by ::lyd_hash_table_frozen_size().
+ * @param[in] mem Memory of the hash table.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_hash_table_frozen_create(struct lyd_node *parent, uint32_t size, void *mem);
+
 /**
  * @brief Maintain node's parent's children hash table when unlinking the node.
  *
@@ -671,6 +736,359 @@ void lyd_unlink_hash(struct lyd_node *node);
 
 /** @} datahash */
 
+/**
+ * @defgroup dataindex Secondary data indexes manipulation
+ * @ingroup datatree
+ * @{
+ */
+
+/**
+ * @brief Update secondary indexes after a node was linked to its parent.
+ *
+ * @param[in] node Linked data node.
+ */
+void lyd_index_insert(const struct lyd_node *node);
+
+/**
+ * @brief Update secondary indexes before a node is unlinked from its parent or its value is changed.
+ *
+ * @param[in] node Data node being unlinked.
+ */
+void lyd_index_unlink(const struct lyd_node *node);
+
+/**
+ * @brief Free all the secondary index records of the list instances of a parent node that is being freed.
+ *
+ * @param[in] node Inner data node being freed.
+ */
+void lyd_index_free_parent(const struct lyd_node *node);
+
+/**
+ * @brief Free all the secondary indexes defined for schema nodes of a module.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] mod Module whose compiled schema nodes are being freed, NULL for all the indexes.
+ */
+void lyd_index_free_module(struct ly_ctx *ctx, const struct lys_module *mod);
+
+/**
+ * @brief Learn whether there is a secondary index for a leaf.
+ *
+ * @param[in] leaf Schema leaf of a list.
+ * @return Whether the list instances are indexed by @p leaf.
+ */
+ly_bool lyd_index_exists(const struct lysc_node *leaf);
+
+/**
+ * @brief Find list instances with a specific leaf value using a secondary index.
+ *
+ * @param[in] parent Parent of the list instances.
+ * @param[in] leaf Indexed schema leaf.
+ * @param[in] value Value of @p leaf to find.
+ * @param[in,out] entries Set to add the found list instances to, in the data order.
+ * @return LY_SUCCESS on success, even if nothing was found;
+ * @return LY_ENOT if there is no index for @p leaf;
+ * @return LY_ERR on error.
+ */
+LY_ERR lyd_index_find(const struct lyd_node *parent, const struct lysc_node *leaf, const struct lyd_value *value,
+        struct ly_set *entries);
+
+/**
+ * @brief Create the list constraint states of a context, see ::LY_CTX_LIST_CONSTRAINTS.
+ *
+ * @param[in] ctx libyang context.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_cons_new(struct ly_ctx *ctx);
+
+/**
+ * @brief Free all the list constraint states of a context, if any.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_cons_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Update list constraint states after a node was linked or before it is unlinked or its value is changed.
+ *
+ * @param[in] node Linked or unlinked data node.
+ * @param[in] add Whether @p node was linked or is being unlinked.
+ */
+void lyd_cons_update(const struct lyd_node *node, ly_bool add);
+
+/**
+ * @brief Free all the list constraint states of the (leaf-)list instances of a parent node that is being freed.
+ *
+ * @param[in] node Inner data node being freed.
+ */
+void lyd_cons_free_parent(const struct lyd_node *node);
+
+/**
+ * @brief Get the number of (leaf-)list instances from their maintained constraint state, which is created if needed.
+ *
+ * @param[in] parent Parent of the instances.
+ * @param[in] snode Schema node of the instances.
+ * @param[out] count Number of the instances.
+ * @return LY_SUCCESS on success;
+ * @return LY_ENOT if the constraint state cannot be used.
+ */
+LY_ERR lyd_cons_count(const struct lyd_node *parent, const struct lysc_node *snode, uint32_t *count);
+
+/**
+ * @brief Learn whether there are list instances with the same values of a unique from their maintained constraint
+ * state, which is created if needed.
+ *
+ * @param[in] parent Parent of the instances.
+ * @param[in] snode Schema list of the instances.
+ * @param[out] dup Whether there are some instances with the same values of a unique.
+ * @return LY_SUCCESS on success;
+ * @return LY_ENOT if the constraint state cannot be used.
+ */
+LY_ERR lyd_cons_unique(const struct lyd_node *parent, const struct lysc_node *snode, ly_bool *dup);
+
+/**
+ * @brief Create the index of data instances of schema nodes in a context, see ::LY_CTX_INST_INDEX.
+ *
+ * @param[in] ctx libyang context.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_inst_index_new(struct ly_ctx *ctx);
+
+/**
+ * @brief Free the index of data instances of schema nodes in a context, if any.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_inst_index_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Add a new data node into the instance index, if used.
+ *
+ * @param[in] node Created data node.
+ */
+void lyd_inst_index_add(const struct lyd_node *node);
+
+/**
+ * @brief Add a parent newly marked with ::LYD_DFLT_VIRTUAL into the instance index, if used.
+ *
+ * @param[in] parent Parent data node of virtual default leaves.
+ */
+void lyd_inst_index_dflt_parent(const struct lyd_node *parent);
+
+/**
+ * @brief Remove a data node from the instance index, if used.
+ *
+ * @param[in] node Data node being freed.
+ */
+void lyd_inst_index_del(const struct lyd_node *node);
+
+/**
+ * @brief Find all the data instances of schema nodes with a name using the instance index.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] mod Module of the schema nodes, NULL for any.
+ * @param[in] name Name of the schema nodes in the dictionary of @p ctx.
+ * @param[in,out] insts Set to add the found data instances to, in no particular order and from any data trees.
+ * @return LY_SUCCESS on success, even if nothing was found;
+ * @return LY_ENOT if the instance index cannot be used;
+ * @return LY_ERR on error.
+ */
+LY_ERR lyd_inst_index_find(const struct ly_ctx *ctx, const struct lys_module *mod, const char *name, struct ly_set *insts);
+
+/**
+ * @brief Create the cache of when condition results of a context, see ::LY_CTX_WHEN_CACHE.
+ *
+ * @param[in] ctx libyang context.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_when_cache_new(struct ly_ctx *ctx);
+
+/**
+ * @brief Free the cache of when condition results of a context, if any.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_when_cache_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Learn whether the cached true result of the when conditions of a node is still valid.
+ *
+ * @param[in] node Data node with when conditions.
+ * @return Whether the conditions are known to be true without evaluating them.
+ */
+ly_bool lyd_when_cache_valid(const struct lyd_node *node);
+
+/**
+ * @brief Store the true result of the when conditions of a node in the cache.
+ *
+ * @param[in] node Data node whose when conditions were evaluated to true.
+ */
+void lyd_when_cache_store(const struct lyd_node *node);
+
+/**
+ * @brief Invalidate the cached when results depending on a node after it was linked or before its value is changed.
+ *
+ * @param[in] node Linked or changed data node.
+ */
+void lyd_when_cache_change(const struct lyd_node *node);
+
+/**
+ * @brief Invalidate the cached when results depending on a node and forget its own result before it is unlinked.
+ *
+ * @param[in] node Data node being unlinked.
+ */
+void lyd_when_cache_unlink(const struct lyd_node *node);
+
+/**
+ * @brief Forget the cached when result of a node that is being freed.
+ *
+ * @param[in] node Data node being freed.
+ */
+void lyd_when_cache_del(const struct lyd_node *node);
+
+/**
+ * @brief Get the position of a (leaf-)list instance using the children vector of its parent.
+ *
+ * The vector is created for a parent with enough children, if it does not exist.
+ *
+ * @param[in] instance (Leaf-)list instance with a parent.
+ * @return Position of @p instance among its instances, starting from 1;
+ * @return 0 if the parent has no children vector and it cannot be created.
+ */
+uint32_t lyd_child_vec_list_pos(const struct lyd_node *instance);
+
+/**
+ * @brief Free all the children vectors of a context.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_child_vec_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Learn whether a default leaf can be virtual, see ::LYD_DFLT_VIRTUAL.
+ *
+ * @param[in] parent Parent data node of the leaf.
+ * @param[in] snode Schema node of the leaf.
+ * @return Whether the leaf can be virtual.
+ */
+ly_bool lyd_dflt_virtual_allowed(const struct lyd_node *parent, const struct lysc_node *snode);
+
+/**
+ * @brief Get a virtual default leaf of a parent, see ::LYD_DFLT_VIRTUAL.
+ *
+ * @param[in] parent Parent data node without an instance of @p snode.
+ * @param[in] snode Schema node of the leaf.
+ * @param[out] node Virtual default leaf.
+ * @return LY_SUCCESS on success;
+ * @return LY_ENOTFOUND if the leaf is not virtual;
+ * @return LY_ERR on error.
+ */
+LY_ERR lyd_dflt_virtual_get(const struct lyd_node *parent, const struct lysc_node *snode, struct lyd_node **node);
+
+/**
+ * @brief Get all the virtual default leaves of a parent, see ::LYD_DFLT_VIRTUAL.
+ *
+ * @param[in] parent Parent data node.
+ * @param[in,out] set Set to add the virtual leaves to, in the schema order.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_dflt_virtual_children(const struct lyd_node *parent, struct ly_set *set);
+
+/**
+ * @brief Retire a virtual default leaf replaced by a real leaf linked to the parent, it is freed with the parent.
+ *
+ * @param[in] node Linked data node.
+ */
+void lyd_dflt_virtual_insert(const struct lyd_node *node);
+
+/**
+ * @brief Free all the virtual default leaves of a parent node that is being freed.
+ *
+ * @param[in] node Inner data node being freed.
+ */
+void lyd_dflt_virtual_free_parent(const struct lyd_node *node);
+
+/**
+ * @brief Detach a virtual default leaf from its parent, it becomes a standalone default node.
+ *
+ * @param[in] node Virtual default leaf.
+ */
+void lyd_dflt_virtual_unlink(struct lyd_node *node);
+
+/**
+ * @brief Link a virtual default leaf to its parent as a regular default node.
+ *
+ * @param[in] node Virtual default leaf.
+ * @return LY_SUCCESS on success.
+ * @return LY_EINVAL if the leaf was replaced by a real instance, it is then left virtual.
+ */
+LY_ERR lyd_dflt_virtual_materialize(struct lyd_node *node);
+
+/**
+ * @brief Free all the virtual default leaves of a context.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_dflt_virtual_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Parse the children of a lazily parsed LYB data node, see ::LYD_LYB_STUB.
+ *
+ * @param[in] node Node to load, nothing is done if it is not a stub.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_lyb_stub_load(const struct lyd_node *node);
+
+/**
+ * @brief Parse the children of all the lazily parsed LYB data nodes in siblings and their descendants.
+ *
+ * @param[in] first First sibling to load.
+ * @return LY_ERR value.
+ */
+LY_ERR lyd_lyb_stub_load_siblings(const struct lyd_node *first);
+
+/**
+ * @brief Get the children of a node, parse them first if it is a lazily parsed LYB data node.
+ *
+ * Parsing errors are only logged and the node is then returned with whatever children it has.
+ *
+ * @param[in] node Node to use.
+ * @return Pointer to the first child node (if any) of the @p node.
+ */
+struct lyd_node *lyd_child_load(const struct lyd_node *node);
+
+/**
+ * @brief Free the stub record of a lazily parsed LYB data node that is being freed.
+ *
+ * @param[in] node Inner data node being freed.
+ */
+void lyd_lyb_stub_free_node(const struct lyd_node *node);
+
+/**
+ * @brief Free all the stub records of lazily parsed LYB data nodes of a context.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyd_lyb_stub_free(struct ly_ctx *ctx);
+
+/** @} dataindex */
+
+/**
+ * @brief Free a whole frozen data tree, see ::lyd_freeze().
+ *
+ * @param[in] node Any node of the frozen tree.
+ */
+void lyd_frozen_free(struct lyd_node *node);
+
+/**
+ * @brief Check that a data node can be modified, it is not a part of a frozen tree.
+ *
+ * @param[in] node Data node to check, may be NULL.
+ * @return LY_SUCCESS if the node can be modified;
+ * @return LY_EINVAL if it is frozen.
+ */
+LY_ERR lyd_frozen_check(const struct lyd_node *node);
+
 /**
  * @brief Append all list key predicates to path.
  *
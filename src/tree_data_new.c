@@ -18,6 +18,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -29,6 +30,7 @@
 #include "dict.h"
 #include "diff.h"
 #include "hash_table.h"
+#include "hash_table_internal.h"
 #include "in.h"
 #include "in_internal.h"
 #include "log.h"
@@ -73,6 +75,7 @@ lyd_create_term(const struct lysc_node *schema, const char *value, size_t value_
     LOG_LOCBACK(1, 0);
     LY_CHECK_ERR_RET(ret, free(term), ret);
     lyd_hash(&term->node);
+    lyd_inst_index_add(&term->node);
 
     *node = &term->node;
     return ret;
@@ -103,6 +106,7 @@ lyd_create_term2(const struct lysc_node *schema, const struct lyd_value *val, st
         return ret;
     }
     lyd_hash(&term->node);
+    lyd_inst_index_add(&term->node);
 
     *node = &term->node;
     return ret;
@@ -129,6 +133,7 @@ lyd_create_inner(const struct lysc_node *schema, struct lyd_node **node)
     if ((schema->nodetype != LYS_LIST) || (schema->flags & LYS_KEYLESS)) {
         lyd_hash(&in->node);
     }
+    lyd_inst_index_add(&in->node);
 
     *node = &in->node;
     return LY_SUCCESS;
@@ -325,6 +330,7 @@ lyd_create_any(const struct lysc_node *schema, const void *value, LYD_ANYDATA_VA
     any->schema = schema;
     any->prev = &any->node;
     any->flags = LYD_NEW;
+    lyd_inst_index_add(&any->node);
 
     if (schema->nodetype == LYS_ANYDATA) {
         /* anydata */
@@ -441,6 +447,8 @@ lyd_create_opaq(const struct ly_ctx *ctx, const char *name, size_t name_len, con
     LY_CHECK_ERR_GOTO(!opaq, LOGMEM(ctx); ret = LY_EMEM, finish);
 
     opaq->prev = &opaq->node;
+    opaq->ctx = ctx;
+    lyd_inst_index_add(&opaq->node);
     LY_CHECK_GOTO(ret = lydict_insert(ctx, name, name_len, &opaq->name.name), finish);
 
     if (pref_len) {
@@ -459,7 +467,6 @@ lyd_create_opaq(const struct ly_ctx *ctx, const char *name, size_t name_len, con
     opaq->format = format;
     opaq->val_prefix_data = val_prefix_data;
     opaq->hints = hints;
-    opaq->ctx = ctx;
 
 finish:
     if (ret) {
@@ -506,6 +513,7 @@ lyd_new_inner(struct lyd_node *parent, const struct lys_module *module, const ch
 
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (!module) {
         module = parent->schema->module;
@@ -622,6 +630,7 @@ lyd_new_list(struct lyd_node *parent, const struct lys_module *module, const cha
 
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
     LY_CHECK_RET(lyd_new_val_get_format(options, &format));
     LY_CHECK_ARG_RET(ctx, !(store_only && (format == LY_VALUE_CANON || format == LY_VALUE_LYB)), LY_EINVAL);
 
@@ -727,6 +736,7 @@ lyd_new_list2(struct lyd_node *parent, const struct lys_module *module, const ch
 
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (!module) {
         module = parent->schema->module;
@@ -782,6 +792,7 @@ lyd_new_list3(struct lyd_node *parent, const struct lys_module *module, const ch
     LY_CHECK_RET(lyd_new_val_get_format(options, &format));
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name, (format != LY_VALUE_LYB) || value_lengths, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
     LY_CHECK_ARG_RET(ctx, !(store_only && (format == LY_VALUE_CANON || format == LY_VALUE_LYB)), LY_EINVAL);
 
     /* create the list node */
@@ -846,6 +857,7 @@ _lyd_new_term(struct lyd_node *parent, const struct lys_module *module, const ch
 
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
     LY_CHECK_RET(lyd_new_val_get_format(options, &format));
     LY_CHECK_ARG_RET(ctx, !(store_only && (format == LY_VALUE_CANON || format == LY_VALUE_LYB)), LY_EINVAL);
 
@@ -942,6 +954,7 @@ lyd_new_any(struct lyd_node *parent, const struct lys_module *module, const char
     LY_CHECK_ARG_RET(ctx, parent || module, parent || node, name,
             (value_type == LYD_ANYDATA_DATATREE) || (value_type == LYD_ANYDATA_STRING) || value, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (!module) {
         module = parent->schema->module;
@@ -1008,6 +1021,7 @@ lyd_new_meta(const struct ly_ctx *ctx, struct lyd_node *parent, const struct lys
 
     LY_CHECK_ARG_RET(ctx, ctx || parent, name, module || strchr(name, ':'), parent || meta, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, ctx, parent ? LYD_CTX(parent) : NULL, module ? module->ctx : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
     if (!ctx) {
         ctx = module ? module->ctx : LYD_CTX(parent);
     }
@@ -1051,6 +1065,7 @@ lyd_new_meta2(const struct ly_ctx *ctx, struct lyd_node *parent, uint32_t option
 
     LY_CHECK_ARG_RET(NULL, ctx, attr, parent || meta, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, ctx, parent ? LYD_CTX(parent) : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (parent && !parent->schema) {
         LOGERR(ctx, LY_EINVAL, "Cannot add metadata to an opaque node \"%s\".",
@@ -1093,6 +1108,7 @@ lyd_new_opaq(struct lyd_node *parent, const struct ly_ctx *ctx, const char *name
 
     LY_CHECK_ARG_RET(ctx, parent || ctx, parent || node, name, module_name, !prefix || !strcmp(prefix, module_name), LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, ctx, parent ? LYD_CTX(parent) : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (!ctx) {
         ctx = LYD_CTX(parent);
@@ -1123,6 +1139,7 @@ lyd_new_opaq2(struct lyd_node *parent, const struct ly_ctx *ctx, const char *nam
 
     LY_CHECK_ARG_RET(ctx, parent || ctx, parent || node, name, module_ns, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, ctx, parent ? LYD_CTX(parent) : NULL, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     if (!ctx) {
         ctx = LYD_CTX(parent);
@@ -1153,6 +1170,7 @@ lyd_new_attr(struct lyd_node *parent, const char *module_name, const char *name,
     size_t pref_len, name_len, mod_len;
 
     LY_CHECK_ARG_RET(NULL, parent, !parent->schema, name, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     ctx = LYD_CTX(parent);
 
@@ -1203,6 +1221,7 @@ lyd_new_attr2(struct lyd_node *parent, const char *module_ns, const char *name,
     size_t pref_len, name_len;
 
     LY_CHECK_ARG_RET(NULL, parent, !parent->schema, name, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     ctx = LYD_CTX(parent);
 
@@ -1259,6 +1278,10 @@ lyd_change_node_value(struct lyd_node_term *term, struct lyd_value *val, ly_bool
     } else if ((term->schema->flags & LYS_KEY) && term->parent) {
         target = (struct lyd_node *)term->parent;
     } else {
+        /* the value is about to change, update any secondary indexes */
+        lyd_index_unlink(&term->node);
+        lyd_when_cache_change(&term->node);
+
         /* just change the value */
         term->value.realtype->plugin->free(LYD_CTX(term), &term->value);
         if (use_val) {
@@ -1266,6 +1289,9 @@ lyd_change_node_value(struct lyd_node_term *term, struct lyd_value *val, ly_bool
         } else {
             rc = ((struct lysc_node_leaf *)term->schema)->type->plugin->duplicate(LYD_CTX(term), val, &term->value);
         }
+        if (!rc) {
+            lyd_index_insert(&term->node);
+        }
 
         /* leaf that is not a key, its value is not used for its hash so it does not change */
         return rc;
@@ -1325,6 +1351,14 @@ lyd_change_term_val(struct lyd_node *term, struct lyd_value *val, ly_bool use_va
     t = (struct lyd_node_term *)term;
     type = ((struct lysc_node_leaf *)term->schema)->type;
 
+    if ((term->flags & LYD_DFLT_VIRTUAL) && (rc = lyd_dflt_virtual_materialize(term))) {
+        /* a virtual default leaf is being changed but it cannot be materialized */
+        if (use_val) {
+            type->plugin->free(LYD_CTX(term), val);
+        }
+        return rc;
+    }
+
     /* compare original and new value */
     if (type->plugin->compare(LYD_CTX(term), &t->value, val)) {
         /* since they are different, they cannot both be default */
@@ -1400,6 +1434,7 @@ _lyd_change_term(struct lyd_node *term, const void *value, size_t value_len, LY_
     struct lyd_value val;
 
     assert(term && term->schema && (term->schema->nodetype & LYD_NODE_TERM));
+    LY_CHECK_RET(lyd_frozen_check(term));
 
     /* parse the new value */
     LOG_LOCSET(term->schema, term);
@@ -1445,6 +1480,7 @@ lyd_change_meta(struct lyd_meta *meta, const char *val_str)
     ly_bool val_change;
 
     LY_CHECK_ARG_RET(NULL, meta, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(meta->parent));
 
     if (!val_str) {
         val_str = "";
@@ -1915,6 +1951,7 @@ lyd_new_path(struct lyd_node *parent, const struct ly_ctx *ctx, const char *path
     LY_CHECK_ARG_RET(ctx, parent || ctx, path, (path[0] == '/') || parent,
             !(options & LYD_NEW_VAL_BIN) || !(options & LYD_NEW_VAL_CANON), LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     return lyd_new_path_(parent, ctx, NULL, path, value, 0, LYD_ANYDATA_STRING, options, node, NULL);
 }
@@ -1927,6 +1964,7 @@ lyd_new_path2(struct lyd_node *parent, const struct ly_ctx *ctx, const char *pat
     LY_CHECK_ARG_RET(ctx, parent || ctx, path, (path[0] == '/') || parent,
             !(options & LYD_NEW_VAL_BIN) || !(options & LYD_NEW_VAL_CANON), LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     return lyd_new_path_(parent, ctx, NULL, path, value, value_len, value_type, options, new_parent, new_node);
 }
@@ -1940,10 +1978,337 @@ lyd_new_ext_path(struct lyd_node *parent, const struct lysc_ext_instance *ext, c
     LY_CHECK_ARG_RET(ctx, ext, path, (path[0] == '/') || parent,
             !(options & LYD_NEW_VAL_BIN) || !(options & LYD_NEW_VAL_CANON), LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, parent ? LYD_CTX(parent) : NULL, ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(parent));
 
     return lyd_new_path_(parent, ctx, ext, path, value, 0, LYD_ANYDATA_STRING, options, node, NULL);
 }
 
+/*
+ * Virtual default leaves (::LYD_IMPLICIT_VIRTUAL_DFLT) are not created in the data tree, only their parent is marked
+ * with ::LYD_DFLT_VIRTUAL. Once a virtual default leaf is needed by a reader, it is created with its parent pointer
+ * set but without being linked to the parent children and stored in ::ly_ctx.dflt_virt_ht, in a ::lyd_dflt_virt
+ * record of its parent. Once a real instance of the leaf is linked to the parent, the virtual leaf is only moved
+ * aside in the record so that the readers holding it are not left with a dangling pointer, it is freed with the parent.
+ * Since the virtual nodes are created by readers, the record updates are serialized by ::ly_ctx.data_index_lock.
+ */
+
+/**
+ * @brief Virtual default leaves of a single parent data node.
+ */
+struct lyd_dflt_virt {
+    const struct lyd_node *parent;  /**< parent data node of the virtual leaves */
+    struct ly_set nodes;            /**< created virtual default leaves (struct lyd_node *) */
+    struct ly_set replaced;         /**< virtual default leaves replaced by real instances (struct lyd_node *) */
+};
+
+/**
+ * @brief Hash table value-equal callback for virtual default records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lyd_dflt_virt_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyd_dflt_virt *virt1 = *(struct lyd_dflt_virt **)val1_p, *virt2 = *(struct lyd_dflt_virt **)val2_p;
+
+    return virt1->parent == virt2->parent;
+}
+
+/**
+ * @brief Free a virtual default leaf.
+ *
+ * @param[in] node Virtual node to free.
+ */
+static void
+lyd_dflt_virt_node_free(void *node)
+{
+    struct lyd_node *vnode = node;
+
+    /* it is not linked anywhere */
+    vnode->parent = NULL;
+    vnode->flags &= ~LYD_DFLT_VIRTUAL;
+    lyd_free_tree(vnode);
+}
+
+/**
+ * @brief Hash table free callback for virtual default records.
+ */
+static void
+lyd_dflt_virt_free(void *val_p)
+{
+    struct lyd_dflt_virt *virt = *(struct lyd_dflt_virt **)val_p;
+
+    ly_set_erase(&virt->nodes, lyd_dflt_virt_node_free);
+    ly_set_erase(&virt->replaced, lyd_dflt_virt_node_free);
+    free(virt);
+}
+
+/**
+ * @brief Get hash of a parent of virtual default leaves.
+ *
+ * @param[in] parent Parent data node.
+ * @return Hash.
+ */
+static uint32_t
+lyd_dflt_virt_hash(const struct lyd_node *parent)
+{
+    return lyht_hash((const char *)&parent, sizeof parent);
+}
+
+/**
+ * @brief Find the virtual default record of a parent.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] parent Parent data node.
+ * @return Found record, NULL if there is none.
+ */
+static struct lyd_dflt_virt *
+lyd_dflt_virt_get(const struct ly_ctx *ctx, const struct lyd_node *parent)
+{
+    struct lyd_dflt_virt virt_key = {.parent = parent}, *virt_p = &virt_key, **match_p;
+
+    if (!ctx->dflt_virt_ht || lyht_find(ctx->dflt_virt_ht, &virt_p, lyd_dflt_virt_hash(parent), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+ly_bool
+lyd_dflt_virtual_allowed(const struct lyd_node *parent, const struct lysc_node *snode)
+{
+    /* only config leaves with an unconditional default directly in the parent, not in a choice, whose value
+     * does not reference the data tree */
+    return (snode->nodetype == LYS_LEAF) && ((struct lysc_node_leaf *)snode)->dflt && (snode->parent == parent->schema) &&
+           (snode->flags & LYS_CONFIG_W) && !(snode->flags & (LYS_IS_INPUT | LYS_IS_OUTPUT | LYS_IS_NOTIF)) &&
+           !(snode->flags & LYS_STATUS_OBSLT) && !lysc_has_when(snode) &&
+           (((struct lysc_node_leaf *)snode)->type->basetype != LY_TYPE_LEAFREF) &&
+           (((struct lysc_node_leaf *)snode)->type->basetype != LY_TYPE_INST) &&
+           (((struct lysc_node_leaf *)snode)->type->basetype != LY_TYPE_UNION);
+}
+
+/**
+ * @brief Get a virtual default leaf of a parent, create it if it does not exist.
+ *
+ * Is expected to be called with ::ly_ctx.data_index_lock held.
+ *
+ * @param[in] parent Parent data node marked with ::LYD_DFLT_VIRTUAL.
+ * @param[in] snode Schema node of the leaf.
+ * @param[out] node Virtual default leaf.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyd_dflt_virt_get_create(const struct lyd_node *parent, const struct lysc_node *snode, struct lyd_node **node)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)LYD_CTX(parent);
+    struct lyd_dflt_virt *virt;
+    uint32_t i;
+    LY_ERR rc;
+
+    virt = lyd_dflt_virt_get(ctx, parent);
+    if (virt) {
+        for (i = 0; i < virt->nodes.count; ++i) {
+            if (virt->nodes.dnodes[i]->schema == snode) {
+                *node = virt->nodes.dnodes[i];
+                return LY_SUCCESS;
+            }
+        }
+    } else {
+        if (!ctx->dflt_virt_ht) {
+            ctx->dflt_virt_ht = lyht_new(LYHT_MIN_SIZE, sizeof(struct lyd_dflt_virt *), lyd_dflt_virt_equal_cb, NULL, 1);
+            LY_CHECK_ERR_RET(!ctx->dflt_virt_ht, LOGMEM(ctx), LY_EMEM);
+        }
+
+        /* new parent record */
+        virt = calloc(1, sizeof *virt);
+        LY_CHECK_ERR_RET(!virt, LOGMEM(ctx), LY_EMEM);
+        virt->parent = parent;
+        if (lyht_insert(ctx->dflt_virt_ht, &virt, lyd_dflt_virt_hash(parent), NULL)) {
+            free(virt);
+            LOGMEM(ctx);
+            return LY_EMEM;
+        }
+    }
+
+    /* create the node, not linked to its parent */
+    rc = lyd_create_term2(snode, ((struct lysc_node_leaf *)snode)->dflt, node);
+    if (rc && (rc != LY_EINCOMPLETE)) {
+        return rc;
+    }
+    (*node)->flags = LYD_DEFAULT | LYD_DFLT_VIRTUAL;
+    (*node)->parent = (struct lyd_node_inner *)parent;
+
+    if ((rc = ly_set_add(&virt->nodes, *node, 1, NULL))) {
+        lyd_dflt_virt_node_free(*node);
+        *node = NULL;
+    }
+    return rc;
+}
+
+LY_ERR
+lyd_dflt_virtual_get(const struct lyd_node *parent, const struct lysc_node *snode, struct lyd_node **node)
+{
+    const struct ly_ctx *ctx;
+    LY_ERR rc;
+
+    *node = NULL;
+    if (!parent || !parent->schema || !(parent->flags & LYD_DFLT_VIRTUAL) || !lyd_dflt_virtual_allowed(parent, snode)) {
+        return LY_ENOTFOUND;
+    }
+
+    ctx = LYD_CTX(parent);
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+    rc = lyd_dflt_virt_get_create(parent, snode, node);
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    return rc;
+}
+
+LY_ERR
+lyd_dflt_virtual_children(const struct lyd_node *parent, struct ly_set *set)
+{
+    const struct ly_ctx *ctx;
+    const struct lysc_node *snode = NULL;
+    struct lyd_node *node;
+    LY_ERR rc = LY_SUCCESS;
+
+    if (!parent->schema || !(parent->flags & LYD_DFLT_VIRTUAL)) {
+        return LY_SUCCESS;
+    }
+
+    ctx = LYD_CTX(parent);
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    while ((snode = lys_getnext(snode, parent->schema, NULL, 0))) {
+        if (!lyd_dflt_virtual_allowed(parent, snode) || !lyd_find_sibling_val_(lyd_child(parent), snode, NULL, 0, NULL)) {
+            /* not virtual or there is a real instance */
+            continue;
+        }
+
+        LY_CHECK_GOTO(rc = lyd_dflt_virt_get_create(parent, snode, &node), cleanup);
+        LY_CHECK_GOTO(rc = ly_set_add(set, node, 1, NULL), cleanup);
+    }
+
+cleanup:
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+    return rc;
+}
+
+/**
+ * @brief Remove a virtual default leaf from the record of its parent.
+ *
+ * Is expected to be called with ::ly_ctx.data_index_lock held.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] node Virtual node to remove.
+ */
+static void
+lyd_dflt_virt_remove(const struct ly_ctx *ctx, const struct lyd_node *node)
+{
+    struct lyd_dflt_virt *virt;
+
+    virt = lyd_dflt_virt_get(ctx, lyd_parent(node));
+    if (!virt) {
+        return;
+    }
+
+    if (ly_set_contains(&virt->nodes, node, NULL)) {
+        ly_set_rm(&virt->nodes, (void *)node, NULL);
+    } else {
+        ly_set_rm(&virt->replaced, (void *)node, NULL);
+    }
+
+    if (!virt->nodes.count && !virt->replaced.count) {
+        lyht_remove(ctx->dflt_virt_ht, &virt, lyd_dflt_virt_hash(virt->parent));
+        lyd_dflt_virt_free(&virt);
+    }
+}
+
+void
+lyd_dflt_virtual_insert(const struct lyd_node *node)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_dflt_virt *virt;
+    struct lyd_node *vnode = NULL;
+    uint32_t i;
+
+    if (!ctx->dflt_virt_ht || !node->schema || (node->schema->nodetype != LYS_LEAF) || !node->parent ||
+            !(node->parent->flags & LYD_DFLT_VIRTUAL)) {
+        return;
+    }
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    virt = lyd_dflt_virt_get(ctx, lyd_parent(node));
+    for (i = 0; virt && (i < virt->nodes.count); ++i) {
+        if (virt->nodes.dnodes[i]->schema == node->schema) {
+            vnode = virt->nodes.dnodes[i];
+            ly_set_rm_index(&virt->nodes, i, NULL);
+            break;
+        }
+    }
+
+    /* the real instance replaces the virtual one, which is kept until the parent is freed */
+    if (vnode && ly_set_add(&virt->replaced, vnode, 1, NULL)) {
+        assert(vnode != node);
+        lyd_dflt_virt_node_free(vnode);
+    }
+
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+}
+
+void
+lyd_dflt_virtual_free_parent(const struct lyd_node *node)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyd_dflt_virt *virt;
+
+    if (!ctx->dflt_virt_ht || !(node->flags & LYD_DFLT_VIRTUAL) || !(virt = lyd_dflt_virt_get(ctx, node))) {
+        return;
+    }
+
+    lyht_remove(ctx->dflt_virt_ht, &virt, lyd_dflt_virt_hash(node));
+    lyd_dflt_virt_free(&virt);
+}
+
+void
+lyd_dflt_virtual_unlink(struct lyd_node *node)
+{
+    const struct ly_ctx *ctx = LYD_CTX(node);
+
+    assert(node->flags & LYD_DFLT_VIRTUAL);
+
+    pthread_mutex_lock((pthread_mutex_t *)&ctx->data_index_lock);
+    lyd_dflt_virt_remove(ctx, node);
+    pthread_mutex_unlock((pthread_mutex_t *)&ctx->data_index_lock);
+
+    node->parent = NULL;
+    node->flags &= ~LYD_DFLT_VIRTUAL;
+}
+
+LY_ERR
+lyd_dflt_virtual_materialize(struct lyd_node *node)
+{
+    struct lyd_node *parent = lyd_parent(node);
+
+    if (!lyd_find_sibling_val_(lyd_child(parent), node->schema, NULL, 0, NULL)) {
+        /* replaced by a real instance before, it is kept virtual until the parent is freed */
+        LOGERR(LYD_CTX(node), LY_EINVAL, "Virtual default leaf \"%s\" was replaced by a real instance.", LYD_NAME(node));
+        return LY_EINVAL;
+    }
+
+    /* link the node as a regular default node */
+    lyd_dflt_virtual_unlink(node);
+    lyd_insert_node(parent, NULL, node, LYD_INSERT_NODE_DEFAULT);
+    return LY_SUCCESS;
+}
+
+void
+lyd_dflt_virtual_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->dflt_virt_ht, lyd_dflt_virt_free);
+    ctx->dflt_virt_ht = NULL;
+}
+
 LY_ERR
 lyd_new_implicit(struct lyd_node *parent, struct lyd_node **first, const struct lysc_node *sparent,
         const struct lys_module *mod, struct ly_set *node_when, struct ly_set *node_types, struct ly_set *ext_node,
@@ -2004,7 +2369,7 @@ lyd_new_implicit(struct lyd_node *parent, struct lyd_node **first, const struct
 
         switch (snode->nodetype) {
         case LYS_CONTAINER:
-            if (!(snode->flags & LYS_PRESENCE) && lyd_find_sibling_val(*first, snode, NULL, 0, NULL)) {
+            if (!(snode->flags & LYS_PRESENCE) && lyd_find_sibling_val_(*first, snode, NULL, 0, NULL)) {
                 /* create default NP container */
                 LY_CHECK_RET(lyd_create_inner(snode, &node));
                 node->flags = LYD_DEFAULT | (lysc_has_when(snode) ? LYD_WHEN_TRUE : 0);
@@ -2026,7 +2391,16 @@ lyd_new_implicit(struct lyd_node *parent, struct lyd_node **first, const struct
             break;
         case LYS_LEAF:
             if (!(impl_opts & LYD_IMPLICIT_NO_DEFAULTS) && ((struct lysc_node_leaf *)snode)->dflt &&
-                    lyd_find_sibling_val(*first, snode, NULL, 0, NULL)) {
+                    lyd_find_sibling_val_(*first, snode, NULL, 0, NULL)) {
+                if ((impl_opts & LYD_IMPLICIT_VIRTUAL_DFLT) && !diff && parent && lyd_dflt_virtual_allowed(parent, snode)) {
+                    /* keep the default leaf virtual */
+                    if (!(parent->flags & LYD_DFLT_VIRTUAL)) {
+                        parent->flags |= LYD_DFLT_VIRTUAL;
+                        lyd_inst_index_dflt_parent(parent);
+                    }
+                    break;
+                }
+
                 /* create default leaf */
                 ret = lyd_create_term2(snode, ((struct lysc_node_leaf *)snode)->dflt, &node);
                 if (ret == LY_EINCOMPLETE) {
@@ -2056,7 +2430,7 @@ lyd_new_implicit(struct lyd_node *parent, struct lyd_node **first, const struct
             break;
         case LYS_LEAFLIST:
             if (!(impl_opts & LYD_IMPLICIT_NO_DEFAULTS) && ((struct lysc_node_leaflist *)snode)->dflts &&
-                    lyd_find_sibling_val(*first, snode, NULL, 0, NULL)) {
+                    lyd_find_sibling_val_(*first, snode, NULL, 0, NULL)) {
                 /* create all default leaf-lists */
                 dflts = ((struct lysc_node_leaflist *)snode)->dflts;
                 LY_ARRAY_FOR(dflts, u) {
@@ -2126,6 +2500,7 @@ lyd_new_implicit_tree(struct lyd_node *tree, uint32_t implicit_options, struct l
     struct ly_ht *getnext_ht = NULL;
 
     LY_CHECK_ARG_RET(NULL, tree, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(tree));
     if (diff) {
         *diff = NULL;
     }
@@ -2166,6 +2541,7 @@ lyd_new_implicit_all(struct lyd_node **tree, const struct ly_ctx *ctx, uint32_t
 
     LY_CHECK_ARG_RET(ctx, tree, *tree || ctx, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, *tree ? LYD_CTX(*tree) : NULL, ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(*tree));
     if (diff) {
         *diff = NULL;
     }
@@ -1,10 +1,7 @@
 /**
  * @file tree_data_sorted.c
  * @author Adam Piecek <piecek@cesnet.cz>
- * @brief Red-black tree implementation from FRRouting project (https://github.com/FRRouting/frr).
- *
- * The effort of this implementation was to take the working Red-black tree implementation
- * and adapt its interface to libyang.
+ * @brief Chunked B+tree index for sorting data nodes.
  *
  * Copyright (c) 2015 - 2023 CESNET, z.s.p.o.
  *
@@ -15,13 +12,6 @@
  *     https://opensource.org/licenses/BSD-3-Clause
  */
 
-// SPDX-License-Identifier: ISC AND BSD-2-Clause
-/*	$OpenBSD: subr_tree.c,v 1.9 2017/06/08 03:30:52 dlg Exp $ */
-/*
- * Copyright 2002 Niels Provos <provos@citi.umich.edu>
- * Copyright (c) 2016 David Gwynne <dlg@openbsd.org>
- */
-
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,18 +29,15 @@
 
 /*
      metadata (root_meta)
-      ^   |________
-      |            |
-      |            v                    --
-      |      _____rbt__                   |
-      |     |      |   |                  |
-      |     v      |   v                  |
-      |   _rbn_    | _rbn_____            | BST
-      |     |      |   |      |           | (Red-black tree)
-      |  ___|      |   |      v           |
-      | |     _____|   |    _rbn_         |
-      | |    |         |      |         --
-      | v    v         v      v
+      ^   |
+      |   v
+      |  tree
+      |  chunks: [ chunk0 ,        chunk1 ]    --
+      |              |               |           | index
+      |              v               v           | (B+tree with a single inner level)
+      |         [ d1, d2 ]      [ d3, d4 ]       |
+      |           |    |          |    |       --
+      |           v    v          v    v
  ... lyd1<-->lyd2<-->lyd3<-->lyd4 ...
    (leader)
 
@@ -59,111 +46,87 @@
             (leaf-)list
 
  The (leaf-)list consists of data nodes (lyd). The first instance of the (leaf-)list is named leader,
- which contains metadata named 'lyds_tree'. This metadata has a reference to the root of the Red-black tree.
- This tree consists of nodes named 'rbn'. Each of these nodes contains a reference to a left or right child,
- as well as a reference to a data node.
+ which contains metadata named 'lyds_tree'. This metadata has a reference to the lyds tree, which is a sorted
+ array of chunks. Every chunk is a sorted array of references to data nodes and the last node of a chunk
+ is never greater than the first node of the following chunk. The order of the references is always
+ the same as the order of the data nodes in the siblings.
+
+ Compared to a binary tree, there is no per-node allocation and a single entry costs just one pointer,
+ lookups are a binary search over the chunks followed by a binary search inside a single chunk and
+ appending already sorted nodes (bulk-load) is just storing the pointer at the end of the last chunk.
 */
 
-/*
- * A red-black tree is a binary search tree (BST) with the node color as an
- * extra attribute. It fulfills a set of conditions:
- *	- every search path from the root to a leaf consists of the same number of black nodes,
- *	- each red node (except for the root) has a black parent,
- *	- each leaf node is black.
- *
- * Every operation on a red-black tree is bounded as O(lg n).
- * The maximum height of a red-black tree is 2lg (n+1).
+/**
+ * @brief Maximum number of data nodes in a single chunk. A full chunk is split in halves.
  */
-
-#define RB_BLACK    0   /**< black node in a red-black tree */
-#define RB_RED      1   /**< red node in a red-black tree */
+#define LYDS_CHUNK_SIZE 256
 
 /**
- * @brief Red-black node
+ * @brief Number of data nodes a new chunk is allocated for, it grows up to ::LYDS_CHUNK_SIZE.
  */
-struct rb_node {
-    struct rb_node *parent;     /**< parent node (NULL if this is a root node) */
-    struct rb_node *left;       /**< left node with a lower value */
-    struct rb_node *right;      /**< left node with a greater value */
-    struct lyd_node *dnode;     /**< assigned libyang data node */
-    uint8_t color;              /**< color for red-black node */
-};
+#define LYDS_CHUNK_MIN_SIZE 4
 
 /**
- * @defgroup rbngetters Macros for accessing members.
- *
- * Useful if there is a need to reduce the memory space for red-black nodes in the future. The color bit can be hidden
- * in some (parent/left/right) pointer and their true values can be obtained by masking. This saves 8 bytes, but there
- * is no guarantee that the code will be cross-platform.
- *
- * @{
+ * @brief Chunk of sorted references to data nodes.
  */
-#define RBN_LEFT(NODE) ((NODE)->left)
-#define RBN_RIGHT(NODE) ((NODE)->right)
-#define RBN_PARENT(NODE) ((NODE)->parent)
-#define RBN_DNODE(NODE) ((NODE)->dnode)
-#define RBN_COLOR(NODE) ((NODE)->color)
-/** @} rbngetters */
+struct lyds_chunk {
+    uint32_t count;             /**< number of used items in dnodes */
+    uint32_t size;              /**< number of allocated items in dnodes */
+    struct lyd_node *dnodes[];  /**< sorted data nodes */
+};
 
 /**
- * @brief Rewrite members from @p SRC to @p DST.
- *
- * @param[in] DST Destination node.
- * @param[in] SRC Source node.
+ * @brief Comparison callback of two data nodes.
  */
-#define RBN_COPY(DST, SRC) \
-    RBN_PARENT(DST) = RBN_PARENT(SRC); \
-    RBN_LEFT(DST)   = RBN_LEFT(SRC); \
-    RBN_RIGHT(DST)  = RBN_RIGHT(SRC); \
-    RBN_COLOR(DST)  = RBN_COLOR(SRC);
+typedef int (*lyds_compare_clb)(const struct lyd_node *n1, const struct lyd_node *n2);
 
 /**
- * @brief Reset the red-black node and set new dnode.
- *
- * @param[in] RBN Node to reset.
- * @param[in] DNODE New dnode value for @p rbn.
+ * @brief Index of sorted (leaf-)list instances.
  */
-#define RBN_RESET(RBN, DNODE) \
-    *(RBN) = (const struct rb_node){0}; \
-    RBN_DNODE(RBN) = DNODE;
+struct lyds_tree {
+    lyds_compare_clb compare;   /**< comparison callback for the (leaf-)list */
+    struct lyds_chunk **chunks; /**< sorted chunks, all of them contain at least one node */
+    uint32_t count;             /**< number of chunks */
+    uint32_t size;              /**< number of allocated chunk pointers */
+};
 
 /**
- * @brief Get red-black root from metadata.
+ * @brief Get lyds tree from metadata.
  *
  * @param[in] META Pointer to the struct lyd_meta.
- * @param[out] RBT Root of the Red-black tree.
+ * @param[out] TREE lyds tree.
  */
-#define RBT_GET(META, RBT) \
+#define LYDS_TREE_GET(META, TREE) \
     { \
         struct lyd_value_lyds_tree *_lt; \
         LYD_VALUE_GET(&META->value, _lt); \
-        RBT = _lt ? _lt->rbt : NULL; \
+        TREE = _lt ? _lt->rbt : NULL; \
     }
 
 /**
- * @brief Set a new red-black root to the metadata.
+ * @brief Set a new lyds tree to the metadata.
  *
  * @param[in] META Pointer to the struct lyd_meta.
- * @param[in] RBT Root of the Red-black tree.
+ * @param[in] TREE lyds tree.
  */
-#define RBT_SET(META, RBT) \
+#define LYDS_TREE_SET(META, TREE) \
     { \
         struct lyd_value_lyds_tree *_lt; \
         LYD_VALUE_GET(&META->value, _lt); \
-        _lt->rbt = RBT; \
+        _lt->rbt = TREE; \
     }
 
 /**
- * @brief Get Red-black tree from data node.
+ * @brief Get lyds tree from data node.
  *
  * @param[in] leader First instance of the (leaf-)list in sequence.
- * @param[out] meta Metadata from which the Red-black tree was obtained. The parameter is optional.
- * @return Root of the Red-black tree or NULL.
+ * @param[out] meta Metadata from which the lyds tree was obtained. The parameter is optional.
+ * @return lyds tree or NULL.
  */
-static struct rb_node *
-lyds_get_rb_tree(const struct lyd_node *leader, struct lyd_meta **meta)
+static struct lyds_tree *
+lyds_get_tree(const struct lyd_node *leader, struct lyd_meta **meta)
 {
-    struct rb_node *rbt;
+    struct lyds_tree *tree;
     struct lyd_meta *iter;
 
     if (meta) {
@@ -174,8 +137,8 @@ lyds_get_rb_tree(const struct lyd_node *leader, struct lyd_meta **meta)
             if (meta) {
                 *meta = iter;
             }
-            RBT_GET(iter, rbt);
-            return rbt;
+            LYDS_TREE_GET(iter, tree);
+            return tree;
         }
     }
 
@@ -193,14 +156,14 @@ lyds_get_rb_tree(const struct lyd_node *leader, struct lyd_meta **meta)
  * @return Positive number if val1 > val2.
  */
 static int
-rb_sort_clb(const struct ly_ctx *ctx, const struct lyd_value *val1, const struct lyd_value *val2)
+lyds_sort_clb(const struct ly_ctx *ctx, const struct lyd_value *val1, const struct lyd_value *val2)
 {
     assert(val1->realtype == val2->realtype);
     return val1->realtype->plugin->sort(ctx, val1, val2);
 }
 
 /**
- * @brief Compare red-black nodes by rb_node.dnode from the same Red-black tree.
+ * @brief Compare leaf-list data nodes.
  *
  * @param[in] n1 First leaf-list data node.
  * @param[in] n2 Second leaf-list data node.
@@ -209,7 +172,7 @@ rb_sort_clb(const struct ly_ctx *ctx, const struct lyd_value *val1, const struct
  * @return Positive number if val1 > val2.
  */
 static int
-rb_compare_leaflists(const struct lyd_node *n1, const struct lyd_node *n2)
+lyds_compare_leaflists(const struct lyd_node *n1, const struct lyd_node *n2)
 {
     struct lyd_value *val1, *val2;
 
@@ -219,11 +182,11 @@ rb_compare_leaflists(const struct lyd_node *n1, const struct lyd_node *n2)
 
     val1 = &((struct lyd_node_term *)n1)->value;
     val2 = &((struct lyd_node_term *)n2)->value;
-    return rb_sort_clb(LYD_CTX(n1), val1, val2);
+    return lyds_sort_clb(LYD_CTX(n1), val1, val2);
 }
 
 /**
- * @brief Compare red-black nodes by rb_node.dnode from the same Red-black tree.
+ * @brief Compare list data nodes.
  *
  * @param[in] n1 First list data node.
  * @param[in] n2 Second list data node.
@@ -232,7 +195,7 @@ rb_compare_leaflists(const struct lyd_node *n1, const struct lyd_node *n2)
  * @return Positive number if val1 > val2.
  */
 static int
-rb_compare_lists(const struct lyd_node *n1, const struct lyd_node *n2)
+lyds_compare_lists(const struct lyd_node *n1, const struct lyd_node *n2)
 {
     const struct lyd_node *k1, *k2;
     struct lyd_value *val1, *val2;
@@ -247,7 +210,7 @@ rb_compare_lists(const struct lyd_node *n1, const struct lyd_node *n2)
     k2 = ((const struct lyd_node_inner *)n2)->child;
     val1 = &((struct lyd_node_term *)k1)->value;
     val2 = &((struct lyd_node_term *)k2)->value;
-    cmp = rb_sort_clb(LYD_CTX(n1), val1, val2);
+    cmp = lyds_sort_clb(LYD_CTX(n1), val1, val2);
     if (cmp != 0) {
         return cmp;
     }
@@ -259,7 +222,7 @@ rb_compare_lists(const struct lyd_node *n1, const struct lyd_node *n2)
         assert(k1->schema == k2->schema);
         val1 = &((struct lyd_node_term *)k1)->value;
         val2 = &((struct lyd_node_term *)k2)->value;
-        cmp = rb_sort_clb(LYD_CTX(n1), val1, val2);
+        cmp = lyds_sort_clb(LYD_CTX(n1), val1, val2);
         if (cmp != 0) {
             return cmp;
         }
@@ -270,634 +233,484 @@ rb_compare_lists(const struct lyd_node *n1, const struct lyd_node *n2)
 }
 
 /**
- * @brief Release unlinked red-black node.
+ * @brief Get a free chunk, either from the pool or a newly allocated one.
  *
- * @param[in,out] rbn Node to free, is set to NULL.
+ * @param[in] ctx libyang context for logging.
+ * @param[in] size Minimal number of data nodes the chunk must be able to hold.
+ * @param[in,out] pool Optional pool of free chunks.
+ * @return Empty chunk, NULL on memory allocation failure.
  */
-static void
-rb_free_node(struct rb_node **rbn)
+static struct lyds_chunk *
+lyds_chunk_new(const struct ly_ctx *ctx, uint32_t size, struct lyds_pool *pool)
 {
-    free(*rbn);
-    *rbn = NULL;
+    struct lyds_chunk *chunk = NULL, *tmp;
+
+    if (pool && pool->tree && pool->tree->count) {
+        /* reuse a released chunk */
+        chunk = pool->tree->chunks[--pool->tree->count];
+        if (chunk->size < size) {
+            tmp = realloc(chunk, sizeof *chunk + size * sizeof *chunk->dnodes);
+            LY_CHECK_ERR_RET(!tmp, free(chunk); LOGMEM(ctx), NULL);
+            chunk = tmp;
+            chunk->size = size;
+        }
+    } else {
+        size = (size < LYDS_CHUNK_MIN_SIZE) ? LYDS_CHUNK_MIN_SIZE : size;
+        chunk = malloc(sizeof *chunk + size * sizeof *chunk->dnodes);
+        LY_CHECK_ERR_RET(!chunk, LOGMEM(ctx), NULL);
+        chunk->size = size;
+    }
+    chunk->count = 0;
+
+    return chunk;
 }
 
 /**
- * @brief Traversing all red-black nodes.
- *
- * Traversal order is not the same as traversing data nodes.
- * The rb_next() is available for browsing in a sorted manner.
+ * @brief Enlarge a chunk so that it can hold at least @p size data nodes.
  *
- * @param[in] current_state Current state of iterator.
- * @param[out] next_state The updated state of the iterator.
- * @return Next node or the first node.
+ * @param[in] ctx libyang context for logging.
+ * @param[in,out] tree lyds tree with the chunk.
+ * @param[in] ci Index of the chunk.
+ * @param[in] size Minimal number of data nodes the chunk must be able to hold.
+ * @return LY_ERR value.
  */
-static struct rb_node *
-rb_iter_traversal(struct rb_node *current_state, struct rb_node **next_state)
+static LY_ERR
+lyds_chunk_grow(const struct ly_ctx *ctx, struct lyds_tree *tree, uint32_t ci, uint32_t size)
 {
-    struct rb_node *iter, *parent, *next;
-
-    for (iter = current_state; iter; iter = next) {
-        if (RBN_LEFT(iter)) {
-            next = RBN_LEFT(iter);
-            continue;
-        } else if (RBN_RIGHT(iter)) {
-            next = RBN_RIGHT(iter);
-            continue;
-        }
+    struct lyds_chunk *chunk;
+    uint32_t new_size;
 
-        *next_state = parent = RBN_PARENT(iter);
+    if (tree->chunks[ci]->size >= size) {
+        return LY_SUCCESS;
+    }
 
-        if (parent && (RBN_LEFT(parent) == iter)) {
-            RBN_LEFT(parent) = NULL;
-        } else if (parent && (RBN_RIGHT(parent) == iter)) {
-            RBN_RIGHT(parent) = NULL;
-        }
+    new_size = tree->chunks[ci]->size * 2;
+    new_size = (new_size < size) ? size : new_size;
+    new_size = (new_size > LYDS_CHUNK_SIZE) ? LYDS_CHUNK_SIZE : new_size;
+    assert(new_size >= size);
 
-        return iter;
-    }
+    chunk = realloc(tree->chunks[ci], sizeof *chunk + new_size * sizeof *chunk->dnodes);
+    LY_CHECK_ERR_RET(!chunk, LOGMEM(ctx), LY_EMEM);
+    chunk->size = new_size;
+    tree->chunks[ci] = chunk;
 
-    return NULL;
+    return LY_SUCCESS;
 }
 
 /**
- * @brief Iterator initialization for traversing red-black tree.
+ * @brief Insert a chunk into the chunk array of a lyds tree.
  *
- * @param[in] rbt Root of the Red-black tree.
- * @param[out] iter_state Iterator state which must be maintained during browsing.
- * @return First node.
+ * @param[in] ctx libyang context for logging.
+ * @param[in,out] tree lyds tree to modify.
+ * @param[in] ci Index the chunk will have.
+ * @param[in] chunk Chunk to insert, it is freed on error.
+ * @return LY_ERR value.
  */
-static struct rb_node *
-rb_iter_begin(struct rb_node *rbt, struct rb_node **iter_state)
+static LY_ERR
+lyds_tree_add_chunk(const struct ly_ctx *ctx, struct lyds_tree *tree, uint32_t ci, struct lyds_chunk *chunk)
 {
-    return rb_iter_traversal(rbt, iter_state);
+    struct lyds_chunk **chunks;
+    uint32_t size;
+
+    assert(ci <= tree->count);
+
+    if (tree->count == tree->size) {
+        size = tree->size ? tree->size * 2 : 1;
+        chunks = realloc(tree->chunks, size * sizeof *chunks);
+        LY_CHECK_ERR_RET(!chunks, free(chunk); LOGMEM(ctx), LY_EMEM);
+        tree->chunks = chunks;
+        tree->size = size;
+    }
+
+    memmove(&tree->chunks[ci + 1], &tree->chunks[ci], (tree->count - ci) * sizeof *tree->chunks);
+    tree->chunks[ci] = chunk;
+    ++tree->count;
+
+    return LY_SUCCESS;
 }
 
 /**
- * @brief Get the following node when traversing red-black tree.
+ * @brief Remove a chunk from the chunk array of a lyds tree and free it.
  *
- * @param[in,out] iter_state Iterator state which must be maintained during browsing.
- * @return Next node.
+ * @param[in,out] tree lyds tree to modify.
+ * @param[in] ci Index of the chunk to remove.
  */
-static struct rb_node *
-rb_iter_next(struct rb_node **iter_state)
+static void
+lyds_tree_del_chunk(struct lyds_tree *tree, uint32_t ci)
 {
-    return rb_iter_traversal(*iter_state, iter_state);
+    assert(ci < tree->count);
+
+    free(tree->chunks[ci]);
+    --tree->count;
+    memmove(&tree->chunks[ci], &tree->chunks[ci + 1], (tree->count - ci) * sizeof *tree->chunks);
 }
 
-void
-lyds_free_tree(struct rb_node *rbt)
+/**
+ * @brief Create a new lyds tree with a single data node.
+ *
+ * @param[in] node First data node of the tree.
+ * @param[in,out] pool Optional pool of free chunks.
+ * @param[out] tree Created lyds tree.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyds_tree_create(struct lyd_node *node, struct lyds_pool *pool, struct lyds_tree **tree)
 {
-    struct rb_node *rbn, *iter_state;
+    struct lyds_chunk *chunk;
 
-    /* There is no rebalancing. */
-    for (rbn = rb_iter_begin(rbt, &iter_state); rbn; rbn = rb_iter_next(&iter_state)) {
-        rb_free_node(&rbn);
-    }
-}
+    *tree = calloc(1, sizeof **tree);
+    LY_CHECK_ERR_RET(!*tree, LOGMEM(LYD_CTX(node)), LY_EMEM);
+    (*tree)->compare = (node->schema->nodetype == LYS_LEAFLIST) ? lyds_compare_leaflists : lyds_compare_lists;
 
-static void
-rb_set(struct rb_node *rbn, struct rb_node *parent)
-{
-    RBN_PARENT(rbn) = parent;
-    RBN_LEFT(rbn) = RBN_RIGHT(rbn) = NULL;
-    RBN_COLOR(rbn) = RB_RED;
-}
+    chunk = lyds_chunk_new(LYD_CTX(node), 1, pool);
+    if (!chunk || lyds_tree_add_chunk(LYD_CTX(node), *tree, 0, chunk)) {
+        free(*tree);
+        *tree = NULL;
+        return LY_EMEM;
+    }
+    chunk->dnodes[0] = node;
+    chunk->count = 1;
 
-static void
-rb_set_blackred(struct rb_node *black, struct rb_node *red)
-{
-    RBN_COLOR(black) = RB_BLACK;
-    RBN_COLOR(red) = RB_RED;
+    return LY_SUCCESS;
 }
 
+/**
+ * @brief Find the position after all the data nodes not greater than @p node.
+ *
+ * @param[in] tree lyds tree to search in.
+ * @param[in] node Data node with the value to search for.
+ * @param[out] ci Index of the chunk.
+ * @param[out] ni Index in the chunk, may be equal to the chunk count.
+ */
 static void
-rb_rotate_left(struct rb_node **rbt, struct rb_node *rbn)
+lyds_tree_upper_bound(const struct lyds_tree *tree, const struct lyd_node *node, uint32_t *ci, uint32_t *ni)
 {
-    struct rb_node *parent;
-    struct rb_node *tmp;
-
-    tmp = RBN_RIGHT(rbn);
-    RBN_RIGHT(rbn) = RBN_LEFT(tmp);
-    if (RBN_RIGHT(rbn) != NULL) {
-        RBN_PARENT(RBN_LEFT(tmp)) = rbn;
+    const struct lyds_chunk *chunk;
+    uint32_t lo, hi, mid;
+
+    /* the most common case, appending sorted nodes */
+    chunk = tree->chunks[tree->count - 1];
+    if (tree->compare(chunk->dnodes[chunk->count - 1], node) <= 0) {
+        *ci = tree->count - 1;
+        *ni = chunk->count;
+        return;
     }
 
-    parent = RBN_PARENT(rbn);
-    RBN_PARENT(tmp) = parent;
-    if (parent != NULL) {
-        if (rbn == RBN_LEFT(parent)) {
-            RBN_LEFT(parent) = tmp;
+    /* first chunk with its last node greater than the node */
+    lo = 0;
+    hi = tree->count - 1;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        chunk = tree->chunks[mid];
+        if (tree->compare(chunk->dnodes[chunk->count - 1], node) > 0) {
+            hi = mid;
         } else {
-            RBN_RIGHT(parent) = tmp;
+            lo = mid + 1;
         }
-    } else {
-        *rbt = tmp;
     }
+    *ci = lo;
 
-    RBN_LEFT(tmp) = rbn;
-    RBN_PARENT(rbn) = tmp;
+    /* first node in the chunk greater than the node */
+    chunk = tree->chunks[lo];
+    lo = 0;
+    hi = chunk->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (tree->compare(chunk->dnodes[mid], node) > 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *ni = lo;
 }
 
-static void
-rb_rotate_right(struct rb_node **rbt, struct rb_node *rbn)
+/**
+ * @brief Find the position of a data node in a lyds tree.
+ *
+ * @param[in] tree lyds tree to search in.
+ * @param[in] node Data node to find.
+ * @param[out] ci Index of the chunk.
+ * @param[out] ni Index in the chunk.
+ * @return 1 if the node was found, 0 otherwise.
+ */
+static ly_bool
+lyds_tree_find(const struct lyds_tree *tree, const struct lyd_node *node, uint32_t *ci, uint32_t *ni)
 {
-    struct rb_node *parent;
-    struct rb_node *tmp;
-
-    tmp = RBN_LEFT(rbn);
-    RBN_LEFT(rbn) = RBN_RIGHT(tmp);
-    if (RBN_LEFT(rbn) != NULL) {
-        RBN_PARENT(RBN_RIGHT(tmp)) = rbn;
+    const struct lyds_chunk *chunk;
+    uint32_t lo, hi, mid;
+
+    /* the first and the last nodes are the most frequently removed ones */
+    chunk = tree->chunks[tree->count - 1];
+    if (chunk->dnodes[chunk->count - 1] == node) {
+        *ci = tree->count - 1;
+        *ni = chunk->count - 1;
+        return 1;
+    } else if (tree->chunks[0]->dnodes[0] == node) {
+        *ci = 0;
+        *ni = 0;
+        return 1;
     }
 
-    parent = RBN_PARENT(rbn);
-    RBN_PARENT(tmp) = parent;
-    if (parent != NULL) {
-        if (rbn == RBN_LEFT(parent)) {
-            RBN_LEFT(parent) = tmp;
+    /* first chunk with its last node not less than the node */
+    lo = 0;
+    hi = tree->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        chunk = tree->chunks[mid];
+        if (tree->compare(chunk->dnodes[chunk->count - 1], node) >= 0) {
+            hi = mid;
         } else {
-            RBN_RIGHT(parent) = tmp;
+            lo = mid + 1;
         }
-    } else {
-        *rbt = tmp;
+    }
+    *ci = lo;
+    if (*ci == tree->count) {
+        return 0;
     }
 
-    RBN_RIGHT(tmp) = rbn;
-    RBN_PARENT(rbn) = tmp;
-}
-
-static void
-rb_insert_color(struct rb_node **rbt, struct rb_node *rbn)
-{
-    struct rb_node *parent, *gparent, *tmp;
-
-    while ((parent = RBN_PARENT(rbn)) != NULL &&
-            RBN_COLOR(parent) == RB_RED) {
-        gparent = RBN_PARENT(parent);
-
-        if (parent == RBN_LEFT(gparent)) {
-            tmp = RBN_RIGHT(gparent);
-            if ((tmp != NULL) && (RBN_COLOR(tmp) == RB_RED)) {
-                RBN_COLOR(tmp) = RB_BLACK;
-                rb_set_blackred(parent, gparent);
-                rbn = gparent;
-                continue;
-            }
-
-            if (RBN_RIGHT(parent) == rbn) {
-                rb_rotate_left(rbt, parent);
-                tmp = parent;
-                parent = rbn;
-                rbn = tmp;
-            }
-
-            rb_set_blackred(parent, gparent);
-            rb_rotate_right(rbt, gparent);
+    /* first node in the chunk not less than the node */
+    chunk = tree->chunks[*ci];
+    lo = 0;
+    hi = chunk->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (tree->compare(chunk->dnodes[mid], node) >= 0) {
+            hi = mid;
         } else {
-            tmp = RBN_LEFT(gparent);
-            if ((tmp != NULL) && (RBN_COLOR(tmp) == RB_RED)) {
-                RBN_COLOR(tmp) = RB_BLACK;
-                rb_set_blackred(parent, gparent);
-                rbn = gparent;
-                continue;
-            }
+            lo = mid + 1;
+        }
+    }
+    *ni = lo;
 
-            if (RBN_LEFT(parent) == rbn) {
-                rb_rotate_right(rbt, parent);
-                tmp = parent;
-                parent = rbn;
-                rbn = tmp;
+    /* sequential search in nodes having the same value */
+    for ( ; *ci < tree->count; ++(*ci), *ni = 0) {
+        chunk = tree->chunks[*ci];
+        for ( ; *ni < chunk->count; ++(*ni)) {
+            if (chunk->dnodes[*ni] == node) {
+                return 1;
+            } else if (tree->compare(chunk->dnodes[*ni], node)) {
+                return 0;
             }
-
-            rb_set_blackred(parent, gparent);
-            rb_rotate_left(rbt, gparent);
         }
     }
 
-    RBN_COLOR(*rbt) = RB_BLACK;
+    return 0;
 }
 
-static void
-rb_remove_color(struct rb_node **rbt, struct rb_node *parent, struct rb_node *rbn)
+/**
+ * @brief Get the data node preceding a position in a lyds tree.
+ *
+ * @param[in] tree lyds tree.
+ * @param[in] ci Index of the chunk.
+ * @param[in] ni Index in the chunk.
+ * @return Previous data node, NULL if the position is the first one.
+ */
+static struct lyd_node *
+lyds_tree_prev(const struct lyds_tree *tree, uint32_t ci, uint32_t ni)
 {
-    struct rb_node *tmp;
-
-    while ((rbn == NULL || RBN_COLOR(rbn) == RB_BLACK) &&
-            rbn != *rbt && parent) {
-        if (RBN_LEFT(parent) == rbn) {
-            tmp = RBN_RIGHT(parent);
-            if (RBN_COLOR(tmp) == RB_RED) {
-                rb_set_blackred(tmp, parent);
-                rb_rotate_left(rbt, parent);
-                tmp = RBN_RIGHT(parent);
-            }
-            if (((RBN_LEFT(tmp) == NULL) ||
-                    (RBN_COLOR(RBN_LEFT(tmp)) == RB_BLACK)) &&
-                    ((RBN_RIGHT(tmp) == NULL) ||
-                    (RBN_COLOR(RBN_RIGHT(tmp)) == RB_BLACK))) {
-                RBN_COLOR(tmp) = RB_RED;
-                rbn = parent;
-                parent = RBN_PARENT(rbn);
-            } else {
-                if ((RBN_RIGHT(tmp) == NULL) ||
-                        (RBN_COLOR(RBN_RIGHT(tmp)) == RB_BLACK)) {
-                    struct rb_node *oleft;
-
-                    oleft = RBN_LEFT(tmp);
-                    if (oleft != NULL) {
-                        RBN_COLOR(oleft) = RB_BLACK;
-                    }
-
-                    RBN_COLOR(tmp) = RB_RED;
-                    rb_rotate_right(rbt, tmp);
-                    tmp = RBN_RIGHT(parent);
-                }
-
-                RBN_COLOR(tmp) = RBN_COLOR(parent);
-                RBN_COLOR(parent) = RB_BLACK;
-                if (RBN_RIGHT(tmp)) {
-                    RBN_COLOR(RBN_RIGHT(tmp)) = RB_BLACK;
-                }
-
-                rb_rotate_left(rbt, parent);
-                rbn = *rbt;
-                break;
-            }
-        } else {
-            tmp = RBN_LEFT(parent);
-            if (RBN_COLOR(tmp) == RB_RED) {
-                rb_set_blackred(tmp, parent);
-                rb_rotate_right(rbt, parent);
-                tmp = RBN_LEFT(parent);
-            }
-
-            if (((RBN_LEFT(tmp) == NULL) ||
-                    (RBN_COLOR(RBN_LEFT(tmp)) == RB_BLACK)) &&
-                    ((RBN_RIGHT(tmp) == NULL) ||
-                    (RBN_COLOR(RBN_RIGHT(tmp)) == RB_BLACK))) {
-                RBN_COLOR(tmp) = RB_RED;
-                rbn = parent;
-                parent = RBN_PARENT(rbn);
-            } else {
-                if ((RBN_LEFT(tmp) == NULL) ||
-                        (RBN_COLOR(RBN_LEFT(tmp)) == RB_BLACK)) {
-                    struct rb_node *oright;
-
-                    oright = RBN_RIGHT(tmp);
-                    if (oright != NULL) {
-                        RBN_COLOR(oright) = RB_BLACK;
-                    }
-
-                    RBN_COLOR(tmp) = RB_RED;
-                    rb_rotate_left(rbt, tmp);
-                    tmp = RBN_LEFT(parent);
-                }
-
-                RBN_COLOR(tmp) = RBN_COLOR(parent);
-                RBN_COLOR(parent) = RB_BLACK;
-                if (RBN_LEFT(tmp) != NULL) {
-                    RBN_COLOR(RBN_LEFT(tmp)) = RB_BLACK;
-                }
-
-                rb_rotate_right(rbt, parent);
-                rbn = *rbt;
-                break;
-            }
-        }
+    if (ni) {
+        return tree->chunks[ci]->dnodes[ni - 1];
+    } else if (ci) {
+        return tree->chunks[ci - 1]->dnodes[tree->chunks[ci - 1]->count - 1];
     }
 
-    if (rbn != NULL) {
-        RBN_COLOR(rbn) = RB_BLACK;
-    }
+    return NULL;
 }
 
 /**
- * @brief Remove node from the Red-black tree.
+ * @brief Insert a data node into a lyds tree at a position.
  *
- * @param[in,out] rbt Root of the Red-black tree. After the @p rbn is removed, the root may change.
- * @param[in] rbn Node to remove.
- * @return Removed node from the Red-black tree.
+ * @param[in,out] tree lyds tree to modify.
+ * @param[in] ci Index of the chunk.
+ * @param[in] ni Index in the chunk.
+ * @param[in] node Data node to insert.
+ * @param[in,out] pool Optional pool of free chunks.
+ * @param[out] prev Data node preceding @p node in the tree, NULL if @p node is the first one.
+ * @return LY_ERR value.
  */
-static struct rb_node *
-rb_remove(struct rb_node **rbt, struct rb_node *rbn)
+static LY_ERR
+lyds_tree_insert_at(struct lyds_tree *tree, uint32_t ci, uint32_t ni, struct lyd_node *node,
+        struct lyds_pool *pool, struct lyd_node **prev)
 {
-    struct rb_node *child, *parent, *old = rbn;
-    uint8_t color;
-
-    if (RBN_LEFT(rbn) == NULL) {
-        child = RBN_RIGHT(rbn);
-    } else if (RBN_RIGHT(rbn) == NULL) {
-        child = RBN_LEFT(rbn);
-    } else {
-        struct rb_node *tmp;
-
-        rbn = RBN_RIGHT(rbn);
-        while ((tmp = RBN_LEFT(rbn)) != NULL) {
-            rbn = tmp;
-        }
-
-        child = RBN_RIGHT(rbn);
-        parent = RBN_PARENT(rbn);
-        color = RBN_COLOR(rbn);
-        if (child != NULL) {
-            RBN_PARENT(child) = parent;
-        }
-        if (parent != NULL) {
-            if (RBN_LEFT(parent) == rbn) {
-                RBN_LEFT(parent) = child;
-            } else {
-                RBN_RIGHT(parent) = child;
-            }
-        } else {
-            *rbt = child;
-        }
-        if (RBN_PARENT(rbn) == old) {
-            parent = rbn;
-        }
-        RBN_COPY(rbn, old);
-
-        tmp = RBN_PARENT(old);
-        if (tmp != NULL) {
-            if (RBN_LEFT(tmp) == old) {
-                RBN_LEFT(tmp) = rbn;
-            } else {
-                RBN_RIGHT(tmp) = rbn;
-            }
-        } else {
-            *rbt = rbn;
+    const struct ly_ctx *ctx = LYD_CTX(node);
+    struct lyds_chunk *chunk, *new_chunk;
+    uint32_t half;
+
+    chunk = tree->chunks[ci];
+    if ((chunk->count == chunk->size) && (chunk->size < LYDS_CHUNK_SIZE)) {
+        /* enlarge the chunk */
+        LY_CHECK_RET(lyds_chunk_grow(ctx, tree, ci, chunk->count + 1));
+        chunk = tree->chunks[ci];
+    } else if ((chunk->count == chunk->size) && (ni == chunk->count) && (ci == tree->count - 1)) {
+        /* appending to a full last chunk, start a new one so that sorted input fills the chunks completely */
+        new_chunk = lyds_chunk_new(ctx, 1, pool);
+        LY_CHECK_RET(!new_chunk, LY_EMEM);
+        LY_CHECK_RET(lyds_tree_add_chunk(ctx, tree, ci + 1, new_chunk));
+        chunk = new_chunk;
+        ++ci;
+        ni = 0;
+    } else if (chunk->count == chunk->size) {
+        /* split the chunk in halves */
+        half = chunk->count / 2;
+        new_chunk = lyds_chunk_new(ctx, LYDS_CHUNK_SIZE, pool);
+        LY_CHECK_RET(!new_chunk, LY_EMEM);
+        LY_CHECK_RET(lyds_tree_add_chunk(ctx, tree, ci + 1, new_chunk));
+        memcpy(new_chunk->dnodes, &chunk->dnodes[half], (chunk->count - half) * sizeof *chunk->dnodes);
+        new_chunk->count = chunk->count - half;
+        chunk->count = half;
+        if (ni > half) {
+            chunk = new_chunk;
+            ++ci;
+            ni -= half;
         }
-
-        RBN_PARENT(RBN_LEFT(old)) = rbn;
-        if (RBN_RIGHT(old)) {
-            RBN_PARENT(RBN_RIGHT(old)) = rbn;
-        }
-
-        goto color;
     }
 
-    parent = RBN_PARENT(rbn);
-    color = RBN_COLOR(rbn);
+    memmove(&chunk->dnodes[ni + 1], &chunk->dnodes[ni], (chunk->count - ni) * sizeof *chunk->dnodes);
+    chunk->dnodes[ni] = node;
+    ++chunk->count;
 
-    if (child != NULL) {
-        RBN_PARENT(child) = parent;
-    }
-    if (parent != NULL) {
-        if (RBN_LEFT(parent) == rbn) {
-            RBN_LEFT(parent) = child;
-        } else {
-            RBN_RIGHT(parent) = child;
-        }
-    } else {
-        *rbt = child;
-    }
-color:
-    if (color == RB_BLACK) {
-        rb_remove_color(rbt, parent, child);
-    }
-
-    return old;
+    *prev = lyds_tree_prev(tree, ci, ni);
+    return LY_SUCCESS;
 }
 
 /**
- * @brief Insert new node to the Red-black tree.
+ * @brief Insert a data node into a lyds tree so that the tree remains sorted.
  *
- * @param[in,out] rbt Root of the Red-black tree. After the @p rbn is inserted, the root may change.
- * @param[in] rbn Node to insert.
- * @param[out] max_p Set to 1 if the inserted node will also be maximum.
+ * Data nodes with the same value are inserted after the existing ones.
+ *
+ * @param[in,out] tree lyds tree to modify.
+ * @param[in] node Data node to insert.
+ * @param[in,out] pool Optional pool of free chunks.
+ * @param[out] prev Data node preceding @p node in the tree, NULL if @p node is the first one.
+ * @param[out] max_p Optional, set to 1 if the inserted node is also the maximum.
+ * @return LY_ERR value.
  */
-static void
-rb_insert_node(struct rb_node **rbt, struct rb_node *rbn, ly_bool *max_p)
+static LY_ERR
+lyds_tree_insert(struct lyds_tree *tree, struct lyd_node *node, struct lyds_pool *pool, struct lyd_node **prev,
+        ly_bool *max_p)
 {
+    uint32_t ci, ni;
     ly_bool max;
-    struct rb_node *tmp;
-    struct rb_node *parent = NULL;
-    int comp = 0;
-
-    int (*rb_compare)(const struct lyd_node *n1, const struct lyd_node *n2);
-
-    if (RBN_DNODE(*rbt)->schema->nodetype == LYS_LEAFLIST) {
-        rb_compare = rb_compare_leaflists;
-    } else {
-        rb_compare = rb_compare_lists;
-    }
-
-    max = 1;
-    tmp = *rbt;
-    while (tmp != NULL) {
-        parent = tmp;
-
-        comp = rb_compare(RBN_DNODE(tmp), RBN_DNODE(rbn));
-        if (comp > 0) {
-            tmp = RBN_LEFT(tmp);
-            max = 0;
-        } else {
-            tmp = RBN_RIGHT(tmp);
-        }
-    }
-
-    rb_set(rbn, parent);
-
-    if (parent != NULL) {
-        if (comp > 0) {
-            RBN_LEFT(parent) = rbn;
-        } else {
-            RBN_RIGHT(parent) = rbn;
-        }
-    } else {
-        *rbt = rbn;
-    }
 
-    rb_insert_color(rbt, rbn);
+    lyds_tree_upper_bound(tree, node, &ci, &ni);
+    max = (ci == tree->count - 1) && (ni == tree->chunks[ci]->count);
+    LY_CHECK_RET(lyds_tree_insert_at(tree, ci, ni, node, pool, prev));
 
     if (max_p) {
         *max_p = max;
     }
+    return LY_SUCCESS;
 }
 
 /**
- * @brief Return the first lesser node (previous).
+ * @brief Remove a data node from a lyds tree at a position.
  *
- * @param[in] rbn Node from which the previous node is wanted.
- * @return Return the first lesser node.
- * @return NULL if @p rbn has the least value.
+ * Underfilled chunks are merged with their successors.
+ *
+ * @param[in,out] tree lyds tree to modify, it may remain without chunks.
+ * @param[in] ci Index of the chunk.
+ * @param[in] ni Index in the chunk.
  */
-static struct rb_node *
-rb_prev(struct rb_node *rbn)
+static void
+lyds_tree_remove_at(struct lyds_tree *tree, uint32_t ci, uint32_t ni)
 {
-    if (RBN_LEFT(rbn)) {
-        rbn = RBN_LEFT(rbn);
-        while (RBN_RIGHT(rbn)) {
-            rbn = RBN_RIGHT(rbn);
-        }
-    } else {
-        if (RBN_PARENT(rbn) && (rbn == RBN_RIGHT(RBN_PARENT(rbn)))) {
-            rbn = RBN_PARENT(rbn);
-        } else {
-            while (RBN_PARENT(rbn) &&
-                    (rbn == RBN_LEFT(RBN_PARENT(rbn)))) {
-                rbn = RBN_PARENT(rbn);
-            }
-            rbn = RBN_PARENT(rbn);
-        }
-    }
+    struct lyds_chunk *chunk, *next;
 
-    return rbn;
-}
+    chunk = tree->chunks[ci];
+    --chunk->count;
+    memmove(&chunk->dnodes[ni], &chunk->dnodes[ni + 1], (chunk->count - ni) * sizeof *chunk->dnodes);
 
-/**
- * @brief Return the first greater node (next).
- *
- * @param[in] rbn Node from which the next node is wanted.
- * @return Return the first greater node.
- * @return NULL if @p rbn has the greatest value.
- */
-static struct rb_node *
-rb_next(struct rb_node *rbn)
-{
-    if (RBN_RIGHT(rbn) != NULL) {
-        rbn = RBN_RIGHT(rbn);
-        while (RBN_LEFT(rbn) != NULL) {
-            rbn = RBN_LEFT(rbn);
-        }
-    } else {
-        if (RBN_PARENT(rbn) && (rbn == RBN_LEFT(RBN_PARENT(rbn)))) {
-            rbn = RBN_PARENT(rbn);
-        } else {
-            while (RBN_PARENT(rbn) &&
-                    (rbn == RBN_RIGHT(RBN_PARENT(rbn)))) {
-                rbn = RBN_PARENT(rbn);
-            }
-            rbn = RBN_PARENT(rbn);
-        }
+    if (!chunk->count) {
+        lyds_tree_del_chunk(tree, ci);
+        return;
     }
 
-    return rbn;
+    if ((ci + 1 < tree->count) && (chunk->count + tree->chunks[ci + 1]->count <= LYDS_CHUNK_SIZE / 4) &&
+            (chunk->count + tree->chunks[ci + 1]->count <= chunk->size)) {
+        /* merge with the next chunk */
+        next = tree->chunks[ci + 1];
+        memcpy(&chunk->dnodes[chunk->count], next->dnodes, next->count * sizeof *next->dnodes);
+        chunk->count += next->count;
+        lyds_tree_del_chunk(tree, ci + 1);
+    }
 }
 
 /**
- * @brief Find @p target value in the Red-black tree.
+ * @brief Remove all the data nodes starting at a position from a lyds tree.
  *
- * @param[in] rbt Root of the Red-black tree.
- * @param[in] target Node containing the value to find.
- * @return red-black node which contains the same value as @p target or NULL.
+ * @param[in,out] tree lyds tree to modify, it may remain without chunks.
+ * @param[in] ci Index of the chunk.
+ * @param[in] ni Index in the chunk.
  */
-static struct rb_node *
-rb_find(struct rb_node *rbt, struct lyd_node *target)
+static void
+lyds_tree_truncate(struct lyds_tree *tree, uint32_t ci, uint32_t ni)
 {
-    struct rb_node *iter, *pivot;
-    int comp;
-
-    int (*rb_compare)(const struct lyd_node *n1, const struct lyd_node *n2);
-
-    if (RBN_DNODE(rbt) == target) {
-        return rbt;
+    while (tree->count > ci + 1) {
+        lyds_tree_del_chunk(tree, tree->count - 1);
     }
 
-    if (RBN_DNODE(rbt)->schema->nodetype == LYS_LEAFLIST) {
-        rb_compare = rb_compare_leaflists;
-    } else {
-        rb_compare = rb_compare_lists;
+    tree->chunks[ci]->count = ni;
+    if (!ni) {
+        lyds_tree_del_chunk(tree, ci);
     }
-
-    iter = rbt;
-    do {
-        comp = rb_compare(RBN_DNODE(iter), target);
-        if (comp > 0) {
-            iter = RBN_LEFT(iter);
-        } else if (comp < 0) {
-            iter = RBN_RIGHT(iter);
-        } else if (RBN_DNODE(iter) == target) {
-            return iter;
-        } else {
-            /* sequential search in nodes having the same value */
-            pivot = iter;
-
-            /* search in predecessors */
-            for (iter = rb_prev(pivot); iter; iter = rb_prev(iter)) {
-                if (rb_compare(RBN_DNODE(iter), target) != 0) {
-                    break;
-                } else if (RBN_DNODE(iter) == target) {
-                    return iter;
-                }
-            }
-
-            /* search in successors */
-            for (iter = rb_next(pivot); iter; iter = rb_next(iter)) {
-                if (rb_compare(RBN_DNODE(iter), target) != 0) {
-                    break;
-                } else if (RBN_DNODE(iter) == target) {
-                    return iter;
-                }
-            }
-
-            /* node not found */
-            break;
-        }
-    } while (iter != NULL);
-
-    return NULL;
 }
 
 LY_ERR
-lyds_create_node(struct lyd_node *node, struct rb_node **rbn)
+lyds_create_tree(struct lyd_node *node, struct lyds_tree **tree)
 {
-    *rbn = calloc(1, sizeof **rbn);
-    LY_CHECK_ERR_RET(!(*rbn), LOGERR(LYD_CTX(node), LY_EMEM, "Allocation of red-black node failed."), LY_EMEM);
-    RBN_DNODE(*rbn) = node;
+    return lyds_tree_create(node, NULL, tree);
+}
 
-    return LY_SUCCESS;
+void
+lyds_free_tree(struct lyds_tree *tree)
+{
+    uint32_t ci;
+
+    if (!tree) {
+        return;
+    }
+
+    for (ci = 0; ci < tree->count; ++ci) {
+        free(tree->chunks[ci]);
+    }
+    free(tree->chunks);
+    free(tree);
 }
 
 void
 lyds_pool_add(struct lyd_node *leader, struct lyds_pool *pool)
 {
-    struct rb_node *rbt;
-    struct lyd_meta *root_meta, *tmp;
+    struct lyds_tree *tree;
+    struct lyd_meta *root_meta;
+    uint32_t ci;
 
     assert(pool && leader);
 
-    rbt = lyds_get_rb_tree(leader, &root_meta);
+    tree = lyds_get_tree(leader, &root_meta);
     if (root_meta) {
         lyd_unlink_meta_single(root_meta);
-        if (pool->meta) {
-            tmp = pool->meta;
-            pool->meta = root_meta;
-            root_meta->next = tmp;
-        } else {
-            pool->meta = root_meta;
-        }
+        root_meta->next = pool->meta;
+        pool->meta = root_meta;
+        LYDS_TREE_SET(root_meta, NULL);
     }
 
-    if (!rbt) {
+    if (!tree) {
         return;
     }
 
-    if (pool->rbn) {
-        RBN_RESET(pool->rbn, NULL);
-    }
-
-    if (pool->iter_state) {
-        /* insert rbn back */
-        assert(pool->rbn);
-        if (RBN_LEFT(pool->iter_state)) {
-            assert(!RBN_RIGHT(pool->iter_state));
-            RBN_RIGHT(pool->iter_state) = pool->rbn;
-        } else {
-            assert(!RBN_LEFT(pool->iter_state));
-            RBN_LEFT(pool->iter_state) = pool->rbn;
-        }
-        RBN_PARENT(pool->rbn) = pool->iter_state;
+    if (!pool->tree) {
+        /* the tree itself becomes the storage of free chunks */
+        pool->tree = tree;
+        return;
     }
 
-    if (pool->rbn) {
-        /* link rbt with rbn */
-        RBN_LEFT(pool->rbn) = rbt;
-        RBN_PARENT(rbt) = pool->rbn;
-        pool->rbn = rb_iter_begin(rbt, &pool->iter_state);
-    } else {
-        /* set new red black tree */
-        pool->rbn = rb_iter_begin(rbt, &pool->iter_state);
+    /* move the chunks to the pool, a chunk is freed if it cannot be added */
+    for (ci = 0; ci < tree->count; ++ci) {
+        lyds_tree_add_chunk(LYD_CTX(leader), pool->tree, pool->tree->count, tree->chunks[ci]);
     }
+    tree->count = 0;
+    lyds_free_tree(tree);
 }
 
 /**
@@ -927,58 +740,45 @@ void
 lyds_pool_clean(struct lyds_pool *pool)
 {
     struct lyd_meta *meta, *next;
-    struct rb_node *iter;
 
-    for (iter = pool->rbn; iter; iter = rb_iter_next(&pool->iter_state)) {
-        rb_free_node(&iter);
-    }
-    pool->rbn = NULL;
+    lyds_free_tree(pool->tree);
+    pool->tree = NULL;
 
     for (meta = pool->meta; meta; meta = next) {
         next = meta->next;
-        RBT_SET(meta, NULL);
+        LYDS_TREE_SET(meta, NULL);
         lyd_free_meta_single(meta);
     }
     pool->meta = NULL;
 }
 
 /**
- * @brief Remove red-black node from the Red-black tree using the data node.
+ * @brief Remove data node from the lyds tree.
  *
- * @param[in] root_meta Metadata from leader containing a reference to the Red-black tree.
- * @param[in,out] rbt Root of the Red-black tree.
- * @param[in] node Data node used to find the corresponding red-black node.
- * @param[out] removed Removed node from Red-black tree. It can be deallocated or reset for further use.
+ * @param[in] root_meta Metadata from leader containing a reference to the lyds tree. If the tree
+ * remains empty, it is freed.
+ * @param[in] node Data node to remove.
  */
 static void
-rb_remove_node(struct lyd_meta *root_meta, struct rb_node **rbt, struct lyd_node *node, struct rb_node **removed)
+lyds_remove_node(struct lyd_meta *root_meta, struct lyd_node *node)
 {
-    struct rb_node *rbn;
+    struct lyds_tree *tree;
+    uint32_t ci, ni;
 
-    assert(root_meta && rbt && node);
+    assert(root_meta && node);
 
-    if (!*rbt) {
-        return;
-    }
-
-    /* find @p node in the Red-black tree. */
-    rbn = rb_find(*rbt, node);
-    if (!rbn) {
+    LYDS_TREE_GET(root_meta, tree);
+    if (!tree || !lyds_tree_find(tree, node, &ci, &ni)) {
         /* node was not inserted to the lyds tree due to optimization */
         return;
     }
-    assert(RBN_DNODE(rbn) == node);
-
-    /* remove node */
-    rbn = rb_remove(rbt, rbn);
-    *removed = rbn;
-    if (rbn == *rbt) {
-        /* rbn was the last node, assurance that root will be set to NULL */
-        *rbt = NULL;
-    }
 
-    /* the root of the Red-black tree may changed due to removal, so update the pointer to the root */
-    RBT_SET(root_meta, *rbt);
+    lyds_tree_remove_at(tree, ci, ni);
+    if (!tree->count) {
+        /* the last node was removed */
+        lyds_free_tree(tree);
+        LYDS_TREE_SET(root_meta, NULL);
+    }
 }
 
 ly_bool
@@ -1014,22 +814,19 @@ lyds_move_meta(struct lyd_node *dst, struct lyd_meta *meta)
  * @param[in,out] first_sibling First sibling node.
  * @param[in,out] leader First instance of the (leaf-)list.
  * @param[in] node Data node to link.
- * @param[in] root_meta Metadata containing Red-black tree. Can be moved to a new leader.
- * @param[in] rbn red-black node of @p node.
+ * @param[in] root_meta Metadata containing lyds tree. Can be moved to a new leader.
+ * @param[in] prev Data node preceding @p node in the lyds tree, NULL if @p node is the least one.
  */
 static void
 lyds_link_data_node(struct lyd_node **first_sibling, struct lyd_node **leader, struct lyd_node *node,
-        struct lyd_meta *root_meta, struct rb_node *rbn)
+        struct lyd_meta *root_meta, struct lyd_node *prev)
 {
-    struct rb_node *prev;
-
     /* insert @p node also into the data node (struct lyd_node) siblings */
-    prev = rb_prev(rbn);
     if (prev) {
-        lyd_insert_after_node(first_sibling, RBN_DNODE(prev), RBN_DNODE(rbn));
+        lyd_insert_after_node(first_sibling, prev, node);
     } else {
         /* leader is no longer the first, the first is @p node */
-        lyd_insert_before_node(*leader, RBN_DNODE(rbn));
+        lyd_insert_before_node(*leader, node);
         *leader = node;
         /* move metadata from the old leader to the new one */
         lyds_move_meta(node, root_meta);
@@ -1039,33 +836,32 @@ lyds_link_data_node(struct lyd_node **first_sibling, struct lyd_node **leader, s
 }
 
 /**
- * @brief Additionally create the Red-black nodes.
+ * @brief Additionally insert data nodes into the lyds tree.
+ *
+ * Already sorted nodes are only appended at the end of the tree, the rest are also sorted.
  *
  * @param[in,out] first_sibling First sibling node.
  * @param[in,out] leader First instance of the (leaf-)list.
- * @param[in] root_meta From the @p leader, metadata in which is the root of the Red-black tree.
- * @param[in] rbt From the @p root_meta, root of the Red-black tree.
- * @param[in] node Start node from which rb nodes will be created.
+ * @param[in] root_meta From the @p leader, metadata in which is the lyds tree.
+ * @param[in] tree From the @p root_meta, lyds tree.
+ * @param[in] node Start node from which the nodes will be inserted.
+ * @param[in,out] pool Optional pool from which the lyds data will be reused.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyds_additionally_create_rb_nodes(struct lyd_node **first_sibling, struct lyd_node **leader,
-        struct lyd_meta *root_meta, struct rb_node **rbt, struct lyd_node *node)
+lyds_additionally_insert_nodes(struct lyd_node **first_sibling, struct lyd_node **leader,
+        struct lyd_meta *root_meta, struct lyds_tree *tree, struct lyd_node *node, struct lyds_pool *pool)
 {
-    LY_ERR ret;
     ly_bool max;
-    struct rb_node *rbn;
-    struct lyd_node *iter, *next;
+    struct lyd_node *iter, *next, *prev;
 
     for (iter = node; iter && (iter->schema == (*leader)->schema); iter = next) {
         next = iter->next;
-        ret = lyds_create_node(iter, &rbn);
-        LY_CHECK_RET(ret);
-        rb_insert_node(rbt, rbn, &max);
+        LY_CHECK_RET(lyds_tree_insert(tree, iter, pool, &prev, &max));
         if (!max) {
             /* nodes were not sorted, they will be sorted now */
             lyd_unlink_ignore_lyds(first_sibling, iter);
-            lyds_link_data_node(first_sibling, leader, iter, root_meta, rbn);
+            lyds_link_data_node(first_sibling, leader, iter, root_meta, prev);
             lyd_insert_hash(iter);
         }
     }
@@ -1074,77 +870,25 @@ lyds_additionally_create_rb_nodes(struct lyd_node **first_sibling, struct lyd_no
 }
 
 /**
- * @brief Additionally create the Red-black tree for the sorted nodes.
+ * @brief Additionally create the lyds tree for the sorted nodes.
  *
  * @param[in,out] first_sibling First sibling node.
  * @param[in,out] leader First instance of the (leaf-)list.
- * @param[in] root_meta From the @p leader, metadata in which is the root of the Red-black tree.
- * @param[in] rbt From the @p root_meta, root of the Red-black tree.
+ * @param[in] root_meta From the @p leader, metadata in which the lyds tree will be stored.
+ * @param[out] tree Created lyds tree.
+ * @param[in,out] pool Optional pool from which the lyds data will be reused.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyds_additionally_create_rb_tree(struct lyd_node **first_sibling, struct lyd_node **leader,
-        struct lyd_meta *root_meta, struct rb_node **rbt)
-{
-    LY_ERR ret;
-    struct rb_node *rbn;
-
-    /* let's begin with the leader */
-    ret = lyds_create_node(*leader, &rbn);
-    LY_CHECK_RET(ret);
-    *rbt = rbn;
-
-    /* continue with the rest of the nodes */
-    ret = lyds_additionally_create_rb_nodes(first_sibling, leader, root_meta, rbt, (*leader)->next);
-
-    /* store pointer to the root */
-    RBT_SET(root_meta, *rbt);
-
-    return ret;
-}
-
-/**
- * @brief Additionally reuse the Red-black tree for the sorted nodes.
- *
- * @param[in,out] first_sibling First sibling node.
- * @param[in,out] leader First instance of the (leaf-)list.
- * @param[in] root_meta From the @p leader, metadata in which is the root of the Red-black tree.
- * @param[in] rbt From the @p root_meta, root of the Red-black tree.
- * @param[in,out] pool Pool from which the lyds data will be reused
- * @param[out] next Data node for which no free red-black node was available,
- * so not all nodes have been processed. Or is set to NULL, so all were sorted successfully.
- */
-static void
-lyds_additionally_reuse_rb_tree(struct lyd_node **first_sibling, struct lyd_node **leader, struct lyd_meta *root_meta,
-        struct rb_node **rbt, struct lyds_pool *pool, struct lyd_node **next)
+lyds_additionally_create_tree(struct lyd_node **first_sibling, struct lyd_node **leader,
+        struct lyd_meta *root_meta, struct lyds_tree **tree, struct lyds_pool *pool)
 {
-    ly_bool max;
-    struct lyd_node *iter, *next_node;
-
     /* let's begin with the leader */
-    RBN_RESET(pool->rbn, *leader);
-    *rbt = pool->rbn;
-    pool->rbn = rb_iter_next(&pool->iter_state);
+    LY_CHECK_RET(lyds_tree_create(*leader, pool, tree));
+    LYDS_TREE_SET(root_meta, *tree);
 
     /* continue with the rest of the nodes */
-    for (iter = (*leader)->next; iter && (iter->schema == (*leader)->schema); iter = next_node) {
-        next_node = iter->next;
-        if (!pool->rbn) {
-            *next = iter;
-            return;
-        }
-        RBN_RESET(pool->rbn, iter);
-        rb_insert_node(rbt, pool->rbn, &max);
-        if (!max) {
-            /* nodes were not sorted, they will be sorted now */
-            lyd_unlink_ignore_lyds(first_sibling, iter);
-            lyds_link_data_node(first_sibling, leader, iter, root_meta, pool->rbn);
-            lyd_insert_hash(iter);
-        }
-        pool->rbn = rb_iter_next(&pool->iter_state);
-    }
-
-    *next = NULL;
+    return lyds_additionally_insert_nodes(first_sibling, leader, root_meta, *tree, (*leader)->next, pool);
 }
 
 LY_ERR
@@ -1157,7 +901,7 @@ lyds_create_metadata(struct lyd_node *leader, struct lyd_meta **meta_p)
 
     assert(leader && (!leader->prev->next || (leader->schema != leader->prev->schema)));
 
-    lyds_get_rb_tree(leader, &meta);
+    lyds_get_tree(leader, &meta);
     if (meta) {
         /* nothing to do, the metadata is already set */
         return LY_SUCCESS;
@@ -1172,7 +916,7 @@ lyds_create_metadata(struct lyd_node *leader, struct lyd_meta **meta_p)
     }
     LY_CHECK_ERR_RET(!modyang, LOGERR(LYD_CTX(leader), LY_EINT, "The yang module is not installed."), LY_EINT);
 
-    /* create new metadata, its rbt is NULL */
+    /* create new metadata, its tree is NULL */
     ret = lyd_create_meta(leader, &meta, modyang, "lyds_tree", 9, NULL, 0, 0, 1, NULL,
             LY_VALUE_CANON, NULL, LYD_HINT_DATA, NULL, 0, NULL);
     LY_CHECK_RET(ret);
@@ -1184,70 +928,40 @@ lyds_create_metadata(struct lyd_node *leader, struct lyd_meta **meta_p)
     return LY_SUCCESS;
 }
 
-/**
- * @brief Create and insert a new red-black node.
- *
- * The data node itself is not sorted. To to this, call the lyds_link_data_node().
- *
- * @param[in] node Data node to be accessed from the Red-black tree.
- * @param[in,out] rbt Root of the Red-black tree.
- * @param[out] rbn Created and inserted red-black node containing @p node.
- * @return LY_ERR value.
- */
-static LY_ERR
-rb_insert(struct lyd_node *node, struct rb_node **rbt, struct rb_node **rbn)
-{
-    LY_ERR ret;
-
-    /* create a new red-black node to which the @p node will be assigned */
-    ret = lyds_create_node(node, rbn);
-    LY_CHECK_RET(ret);
-
-    /* insert red-black node with @p node to the Red-black tree */
-    rb_insert_node(rbt, *rbn, NULL);
-
-    return LY_SUCCESS;
-}
-
 LY_ERR
 lyds_insert(struct lyd_node **first_sibling, struct lyd_node **leader, struct lyd_node *node)
 {
-    LY_ERR ret;
-    struct rb_node *rbt, *rbn;
+    struct lyds_tree *tree;
+    struct lyd_node *prev;
     struct lyd_meta *root_meta;
 
-    /* @p node must not be part of another Red-black tree, only single node can satisfy this condition */
+    /* @p node must not be part of another lyds tree, only single node can satisfy this condition */
     assert(LYD_NODE_IS_ALONE(node) && leader && node);
 
     /* Clear the @p node. It may have unnecessary data due to duplication or due to lyds_unlink() calls. */
-    rbt = lyds_get_rb_tree(node, &root_meta);
+    tree = lyds_get_tree(node, &root_meta);
     if (root_meta) {
-        assert(!rbt || (!RBN_LEFT(rbt) && !RBN_RIGHT(rbt)));
+        assert(!tree || ((tree->count == 1) && (tree->chunks[0]->count == 1)));
         /* metadata in @p node will certainly no longer be needed */
         lyd_free_meta_single(root_meta);
     }
 
-    /* get the Red-black tree from the @p leader */
-    rbt = lyds_get_rb_tree(*leader, &root_meta);
+    /* get the lyds tree from the @p leader */
+    tree = lyds_get_tree(*leader, &root_meta);
     if (!root_meta) {
         LY_CHECK_RET(lyds_create_metadata(*leader, &root_meta));
     }
-    if (!rbt) {
-        /* Due to optimization, the Red-black tree has not been created so far, so it will be
+    if (!tree) {
+        /* Due to optimization, the lyds tree has not been created so far, so it will be
          * created additionally now. It may still not be worth creating a tree and it may be better
          * to insert the node by linear search instead, but that is a case for further optimization.
          */
-        ret = lyds_additionally_create_rb_tree(first_sibling, leader, root_meta, &rbt);
-        LY_CHECK_RET(ret);
+        LY_CHECK_RET(lyds_additionally_create_tree(first_sibling, leader, root_meta, &tree, NULL));
     }
 
     /* Insert the node to the correct order. */
-    ret = rb_insert(node, &rbt, &rbn);
-    LY_CHECK_RET(ret);
-    lyds_link_data_node(first_sibling, leader, node, root_meta, rbn);
-
-    /* the root of the Red-black tree may changed due to insertion, so update the pointer to the root */
-    RBT_SET(root_meta, rbt);
+    LY_CHECK_RET(lyds_tree_insert(tree, node, NULL, &prev, NULL));
+    lyds_link_data_node(first_sibling, leader, node, root_meta, prev);
 
     return LY_SUCCESS;
 }
@@ -1256,12 +970,11 @@ LY_ERR
 lyds_insert2(struct lyd_node *parent, struct lyd_node **first_sibling, struct lyd_node **leader,
         struct lyd_node *node, struct lyds_pool *pool)
 {
-    LY_ERR ret;
-    struct rb_node *rbt = NULL, *rbn;
-    struct lyd_node *ld, *next;
+    struct lyds_tree *tree;
+    struct lyd_node *ld, *prev;
     struct lyd_meta *root_meta;
 
-    assert(pool && pool->rbn && first_sibling && node);
+    assert(pool && pool->tree && first_sibling && node);
 
     if (!*leader || ((*leader)->schema != node->schema)) {
         /* leader has not been visited yet */
@@ -1278,50 +991,29 @@ lyds_insert2(struct lyd_node *parent, struct lyd_node **first_sibling, struct ly
         }
     }
 
-    /* get Red-black tree from leader */
-    rbt = lyds_get_rb_tree(*leader, &root_meta);
+    /* get lyds tree from leader */
+    tree = lyds_get_tree(*leader, &root_meta);
     if (!root_meta) {
         /* leader needs metadata */
         root_meta = lyds_pool_get_meta(pool);
         if (!root_meta) {
             /* there is no free structure for metadata, a new one must be allocated */
-            ret = lyds_create_metadata(*leader, &root_meta);
-            LY_CHECK_RET(ret);
+            LY_CHECK_RET(lyds_create_metadata(*leader, &root_meta));
         } else {
             /* reuse metadata */
             lyd_insert_meta(*leader, root_meta, 0);
         }
     }
-    if (!rbt) {
-        /* Red-black tree needed */
-        lyds_additionally_reuse_rb_tree(first_sibling, leader, root_meta, &rbt, pool, &next);
-        if (next) {
-            /* there is no free structure for red-black node, a new ones must be allocated */
-            ret = lyds_additionally_create_rb_nodes(first_sibling, leader, root_meta, &rbt, next);
-            LY_CHECK_RET(ret);
-        }
+    if (!tree) {
+        /* lyds tree needed, reuse free chunks */
+        LY_CHECK_RET(lyds_additionally_create_tree(first_sibling, leader, root_meta, &tree, pool));
     }
 
-    /* insert @p node */
-    if (pool->rbn) {
-        /* reuse free red-black node and insert */
-        rbn = pool->rbn;
-        RBN_RESET(rbn, node);
-        rb_insert_node(&rbt, rbn, NULL);
-        /* prepare for the next node */
-        pool->rbn = rb_iter_next(&pool->iter_state);
-    } else {
-        /* allocate new node and insert */
-        ret = rb_insert(node, &rbt, &rbn);
-        LY_CHECK_RET(ret);
-    }
-    /* connect @p node with siblings so that the order is maintained */
-    lyds_link_data_node(first_sibling, leader, node, root_meta, rbn);
+    /* insert @p node and connect it with siblings so that the order is maintained */
+    LY_CHECK_RET(lyds_tree_insert(tree, node, pool, &prev, NULL));
+    lyds_link_data_node(first_sibling, leader, node, root_meta, prev);
 
 cleanup:
-    if (rbt) {
-        RBT_SET(root_meta, rbt);
-    }
     lyd_insert_hash(node);
     *first_sibling = node->prev->next ? *first_sibling : node;
 
@@ -1331,15 +1023,14 @@ cleanup:
 void
 lyds_unlink(struct lyd_node **leader, struct lyd_node *node)
 {
-    struct rb_node *rbt, *removed = NULL;
     struct lyd_meta *root_meta;
 
     if (!node || !leader || !*leader) {
         return;
     }
 
-    /* get the Red-black tree from the leader */
-    rbt = lyds_get_rb_tree(*leader, &root_meta);
+    /* get the lyds tree from the leader */
+    lyds_get_tree(*leader, &root_meta);
 
     /* find out if leader_p is alone */
     if (!root_meta || LYD_NODE_IS_ALONE(*leader)) {
@@ -1351,69 +1042,42 @@ lyds_unlink(struct lyd_node **leader, struct lyd_node *node)
         lyds_move_meta((*leader)->next, root_meta);
     }
 
-    rb_remove_node(root_meta, &rbt, node, &removed);
-    rb_free_node(&removed);
+    lyds_remove_node(root_meta, node);
 }
 
 void
 lyds_split(struct lyd_node **first_sibling, struct lyd_node *leader, struct lyd_node *node, struct lyd_node **next_p)
 {
-    struct rb_node *rbt, *rbn;
+    struct lyds_tree *tree;
     struct lyd_node *iter, *next, *start, *dst;
     struct lyd_meta *root_meta;
+    uint32_t ci, ni;
 
     assert(leader && node);
 
-    rbt = lyds_get_rb_tree(leader, &root_meta);
-    if (!rbt || (leader == node)) {
-        /* Second list is just unlinked */
-        start = node->next;
-        lyd_unlink_ignore_lyds(first_sibling, node);
-        dst = node;
-        LY_LIST_FOR_SAFE(start, next, iter) {
-            if (iter->schema != node->schema) {
-                break;
-            }
-            lyd_unlink_ignore_lyds(first_sibling, iter);
-            lyd_insert_after_node(&node, dst, iter);
-            dst = iter;
+    tree = lyds_get_tree(leader, &root_meta);
+    if (tree && (leader != node) && lyds_tree_find(tree, node, &ci, &ni)) {
+        /* @p node and all the following instances are at the end of the lyds tree */
+        lyds_tree_truncate(tree, ci, ni);
+        if (!tree->count) {
+            lyds_free_tree(tree);
+            LYDS_TREE_SET(root_meta, NULL);
         }
-        *next_p = iter;
-        return;
     }
 
+    /* unlink @p node and the rest of the nodes, they form the second (leaf-)list */
     start = node->next;
-    if (!start || (start->schema != node->schema)) {
-        /* @p node is the last node, remove from Red-black tree and unlink */
-        rb_remove_node(root_meta, &rbt, node, &rbn);
-        rb_free_node(&rbn);
-        lyd_unlink_ignore_lyds(first_sibling, node);
-        *next_p = start;
-        goto cleanup;
-    }
-
-    /* remove @p node from Red-black tree and unlink */
-    rb_remove_node(root_meta, &rbt, node, &rbn);
-    rb_free_node(&rbn);
     lyd_unlink_ignore_lyds(first_sibling, node);
-
-    /* remove the rest of nodes from Red-black tree and unlink */
     dst = node;
     LY_LIST_FOR_SAFE(start, next, iter) {
         if (iter->schema != node->schema) {
             break;
         }
-        rb_remove_node(root_meta, &rbt, iter, &rbn);
-        rb_free_node(&rbn);
         lyd_unlink_ignore_lyds(first_sibling, iter);
-        /* insert them to the second (leaf-)list */
         lyd_insert_after_node(&node, dst, iter);
         dst = iter;
     }
     *next_p = iter;
-
-cleanup:
-    RBT_SET(root_meta, rbt);
 }
 
 void
@@ -1422,18 +1086,18 @@ lyds_free_metadata(struct lyd_node *node)
     struct lyd_meta *root_meta;
 
     if (node) {
-        lyds_get_rb_tree(node, &root_meta);
+        lyds_get_tree(node, &root_meta);
         lyd_free_meta_single(root_meta);
     }
 }
 
 /**
- * @brief Merge nodes (src) without Red-black tree into (dst) nodes with Red-black tree.
+ * @brief Merge source nodes into destination nodes with lyds tree.
  *
  * @param[in,out] first_dst First sibling node, destination.
  * @param[in,out] leader_dst First instance of the destination (leaf-)list.
  * @param[in] root_meta_dst Metadata 'lyds_tree' from @p leader_dst.
- * @param[in] rbt_dst Root of the destination Red-black tree.
+ * @param[in] tree_dst Destination lyds tree.
  * @param[in,out] first_src First sibling node, source.
  * @param[in] leader_src First instance of the source (leaf-)list.
  * @param[out] next_p Data node located after source (leaf-)list.
@@ -1441,251 +1105,25 @@ lyds_free_metadata(struct lyd_node *node)
  * @return LY_ERR value.
  */
 static LY_ERR
-lyds_merge_nodes1(struct lyd_node **first_dst, struct lyd_node **leader_dst, struct lyd_meta *root_meta_dst,
-        struct rb_node *rbt_dst, struct lyd_node **first_src, struct lyd_node *leader_src, struct lyd_node **next_p)
+lyds_merge_nodes(struct lyd_node **first_dst, struct lyd_node **leader_dst, struct lyd_meta *root_meta_dst,
+        struct lyds_tree *tree_dst, struct lyd_node **first_src, struct lyd_node *leader_src, struct lyd_node **next_p)
 {
-    LY_ERR ret;
-    struct rb_node *rbn;
-    struct lyd_node *iter, *next;
+    struct lyd_node *iter, *next, *prev;
     const struct lysc_node *schema;
 
     schema = leader_src->schema;
     for (iter = leader_src; iter && (iter->schema == schema); iter = next) {
-        ret = rb_insert(iter, &rbt_dst, &rbn);
-        if (ret) {
+        if (lyds_tree_insert(tree_dst, iter, NULL, &prev, NULL)) {
             /* allocation failed, @p next_p must refer to failed node */
             break;
         }
         next = iter->next;
         lyd_unlink_ignore_lyds(first_src, iter);
-        lyds_link_data_node(first_dst, leader_dst, iter, root_meta_dst, rbn);
+        lyds_link_data_node(first_dst, leader_dst, iter, root_meta_dst, prev);
         lyd_insert_hash(iter);
     }
     *next_p = iter;
 
-    RBT_SET(root_meta_dst, rbt_dst);
-
-    return LY_SUCCESS;
-}
-
-/**
- * @brief Merge nodes which belongs before @p leader_dst.
- *
- * Reminder:
- * Merge nodes (src) with Red-black tree into (dst) nodes without Red-black tree.
- * Create red-black nodes from destination (leaf-)list and insert them into @p rbt_src.
- * At the end of the lyds_merge_nodes2(), rbt_src will move and become rbt_dst.
- *
- * @param[in,out] leader_dst First instance of the destination (leaf-)list.
- * @param[in,out] first_src First sibling node, source.
- * @param[in] leader_src First instance of the source (leaf-)list.
- * @param[in,out] rbt_src Root of the source Red-black tree.
- * @param[out] dst_iter Last merged node into the @p rbt_src.
- * @param[out] next_p On error, points to data node which failed to merge.
- * @return LY_ERR value.
- */
-static LY_ERR
-lyds_merge_nodes2_front(struct lyd_node **leader_dst, struct lyd_node **first_src, struct lyd_node *leader_src,
-        struct rb_node **rbt_src, struct rb_node **dst_iter, struct lyd_node **next_p)
-{
-    LY_ERR ret;
-    struct rb_node *prev, *iter;
-    struct lyd_node *dst;
-
-    /* insert destination leader */
-    ret = rb_insert(*leader_dst, rbt_src, dst_iter);
-    LY_CHECK_ERR_RET(ret, *next_p = leader_src, ret);
-
-    /* iterate over source RB tree and move the nodes belonging before destination leader */
-    prev = rb_prev(*dst_iter);
-    dst = *leader_dst;
-    for (iter = prev; iter; iter = rb_prev(iter)) {
-        lyd_unlink_ignore_lyds(first_src, RBN_DNODE(iter));
-        lyd_insert_before_node(dst, RBN_DNODE(iter));
-        lyd_insert_hash(RBN_DNODE(iter));
-        dst = RBN_DNODE(iter);
-    }
-    if (prev) {
-        *leader_dst = dst;
-    }
-
-    return LY_SUCCESS;
-}
-
-/**
- * @brief Merge nodes which belongs between destination (leaf-)list nodes.
- *
- * Reminder:
- * Merge nodes (src) with Red-black tree into (dst) nodes without Red-black tree.
- * Create red-black nodes from destination (leaf-)list and insert them into @p rbt_src.
- * At the end of the lyds_merge_nodes2(), rbt_src will move and become rbt_dst.
- *
- * @param[in,out] first_dst First sibling node, destination.
- * @param[in,out] leader_dst First instance of the destination (leaf-)list.
- * @param[in,out] first_src First sibling node, source.
- * @param[in,out] rbt_src Root of the source Red-black tree.
- * @param[out] dst_iter Last merged node into the @p rbt_src.
- * @param[out] next_p On error, points to data node which failed to merge.
- * @return LY_ERR value.
- */
-static LY_ERR
-lyds_merge_nodes2_among(struct lyd_node **first_dst, struct lyd_node **leader_dst, struct lyd_node **first_src,
-        struct rb_node **rbt_src, struct rb_node **dst_iter, struct lyd_node **next_p)
-{
-    LY_ERR ret;
-    struct rb_node *rbn, *iter, *rbn_prev;
-    struct lyd_node *dst, *node;
-    const struct lysc_node *schema;
-
-    schema = (*leader_dst)->schema;
-    rbn = *dst_iter;
-    for (node = RBN_DNODE(*dst_iter); node->next && (node->schema == schema); node = dst->next) {
-        /* insert node from destination (leaf-)list into @p rbt_src */
-        rbn_prev = rbn;
-        ret = rb_insert(node->next, rbt_src, &rbn);
-        LY_CHECK_ERR_RET(ret, *next_p = RBN_DNODE(rb_next(rbn_prev)), ret);
-
-        dst = node;
-        /* move source data nodes between next-to-last inserted node and last inserted node */
-        for (iter = rb_next(rbn_prev); iter != rbn; iter = rb_next(iter)) {
-            lyd_unlink_ignore_lyds(first_src, RBN_DNODE(iter));
-            /* insert source data nodes into destination (leaf-)list */
-            lyd_insert_after_node(first_dst, dst, RBN_DNODE(iter));
-            lyd_insert_hash(RBN_DNODE(iter));
-            dst = RBN_DNODE(iter);
-        }
-    }
-    *dst_iter = rbn;
-
-    return LY_SUCCESS;
-}
-
-/**
- * @brief Merge nodes which belongs after destination (leaf-)list nodes.
- *
- * Reminder:
- * Merge nodes (src) with Red-black tree into (dst) nodes without Red-black tree.
- * Create red-black nodes from destination (leaf-)list and insert them into @p rbt_src.
- * At the end of the lyds_merge_nodes2(), rbt_src will move and become rbt_dst.
- *
- * @param[in,out] first_dst First sibling node, destination.
- * @param[in,out] first_src First sibling node, source.
- * @param[in] dst_iter Last merged node into the @p rbt_src.
- * @param[out] next_p Data node located after source (leaf-)list.
- */
-static void
-lyds_merge_nodes2_back(struct lyd_node **first_dst, struct lyd_node **first_src, struct rb_node *dst_iter,
-        struct lyd_node **next_p)
-{
-    struct rb_node *iter, *begin;
-    struct lyd_node *dst;
-
-    begin = rb_next(dst_iter);
-    LY_CHECK_RET(!begin,; );
-    dst = RBN_DNODE(dst_iter);
-    for (iter = begin; iter; iter = rb_next(iter)) {
-        *next_p = RBN_DNODE(iter)->next;
-        lyd_unlink_ignore_lyds(first_src, RBN_DNODE(iter));
-        lyd_insert_after_node(first_dst, dst, RBN_DNODE(iter));
-        lyd_insert_hash(RBN_DNODE(iter));
-        dst = RBN_DNODE(iter);
-    }
-}
-
-/**
- * @brief Merge nodes (src) with Red-black tree into (dst) nodes without Red-black tree.
- *
- * Create red-black nodes from destination (leaf-)list and insert them into @p rbt_src.
- * At the end of the lyds_merge_nodes2(), rbt_src will move and become rbt_dst.
- *
- * @param[in,out] first_dst First sibling node, destination.
- * @param[in,out] leader_dst First instance of the destination (leaf-)list.
- * @param[in,out] first_src First sibling node, source.
- * @param[in] leader_src First instance of the source (leaf-)list.
- * @param[in] root_meta_src Metadata 'lyds_tree' from @p leader_src.
- * @param[in] rbt_src Root of the source Red-black tree.
- * @param[out] next_p Data node located after source (leaf-)list.
- * On error, points to data node which failed to merge.
- * @return LY_ERR value.
- */
-static LY_ERR
-lyds_merge_nodes2(struct lyd_node **first_dst, struct lyd_node **leader_dst,
-        struct lyd_node **first_src, struct lyd_node *leader_src, struct lyd_meta *root_meta_src,
-        struct rb_node *rbt_src, struct lyd_node **next_p)
-{
-    LY_ERR ret;
-    struct rb_node *dst_iter;
-
-    /* merge first destination node, move source nodes which belongs before this node */
-    ret = lyds_merge_nodes2_front(leader_dst, first_src, leader_src, &rbt_src, &dst_iter, next_p);
-    LY_CHECK_GOTO(ret, cleanup);
-    *first_dst = !(*first_dst)->prev->next ? *first_dst : *leader_dst;
-
-    /* RB tree si moved from source to destination (leaf-)list */
-    lyds_move_meta(*leader_dst, root_meta_src);
-
-    /* merge the rest of the destination nodes, move corresponding source nodes */
-    ret = lyds_merge_nodes2_among(first_dst, leader_dst, first_src, &rbt_src, &dst_iter, next_p);
-    LY_CHECK_GOTO(ret, cleanup);
-
-    /* move the rest of the source nodes */
-    lyds_merge_nodes2_back(first_dst, first_src, dst_iter, next_p);
-
-    if (*next_p && ((*next_p)->schema == (*leader_dst)->schema)) {
-        ret = lyds_merge_nodes1(first_dst, leader_dst, root_meta_src, rbt_src, first_src, *next_p, next_p);
-    }
-
-cleanup:
-    RBT_SET(root_meta_src, rbt_src);
-
-    return ret;
-}
-
-/**
- * @brief Merge nodes (src) with Red-black tree into (dst) nodes with Red-black tree.
- *
- * Possible improvement: find out which rb_tree is bigger and then move nodes into it.
- * Current implementation blindly guesses that the source Red-black tree is smaller.
- *
- * @param[in,out] first_dst First sibling node, destination.
- * @param[in,out] leader_dst First instance of the destination (leaf-)list.
- * @param[in] root_meta_dst Metadata 'lyds_tree' from @p leader_dst.
- * @param[in] rbt_dst Root of the destination Red-black tree.
- * @param[in,out] first_src First sibling node, source.
- * @param[in] root_meta_src Metadata 'lyds_tree' from @p leader_src.
- * @param[in] rbt_src Root of the source Red-black tree.
- * @param[out] next_p Data node located after source (leaf-)list.
- * @return LY_ERR value.
- */
-static LY_ERR
-lyds_merge_nodes3(struct lyd_node **first_dst, struct lyd_node **leader_dst, struct lyd_meta *root_meta_dst,
-        struct rb_node *rbt_dst, struct lyd_node **first_src, struct lyd_meta *root_meta_src,
-        struct rb_node *rbt_src, struct lyd_node **next_p)
-{
-    struct rb_node *iter, *iter_state;
-    struct lyd_node *node;
-
-    /* release source RB tree */
-    RBT_SET(root_meta_src, NULL);
-    lyd_free_meta_single(root_meta_src);
-
-    /* 'randomly' iterate over all source nodes, merge and move to the destination */
-    for (iter = rb_iter_begin(rbt_src, &iter_state); iter; iter = rb_iter_next(&iter_state)) {
-        node = RBN_DNODE(iter);
-        *next_p = node->next;
-        RBN_RESET(iter, node);
-        rb_insert_node(&rbt_dst, iter, NULL);
-        lyd_unlink_ignore_lyds(first_src, node);
-        lyds_link_data_node(first_dst, leader_dst, node, root_meta_dst, iter);
-        lyd_insert_hash(node);
-    }
-
-    if (!*next_p || ((*next_p)->schema != (*leader_dst)->schema)) {
-        RBT_SET(root_meta_dst, rbt_dst);
-    } else {
-        LY_CHECK_RET(lyds_merge_nodes1(first_dst, leader_dst, root_meta_dst, rbt_dst, first_src, *next_p, next_p));
-    }
-
     return LY_SUCCESS;
 }
 
@@ -1693,38 +1131,29 @@ LY_ERR
 lyds_merge(struct lyd_node **first_dst, struct lyd_node **leader_dst, struct lyd_node **first_src,
         struct lyd_node *leader_src, struct lyd_node **next_p)
 {
-    LY_ERR ret = LY_SUCCESS;
-    struct rb_node *rbt_dst, *rbt_src;
-    struct lyd_meta *root_meta_dst, *root_meta_src = NULL;
+    struct lyds_tree *tree_dst;
+    struct lyd_meta *root_meta_dst, *root_meta_src;
 
     assert(leader_dst && leader_src && next_p);
 
-    rbt_dst = lyds_get_rb_tree(*leader_dst, &root_meta_dst);
-    rbt_src = lyds_get_rb_tree(leader_src, &root_meta_src);
+    tree_dst = lyds_get_tree(*leader_dst, &root_meta_dst);
+    lyds_get_tree(leader_src, &root_meta_src);
 
-    if (root_meta_src && !rbt_src) {
-        /* Release unnecessary metadata which can be empty, e.g. when duplicating a node */
+    if (root_meta_src) {
+        /* the source nodes are inserted into the destination lyds tree, the source one is not needed */
         lyd_free_meta_single(root_meta_src);
     }
 
-    if (!rbt_dst && !rbt_src) {
-        /* create RB tree from destination nodes, merge and move source nodes */
-        LY_CHECK_RET(lyds_create_metadata(*leader_dst, &root_meta_dst));
-        LY_CHECK_RET(lyds_additionally_create_rb_tree(first_dst, leader_dst, root_meta_dst, &rbt_dst));
-        ret = lyds_merge_nodes1(first_dst, leader_dst, root_meta_dst, rbt_dst, first_src, leader_src, next_p);
-    } else if (rbt_dst && !rbt_src) {
-        /* just merge and move source nodes */
-        ret = lyds_merge_nodes1(first_dst, leader_dst, root_meta_dst, rbt_dst, first_src, leader_src, next_p);
-    } else if (!rbt_dst && rbt_src) {
-        /* merge destination nodes with RB tree, move RB tree and source nodes */
-        ret = lyds_merge_nodes2(first_dst, leader_dst, first_src, leader_src, root_meta_src, rbt_src, next_p);
-    } else {
-        /* merge and move source nodes, release source RB tree */
-        assert(rbt_dst && rbt_src);
-        lyds_merge_nodes3(first_dst, leader_dst, root_meta_dst, rbt_dst, first_src, root_meta_src, rbt_src, next_p);
+    if (!tree_dst) {
+        /* create lyds tree from destination nodes */
+        if (!root_meta_dst) {
+            LY_CHECK_RET(lyds_create_metadata(*leader_dst, &root_meta_dst));
+        }
+        LY_CHECK_RET(lyds_additionally_create_tree(first_dst, leader_dst, root_meta_dst, &tree_dst, NULL));
     }
 
-    return ret;
+    /* merge and move source nodes */
+    return lyds_merge_nodes(first_dst, leader_dst, root_meta_dst, tree_dst, first_src, leader_src, next_p);
 }
 
 int
@@ -1735,8 +1164,8 @@ lyds_compare_single(struct lyd_node *node1, struct lyd_node *node2)
     if (node1 == node2) {
         return 0;
     } else if (node1->schema->nodetype == LYS_LEAFLIST) {
-        return rb_compare_leaflists(node1, node2);
+        return lyds_compare_leaflists(node1, node2);
     } else {
-        return rb_compare_lists(node1, node2);
+        return lyds_compare_lists(node1, node2);
     }
 }
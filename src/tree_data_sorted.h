@@ -1,7 +1,7 @@
 /**
  * @file tree_data_sorted.h
  * @author Adam Piecek <piecek@cesnet.cz>
- * @brief Binary search tree (BST) for sorting data nodes.
+ * @brief Index for sorting data nodes.
  *
  * Copyright (c) 2015 - 2023 CESNET, z.s.p.o.
  *
@@ -18,11 +18,12 @@
 #include "log.h"
 
 struct lyd_node;
-struct rb_node;
+struct lyds_tree;
 struct lyd_meta;
 
 /* This functionality applies to list and leaf-list with the "ordered-by system" statement,
- * which is implicit. The BST is implemented using a Red-black tree and is used for sorting nodes.
+ * which is implicit. The index is implemented as a B+tree with a single inner level (sorted array of chunks
+ * of sorted data node references) and is used for sorting nodes.
  * For example, a list of valid users would typically be sorted alphabetically. This tree is saved
  * in the first instance of the leaf-list/list in the metadata named lyds_tree. Thanks to the tree,
  * it is possible to insert a sibling data node in such a way that the order of the nodes is preserved.
@@ -33,22 +34,20 @@ struct lyd_meta;
  */
 
 /**
- * @brief BST and 'lyds_tree' metadata pool.
+ * @brief lyds tree and 'lyds_tree' metadata pool.
  *
- * The structure stores a free Red-black tree and metadata, which can be reused. Thanks to this,
+ * The structure stores free chunks of lyds trees and metadata, which can be reused. Thanks to this,
  * it is possible to work with data more efficiently and thus prevent repeated allocation and freeing of memory.
  */
 struct lyds_pool {
-    struct rb_node *rbn;            /**< The current free node to use. If set, the pool is not empty. */
+    struct lyds_tree *tree;         /**< Tree holding the free chunks to use. If set, the pool is not empty. */
     struct lyd_meta *meta;          /**< Pointer to the list of free 'lyds_tree' metadata to reuse. */
-    /* Private items */
-    struct rb_node *iter_state;     /**< Internal iterator over a Red-black tree. Pointer to a successor. */
 };
 
 /**
  * @brief Check that ordering is supported for the @p node.
  *
- * If the function returns 0 for a given node, other lyds_* or rb_* functions must not be called for this node.
+ * If the function returns 0 for a given node, other lyds_* functions must not be called for this node.
  *
  * @param[in] node Node to check. Expected (leaf-)list or list with key(s).
  * @return 1 if @p node can be sorted.
@@ -68,23 +67,23 @@ ly_bool lyds_is_supported(const struct lyd_node *node);
  * @brief Create the 'lyds_tree' metadata.
  *
  * @param[in] leader First instance of the (leaf-)list. If the node already contains the metadata,
- * then nothing happens. The BST is unchanged or empty.
+ * then nothing happens. The lyds tree is unchanged or empty.
  * @param[out] meta Newly created 'lyds_tree' metadata.
  * @return LY_ERR value.
  */
 LY_ERR lyds_create_metadata(struct lyd_node *leader, struct lyd_meta **meta);
 
 /**
- * @brief Create new BST node.
+ * @brief Create new lyds tree.
  *
- * @param[in] node Data node to link with new red-black node.
- * @param[out] rbn Created red-black node.
+ * @param[in] node The first data node of the tree.
+ * @param[out] tree Created lyds tree.
  * @return LY_SUCCESS on success.
  */
-LY_ERR lyds_create_node(struct lyd_node *node, struct rb_node **rbn);
+LY_ERR lyds_create_tree(struct lyd_node *node, struct lyds_tree **tree);
 
 /**
- * @brief Insert the @p node into BST and into @p leader's siblings.
+ * @brief Insert the @p node into lyds tree and into @p leader's siblings.
  *
  * Sibling data nodes of the @p leader are also modified for sorting to take place.
  * The function automatically take care of lyds_create_metadata() and lyds_create_tree() calls.
@@ -99,7 +98,7 @@ LY_ERR lyds_create_node(struct lyd_node *node, struct rb_node **rbn);
 LY_ERR lyds_insert(struct lyd_node **first_sibling, struct lyd_node **leader, struct lyd_node *node);
 
 /**
- * @brief Insert the @p node into BST and into @p leader's siblings and use @p pool.
+ * @brief Insert the @p node into lyds tree and into @p leader's siblings and use @p pool.
  *
  * @param[in] parent Parent to insert into, NULL for top-level sibling.
  * @param[in,out] first_sibling First sibling, NULL if no top-level sibling exist yet.
@@ -115,10 +114,10 @@ LY_ERR lyds_insert2(struct lyd_node *parent, struct lyd_node **first_sibling, st
         struct lyd_node *node, struct lyds_pool *pool);
 
 /**
- * @brief Unlink (remove) the specified data node from BST.
+ * @brief Unlink (remove) the specified data node from lyds tree.
  *
  * Pointers in sibling data nodes (lyd_node) are NOT modified. This means that the data node is NOT unlinked.
- * Even if the BST will remain empty, lyds_tree metadata will remain.
+ * Even if the lyds tree will remain empty, lyds_tree metadata will remain.
  * Hash for data nodes is not removed.
  *
  * @param[in,out] leader First instance of (leaf-)list. If it is NULL, nothing happens.
@@ -164,9 +163,9 @@ void lyds_split(struct lyd_node **first_sibling, struct lyd_node *leader, struct
  *
  * @param[in,out] first_dst First sibling node, destination.
  * @param[in,out] leader_dst Destination (leaf-)list, first instance. It may not contain
- * the lyds_tree metadata or BST. After merge @p leader_dst can be reset to new leader.
+ * the lyds_tree metadata or lyds tree. After merge @p leader_dst can be reset to new leader.
  * @param[in,out] first_src First sibling node, source.
- * @param[in] leader_src Source (leaf-)list, first instance. It may not contain the lyds_tree metadata or BST.
+ * @param[in] leader_src Source (leaf-)list, first instance. It may not contain the lyds_tree metadata or lyds tree.
  * @param[out] next Data node located after source (leaf-)list.
  * On error, points to data node which failed to merge.
  * @return LY_ERR value.
@@ -186,19 +185,19 @@ LY_ERR lyds_merge(struct lyd_node **first_dst, struct lyd_node **leader_dst, str
 int lyds_compare_single(struct lyd_node *node1, struct lyd_node *node2);
 
 /**
- * @brief Release the metadata including BST.
+ * @brief Release the metadata including lyds tree.
  *
  * No more nodes can be inserted after the function is executed.
  *
- * @param[in] node Data node of the type (leaf-)list that may contain metadata and BST.
+ * @param[in] node Data node of the type (leaf-)list that may contain metadata and lyds tree.
  */
 void lyds_free_metadata(struct lyd_node *node);
 
 /**
- * @brief Release all BST nodes including the root.
+ * @brief Release the lyds tree.
  *
- * @param[in] rbt Root of the Red-black tree.
+ * @param[in] tree lyds tree to free, can be NULL.
  */
-void lyds_free_tree(struct rb_node *rbt);
+void lyds_free_tree(struct lyds_tree *tree);
 
 #endif /* _LYDS_TREE_H_ */
@@ -27,6 +27,7 @@
 #include "context.h"
 #include "dict.h"
 #include "hash_table.h"
+#include "hash_table_internal.h"
 #include "in.h"
 #include "in_internal.h"
 #include "log.h"
@@ -2813,3 +2814,183 @@ lys_stmt_flags(enum ly_stmt stmt)
 
     return 0;
 }
+
+/**
+ * @brief Hash table value-equal callback for identity closure records.
+ *
+ * Implementation of ::lyht_value_equal_cb.
+ */
+static ly_bool
+lys_ident_closure_equal_cb(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lys_ident_closure_rec *rec1 = *(struct lys_ident_closure_rec **)val1_p;
+    struct lys_ident_closure_rec *rec2 = *(struct lys_ident_closure_rec **)val2_p;
+
+    return rec1->ident == rec2->ident;
+}
+
+/**
+ * @brief Hash table free callback for identity closure records.
+ *
+ * @param[in] val_p Pointer to the record pointer.
+ */
+static void
+lys_ident_closure_rec_free(void *val_p)
+{
+    struct lys_ident_closure_rec *rec = *(struct lys_ident_closure_rec **)val_p;
+
+    LY_ARRAY_FREE(rec->bases);
+    free(rec);
+}
+
+/**
+ * @brief Find an identity closure record.
+ *
+ * @param[in] ht Closure hash table.
+ * @param[in] ident Identity of the record.
+ * @return Found record, NULL if not found.
+ */
+static struct lys_ident_closure_rec *
+lys_ident_closure_find(const struct ly_ht *ht, const struct lysc_ident *ident)
+{
+    struct lys_ident_closure_rec rec_key = {.ident = ident}, *rec_p = &rec_key, **match_p;
+
+    if (lyht_find(ht, &rec_p, lyht_hash((const char *)&ident, sizeof ident), (void **)&match_p)) {
+        return NULL;
+    }
+    return *match_p;
+}
+
+/**
+ * @brief Compare 2 identity pointers, for qsort() and bsearch().
+ */
+static int
+lys_ident_closure_ptr_cmp(const void *ptr1, const void *ptr2)
+{
+    uintptr_t ident1 = (uintptr_t)*(const struct lysc_ident **)ptr1;
+    uintptr_t ident2 = (uintptr_t)*(const struct lysc_ident **)ptr2;
+
+    return (ident1 > ident2) - (ident1 < ident2);
+}
+
+/**
+ * @brief Add a base identity into the closure of all the identities derived from it.
+ *
+ * @param[in] ht Closure hash table.
+ * @param[in] base Base identity.
+ * @param[in] derived Derived identities of @p base or of one of its derived identities.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lys_ident_closure_add_base_r(struct ly_ht *ht, const struct lysc_ident *base, struct lysc_ident **derived)
+{
+    LY_ARRAY_COUNT_TYPE u;
+    struct lys_ident_closure_rec *rec;
+    const struct lysc_ident **base_p;
+
+    LY_ARRAY_FOR(derived, u) {
+        rec = lys_ident_closure_find(ht, derived[u]);
+        if (!rec) {
+            /* identity not in the context, should not happen */
+            continue;
+        }
+        if (LY_ARRAY_COUNT(rec->bases) && (rec->bases[LY_ARRAY_COUNT(rec->bases) - 1] == base)) {
+            /* reached again through another base, the derived identities were processed already */
+            continue;
+        }
+
+        LY_ARRAY_NEW_RET(NULL, rec->bases, base_p, LY_EMEM);
+        *base_p = base;
+
+        LY_CHECK_RET(lys_ident_closure_add_base_r(ht, base, derived[u]->derived));
+    }
+
+    return LY_SUCCESS;
+}
+
+void
+lys_ident_closure_build(struct ly_ctx *ctx)
+{
+    struct ly_ht *ht = NULL;
+    struct lys_ident_closure_rec *rec;
+    const struct lys_module *mod;
+    const struct lysc_ident *ident;
+    uint32_t i, hash;
+    LY_ARRAY_COUNT_TYPE u;
+
+    if (ctx->ident_closure_ht) {
+        /* up-to-date */
+        return;
+    }
+
+    ht = lyht_new(LYHT_MIN_SIZE, sizeof rec, lys_ident_closure_equal_cb, NULL, 1);
+    LY_CHECK_GOTO(!ht, error);
+
+    /* a record for every identity */
+    i = 0;
+    while ((mod = ly_ctx_get_module_iter(ctx, &i))) {
+        LY_ARRAY_FOR(mod->identities, u) {
+            ident = &mod->identities[u];
+            rec = calloc(1, sizeof *rec);
+            LY_CHECK_GOTO(!rec, error);
+            rec->ident = ident;
+
+            hash = lyht_hash((const char *)&ident, sizeof ident);
+            if (lyht_insert(ht, &rec, hash, NULL)) {
+                free(rec);
+                goto error;
+            }
+        }
+    }
+
+    /* add every identity as a base of all its (transitive) derived identities */
+    i = 0;
+    while ((mod = ly_ctx_get_module_iter(ctx, &i))) {
+        LY_ARRAY_FOR(mod->identities, u) {
+            LY_CHECK_GOTO(lys_ident_closure_add_base_r(ht, &mod->identities[u], mod->identities[u].derived), error);
+        }
+    }
+
+    /* sort the bases */
+    i = 0;
+    while ((mod = ly_ctx_get_module_iter(ctx, &i))) {
+        LY_ARRAY_FOR(mod->identities, u) {
+            rec = lys_ident_closure_find(ht, &mod->identities[u]);
+            if (!rec->bases) {
+                continue;
+            }
+            qsort(rec->bases, LY_ARRAY_COUNT(rec->bases), sizeof *rec->bases, lys_ident_closure_ptr_cmp);
+        }
+    }
+
+    ctx->ident_closure_ht = ht;
+    return;
+
+error:
+    /* not fatal, the closure is just not used */
+    lyht_free(ht, lys_ident_closure_rec_free);
+}
+
+void
+lys_ident_closure_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->ident_closure_ht, lys_ident_closure_rec_free);
+    ctx->ident_closure_ht = NULL;
+}
+
+LY_ERR
+lys_ident_closure_isderived(const struct lysc_ident *base, const struct lysc_ident *der)
+{
+    const struct ly_ht *ht = base->module->ctx->ident_closure_ht;
+    struct lys_ident_closure_rec *rec;
+
+    if (!ht || !(rec = lys_ident_closure_find(ht, der))) {
+        /* no closure or the identity is not a part of it (extension instance identity) */
+        return LY_ENOT;
+    }
+
+    if (!rec->bases || !bsearch(&base, rec->bases, LY_ARRAY_COUNT(rec->bases), sizeof *rec->bases, lys_ident_closure_ptr_cmp)) {
+        return LY_ENOTFOUND;
+    }
+    return LY_SUCCESS;
+}
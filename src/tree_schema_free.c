@@ -18,10 +18,12 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include "cbor.h"
 #include "compat.h"
 #include "dict.h"
 #include "log.h"
 #include "ly_common.h"
+#include "lyb.h"
 #include "plugins_exts.h"
 #include "plugins_types.h"
 #include "tree.h"
@@ -791,6 +793,7 @@ lysc_ident_derived_unlink(const struct lysc_ident *ident)
                 LY_ARRAY_FOR(mod->identities[v].derived, w) {
                     if (mod->identities[v].derived[w] == ident) {
                         /* remove the link */
+                        lys_ident_closure_free(ident->module->ctx);
                         LY_ARRAY_DECREMENT(mod->identities[v].derived);
                         if (!LY_ARRAY_COUNT(mod->identities[v].derived)) {
                             LY_ARRAY_FREE(mod->identities[v].derived);
@@ -1280,6 +1283,15 @@ lysc_module_free(struct lysf_ctx *ctx, struct lysc_module *module)
         return;
     }
 
+    /* free any secondary data indexes referencing the nodes */
+    lyd_index_free_module(module->mod->ctx, module->mod);
+
+    /* drop the cached LYB hashes of schema siblings, they may reference the nodes */
+    lyb_sibs_free(module->mod->ctx);
+
+    /* drop the resolved SIDs, they may reference the nodes */
+    ly_sid_resolved_free(module->mod->ctx);
+
     LY_LIST_FOR_SAFE(module->data, node_next, node) {
         lysc_node_free_(ctx, node);
     }
@@ -1312,6 +1324,10 @@ lys_module_free(struct lysf_ctx *ctx, struct lys_module *module, ly_bool remove_
             lysc_ident_derived_unlink(&module->identities[u]);
         }
     }
+    if (module->identities) {
+        lys_ident_closure_free(module->ctx);
+        ly_sid_resolved_free(module->ctx);
+    }
     FREE_ARRAY(ctx, module->identities, lysc_ident_free);
     lysp_module_free(ctx, module->parsed);
 
@@ -737,4 +737,42 @@ uint8_t lys_stmt_flags(enum ly_stmt stmt);
  */
 LY_ERR lyplg_ext_get_storage_p(const struct lysc_ext_instance *ext, int stmt, void ***storage_pp);
 
+/**
+ * @brief Identity with all its (transitive) base identities, record of ::ly_ctx.ident_closure_ht.
+ */
+struct lys_ident_closure_rec {
+    const struct lysc_ident *ident;     /**< identity */
+    const struct lysc_ident **bases;    /**< all the identities @p ident is derived from, sorted by their address
+                                             ([sized array](@ref sizedarrays)) */
+};
+
+/**
+ * @brief Create the identity derivation closure of a context, if not up-to-date.
+ *
+ * Failure to create it is not an error, derivation of the identities is then learned by traversing
+ * ::lysc_ident.derived.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lys_ident_closure_build(struct ly_ctx *ctx);
+
+/**
+ * @brief Free the identity derivation closure of a context, must be called whenever any ::lysc_ident.derived
+ * array changes or an identity is freed.
+ *
+ * @param[in] ctx Context to use.
+ */
+void lys_ident_closure_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Learn whether an identity is derived from another identity using the identity derivation closure.
+ *
+ * @param[in] base Base identity.
+ * @param[in] der Possibly derived identity.
+ * @return LY_SUCCESS if @p der is derived from @p base.
+ * @return LY_ENOTFOUND if @p der is not derived from @p base.
+ * @return LY_ENOT if the closure cannot be used.
+ */
+LY_ERR lys_ident_closure_isderived(const struct lysc_ident *base, const struct lysc_ident *der);
+
 #endif /* LY_TREE_SCHEMA_INTERNAL_H_ */
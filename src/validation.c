@@ -29,6 +29,7 @@
 #include "ly_common.h"
 #include "parser_data.h"
 #include "parser_internal.h"
+#include "plugins_internal.h"
 #include "plugins_exts.h"
 #include "plugins_exts/metadata.h"
 #include "plugins_types.h"
@@ -395,8 +396,13 @@ lyd_validate_unres_when(struct lyd_node **tree, const struct lys_module *mod, st
         node = node_when->dnodes[i];
         LOG_LOCSET(node->schema, node);
 
-        /* evaluate all when expressions that affect this node's existence */
-        r = lyd_validate_node_when(*tree, node, node->schema, xpath_options, &disabled);
+        /* evaluate all when expressions that affect this node's existence, unless their cached result is valid */
+        if (!xpath_options && lyd_when_cache_valid(node)) {
+            r = LY_SUCCESS;
+            disabled = NULL;
+        } else {
+            r = lyd_validate_node_when(*tree, node, node->schema, xpath_options, &disabled);
+        }
         if (!r) {
             if (disabled) {
                 /* when false */
@@ -420,6 +426,9 @@ lyd_validate_unres_when(struct lyd_node **tree, const struct lys_module *mod, st
             } else {
                 /* when true */
                 node->flags |= LYD_WHEN_TRUE;
+                if (!xpath_options) {
+                    lyd_when_cache_store(node);
+                }
             }
 
             /* remove this node from the set keeping the order, its when was resolved */
@@ -446,6 +455,7 @@ lyd_validate_unres(struct lyd_node **tree, const struct lys_module *mod, enum ly
 {
     LY_ERR r, rc = LY_SUCCESS;
     uint32_t i;
+    ly_bool lref_cache = 0;
 
     if (ext_val && ext_val->count) {
         /* first validate parsed extension data */
@@ -504,6 +514,9 @@ lyd_validate_unres(struct lyd_node **tree, const struct lys_module *mod, enum ly
     }
 
     if (node_types && node_types->count) {
+        /* the tree is not modified while validating the values so the leafref targets can be cached */
+        lyplg_type_leafref_cache_start(&lref_cache);
+
         /* finish incompletely validated terminal values (traverse from the end for efficient set removal) */
         i = node_types->count;
         do {
@@ -521,6 +534,11 @@ lyd_validate_unres(struct lyd_node **tree, const struct lys_module *mod, enum ly
             /* remove this node from the set */
             ly_set_rm_index(node_types, i, NULL);
         } while (i);
+
+        if (lref_cache) {
+            lyplg_type_leafref_cache_stop();
+            lref_cache = 0;
+        }
     }
 
     if (meta_types && meta_types->count) {
@@ -543,6 +561,9 @@ lyd_validate_unres(struct lyd_node **tree, const struct lys_module *mod, enum ly
     }
 
 cleanup:
+    if (lref_cache) {
+        lyplg_type_leafref_cache_stop();
+    }
     return rc;
 }
 
@@ -1096,7 +1117,7 @@ lyd_validate_mandatory(const struct lyd_node *first, const struct lyd_node *pare
     } else {
         assert(snode->nodetype & (LYS_LEAF | LYS_CONTAINER | LYD_NODE_ANY));
 
-        if (!lyd_find_sibling_val(first, snode, NULL, 0, NULL)) {
+        if (!lyd_find_sibling_val_(first, snode, NULL, 0, NULL)) {
             /* data instance found */
             return LY_SUCCESS;
         }
@@ -1158,6 +1179,16 @@ lyd_validate_minmax(const struct lyd_node *first, const struct lyd_node *parent,
 
     assert(min || max);
 
+    if (parent && !lyd_cons_count(parent, snode, &count)) {
+        if ((count >= min) && (!max || (count <= max))) {
+            /* maintained list constraint state, satisfied */
+            return LY_SUCCESS;
+        }
+
+        /* find the instances for the error */
+        count = 0;
+    }
+
     LYD_LIST_FOR_INST(first, snode, iter) {
         last_iter = iter;
         ++count;
@@ -1272,13 +1303,57 @@ lyd_val_uniq_find_leaf(const struct lysc_node_leaf *uniq_leaf, const struct lyd_
 
         /* find iter instance in children */
         assert(iter->nodetype & (LYS_CONTAINER | LYS_LEAF));
-        lyd_find_sibling_val(lyd_child(node), iter, NULL, 0, &node);
+        lyd_find_sibling_val_(lyd_child(node), iter, NULL, 0, &node);
         --depth;
     }
 
     return node;
 }
 
+const struct lyd_value *
+lyd_val_uniq_value(const struct lysc_node_leaf *uniq_leaf, const struct lyd_node *list)
+{
+    struct lyd_node *diter;
+
+    diter = lyd_val_uniq_find_leaf(uniq_leaf, list);
+    if (diter) {
+        return &((struct lyd_node_term *)diter)->value;
+    }
+
+    /* use default value */
+    return uniq_leaf->dflt;
+}
+
+LY_ERR
+lyd_val_uniq_hash(const struct lysc_node_leaf **unique, const struct lyd_node *list, uint32_t *hash)
+{
+    const struct lyd_value *val;
+    LY_ARRAY_COUNT_TYPE v;
+    const void *hash_key;
+    size_t key_len;
+    ly_bool dyn;
+
+    *hash = 0;
+    LY_ARRAY_FOR(unique, v) {
+        val = lyd_val_uniq_value(unique[v], list);
+        if (!val) {
+            /* unique item not present nor has default value */
+            return LY_ENOT;
+        }
+
+        /* get hash key */
+        hash_key = val->realtype->plugin->print(NULL, val, LY_VALUE_LYB, NULL, &dyn, &key_len);
+        *hash = lyht_hash_multi(*hash, hash_key, key_len);
+        if (dyn) {
+            free((void *)hash_key);
+        }
+    }
+
+    /* finish the hash value */
+    *hash = lyht_hash_multi(*hash, NULL, 0);
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Unique list validation callback argument.
  */
@@ -1297,8 +1372,8 @@ lyd_val_uniq_list_equal(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *c
 {
     struct ly_ctx *ctx;
     struct lysc_node_list *slist;
-    struct lyd_node *diter, *first, *second;
-    struct lyd_value *val1, *val2;
+    struct lyd_node *first, *second;
+    const struct lyd_value *val1, *val2;
     char *path1, *path2, *uniq_str, *ptr;
     LY_ARRAY_COUNT_TYPE u, v;
     struct lyd_val_uniq_arg *arg = cb_data;
@@ -1326,23 +1401,8 @@ lyd_val_uniq_list_equal(void *val1_p, void *val2_p, ly_bool UNUSED(mod), void *c
     LY_ARRAY_FOR(slist->uniques, u) {
 uniquecheck:
         LY_ARRAY_FOR(slist->uniques[u], v) {
-            /* first */
-            diter = lyd_val_uniq_find_leaf(slist->uniques[u][v], first);
-            if (diter) {
-                val1 = &((struct lyd_node_term *)diter)->value;
-            } else {
-                /* use default value */
-                val1 = slist->uniques[u][v]->dflt;
-            }
-
-            /* second */
-            diter = lyd_val_uniq_find_leaf(slist->uniques[u][v], second);
-            if (diter) {
-                val2 = &((struct lyd_node_term *)diter)->value;
-            } else {
-                /* use default value */
-                val2 = slist->uniques[u][v]->dflt;
-            }
+            val1 = lyd_val_uniq_value(slist->uniques[u][v], first);
+            val2 = lyd_val_uniq_value(slist->uniques[u][v], second);
 
             if (!val1 || !val2 || val1->realtype->plugin->compare(ctx, val1, val2)) {
                 /* values differ or either one is not set */
@@ -1403,30 +1463,33 @@ uniquecheck:
  * @brief Validate list unique leaves.
  *
  * @param[in] first First sibling to search in.
+ * @param[in] parent Data parent.
  * @param[in] snode Schema node to validate.
  * @param[in] uniques List unique arrays to validate.
  * @param[in] val_opts Validation options.
  * @return LY_ERR value.
  */
 static LY_ERR
-lyd_validate_unique(const struct lyd_node *first, const struct lysc_node *snode, const struct lysc_node_leaf ***uniques,
-        uint32_t val_opts)
+lyd_validate_unique(const struct lyd_node *first, const struct lyd_node *parent, const struct lysc_node *snode,
+        const struct lysc_node_leaf ***uniques, uint32_t val_opts)
 {
     const struct lyd_node *diter;
     struct ly_set *set;
     LY_ARRAY_COUNT_TYPE u, v, x = 0;
     LY_ERR ret = LY_SUCCESS;
     uint32_t hash, i;
-    size_t key_len;
-    ly_bool dyn;
-    const void *hash_key;
+    ly_bool dup;
     struct lyd_val_uniq_arg arg, *args = NULL;
     struct ly_ht **uniqtables = NULL;
-    struct lyd_value *val;
     struct ly_ctx *ctx = snode->module->ctx;
 
     assert(uniques);
 
+    if (parent && !lyd_cons_unique(parent, snode, &dup) && !dup) {
+        /* maintained list constraint state, no instances with the same unique values */
+        return LY_SUCCESS;
+    }
+
     /* get all list instances */
     LY_CHECK_RET(ly_set_new(&set));
     LY_LIST_FOR(first, diter) {
@@ -1462,35 +1525,11 @@ lyd_validate_unique(const struct lyd_node *first, const struct lysc_node *snode,
         for (i = 0; i < set->count; i++) {
             /* loop for unique - get the hash for the instances */
             for (u = 0; u < x; u++) {
-                val = NULL;
-                for (v = hash = 0; v < LY_ARRAY_COUNT(uniques[u]); v++) {
-                    diter = lyd_val_uniq_find_leaf(uniques[u][v], set->objs[i]);
-                    if (diter) {
-                        val = &((struct lyd_node_term *)diter)->value;
-                    } else {
-                        /* use default value */
-                        val = uniques[u][v]->dflt;
-                    }
-                    if (!val) {
-                        /* unique item not present nor has default value */
-                        break;
-                    }
-
-                    /* get hash key */
-                    hash_key = val->realtype->plugin->print(NULL, val, LY_VALUE_LYB, NULL, &dyn, &key_len);
-                    hash = lyht_hash_multi(hash, hash_key, key_len);
-                    if (dyn) {
-                        free((void *)hash_key);
-                    }
-                }
-                if (!val) {
+                if (lyd_val_uniq_hash(uniques[u], set->objs[i], &hash)) {
                     /* skip this list instance since its unique set is incomplete */
                     continue;
                 }
 
-                /* finish the hash value */
-                hash = lyht_hash_multi(hash, NULL, 0);
-
                 /* insert into the hashtable */
                 ret = lyht_insert(uniqtables[u], &set->objs[i], hash, NULL);
                 if (ret == LY_EEXIST) {
@@ -1588,7 +1627,7 @@ lyd_validate_siblings_schema_r(const struct lyd_node *first, const struct lyd_no
 
             /* check unique */
             if (slist->uniques) {
-                r = lyd_validate_unique(first, snode, (const struct lysc_node_leaf ***)slist->uniques, val_opts);
+                r = lyd_validate_unique(first, parent, snode, (const struct lysc_node_leaf ***)slist->uniques, val_opts);
                 LY_VAL_ERR_GOTO(r, rc = r, val_opts, cleanup);
             }
         } else if (snode->nodetype == LYS_LEAFLIST) {
@@ -1961,6 +2000,9 @@ lyd_validate_subtree(struct lyd_node *root, struct ly_set *node_when, struct ly_
             if (val_opts & LYD_VALIDATE_NO_DEFAULTS) {
                 impl_opts |= LYD_IMPLICIT_NO_DEFAULTS;
             }
+            if (val_opts & LYD_VALIDATE_VIRTUAL_DEFAULTS) {
+                impl_opts |= LYD_IMPLICIT_VIRTUAL_DFLT;
+            }
             r = lyd_new_implicit(node, lyd_node_child_p(node), NULL, NULL, NULL, NULL, NULL, impl_opts, getnext_ht, diff);
             LY_CHECK_ERR_GOTO(r, rc = r, cleanup);
         }
@@ -2007,6 +2049,9 @@ lyd_validate(struct lyd_node **tree, const struct lys_module *module, const stru
         ext_val_p = &ext_val;
     }
 
+    /* lazily parsed LYB subtrees are validated as well */
+    LY_CHECK_RET(lyd_lyb_stub_load_siblings(*tree));
+
     next = *tree;
     while (1) {
         if (val_opts & LYD_VALIDATE_PRESENT) {
@@ -2042,6 +2087,9 @@ lyd_validate(struct lyd_node **tree, const struct lys_module *module, const stru
         if (val_opts & LYD_VALIDATE_NO_DEFAULTS) {
             impl_opts |= LYD_IMPLICIT_NO_DEFAULTS;
         }
+        if (val_opts & LYD_VALIDATE_VIRTUAL_DEFAULTS) {
+            impl_opts |= LYD_IMPLICIT_VIRTUAL_DFLT;
+        }
         if (validate_subtree) {
             r = lyd_new_implicit(lyd_parent(*first2), first2, NULL, mod, NULL, NULL, NULL, impl_opts, getnext_ht, diff);
             LY_CHECK_ERR_GOTO(r, rc = r, cleanup);
@@ -2161,6 +2209,7 @@ lyd_validate_all(struct lyd_node **tree, const struct ly_ctx *ctx, uint32_t val_
 {
     LY_CHECK_ARG_RET(NULL, tree, *tree || ctx, LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, *tree ? LYD_CTX(*tree) : NULL, ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(*tree));
     if (!ctx) {
         ctx = LYD_CTX(*tree);
     }
@@ -2176,6 +2225,7 @@ lyd_validate_module(struct lyd_node **tree, const struct lys_module *module, uin
 {
     LY_CHECK_ARG_RET(NULL, tree, module, !(val_opts & LYD_VALIDATE_PRESENT), LY_EINVAL);
     LY_CHECK_CTX_EQUAL_RET(__func__, *tree ? LYD_CTX(*tree) : NULL, module->ctx, LY_EINVAL);
+    LY_CHECK_RET(lyd_frozen_check(*tree));
     if (diff) {
         *diff = NULL;
     }
@@ -2245,7 +2295,7 @@ lyd_val_op_merge_find(const struct lyd_node *op_tree, const struct lyd_node *op_
     cur_depth = op_depth;
     while (cur_depth && tree_iter) {
         /* find op iter in tree */
-        lyd_find_sibling_first(tree_iter, op_iter, &match);
+        lyd_find_sibling_first_(tree_iter, op_iter, &match);
         if (!match) {
             break;
         }
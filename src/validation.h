@@ -26,6 +26,8 @@ struct ly_set;
 struct lyd_node;
 struct lys_module;
 struct lysc_node;
+struct lysc_node_leaf;
+struct lyd_value;
 
 /**
  * @brief Cached getnext schema nodes stored in a validation HT.
@@ -36,6 +38,27 @@ struct lyd_val_getnext {
     const struct lysc_node **choices;   /**< array of choice schema node children terminated by NULL */
 };
 
+/**
+ * @brief Get the value of a list unique leaf in a list instance.
+ *
+ * @param[in] uniq_leaf Unique leaf.
+ * @param[in] list List instance.
+ * @return Value of the @p uniq_leaf instance, its default value if not instantiated;
+ * @return NULL if there is no value.
+ */
+const struct lyd_value *lyd_val_uniq_value(const struct lysc_node_leaf *uniq_leaf, const struct lyd_node *list);
+
+/**
+ * @brief Get the hash of the values of a list unique in a list instance.
+ *
+ * @param[in] unique Unique leaves.
+ * @param[in] list List instance.
+ * @param[out] hash Hash of all the values.
+ * @return LY_SUCCESS on success;
+ * @return LY_ENOT if some of the leaves has no value.
+ */
+LY_ERR lyd_val_uniq_hash(const struct lysc_node_leaf **unique, const struct lyd_node *list, uint32_t *hash);
+
 /**
  * @brief Create a getnext cached schema node validation HT.
  *
@@ -1290,31 +1290,41 @@ LY_ERR
 lyxml_dump_text(struct ly_out *out, const char *text, ly_bool attribute)
 {
     LY_ERR ret;
+    size_t len, span;
 
     if (!text) {
         return 0;
     }
 
-    for (uint64_t u = 0; text[u]; u++) {
-        switch (text[u]) {
+    for (len = strlen(text); len; ++text, --len) {
+        /* write the run of characters that need no escaping at once */
+        span = ly_strncspn(text, len, attribute ? "&<>\"" : "&<>", 0);
+        if (span) {
+            LY_CHECK_RET(ly_write_(out, text, span));
+            text += span;
+            len -= span;
+            if (!len) {
+                break;
+            }
+        }
+
+        switch (*text) {
         case '&':
-            ret = ly_print_(out, "&amp;");
+            ret = ly_print_lit(out, "&amp;");
             break;
         case '<':
-            ret = ly_print_(out, "&lt;");
+            ret = ly_print_lit(out, "&lt;");
             break;
         case '>':
             /* not needed, just for readability */
-            ret = ly_print_(out, "&gt;");
+            ret = ly_print_lit(out, "&gt;");
             break;
         case '"':
-            if (attribute) {
-                ret = ly_print_(out, "&quot;");
-                break;
-            }
-        /* fall through */
+            ret = ly_print_lit(out, "&quot;");
+            break;
         default:
-            ret = ly_write_(out, &text[u], 1);
+            LOGINT(NULL);
+            ret = LY_EINT;
             break;
         }
         LY_CHECK_RET(ret);
@@ -20,10 +20,12 @@
 #include <ctype.h>
 #include <errno.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "compat.h"
 #include "context.h"
@@ -328,9 +330,9 @@ print_set_debug(struct lyxp_set *set)
                 break;
             case LYXP_NODE_ELEM:
                 if (item->node->schema && (item->node->schema->nodetype == LYS_LIST) &&
-                        (lyd_child(item->node)->schema->nodetype == LYS_LEAF)) {
+                        (lyd_child_load(item->node)->schema->nodetype == LYS_LEAF)) {
                     LOGDBG(LY_LDGXPATH, "\t%d (pos %u): ELEM %s (1st child val: %s)", i + 1, item->pos,
-                            item->node->schema->name, lyd_get_value(lyd_child(item->node)));
+                            item->node->schema->name, lyd_get_value(lyd_child_load(item->node)));
                 } else if (lyd_get_value(item->node)) {
                     LOGDBG(LY_LDGXPATH, "\t%d (pos %u): ELEM %s (val: %s)", i + 1, item->pos,
                             LYD_NAME(item->node), lyd_get_value(item->node));
@@ -495,7 +497,7 @@ cast_string_recursive(const struct lyd_node *node, struct lyxp_set *set, uint32_
     } else {
         if (node->schema) {
             nodetype = node->schema->nodetype;
-        } else if (lyd_child(node)) {
+        } else if (lyd_child_load(node)) {
             nodetype = LYS_CONTAINER;
         } else {
             nodetype = LYS_LEAF;
@@ -510,7 +512,7 @@ cast_string_recursive(const struct lyd_node *node, struct lyxp_set *set, uint32_
             strcpy(*str + (*used - 1), "\n");
             ++(*used);
 
-            for (child = lyd_child(node); child; child = child->next) {
+            for (child = lyd_child_load(node); child; child = child->next) {
                 LY_CHECK_RET(cast_string_recursive(child, set, indent + 1, str, used, size));
             }
 
@@ -1468,6 +1470,11 @@ get_node_pos(const struct lyd_node *node, enum lyxp_node_type node_type, const s
         return 0;
     }
 
+    if ((node->flags & LYD_DFLT_VIRTUAL) && node->schema && (node->schema->nodetype & LYD_NODE_TERM)) {
+        /* virtual default leaf is not in the tree, it shares the position of its parent */
+        node = lyd_parent(node);
+    }
+
     if (*prev) {
         /* start from the previous element instead from the root */
         pos = *prev_pos;
@@ -1589,6 +1596,40 @@ get_meta_pos(struct lyd_meta *meta)
     return pos;
 }
 
+/**
+ * @brief Compare 2 different nodes with the same position, see ::LYD_DFLT_VIRTUAL.
+ *
+ * Virtual default leaves follow their parent and are ordered by their schema nodes.
+ *
+ * @param[in] node1 1st node.
+ * @param[in] node2 2nd node.
+ * @return If 1st > 2nd returns 1, 1st < 2nd returns -1.
+ */
+static int
+set_sort_compare_virtual(const struct lyd_node *node1, const struct lyd_node *node2)
+{
+    const struct lysc_node *iter;
+
+    if (!(node1->flags & LYD_DFLT_VIRTUAL) || (node1->schema->nodetype & LYD_NODE_INNER)) {
+        /* parent of the 2nd node */
+        assert(lyd_parent(node2) == node1);
+        return -1;
+    } else if (!(node2->flags & LYD_DFLT_VIRTUAL) || (node2->schema->nodetype & LYD_NODE_INNER)) {
+        /* parent of the 1st node */
+        assert(lyd_parent(node1) == node2);
+        return 1;
+    }
+
+    /* both virtual leaves of a single parent */
+    assert(lyd_parent(node1) == lyd_parent(node2));
+    for (iter = node1->schema; iter; iter = iter->next) {
+        if (iter == node2->schema) {
+            return -1;
+        }
+    }
+    return 1;
+}
+
 /**
  * @brief Compare 2 nodes in respect to XPath document order.
  *
@@ -1638,6 +1679,11 @@ set_sort_compare(struct lyxp_set_node *item1, struct lyxp_set_node *item2)
         return 0;
     }
 
+    /* 1st ELEM - 2nd ELEM, at least one is a virtual default leaf sharing the position of its parent */
+    if ((item1->type == LYXP_NODE_ELEM) && (item2->type == LYXP_NODE_ELEM)) {
+        return set_sort_compare_virtual(item1->node, item2->node);
+    }
+
     /* 1st ELEM - 2nd TEXT, 1st ELEM - any pos - 2nd META */
     /* elem is always first, 2nd node is after it */
     if (item1->type == LYXP_NODE_ELEM) {
@@ -5839,7 +5885,7 @@ moveto_axis_node_next_dfs_forward(const struct lyd_node *iter, const struct lyd_
     const struct lyd_node *next = NULL;
 
     /* 1) child */
-    next = lyd_child(iter);
+    next = lyd_child_load(iter);
     if (!next) {
         if (iter == stop) {
             /* reached stop, no more descendants */
@@ -5873,8 +5919,8 @@ moveto_axis_node_next_dfs_backward(const struct lyd_node *iter, const struct lyd
 
     /* 1) previous sibling innermost last child */
     next = iter->prev->next ? iter->prev : NULL;
-    while (next && lyd_child(next)) {
-        next = lyd_child(next);
+    while (next && lyd_child_load(next)) {
+        next = lyd_child_load(next);
         next = next->prev;
     }
 
@@ -5944,7 +5990,7 @@ moveto_axis_node_next_first(const struct lyd_node **iter, enum lyxp_node_type *i
             next_type = next ? LYXP_NODE_ELEM : 0;
         } else {
             /* search in children */
-            next = lyd_child(node);
+            next = lyd_child_load(node);
             next_type = next ? LYXP_NODE_ELEM : 0;
         }
         break;
@@ -6109,6 +6155,51 @@ moveto_axis_node_next(const struct lyd_node **iter, enum lyxp_node_type *iter_ty
     return next_type ? LY_SUCCESS : LY_ENOTFOUND;
 }
 
+/**
+ * @brief Add the matching virtual default leaves (::LYD_DFLT_VIRTUAL) of a node into a set.
+ *
+ * @param[in] parent Parent node of the virtual leaves.
+ * @param[in] set Set to read general context from.
+ * @param[in] moveto_mod Matching node module, NULL for no prefix.
+ * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] options XPath options.
+ * @param[in] dup_check Whether duplicates in @p result are possible and must be skipped.
+ * @param[in,out] result Set to add the matching leaves to.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+moveto_node_virtual(const struct lyd_node *parent, const struct lyxp_set *set, const struct lys_module *moveto_mod,
+        const char *ncname, uint32_t options, ly_bool dup_check, struct lyxp_set *result)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct ly_set vset = {0};
+    uint32_t i;
+
+    if (!(parent->flags & LYD_DFLT_VIRTUAL) || !parent->schema || !(parent->schema->nodetype & LYD_NODE_INNER)) {
+        return LY_SUCCESS;
+    }
+
+    LY_CHECK_GOTO(rc = lyd_dflt_virtual_children(parent, &vset), cleanup);
+    for (i = 0; i < vset.count; ++i) {
+        if (moveto_node_check(vset.dnodes[i], LYXP_NODE_ELEM, set, ncname, moveto_mod, options)) {
+            /* not a match, virtual leaves have no when */
+            continue;
+        }
+        if (dup_check) {
+            result->non_child_axis = 1;
+            if (set_dup_node_check(result, vset.dnodes[i], LYXP_NODE_ELEM, -1)) {
+                continue;
+            }
+        }
+
+        set_insert_node(result, vset.dnodes[i], 0, LYXP_NODE_ELEM, result->used);
+    }
+
+cleanup:
+    ly_set_erase(&vset, NULL);
+    return rc;
+}
+
 /**
  * @brief Move context @p set to a node. Result is LYXP_SET_NODE_SET. Context position aware.
  *
@@ -6142,10 +6233,25 @@ moveto_node(struct lyxp_set *set, const struct lys_module *moveto_mod, const cha
     set_init(&result, set);
 
     for (i = 0; i < set->used; ++i) {
+        if (((axis == LYXP_AXIS_CHILD) || (axis == LYXP_AXIS_DESCENDANT)) &&
+                (set->val.nodes[i].type == LYXP_NODE_ELEM)) {
+            /* virtual default children, they precede the real ones */
+            rc = moveto_node_virtual(set->val.nodes[i].node, set, moveto_mod, ncname, options,
+                    axis == LYXP_AXIS_DESCENDANT, &result);
+            LY_CHECK_GOTO(rc, cleanup);
+        }
+
         /* iterate over all the nodes on the axis of the node */
         iter = NULL;
         iter_type = 0;
         while (!moveto_axis_node_next(&iter, &iter_type, set->val.nodes[i].node, set->val.nodes[i].type, axis, set)) {
+            if (((axis == LYXP_AXIS_DESCENDANT) || (axis == LYXP_AXIS_DESCENDANT_OR_SELF)) &&
+                    (iter_type == LYXP_NODE_ELEM)) {
+                /* virtual default children of every descendant */
+                rc = moveto_node_virtual(iter, set, moveto_mod, ncname, options, 1, &result);
+                LY_CHECK_GOTO(rc, cleanup);
+            }
+
             r = moveto_node_check(iter, iter_type, set, ncname, moveto_mod, options);
             if (r == LY_EINCOMPLETE) {
                 rc = r;
@@ -6263,19 +6369,23 @@ moveto_node_hash_child(struct lyxp_set *set, const struct lysc_node *scnode, con
             siblings = set->tree;
         } else if (set->val.nodes[i].type == LYXP_NODE_ELEM) {
             /* search in children */
-            siblings = lyd_child(set->val.nodes[i].node);
+            siblings = lyd_child_load(set->val.nodes[i].node);
         }
 
         /* find the node using hashes */
         if (inst) {
-            r = lyd_find_sibling_first(siblings, inst, &sub);
+            r = lyd_find_sibling_first_(siblings, inst, &sub);
         } else {
-            r = lyd_find_sibling_val(siblings, scnode, NULL, 0, &sub);
+            r = lyd_find_sibling_val_(siblings, scnode, NULL, 0, &sub);
         }
         if (r == LY_ENOTFOUND) {
             /* may still be an opaque node */
             r = lyd_find_sibling_opaq_next(siblings, scnode->name, &sub);
         }
+        if ((r == LY_ENOTFOUND) && !inst && (set->val.nodes[i].type == LYXP_NODE_ELEM)) {
+            /* or a virtual default leaf */
+            r = lyd_dflt_virtual_get(set->val.nodes[i].node, scnode, &sub);
+        }
         LY_CHECK_ERR_GOTO(r && (r != LY_ENOTFOUND), ret = r, cleanup);
 
         /* when check */
@@ -6302,6 +6412,84 @@ cleanup:
     return ret;
 }
 
+/**
+ * @brief Move context @p set to list instance children using a secondary index. Result is LYXP_SET_NODE_SET.
+ * Context position aware.
+ *
+ * @param[in,out] set Set to use.
+ * @param[in] scnode Matching list schema node.
+ * @param[in] leaf Indexed leaf of @p scnode.
+ * @param[in] value Value of @p leaf the list instances must have.
+ * @param[in] options XPath options.
+ * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
+ */
+static LY_ERR
+moveto_node_index_child(struct lyxp_set *set, const struct lysc_node *scnode, const struct lysc_node *leaf,
+        const struct lyd_value *value, uint32_t options)
+{
+    LY_ERR ret = LY_SUCCESS;
+    uint32_t i, j;
+    struct lyxp_set result;
+    struct ly_set entries = {0};
+    struct lyd_node *sub;
+
+    assert(scnode && (scnode->nodetype == LYS_LIST) && leaf);
+
+    /* init result set */
+    set_init(&result, set);
+
+    if (options & LYXP_SKIP_EXPR) {
+        goto cleanup;
+    }
+
+    if (set->type != LYXP_SET_NODE_SET) {
+        LOGVAL(set->ctx, LY_VCODE_XP_INOP_1, "path operator", print_set_type(set));
+        ret = LY_EVALID;
+        goto cleanup;
+    }
+
+    /* context check for all the nodes since we have the schema node */
+    if ((set->root_type == LYXP_NODE_ROOT_CONFIG) && (scnode->flags & LYS_CONFIG_R)) {
+        lyxp_set_free_content(set);
+        goto cleanup;
+    }
+
+    for (i = 0; i < set->used; ++i) {
+        if (set->val.nodes[i].type != LYXP_NODE_ELEM) {
+            /* top-level list instances are never indexed */
+            continue;
+        }
+
+        /* find the instances using the index */
+        entries.count = 0;
+        LY_CHECK_GOTO(ret = lyd_index_find(set->val.nodes[i].node, leaf, value, &entries), cleanup);
+
+        for (j = 0; j < entries.count; ++j) {
+            sub = entries.dnodes[j];
+
+            /* when check */
+            if (!(options & LYXP_IGNORE_WHEN) && lysc_has_when(sub->schema) && !(sub->flags & LYD_WHEN_TRUE)) {
+                ret = LY_EINCOMPLETE;
+                goto cleanup;
+            }
+
+            /* pos filled later */
+            set_insert_node(&result, sub, 0, LYXP_NODE_ELEM, result.used);
+        }
+    }
+
+    /* move result to the set */
+    lyxp_set_free_content(set);
+    *set = result;
+    result.type = LYXP_SET_NUMBER;
+    assert(!set_sort(set));
+
+cleanup:
+    lyxp_set_free_content(&result);
+    ly_set_erase(&entries, NULL);
+    return ret;
+}
+
 /**
  * @brief Check @p node as a part of schema NameTest processing.
  *
@@ -6837,81 +7025,79 @@ moveto_scnode(struct lyxp_set *set, const struct lys_module *moveto_mod, const c
 }
 
 /**
- * @brief Move context @p set to a child node and all its descendants. Result is LYXP_SET_NODE_SET.
- *        Context position aware.
+ * @brief Sort set nodes into the document order comparator.
+ */
+static int
+set_node_doc_order_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct lyxp_set_node *item1 = ptr1, *item2 = ptr2;
+
+    return lyd_node_doc_order_cmp(item1->node, item2->node);
+}
+
+/**
+ * @brief Move context @p set to all the matching descendant nodes using the instance index (::LY_CTX_INST_INDEX).
+ * Result is LYXP_SET_NODE_SET. Context position aware.
  *
- * @param[in] set Set to use.
+ * @param[in,out] set Set of the child nodes of the original context nodes, whose subtrees to search.
  * @param[in] moveto_mod Matching node module, NULL for no prefix.
- * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] ncname Matching node name in the dictionary.
  * @param[in] options XPath options.
+ * @return LY_ENOT if the index cannot be used;
  * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
  */
 static LY_ERR
-moveto_node_alldesc_child(struct lyxp_set *set, const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+moveto_node_alldesc_child_index(struct lyxp_set *set, const struct lys_module *moveto_mod, const char *ncname,
+        uint32_t options)
 {
-    uint32_t i;
-    const struct lyd_node *next, *elem, *start;
+    LY_ERR rc = LY_SUCCESS;
+    struct ly_set insts = {0};
     struct lyxp_set ret_set;
-    LY_ERR rc;
-
-    if (options & LYXP_SKIP_EXPR) {
-        return LY_SUCCESS;
-    }
+    const struct lyd_node *node, *iter;
+    uint32_t i;
 
-    if (set->type != LYXP_SET_NODE_SET) {
-        LOGVAL(set->ctx, LY_VCODE_XP_INOP_1, "path operator", print_set_type(set));
-        return LY_EVALID;
+    if (!ncname || !set->used) {
+        return LY_ENOT;
     }
 
-    /* replace the original nodes (and throws away all text and meta nodes, root is replaced by a child) */
-    rc = xpath_pi_node(set, LYXP_AXIS_CHILD, options);
+    /* get all the instances of the schema nodes with the name, in any tree */
+    rc = lyd_inst_index_find(set->ctx, moveto_mod, ncname, &insts);
     LY_CHECK_RET(rc);
 
-    /* this loop traverses all the nodes in the set and adds/keeps only those that match qname */
     set_init(&ret_set, set);
-    for (i = 0; i < set->used; ++i) {
-
-        /* TREE DFS */
-        start = set->val.nodes[i].node;
-        for (elem = next = start; elem; elem = next) {
-            rc = moveto_node_check(elem, LYXP_NODE_ELEM, set, ncname, moveto_mod, options);
-            if (!rc) {
-                /* add matching node into result set */
-                set_insert_node(&ret_set, elem, 0, LYXP_NODE_ELEM, ret_set.used);
-                if (set_dup_node_check(set, elem, LYXP_NODE_ELEM, i)) {
-                    /* the node is a duplicate, we'll process it later in the set */
-                    goto skip_children;
-                }
-            } else if (rc == LY_EINCOMPLETE) {
-                return rc;
-            } else if (rc == LY_EINVAL) {
-                goto skip_children;
-            }
-
-            /* TREE DFS NEXT ELEM */
-            /* select element for the next run - children first */
-            next = lyd_child(elem);
-            if (!next) {
-skip_children:
-                /* no children, so try siblings, but only if it's not the start,
-                 * that is considered to be the root and it's siblings are not traversed */
-                if (elem != start) {
-                    next = elem->next;
-                } else {
-                    break;
-                }
+    for (i = 0; i < insts.count; ++i) {
+        node = insts.dnodes[i];
+
+        /* the node or one of its ancestors must be in the set, without a skipped subtree in between */
+        for (iter = node; iter; iter = lyd_parent(iter)) {
+            if ((iter != node) && set->context_op && (iter->schema->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) &&
+                    (iter->schema != set->context_op)) {
+                iter = NULL;
+                break;
             }
-            while (!next) {
-                /* no siblings, go back through the parents */
-                if (lyd_parent(elem) == start) {
-                    /* we are done, no next element to process */
-                    break;
-                }
-                /* parent is already processed, go to its sibling */
-                elem = lyd_parent(elem);
-                next = elem->next;
+            if (set_dup_node_check(set, iter, LYXP_NODE_ELEM, -1)) {
+                break;
             }
         }
+        if (!iter) {
+            continue;
+        }
+
+        rc = moveto_node_check(node, LYXP_NODE_ELEM, set, ncname, moveto_mod, options);
+        if (rc == LY_EINCOMPLETE) {
+            goto cleanup;
+        } else if (rc) {
+            /* not a match, or in a skipped subtree */
+            rc = LY_SUCCESS;
+            continue;
+        }
+
+        set_insert_node(&ret_set, node, 0, LYXP_NODE_ELEM, ret_set.used);
+    }
+
+    /* sort the nodes, only their ancestors and siblings are traversed unlike by set_sort() */
+    if (ret_set.used > 1) {
+        qsort(ret_set.val.nodes, ret_set.used, sizeof *ret_set.val.nodes, set_node_doc_order_cmp);
     }
 
     /* make the temporary set the current one */
@@ -6921,60 +7107,56 @@ skip_children:
     memcpy(set, &ret_set, sizeof *set);
     assert(!set_sort(set));
 
-    return LY_SUCCESS;
+cleanup:
+    if (rc) {
+        lyxp_set_free_content(&ret_set);
+    }
+    ly_set_erase(&insts, NULL);
+    return rc;
 }
 
 /**
- * @brief Move context @p set to a child schema node and all its descendants starting from a node.
- * Result is LYXP_SET_NODE_SET.
+ * @brief Add all the descendants of a single node in a set matching a node test into another set.
  *
- * @param[in] set Set to use.
- * @param[in] start Start node whose subtree to add.
- * @param[in] start_idx Index of @p start in @p set.
+ * @param[in] set Context set.
+ * @param[in] start_idx Index of the node in @p set whose subtree to traverse.
  * @param[in] moveto_mod Matching node module, NULL for no prefix.
  * @param[in] ncname Matching node name in the dictionary, NULL for any.
  * @param[in] options XPath options.
- * @return LY_ERR value.
+ * @param[in,out] ret_set Set to add the matching nodes to.
+ * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
  */
 static LY_ERR
-moveto_scnode_dfs(struct lyxp_set *set, const struct lysc_node *start, uint32_t start_idx,
-        const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+moveto_node_alldesc_child_subtree(const struct lyxp_set *set, uint32_t start_idx, const struct lys_module *moveto_mod,
+        const char *ncname, uint32_t options, struct lyxp_set *ret_set)
 {
-    const struct lysc_node *next, *elem;
-    uint32_t idx;
+    const struct lyd_node *next, *elem, *start;
     LY_ERR rc;
 
     /* TREE DFS */
+    start = set->val.nodes[start_idx].node;
     for (elem = next = start; elem; elem = next) {
-        if ((elem == start) || (elem->nodetype & (LYS_CHOICE | LYS_CASE))) {
-            /* schema-only nodes, skip root */
-            goto next_iter;
-        }
-
-        rc = moveto_scnode_check(elem, start, set, ncname, moveto_mod);
+        rc = moveto_node_check(elem, LYXP_NODE_ELEM, set, ncname, moveto_mod, options);
         if (!rc) {
-            if (lyxp_set_scnode_contains(set, elem, LYXP_NODE_ELEM, start_idx, &idx)) {
-                set->val.scnodes[idx].in_ctx = LYXP_SET_SCNODE_ATOM_CTX;
-                if (idx > start_idx) {
-                    /* we will process it later in the set */
-                    goto skip_children;
-                }
-            } else {
-                LY_CHECK_RET(lyxp_set_scnode_insert_node(set, elem, LYXP_NODE_ELEM, LYXP_AXIS_DESCENDANT, NULL));
+            /* add matching node into result set */
+            set_insert_node(ret_set, elem, 0, LYXP_NODE_ELEM, ret_set->used);
+            if (set_dup_node_check(set, elem, LYXP_NODE_ELEM, start_idx)) {
+                /* the node is a duplicate, we'll process it later in the set */
+                goto skip_children;
             }
+        } else if (rc == LY_EINCOMPLETE) {
+            return rc;
         } else if (rc == LY_EINVAL) {
             goto skip_children;
         }
 
-next_iter:
+        /* virtual default children follow their parent */
+        rc = moveto_node_virtual(elem, set, moveto_mod, ncname, options, 0, ret_set);
+        LY_CHECK_RET(rc);
+
         /* TREE DFS NEXT ELEM */
         /* select element for the next run - children first */
-        next = lysc_node_child(elem);
-        if (next && (next->nodetype == LYS_INPUT) && (options & LYXP_SCNODE_OUTPUT)) {
-            next = next->next;
-        } else if (next && (next->nodetype == LYS_OUTPUT) && !(options & LYXP_SCNODE_OUTPUT)) {
-            next = next->next;
-        }
+        next = lyd_child_load(elem);
         if (!next) {
 skip_children:
             /* no children, so try siblings, but only if it's not the start,
@@ -6987,12 +7169,12 @@ skip_children:
         }
         while (!next) {
             /* no siblings, go back through the parents */
-            if (elem->parent == start) {
+            if (lyd_parent(elem) == start) {
                 /* we are done, no next element to process */
                 break;
             }
             /* parent is already processed, go to its sibling */
-            elem = elem->parent;
+            elem = lyd_parent(elem);
             next = elem->next;
         }
     }
@@ -7001,47 +7183,355 @@ skip_children:
 }
 
 /**
- * @brief Move context @p set to a child schema node and all its descendants. Result is LYXP_SET_NODE_SET.
+ * @brief Get the number of worker threads to evaluate an XPath step with (::LY_CTX_XPATH_PARALLEL).
  *
- * @param[in] set Set to use.
- * @param[in] moveto_mod Matching node module, NULL for no prefix.
- * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] set Context set.
  * @param[in] options XPath options.
- * @return LY_ERR value.
+ * @param[in] units Number of independent units of work of the step.
+ * @return Number of worker threads, 1 if the step should be evaluated serially.
  */
-static LY_ERR
-moveto_scnode_alldesc_child(struct lyxp_set *set, const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+static uint32_t
+lyxp_parallel_thread_count(const struct lyxp_set *set, uint32_t options, uint32_t units)
 {
-    uint32_t i, orig_used, mod_idx;
-    const struct lys_module *mod;
-    const struct lysc_node *root;
+    long cpus;
+    uint32_t count;
 
-    if (options & LYXP_SKIP_EXPR) {
-        return LY_SUCCESS;
+    if (!(set->ctx->flags & LY_CTX_XPATH_PARALLEL) || (options & LYXP_NO_PARALLEL) || (units < 2)) {
+        return 1;
     }
 
-    if (set->type != LYXP_SET_SCNODE_SET) {
-        LOGVAL(set->ctx, LY_VCODE_XP_INOP_1, "path operator", print_set_type(set));
-        return LY_EVALID;
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    count = (cpus > 1) ? (uint32_t)cpus : 1;
+    if (count > LYXP_PARALLEL_MAX_THREADS) {
+        count = LYXP_PARALLEL_MAX_THREADS;
+    }
+    if (count > units) {
+        count = units;
     }
 
-    orig_used = set->used;
-    for (i = 0; i < orig_used; ++i) {
-        if (set->val.scnodes[i].in_ctx != LYXP_SET_SCNODE_ATOM_CTX) {
-            if (set->val.scnodes[i].in_ctx != LYXP_SET_SCNODE_START) {
-                continue;
-            }
+    return count;
+}
 
-            /* remember context node */
-            set->val.scnodes[i].in_ctx = LYXP_SET_SCNODE_START_USED;
-        } else {
-            set->val.scnodes[i].in_ctx = LYXP_SET_SCNODE_ATOM_NODE;
+/**
+ * @brief Count the nodes in the subtrees of the nodes in a set, up to a limit.
+ *
+ * @param[in] set Context set.
+ * @param[in] limit Maximum number of nodes to count.
+ * @return Number of nodes, at most @p limit.
+ */
+static uint32_t
+moveto_node_alldesc_count(const struct lyxp_set *set, uint32_t limit)
+{
+    struct lyd_node *elem;
+    uint32_t i, count = 0;
+
+    for (i = 0; (i < set->used) && (count < limit); ++i) {
+        LYD_TREE_DFS_BEGIN(set->val.nodes[i].node, elem) {
+            if (++count == limit) {
+                break;
+            }
+            LYD_TREE_DFS_END(set->val.nodes[i].node, elem);
         }
+    }
 
-        if ((set->val.scnodes[i].type == LYXP_NODE_ROOT_CONFIG) || (set->val.scnodes[i].type == LYXP_NODE_ROOT)) {
-            /* traverse all top-level nodes in all the modules */
-            mod_idx = 0;
-            while ((mod = ly_ctx_get_module_iter(set->ctx, &mod_idx))) {
+    return count;
+}
+
+/**
+ * @brief Worker of a parallel evaluation of ::moveto_node_alldesc_child().
+ */
+struct lyxp_alldesc_worker {
+    pthread_t tid;                  /**< worker thread */
+    const struct lyxp_set *set;     /**< context set */
+    ATOMIC_T *next_idx;             /**< shared index of the next node in lyxp_alldesc_worker.set to traverse */
+    const struct lys_module *moveto_mod; /**< matching node module */
+    const char *ncname;             /**< matching node name */
+    uint32_t options;               /**< XPath options */
+    struct lyxp_set ret_set;        /**< matching nodes found by this worker */
+    LY_ERR rc;                      /**< return code of the worker */
+};
+
+/**
+ * @brief Worker thread traversing the subtrees of the context set nodes until there are none left.
+ *
+ * @param[in] arg Worker structure (struct lyxp_alldesc_worker *).
+ * @return NULL.
+ */
+static void *
+moveto_node_alldesc_child_thread(void *arg)
+{
+    struct lyxp_alldesc_worker *w = arg;
+    uint32_t i, temp_lo = 0;
+
+    /* errors are not logged from the workers */
+    ly_temp_log_options(&temp_lo);
+
+    while (!w->rc && ((i = ATOMIC_INC_RELAXED(*w->next_idx)) < w->set->used)) {
+        w->rc = moveto_node_alldesc_child_subtree(w->set, i, w->moveto_mod, w->ncname, w->options, &w->ret_set);
+    }
+
+    ly_temp_log_options(NULL);
+    return NULL;
+}
+
+/**
+ * @brief Add all the matching descendants of the nodes in a set into another set using worker threads,
+ * each traversing whole subtrees of the context nodes.
+ *
+ * @param[in] set Context set.
+ * @param[in] thread_count Number of worker threads to use.
+ * @param[in] moveto_mod Matching node module, NULL for no prefix.
+ * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] options XPath options.
+ * @param[in,out] ret_set Empty set to add the sorted matching nodes to.
+ * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
+ */
+static LY_ERR
+moveto_node_alldesc_child_parallel(const struct lyxp_set *set, uint32_t thread_count, const struct lys_module *moveto_mod,
+        const char *ncname, uint32_t options, struct lyxp_set *ret_set)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_alldesc_worker *workers;
+    ATOMIC_T next_idx;
+    uint32_t i, started;
+
+    workers = calloc(thread_count, sizeof *workers);
+    LY_CHECK_ERR_RET(!workers, LOGMEM(set->ctx), LY_EMEM);
+
+    ATOMIC_STORE_RELAXED(next_idx, 0);
+    for (started = 0; started < thread_count; ++started) {
+        workers[started].set = set;
+        workers[started].next_idx = &next_idx;
+        workers[started].moveto_mod = moveto_mod;
+        workers[started].ncname = ncname;
+        workers[started].options = options | LYXP_NO_PARALLEL;
+        set_init(&workers[started].ret_set, set);
+        workers[started].ret_set.type = LYXP_SET_NODE_SET;
+        if (pthread_create(&workers[started].tid, NULL, moveto_node_alldesc_child_thread, &workers[started])) {
+            /* use only the threads created so far, the calling thread if none */
+            break;
+        }
+    }
+    if (!started) {
+        for (i = 0; !rc && (i < set->used); ++i) {
+            rc = moveto_node_alldesc_child_subtree(set, i, moveto_mod, ncname, options, ret_set);
+        }
+    }
+
+    for (i = 0; i < started; ++i) {
+        pthread_join(workers[i].tid, NULL);
+    }
+
+    /* merge the sorted results */
+    for (i = 0; i < started; ++i) {
+        if (!rc) {
+            rc = workers[i].rc;
+        }
+        if (!rc) {
+            assert(!set_sort(&workers[i].ret_set));
+            rc = set_sorted_merge(ret_set, &workers[i].ret_set);
+        }
+        lyxp_set_free_content(&workers[i].ret_set);
+    }
+    if (!started) {
+        /* the set of the worker that failed to start */
+        lyxp_set_free_content(&workers[0].ret_set);
+    }
+
+    free(workers);
+    return rc;
+}
+
+/**
+ * @brief Move context @p set to a child node and all its descendants. Result is LYXP_SET_NODE_SET.
+ *        Context position aware.
+ *
+ * @param[in] set Set to use.
+ * @param[in] moveto_mod Matching node module, NULL for no prefix.
+ * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] options XPath options.
+ * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
+ */
+static LY_ERR
+moveto_node_alldesc_child(struct lyxp_set *set, const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+{
+    uint32_t i, thread_count;
+    struct lyxp_set ret_set;
+    LY_ERR rc;
+
+    if (options & LYXP_SKIP_EXPR) {
+        return LY_SUCCESS;
+    }
+
+    if (set->type != LYXP_SET_NODE_SET) {
+        LOGVAL(set->ctx, LY_VCODE_XP_INOP_1, "path operator", print_set_type(set));
+        return LY_EVALID;
+    }
+
+    /* replace the original nodes (and throws away all text and meta nodes, root is replaced by a child) */
+    rc = xpath_pi_node(set, LYXP_AXIS_CHILD, options);
+    LY_CHECK_RET(rc);
+
+    /* try to avoid traversing all the subtrees */
+    rc = moveto_node_alldesc_child_index(set, moveto_mod, ncname, options);
+    if (rc != LY_ENOT) {
+        return rc;
+    }
+
+    set_init(&ret_set, set);
+    thread_count = lyxp_parallel_thread_count(set, options, set->used);
+    if (thread_count > 1) {
+        /* the threads are worth starting only for large enough subtrees */
+        thread_count = lyxp_parallel_thread_count(set, options,
+                moveto_node_alldesc_count(set, thread_count * LYXP_PARALLEL_DESC_MIN_NODES) / LYXP_PARALLEL_DESC_MIN_NODES);
+    }
+    if (thread_count > 1) {
+        /* traverse the subtrees in parallel */
+        ret_set.type = LYXP_SET_NODE_SET;
+        rc = moveto_node_alldesc_child_parallel(set, thread_count, moveto_mod, ncname, options, &ret_set);
+        if (rc) {
+            lyxp_set_free_content(&ret_set);
+            return rc;
+        }
+    } else {
+        /* this loop traverses all the nodes in the set and adds/keeps only those that match qname */
+        for (i = 0; i < set->used; ++i) {
+            rc = moveto_node_alldesc_child_subtree(set, i, moveto_mod, ncname, options, &ret_set);
+            if (rc) {
+                lyxp_set_free_content(&ret_set);
+                return rc;
+            }
+        }
+    }
+
+    /* make the temporary set the current one */
+    ret_set.ctx_pos = set->ctx_pos;
+    ret_set.ctx_size = set->ctx_size;
+    lyxp_set_free_content(set);
+    memcpy(set, &ret_set, sizeof *set);
+    assert(!set_sort(set));
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Move context @p set to a child schema node and all its descendants starting from a node.
+ * Result is LYXP_SET_NODE_SET.
+ *
+ * @param[in] set Set to use.
+ * @param[in] start Start node whose subtree to add.
+ * @param[in] start_idx Index of @p start in @p set.
+ * @param[in] moveto_mod Matching node module, NULL for no prefix.
+ * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] options XPath options.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+moveto_scnode_dfs(struct lyxp_set *set, const struct lysc_node *start, uint32_t start_idx,
+        const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+{
+    const struct lysc_node *next, *elem;
+    uint32_t idx;
+    LY_ERR rc;
+
+    /* TREE DFS */
+    for (elem = next = start; elem; elem = next) {
+        if ((elem == start) || (elem->nodetype & (LYS_CHOICE | LYS_CASE))) {
+            /* schema-only nodes, skip root */
+            goto next_iter;
+        }
+
+        rc = moveto_scnode_check(elem, start, set, ncname, moveto_mod);
+        if (!rc) {
+            if (lyxp_set_scnode_contains(set, elem, LYXP_NODE_ELEM, start_idx, &idx)) {
+                set->val.scnodes[idx].in_ctx = LYXP_SET_SCNODE_ATOM_CTX;
+                if (idx > start_idx) {
+                    /* we will process it later in the set */
+                    goto skip_children;
+                }
+            } else {
+                LY_CHECK_RET(lyxp_set_scnode_insert_node(set, elem, LYXP_NODE_ELEM, LYXP_AXIS_DESCENDANT, NULL));
+            }
+        } else if (rc == LY_EINVAL) {
+            goto skip_children;
+        }
+
+next_iter:
+        /* TREE DFS NEXT ELEM */
+        /* select element for the next run - children first */
+        next = lysc_node_child(elem);
+        if (next && (next->nodetype == LYS_INPUT) && (options & LYXP_SCNODE_OUTPUT)) {
+            next = next->next;
+        } else if (next && (next->nodetype == LYS_OUTPUT) && !(options & LYXP_SCNODE_OUTPUT)) {
+            next = next->next;
+        }
+        if (!next) {
+skip_children:
+            /* no children, so try siblings, but only if it's not the start,
+             * that is considered to be the root and it's siblings are not traversed */
+            if (elem != start) {
+                next = elem->next;
+            } else {
+                break;
+            }
+        }
+        while (!next) {
+            /* no siblings, go back through the parents */
+            if (elem->parent == start) {
+                /* we are done, no next element to process */
+                break;
+            }
+            /* parent is already processed, go to its sibling */
+            elem = elem->parent;
+            next = elem->next;
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Move context @p set to a child schema node and all its descendants. Result is LYXP_SET_NODE_SET.
+ *
+ * @param[in] set Set to use.
+ * @param[in] moveto_mod Matching node module, NULL for no prefix.
+ * @param[in] ncname Matching node name in the dictionary, NULL for any.
+ * @param[in] options XPath options.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+moveto_scnode_alldesc_child(struct lyxp_set *set, const struct lys_module *moveto_mod, const char *ncname, uint32_t options)
+{
+    uint32_t i, orig_used, mod_idx;
+    const struct lys_module *mod;
+    const struct lysc_node *root;
+
+    if (options & LYXP_SKIP_EXPR) {
+        return LY_SUCCESS;
+    }
+
+    if (set->type != LYXP_SET_SCNODE_SET) {
+        LOGVAL(set->ctx, LY_VCODE_XP_INOP_1, "path operator", print_set_type(set));
+        return LY_EVALID;
+    }
+
+    orig_used = set->used;
+    for (i = 0; i < orig_used; ++i) {
+        if (set->val.scnodes[i].in_ctx != LYXP_SET_SCNODE_ATOM_CTX) {
+            if (set->val.scnodes[i].in_ctx != LYXP_SET_SCNODE_START) {
+                continue;
+            }
+
+            /* remember context node */
+            set->val.scnodes[i].in_ctx = LYXP_SET_SCNODE_START_USED;
+        } else {
+            set->val.scnodes[i].in_ctx = LYXP_SET_SCNODE_ATOM_NODE;
+        }
+
+        if ((set->val.scnodes[i].type == LYXP_NODE_ROOT_CONFIG) || (set->val.scnodes[i].type == LYXP_NODE_ROOT)) {
+            /* traverse all top-level nodes in all the modules */
+            mod_idx = 0;
+            while ((mod = ly_ctx_get_module_iter(set->ctx, &mod_idx))) {
                 /* module may not be implemented or not compiled yet */
                 if (!mod->compiled) {
                     continue;
@@ -7497,6 +7987,160 @@ moveto_op_math(struct lyxp_set *set1, struct lyxp_set *set2, const char *op)
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Evaluate a predicate for a single node of a set.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in,out] tok_idx Position of the predicate expression in @p exp, is moved after it.
+ * @param[in] set Context set.
+ * @param[in] idx Index of the node in @p set.
+ * @param[in] options XPath options.
+ * @param[in] reverse_axis Whether the predicate is evaluated on a reverse axis.
+ * @param[out] not_found Set if the evaluation did not find some nodes.
+ * @param[out] satisfied Whether the node satisfies the predicate.
+ * @return LY_ERR (LY_EINCOMPLETE on unresolved when)
+ */
+static LY_ERR
+eval_predicate_node(const struct lyxp_expr *exp, uint32_t *tok_idx, const struct lyxp_set *set, uint32_t idx,
+        uint32_t options, ly_bool reverse_axis, ly_bool *not_found, ly_bool *satisfied)
+{
+    LY_ERR rc;
+    struct lyxp_set set2;
+    uint32_t pos;
+
+    set_init(&set2, set);
+    set_insert_node(&set2, set->val.nodes[idx].node, set->val.nodes[idx].pos, set->val.nodes[idx].type, 0);
+
+    /* remember the node context position for position() and context size for last() */
+    pos = reverse_axis ? set->used - idx : idx + 1;
+    set2.ctx_pos = pos;
+    set2.ctx_size = set->used;
+
+    rc = eval_expr_select(exp, tok_idx, 0, &set2, options);
+    if (rc) {
+        lyxp_set_free_content(&set2);
+        return rc;
+    }
+    *not_found = set2.not_found;
+
+    /* number is a proximity position */
+    if (set2.type == LYXP_SET_NUMBER) {
+        if ((long long)set2.val.num == pos) {
+            set2.val.num = 1;
+        } else {
+            set2.val.num = 0;
+        }
+    }
+    lyxp_set_cast(&set2, LYXP_SET_BOOLEAN);
+    *satisfied = set2.val.bln;
+
+    lyxp_set_free_content(&set2);
+    return LY_SUCCESS;
+}
+
+/**
+ * @brief Worker of a parallel evaluation of a predicate.
+ */
+struct lyxp_pred_worker {
+    pthread_t tid;                  /**< worker thread */
+    const struct lyxp_expr *exp;    /**< parsed XPath expression */
+    uint32_t tok_idx;               /**< position of the predicate expression in lyxp_pred_worker.exp */
+    const struct lyxp_set *set;     /**< context set */
+    uint32_t options;               /**< XPath options */
+    ly_bool reverse_axis;           /**< whether the predicate is evaluated on a reverse axis */
+    uint32_t start;                 /**< index of the first node in lyxp_pred_worker.set to evaluate */
+    uint32_t end;                   /**< index after the last node to evaluate, on return the index of the first node
+                                         whose evaluation failed or did not find some nodes */
+    ly_bool *satisfied;             /**< shared array of the results for all the nodes in lyxp_pred_worker.set */
+};
+
+/**
+ * @brief Worker thread evaluating a predicate for a range of nodes.
+ *
+ * @param[in] arg Worker structure (struct lyxp_pred_worker *).
+ * @return NULL.
+ */
+static void *
+eval_predicate_thread(void *arg)
+{
+    struct lyxp_pred_worker *w = arg;
+    uint32_t i, tok_idx, temp_lo = 0;
+    ly_bool not_found;
+
+    /* errors are not logged from the workers, the node is evaluated again by the calling thread */
+    ly_temp_log_options(&temp_lo);
+
+    for (i = w->start; i < w->end; ++i) {
+        tok_idx = w->tok_idx;
+        if (eval_predicate_node(w->exp, &tok_idx, w->set, i, w->options, w->reverse_axis, &not_found,
+                &w->satisfied[i]) || not_found) {
+            w->end = i;
+            break;
+        }
+    }
+
+    ly_temp_log_options(NULL);
+    return NULL;
+}
+
+/**
+ * @brief Evaluate a predicate for the nodes of a set using worker threads, each evaluating a range of the nodes.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] tok_idx Position of the predicate expression in @p exp.
+ * @param[in] set Context set.
+ * @param[in] thread_count Number of worker threads to use.
+ * @param[in] options XPath options.
+ * @param[in] reverse_axis Whether the predicate is evaluated on a reverse axis.
+ * @param[out] satisfied Results of the evaluated nodes.
+ * @param[out] evaluated Number of the first nodes in @p set whose results are in @p satisfied, the rest must be
+ * evaluated serially.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+eval_predicate_parallel(const struct lyxp_expr *exp, uint32_t tok_idx, const struct lyxp_set *set, uint32_t thread_count,
+        uint32_t options, ly_bool reverse_axis, ly_bool *satisfied, uint32_t *evaluated)
+{
+    struct lyxp_pred_worker *workers;
+    uint32_t i, started, chunk;
+
+    *evaluated = 0;
+
+    workers = calloc(thread_count, sizeof *workers);
+    LY_CHECK_ERR_RET(!workers, LOGMEM(set->ctx), LY_EMEM);
+
+    chunk = (set->used + thread_count - 1) / thread_count;
+    for (started = 0; started < thread_count; ++started) {
+        workers[started].exp = exp;
+        workers[started].tok_idx = tok_idx;
+        workers[started].set = set;
+        workers[started].options = options | LYXP_NO_PARALLEL;
+        workers[started].reverse_axis = reverse_axis;
+        workers[started].start = started * chunk;
+        workers[started].end = (started + 1 == thread_count) ? set->used : (started + 1) * chunk;
+        workers[started].satisfied = satisfied;
+        if (pthread_create(&workers[started].tid, NULL, eval_predicate_thread, &workers[started])) {
+            /* the rest is evaluated serially */
+            break;
+        }
+    }
+
+    for (i = 0; i < started; ++i) {
+        pthread_join(workers[i].tid, NULL);
+    }
+
+    /* learn the continuous range of evaluated nodes */
+    for (i = 0; i < started; ++i) {
+        *evaluated = workers[i].end;
+        if ((i + 1 == thread_count) || (workers[i].end < workers[i + 1].start)) {
+            break;
+        }
+    }
+
+    free(workers);
+    return LY_SUCCESS;
+}
+
 /**
  * @brief Evaluate Predicate. Logs directly on error.
  *
@@ -7513,9 +8157,9 @@ static LY_ERR
 eval_predicate(const struct lyxp_expr *exp, uint32_t *tok_idx, struct lyxp_set *set, uint32_t options, enum lyxp_axis axis)
 {
     LY_ERR rc;
-    uint32_t i, orig_exp, orig_pos, orig_size;
+    uint32_t i, orig_exp, evaluated, thread_count;
     int32_t pred_in_ctx;
-    ly_bool reverse_axis = 0;
+    ly_bool reverse_axis = 0, not_found, satisfied_node, *satisfied;
     struct lyxp_set set2 = {0};
 
     /* '[' */
@@ -7557,41 +8201,41 @@ only_parse:
         }
 
         orig_exp = *tok_idx;
-        orig_pos = reverse_axis ? set->used + 1 : 0;
-        orig_size = set->used;
-        for (i = 0; i < set->used; ++i) {
-            set_init(&set2, set);
-            set_insert_node(&set2, set->val.nodes[i].node, set->val.nodes[i].pos, set->val.nodes[i].type, 0);
-
-            /* remember the node context position for position() and context size for last() */
-            orig_pos += reverse_axis ? -1 : 1;
-
-            set2.ctx_pos = orig_pos;
-            set2.ctx_size = orig_size;
-            *tok_idx = orig_exp;
-
-            rc = eval_expr_select(exp, tok_idx, 0, &set2, options);
-            if (!rc && set2.not_found) {
-                set->not_found = 1;
-                break;
-            }
+        evaluated = 0;
+        thread_count = lyxp_parallel_thread_count(set, options, set->used / LYXP_PARALLEL_PRED_MIN_NODES);
+        if (thread_count > 1) {
+            /* evaluate the nodes in parallel */
+            satisfied = malloc(set->used * sizeof *satisfied);
+            LY_CHECK_ERR_RET(!satisfied, LOGMEM(set->ctx), LY_EMEM);
+            rc = eval_predicate_parallel(exp, orig_exp, set, thread_count, options, reverse_axis, satisfied, &evaluated);
             if (rc) {
-                lyxp_set_free_content(&set2);
+                free(satisfied);
                 return rc;
             }
-
-            /* number is a proximity position */
-            if (set2.type == LYXP_SET_NUMBER) {
-                if ((long long)set2.val.num == orig_pos) {
-                    set2.val.num = 1;
-                } else {
-                    set2.val.num = 0;
+            for (i = 0; i < evaluated; ++i) {
+                if (!satisfied[i]) {
+                    set_remove_node_none(set, i);
                 }
             }
-            lyxp_set_cast(&set2, LYXP_SET_BOOLEAN);
+            free(satisfied);
+        }
+
+        if (evaluated == set->used) {
+            /* skip the predicate expression */
+            rc = eval_expr_select(exp, tok_idx, 0, set, options | LYXP_SKIP_EXPR);
+            LY_CHECK_RET(rc);
+        }
+        for (i = evaluated; i < set->used; ++i) {
+            *tok_idx = orig_exp;
+            rc = eval_predicate_node(exp, tok_idx, set, i, options, reverse_axis, &not_found, &satisfied_node);
+            LY_CHECK_RET(rc);
+            if (not_found) {
+                set->not_found = 1;
+                break;
+            }
 
             /* predicate satisfied or not? */
-            if (!set2.val.bln) {
+            if (!satisfied_node) {
                 set_remove_node_none(set, i);
             }
         }
@@ -7722,24 +8366,23 @@ eval_name_test_try_compile_predicate_key(const char *nametest, uint32_t len, con
 }
 
 /**
- * @brief Append a simple predicate for the node.
+ * @brief Evaluate a predicate value subexpression that must not depend on the context node instance.
  *
  * @param[in] exp Full parsed XPath expression.
- * @param[in] tok_idx Predicate start index in @p exp.
- * @param[in] end_tok_idx Predicate end index in @p exp.
+ * @param[in] tok_idx Predicate value start index in @p exp.
+ * @param[in] end_tok_idx Predicate value end index in @p exp.
  * @param[in] ctx_scnode Found schema node as the context for the predicate.
  * @param[in] set Context set.
- * @param[in] pred_node Node with the value referenced in the predicate.
- * @param[in,out] pred Predicate to append to.
- * @param[in,out] pred_len Length of @p pred, is updated.
+ * @param[out] value_set Evaluated value, cast into a string.
+ * @param[out] value_type Optional type of the value before it was cast.
  * @return LY_SUCCESS on success,
- * @return LY_ENOT if a predicate could not be compiled.
+ * @return LY_ENOT if the value may depend on the context node instance.
  * @return LY_ERR on any error.
  */
 static LY_ERR
-eval_name_test_try_compile_predicate_append(const struct lyxp_expr *exp, uint32_t tok_idx, uint32_t end_tok_idx,
-        const struct lysc_node *ctx_scnode, const struct lyxp_set *set, const struct lysc_node *pred_node, char **pred,
-        uint32_t *pred_len)
+eval_name_test_try_compile_predicate_value(const struct lyxp_expr *exp, uint32_t tok_idx, uint32_t end_tok_idx,
+        const struct lysc_node *ctx_scnode, const struct lyxp_set *set, struct lyxp_set *value_set,
+        enum lyxp_set_type *value_type)
 {
     LY_ERR rc = LY_SUCCESS;
     uint32_t i;
@@ -7748,7 +8391,6 @@ eval_name_test_try_compile_predicate_append(const struct lyxp_expr *exp, uint32_
     const struct lysc_node *sparent, *cur_scnode;
     struct lyxp_expr *val_exp = NULL;
     struct lyxp_set set2 = {0};
-    char quot;
 
     /* duplicate the value expression */
     LY_CHECK_GOTO(rc = lyxp_expr_dup(set->ctx, exp, tok_idx, end_tok_idx, &val_exp), cleanup);
@@ -7790,17 +8432,57 @@ eval_name_test_try_compile_predicate_append(const struct lyxp_expr *exp, uint32_
     }
 
     /* get any data instance of the context node, we checked it makes no difference */
-    siblings = set->val.nodes[0].node ? lyd_child(set->val.nodes[0].node) : set->tree;
+    siblings = set->val.nodes[0].node ? lyd_child_load(set->val.nodes[0].node) : set->tree;
     LY_CHECK_GOTO(rc = lyd_find_sibling_schema(siblings, ctx_scnode, &ctx_node), cleanup);
 
     /* evaluate the value subexpression with the root context node */
     lyxp_set_free_content(&set2);
     LY_CHECK_GOTO(rc = lyxp_eval(set->ctx, val_exp, set->cur_mod, set->format, set->prefix_data, set->cur_node,
             ctx_node, set->tree, NULL, &set2, 0), cleanup);
+    if (value_type) {
+        *value_type = set2.type;
+    }
 
     /* cast it into a string */
     LY_CHECK_GOTO(rc = lyxp_set_cast(&set2, LYXP_SET_STRING), cleanup);
 
+    *value_set = set2;
+    memset(&set2, 0, sizeof set2);
+
+cleanup:
+    lyxp_expr_free(set->ctx, val_exp);
+    lyxp_set_free_content(&set2);
+    return rc;
+}
+
+/**
+ * @brief Append a simple predicate for the node.
+ *
+ * @param[in] exp Full parsed XPath expression.
+ * @param[in] tok_idx Predicate start index in @p exp.
+ * @param[in] end_tok_idx Predicate end index in @p exp.
+ * @param[in] ctx_scnode Found schema node as the context for the predicate.
+ * @param[in] set Context set.
+ * @param[in] pred_node Node with the value referenced in the predicate.
+ * @param[in,out] pred Predicate to append to.
+ * @param[in,out] pred_len Length of @p pred, is updated.
+ * @return LY_SUCCESS on success,
+ * @return LY_ENOT if a predicate could not be compiled.
+ * @return LY_ERR on any error.
+ */
+static LY_ERR
+eval_name_test_try_compile_predicate_append(const struct lyxp_expr *exp, uint32_t tok_idx, uint32_t end_tok_idx,
+        const struct lysc_node *ctx_scnode, const struct lyxp_set *set, const struct lysc_node *pred_node, char **pred,
+        uint32_t *pred_len)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_set set2 = {0};
+    char quot;
+
+    /* evaluate the value */
+    LY_CHECK_GOTO(rc = eval_name_test_try_compile_predicate_value(exp, tok_idx, end_tok_idx, ctx_scnode, set, &set2,
+            NULL), cleanup);
+
     /* append the JSON predicate */
     *pred = ly_realloc(*pred, *pred_len + 1 + strlen(pred_node->name) + 2 + strlen(set2.val.str) + 3);
     LY_CHECK_ERR_GOTO(!*pred, LOGMEM(set->ctx); rc = LY_EMEM, cleanup);
@@ -7808,7 +8490,6 @@ eval_name_test_try_compile_predicate_append(const struct lyxp_expr *exp, uint32_
     *pred_len += sprintf(*pred + *pred_len, "[%s=%c%s%c]", pred_node->name, quot, set2.val.str, quot);
 
 cleanup:
-    lyxp_expr_free(set->ctx, val_exp);
     lyxp_set_free_content(&set2);
     return rc;
 }
@@ -7908,74 +8589,238 @@ eval_name_test_try_compile_predicates(const struct lyxp_expr *exp, uint32_t *tok
     } else {
         /* check for predicate "[.=...]" */
 
-        /* learn just where this single predicate ends */
-        e_idx = *tok_idx;
+        /* learn just where this single predicate ends */
+        e_idx = *tok_idx;
+
+        /* '[' */
+        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
+            rc = LY_ENOT;
+            goto cleanup;
+        }
+        ++e_idx;
+
+        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_DOT)) {
+            /* not the node value */
+            rc = LY_ENOT;
+            goto cleanup;
+        }
+        ++e_idx;
+
+        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_EQUAL)) {
+            /* not '=' */
+            rc = LY_ENOT;
+            goto cleanup;
+        }
+        ++e_idx;
+
+        /* value start */
+        val_start_idx = e_idx;
+
+        /* ']' */
+        nested_pred = 1;
+        do {
+            ++e_idx;
+
+            if ((nested_pred == 1) && !lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_LOG)) {
+                /* higher priority than '=' */
+                rc = LY_ENOT;
+                goto cleanup;
+            } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
+                /* nested predicate */
+                ++nested_pred;
+            } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK2)) {
+                /* predicate end */
+                --nested_pred;
+            }
+        } while (nested_pred);
+
+        /* try to evaluate the value */
+        LY_CHECK_GOTO(rc = eval_name_test_try_compile_predicate_append(exp, val_start_idx, e_idx - 1, ctx_scnode, set,
+                ctx_scnode, &pred, &pred_len), cleanup);
+
+        ++e_idx;
+    }
+
+    /* parse the predicate(s) */
+    LY_CHECK_GOTO(rc = ly_path_parse_predicate(set->ctx, ctx_scnode, pred, pred_len, LY_PATH_PREFIX_OPTIONAL,
+            LY_PATH_PRED_SIMPLE, &exp2), cleanup);
+
+    /* compile */
+    rc = ly_path_compile_predicate(set->ctx, set->cur_node ? set->cur_node->schema : NULL, set->cur_mod, ctx_scnode, exp2,
+            &pred_idx, LY_VALUE_JSON, NULL, predicates);
+    LY_CHECK_GOTO(rc, cleanup);
+
+    /* success, the predicate must include all the needed information for hash-based search */
+    *tok_idx = e_idx;
+
+cleanup:
+    ly_temp_log_options(prev_lo);
+    lyxp_expr_free(set->ctx, exp2);
+    free(pred);
+    return rc;
+}
+
+/**
+ * @brief Try to compile a list predicate on an indexed leaf to be used for index-based instance search.
+ *
+ * @param[in] exp Full parsed XPath expression.
+ * @param[in,out] tok_idx Index in @p exp at the beginning of the predicate, is updated on success.
+ * @param[in] ctx_scnode Found list schema node as the context for the predicate.
+ * @param[in] set Context set.
+ * @param[in] options XPath options.
+ * @param[out] leaf_p Indexed leaf referenced in the predicate.
+ * @param[out] value Stored value of @p leaf_p from the predicate, must be freed on success.
+ * @return LY_SUCCESS on success,
+ * @return LY_ENOT if a predicate could not be compiled.
+ * @return LY_ERR on any error.
+ */
+static LY_ERR
+eval_name_test_try_compile_index_predicate(const struct lyxp_expr *exp, uint32_t *tok_idx,
+        const struct lysc_node *ctx_scnode, const struct lyxp_set *set, uint32_t options, const struct lysc_node **leaf_p,
+        struct lyd_value *value)
+{
+    LY_ERR rc = LY_SUCCESS;
+    uint32_t i, e_idx, val_start_idx, *prev_lo, temp_lo = 0, nested_pred, len;
+    const char *nametest;
+    const struct lys_module *mod;
+    const struct lysc_node *leaf;
+    const struct lysc_type *type = NULL;
+    struct lyxp_set set2 = {0};
+    enum lyxp_set_type val_type;
+    ly_bool incomplete = 0, stored = 0;
+
+    assert(ctx_scnode->nodetype == LYS_LIST);
+
+    if (!set->ctx->data_indexes.count) {
+        /* no indexes */
+        return LY_ENOT;
+    }
+
+    /* turn logging off */
+    prev_lo = ly_temp_log_options(&temp_lo);
+
+    /* check for predicate "[leaf=...]" */
+    e_idx = *tok_idx;
+
+    /* '[' */
+    if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+    ++e_idx;
+
+    if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_NAMETEST)) {
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+
+    /* find the indexed leaf */
+    nametest = exp->expr + exp->tok_pos[e_idx];
+    len = exp->tok_len[e_idx];
+    LY_CHECK_GOTO(rc = moveto_resolve_module(&nametest, &len, set, ctx_scnode, &mod), cleanup);
+    leaf = lys_find_child(ctx_scnode, mod ? mod : ctx_scnode->module, nametest, len, LYS_LEAF, 0);
+    if (!leaf || (leaf->flags & LYS_KEY) || !lyd_index_exists(leaf)) {
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+    if ((!(options & LYXP_IGNORE_WHEN) && lysc_has_when(leaf)) ||
+            ((set->root_type == LYXP_NODE_ROOT_CONFIG) && (leaf->flags & LYS_CONFIG_R))) {
+        /* the leaf instances may not be accessible */
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+    ++e_idx;
+
+    if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_EQUAL)) {
+        /* not '=' */
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+    ++e_idx;
+
+    /* value start */
+    val_start_idx = e_idx;
 
-        /* '[' */
-        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
-            rc = LY_ENOT;
-            goto cleanup;
-        }
+    /* ']' */
+    nested_pred = 1;
+    do {
         ++e_idx;
 
-        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_DOT)) {
-            /* not the node value */
+        if ((nested_pred == 1) && !lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_LOG)) {
+            /* higher priority than '=' */
             rc = LY_ENOT;
             goto cleanup;
-        }
-        ++e_idx;
-
-        if (lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_EQUAL)) {
-            /* not '=' */
+        } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
+            /* nested predicate */
+            ++nested_pred;
+        } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK2)) {
+            /* predicate end */
+            --nested_pred;
+        }
+    } while (nested_pred);
+
+    /* try to evaluate the value */
+    LY_CHECK_GOTO(rc = eval_name_test_try_compile_predicate_value(exp, val_start_idx, e_idx - 1, ctx_scnode, set,
+            &set2, &val_type), cleanup);
+
+    /* only values compared the same way as the stored values can be used */
+    type = ((struct lysc_node_leaf *)leaf)->type;
+    if (val_type == LYXP_SET_NUMBER) {
+        switch (type->basetype) {
+        case LY_TYPE_UINT8:
+        case LY_TYPE_UINT16:
+        case LY_TYPE_UINT32:
+        case LY_TYPE_UINT64:
+        case LY_TYPE_INT8:
+        case LY_TYPE_INT16:
+        case LY_TYPE_INT32:
+        case LY_TYPE_INT64:
+        case LY_TYPE_DEC64:
+            /* numeric comparison */
+            break;
+        default:
             rc = LY_ENOT;
             goto cleanup;
         }
-        ++e_idx;
-
-        /* value start */
-        val_start_idx = e_idx;
-
-        /* ']' */
-        nested_pred = 1;
-        do {
-            ++e_idx;
-
-            if ((nested_pred == 1) && !lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_OPER_LOG)) {
-                /* higher priority than '=' */
-                rc = LY_ENOT;
-                goto cleanup;
-            } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK1)) {
-                /* nested predicate */
-                ++nested_pred;
-            } else if (!lyxp_check_token(NULL, exp, e_idx, LYXP_TOKEN_BRACK2)) {
-                /* predicate end */
-                --nested_pred;
-            }
-        } while (nested_pred);
-
-        /* try to evaluate the value */
-        LY_CHECK_GOTO(rc = eval_name_test_try_compile_predicate_append(exp, val_start_idx, e_idx - 1, ctx_scnode, set,
-                ctx_scnode, &pred, &pred_len), cleanup);
-
-        ++e_idx;
+    } else if (val_type != LYXP_SET_STRING) {
+        rc = LY_ENOT;
+        goto cleanup;
     }
 
-    /* parse the predicate(s) */
-    LY_CHECK_GOTO(rc = ly_path_parse_predicate(set->ctx, ctx_scnode, pred, pred_len, LY_PATH_PREFIX_OPTIONAL,
-            LY_PATH_PRED_SIMPLE, &exp2), cleanup);
+    /* store the value */
+    rc = lyd_value_store(set->ctx, value, type, set2.val.str, strlen(set2.val.str), 0, 0, NULL, LY_VALUE_JSON, NULL,
+            LYD_HINT_DATA, leaf, &incomplete);
+    if (rc || incomplete) {
+        stored = rc ? 0 : 1;
+        rc = LY_ENOT;
+        goto cleanup;
+    }
+    stored = 1;
+    if ((val_type == LYXP_SET_STRING) && strcmp(lyd_value_get_canonical(set->ctx, value), set2.val.str)) {
+        /* not the canonical value, compared as strings */
+        rc = LY_ENOT;
+        goto cleanup;
+    }
 
-    /* compile */
-    rc = ly_path_compile_predicate(set->ctx, set->cur_node ? set->cur_node->schema : NULL, set->cur_mod, ctx_scnode, exp2,
-            &pred_idx, LY_VALUE_JSON, NULL, predicates);
-    LY_CHECK_GOTO(rc, cleanup);
+    /* opaque instances cannot be indexed */
+    for (i = 0; i < set->used; ++i) {
+        if ((set->val.nodes[i].type == LYXP_NODE_ELEM) &&
+                !lyd_find_sibling_opaq_next(lyd_child_load(set->val.nodes[i].node), ctx_scnode->name, NULL)) {
+            rc = LY_ENOT;
+            goto cleanup;
+        }
+    }
 
-    /* success, the predicate must include all the needed information for hash-based search */
-    *tok_idx = e_idx;
+    /* success */
+    *leaf_p = leaf;
+    *tok_idx = e_idx + 1;
 
 cleanup:
+    if (rc && stored) {
+        type->plugin->free(set->ctx, value);
+    }
     ly_temp_log_options(prev_lo);
-    lyxp_expr_free(set->ctx, exp2);
-    free(pred);
+    lyxp_set_free_content(&set2);
     return rc;
 }
 
@@ -8146,8 +8991,9 @@ eval_name_test_with_predicate(const struct lyxp_expr *exp, uint32_t *tok_idx, en
     const char *ncname, *ncname_dict = NULL;
     uint32_t i, ncname_len;
     const struct lys_module *moveto_mod = NULL, *moveto_m;
-    const struct lysc_node *scnode = NULL;
+    const struct lysc_node *scnode = NULL, *idx_leaf = NULL;
     struct ly_path_predicate *predicates = NULL;
+    struct lyd_value idx_value;
     int scnode_skip_pred = 0;
 
     LOGDBG(LY_LDGXPATH, "%-27s %s %s[%u]", __func__, (options & LYXP_SKIP_EXPR ? "skipped" : "parsed"),
@@ -8197,8 +9043,11 @@ eval_name_test_with_predicate(const struct lyxp_expr *exp, uint32_t *tok_idx, en
         if (scnode && (scnode->nodetype & (LYS_LIST | LYS_LEAFLIST))) {
             /* try to create the predicates */
             if (eval_name_test_try_compile_predicates(exp, tok_idx, scnode, set, &predicates)) {
-                /* hashes cannot be used */
-                scnode = NULL;
+                /* hashes cannot be used, try a secondary index */
+                if ((scnode->nodetype != LYS_LIST) || eval_name_test_try_compile_index_predicate(exp, tok_idx, scnode,
+                        set, options, &idx_leaf, &idx_value)) {
+                    scnode = NULL;
+                }
             }
         }
     }
@@ -8282,6 +9131,9 @@ moveto:
             if (all_desc && (axis == LYXP_AXIS_CHILD)) {
                 /* efficient evaluation */
                 rc = moveto_node_alldesc_child(set, moveto_mod, ncname_dict, options);
+            } else if (idx_leaf && (axis == LYXP_AXIS_CHILD)) {
+                /* we can find the list instances using an index */
+                rc = moveto_node_index_child(set, scnode, idx_leaf, &idx_value, options);
             } else if (scnode && (axis == LYXP_AXIS_CHILD)) {
                 /* we can find the child nodes using hashes */
                 rc = moveto_node_hash_child(set, scnode, predicates, options);
@@ -8317,6 +9169,9 @@ cleanup:
     if (predicates) {
         ly_path_predicates_free(scnode->module->ctx, predicates);
     }
+    if (idx_leaf) {
+        idx_value.realtype->plugin->free(set->ctx, &idx_value);
+    }
     return rc;
 }
 
@@ -9789,6 +10644,444 @@ lyxp_eval(const struct ly_ctx *ctx, const struct lyxp_expr *exp, const struct ly
     return rc;
 }
 
+/**
+ * @brief Single step of a path evaluated lazily by ::lyxp_iter.
+ */
+struct lyxp_iter_step {
+    ly_bool desc;                   /**< whether the step is preceded by "//" instead of "/" */
+    const struct lys_module *mod;   /**< matching node module, NULL for any */
+    const char *name;               /**< matching node name in the dictionary, NULL for any */
+    struct lyxp_expr **preds;       /**< [sized array](@ref sizedarrays) of predicate expressions */
+};
+
+/**
+ * @brief Lazy evaluation state of a simple path.
+ *
+ * The data are traversed in DFS (document order) and for every node it is remembered which steps of the path
+ * it matches (the node itself) and which steps any of its ancestors match. A node matching the last step is a result.
+ */
+struct lyxp_iter {
+    struct lyxp_set set;            /**< evaluation context, the set itself is not used */
+    uint32_t options;               /**< XPath options */
+    const struct lyd_node *start;   /**< context node of a relative path, NULL for the root */
+    struct lyxp_iter_step *steps;   /**< [sized array](@ref sizedarrays) of the path steps */
+
+    const struct lyd_node *cur;     /**< last traversed node */
+    ly_bool finished;               /**< set if all the nodes were traversed */
+    uint32_t depth;                 /**< depth of lyxp_iter.cur, the root or the context node has depth 0 */
+    uint32_t depth_size;            /**< allocated size of the depth arrays */
+    uint64_t *match;                /**< steps matched by the nodes on the current DFS path, bit 0 is the start */
+    uint64_t *anc_match;            /**< steps matched by the nodes and all their ancestors on the current DFS path */
+};
+
+/**
+ * @brief Check whether a predicate can be evaluated for a single node, without knowing the whole node set.
+ *
+ * It must never be evaluated into a number (proximity position) so it must be a comparison, a logical expression,
+ * or a path. Also, it must not use the context position and size.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] start Index of the first predicate expression token.
+ * @param[in] end Index of the closing bracket of the predicate.
+ * @return Whether the predicate is supported by ::lyxp_iter.
+ */
+static ly_bool
+lyxp_iter_exp_pred_supported(const struct lyxp_expr *exp, uint32_t start, uint32_t end)
+{
+    uint32_t i, nest = 0;
+    ly_bool bool_oper = 0, math_oper = 0;
+
+    for (i = start; i < end; ++i) {
+        switch (exp->tokens[i]) {
+        case LYXP_TOKEN_PAR1:
+        case LYXP_TOKEN_BRACK1:
+            ++nest;
+            break;
+        case LYXP_TOKEN_PAR2:
+        case LYXP_TOKEN_BRACK2:
+            --nest;
+            break;
+        case LYXP_TOKEN_OPER_LOG:
+        case LYXP_TOKEN_OPER_EQUAL:
+        case LYXP_TOKEN_OPER_NEQUAL:
+        case LYXP_TOKEN_OPER_COMP:
+            if (!nest) {
+                bool_oper = 1;
+            }
+            break;
+        case LYXP_TOKEN_OPER_MATH:
+            if (!nest) {
+                math_oper = 1;
+            }
+            break;
+        case LYXP_TOKEN_FUNCNAME:
+            if (!ly_strncmp("position", &exp->expr[exp->tok_pos[i]], exp->tok_len[i]) ||
+                    !ly_strncmp("last", &exp->expr[exp->tok_pos[i]], exp->tok_len[i])) {
+                /* the context position and size are not known */
+                return 0;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (bool_oper) {
+        /* boolean */
+        return 1;
+    }
+
+    switch (exp->tokens[start]) {
+    case LYXP_TOKEN_NAMETEST:
+    case LYXP_TOKEN_DOT:
+    case LYXP_TOKEN_DDOT:
+    case LYXP_TOKEN_AT:
+    case LYXP_TOKEN_AXISNAME:
+    case LYXP_TOKEN_OPER_PATH:
+    case LYXP_TOKEN_OPER_RPATH:
+        /* node set */
+        return math_oper ? 0 : 1;
+    default:
+        /* possibly a number */
+        return 0;
+    }
+}
+
+/**
+ * @brief Check whether a simple path expression can be evaluated lazily.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[out] absolute Whether the path is absolute.
+ * @return Whether the expression is a simple path supported by ::lyxp_iter.
+ */
+static ly_bool
+lyxp_iter_exp_is_path(const struct lyxp_expr *exp, ly_bool *absolute)
+{
+    uint32_t i, steps = 0, nest, start;
+
+    i = 0;
+    *absolute = 0;
+    if ((exp->tokens[0] == LYXP_TOKEN_OPER_PATH) || (exp->tokens[0] == LYXP_TOKEN_OPER_RPATH)) {
+        *absolute = 1;
+        ++i;
+    }
+
+    while (i < exp->used) {
+        /* NameTest */
+        if (exp->tokens[i] != LYXP_TOKEN_NAMETEST) {
+            return 0;
+        }
+        ++i;
+        ++steps;
+
+        /* Predicate* */
+        while ((i < exp->used) && (exp->tokens[i] == LYXP_TOKEN_BRACK1)) {
+            start = i + 1;
+            for (nest = 1, ++i; (i < exp->used) && nest; ++i) {
+                if (exp->tokens[i] == LYXP_TOKEN_BRACK1) {
+                    ++nest;
+                } else if (exp->tokens[i] == LYXP_TOKEN_BRACK2) {
+                    --nest;
+                }
+            }
+            if (!lyxp_iter_exp_pred_supported(exp, start, i - 1)) {
+                return 0;
+            }
+        }
+
+        if (i == exp->used) {
+            break;
+        }
+
+        /* '/' or '//' */
+        if ((exp->tokens[i] != LYXP_TOKEN_OPER_PATH) && (exp->tokens[i] != LYXP_TOKEN_OPER_RPATH)) {
+            return 0;
+        }
+        ++i;
+        if (i == exp->used) {
+            return 0;
+        }
+    }
+
+    /* the match bitmaps need a bit for every step and the start */
+    return (steps && (steps < 64)) ? 1 : 0;
+}
+
+/**
+ * @brief Create the steps of a lazily evaluated path.
+ *
+ * @param[in] iter Iterator to fill.
+ * @param[in] exp Parsed simple path expression.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyxp_iter_steps_create(struct lyxp_iter *iter, const struct lyxp_expr *exp)
+{
+    struct lyxp_iter_step *step;
+    struct lyxp_expr **pred;
+    const char *ncname;
+    uint32_t i, ncname_len, nest, start;
+
+    i = 0;
+    while (i < exp->used) {
+        LY_ARRAY_NEW_RET(iter->set.ctx, iter->steps, step, LY_EMEM);
+
+        if ((exp->tokens[i] == LYXP_TOKEN_OPER_PATH) || (exp->tokens[i] == LYXP_TOKEN_OPER_RPATH)) {
+            step->desc = (exp->tokens[i] == LYXP_TOKEN_OPER_RPATH) ? 1 : 0;
+            ++i;
+        }
+
+        /* NameTest */
+        assert(exp->tokens[i] == LYXP_TOKEN_NAMETEST);
+        ncname = &exp->expr[exp->tok_pos[i]];
+        ncname_len = exp->tok_len[i];
+        if ((ncname[0] != '*') || (ncname_len != 1)) {
+            LY_CHECK_RET(moveto_resolve_module(&ncname, &ncname_len, &iter->set, NULL, &step->mod));
+            if ((ncname[0] != '*') || (ncname_len != 1)) {
+                LY_CHECK_RET(lydict_insert(iter->set.ctx, ncname, ncname_len, &step->name));
+            }
+        }
+        ++i;
+
+        /* Predicate* */
+        while ((i < exp->used) && (exp->tokens[i] == LYXP_TOKEN_BRACK1)) {
+            start = i + 1;
+            for (nest = 1, ++i; nest; ++i) {
+                if (exp->tokens[i] == LYXP_TOKEN_BRACK1) {
+                    ++nest;
+                } else if (exp->tokens[i] == LYXP_TOKEN_BRACK2) {
+                    --nest;
+                }
+            }
+
+            /* parse the predicate as a standalone expression */
+            LY_ARRAY_NEW_RET(iter->set.ctx, step->preds, pred, LY_EMEM);
+            LY_CHECK_RET(lyxp_expr_parse(iter->set.ctx, &exp->expr[exp->tok_pos[start]],
+                    exp->tok_pos[i - 1] - exp->tok_pos[start], 1, pred));
+        }
+    }
+
+    return LY_SUCCESS;
+}
+
+LY_ERR
+lyxp_iter_new(const struct ly_ctx *ctx, const struct lyxp_expr *exp, const struct lys_module *cur_mod,
+        LY_VALUE_FORMAT format, void *prefix_data, const struct lyd_node *ctx_node, const struct lyd_node *tree,
+        const struct lyxp_var *vars, uint32_t options, struct lyxp_iter **iter)
+{
+    LY_ERR rc = LY_SUCCESS;
+    ly_bool absolute;
+
+    LY_CHECK_ARG_RET(ctx, ctx, exp, iter, LY_EINVAL);
+
+    *iter = NULL;
+    if (!lyxp_iter_exp_is_path(exp, &absolute)) {
+        return LY_ENOT;
+    }
+
+    if (tree) {
+        /* adjust the pointer to be the first top-level sibling */
+        while (tree->parent) {
+            tree = lyd_parent(tree);
+        }
+        tree = lyd_first_sibling(tree);
+    }
+
+    *iter = calloc(1, sizeof **iter);
+    LY_CHECK_ERR_RET(!*iter, LOGMEM(ctx), LY_EMEM);
+
+    /* evaluation context, the same as in lyxp_eval() */
+    (*iter)->set.type = LYXP_SET_NODE_SET;
+    (*iter)->set.root_type = lyxp_get_root_type(ctx_node, NULL, options);
+    (*iter)->set.ctx = (struct ly_ctx *)ctx;
+    (*iter)->set.cur_node = ctx_node;
+    for ((*iter)->set.context_op = ctx_node ? ctx_node->schema : NULL;
+            (*iter)->set.context_op && !((*iter)->set.context_op->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF));
+            (*iter)->set.context_op = (*iter)->set.context_op->parent) {}
+    (*iter)->set.tree = tree;
+    (*iter)->set.cur_mod = cur_mod;
+    (*iter)->set.format = format;
+    (*iter)->set.prefix_data = prefix_data;
+    (*iter)->set.vars = vars;
+    (*iter)->options = options;
+    (*iter)->start = absolute ? NULL : ctx_node;
+
+    LY_CHECK_GOTO(rc = lyxp_iter_steps_create(*iter, exp), cleanup);
+
+    /* the start */
+    (*iter)->match = malloc(8 * sizeof *(*iter)->match);
+    (*iter)->anc_match = malloc(8 * sizeof *(*iter)->anc_match);
+    LY_CHECK_ERR_GOTO(!(*iter)->match || !(*iter)->anc_match, LOGMEM(ctx); rc = LY_EMEM, cleanup);
+    (*iter)->depth_size = 8;
+    (*iter)->match[0] = 1;
+    (*iter)->anc_match[0] = 1;
+
+cleanup:
+    if (rc) {
+        lyxp_iter_free(*iter);
+        *iter = NULL;
+    }
+    return rc;
+}
+
+/**
+ * @brief Check whether a node satisfies a node test and the predicates of a step.
+ *
+ * @param[in] iter Iterator to use.
+ * @param[in] node Data node to check.
+ * @param[in] step Step to check.
+ * @param[out] match Whether @p node matches.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+lyxp_iter_step_match(const struct lyxp_iter *iter, const struct lyd_node *node, const struct lyxp_iter_step *step,
+        ly_bool *match)
+{
+    LY_ERR rc = LY_SUCCESS;
+    struct lyxp_set pred_set = {0};
+    LY_ARRAY_COUNT_TYPE u;
+
+    *match = 0;
+
+    /* NodeTest */
+    if (moveto_node_check(node, LYXP_NODE_ELEM, &iter->set, step->name, step->mod, iter->options)) {
+        return LY_SUCCESS;
+    }
+
+    /* Predicate* */
+    LY_ARRAY_FOR(step->preds, u) {
+        rc = lyxp_eval(iter->set.ctx, step->preds[u], iter->set.cur_mod, iter->set.format, iter->set.prefix_data,
+                iter->set.cur_node, node, iter->set.tree, iter->set.vars, &pred_set, iter->options);
+        LY_CHECK_GOTO(rc, cleanup);
+        assert(pred_set.type != LYXP_SET_NUMBER);
+
+        LY_CHECK_GOTO(rc = lyxp_set_cast(&pred_set, LYXP_SET_BOOLEAN), cleanup);
+        if (!pred_set.val.bln) {
+            goto cleanup;
+        }
+        lyxp_set_free_content(&pred_set);
+    }
+
+    *match = 1;
+
+cleanup:
+    lyxp_set_free_content(&pred_set);
+    return rc;
+}
+
+LY_ERR
+lyxp_iter_next(struct lyxp_iter *iter, const struct lyd_node **node)
+{
+    const struct lyd_node *next;
+    const struct lyxp_iter_step *step;
+    LY_ARRAY_COUNT_TYPE u, step_count = LY_ARRAY_COUNT(iter->steps);
+    uint64_t match, anc_match, live;
+    void *mem;
+    ly_bool m;
+
+    *node = NULL;
+
+    while (1) {
+        /* DFS next, children only if they can match some step */
+        if (iter->finished) {
+            return LY_ENOTFOUND;
+        } else if (!iter->depth) {
+            next = iter->start ? lyd_child_load(iter->start) : iter->set.tree;
+            iter->depth = 1;
+        } else {
+            live = 0;
+            for (u = 0; u < step_count; ++u) {
+                if (iter->match[iter->depth] & (1ULL << u)) {
+                    live = 1;
+                } else if (iter->steps[u].desc && (iter->anc_match[iter->depth] & (1ULL << u))) {
+                    live = 1;
+                }
+            }
+
+            next = live ? lyd_child_load(iter->cur) : NULL;
+            if (next) {
+                ++iter->depth;
+            } else {
+                /* siblings, or the siblings of the parents */
+                next = iter->cur;
+                while ((iter->depth > 1) && !next->next) {
+                    next = lyd_parent(next);
+                    --iter->depth;
+                }
+                next = next->next;
+            }
+        }
+        if (!next) {
+            iter->finished = 1;
+            return LY_ENOTFOUND;
+        }
+        iter->cur = next;
+
+        if (iter->depth == iter->depth_size) {
+            mem = ly_realloc(iter->match, 2 * iter->depth_size * sizeof *iter->match);
+            LY_CHECK_ERR_RET(!mem, LOGMEM(iter->set.ctx), LY_EMEM);
+            iter->match = mem;
+            mem = ly_realloc(iter->anc_match, 2 * iter->depth_size * sizeof *iter->anc_match);
+            LY_CHECK_ERR_RET(!mem, LOGMEM(iter->set.ctx), LY_EMEM);
+            iter->anc_match = mem;
+            iter->depth_size *= 2;
+        }
+
+        if (moveto_node_check(next, LYXP_NODE_ELEM, &iter->set, NULL, NULL, iter->options) == LY_EINVAL) {
+            /* inaccessible subtree */
+            iter->match[iter->depth] = 0;
+            iter->anc_match[iter->depth] = 0;
+            continue;
+        }
+
+        /* learn the matching steps, bit n is set if step n-1 matches */
+        match = 0;
+        anc_match = iter->anc_match[iter->depth - 1];
+        for (u = 0; u < step_count; ++u) {
+            step = &iter->steps[u];
+            if (!((step->desc ? anc_match : iter->match[iter->depth - 1]) & (1ULL << u))) {
+                /* the previous step was not matched by the parent or an ancestor */
+                continue;
+            }
+
+            LY_CHECK_RET(lyxp_iter_step_match(iter, next, step, &m));
+            if (m) {
+                match |= 1ULL << (u + 1);
+            }
+        }
+        iter->match[iter->depth] = match;
+        iter->anc_match[iter->depth] = anc_match | match;
+
+        if (match & (1ULL << step_count)) {
+            /* result */
+            *node = next;
+            return LY_SUCCESS;
+        }
+    }
+}
+
+void
+lyxp_iter_free(struct lyxp_iter *iter)
+{
+    LY_ARRAY_COUNT_TYPE u, v;
+
+    if (!iter) {
+        return;
+    }
+
+    LY_ARRAY_FOR(iter->steps, u) {
+        lydict_remove(iter->set.ctx, iter->steps[u].name);
+        LY_ARRAY_FOR(iter->steps[u].preds, v) {
+            lyxp_expr_free(iter->set.ctx, iter->steps[u].preds[v]);
+        }
+        LY_ARRAY_FREE(iter->steps[u].preds);
+    }
+    LY_ARRAY_FREE(iter->steps);
+    free(iter->match);
+    free(iter->anc_match);
+    free(iter);
+}
+
 #if 0
 
 /* full xml printing of set elements, not used currently */
@@ -25,6 +25,7 @@
 
 struct ly_ctx;
 struct lyd_node;
+struct lyxp_iter;
 
 /**
  * @internal
@@ -93,6 +94,11 @@ struct lyd_node;
 /* Maximum number of nested expressions. */
 #define LYXP_MAX_BLOCK_DEPTH 100
 
+/* parallel evaluation (::LY_CTX_XPATH_PARALLEL) */
+#define LYXP_PARALLEL_MAX_THREADS 16    /* maximum number of worker threads of a single evaluation step */
+#define LYXP_PARALLEL_PRED_MIN_NODES 1024 /* minimum number of nodes evaluated by a predicate worker */
+#define LYXP_PARALLEL_DESC_MIN_NODES 4096 /* minimum number of descendant nodes traversed by a descendant axis worker */
+
 /**
  * @brief Tokens that can be in an XPath expression.
  */
@@ -353,6 +359,50 @@ LY_ERR lyxp_eval(const struct ly_ctx *ctx, const struct lyxp_expr *exp, const st
         LY_VALUE_FORMAT format, void *prefix_data, const struct lyd_node *cur_node, const struct lyd_node *ctx_node,
         const struct lyd_node *tree, const struct lyxp_var *vars, struct lyxp_set *set, uint32_t options);
 
+/**
+ * @brief Create an iterator lazily evaluating a simple path on data, in document order.
+ *
+ * Supported are only paths of child ("/") and descendant ("//") steps with name tests and predicates that are
+ * comparisons, logical expressions, or paths, without position() or last().
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] exp Parsed XPath expression to be evaluated, may be freed after the iterator is created.
+ * @param[in] cur_mod Current module for the expression (where it was "instantiated").
+ * @param[in] format Format of the XPath expression (more specifically, of any used prefixes).
+ * @param[in] prefix_data Format-specific prefix data (see ::ly_resolve_prefix), must be valid while the iterator is used.
+ * @param[in] ctx_node Starting context data node, NULL in case of the root node.
+ * @param[in] tree Data tree on which to perform the evaluation, it must include all the available data (including
+ * the tree of @p ctx_node). Can be any node of the tree, it is adjusted.
+ * @param[in] vars [Sized array](@ref sizedarrays) of XPath variables, must be valid while the iterator is used.
+ * @param[in] options Whether to apply some evaluation restrictions.
+ * @param[out] iter Created iterator.
+ * @return LY_ENOT if @p exp is not a supported path;
+ * @return LY_ERR value.
+ */
+LY_ERR lyxp_iter_new(const struct ly_ctx *ctx, const struct lyxp_expr *exp, const struct lys_module *cur_mod,
+        LY_VALUE_FORMAT format, void *prefix_data, const struct lyd_node *ctx_node, const struct lyd_node *tree,
+        const struct lyxp_var *vars, uint32_t options, struct lyxp_iter **iter);
+
+/**
+ * @brief Get the next node matching the path of an iterator.
+ *
+ * The data must not be modified while the iterator is used.
+ *
+ * @param[in] iter Iterator to use.
+ * @param[out] node Next matching data node.
+ * @return LY_SUCCESS on success;
+ * @return LY_ENOTFOUND if there are no more matching nodes;
+ * @return LY_ERR value on error.
+ */
+LY_ERR lyxp_iter_next(struct lyxp_iter *iter, const struct lyd_node **node);
+
+/**
+ * @brief Free an iterator.
+ *
+ * @param[in] iter Iterator to free.
+ */
+void lyxp_iter_free(struct lyxp_iter *iter);
+
 /**
  * @brief Get all the partial XPath nodes (atoms) that are required for @p exp to be evaluated.
  *
@@ -386,6 +436,7 @@ LY_ERR lyxp_atomize(const struct ly_ctx *ctx, const struct lyxp_expr *exp, const
 #define LYXP_ACCESS_TREE_ALL 0x80   /**< Explicit accessible tree of all the nodes. */
 #define LYXP_ACCESS_TREE_CONFIG 0x0100  /**< Explicit accessible tree of only configuration data. */
 #define LYXP_SCNODE_SCHEMAMOUNT LYS_FIND_SCHEMAMOUNT    /**< Nodes from mounted modules are also accessible. */
+#define LYXP_NO_PARALLEL     0x0400 /**< Never evaluate in parallel, used by the worker threads. */
 
 /**
  * @brief Cast XPath set to another type.
@@ -15,10 +15,12 @@
 #define _GNU_SOURCE
 
 #include <assert.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <sys/time.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "libyang.h"
 #include "tests_config.h"
@@ -147,6 +149,30 @@ create_list_inst(const struct lys_module *mod, uint32_t offset, uint32_t count,
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Print the name column of a result row.
+ *
+ * @param[in] name Name of the row.
+ */
+static void
+print_row_name(const char *name)
+{
+    const uint32_t name_fixed_len = 38;
+    char str[name_fixed_len + 1];
+    uint32_t printed;
+
+    printed = sprintf(str, "| %s ", name);
+    while (printed + 2 < name_fixed_len) {
+        printed += sprintf(str + printed, ".");
+    }
+    if (printed + 1 < name_fixed_len) {
+        printed += sprintf(str + printed, " ");
+    }
+    sprintf(str + printed, "|");
+    fputs(str, stdout);
+    fflush(stdout);
+}
+
 /**
  * @brief Execute a test.
  *
@@ -164,22 +190,11 @@ exec_test(setup_cb setup, test_cb test, const char *name, const struct lys_modul
     LY_ERR ret;
     struct timespec ts_start, ts_end;
     struct test_state state = {0};
-    const uint32_t name_fixed_len = 38;
-    char str[name_fixed_len + 1];
-    uint32_t i, printed;
+    uint32_t i;
     uint64_t time_usec = 0;
 
     /* print test start */
-    printed = sprintf(str, "| %s ", name);
-    while (printed + 2 < name_fixed_len) {
-        printed += sprintf(str + printed, ".");
-    }
-    if (printed + 1 < name_fixed_len) {
-        printed += sprintf(str + printed, " ");
-    }
-    sprintf(str + printed, "|");
-    fputs(str, stdout);
-    fflush(stdout);
+    print_row_name(name);
 
     /* setup */
     if ((ret = setup(mod, count, &state))) {
@@ -205,6 +220,45 @@ exec_test(setup_cb setup, test_cb test, const char *name, const struct lys_modul
     return LY_SUCCESS;
 }
 
+/**
+ * @brief Print the size of the testing data encoded in a format.
+ *
+ * @param[in] name Name of the encoding.
+ * @param[in] mod Module of testing data.
+ * @param[in] count Count of list instances, size of the testing data set.
+ * @param[in] format Format of the encoding.
+ * @param[in] print_options Print options of the encoding.
+ * @return LY_ERR value.
+ */
+static LY_ERR
+exec_size(const char *name, const struct lys_module *mod, uint32_t count, LYD_FORMAT format, uint32_t print_options)
+{
+    LY_ERR ret;
+    struct lyd_node *data = NULL;
+    struct ly_out *out = NULL;
+    char *buf = NULL;
+
+    print_row_name(name);
+
+    if ((ret = create_list_inst(mod, 0, count, &data))) {
+        goto cleanup;
+    }
+    if ((ret = ly_out_new_memory(&buf, 0, &out))) {
+        goto cleanup;
+    }
+    if ((ret = lyd_print_all(out, data, format, print_options))) {
+        goto cleanup;
+    }
+
+    printf(" %10" PRIu64 " B |\n", (uint64_t)ly_out_printed(out));
+
+cleanup:
+    ly_out_free(out, NULL, 0);
+    free(buf);
+    lyd_free_siblings(data);
+    return ret;
+}
+
 static void
 TEST_START(struct timespec *ts)
 {
@@ -510,6 +564,12 @@ test_parse_lyb_file_no_validate(struct test_state *state, struct timespec *ts_st
     return _test_parse(state, LYD_LYB, 1, 0, LYD_PARSE_STRICT | LYD_PARSE_ONLY | LYD_PARSE_ORDERED, 0, ts_start, ts_end);
 }
 
+static LY_ERR
+test_parse_cbor_mem_no_validate(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_parse(state, LYD_CBOR, 0, 0, LYD_PARSE_STRICT | LYD_PARSE_ONLY | LYD_PARSE_ORDERED, 0, ts_start, ts_end);
+}
+
 static LY_ERR
 _test_print(struct test_state *state, LYD_FORMAT format, uint32_t print_options, struct timespec *ts_start,
         struct timespec *ts_end)
@@ -548,6 +608,68 @@ test_print_lyb(struct test_state *state, struct timespec *ts_start, struct times
     return _test_print(state, LYD_LYB, LYD_PRINT_SHRINK, ts_start, ts_end);
 }
 
+static LY_ERR
+test_print_cbor(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_print(state, LYD_CBOR, 0, ts_start, ts_end);
+}
+
+static LY_ERR
+_test_print_fd(struct test_state *state, LYD_FORMAT format, size_t buf_size, struct timespec *ts_start,
+        struct timespec *ts_end)
+{
+    LY_ERR ret = LY_SUCCESS;
+    struct ly_out *out = NULL;
+    int fd;
+
+    if ((fd = open(TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1) {
+        return LY_ESYS;
+    }
+    if ((ret = ly_out_new_fd(fd, &out))) {
+        goto cleanup;
+    }
+    if ((ret = ly_out_buffer_size(out, buf_size))) {
+        goto cleanup;
+    }
+
+    TEST_START(ts_start);
+
+    if ((ret = lyd_print_all(out, state->data1, format, LYD_PRINT_SHRINK))) {
+        goto cleanup;
+    }
+
+    TEST_END(ts_end);
+
+cleanup:
+    ly_out_free(out, NULL, 0);
+    close(fd);
+    return ret;
+}
+
+static LY_ERR
+test_print_xml_fd(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_print_fd(state, LYD_XML, LY_OUT_BUF_SIZE, ts_start, ts_end);
+}
+
+static LY_ERR
+test_print_xml_fd_unbuffered(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_print_fd(state, LYD_XML, 0, ts_start, ts_end);
+}
+
+static LY_ERR
+test_print_json_fd(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_print_fd(state, LYD_JSON, LY_OUT_BUF_SIZE, ts_start, ts_end);
+}
+
+static LY_ERR
+test_print_json_fd_unbuffered(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
+{
+    return _test_print_fd(state, LYD_JSON, 0, ts_start, ts_end);
+}
+
 static LY_ERR
 test_dup(struct test_state *state, struct timespec *ts_start, struct timespec *ts_end)
 {
@@ -782,9 +904,15 @@ struct test tests[] = {
     {"parse lyb mem validate", setup_data_single_tree, test_parse_lyb_mem_validate},
     {"parse lyb mem no validate", setup_data_single_tree, test_parse_lyb_mem_no_validate},
     {"parse lyb file no validate", setup_data_single_tree, test_parse_lyb_file_no_validate},
+    {"parse cbor mem no validate", setup_data_single_tree, test_parse_cbor_mem_no_validate},
     {"print xml", setup_data_single_tree, test_print_xml},
     {"print json", setup_data_single_tree, test_print_json},
     {"print lyb", setup_data_single_tree, test_print_lyb},
+    {"print cbor", setup_data_single_tree, test_print_cbor},
+    {"print xml fd", setup_data_single_tree, test_print_xml_fd},
+    {"print xml fd unbuffered", setup_data_single_tree, test_print_xml_fd_unbuffered},
+    {"print json fd", setup_data_single_tree, test_print_json_fd},
+    {"print json fd unbuffered", setup_data_single_tree, test_print_json_fd_unbuffered},
     {"dup", setup_data_single_tree, test_dup},
     {"dup_siblings_to_empty", setup_data_empty_and_full_trees, test_dup_siblings_to_empty},
     {"free", setup_basic, test_free},
@@ -798,12 +926,18 @@ struct test tests[] = {
     {"merge no same destruct", setup_basic, test_merge_no_same_destruct},
 };
 
+struct test tests_sid[] = {
+    {"parse cbor sid mem no validate", setup_data_single_tree, test_parse_cbor_mem_no_validate},
+    {"print cbor sid", setup_data_single_tree, test_print_cbor},
+};
+
 int
 main(int argc, char **argv)
 {
     LY_ERR ret = LY_SUCCESS;
     struct ly_ctx *ctx = NULL;
     const struct lys_module *mod;
+    struct ly_in *in = NULL;
     uint32_t i, count, tries;
 
     if (argc < 3) {
@@ -844,9 +978,44 @@ main(int argc, char **argv)
         }
     }
 
+    /* sizes of the encodings */
+    printf("\n");
+    if ((ret = exec_size("size xml", mod, count, LYD_XML, LYD_PRINT_SHRINK))) {
+        goto cleanup;
+    }
+    if ((ret = exec_size("size json", mod, count, LYD_JSON, LYD_PRINT_SHRINK))) {
+        goto cleanup;
+    }
+    if ((ret = exec_size("size lyb", mod, count, LYD_LYB, LYD_PRINT_SHRINK))) {
+        goto cleanup;
+    }
+    if ((ret = exec_size("size cbor", mod, count, LYD_CBOR, 0))) {
+        goto cleanup;
+    }
+
+    /* load SIDs, CBOR uses them instead of the names */
+    if ((ret = ly_in_new_filepath(TESTS_SRC "/perf/perf.sid", 0, &in))) {
+        goto cleanup;
+    }
+    if ((ret = ly_ctx_load_sid_file(ctx, in))) {
+        goto cleanup;
+    }
+    if ((ret = exec_size("size cbor sid", mod, count, LYD_CBOR, 0))) {
+        goto cleanup;
+    }
+
+    /* tests with SIDs */
+    printf("\n");
+    for (i = 0; i < (sizeof tests_sid / sizeof(struct test)); ++i) {
+        if ((ret = exec_test(tests_sid[i].setup, tests_sid[i].test, tests_sid[i].name, mod, count, tries))) {
+            goto cleanup;
+        }
+    }
+
     printf("\n");
 
 cleanup:
+    ly_in_free(in, 0);
     ly_ctx_destroy(ctx);
     return ret;
 }
@@ -400,6 +400,48 @@ test_value_prefix_next(void **UNUSED(state))
     assert_int_equal(0, is_prefix);
 }
 
+static void
+test_strncspn(void **UNUSED(state))
+{
+    char buf[100];
+    size_t i, j;
+
+    /* no rejected characters, the length is not exceeded */
+    memset(buf, 'a', sizeof buf);
+    assert_int_equal(0, ly_strncspn(buf, 0, "&<>", 0));
+    assert_int_equal(37, ly_strncspn(buf, 37, "&<>", 0));
+    assert_int_equal(100, ly_strncspn(buf, 100, "&<>", 1));
+
+    /* a rejected character at every position, both in whole blocks and in the remainder */
+    for (i = 0; i < 70; ++i) {
+        for (j = 0; j < 4; ++j) {
+            buf[i] = "&<>\""[j];
+            assert_int_equal(i, ly_strncspn(buf, 70, "&<>\"", 0));
+            assert_int_equal((j == 3) ? 70 : i, ly_strncspn(buf, 70, "&<>", 0));
+        }
+
+        /* control characters */
+        buf[i] = '\n';
+        assert_int_equal(70, ly_strncspn(buf, 70, "\"\\", 0));
+        assert_int_equal(i, ly_strncspn(buf, 70, "\"\\", 1));
+        buf[i] = 0x7f;
+        assert_int_equal(i, ly_strncspn(buf, 70, "\"\\", 1));
+
+        /* non-ASCII UTF-8 bytes are never rejected */
+        buf[i] = (char)0x80;
+        assert_int_equal(70, ly_strncspn(buf, 70, "\"\\", 1));
+        buf[i] = (char)0xff;
+        assert_int_equal(70, ly_strncspn(buf, 70, "\"\\", 1));
+
+        /* NULL-byte is always rejected */
+        buf[i] = '\0';
+        assert_int_equal(i, ly_strncspn(buf, 70, "", 0));
+        assert_int_equal(i, ly_strncspn(buf, 70, "&<>\"", 0));
+
+        buf[i] = 'a';
+    }
+}
+
 int
 main(void)
 {
@@ -410,6 +452,7 @@ main(void)
         UTEST(test_parse_nodeid),
         UTEST(test_parse_instance_predicate),
         UTEST(test_value_prefix_next),
+        UTEST(test_strncspn),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
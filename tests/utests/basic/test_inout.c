@@ -25,6 +25,7 @@
 #include "log.h"
 #include "ly_common.h"
 #include "out.h"
+#include "out_internal.h"
 
 #define TEST_INPUT_FILE TESTS_BIN "/libyang_test_input"
 #define TEST_OUTPUT_FILE TESTS_BIN "/libyang_test_output"
@@ -207,6 +208,44 @@ test_output_mem(void **UNUSED(state))
     ly_out_free(out, NULL, 1);
 }
 
+static void
+test_output_primitives(void **UNUSED(state))
+{
+    struct ly_out *out = NULL;
+    char *buf = NULL;
+
+    assert_int_equal(LY_SUCCESS, ly_out_new_memory(&buf, 0, &out));
+
+    assert_int_equal(LY_SUCCESS, ly_print_lit(out, "<"));
+    assert_int_equal(LY_SUCCESS, ly_print_str(out, "name"));
+    assert_int_equal(LY_SUCCESS, ly_print_str(out, NULL));
+    assert_int_equal(LY_SUCCESS, ly_print_lit(out, ">"));
+    assert_string_equal("<name>", buf);
+    assert_int_equal(6, ly_out_printed_total(out));
+
+    /* indentation longer than the static buffer */
+    assert_int_equal(LY_SUCCESS, ly_out_reset(out));
+    assert_int_equal(LY_SUCCESS, ly_print_indent(out, 0));
+    assert_int_equal(LY_SUCCESS, ly_print_indent(out, 150));
+    assert_int_equal(150, strlen(buf));
+    assert_int_equal(150, strspn(buf, " "));
+
+    /* numbers */
+    assert_int_equal(LY_SUCCESS, ly_out_reset(out));
+    ly_print_uint(out, 0);
+    ly_print_lit(out, " ");
+    ly_print_uint(out, UINT64_MAX);
+    ly_print_lit(out, " ");
+    ly_print_int(out, -42);
+    ly_print_lit(out, " ");
+    ly_print_int(out, INT64_MIN);
+    ly_print_lit(out, " ");
+    ly_print_int(out, INT64_MAX);
+    assert_string_equal("0 18446744073709551615 -42 -9223372036854775808 9223372036854775807", buf);
+
+    ly_out_free(out, NULL, 1);
+}
+
 static void
 test_output_fd(void **UNUSED(state))
 {
@@ -248,6 +287,17 @@ test_output_fd(void **UNUSED(state))
     ly_print_flush(out);
     assert_int_equal(8, read(fd2, buf, 30));
     assert_string_equal("rewrite", buf);
+    assert_int_equal(0, lseek(fd2, 0, SEEK_SET));
+    assert_int_equal(LY_SUCCESS, ly_out_reset(out));
+
+    /* buffered writing, data not fitting into the buffer are written together with the buffered ones */
+    assert_int_equal(LY_SUCCESS, ly_out_buffer_size(out, 16));
+    assert_int_equal(LY_SUCCESS, ly_write(out, "long ", 5));
+    assert_int_equal(0, read(fd2, buf, 30));
+    assert_int_equal(LY_SUCCESS, ly_write(out, "unbuffered data", 16));
+    memset(buf, 0, sizeof buf);
+    assert_int_equal(21, read(fd2, buf, 30));
+    assert_string_equal("long unbuffered data", buf);
 
     close(fd2);
     ly_out_free(out, NULL, 1);
@@ -384,6 +434,28 @@ test_output_clb(void **UNUSED(state))
     assert_int_equal(10, read(fd2, buf, 30));
     assert_string_equal("test print", buf);
 
+    /* buffered writing */
+    assert_int_equal(LY_SUCCESS, ly_out_buffer_size(out, 16));
+    assert_int_equal(LY_SUCCESS, ly_print(out, "%s", "buffer"));
+    assert_int_equal(6, ly_out_printed(out));
+    assert_int_equal(0, read(fd2, buf, 30));
+    assert_int_equal(LY_SUCCESS, ly_write(out, "ed", 2));
+    ly_print_flush(out);
+    memset(buf, 0, sizeof buf);
+    assert_int_equal(8, read(fd2, buf, 30));
+    assert_string_equal("buffered", buf);
+
+    /* the callback is passed the data in chunks of at most the buffer size */
+    assert_int_equal(LY_SUCCESS, ly_write(out, "long ", 5));
+    assert_int_equal(LY_SUCCESS, ly_write(out, "unbuffered data", 16));
+    memset(buf, 0, sizeof buf);
+    assert_int_equal(16, read(fd2, buf, 30));
+    assert_string_equal("long unbuffered ", buf);
+    ly_print_flush(out);
+    memset(buf, 0, sizeof buf);
+    assert_int_equal(5, read(fd2, buf, 30));
+    assert_string_equal("data", buf);
+
     close(fd2);
     ly_out_free(out, close_clb, 0);
 }
@@ -397,6 +469,7 @@ main(void)
         UTEST(test_input_file, setup_files, teardown_files),
         UTEST(test_input_filepath, setup_files, teardown_files),
         UTEST(test_output_mem),
+        UTEST(test_output_primitives),
         UTEST(test_output_fd, setup_files, teardown_files),
         UTEST(test_output_file, setup_files, teardown_files),
         UTEST(test_output_filepath, setup_files, teardown_files),
@@ -14,7 +14,9 @@
 #define _UTEST_MAIN_
 #include "utests.h"
 
+#include <inttypes.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "context.h"
 #include "parser_data.h"
@@ -402,6 +404,346 @@ test_hash(void **state)
     lyd_free_all(tree);
 }
 
+static void
+test_index(void **state)
+{
+    const char *data =
+            "<c xmlns=\"urn:tests:a\">\n"
+            "    <ll>\n"
+            "        <a>val_a</a>\n"
+            "        <ll>\n"
+            "            <a>val_c</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_b</a>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_a</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_d</a>\n"
+            "            <b>other</b>\n"
+            "        </ll>\n"
+            "    </ll>\n"
+            "</c>";
+    struct lyd_node *tree, *node;
+    struct ly_set *set;
+    const struct lysc_node *leaf;
+
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+    assert_non_null(tree);
+
+    /* keys and top-level list leaves cannot be indexed */
+    leaf = lys_find_path(UTEST_LYCTX, NULL, "/a:c/ll/ll/a", 0);
+    assert_non_null(leaf);
+    assert_int_equal(LY_EINVAL, lyd_index_add(leaf));
+    CHECK_LOG_CTX("Leaf \"a\" is a list key, instances are always found by hashes.", NULL, 0);
+    leaf = lys_find_path(UTEST_LYCTX, NULL, "/a:l1/c", 0);
+    assert_non_null(leaf);
+    assert_int_equal(LY_EINVAL, lyd_index_add(leaf));
+    CHECK_LOG_CTX("Indexing instances of top-level list \"l1\" is not supported.", NULL, 0);
+
+    leaf = lys_find_path(UTEST_LYCTX, NULL, "/a:c/ll/ll/b", 0);
+    assert_non_null(leaf);
+    assert_int_equal(LY_ENOTFOUND, lyd_index_remove(leaf));
+    assert_int_equal(LY_SUCCESS, lyd_index_add(leaf));
+    assert_int_equal(LY_SUCCESS, lyd_index_add(leaf));
+
+    /* index used, results in document order (ordered by keys) */
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='val']", &set));
+    assert_int_equal(2, set->count);
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[0])), "val_a");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[1])), "val_c");
+    ly_set_free(set, NULL);
+
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='none']", &set));
+    assert_int_equal(0, set->count);
+    ly_set_free(set, NULL);
+
+    /* value change is reflected */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c/ll[a='val_a']/ll[a='val_d']/b", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "val"));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='val']", &set));
+    assert_int_equal(3, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='other']", &set));
+    assert_int_equal(0, set->count);
+    ly_set_free(set, NULL);
+
+    /* unlinked and inserted leaves are reflected */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c/ll[a='val_a']/ll[a='val_c']/b", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c/ll[a='val_a']/ll[a='val_b']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_new_term(node, NULL, "b", "new", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='val']", &set));
+    assert_int_equal(2, set->count);
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[0])), "val_a");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[1])), "val_d");
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='new']", &set));
+    assert_int_equal(1, set->count);
+    assert_ptr_equal(node, set->objs[0]);
+    ly_set_free(set, NULL);
+
+    /* the same results without the index */
+    assert_int_equal(LY_SUCCESS, lyd_index_remove(leaf));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c/ll[a='val_a']/ll[b='val']", &set));
+    assert_int_equal(2, set->count);
+    ly_set_free(set, NULL);
+
+    lyd_free_all(tree);
+}
+
+static void
+test_inst_index(void **state)
+{
+    const char *data =
+            "<l1 xmlns=\"urn:tests:a\">\n"
+            "    <a>a1</a>\n"
+            "    <b>b1</b>\n"
+            "    <c>c1</c>\n"
+            "</l1>\n"
+            "<l1 xmlns=\"urn:tests:a\">\n"
+            "    <a>a2</a>\n"
+            "    <b>b2</b>\n"
+            "</l1>\n"
+            "<c xmlns=\"urn:tests:a\">\n"
+            "    <ll>\n"
+            "        <a>val_b</a>\n"
+            "        <ll>\n"
+            "            <a>val_b</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_a</a>\n"
+            "        </ll>\n"
+            "    </ll>\n"
+            "    <ll>\n"
+            "        <a>val_a</a>\n"
+            "        <ll>\n"
+            "            <a>val_c</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "    </ll>\n"
+            "    <ll2>one</ll2>\n"
+            "    <ll2>two</ll2>\n"
+            "</c>";
+    const char *paths[] = {"//a:ll", "/a:c//a:a", "/a:c/ll//b", "//a:l1/a", "//a:ll[a='val_b']", "/a:c/ll/ll//a",
+        "//a:ll2", "//a:foo"};
+    struct ly_ctx *ctx;
+    struct lyd_node *tree, *node;
+    struct ly_set *set, *set2;
+    uint32_t i, j;
+
+    assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_INST_INDEX));
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+    assert_non_null(tree);
+
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//a:ll", &set));
+    assert_int_equal(5, set->count);
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[0])), "val_a");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[1])), "val_c");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[2])), "val_b");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[3])), "val_a");
+    assert_string_equal(lyd_get_value(lyd_child(set->objs[4])), "val_b");
+    ly_set_free(set, NULL);
+
+    /* freed nodes are not found */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c/ll[a='val_a']/ll[a='val_c']", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/a:c//b", &set));
+    assert_int_equal(1, set->count);
+    ly_set_free(set, NULL);
+
+    /* the index is enabled again with data existing, it is never used in the context */
+    assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(UTEST_LYCTX, LY_CTX_INST_INDEX));
+    assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_INST_INDEX));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//a:ll", &set));
+    assert_int_equal(4, set->count);
+    ly_set_free(set, NULL);
+    lyd_free_all(tree);
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//a:ll", &set));
+    assert_int_equal(5, set->count);
+    ly_set_free(set, NULL);
+    lyd_free_all(tree);
+
+    /* the same results without the index */
+    for (i = 0; i < sizeof paths / sizeof *paths; ++i) {
+        assert_int_equal(LY_SUCCESS, ly_ctx_new(NULL, LY_CTX_INST_INDEX, &ctx));
+        assert_int_equal(LY_SUCCESS, lys_parse_mem(ctx, schema_a, LYS_IN_YANG, NULL));
+        assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(ctx, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, paths[i], &set));
+        assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(ctx, LY_CTX_INST_INDEX));
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, paths[i], &set2));
+
+        assert_int_equal(set->count, set2->count);
+        for (j = 0; j < set->count; ++j) {
+            assert_ptr_equal(set->objs[j], set2->objs[j]);
+        }
+        ly_set_free(set, NULL);
+        ly_set_free(set2, NULL);
+        lyd_free_all(tree);
+        ly_ctx_destroy(ctx);
+    }
+}
+
+static void
+test_iter(void **state)
+{
+    const char *data =
+            "<l1 xmlns=\"urn:tests:a\">\n"
+            "    <a>a1</a>\n"
+            "    <b>b1</b>\n"
+            "    <c>c1</c>\n"
+            "</l1>\n"
+            "<l1 xmlns=\"urn:tests:a\">\n"
+            "    <a>a2</a>\n"
+            "    <b>b2</b>\n"
+            "</l1>\n"
+            "<foo xmlns=\"urn:tests:a\">foo value</foo>\n"
+            "<c xmlns=\"urn:tests:a\">\n"
+            "    <x>val</x>\n"
+            "    <ll>\n"
+            "        <a>val_a</a>\n"
+            "        <ll>\n"
+            "            <a>val_a</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_b</a>\n"
+            "        </ll>\n"
+            "    </ll>\n"
+            "    <ll>\n"
+            "        <a>val_b</a>\n"
+            "        <ll>\n"
+            "            <a>val_a</a>\n"
+            "        </ll>\n"
+            "        <ll>\n"
+            "            <a>val_b</a>\n"
+            "            <b>val</b>\n"
+            "        </ll>\n"
+            "    </ll>\n"
+            "    <ll2>one</ll2>\n"
+            "    <ll2>two</ll2>\n"
+            "    <ll2>three</ll2>\n"
+            "</c>";
+    const char *paths[] = {"/a:l1", "/a:l1/a", "//a", "/a:c//ll", "//ll/ll", "/a:c/ll[a='val_b']//b", "//ll[b]",
+        "/a:c/*/ll[2]", "/a:c/ll2[. != 'two']", "//ll[ll[b = 'val']]/a", "/a:*", "//a:ll2[2]", "/a:c/ll//ll[1][a='val_a']",
+        "/a:l1 | /a:foo", "/a:c/ll[last()]", "//none"};
+    struct lyd_node *tree, *node;
+    struct lyd_xpath_iter *iter;
+    struct ly_set *set;
+    ly_bool result;
+    uint32_t i, j;
+
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+    assert_non_null(tree);
+
+    /* the same nodes in the same order as the full evaluation */
+    for (i = 0; i < sizeof paths / sizeof *paths; ++i) {
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, paths[i], &set));
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath_iter(tree, tree, paths[i], LY_VALUE_JSON, NULL, NULL, &iter));
+        for (j = 0; j < set->count; ++j) {
+            assert_int_equal(LY_SUCCESS, lyd_find_xpath_next(iter, &node));
+            assert_ptr_equal(set->dnodes[j], node);
+        }
+        assert_int_equal(LY_ENOTFOUND, lyd_find_xpath_next(iter, &node));
+        assert_null(node);
+        assert_int_equal(LY_ENOTFOUND, lyd_find_xpath_next(iter, &node));
+        lyd_find_xpath_iter_free(iter);
+
+        assert_int_equal(LY_SUCCESS, lyd_eval_xpath(tree, paths[i], &result));
+        assert_int_equal(set->count ? 1 : 0, result);
+        ly_set_free(set, NULL);
+    }
+
+    /* relative path, stop early */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath_iter(node, tree, "ll/ll/a", LY_VALUE_JSON, NULL, NULL, &iter));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath_next(iter, &node));
+    assert_string_equal(lyd_get_value(node), "val_a");
+    assert_string_equal(lyd_get_value(lyd_child(lyd_parent(lyd_parent(node)))), "val_a");
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath_next(iter, &node));
+    assert_string_equal(lyd_get_value(node), "val_b");
+    lyd_find_xpath_iter_free(iter);
+
+    /* invalid */
+    assert_int_equal(LY_EVALID, lyd_find_xpath_iter(tree, tree, "/a:c/ll[", LY_VALUE_JSON, NULL, NULL, &iter));
+    UTEST_LOG_CTX_CLEAN;
+    assert_int_equal(LY_EVALID, lyd_find_xpath_iter(tree, tree, "/x:c", LY_VALUE_JSON, NULL, NULL, &iter));
+    CHECK_LOG_CTX("Unknown/non-implemented module \"x\".", NULL, 0);
+
+    lyd_free_all(tree);
+}
+
+#if !defined (_WIN32) && !defined (__APPLE__)
+
+long __real_sysconf(int name);
+
+/* pretend there are several CPUs so that the parallel evaluation is always used */
+long
+__wrap_sysconf(int name)
+{
+    if (name == _SC_NPROCESSORS_ONLN) {
+        return 4;
+    }
+    return __real_sysconf(name);
+}
+
+#endif
+
+static void
+test_parallel(void **state)
+{
+    const char *paths[] = {"//c", "//a:l1[c = 'c7']/a", "//*[contains(., '13')]", "/a:l1[position() mod 3 = 0]/b",
+        "/a:l1[last()]", "/a:l1[5]", "/a:l1[c][position() < 4]", "//a:l1/*[. = 'a300' or . = 'b301']", "/a:l1//b"};
+    struct lyd_node *tree;
+    struct ly_set *set, *par_set;
+    char *data;
+    uint32_t i, j, len = 0;
+
+    /* many top-level instances */
+    data = malloc(10000 * 80);
+    assert_non_null(data);
+    for (i = 0; i < 10000; ++i) {
+        if (i % 2) {
+            len += sprintf(data + len, "<l1 xmlns=\"urn:tests:a\"><a>a%" PRIu32 "</a><b>b%" PRIu32 "</b></l1>", i, i);
+        } else {
+            len += sprintf(data + len, "<l1 xmlns=\"urn:tests:a\"><a>a%" PRIu32 "</a><b>b%" PRIu32 "</b><c>c%" PRIu32
+                    "</c></l1>", i, i, i);
+        }
+    }
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, data, LYD_XML, LYD_PARSE_STRICT, LYD_VALIDATE_PRESENT, &tree));
+    free(data);
+
+    /* the same nodes in the same order as the serial evaluation */
+    for (i = 0; i < sizeof paths / sizeof *paths; ++i) {
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, paths[i], &set));
+        assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_XPATH_PARALLEL));
+        assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, paths[i], &par_set));
+        assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(UTEST_LYCTX, LY_CTX_XPATH_PARALLEL));
+
+        assert_int_equal(set->count, par_set->count);
+        for (j = 0; j < set->count; ++j) {
+            assert_ptr_equal(set->dnodes[j], par_set->dnodes[j]);
+        }
+        ly_set_free(set, NULL);
+        ly_set_free(par_set, NULL);
+    }
+
+    /* errors are logged by the calling thread */
+    assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_XPATH_PARALLEL));
+    assert_int_equal(LY_EVALID, lyd_find_xpath(tree, "/a:l1[count(a) = count(string(b))]", &set));
+    CHECK_LOG_CTX("Wrong type of argument #1 (string) for the XPath function count(node-set).",
+            "/a:l1[a='a0'][b='b0']", 0);
+    assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(UTEST_LYCTX, LY_CTX_XPATH_PARALLEL));
+
+    lyd_free_all(tree);
+}
+
 static void
 test_rpc(void **state)
 {
@@ -1269,6 +1611,10 @@ main(void)
         UTEST(test_union, setup),
         UTEST(test_invalid, setup),
         UTEST(test_hash, setup),
+        UTEST(test_index, setup),
+        UTEST(test_inst_index, setup),
+        UTEST(test_iter, setup),
+        UTEST(test_parallel, setup),
         UTEST(test_rpc, setup),
         UTEST(test_toplevel, setup),
         UTEST(test_atomize, setup),
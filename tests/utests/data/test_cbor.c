@@ -0,0 +1,322 @@
+/**
+ * @file test_cbor.c
+ * @brief Cmocka tests for YANG-CBOR data format.
+ *
+ * Copyright (c) 2026 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+#define _UTEST_MAIN_
+#include "utests.h"
+
+#include "libyang.h"
+
+static const char *types_mod =
+        "module types {yang-version 1.1; namespace urn:types; prefix t;"
+        "  identity base;"
+        "  identity id1 {base base;}"
+        "  container cont {"
+        "    leaf u8 {type uint8;}"
+        "    leaf i16 {type int16;}"
+        "    leaf u64 {type uint64;}"
+        "    leaf i64 {type int64;}"
+        "    leaf d {type decimal64 {fraction-digits 2;}}"
+        "    leaf b {type boolean;}"
+        "    leaf e {type empty;}"
+        "    leaf bin {type binary;}"
+        "    leaf en {type enumeration {enum one; enum two {value 5;}}}"
+        "    leaf bi {type bits {bit a; bit b {position 10;}}}"
+        "    leaf str {type string;}"
+        "    leaf id {type identityref {base base;}}"
+        "    leaf un {type union {type uint8; type enumeration {enum x;} type bits {bit y;} type identityref {base base;}"
+        "      type string;}}"
+        "    leaf-list ll {type int8;}"
+        "    list lst {key k; leaf k {type string;} leaf v {type int32;}}"
+        "    anydata any;"
+        "  }"
+        "  rpc oper {"
+        "    input {leaf arg {type string;}}"
+        "    output {leaf res {type uint32;}}"
+        "  }"
+        "}";
+
+static const char *types_sid =
+        "{\"ietf-sid-file:sid-file\": {\"module-name\": \"types\", \"module-revision\": \"unknown\","
+        "  \"item\": ["
+        "    {\"namespace\": \"module\", \"identifier\": \"types\", \"sid\": \"60000\"},"
+        "    {\"namespace\": \"identity\", \"identifier\": \"base\", \"sid\": \"60001\"},"
+        "    {\"namespace\": \"identity\", \"identifier\": \"id1\", \"sid\": \"60002\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont\", \"sid\": \"60010\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/u8\", \"sid\": \"60011\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/d\", \"sid\": \"60012\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/id\", \"sid\": \"60013\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/un\", \"sid\": \"60014\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/lst\", \"sid\": \"60015\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/lst/k\", \"sid\": \"60016\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:cont/any\", \"sid\": \"60017\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:oper\", \"sid\": \"60020\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:oper/input/arg\", \"sid\": \"60021\"},"
+        "    {\"namespace\": \"data\", \"identifier\": \"/types:oper/output/res\", \"sid\": \"60022\"}"
+        "  ]"
+        "}}";
+
+static int
+setup(void **state)
+{
+    UTEST_SETUP;
+    UTEST_ADD_MODULE(types_mod, LYS_IN_YANG, NULL, NULL);
+
+    return 0;
+}
+
+static void
+load_sid(void **state, const char *sid_file)
+{
+    struct ly_in *in;
+
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory(sid_file, &in));
+    assert_int_equal(LY_SUCCESS, ly_ctx_load_sid_file(UTEST_LYCTX, in));
+    ly_in_free(in, 0);
+}
+
+static void
+check_print_parse(void **state, const char *data_json)
+{
+    struct lyd_node *tree_1, *tree_2;
+    char *cbor_out;
+
+    CHECK_PARSE_LYD_PARAM(data_json, LYD_JSON, LYD_PARSE_ONLY | LYD_PARSE_STRICT, 0, LY_SUCCESS, tree_1);
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&cbor_out, tree_1, LYD_CBOR, LYD_PRINT_WITHSIBLINGS));
+    CHECK_PARSE_LYD_PARAM(cbor_out, LYD_CBOR, LYD_PARSE_ONLY | LYD_PARSE_STRICT, 0, LY_SUCCESS, tree_2);
+    assert_non_null(tree_2);
+    CHECK_LYD(tree_1, tree_2);
+
+    free(cbor_out);
+    lyd_free_all(tree_1);
+    lyd_free_all(tree_2);
+}
+
+static void
+check_bytes(void **state, const char *data_json, const char *bytes, size_t len)
+{
+    struct lyd_node *tree;
+    struct ly_out *out;
+    char *cbor_out = NULL;
+
+    CHECK_PARSE_LYD_PARAM(data_json, LYD_JSON, LYD_PARSE_ONLY | LYD_PARSE_STRICT, 0, LY_SUCCESS, tree);
+    assert_int_equal(LY_SUCCESS, ly_out_new_memory(&cbor_out, 0, &out));
+    assert_int_equal(LY_SUCCESS, lyd_print_all(out, tree, LYD_CBOR, 0));
+    assert_int_equal(len, ly_out_printed(out));
+    assert_int_equal(0, memcmp(bytes, cbor_out, len));
+
+    ly_out_free(out, NULL, 1);
+    lyd_free_all(tree);
+}
+
+static const char *types_data =
+        "{\"types:cont\": {\"u8\": 200, \"i16\": -300, \"u64\": \"18446744073709551615\","
+        "  \"i64\": \"-9223372036854775808\", \"d\": \"-1.05\", \"b\": true, \"e\": [null], \"bin\": \"AQID\","
+        "  \"en\": \"two\", \"bi\": \"a b\", \"str\": \"text\", \"id\": \"types:id1\", \"un\": \"x\", \"ll\": [-1, 2],"
+        "  \"lst\": [{\"k\": \"a\", \"v\": 1}, {\"k\": \"b\", \"v\": -2}], \"any\": {\"types:cont\": {\"u8\": 1}}}}";
+
+static void
+test_types(void **state)
+{
+    check_print_parse(state, types_data);
+
+    /* union members */
+    check_print_parse(state, "{\"types:cont\": {\"un\": 7}}");
+    check_print_parse(state, "{\"types:cont\": {\"un\": \"y\"}}");
+    check_print_parse(state, "{\"types:cont\": {\"un\": \"types:id1\"}}");
+    check_print_parse(state, "{\"types:cont\": {\"un\": \"300\"}}");
+
+    /* bits in a bitmap */
+    check_bytes(state, "{\"types:cont\": {\"bi\": \"b\"}}",
+            "\xA1\x6A" "types:cont" "\xA1\x62" "bi" "\x42\x00\x04", 19);
+
+    /* decimal fraction */
+    check_bytes(state, "{\"types:cont\": {\"d\": \"-1.05\"}}",
+            "\xA1\x6A" "types:cont" "\xA1\x61" "d" "\xC4\x82\x21\x38\x68", 20);
+}
+
+static void
+test_sid(void **state)
+{
+    load_sid(state, types_sid);
+
+    check_print_parse(state, types_data);
+    check_print_parse(state, "{\"types:cont\": {\"un\": \"types:id1\"}}");
+
+    /* delta SIDs */
+    check_bytes(state, "{\"types:cont\": {\"u8\": 5}}", "\xA1\x19\xEA\x6A\xA1\x01\x05", 7);
+
+    /* identityref SID, tagged in a union */
+    check_bytes(state, "{\"types:cont\": {\"id\": \"types:id1\", \"un\": \"types:id1\"}}",
+            "\xA1\x19\xEA\x6A\xA2\x03\x19\xEA\x62\x04\xD8\x2D\x19\xEA\x62", 15);
+
+    /* names of nodes without a SID */
+    check_bytes(state, "{\"types:cont\": {\"lst\": [{\"k\": \"a\", \"v\": 1}]}}",
+            "\xA1\x19\xEA\x6A\xA1\x05\x81\xA2\x01\x61" "a" "\x61" "v" "\x01", 14);
+
+    /* anydata members relative to the anydata node */
+    check_bytes(state, "{\"types:cont\": {\"any\": {\"types:cont\": {\"u8\": 1}}}}",
+            "\xA1\x19\xEA\x6A\xA1\x07\xA1\x26\xA1\x01\x01", 11);
+}
+
+static void
+test_sid_later_module(void **state)
+{
+    const char *mod = "module late {namespace urn:late; prefix l; container c {leaf l {type uint8;}}}";
+    const char *sid =
+            "{\"ietf-sid-file:sid-file\": {\"module-name\": \"late\", \"item\": ["
+            "  {\"namespace\": \"data\", \"identifier\": \"/late:c\", \"sid\": 1000},"
+            "  {\"namespace\": \"data\", \"identifier\": \"/late:c/l\", \"sid\": 1001}"
+            "]}}";
+
+    /* SID file loaded before the module */
+    load_sid(state, sid);
+    UTEST_ADD_MODULE(mod, LYS_IN_YANG, NULL, NULL);
+
+    check_bytes(state, "{\"late:c\": {\"l\": 5}}", "\xA1\x19\x03\xE8\xA1\x01\x05", 7);
+    check_print_parse(state, "{\"late:c\": {\"l\": 5}}");
+}
+
+static void
+test_rpc(void **state)
+{
+    struct ly_in *in;
+    struct lyd_node *tree_1, *tree_2, *op;
+    char *cbor_out;
+
+    load_sid(state, types_sid);
+
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory("{\"types:oper\": {\"arg\": \"val\"}}", &in));
+    assert_int_equal(LY_SUCCESS, lyd_parse_op(UTEST_LYCTX, NULL, in, LYD_JSON, LYD_TYPE_RPC_YANG, &tree_1, NULL));
+    ly_in_free(in, 0);
+
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&cbor_out, tree_1, LYD_CBOR, 0));
+    assert_int_equal(0, memcmp("\xA1\x19\xEA\x74\xA1\x01\x63" "val", cbor_out, 10));
+
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory(cbor_out, &in));
+    assert_int_equal(LY_SUCCESS, lyd_parse_op(UTEST_LYCTX, NULL, in, LYD_CBOR, LYD_TYPE_RPC_YANG, &tree_2, &op));
+    ly_in_free(in, 0);
+    assert_non_null(op);
+    CHECK_LYD(tree_1, tree_2);
+
+    free(cbor_out);
+    lyd_free_all(tree_1);
+    lyd_free_all(tree_2);
+}
+
+static void
+test_sid_file_invalid(void **state)
+{
+    struct ly_in *in;
+
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory("{\"item\": [{\"namespace\": \"data\", \"identifier\": \"/types:cont\","
+            " \"sid\": \"0\"}]}", &in));
+    assert_int_equal(LY_EVALID, ly_ctx_load_sid_file(UTEST_LYCTX, in));
+    ly_in_free(in, 0);
+    CHECK_LOG_CTX("Invalid SID \"0\".", NULL, 1);
+
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory("{\"item\": [{\"namespace\": \"data\", \"identifier\": \"/types:cont\","
+            " \"sid\": 10}, {\"namespace\": \"data\", \"identifier\": \"/types:cont/u8\", \"sid\": 10}]}", &in));
+    assert_int_equal(LY_EVALID, ly_ctx_load_sid_file(UTEST_LYCTX, in));
+    ly_in_free(in, 0);
+    CHECK_LOG_CTX("SID 10 assigned to both \"/types:cont\" and \"/types:cont/u8\".", NULL, 1);
+}
+
+static void
+test_parse_invalid(void **state)
+{
+    struct lyd_node *tree;
+
+    /* not a map */
+    CHECK_PARSE_LYD_PARAM("\x01", LYD_CBOR, 0, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Expected a YANG-CBOR map of the data nodes.", NULL, 0);
+
+    /* unknown node */
+    CHECK_PARSE_LYD_PARAM("\xA1\x63" "a:b" "\x01", LYD_CBOR, LYD_PARSE_STRICT, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Node \"a:b\" not found.", NULL, 0);
+    CHECK_PARSE_LYD_PARAM("\xA1\x63" "a:b" "\x01", LYD_CBOR, LYD_PARSE_ONLY, 0, LY_SUCCESS, tree);
+    assert_null(tree);
+
+    /* invalid value */
+    CHECK_PARSE_LYD_PARAM("\xA1\x6A" "types:cont" "\xA1\x62" "u8" "\x19\x01\x00", LYD_CBOR, 0, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Value \"256\" is out of type uint8 min/max bounds.", "/types:cont/u8", 0);
+
+    /* leaf-list not an array */
+    CHECK_PARSE_LYD_PARAM("\xA1\x6A" "types:cont" "\xA1\x62" "ll" "\x01", LYD_CBOR, 0, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Expected a YANG-CBOR array as the value of \"ll\".", "/types:cont", 0);
+
+    /* NUL in a name and in a value */
+    CHECK_PARSE_LYD_PARAM("\xA1\x6C" "types:cont\0x" "\xA0", LYD_CBOR, LYD_PARSE_ONLY, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Invalid YANG-CBOR text string with a NUL character.", NULL, 0);
+    CHECK_PARSE_LYD_PARAM("\xA1\x6A" "types:cont" "\xA1\x63" "str" "\x63" "a\0b", LYD_CBOR, LYD_PARSE_ONLY, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Invalid YANG-CBOR text string with a NUL character.", "/types:cont/str", 0);
+    CHECK_PARSE_LYD_PARAM("\xA1\x6A" "types:cont" "\xA1\x63" "str" "\x7F\x61" "a" "\x62" "\0b" "\xFF", LYD_CBOR,
+            LYD_PARSE_ONLY, 0, LY_EVALID, tree);
+    CHECK_LOG_CTX("Invalid YANG-CBOR text string with a NUL character.", "/types:cont/str", 0);
+}
+
+static void
+test_parse_limits(void **state)
+{
+    const char str_long[] = "\xA1\x6A" "types:cont" "\xA1\x63" "str" "\x7A\xFF\xFF\xFF\xFF" "a";
+    const char chunk_long[] = "\xA1\x6A" "types:cont" "\xA1\x63" "str" "\x7F\x61" "a" "\x7A\xFF\xFF\xFF\xFF" "a\xFF";
+    const char chunk_overflow[] = "\xA1\x6A" "types:cont" "\xA1\x63" "str" "\x7F\x61" "a"
+            "\x7B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" "\xFF";
+    struct ly_in *in;
+    struct lyd_node *tree;
+    char *data;
+    uint32_t i;
+
+    /* deeply nested unknown member */
+    data = malloc(6 + 6000);
+    assert_non_null(data);
+    memcpy(data, "\xA1\x63" "a:b", 5);
+    for (i = 0; i < 6000; ++i) {
+        data[5 + i] = '\xC6';
+    }
+    data[5 + i] = '\x01';
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory_len(data, 6 + 6000, &in));
+    assert_int_equal(LY_EVALID, lyd_parse_data(UTEST_LYCTX, NULL, in, LYD_CBOR, LYD_PARSE_ONLY, 0, &tree));
+    CHECK_LOG_CTX("Maximum number 5000 of YANG-CBOR nestings has been exceeded.", NULL, 0);
+    ly_in_free(in, 1);
+
+    /* string longer than the data */
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory_len(str_long, sizeof str_long - 1, &in));
+    assert_int_equal(LY_EVALID, lyd_parse_data(UTEST_LYCTX, NULL, in, LYD_CBOR, LYD_PARSE_ONLY, 0, &tree));
+    CHECK_LOG_CTX("Unexpected end of YANG-CBOR data.", "/types:cont/str", 0);
+    ly_in_free(in, 0);
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory_len(chunk_long, sizeof chunk_long - 1, &in));
+    assert_int_equal(LY_EVALID, lyd_parse_data(UTEST_LYCTX, NULL, in, LYD_CBOR, LYD_PARSE_ONLY, 0, &tree));
+    CHECK_LOG_CTX("Unexpected end of YANG-CBOR data.", "/types:cont/str", 0);
+    ly_in_free(in, 0);
+
+    /* string length overflowing the size */
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory_len(chunk_overflow, sizeof chunk_overflow - 1, &in));
+    assert_int_equal(LY_EVALID, lyd_parse_data(UTEST_LYCTX, NULL, in, LYD_CBOR, LYD_PARSE_ONLY, 0, &tree));
+    CHECK_LOG_CTX("Too long YANG-CBOR string of 18446744073709551615 bytes.", "/types:cont/str", 0);
+    ly_in_free(in, 0);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        UTEST(test_types, setup),
+        UTEST(test_sid, setup),
+        UTEST(test_sid_later_module, setup),
+        UTEST(test_rpc, setup),
+        UTEST(test_sid_file_invalid, setup),
+        UTEST(test_parse_invalid, setup),
+        UTEST(test_parse_limits, setup),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -715,6 +715,68 @@ test_userord_llist2(void **state)
     TEST_DIFF_3(xml1, xml2, xml3, 0, out_diff_1, out_diff_2, out_merge);
 }
 
+static void
+test_userord_llist_rotate(void **state)
+{
+    (void) state;
+    const char *xml1 =
+            "<df xmlns=\"urn:libyang:tests:defaults\">\n"
+            "  <llist>1</llist>\n"
+            "  <llist>2</llist>\n"
+            "  <llist>3</llist>\n"
+            "  <llist>4</llist>\n"
+            "  <llist>5</llist>\n"
+            "</df>\n";
+    const char *xml2 =
+            "<df xmlns=\"urn:libyang:tests:defaults\">\n"
+            "  <llist>2</llist>\n"
+            "  <llist>3</llist>\n"
+            "  <llist>4</llist>\n"
+            "  <llist>5</llist>\n"
+            "  <llist>1</llist>\n"
+            "</df>\n";
+    const char *xml3 =
+            "<df xmlns=\"urn:libyang:tests:defaults\">\n"
+            "  <llist>5</llist>\n"
+            "  <llist>1</llist>\n"
+            "  <llist>2</llist>\n"
+            "  <llist>3</llist>\n"
+            "  <llist>4</llist>\n"
+            "</df>\n";
+
+    const char *out_diff_1 =
+            "<df xmlns=\"urn:libyang:tests:defaults\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:operation=\"none\">\n"
+            "  <llist yang:operation=\"replace\" yang:orig-default=\"false\" yang:orig-value=\"\" yang:value=\"5\">1</llist>\n"
+            "</df>\n";
+    const char *out_diff_2 =
+            "<df xmlns=\"urn:libyang:tests:defaults\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:operation=\"none\">\n"
+            "  <llist yang:operation=\"replace\" yang:orig-default=\"false\" yang:orig-value=\"4\" yang:value=\"\">5</llist>\n"
+            "  <llist yang:operation=\"replace\" yang:orig-default=\"false\" yang:orig-value=\"4\" yang:value=\"5\">1</llist>\n"
+            "</df>\n";
+    struct lyd_node *data1, *data2, *data3, *diff;
+
+    CHECK_PARSE_LYD(xml1, data1);
+    CHECK_PARSE_LYD(xml2, data2);
+    CHECK_PARSE_LYD(xml3, data3);
+
+    /* only the instances not keeping their relative order are moved */
+    CHECK_PARSE_LYD_DIFF(data1, data2, LYD_DIFF_MIN_MOVES, diff);
+    CHECK_LYD_STRING(diff, out_diff_1);
+    assert_int_equal(lyd_diff_apply_all(&data1, diff), LY_SUCCESS);
+    CHECK_LYD(data1, data2);
+    lyd_free_all(diff);
+
+    CHECK_PARSE_LYD_DIFF(data2, data3, LYD_DIFF_MIN_MOVES, diff);
+    CHECK_LYD_STRING(diff, out_diff_2);
+    assert_int_equal(lyd_diff_apply_all(&data2, diff), LY_SUCCESS);
+    CHECK_LYD(data2, data3);
+    lyd_free_all(diff);
+
+    lyd_free_all(data1);
+    lyd_free_all(data2);
+    lyd_free_all(data3);
+}
+
 static void
 test_userord_mix(void **state)
 {
@@ -1374,6 +1436,75 @@ test_metadata(void **state)
     TEST_DIFF_3(xml1, xml2, xml3, LYD_DIFF_META, out_diff_1, out_diff_2, out_merge);
 }
 
+static void
+test_lyb(void **state)
+{
+    (void) state;
+    const char *xml1 = "<df xmlns=\"urn:libyang:tests:defaults\" xmlns:df=\"urn:libyang:tests:defaults\">\n"
+            "  <foo>10</foo>\n"
+            "  <llist>1</llist><llist>2</llist><llist>3</llist>\n"
+            "  <ul><l1>a</l1><l2>1</l2></ul><ul><l1>b</l1><l2>2</l2></ul>\n"
+            "  <list df:my-meta=\"val1\"><name>a</name><value>1</value></list>\n"
+            "  <list><name>b</name><value df:my-meta2=\"val2\">2</value></list>\n"
+            "</df>\n";
+    const char *xml2 = "<df xmlns=\"urn:libyang:tests:defaults\" xmlns:df=\"urn:libyang:tests:defaults\">\n"
+            "  <foo>20</foo>\n"
+            "  <llist>3</llist><llist>1</llist><llist>2</llist>\n"
+            "  <ul><l1>b</l1><l2>2</l2></ul><ul><l1>a</l1><l2>5</l2></ul>\n"
+            "  <list><name>b</name><value df:my-meta2=\"val3\">2</value></list>\n"
+            "  <list><name>c</name><value>3</value></list>\n"
+            "</df>\n";
+    struct lyd_node *data1, *data2, *diff, *diff2, *empty = NULL;
+    char *lyb, *lyb_diff;
+    struct ly_out *out;
+    struct ly_in *in;
+    size_t len, len_diff;
+
+    CHECK_PARSE_LYD(xml1, data1);
+    CHECK_PARSE_LYD(xml2, data2);
+    CHECK_PARSE_LYD_DIFF(data1, data2, LYD_DIFF_META, diff);
+
+    /* the diff metadata are encoded compactly */
+    assert_int_equal(LY_SUCCESS, ly_out_new_memory(&lyb, 0, &out));
+    assert_int_equal(LY_SUCCESS, lyd_print_all(out, diff, LYD_LYB, 0));
+    len = ly_out_printed(out);
+    ly_out_free(out, NULL, 0);
+    assert_int_equal(LY_SUCCESS, ly_out_new_memory(&lyb_diff, 0, &out));
+    assert_int_equal(LY_SUCCESS, lyd_print_all(out, diff, LYD_LYB, LYD_PRINT_LYB_DIFF));
+    len_diff = ly_out_printed(out);
+    ly_out_free(out, NULL, 0);
+    assert_true(len_diff < len);
+    assert_int_equal(len_diff, lyd_lyb_data_length(lyb_diff));
+
+    /* the same diff is parsed */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_diff, LYD_LYB, LYD_PARSE_ONLY, 0, &diff2));
+    CHECK_LYD(diff, diff2);
+    lyd_free_all(diff2);
+
+    /* apply */
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory(lyb_diff, &in));
+    assert_int_equal(LY_SUCCESS, lyd_diff_apply_lyb(UTEST_LYCTX, in, &data1));
+    ly_in_free(in, 0);
+    CHECK_LYD(data1, data2);
+    free(lyb);
+    free(lyb_diff);
+    lyd_free_all(diff);
+
+    /* apply on empty data */
+    CHECK_PARSE_LYD_DIFF(NULL, data2, LYD_DIFF_META, diff);
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&lyb_diff, diff, LYD_LYB, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_LYB_DIFF));
+    assert_int_equal(LY_SUCCESS, ly_in_new_memory(lyb_diff, &in));
+    assert_int_equal(LY_SUCCESS, lyd_diff_apply_lyb(UTEST_LYCTX, in, &empty));
+    ly_in_free(in, 0);
+    CHECK_LYD(empty, data2);
+    free(lyb_diff);
+
+    lyd_free_all(diff);
+    lyd_free_all(empty);
+    lyd_free_all(data1);
+    lyd_free_all(data2);
+}
+
 int
 main(void)
 {
@@ -1389,6 +1520,7 @@ main(void)
         UTEST(test_nested_list, setup),
         UTEST(test_userord_llist, setup),
         UTEST(test_userord_llist2, setup),
+        UTEST(test_userord_llist_rotate, setup),
         UTEST(test_userord_mix, setup),
         UTEST(test_userord_list, setup),
         UTEST(test_userord_list2, setup),
@@ -1397,6 +1529,7 @@ main(void)
         UTEST(test_state_llist, setup),
         UTEST(test_wd, setup),
         UTEST(test_metadata, setup),
+        UTEST(test_lyb, setup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -14,6 +14,9 @@
 #define _UTEST_MAIN_
 #include "utests.h"
 
+#include <inttypes.h>
+#include <pthread.h>
+
 #include "hash_table.h"
 #include "libyang.h"
 
@@ -2524,6 +2527,185 @@ test_collisions(void **state)
     free(data_xml);
 }
 
+static void
+test_sibling_cache(void **state)
+{
+    const char *mod1, *mod2;
+
+    mod1 =
+            "module sib1 { namespace \"urn:test-sib1\"; prefix s1;"
+            "  container c {"
+            "    leaf a { type string; }"
+            "    leaf b { type string; }"
+            "  }"
+            "  leaf t { type string; }"
+            "}";
+    UTEST_ADD_MODULE(mod1, LYS_IN_YANG, NULL, NULL);
+
+    /* the cached sibling hashes are reused */
+    check_print_parse(state, "<c xmlns=\"urn:test-sib1\"><a>1</a><b>2</b></c><t xmlns=\"urn:test-sib1\">3</t>");
+    check_print_parse(state, "<c xmlns=\"urn:test-sib1\"><b>2</b></c><t xmlns=\"urn:test-sib1\">3</t>");
+
+    /* new siblings after the context change */
+    mod2 =
+            "module sib2 { namespace \"urn:test-sib2\"; prefix s2;"
+            "  import sib1 { prefix s1; }"
+            "  augment /s1:c {"
+            "    leaf a { type string; }"
+            "    leaf d { type string; }"
+            "  }"
+            "}";
+    UTEST_ADD_MODULE(mod2, LYS_IN_YANG, NULL, NULL);
+
+    check_print_parse(state, "<c xmlns=\"urn:test-sib1\"><a>1</a><b>2</b><a xmlns=\"urn:test-sib2\">4</a>"
+            "<d xmlns=\"urn:test-sib2\">5</d></c>");
+}
+
+#define LAZY_READER_COUNT 4
+
+/**
+ * @brief Reader of a lazily parsed tree finding nodes in subtrees that may be parsed concurrently.
+ */
+static void *
+lazy_reader_thread(void *arg)
+{
+    const struct lyd_node *tree = arg;
+    struct lyd_node *node;
+    char path[64];
+    uintptr_t fails = 0;
+    uint32_t i;
+
+    for (i = 1; i <= 2000; i += 97) {
+        sprintf(path, "/lazy:c/l[k='%" PRIu32 "']/m[n='2']/w", i);
+        if (lyd_find_path(tree, path, 0, &node) || (strlen(lyd_get_value(node)) != 60)) {
+            ++fails;
+        }
+    }
+
+    return (void *)fails;
+}
+
+static void
+test_lazy(void **state)
+{
+    const char *mod;
+    char *data_xml, *lyb_out, *ptr;
+    struct ly_out *out;
+    struct lyd_node *tree_1, *tree_2, *cont, *node, *elem;
+    pthread_t tids[LAZY_READER_COUNT];
+    void *fails;
+    uint32_t i;
+    size_t len;
+
+    mod =
+            "module lazy { namespace \"urn:test-lazy\"; prefix l;"
+            "  container c {"
+            "    list l { key k; leaf k { type uint32; } leaf v { type string; }"
+            "      list m { key n; leaf n { type uint32; } leaf w { type string; } }"
+            "    }"
+            "    leaf x { type string; }"
+            "  }"
+            "  leaf t { type string; }"
+            "}";
+    UTEST_ADD_MODULE(mod, LYS_IN_YANG, NULL, NULL);
+
+    /* enough data for many chunks */
+    data_xml = malloc(2000 * 300 + 200);
+    assert_non_null(data_xml);
+    ptr = data_xml + sprintf(data_xml, "<c xmlns=\"urn:test-lazy\">");
+    for (i = 1; i <= 2000; ++i) {
+        ptr += sprintf(ptr, "<l><k>%" PRIu32 "</k><v>value-%" PRIu32 "-%080d</v><m><n>1</n><w>a</w></m>"
+                "<m><n>2</n><w>%060d</w></m></l>", i, i, 0, 0);
+    }
+    sprintf(ptr, "<x>end</x></c><t xmlns=\"urn:test-lazy\">top</t>");
+    CHECK_PARSE_LYD(data_xml, tree_1);
+    free(data_xml);
+
+    assert_int_equal(LY_SUCCESS, ly_out_new_memory(&lyb_out, 0, &out));
+    assert_int_equal(LY_SUCCESS, lyd_print_all(out, tree_1, LYD_LYB, LYD_PRINT_LYB_INDEX));
+    len = ly_out_printed(out);
+    ly_out_free(out, NULL, 0);
+    assert_true(len > 2000 * 200);
+    assert_int_equal(len, lyd_lyb_data_length(lyb_out));
+
+    /* the data are still parsed normally */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_STRICT,
+            0, &tree_2));
+    CHECK_LYD(tree_1, tree_2);
+    lyd_free_all(tree_2);
+
+    /* only the top-level container is parsed */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_LYB_LAZY,
+            0, &tree_2));
+    cont = tree_2;
+    assert_string_equal(cont->schema->name, "c");
+    assert_true(cont->flags & LYD_LYB_STUB);
+    assert_null(((struct lyd_node_inner *)cont)->child);
+    assert_string_equal(lyd_get_value(cont->next), "top");
+
+    /* finding a node parses only the subtrees on its path */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/l[k='1500']/m[n='2']", 0, &node));
+    assert_false(cont->flags & LYD_LYB_STUB);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/x", 0, &elem));
+    assert_string_equal(lyd_get_value(elem), "end");
+    assert_true(node->flags & LYD_LYB_STUB);
+    assert_string_equal(lyd_get_value(lyd_child(node)), "2");
+    assert_false(lyd_parent(node)->flags & LYD_LYB_STUB);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/l[k='1']", 0, &elem));
+    assert_true(elem->flags & LYD_LYB_STUB);
+    assert_string_equal(lyd_get_value(lyd_child(elem)), "1");
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/l[k='1500']/m[n='2']/w", 0, &elem));
+    assert_false(node->flags & LYD_LYB_STUB);
+    assert_int_equal(60, strlen(lyd_get_value(elem)));
+
+    /* printing parses everything */
+    CHECK_LYD(tree_1, tree_2);
+    lyd_free_all(tree_2);
+
+    /* concurrent readers parsing the same subtrees */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_LYB_LAZY,
+            0, &tree_2));
+    for (i = 0; i < LAZY_READER_COUNT; ++i) {
+        assert_int_equal(0, pthread_create(&tids[i], NULL, lazy_reader_thread, tree_2));
+    }
+    for (i = 0; i < LAZY_READER_COUNT; ++i) {
+        assert_int_equal(0, pthread_join(tids[i], &fails));
+        assert_null(fails);
+    }
+    CHECK_LYD(tree_1, tree_2);
+    lyd_free_all(tree_2);
+
+    /* explicit parsing */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_LYB_LAZY,
+            0, &tree_2));
+    assert_int_equal(LY_SUCCESS, lyd_lyb_materialize(tree_2, 0));
+    assert_false(tree_2->flags & LYD_LYB_STUB);
+    assert_true(lyd_child(tree_2)->flags & LYD_LYB_STUB);
+    assert_int_equal(LY_SUCCESS, lyd_lyb_materialize(tree_2, 1));
+    LYD_TREE_DFS_BEGIN(tree_2, elem) {
+        assert_false(elem->flags & LYD_LYB_STUB);
+        LYD_TREE_DFS_END(tree_2, elem);
+    }
+    assert_int_equal(LY_SUCCESS, lyd_compare_siblings(tree_1, tree_2, LYD_COMPARE_FULL_RECURSION));
+    lyd_free_all(tree_2);
+
+    /* freeing unparsed subtrees */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_ONLY | LYD_PARSE_LYB_LAZY,
+            0, &tree_2));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/l[k='7']", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree_2, "/lazy:c/l[k='8']/v", 0, &node));
+    lyd_free_all(tree_2);
+
+    /* lazy parsing requires only parsing */
+    assert_int_equal(LY_EINVAL, lyd_parse_data_mem(UTEST_LYCTX, lyb_out, LYD_LYB, LYD_PARSE_LYB_LAZY, 0, &tree_2));
+    CHECK_LOG_CTX("Invalid argument !(parse_opts & 0x10000000) || ((parse_opts & 0x010000) && "
+            "(in->type == LY_IN_MEMORY)) (lyd_parse_lyb()).", NULL, 0);
+
+    free(lyb_out);
+    lyd_free_all(tree_1);
+}
+
 #if 0
 
 static void
@@ -2822,6 +3004,8 @@ main(void)
         UTEST(test_statements, setup),
         UTEST(test_opaq, setup),
         UTEST(test_collisions, setup),
+        UTEST(test_sibling_cache, setup),
+        UTEST(test_lazy, setup),
 #if 0
         cmocka_unit_test_setup_teardown(test_types, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_annotations, setup_f, teardown_f),
@@ -71,12 +71,115 @@ test_empty_container_wd_trim(void **state)
     lyd_free_all(tree);
 }
 
+static void
+test_member_names(void **state)
+{
+    struct lyd_node *tree;
+    char *schema = NULL, *data = NULL, *buffer = NULL;
+    uint32_t i;
+
+    /* enough schema nodes to collide in the member name cache */
+    assert_non_null(schema = strdup("module schema3 {namespace urn:tests:schema3;prefix s3;container c {"));
+    assert_non_null(data = strdup("{\"schema3:c\":{"));
+    for (i = 0; i < 600; ++i) {
+        assert_non_null(schema = realloc(schema, strlen(schema) + 64));
+        sprintf(schema + strlen(schema), "leaf l%" PRIu32 " {type uint32;}", i);
+        assert_non_null(data = realloc(data, strlen(data) + 64));
+        sprintf(data + strlen(data), "%s\"l%" PRIu32 "\":%" PRIu32, i ? "," : "", i, i);
+    }
+    strcat(schema, "}}");
+    strcat(data, "}}");
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+
+    /* only the top-level member name is qualified */
+    CHECK_PARSE_LYD_PARAM(data, LYD_JSON, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&buffer, tree, LYD_JSON, LYD_PRINT_SHRINK));
+    CHECK_STRING(buffer, data);
+    free(buffer);
+    lyd_free_all(tree);
+
+    free(schema);
+    free(data);
+}
+
+static void
+check_print_parallel(const struct lyd_node *tree, uint32_t options)
+{
+    char *seq = NULL, *par = NULL;
+
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&seq, tree, LYD_JSON, options));
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&par, tree, LYD_JSON, options | LYD_PRINT_PARALLEL));
+    assert_string_equal(seq, par);
+    free(seq);
+    free(par);
+}
+
+static void
+test_parallel(void **state)
+{
+    struct lyd_node *tree, *node;
+    char *data = NULL;
+    uint32_t i;
+    int len;
+    const char *schema = "module schema4 {namespace urn:tests:schema4;prefix p;"
+            "list l {key k; leaf k {type uint32;} leaf v {type string;}}"
+            "leaf-list ll {type uint32;}"
+            "container c {list l2 {key k; leaf k {type uint32;} container in {leaf x {type string; default \"d\";}}}}"
+            "leaf t {type string;}}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+
+    /* long runs of list instances in several top-level subtrees */
+    assert_non_null(data = strdup("{"));
+    for (i = 0; i < 1500; ++i) {
+        assert_non_null(data = realloc(data, strlen(data) + 64));
+        sprintf(data + strlen(data), "%s{\"k\":%" PRIu32 ",\"v\":\"<%" PRIu32 ">\"}", i ? "," : "\"schema4:l\":[", i, i);
+    }
+    assert_non_null(data = realloc(data, strlen(data) + 64));
+    strcat(data, "],\"schema4:ll\":[1,2,3],\"schema4:c\":{");
+    for (i = 0; i < 2100; ++i) {
+        assert_non_null(data = realloc(data, strlen(data) + 64));
+        sprintf(data + strlen(data), "%s{\"k\":%" PRIu32 "%s}", i ? "," : "\"l2\":[", i, (i % 7) ? "" : ",\"in\":{\"x\":\"&\"}");
+    }
+    strcat(data, "]},\"schema4:t\":\"end\",\"schema2:a\":{}}");
+    CHECK_PARSE_LYD_PARAM(data, LYD_JSON, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+
+    /* the output is the same as when printed sequentially */
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL_TAG);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_TRIM | LYD_PRINT_SHRINK);
+    check_print_parallel(tree, 0);
+
+    /* a single subtree */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/schema4:c", 0, &node));
+    check_print_parallel(node, 0);
+    check_print_parallel(node, LYD_PRINT_SHRINK | LYD_PRINT_WD_ALL);
+
+    lyd_free_all(tree);
+    free(data);
+
+    /* more tasks than may be in flight at once */
+    assert_non_null(data = malloc(64 * 40000));
+    len = sprintf(data, "{\"schema4:c\":{\"l2\":[");
+    for (i = 0; i < 40000; ++i) {
+        len += sprintf(data + len, "%s{\"k\":%" PRIu32 "}", i ? "," : "", i);
+    }
+    strcpy(data + len, "]}}");
+    CHECK_PARSE_LYD_PARAM(data, LYD_JSON, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    lyd_free_all(tree);
+    free(data);
+}
+
 int
 main(void)
 {
     const struct CMUnitTest tests[] = {
         UTEST(test_container_presence, setup),
         UTEST(test_empty_container_wd_trim, setup),
+        UTEST(test_member_names, setup),
+        UTEST(test_parallel, setup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -332,12 +332,70 @@ test_rpc(void **state)
 
 #endif
 
+static void
+check_print_parallel(const struct lyd_node *tree, uint32_t options)
+{
+    char *seq = NULL, *par = NULL;
+
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&seq, tree, LYD_XML, options));
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&par, tree, LYD_XML, options | LYD_PRINT_PARALLEL));
+    assert_string_equal(seq, par);
+    free(seq);
+    free(par);
+}
+
+static void
+test_parallel(void **state)
+{
+    struct lyd_node *tree, *node;
+    char *data = NULL;
+    uint32_t i;
+    const char *schema = "module par {namespace urn:tests:par;prefix p;"
+            "list l {key k; leaf k {type uint32;} leaf v {type string;}}"
+            "leaf-list ll {type uint32;}"
+            "container c {list l2 {key k; leaf k {type uint32;} container in {leaf x {type string; default \"d\";}}}}"
+            "leaf t {type string;}}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+
+    /* long runs of list instances in several top-level subtrees */
+    assert_non_null(data = strdup("{"));
+    for (i = 0; i < 1500; ++i) {
+        assert_non_null(data = realloc(data, strlen(data) + 64));
+        sprintf(data + strlen(data), "%s{\"k\":%" PRIu32 ",\"v\":\"<%" PRIu32 ">\"}", i ? "," : "\"par:l\":[", i, i);
+    }
+    assert_non_null(data = realloc(data, strlen(data) + 64));
+    strcat(data, "],\"par:ll\":[1,2,3],\"par:c\":{");
+    for (i = 0; i < 2100; ++i) {
+        assert_non_null(data = realloc(data, strlen(data) + 64));
+        sprintf(data + strlen(data), "%s{\"k\":%" PRIu32 "%s}", i ? "," : "\"l2\":[", i, (i % 7) ? "" : ",\"in\":{\"x\":\"&\"}");
+    }
+    strcat(data, "]},\"par:t\":\"end\",\"types:cont\":{\"leaftarget\":[null]}}");
+    CHECK_PARSE_LYD_PARAM(data, LYD_JSON, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+
+    /* the output is the same as when printed sequentially */
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL_TAG);
+    check_print_parallel(tree, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_TRIM | LYD_PRINT_SHRINK);
+    check_print_parallel(tree, 0);
+
+    /* a single subtree */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/par:c", 0, &node));
+    check_print_parallel(node, 0);
+    check_print_parallel(node, LYD_PRINT_SHRINK | LYD_PRINT_WD_ALL);
+
+    lyd_free_all(tree);
+    free(data);
+}
+
 int
 main(void)
 {
     const struct CMUnitTest tests[] = {
         UTEST(test_anydata, setup),
         UTEST(test_defaults, setup),
+        UTEST(test_parallel, setup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -14,6 +14,8 @@
 #define _UTEST_MAIN_
 #include "utests.h"
 
+#include <pthread.h>
+
 #include "libyang.h"
 #include "ly_common.h"
 #include "path.h"
@@ -457,6 +459,77 @@ test_list_pos(void **state)
     lyd_free_all(tree);
 }
 
+static void
+test_list_pos_many(void **state)
+{
+    struct lyd_node *tree, *node;
+    struct lys_module *mod;
+    char value[8];
+    uint32_t i;
+    const char *schema =
+            "module list-pos {"
+            "  namespace \"urn:tests:list-pos\";"
+            "  prefix lp;"
+            "  container c {"
+            "    leaf-list x {type string;}"
+            "    leaf-list y {type string; ordered-by user;}"
+            "  }"
+            "}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, &mod);
+
+    /* many instances */
+    assert_int_equal(LY_SUCCESS, lyd_new_inner(NULL, mod, "c", 0, &tree));
+    for (i = 0; i < 100; ++i) {
+        sprintf(value, "v%03" PRIu32, i);
+        assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "x", value, 0, NULL));
+    }
+    i = 0;
+    LY_LIST_FOR(lyd_child(tree), node) {
+        assert_int_equal(++i, lyd_list_pos(node));
+    }
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "x", "v050a", 0, &node));
+    assert_int_equal(52, lyd_list_pos(node));
+    assert_int_equal(53, lyd_list_pos(node->next));
+    lyd_free_tree(lyd_child(tree)->prev);
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "x", "v100", 0, &node));
+    assert_int_equal(101, lyd_list_pos(node));
+    assert_int_equal(100, lyd_list_pos(node->prev));
+    assert_int_equal(1, lyd_list_pos(lyd_child(tree)));
+    lyd_free_all(tree);
+
+    /* user-ordered instances changed anywhere */
+    assert_int_equal(LY_SUCCESS, lyd_new_inner(NULL, mod, "c", 0, &tree));
+    for (i = 0; i < 70; ++i) {
+        sprintf(value, "v%03" PRIu32, i);
+        assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "y", value, 0, NULL));
+    }
+    assert_int_equal(70, lyd_list_pos(lyd_child(tree)->prev));
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "y", "first", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_insert_before(lyd_child(tree), node));
+    assert_int_equal(1, lyd_list_pos(node));
+    assert_int_equal(2, lyd_list_pos(node->next));
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "y", "mid", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_insert_after(lyd_child(tree)->next->next, node));
+    assert_int_equal(4, lyd_list_pos(node));
+    assert_int_equal(72, lyd_list_pos(lyd_child(tree)->prev));
+    lyd_free_tree(lyd_child(tree)->next);
+    assert_int_equal(3, lyd_list_pos(node));
+    assert_int_equal(71, lyd_list_pos(lyd_child(tree)->prev));
+    i = 0;
+    LY_LIST_FOR(lyd_child(tree), node) {
+        assert_int_equal(++i, lyd_list_pos(node));
+    }
+
+    /* all freed from the end and created again */
+    while (lyd_child(tree)) {
+        lyd_free_tree(lyd_child(tree)->prev);
+    }
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "y", "v000", 0, &node));
+    assert_int_equal(1, lyd_list_pos(node));
+    lyd_free_all(tree);
+}
+
 static void
 test_first_sibling(void **state)
 {
@@ -801,6 +874,269 @@ test_data_leafref_nodes2(void **state)
     lyd_free_all(tree);
 }
 
+#define CONCURRENT_READER_COUNT 8
+#define CONCURRENT_LIST_COUNT 32
+
+struct concurrent_reader {
+    pthread_t tid;
+    const struct lyd_node *tree;
+    const char *json;
+    uint32_t fails;
+};
+
+static void *
+concurrent_reader_thread(void *arg)
+{
+    struct concurrent_reader *reader = arg;
+    const struct lyd_node *elem;
+    struct ly_set *set;
+    char xpath[64], addr[16], *json;
+    uint32_t i, j;
+
+    for (i = 0; i < 20; ++i) {
+        /* values, some generated on demand */
+        LYD_TREE_DFS_BEGIN(reader->tree, elem) {
+            if ((elem->schema->nodetype & LYD_NODE_TERM) && !lyd_get_value(elem)) {
+                ++reader->fails;
+            }
+            LYD_TREE_DFS_END(reader->tree, elem);
+        }
+
+        /* XPath, using the secondary index */
+        for (j = 0; j < CONCURRENT_LIST_COUNT; ++j) {
+            sprintf(addr, "10.0.0.%" PRIu32, j);
+            sprintf(xpath, "/t:c/l[addr='%s']/name", addr);
+            if (lyd_find_xpath(reader->tree, xpath, &set) || (set->count != 1) ||
+                    (strtoul(lyd_get_value(set->dnodes[0]), NULL, 10) != j)) {
+                ++reader->fails;
+            }
+            ly_set_free(set, NULL);
+        }
+
+        /* printing */
+        if (lyd_print_mem(&json, reader->tree, LYD_JSON, LYD_PRINT_WITHSIBLINGS) || strcmp(json, reader->json)) {
+            ++reader->fails;
+        }
+        free(json);
+    }
+
+    return NULL;
+}
+
+static void
+test_concurrent_read(void **state)
+{
+    const char *schema = "module t {namespace urn:tests:t;prefix t;yang-version 1.1;"
+            "import ietf-inet-types {prefix inet;}"
+            "container c {list l {key name; leaf name {type uint32;} leaf addr {type inet:ipv4-address;}"
+            "leaf pref {type inet:ipv6-prefix;} leaf bin {type binary;}}}}";
+    struct lyd_node *tree, *lyb_tree;
+    struct concurrent_reader readers[CONCURRENT_READER_COUNT] = {0};
+    struct ly_set *set;
+    char xpath[64], value[32], *lyb, *json;
+    uint32_t i;
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_index_add(lys_find_path(UTEST_LYCTX, NULL, "/t:c/l/addr", 0)));
+
+    assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, UTEST_LYCTX, "/t:c", NULL, 0, &tree));
+    for (i = 0; i < CONCURRENT_LIST_COUNT; ++i) {
+        sprintf(xpath, "/t:c/l[name='%" PRIu32 "']/addr", i);
+        sprintf(value, "10.0.0.%" PRIu32, i);
+        assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, xpath, value, 0, NULL));
+        sprintf(xpath, "/t:c/l[name='%" PRIu32 "']/pref", i);
+        sprintf(value, "2001:db8:%" PRIx32 "::/48", i);
+        assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, xpath, value, 0, NULL));
+        sprintf(xpath, "/t:c/l[name='%" PRIu32 "']/bin", i);
+        assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, xpath, "AAEC", 0, NULL));
+    }
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&json, tree, LYD_JSON, LYD_PRINT_WITHSIBLINGS));
+
+    /* values parsed from LYB have their canonical values generated only when first needed */
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&lyb, tree, LYD_LYB, LYD_PRINT_WITHSIBLINGS));
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, lyb, LYD_LYB, LYD_PARSE_STRICT | LYD_PARSE_ONLY, 0,
+            &lyb_tree));
+    free(lyb);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(lyb_tree, "/t:c/l[name='0']/addr", &set));
+    assert_int_equal(1, set->count);
+    assert_null(((struct lyd_node_term *)set->dnodes[0])->value._canonical);
+    ly_set_free(set, NULL);
+
+    /* concurrent readers of a single tree */
+    for (i = 0; i < CONCURRENT_READER_COUNT; ++i) {
+        readers[i].tree = lyb_tree;
+        readers[i].json = json;
+        assert_int_equal(0, pthread_create(&readers[i].tid, NULL, concurrent_reader_thread, &readers[i]));
+    }
+    for (i = 0; i < CONCURRENT_READER_COUNT; ++i) {
+        assert_int_equal(0, pthread_join(readers[i].tid, NULL));
+        assert_int_equal(0, readers[i].fails);
+    }
+
+    free(json);
+    lyd_free_all(tree);
+    lyd_free_all(lyb_tree);
+}
+
+static void
+test_freeze(void **state)
+{
+    struct lyd_node *tree, *frozen, *thawed, *node;
+    struct ly_set *set;
+    char *str1, *str2;
+    const char *data;
+
+    data = "<l1 xmlns=\"urn:tests:a\"><a>a</a><b>b</b><c>x</c></l1>"
+            "<l1 xmlns=\"urn:tests:a\"><a>a</a><b>c</b></l1>"
+            "<foo xmlns=\"urn:tests:a\">text</foo>"
+            "<ll xmlns=\"urn:tests:a\">1</ll><ll xmlns=\"urn:tests:a\">2</ll>"
+            "<c xmlns=\"urn:tests:a\"><x>y</x><x>z</x><x>0</x><x>1</x><x>2</x><x>3</x></c>";
+    CHECK_PARSE_LYD(data, 0, LYD_VALIDATE_PRESENT, tree);
+    assert_int_equal(LY_SUCCESS, lyd_freeze(tree, &frozen));
+
+    /* the frozen tree reads the same as the original */
+    LY_LIST_FOR(frozen, node) {
+        assert_true(node->flags & LYD_FROZEN);
+    }
+    assert_int_equal(LY_SUCCESS, lyd_compare_siblings(tree, frozen, LYD_COMPARE_FULL_RECURSION));
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&str1, tree, LYD_XML, LYD_PRINT_WITHSIBLINGS));
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&str2, frozen, LYD_XML, LYD_PRINT_WITHSIBLINGS));
+    assert_string_equal(str1, str2);
+    free(str1);
+    free(str2);
+
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(frozen, "/a:c/x", &set));
+    assert_int_equal(6, set->count);
+    assert_string_equal("z", lyd_get_value(set->dnodes[5]));
+    ly_set_free(set, NULL);
+
+    /* hash table in the frozen memory block */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(frozen, "/a:c", 0, &node));
+    assert_non_null(((struct lyd_node_inner *)node)->children_ht);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(frozen, "/a:c/x[.='2']", 0, &node));
+    assert_string_equal("2", lyd_get_value(node));
+    assert_int_equal(LY_SUCCESS, lyd_find_sibling_val(lyd_first_sibling(node), node->schema, "z", 0, &node));
+    assert_string_equal("z", lyd_get_value(node));
+    assert_int_equal(LY_ENOTFOUND, lyd_find_sibling_val(lyd_first_sibling(node), node->schema, "4", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(frozen, "/a:l1[a='a'][b='c']", 0, &node));
+    assert_true(node->flags & LYD_FROZEN);
+
+    /* no modifications are allowed */
+    assert_int_equal(LY_EINVAL, lyd_change_term(node->next, "x"));
+    CHECK_LOG_CTX("Data node \"foo\" is frozen and cannot be modified.", NULL, 0);
+    assert_int_equal(LY_EINVAL, lyd_new_term(node, NULL, "c", "val", 0, NULL));
+    CHECK_LOG_CTX("Data node \"l1\" is frozen and cannot be modified.", NULL, 0);
+    assert_int_equal(LY_EINVAL, lyd_unlink_tree(node));
+    CHECK_LOG_CTX("Data node \"l1\" is frozen and cannot be modified.", NULL, 0);
+    lyd_free_tree(node->next);
+    CHECK_LOG_CTX("Data node \"foo\" is frozen and cannot be modified.", NULL, 0);
+
+    /* thawed copy is a regular tree again */
+    assert_int_equal(LY_SUCCESS, lyd_thaw(node, &thawed));
+    assert_false(thawed->flags & LYD_FROZEN);
+    assert_int_equal(LY_SUCCESS, lyd_compare_siblings(tree, thawed, LYD_COMPARE_FULL_RECURSION));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(thawed, "/a:l1[a='a'][b='c']", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_new_term(node, NULL, "c", "val", 0, NULL));
+
+    lyd_free_all(tree);
+    lyd_free_all(frozen);
+    lyd_free_all(thawed);
+}
+
+static void
+test_image(void **state)
+{
+    struct lyd_node *tree, *node;
+    const struct lyd_image_node *first, *inode;
+    struct ly_ctx *ctx2;
+    void *image, *copy;
+    size_t size;
+    const char *data;
+    char path[16];
+    uint32_t i;
+
+    data = "<l1 xmlns=\"urn:tests:a\"><a>a</a><b>b</b><c>x</c></l1>"
+            "<l1 xmlns=\"urn:tests:a\"><a>a</a><b>c</b></l1>"
+            "<foo xmlns=\"urn:tests:a\">text</foo>"
+            "<ll xmlns=\"urn:tests:a\">1</ll><ll xmlns=\"urn:tests:a\">2</ll>"
+            "<c xmlns=\"urn:tests:a\"><x>y</x><x>z</x></c>"
+            "<any xmlns=\"urn:tests:a\"><val>1</val></any>"
+            "<l2 xmlns=\"urn:tests:a\"><c><x>first</x></c></l2><l2 xmlns=\"urn:tests:a\"><c><x>second</x></c></l2>";
+    CHECK_PARSE_LYD(data, 0, LYD_VALIDATE_PRESENT, tree);
+    assert_int_equal(LY_SUCCESS, lyd_image_create(tree, &image, &size));
+
+    /* the image is read from a different memory */
+    copy = malloc(size);
+    memcpy(copy, image, size);
+    memset(image, 0, size);
+    free(image);
+
+    /* iterate */
+    assert_int_equal(LY_SUCCESS, lyd_image_first(UTEST_LYCTX, copy, &first));
+    inode = first;
+    LY_LIST_FOR(tree, node) {
+        assert_non_null(inode);
+        assert_string_equal(LYD_NAME(node), lyd_image_name(inode));
+        assert_string_equal(node->schema->module->name, lyd_image_module(inode));
+        assert_ptr_equal(node->schema, lyd_image_schema(UTEST_LYCTX, inode));
+        assert_null(lyd_image_parent(inode));
+        inode = lyd_image_next(inode);
+    }
+    assert_null(inode);
+    inode = lyd_image_child(first);
+    assert_string_equal("a", lyd_image_name(inode));
+    assert_ptr_equal(first, lyd_image_parent(inode));
+    assert_null(lyd_image_child(inode));
+
+    /* find */
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l1[a='a'][b='b']/c", &inode));
+    assert_string_equal("x", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:l1[a='a'][b='b']/c", 0, &node));
+    assert_ptr_equal(node->schema, lyd_image_schema(UTEST_LYCTX, inode));
+    assert_int_equal(LY_ENOTFOUND, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l1[a='a'][b='c']/c", NULL));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l1[a='a'][b='c']", &inode));
+    assert_string_equal("c", lyd_image_value(lyd_image_next(lyd_image_child(inode))));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:foo", &inode));
+    assert_string_equal("text", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:ll[.='2']", &inode));
+    assert_string_equal("2", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:c/x[.='z']", &inode));
+    assert_string_equal("z", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l2[2]/c/x", &inode));
+    assert_string_equal("second", lyd_image_value(inode));
+    assert_int_equal(LY_ENOTFOUND, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l2[3]", NULL));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:any", &inode));
+    assert_non_null(lyd_image_value(inode));
+    assert_int_equal(LY_ENOTFOUND, lyd_image_find_path(UTEST_LYCTX, copy, "/a:bar", NULL));
+    free(copy);
+
+    /* indexed siblings */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/a:c", 0, &node));
+    for (i = 0; i < 40; ++i) {
+        sprintf(path, "v%" PRIu32, i);
+        assert_int_equal(LY_SUCCESS, lyd_new_term(node, NULL, "x", path, 0, NULL));
+    }
+    assert_int_equal(LY_SUCCESS, lyd_image_create(tree, &copy, &size));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:c/x[.='v31']", &inode));
+    assert_string_equal("v31", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:c/x[.='y']", &inode));
+    assert_string_equal("y", lyd_image_value(inode));
+    assert_int_equal(LY_ENOTFOUND, lyd_image_find_path(UTEST_LYCTX, copy, "/a:c/x[.='v40']", NULL));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l2[1]/c/x", &inode));
+    assert_string_equal("first", lyd_image_value(inode));
+    assert_int_equal(LY_SUCCESS, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l2[2]/c/x", &inode));
+    assert_string_equal("second", lyd_image_value(inode));
+    assert_int_equal(LY_ENOTFOUND, lyd_image_find_path(UTEST_LYCTX, copy, "/a:l2[3]", NULL));
+
+    /* a different context */
+    assert_int_equal(LY_SUCCESS, ly_ctx_new(NULL, 0, &ctx2));
+    assert_int_equal(LY_EINVAL, lyd_image_first(ctx2, copy, &first));
+    ly_ctx_destroy(ctx2);
+
+    free(copy);
+    lyd_free_all(tree);
+}
+
 int
 main(void)
 {
@@ -810,12 +1146,16 @@ main(void)
         UTEST(test_dup, setup),
         UTEST(test_target, setup),
         UTEST(test_list_pos, setup),
+        UTEST(test_list_pos_many),
         UTEST(test_first_sibling, setup),
         UTEST(test_find_path, setup),
         UTEST(test_data_hash, setup),
         UTEST(test_lyxp_vars),
         UTEST(test_data_leafref_nodes),
         UTEST(test_data_leafref_nodes2),
+        UTEST(test_concurrent_read, setup),
+        UTEST(test_freeze, setup),
+        UTEST(test_image, setup),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -1254,6 +1254,65 @@ test_manipulation_of_many_nodes(void **state)
     lyd_free_all(cont);
 }
 
+static void
+check_ll_sequence(struct lyd_node *first, uint32_t start, uint32_t step, uint32_t count)
+{
+    struct lyd_node *iter;
+    uint32_t i = 0;
+
+    LY_LIST_FOR(first, iter) {
+        assert_int_equal(((struct lyd_node_term *)iter)->value.uint32, start + i * step);
+        i++;
+    }
+    assert_int_equal(i, count);
+}
+
+static void
+test_many_chunks(void **state)
+{
+    const char *schema;
+    struct lys_module *mod;
+    struct lyd_node *cont, *node, *part, *next;
+    char buf[16];
+    uint32_t i;
+
+    schema = "module a {namespace urn:tests:a;prefix a;yang-version 1.1;revision 2014-05-08;"
+            "container cn { leaf-list ll {type uint32;}}}";
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, &mod);
+
+    /* insert enough nodes in a scattered order to fill and split many chunks */
+    assert_int_equal(lyd_new_inner(NULL, mod, "cn", 0, &cont), LY_SUCCESS);
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%" PRIu32, (i * 7919) % 1000);
+        assert_int_equal(lyd_new_term(cont, mod, "ll", buf, 0, NULL), LY_SUCCESS);
+    }
+    check_ll_sequence(lyd_child(cont), 0, 1, 1000);
+
+    /* split the leaf-list in the middle */
+    assert_int_equal(lyd_find_sibling_val(lyd_child(cont), lyd_child(cont)->schema, "500", 0, &part), LY_SUCCESS);
+    assert_int_equal(lyd_unlink_siblings(part), LY_SUCCESS);
+    check_ll_sequence(lyd_child(cont), 0, 1, 500);
+    check_ll_sequence(part, 500, 1, 500);
+
+    /* merge it back */
+    assert_int_equal(lyd_insert_child(cont, part), LY_SUCCESS);
+    check_ll_sequence(lyd_child(cont), 0, 1, 1000);
+
+    /* remove every odd node, then insert them again */
+    for (node = lyd_child(cont); node; node = next) {
+        next = node->next ? node->next->next : NULL;
+        lyd_free_tree(node->next);
+    }
+    check_ll_sequence(lyd_child(cont), 0, 2, 500);
+    for (i = 999; i < 1000; i -= 2) {
+        sprintf(buf, "%" PRIu32, i);
+        assert_int_equal(lyd_new_term(cont, mod, "ll", buf, 0, NULL), LY_SUCCESS);
+    }
+    check_ll_sequence(lyd_child(cont), 0, 1, 1000);
+
+    lyd_free_all(cont);
+}
+
 static void
 test_lyds_free_metadata(void **state)
 {
@@ -1679,6 +1738,7 @@ main(void)
         UTEST(test_parse_ordered_data),
         UTEST(test_print_data),
         UTEST(test_manipulation_of_many_nodes),
+        UTEST(test_many_chunks),
         UTEST(test_lyds_free_metadata),
         UTEST(test_move_whole_list),
         UTEST(test_move_part_list),
@@ -14,6 +14,7 @@
 #define _UTEST_MAIN_
 #include "utests.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -72,6 +73,99 @@ test_when(void **state)
     lyd_free_all(tree);
 }
 
+static void
+test_when_cache(void **state)
+{
+    struct lyd_node *tree, *tree2, *node;
+    const char *schema =
+            "module wc {\n"
+            "    namespace urn:tests:wc;\n"
+            "    prefix wc;\n"
+            "    yang-version 1.1;\n"
+            "\n"
+            "    leaf mode {\n"
+            "        type string;\n"
+            "    }\n"
+            "    container top {\n"
+            "        leaf type {\n"
+            "            type string;\n"
+            "        }\n"
+            "        leaf other {\n"
+            "            type string;\n"
+            "        }\n"
+            "        list l {\n"
+            "            key \"k\";\n"
+            "            leaf k {\n"
+            "                type string;\n"
+            "            }\n"
+            "            container c {\n"
+            "                when \"../../type = 'a'\";\n"
+            "                leaf x {\n"
+            "                    type string;\n"
+            "                }\n"
+            "            }\n"
+            "        }\n"
+            "        container opt {\n"
+            "            when \"/wc:mode = 'on'\";\n"
+            "            leaf y {\n"
+            "                type string;\n"
+            "            }\n"
+            "        }\n"
+            "    }\n"
+            "}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+    assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_WHEN_CACHE));
+
+    LYD_TREE_CREATE("<mode xmlns=\"urn:tests:wc\">on</mode><top xmlns=\"urn:tests:wc\"><type>a</type>"
+            "<l><k>1</k><c><x>1</x></c></l><l><k>2</k><c><x>2</x></c></l><opt><y>y</y></opt></top>", tree);
+
+    /* unrelated changes, the cached results are used */
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/wc:top/other", "o", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/wc:top/l[k='3']", NULL, 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/wc:top/l[k='1']/c", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/wc:top/opt", 0, NULL));
+
+    /* changed dependency, the nodes are auto-deleted */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/wc:top/type", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "b"));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_EINCOMPLETE, lyd_find_path(tree, "/wc:top/l[k='1']/c", 0, NULL));
+    assert_int_equal(LY_EINCOMPLETE, lyd_find_path(tree, "/wc:top/l[k='2']/c", 0, NULL));
+
+    /* new node with a false condition */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/wc:top/l[k='1']/c/x", "1", 0, NULL));
+    assert_int_equal(LY_EVALID, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    CHECK_LOG_CTX("When condition \"../../type = 'a'\" not satisfied.", "/wc:top/l[k='1']/c", 0);
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "a"));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* removed top-level dependency */
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_string_equal(LYD_NAME(tree), "mode");
+    node = tree;
+    tree = tree->next;
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_EINCOMPLETE, lyd_find_path(tree, "/wc:top/opt", 0, NULL));
+
+    /* node with a cached result moved into another tree */
+    LYD_TREE_CREATE("<top xmlns=\"urn:tests:wc\"><type>b</type></top>", tree2);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/wc:top/l[k='1']", 0, &node));
+    assert_true(lyd_child(node)->next->flags & LYD_WHEN_TRUE);
+    lyd_unlink_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_insert_child(tree2, node));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree2, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree2, "/wc:top/l[k='1']", 0, &node));
+    assert_null(lyd_child(node)->next);
+
+    lyd_free_all(tree);
+    lyd_free_all(tree2);
+    assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(UTEST_LYCTX, LY_CTX_WHEN_CACHE));
+}
+
 static void
 test_mandatory_when(void **state)
 {
@@ -696,6 +790,92 @@ test_unique_nested(void **state)
             "/d:lt2[k='val3']", 0, "data-not-unique");
 }
 
+static void
+test_list_constraints(void **state)
+{
+    struct lyd_node *tree, *node;
+    char path[64], val[16];
+    uint32_t i;
+    const char *schema =
+            "module cons {\n"
+            "    namespace urn:tests:cons;\n"
+            "    prefix c;\n"
+            "    yang-version 1.1;\n"
+            "\n"
+            "    container top {\n"
+            "        list l {\n"
+            "            key \"k\";\n"
+            "            unique \"c/u\";\n"
+            "            leaf k {\n"
+            "                type string;\n"
+            "            }\n"
+            "            container c {\n"
+            "                leaf u {\n"
+            "                    type uint32;\n"
+            "                }\n"
+            "            }\n"
+            "        }\n"
+            "        leaf-list ll {\n"
+            "            type uint32;\n"
+            "            min-elements 1;\n"
+            "            max-elements 3;\n"
+            "        }\n"
+            "    }\n"
+            "}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+    assert_int_equal(LY_SUCCESS, ly_ctx_set_options(UTEST_LYCTX, LY_CTX_LIST_CONSTRAINTS));
+
+    assert_int_equal(LY_SUCCESS, lyd_new_path(NULL, UTEST_LYCTX, "/cons:top/ll", "1", 0, &tree));
+    for (i = 0; i < 20; ++i) {
+        sprintf(path, "/cons:top/l[k='e%" PRIu32 "']/c/u", i);
+        sprintf(val, "%" PRIu32, i);
+        assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, path, val, 0, NULL));
+    }
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* changed unique value */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "l[k='e5']/c/u", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "7"));
+    assert_int_equal(LY_EVALID, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    CHECK_LOG_CTX_APPTAG("Unique data leaf(s) \"c/u\" not satisfied in \"/cons:top/l[k='e7']\" and "
+            "\"/cons:top/l[k='e5']\".", "/cons:top/l[k='e5']", 0, "data-not-unique");
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "5"));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* removed unique value */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "l[k='e7']/c", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "l[k='e9']/c/u", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "7"));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* added and removed list instances */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/cons:top/l[k='e20']/c/u", "8", 0, NULL));
+    assert_int_equal(LY_EVALID, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    CHECK_LOG_CTX_APPTAG("Unique data leaf(s) \"c/u\" not satisfied in \"/cons:top/l[k='e8']\" and "
+            "\"/cons:top/l[k='e20']\".", "/cons:top/l[k='e20']", 0, "data-not-unique");
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "l[k='e8']", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* leaf-list instances */
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/cons:top/ll", "2", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/cons:top/ll", "3", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/cons:top/ll", "4", 0, NULL));
+    assert_int_equal(LY_EVALID, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    CHECK_LOG_CTX_APPTAG("Too many \"ll\" instances.", "/cons:top/ll[.='4']", 0, "too-many-elements");
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "ll[.='1']", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+
+    /* the states are freed with the option */
+    assert_int_equal(LY_SUCCESS, ly_ctx_unset_options(UTEST_LYCTX, LY_CTX_LIST_CONSTRAINTS));
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    lyd_free_all(tree);
+}
+
 static void
 test_dup(void **state)
 {
@@ -1094,6 +1274,187 @@ test_defaults(void **state)
     lyd_free_all(tree);
 }
 
+static void
+test_defaults_virtual(void **state)
+{
+    struct ly_ctx *ctx;
+    struct lyd_node *tree, *tree2, *node, *vnode, *diff;
+    struct ly_set *set;
+    char *str;
+    const char *schema =
+            "module dv {\n"
+            "    namespace urn:tests:dv;\n"
+            "    prefix dv;\n"
+            "    yang-version 1.1;\n"
+            "\n"
+            "    container cont {\n"
+            "        leaf a {\n"
+            "            type string;\n"
+            "            default \"dflt-a\";\n"
+            "        }\n"
+            "        leaf b {\n"
+            "            type uint8;\n"
+            "            default \"5\";\n"
+            "        }\n"
+            "        leaf c {\n"
+            "            type string;\n"
+            "        }\n"
+            "        leaf-list ll {\n"
+            "            type string;\n"
+            "            default \"dflt-ll\";\n"
+            "        }\n"
+            "        leaf chk {\n"
+            "            type string;\n"
+            "            must \"../b = 5\";\n"
+            "        }\n"
+            "    }\n"
+            "}";
+
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+
+    /* the default leaves are not created */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, "<cont xmlns=\"urn:tests:dv\"><c>x</c><chk>y</chk></cont>",
+            LYD_XML, 0, LYD_VALIDATE_PRESENT | LYD_VALIDATE_VIRTUAL_DEFAULTS, &tree));
+    assert_true(tree->flags & LYD_DFLT_VIRTUAL);
+    assert_string_equal(LYD_NAME(lyd_child(tree)), "c");
+    assert_string_equal(LYD_NAME(lyd_child(tree)->next), "ll");
+    assert_string_equal(LYD_NAME(lyd_child(tree)->next->next), "chk");
+    assert_null(lyd_child(tree)->next->next->next);
+
+    /* but found */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/a", 0, &node));
+    assert_true(node->flags & LYD_DEFAULT);
+    assert_ptr_equal(lyd_parent(node), tree);
+    assert_string_equal(lyd_get_value(node), "dflt-a");
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/dv:cont/b[. = 5]", &set));
+    assert_int_equal(1, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/dv:cont/c | /dv:cont/b | /dv:cont/a", &set));
+    assert_int_equal(3, set->count);
+    assert_string_equal(LYD_NAME(set->dnodes[0]), "a");
+    assert_string_equal(LYD_NAME(set->dnodes[1]), "b");
+    assert_string_equal(LYD_NAME(set->dnodes[2]), "c");
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//dv:b", &set));
+    assert_int_equal(1, set->count);
+    assert_true(set->dnodes[0]->flags & LYD_DFLT_VIRTUAL);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/dv:cont/descendant::dv:a", &set));
+    assert_int_equal(1, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/dv:cont/*", &set));
+    assert_int_equal(5, set->count);
+    assert_string_equal(LYD_NAME(set->dnodes[0]), "a");
+    assert_string_equal(LYD_NAME(set->dnodes[1]), "b");
+    assert_string_equal(LYD_NAME(set->dnodes[2]), "c");
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/dv:cont/node()", &set));
+    assert_int_equal(5, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//*", &set));
+    assert_int_equal(6, set->count);
+    assert_string_equal(LYD_NAME(set->dnodes[0]), "cont");
+    assert_string_equal(LYD_NAME(set->dnodes[1]), "a");
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_sibling_val(lyd_child(tree), lysc_node_child(tree->schema), NULL, 0, &node));
+    assert_true(node->flags & LYD_DFLT_VIRTUAL);
+    assert_string_equal(lyd_get_value(node), "dflt-a");
+
+    /* and printed */
+    CHECK_LYD_STRING_PARAM(tree, "<cont xmlns=\"urn:tests:dv\"><c>x</c><chk>y</chk></cont>", LYD_XML,
+            LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_EXPLICIT | LYD_PRINT_SHRINK);
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&str, tree, LYD_JSON, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL |
+            LYD_PRINT_SHRINK));
+    assert_string_equal(str, "{\"dv:cont\":{\"c\":\"x\",\"ll\":[\"dflt-ll\"],\"chk\":\"y\",\"a\":\"dflt-a\",\"b\":5}}");
+    free(str);
+
+    /* diff against a materialized tree */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(UTEST_LYCTX, "<cont xmlns=\"urn:tests:dv\"><c>x</c><chk>y</chk>"
+            "<a>new-a</a></cont>", LYD_XML, 0, LYD_VALIDATE_PRESENT, &tree2));
+    assert_int_equal(LY_SUCCESS, lyd_diff_siblings(tree, tree2, LYD_DIFF_DEFAULTS, &diff));
+    assert_non_null(diff);
+    assert_int_equal(LY_SUCCESS, lyd_print_mem(&str, diff, LYD_XML, LYD_PRINT_WITHSIBLINGS | LYD_PRINT_SHRINK));
+    assert_string_equal(str, "<cont xmlns=\"urn:tests:dv\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:operation=\"none\">"
+            "<a yang:operation=\"replace\" yang:orig-default=\"true\" yang:orig-value=\"dflt-a\">new-a</a></cont>");
+    free(str);
+    lyd_free_siblings(diff);
+    assert_int_equal(LY_SUCCESS, lyd_diff_siblings(tree2, tree, LYD_DIFF_DEFAULTS, &diff));
+    assert_non_null(diff);
+    lyd_free_siblings(diff);
+
+    /* changed value materializes the leaf */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/b", 0, &node));
+    assert_int_equal(LY_SUCCESS, lyd_change_term(node, "6"));
+    assert_false(node->flags & (LYD_DEFAULT | LYD_DFLT_VIRTUAL));
+    assert_int_equal(LY_SUCCESS, lyd_find_sibling_val(lyd_child(tree), node->schema, NULL, 0, &node));
+    assert_string_equal(lyd_get_value(node), "6");
+    assert_int_equal(LY_EVALID, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT | LYD_VALIDATE_VIRTUAL_DEFAULTS, NULL));
+    CHECK_LOG_CTX("Must condition \"../b = 5\" not satisfied.", "/dv:cont/chk", 0);
+
+    /* created leaf replaces the virtual one, which remains valid */
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/a", 0, &vnode));
+    assert_int_equal(LY_SUCCESS, lyd_new_path(tree, NULL, "/dv:cont/a", "x", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/a", 0, &node));
+    assert_false(node->flags & LYD_DFLT_VIRTUAL);
+    assert_string_equal(lyd_get_value(node), "x");
+    assert_string_equal(lyd_get_value(vnode), "dflt-a");
+
+    /* the replaced virtual leaf cannot be changed */
+    assert_int_equal(LY_EINVAL, lyd_change_term(vnode, "y"));
+    CHECK_LOG_CTX("Virtual default leaf \"a\" was replaced by a real instance.", NULL, 0);
+    assert_true(vnode->flags & LYD_DFLT_VIRTUAL);
+    assert_string_equal(lyd_get_value(vnode), "dflt-a");
+
+    /* regular validation adds them */
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/a", 0, &node));
+    assert_true(node->flags & LYD_DFLT_VIRTUAL);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/b", 0, &node));
+    lyd_free_tree(node);
+    assert_int_equal(LY_SUCCESS, lyd_validate_all(&tree, NULL, LYD_VALIDATE_PRESENT, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_sibling_val(lyd_child(tree), lysc_node_child(tree->schema), NULL, 0, &node));
+    assert_false(node->flags & LYD_DFLT_VIRTUAL);
+    assert_int_equal(LY_SUCCESS, lyd_find_path(tree, "/dv:cont/b", 0, &node));
+    assert_false(node->flags & LYD_DFLT_VIRTUAL);
+    assert_true(node->flags & LYD_DEFAULT);
+
+    lyd_free_all(tree);
+    lyd_free_all(tree2);
+
+    /* found using the instance index */
+    assert_int_equal(LY_SUCCESS, ly_ctx_new(NULL, LY_CTX_INST_INDEX, &ctx));
+    assert_int_equal(LY_SUCCESS, lys_parse_mem(ctx, schema, LYS_IN_YANG, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(ctx, "<cont xmlns=\"urn:tests:dv\"><c>x</c></cont>",
+            LYD_XML, 0, LYD_VALIDATE_PRESENT | LYD_VALIDATE_VIRTUAL_DEFAULTS, &tree));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//dv:b", &set));
+    assert_int_equal(1, set->count);
+    assert_true(set->dnodes[0]->flags & LYD_DFLT_VIRTUAL);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//dv:c | //dv:a", &set));
+    assert_int_equal(2, set->count);
+    assert_string_equal(LYD_NAME(set->dnodes[0]), "a");
+    assert_string_equal(LYD_NAME(set->dnodes[1]), "c");
+    ly_set_free(set, NULL);
+
+    /* virtual leaves of the tree only, not of a freed one and not those with a real instance */
+    assert_int_equal(LY_SUCCESS, lyd_parse_data_mem(ctx, "<cont xmlns=\"urn:tests:dv\"/>", LYD_XML, 0,
+            LYD_VALIDATE_PRESENT | LYD_VALIDATE_VIRTUAL_DEFAULTS, &tree2));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree2, "//dv:a", &set));
+    assert_int_equal(1, set->count);
+    assert_ptr_equal(lyd_parent(set->dnodes[0]), tree2);
+    ly_set_free(set, NULL);
+    lyd_free_all(tree2);
+    assert_int_equal(LY_SUCCESS, lyd_new_term(tree, NULL, "b", "7", 0, NULL));
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "//dv:a | //dv:b", &set));
+    assert_int_equal(2, set->count);
+    assert_true(set->dnodes[0]->flags & LYD_DFLT_VIRTUAL);
+    assert_false(set->dnodes[1]->flags & LYD_DFLT_VIRTUAL);
+    assert_string_equal(lyd_get_value(set->dnodes[1]), "7");
+    ly_set_free(set, NULL);
+    lyd_free_all(tree);
+    ly_ctx_destroy(ctx);
+}
+
 static void
 test_state(void **state)
 {
@@ -1565,6 +1926,7 @@ main(void)
 {
     const struct CMUnitTest tests[] = {
         UTEST(test_when),
+        UTEST(test_when_cache),
         UTEST(test_mandatory),
         UTEST(test_mandatory_when),
         UTEST(test_type_incomplete_when),
@@ -1572,8 +1934,10 @@ main(void)
         UTEST(test_minmax),
         UTEST(test_unique),
         UTEST(test_unique_nested),
+        UTEST(test_list_constraints),
         UTEST(test_dup),
         UTEST(test_defaults),
+        UTEST(test_defaults_virtual),
         UTEST(test_state),
         UTEST(test_must),
         UTEST(test_multi_error),
@@ -122,12 +122,78 @@ test_plugin_lyb(void **state)
     TEST_SUCCESS_LYB("lyb", "lf", "ident");
 }
 
+static void
+test_derivation(void **state)
+{
+    const char *schema;
+    struct lys_module *mod_a, *mod_b;
+    struct lyd_node *tree;
+    struct ly_set *set;
+    const char *data;
+
+    /* diamond derivation across modules */
+    schema = "module der-a {"
+            "  yang-version 1.1;"
+            "  namespace \"urn:tests:der-a\";"
+            "  prefix a;"
+            "  identity base;"
+            "  identity b1 {base base;}"
+            "  identity b2 {base base;}"
+            "  identity d {base b1; base b2;}"
+            "  identity other;"
+            "}";
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, &mod_a);
+
+    schema = MODULE_CREATE_YANG("der-b",
+            "import der-a {prefix a;}"
+            "identity e {base a:d;}"
+            "leaf-list ll {type identityref {base a:b1;}}");
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, &mod_b);
+
+    assert_int_equal(LY_SUCCESS, lyplg_type_identity_isderived(&mod_a->identities[0], &mod_b->identities[0]));
+    assert_int_equal(LY_SUCCESS, lyplg_type_identity_isderived(&mod_a->identities[2], &mod_b->identities[0]));
+    assert_int_equal(LY_SUCCESS, lyplg_type_identity_isderived(&mod_a->identities[1], &mod_a->identities[3]));
+    assert_int_equal(LY_ENOTFOUND, lyplg_type_identity_isderived(&mod_a->identities[1], &mod_a->identities[2]));
+    assert_int_equal(LY_ENOTFOUND, lyplg_type_identity_isderived(&mod_a->identities[4], &mod_b->identities[0]));
+    assert_int_equal(LY_ENOTFOUND, lyplg_type_identity_isderived(&mod_b->identities[0], &mod_a->identities[3]));
+
+    /* module failing to compile with identities derived from the existing ones */
+    schema = MODULE_CREATE_YANG("der-c",
+            "import der-a {prefix a;}"
+            "identity f {base a:b2;}"
+            "leaf l {type unknown;}");
+    assert_int_equal(LY_EVALID, lys_parse_mem(UTEST_LYCTX, schema, LYS_IN_YANG, NULL));
+    CHECK_LOG_CTX("Referenced type \"unknown\" not found.", "/der-c:l", 0);
+    assert_int_equal(LY_SUCCESS, lyplg_type_identity_isderived(&mod_a->identities[0], &mod_b->identities[0]));
+    assert_int_equal(LY_ENOTFOUND, lyplg_type_identity_isderived(&mod_a->identities[1], &mod_a->identities[2]));
+
+    /* identityref values and derived-from() */
+    data = "<ll xmlns=\"urn:tests:der-b\" xmlns:a=\"urn:tests:der-a\">a:d</ll>"
+            "<ll xmlns=\"urn:tests:der-b\">e</ll>";
+    CHECK_PARSE_LYD_PARAM(data, LYD_XML, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/der-b:ll[derived-from(., 'der-a:b2')]", &set));
+    assert_int_equal(2, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/der-b:ll[derived-from(., 'der-a:d')]", &set));
+    assert_int_equal(1, set->count);
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/der-b:ll[derived-from-or-self(., 'der-a:d')]", &set));
+    assert_int_equal(2, set->count);
+    ly_set_free(set, NULL);
+    lyd_free_all(tree);
+
+    TEST_ERROR_XML("der-b", "xmlns:a=\"urn:tests:der-a\"", "ll", "a:b2");
+    CHECK_LOG_CTX("Invalid identityref \"a:b2\" value - identity not derived from the base \"der-a:b1\".",
+            "/der-b:ll", 1);
+}
+
 int
 main(void)
 {
     const struct CMUnitTest tests[] = {
         UTEST(test_data_xml),
         UTEST(test_plugin_lyb),
+        UTEST(test_derivation),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
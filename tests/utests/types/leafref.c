@@ -16,6 +16,8 @@
 #define  _UTEST_MAIN_
 #include "../utests.h"
 
+#include <inttypes.h>
+
 /* LOCAL INCLUDE HEADERS */
 #include "libyang.h"
 
@@ -310,6 +312,73 @@ test_xpath_invalid_schema(void **state)
     CHECK_LOG_CTX("Deref function target node \"r1\" is not leafref.", "/xp_test:r2", 0);
 }
 
+static void
+test_data_batch(void **state)
+{
+    const char *schema;
+    char *data;
+    struct lyd_node *tree;
+    struct ly_set *set;
+    const struct lyd_node_term *target;
+    const struct lyd_leafref_links_rec *rec;
+    uint32_t i, len;
+
+    schema = MODULE_CREATE_YANG("batch",
+            "container c {"
+            "  list t {key k; leaf k {type string;}}"
+            "  leaf-list v {type string;}"
+            "  leaf-list u {type union {type uint8; type string;}}"
+            "  list r {key id; leaf id {type uint32;}"
+            "    leaf abs {type leafref {path \"/pref:c/pref:t/pref:k\";}}"
+            "    leaf rel {type leafref {path \"../../v\";}}"
+            "    leaf un {type leafref {path \"../../u\";}}"
+            "  }"
+            "}");
+    UTEST_ADD_MODULE(schema, LYS_IN_YANG, NULL, NULL);
+    ly_ctx_set_options(UTEST_LYCTX, LY_CTX_LEAFREF_LINKING);
+
+    /* many leafrefs with the same paths, the targets are collected only once */
+    data = malloc(100 * 128);
+    assert_non_null(data);
+    len = sprintf(data, "<c xmlns=\"urn:tests:batch\"><t><k>a</k></t><t><k>b</k></t><v>x</v><v>y</v>");
+    for (i = 0; i < 50; ++i) {
+        len += sprintf(data + len, "<r><id>%" PRIu32 "</id><abs>%s</abs><rel>%s</rel></r>", i, (i % 2) ? "a" : "b",
+                (i % 3) ? "x" : "y");
+    }
+    strcpy(data + len, "</c>");
+    CHECK_PARSE_LYD_PARAM(data, LYD_XML, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+
+    /* the targets are linked */
+    assert_int_equal(LY_SUCCESS, lyd_find_xpath(tree, "/batch:c/t[k='a']/k", &set));
+    assert_int_equal(1, set->count);
+    target = (struct lyd_node_term *)set->dnodes[0];
+    ly_set_free(set, NULL);
+    assert_int_equal(LY_SUCCESS, lyd_leafref_get_links(target, &rec));
+    assert_int_equal(25, LY_ARRAY_COUNT(rec->leafref_nodes));
+    lyd_free_all(tree);
+
+    /* invalid value after several valid ones */
+    strcpy(data + len, "<r><id>100</id><abs>c</abs></r></c>");
+    CHECK_PARSE_LYD_PARAM(data, LYD_XML, 0, LYD_VALIDATE_PRESENT, LY_EVALID, tree);
+    CHECK_LOG_CTX_APPTAG("Invalid leafref value \"c\" - no target instance \"/pref:c/pref:t/pref:k\" with the same value.",
+            "/batch:c/r[id='100']/abs", 0, "instance-required");
+
+    /* union targets, the value types are compared as well */
+    len = sprintf(data, "<c xmlns=\"urn:tests:batch\"><u>1</u><u>x</u>");
+    for (i = 0; i < 10; ++i) {
+        len += sprintf(data + len, "<r><id>%" PRIu32 "</id><un>%s</un></r>", i, (i % 2) ? "1" : "x");
+    }
+    strcpy(data + len, "<r><id>100</id><un>2</un></r></c>");
+    CHECK_PARSE_LYD_PARAM(data, LYD_XML, 0, LYD_VALIDATE_PRESENT, LY_EVALID, tree);
+    CHECK_LOG_CTX_APPTAG("Invalid leafref value \"2\" - no target instance \"../../u\" with the same value.",
+            "/batch:c/r[id='100']/un", 0, "instance-required");
+    strcpy(data + len, "</c>");
+    CHECK_PARSE_LYD_PARAM(data, LYD_XML, 0, LYD_VALIDATE_PRESENT, LY_SUCCESS, tree);
+    lyd_free_all(tree);
+
+    free(data);
+}
+
 int
 main(void)
 {
@@ -319,6 +388,7 @@ main(void)
         UTEST(test_plugin_lyb),
         UTEST(test_plugin_sort),
         UTEST(test_data_xpath_json),
+        UTEST(test_data_batch),
         UTEST(test_xpath_invalid_schema)
     };
 
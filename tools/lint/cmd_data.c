@@ -80,8 +80,8 @@ cmd_data_help_format(void)
 {
     printf("  -f FORMAT, --format=FORMAT\n"
             "                Print the data in one of the following formats:\n"
-            "                xml, json, lyb\n"
-            "                Note that the LYB format requires the -o option specified.\n");
+            "                xml, json, lyb, cbor\n"
+            "                Note that the LYB and CBOR formats require the -o option specified.\n");
 }
 
 static void
@@ -89,7 +89,7 @@ cmd_data_help_in_format(void)
 {
     printf("  -F FORMAT, --in-format=FORMAT\n"
             "                Load the data in one of the following formats:\n"
-            "                xml, json, lyb\n"
+            "                xml, json, lyb, cbor\n"
             "                If input format not specified, it is detected from the file extension.\n");
 }
 
@@ -334,8 +334,8 @@ cmd_data_dep(struct yl_opt *yo, int posc)
         return 1;
     }
 
-    if (!yo->out && (yo->data_out_format == LYD_LYB)) {
-        YLMSG_E("The LYB format requires the -o option specified.");
+    if (!yo->out && ((yo->data_out_format == LYD_LYB) || (yo->data_out_format == LYD_CBOR))) {
+        YLMSG_E("The LYB and CBOR formats require the -o option specified.");
         return 1;
     }
 
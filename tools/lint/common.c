@@ -146,6 +146,8 @@ get_data_format(const char *filename)
             return LYD_JSON;
         } else if (!strcmp(ptr, "lyb")) {
             return LYD_LYB;
+        } else if (!strcmp(ptr, "cbor")) {
+            return LYD_CBOR;
         } else {
             return LYD_UNKNOWN;
         }
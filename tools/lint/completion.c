@@ -408,7 +408,7 @@ get_data_type_arg(const char *hint, char ***matches, unsigned int *match_count)
 static void
 get_data_in_format_arg(const char *hint, char ***matches, unsigned int *match_count)
 {
-    const char *args[] = {"xml", "json", "lyb", NULL};
+    const char *args[] = {"xml", "json", "lyb", "cbor", NULL};
 
     get_arg_completion(hint, args, matches, match_count);
 }
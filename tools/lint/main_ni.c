@@ -76,11 +76,11 @@ help(int shortout)
     printf("  -f FORMAT, --format=FORMAT\n"
             "                Convert input into FORMAT. Supported formats: \n"
             "                yang, yin, tree, info and feature-param for schemas,\n"
-            "                xml, json, and lyb for data.\n\n");
+            "                xml, json, lyb, and cbor for data.\n\n");
 
     printf("  -I FORMAT, --in-format=FORMAT\n"
             "                Load the data in one of the following formats:\n"
-            "                xml, json, lyb\n"
+            "                xml, json, lyb, cbor\n"
             "                If input format not specified, it is detected from the file extension.\n\n");
 
     printf("  -p PATH, --path=PATH\n"
@@ -138,6 +138,9 @@ yl_opt_update_data_out_format(const char *arg, struct yl_opt *yo)
     } else if (!strcasecmp(arg, "lyb")) {
         yo->schema_out_format = 0;
         yo->data_out_format = LYD_LYB;
+    } else if (!strcasecmp(arg, "cbor")) {
+        yo->schema_out_format = 0;
+        yo->data_out_format = LYD_CBOR;
     } else {
         return 1;
     }
@@ -234,6 +237,8 @@ yo_opt_update_data_in_format(const char *arg, struct yl_opt *yo)
         yo->data_in_format = LYD_JSON;
     } else if (!strcasecmp(arg, "lyb")) {
         yo->data_in_format = LYD_LYB;
+    } else if (!strcasecmp(arg, "cbor")) {
+        yo->data_in_format = LYD_CBOR;
     } else {
         return 1;
     }